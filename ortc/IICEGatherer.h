@@ -132,6 +132,7 @@ namespace ortc
 
     struct Options {
       bool                mContinuousGathering {true};
+      bool                mICELite {false};   // only gather host candidates and answer checks (RFC 8445 section 2.5)
       InterfacePolicyList mInterfacePolicies;
       ServerList          mICEServers;
 
@@ -0,0 +1,516 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+#include <ortc/internal/ortc_BufferPool.h>
+#include <ortc/internal/platform.h>
+
+#include <openpeer/services/ISettings.h>
+#include <openpeer/services/IHelper.h>
+
+#include <zsLib/Log.h>
+#include <zsLib/XML.h>
+
+
+#ifdef _DEBUG
+#define ASSERT(x) ZS_THROW_BAD_STATE_IF(!(x))
+#else
+#define ASSERT(x)
+#endif //_DEBUG
+
+
+namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
+
+namespace ortc
+{
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+
+  namespace internal
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IBufferPoolForSettings
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void IBufferPoolForSettings::applyDefaults()
+    {
+      UseSettings::setUInt(ORTC_SETTING_BUFFER_POOL_MAX_CACHED_BUFFERS_PER_SIZE_CLASS, 1024);
+      UseSettings::setUInt(ORTC_SETTING_BUFFER_POOL_MAX_THREAD_CACHED_BUFFERS_PER_SIZE_CLASS, 64);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark BufferPool::Recycler
+    #pragma mark
+
+    struct BufferPool::Recycler
+    {
+      BufferPoolWeakPtr mPool;
+      SizeClasses mSizeClass {SizeClass_First};
+
+      void operator()(SecureByteBlock *block) const
+      {
+        auto pool = mPool.lock();
+        if (!pool) {
+          delete block;
+          return;
+        }
+        pool->recycle(block, mSizeClass);
+      }
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark BufferPool::ControlBlockAllocator
+    #pragma mark
+
+    // A pooled buffer is handed out with the recycler as its deleter thus
+    // shared_ptr needs a separate control block for each allocation; the
+    // control blocks are cached per thread (like the buffers themselves) so
+    // a pool hit never goes to the global allocator.
+    template <typename T>
+    struct BufferPool::ControlBlockAllocator
+    {
+      typedef T value_type;
+
+      struct FreeList
+      {
+        std::vector<void *> mChunks;
+
+        ~FreeList()
+        {
+          for (auto iter = mChunks.begin(); iter != mChunks.end(); ++iter) {
+            ::operator delete(*iter);
+          }
+          mChunks.clear();
+        }
+      };
+
+      size_t mMaxCached {};
+
+      ControlBlockAllocator(size_t maxCached) : mMaxCached(maxCached) {}
+
+      template <typename U>
+      ControlBlockAllocator(const ControlBlockAllocator<U> &source) : mMaxCached(source.mMaxCached) {}
+
+      T *allocate(size_t count)
+      {
+        if (1 == count) {
+          auto &chunks = freeList().mChunks;
+          if (!chunks.empty()) {
+            void *chunk = chunks.back();
+            chunks.pop_back();
+            return static_cast<T *>(chunk);
+          }
+        }
+        return static_cast<T *>(::operator new(count * sizeof(T)));
+      }
+
+      void deallocate(
+                      T *ptr,
+                      size_t count
+                      )
+      {
+        if (1 == count) {
+          auto &chunks = freeList().mChunks;
+          if (chunks.size() < mMaxCached) {
+            chunks.push_back(ptr);
+            return;
+          }
+        }
+        ::operator delete(ptr);
+      }
+
+      template <typename U>
+      bool operator==(const ControlBlockAllocator<U> &) const {return true;}
+      template <typename U>
+      bool operator!=(const ControlBlockAllocator<U> &) const {return false;}
+
+      static FreeList &freeList()
+      {
+        // one list per control block type (in practice only one is used)
+        static thread_local FreeList list;
+        return list;
+      }
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark BufferPool::ThreadCache
+    #pragma mark
+
+    struct BufferPool::ThreadCache
+    {
+      BufferPoolWeakPtr mPool;
+      BlockList mBlocks[SizeClass_Last+1];
+
+      ~ThreadCache()
+      {
+        auto pool = mPool.lock();
+        if (pool) {
+          pool->release(*this);
+          return;
+        }
+
+        for (size_t index = SizeClass_First; index <= SizeClass_Last; ++index) {
+          for (auto iter = mBlocks[index].begin(); iter != mBlocks[index].end(); ++iter) {
+            delete (*iter);
+          }
+          mBlocks[index].clear();
+        }
+      }
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark BufferPool
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    const char *BufferPool::toString(SizeClasses sizeClass)
+    {
+      switch (sizeClass) {
+        case SizeClass_256:   return "256";
+        case SizeClass_1500:  return "1500";
+        case SizeClass_9000:  return "9000";
+        case SizeClass_64K:   return "64K";
+      }
+      return "UNDEFINED";
+    }
+
+    //-------------------------------------------------------------------------
+    size_t BufferPool::toSize(SizeClasses sizeClass)
+    {
+      switch (sizeClass) {
+        case SizeClass_256:   return 256;
+        case SizeClass_1500:  return 1500;
+        case SizeClass_9000:  return 9000;
+        case SizeClass_64K:   return 0xFFFF+1;
+      }
+      ASSERT(false)
+      return 0;
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr BufferPool::Stats::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::BufferPool::Stats");
+
+      UseServicesHelper::debugAppend(resultEl, "hits", mHits);
+      UseServicesHelper::debugAppend(resultEl, "misses", mMisses);
+      UseServicesHelper::debugAppend(resultEl, "outstanding", mOutstanding);
+      UseServicesHelper::debugAppend(resultEl, "cached", mCached);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    BufferPool::BufferPool(const make_private &) :
+      mMaxCachedPerSizeClass(UseSettings::getUInt(ORTC_SETTING_BUFFER_POOL_MAX_CACHED_BUFFERS_PER_SIZE_CLASS)),
+      mMaxThreadCachedPerSizeClass(UseSettings::getUInt(ORTC_SETTING_BUFFER_POOL_MAX_THREAD_CACHED_BUFFERS_PER_SIZE_CLASS))
+    {
+      ZS_LOG_DETAIL(debug("created"))
+    }
+
+    //-------------------------------------------------------------------------
+    BufferPool::~BufferPool()
+    {
+      mThisWeak.reset();
+
+      for (size_t index = SizeClass_First; index <= SizeClass_Last; ++index) {
+        for (auto iter = mFree[index].begin(); iter != mFree[index].end(); ++iter) {
+          delete (*iter);
+        }
+        mFree[index].clear();
+      }
+
+      ZS_LOG_DETAIL(log("destroyed"))
+    }
+
+    //-------------------------------------------------------------------------
+    BufferPoolPtr BufferPool::create()
+    {
+      BufferPoolPtr pThis(make_shared<BufferPool>(make_private{}));
+      pThis->mThisWeak = pThis;
+      return pThis;
+    }
+
+    //-------------------------------------------------------------------------
+    BufferPoolPtr BufferPool::singleton()
+    {
+      static SingletonLazySharedPtr<BufferPool> singleton(create());
+      BufferPoolPtr result = singleton.singleton();
+      if (!result) {
+        ZS_LOG_WARNING(Detail, slog("singleton gone"))
+      }
+      return result;
+    }
+
+    //-------------------------------------------------------------------------
+    SecureByteBlockPtr BufferPool::allocate(size_t sizeInBytes)
+    {
+      SizeClasses sizeClass {SizeClass_First};
+
+      if (!findSizeClass(sizeInBytes, sizeClass)) {
+        ZS_LOG_INSANE(slog("buffer too large to pool") + ZS_PARAM("size", sizeInBytes))
+        return make_shared<SecureByteBlock>(sizeInBytes);
+      }
+
+      auto pThis = singleton();
+      if (!pThis) return make_shared<SecureByteBlock>(sizeInBytes);
+
+      return pThis->allocate(sizeClass);
+    }
+
+    //-------------------------------------------------------------------------
+    BufferPool::Stats BufferPool::getStats()
+    {
+      Stats result;
+
+      auto pThis = singleton();
+      if (!pThis) return result;
+
+      result.mHits = pThis->mHits;
+      result.mMisses = pThis->mMisses;
+      result.mOutstanding = pThis->mOutstanding;
+
+      {
+        AutoLock lock(pThis->mLock);
+        for (size_t index = SizeClass_First; index <= SizeClass_Last; ++index) {
+          result.mCached += pThis->mFree[index].size();
+        }
+      }
+
+      return result;
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr BufferPool::singletonToDebug()
+    {
+      auto pThis = singleton();
+      if (!pThis) return ElementPtr();
+      return pThis->toDebug();
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark BufferPool => (internal)
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    Log::Params BufferPool::slog(const char *message)
+    {
+      ElementPtr objectEl = Element::create("ortc::BufferPool");
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    Log::Params BufferPool::log(const char *message) const
+    {
+      ElementPtr objectEl = Element::create("ortc::BufferPool");
+      UseServicesHelper::debugAppend(objectEl, "id", mID);
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    Log::Params BufferPool::debug(const char *message) const
+    {
+      return Log::Params(message, toDebug());
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr BufferPool::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::BufferPool");
+
+      UseServicesHelper::debugAppend(resultEl, "id", mID);
+
+      UseServicesHelper::debugAppend(resultEl, "max cached per size class", mMaxCachedPerSizeClass);
+      UseServicesHelper::debugAppend(resultEl, "max thread cached per size class", mMaxThreadCachedPerSizeClass);
+
+      {
+        AutoLock lock(mLock);
+        for (size_t index = SizeClass_First; index <= SizeClass_Last; ++index) {
+          UseServicesHelper::debugAppend(resultEl, (String("cached ") + toString(static_cast<SizeClasses>(index))).c_str(), mFree[index].size());
+        }
+      }
+
+      UseServicesHelper::debugAppend(resultEl, "hits", static_cast<ULONGLONG>(mHits));
+      UseServicesHelper::debugAppend(resultEl, "misses", static_cast<ULONGLONG>(mMisses));
+      UseServicesHelper::debugAppend(resultEl, "outstanding", static_cast<ULONGLONG>(mOutstanding));
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    bool BufferPool::findSizeClass(
+                                   size_t sizeInBytes,
+                                   SizeClasses &outSizeClass
+                                   )
+    {
+      for (size_t index = SizeClass_First; index <= SizeClass_Last; ++index) {
+        SizeClasses sizeClass = static_cast<SizeClasses>(index);
+        if (sizeInBytes > toSize(sizeClass)) continue;
+        outSizeClass = sizeClass;
+        return true;
+      }
+      return false;
+    }
+
+    //-------------------------------------------------------------------------
+    SecureByteBlockPtr BufferPool::allocate(SizeClasses sizeClass)
+    {
+      SecureByteBlock *block = NULL;
+
+      // scope: try the calling thread's cache first (no lock required)
+      {
+        ThreadCache &cache = threadCache();
+        if (cache.mPool.expired()) cache.mPool = mThisWeak;
+
+        BlockList &blocks = cache.mBlocks[sizeClass];
+        if (!blocks.empty()) {
+          block = blocks.back();
+          blocks.pop_back();
+        }
+      }
+
+      if (!block) {
+        AutoLock lock(mLock);
+        BlockList &blocks = mFree[sizeClass];
+        if (!blocks.empty()) {
+          block = blocks.back();
+          blocks.pop_back();
+        }
+      }
+
+      if (block) {
+        ++mHits;
+      } else {
+        ++mMisses;
+        block = new SecureByteBlock(toSize(sizeClass));
+      }
+
+      ++mOutstanding;
+
+      Recycler recycler;
+      recycler.mPool = mThisWeak;
+      recycler.mSizeClass = sizeClass;
+
+      ControlBlockAllocator<SecureByteBlock> allocator(mMaxThreadCachedPerSizeClass * (SizeClass_Last+1));
+
+      return SecureByteBlockPtr(block, recycler, allocator);
+    }
+
+    //-------------------------------------------------------------------------
+    void BufferPool::recycle(
+                             SecureByteBlock *block,
+                             SizeClasses sizeClass
+                             )
+    {
+      ASSERT(NULL != block)
+      ASSERT(toSize(sizeClass) == block->SizeInBytes())
+
+      --mOutstanding;
+
+      // buffers may have held keying material or decrypted media; never hand
+      // out a previous user's data
+      memset(block->BytePtr(), 0, block->SizeInBytes());
+
+      // scope: return to the calling thread's cache (no lock required)
+      {
+        ThreadCache &cache = threadCache();
+        if (cache.mPool.expired()) cache.mPool = mThisWeak;
+
+        BlockList &blocks = cache.mBlocks[sizeClass];
+        if (blocks.size() < mMaxThreadCachedPerSizeClass) {
+          blocks.push_back(block);
+          return;
+        }
+      }
+
+      {
+        AutoLock lock(mLock);
+        BlockList &blocks = mFree[sizeClass];
+        if (blocks.size() < mMaxCachedPerSizeClass) {
+          blocks.push_back(block);
+          return;
+        }
+      }
+
+      delete block;
+    }
+
+    //-------------------------------------------------------------------------
+    void BufferPool::release(ThreadCache &cache)
+    {
+      AutoLock lock(mLock);
+
+      for (size_t index = SizeClass_First; index <= SizeClass_Last; ++index) {
+        BlockList &blocks = cache.mBlocks[index];
+        for (auto iter = blocks.begin(); iter != blocks.end(); ++iter) {
+          if (mFree[index].size() < mMaxCachedPerSizeClass) {
+            mFree[index].push_back(*iter);
+            continue;
+          }
+          delete (*iter);
+        }
+        blocks.clear();
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    BufferPool::ThreadCache &BufferPool::threadCache()
+    {
+      static thread_local ThreadCache cache;
+      return cache;
+    }
+
+  }
+}
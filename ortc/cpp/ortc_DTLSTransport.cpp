@@ -108,18 +108,11 @@ namespace ortc
     // We don't pull the RTP constants from rtputils.h, to avoid a layer violation.
     static const size_t kDtlsRecordHeaderLen = 13;
     static const size_t kMaxDtlsPacketLen = 2048;
-    static const size_t kMinRtpPacketLen = 12;
 
     // Maximum number of pending packets in the queue. Packets are read immediately
     // after they have been written, so a capacity of "1" is sufficient.
     static const size_t kMaxPendingPackets = 1;
 
-    static bool isDtlsPacket(const BYTE *data, size_t len) {
-      return (len >= kDtlsRecordHeaderLen && (data[0] > 19 && data[0] < 64));
-    }
-    static bool isRtpPacket(const BYTE *data, size_t len) {
-      return (len >= kMinRtpPacketLen && (data[0] & 0xC0) == 0x80);
-    }
 
 
 #if (OPENSSL_VERSION_NUMBER >= 0x10001000L)
@@ -715,32 +708,48 @@ namespace ortc
 
       ZS_LOG_TRACE(log("sending rtp packet") + ZS_PARAM("length", bufferLengthInBytes))
 
-      UseSRTPTransportPtr transport;
+      UseSRTPTransportPtr transport = getSRTPTransportForSending(bufferLengthInBytes);
+      if (!transport) return false;
 
-      {
-        AutoRecursiveLock lock(*this);
-        if (!mSRTPTransport) {
-          ZS_LOG_WARNING(Debug, log("srtp transport is not ready"))
-          return false;
-        }
+      // WARNING: Best to not send packet to srtp transport inside an object lock
+      return transport->sendPacket(sendOverICETransport, packetType, buffer, bufferLengthInBytes);
+    }
 
-        transport = mSRTPTransport;
+    //-------------------------------------------------------------------------
+    bool DTLSTransport::sendPacketInPlace(
+                                          IICETypes::Components sendOverICETransport,
+                                          IICETypes::Components packetType,
+                                          BYTE *buffer,
+                                          size_t bufferLengthInBytes,
+                                          size_t bufferTailroomInBytes
+                                          )
+    {
+      EventWriteOrtcDtlsTransportSendRtpPacket(__func__, mID, zsLib::to_underlying(sendOverICETransport), zsLib::to_underlying(packetType), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
 
-        if ((isShutdown()) ||
-            (isShuttingDown())) {
-          ZS_LOG_WARNING(Debug, log("cannot send rtp packet while shutdown/shutting down") + ZS_PARAM("packet length", bufferLengthInBytes))
-          return false;
-        }
+      ZS_LOG_TRACE(log("sending rtp packet in place") + ZS_PARAM("length", bufferLengthInBytes) + ZS_PARAM("tailroom", bufferTailroomInBytes))
 
-        if (!isValidated()) {
-          ZS_LOG_WARNING(Debug, log("cannot send rtp packets while stream is not validated") + ZS_PARAM("packet length", bufferLengthInBytes))
-          return false;
-        }
+      UseSRTPTransportPtr transport = getSRTPTransportForSending(bufferLengthInBytes);
+      if (!transport) return false;
 
-      }
+      // WARNING: Best to not send packet to srtp transport inside an object lock
+      return transport->sendPacketInPlace(sendOverICETransport, packetType, buffer, bufferLengthInBytes, bufferTailroomInBytes);
+    }
+
+    //-------------------------------------------------------------------------
+    bool DTLSTransport::sendPackets(
+                                    IICETypes::Components sendOverICETransport,
+                                    const ISecureTransportTypes::OutgoingPacketList &packets
+                                    )
+    {
+      if (packets.size() < 1) return true;
+
+      ZS_LOG_TRACE(log("sending rtp packet burst") + ZS_PARAM("total", packets.size()))
+
+      UseSRTPTransportPtr transport = getSRTPTransportForSending(packets.front().mSize);
+      if (!transport) return false;
 
       // WARNING: Best to not send packet to srtp transport inside an object lock
-      return transport->sendPacket(sendOverICETransport, packetType, buffer, bufferLengthInBytes);
+      return transport->sendPackets(sendOverICETransport, packets);
     }
 
 
@@ -771,11 +780,14 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool DTLSTransport::handleReceivedPacket(
                                              IICETypes::Components viaTransport,
+                                             PacketDemux::PacketTypes packetType,
                                              const BYTE *buffer,
                                              size_t bufferLengthInBytes
                                              )
     {
-      bool isDTLSPacket = isDtlsPacket(buffer, bufferLengthInBytes);
+      // classified once when read from the socket (see PacketDemux)
+      bool isDTLSPacket = (PacketDemux::PacketType_DTLS == packetType);
+      bool isMediaPacket = PacketDemux::isMedia(packetType);
 
       EventWriteOrtcDtlsTransportReceivedPacket(__func__, mID, zsLib::to_underlying(viaTransport), isDTLSPacket, SafeInt<unsigned int>(bufferLengthInBytes), buffer);
 
@@ -796,7 +808,7 @@ namespace ortc
         }
 
         if (isShuttingDown()) {
-          if (isRtpPacket(buffer, bufferLengthInBytes)) {
+          if (isMediaPacket) {
             ZS_LOG_WARNING(Debug, log("received RTP packet after shutting down (thus discarding)") + ZS_PARAM("buffer length", bufferLengthInBytes))
             return false;
           }
@@ -875,14 +887,14 @@ namespace ortc
           return false;
         }
 
-        if (!isRtpPacket(buffer, bufferLengthInBytes)) {
+        if (!isMediaPacket) {
            ZS_LOG_WARNING(Debug, log("received non DTLS nor RTP packet (thus discarding)") + ZS_PARAM("buffer length", bufferLengthInBytes))
           return false;
         }
 
         if (mPutIncomingRTPIntoPendingQueue) {
           ZS_LOG_TRACE(log("transport not verified thus pushing RTP packet onto pending queue") + ZS_PARAM("buffer length", bufferLengthInBytes))
-          mPendingIncomingRTP.push(make_shared<SecureByteBlock>(buffer, bufferLengthInBytes));
+          mPendingIncomingRTP.push(TypedPacket(packetType, make_shared<SecureByteBlock>(buffer, bufferLengthInBytes)));
           if (mPendingIncomingRTP.size() > mMaxPendingRTPPackets) {
             ZS_LOG_WARNING(Debug, log("too many pending rtp packets (thus popping first packet)"))
             mPendingIncomingRTP.pop();
@@ -906,7 +918,7 @@ namespace ortc
         EventWriteOrtcDtlsTransportForwardingEncryptedPacketToSrtpTransport(__func__, mID, srtpTransport->getID(), zsLib::to_underlying(viaTransport), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
 
         ZS_LOG_INSANE(log("forwarding packet to SRTP transport") + ZS_PARAM("srtp transport id", srtpTransport->getID()) + ZS_PARAM("via", IICETypes::toString(viaTransport)) + ZS_PARAM("buffer length", bufferLengthInBytes))
-        return srtpTransport->handleReceivedPacket(viaTransport, buffer, bufferLengthInBytes);
+        return srtpTransport->handleReceivedPacket(viaTransport, packetType, buffer, bufferLengthInBytes);
       }
 
     handle_data_packet:
@@ -982,6 +994,35 @@ namespace ortc
       return transport->sendPacket(buffer, bufferLengthInBytes);
     }
 
+    //-------------------------------------------------------------------------
+    bool DTLSTransport::sendEncryptedPackets(
+                                             IICETypes::Components sendOverICETransport,
+                                             const ISecureTransportTypes::EncryptedPacketList &packets
+                                             )
+    {
+      UseICETransportPtr transport;
+
+      {
+        AutoRecursiveLock lock(*this);
+
+        if ((isShuttingDown()) ||
+            (isShutdown())) {
+          ZS_LOG_WARNING(Debug, log("cannot send encrypted packets while shutdown") + ZS_PARAM("send over component", IICETypes::toString(sendOverICETransport)) + ZS_PARAM("total", packets.size()))
+          return false;
+        }
+
+        transport = mICETransport;
+        if (!transport) {
+          ZS_LOG_WARNING(Debug, log("ice transport is not available") + ZS_PARAM("send over component", IICETypes::toString(sendOverICETransport)) + ZS_PARAM("total", packets.size()))
+          return false;
+        }
+
+        ASSERT(sendOverICETransport == transport->component())
+      }
+
+      return transport->sendPackets(sendOverICETransport, packets);
+    }
+
     //-------------------------------------------------------------------------
     bool DTLSTransport::handleReceivedDecryptedPacket(
                                                       IICETypes::Components viaTransport,
@@ -1258,7 +1299,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     void DTLSTransport::onDeliverPendingIncomingRTP()
     {
-      PacketQueue pendingPackets;
+      TypedPacketQueue pendingPackets;
       UseSRTPTransportPtr srtpTransport;
 
       IICETypes::Components viaTransport = component();
@@ -1273,7 +1314,7 @@ namespace ortc
         }
 
         pendingPackets = mPendingIncomingRTP;
-        mPendingIncomingRTP = PacketQueue();
+        mPendingIncomingRTP = TypedPacketQueue();
 
         srtpTransport = mSRTPTransport;
         if (!srtpTransport) {
@@ -1283,10 +1324,11 @@ namespace ortc
       }
 
       while (pendingPackets.size() > 0) {
-        auto packet = pendingPackets.front();
+        auto packetType = pendingPackets.front().first;
+        auto packet = pendingPackets.front().second;
 
         EventWriteOrtcDtlsTransportForwardingEncryptedPacketToSrtpTransport(__func__, mID, srtpTransport->getID(), zsLib::to_underlying(viaTransport), SafeInt<unsigned int>(packet->SizeInBytes()), packet->BytePtr());
-        bool delivered = srtpTransport->handleReceivedPacket(viaTransport, packet->BytePtr(), packet->SizeInBytes());
+        bool delivered = srtpTransport->handleReceivedPacket(viaTransport, packetType, packet->BytePtr(), packet->SizeInBytes());
         if (!delivered) {
           ZS_LOG_WARNING(Debug, log("failed to process SRTP packet"))
         }
@@ -1550,6 +1592,29 @@ namespace ortc
               (IDTLSTransportTypes::State_Failed == mCurrentState));
     }
 
+    //-------------------------------------------------------------------------
+    DTLSTransport::UseSRTPTransportPtr DTLSTransport::getSRTPTransportForSending(size_t bufferLengthInBytes)
+    {
+      AutoRecursiveLock lock(*this);
+      if (!mSRTPTransport) {
+        ZS_LOG_WARNING(Debug, log("srtp transport is not ready"))
+        return UseSRTPTransportPtr();
+      }
+
+      if ((isShutdown()) ||
+          (isShuttingDown())) {
+        ZS_LOG_WARNING(Debug, log("cannot send rtp packet while shutdown/shutting down") + ZS_PARAM("packet length", bufferLengthInBytes))
+        return UseSRTPTransportPtr();
+      }
+
+      if (!isValidated()) {
+        ZS_LOG_WARNING(Debug, log("cannot send rtp packets while stream is not validated") + ZS_PARAM("packet length", bufferLengthInBytes))
+        return UseSRTPTransportPtr();
+      }
+
+      return mSRTPTransport;
+    }
+
     //-------------------------------------------------------------------------
     void DTLSTransport::step()
     {
@@ -31,8 +31,12 @@
 
 #include <ortc/internal/ortc_ICEGatherer.h>
 #include <ortc/internal/ortc_ICETransport.h>
+#include <ortc/internal/ortc_BufferPool.h>
 #include <ortc/internal/ortc_Helper.h>
+#include <ortc/internal/ortc_ICESharedPort.h>
+#include <ortc/internal/ortc_NetworkMonitor.h>
 #include <ortc/internal/ortc_ORTC.h>
+#include <ortc/internal/ortc_SocketReactor.h>
 #include <ortc/internal/ortc_Tracing.h>
 #include <ortc/internal/platform.h>
 
@@ -50,6 +54,7 @@
 
 #include <zsLib/SafeInt.h>
 
+#include <algorithm>
 #include <regex>
 
 #include <cryptopp/sha.h>
@@ -98,6 +103,7 @@ namespace ortc
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IDNS, UseDNS)
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHTTP, UseHTTP)
+  ZS_DECLARE_TYPEDEF_PTR(ortc::internal::BufferPool, UseBufferPool)
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IBackOffTimerPattern, UseBackOffTimerPattern)
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ITURNSocket, ITURNSocket)
@@ -120,6 +126,10 @@ namespace ortc
     #pragma mark helpers
     #pragma mark
 
+    // TURN channel bindings expire after 10 minutes (RFC 5766 section 11)
+    static const ULONG kTURNChannelRefreshInSeconds = 60*5;
+    static const ULONG kTURNChannelTimerInSeconds = 30;
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -357,6 +367,7 @@ namespace ortc
 
       UseSettings::setUInt(ORTC_SETTING_GATHERER_REFLEXIVE_INACTIVITY_TIMEOUT_IN_SECONDS, 60*2);
       UseSettings::setUInt(ORTC_SETTING_GATHERER_RELAY_INACTIVITY_TIMEOUT_IN_SECONDS, 60*2);
+      UseSettings::setUInt(ORTC_SETTING_GATHERER_INACTIVITY_TIMER_RESOLUTION_IN_MILLISECONDS, 1000);
       UseSettings::setUInt(ORTC_SETTING_GATHERER_MAX_INCOMING_PACKET_BUFFERING_TIME_IN_SECONDS, 30);
       UseSettings::setUInt(ORTC_SETTING_GATHERER_MAX_TOTAL_INCOMING_PACKET_BUFFERING, 50);
 
@@ -368,6 +379,9 @@ namespace ortc
       UseSettings::setBool(ORTC_SETTING_GATHERER_GATHER_PASSIVE_TCP_CANDIDATES, true);
 
       UseSettings::setUInt(ORTC_SETTING_GATHERER_RECHECK_IP_ADDRESSES_IN_SECONDS, 60);
+
+      UseSettings::setBool(ORTC_SETTING_GATHERER_TURN_CHANNEL_FAST_PATH, true);
+      UseSettings::setUInt(ORTC_SETTING_GATHERER_TURN_CHANNEL_IDLE_TIMEOUT_IN_SECONDS, 60*5);
     }
 
     //-------------------------------------------------------------------------
@@ -525,18 +539,27 @@ namespace ortc
       mGathererRouter(ICEGathererRouter::create()),
       mUsernameFrag(options.mUsernameFragment.hasData() ? options.mUsernameFragment : UseServicesHelper::randomString(UseSettings::getUInt(ORTC_SETTING_GATHERER_USERNAME_FRAG_LENGTH))),
       mPassword(options.mPassword.hasData() ? options.mPassword : UseServicesHelper::randomString(UseSettings::getUInt(ORTC_SETTING_GATHERER_PASSWORD_LENGTH))),
+      mMessageIntegrity(STUNMessageIntegrity::create(mPassword)),
       mCreateTCPCandidates(UseSettings::getBool(ORTC_SETTING_GATHERER_CREATE_TCP_CANDIDATES)),
       mOptions(options.mOptions),
       mComponent(options.mComponent),
       mRTPGatherer(options.mRTPGatherer),
       mReflexiveInactivityTime(Seconds(UseSettings::getUInt(ORTC_SETTING_GATHERER_REFLEXIVE_INACTIVITY_TIMEOUT_IN_SECONDS))),
+      mReflexiveInactivityTimers(Milliseconds(UseSettings::getUInt(ORTC_SETTING_GATHERER_INACTIVITY_TIMER_RESOLUTION_IN_MILLISECONDS))),
       mRelayInactivityTime(Seconds(UseSettings::getUInt(ORTC_SETTING_GATHERER_RELAY_INACTIVITY_TIMEOUT_IN_SECONDS))),
+      mRelayInactivityTimers(Milliseconds(UseSettings::getUInt(ORTC_SETTING_GATHERER_INACTIVITY_TIMER_RESOLUTION_IN_MILLISECONDS))),
       mMaxBufferingTime(Seconds(UseSettings::getUInt(ORTC_SETTING_GATHERER_MAX_INCOMING_PACKET_BUFFERING_TIME_IN_SECONDS))),
       mMaxTotalBuffers(UseSettings::getUInt(ORTC_SETTING_GATHERER_MAX_TOTAL_INCOMING_PACKET_BUFFERING)),
       mMaxTCPBufferingSizePendingConnection(UseSettings::getUInt(ORTC_SETTING_GATHERER_MAX_PENDING_OUTGOING_TCP_SOCKET_BUFFERING_IN_BYTES)),
       mMaxTCPBufferingSizeConnected(UseSettings::getUInt(ORTC_SETTING_GATHERER_MAX_CONNECTED_TCP_SOCKET_BUFFERING_IN_BYTES)),
-      mGatherPassiveTCP(UseSettings::getBool(ORTC_SETTING_GATHERER_GATHER_PASSIVE_TCP_CANDIDATES))
+      mGatherPassiveTCP(UseSettings::getBool(ORTC_SETTING_GATHERER_GATHER_PASSIVE_TCP_CANDIDATES)),
+      mUseSocketReactor(SocketReactor::isEnabled()),
+      mUDPShardsPerPort(UseSettings::getUInt(ORTC_SETTING_SOCKET_REACTOR_UDP_SHARDS_PER_PORT)),
+      mUseSharedPort(ICESharedPort::isEnabled())
     {
+      if (!mUseSocketReactor) mUDPShardsPerPort = 1;
+      if (mUDPShardsPerPort < 1) mUDPShardsPerPort = 1;
+
       mSTUNPacketParseOptions = STUNPacket::ParseOptions(STUNPacket::RFC_AllowAll, false, "ortc::ICEGatherer", mID);
 
       auto recheckIPsInSeconds = UseSettings::getUInt(ORTC_SETTING_GATHERER_RECHECK_IP_ADDRESSES_IN_SECONDS);
@@ -544,6 +567,9 @@ namespace ortc
       if (0 != recheckIPsInSeconds) {
         mRecheckIPsDuration = Seconds(recheckIPsInSeconds);
       }
+
+      mUseTURNChannels = UseSettings::getBool(ORTC_SETTING_GATHERER_TURN_CHANNEL_FAST_PATH);
+      mTURNChannelIdleTimeout = Seconds(UseSettings::getUInt(ORTC_SETTING_GATHERER_TURN_CHANNEL_IDLE_TIMEOUT_IN_SECONDS));
       
       EventWriteOrtcIceGathererCreate(
                                       __func__,
@@ -613,6 +639,20 @@ namespace ortc
         ZS_LOG_DETAIL(log("setting up timer to clean unsed routes") + ZS_PARAM("clean duration (s)", mCleanUnusedRoutesDuration) + ZS_PARAM("timer", mCleanUnusedRoutesTimer->getID()))
       }
 
+      if (mUseSharedPort) {
+        mUseSharedPort = ICESharedPort::registerUsernameFrag(mThisWeak.lock(), mUsernameFrag);
+        if (!mUseSharedPort) {
+          ZS_LOG_DETAIL(log("unable to use shared port (binding own ports)") + ZS_PARAM("username frag", mUsernameFrag))
+        }
+      }
+
+      if (NetworkMonitor::isEnabled()) {
+        mUseNetworkMonitor = NetworkMonitor::subscribe(mID, mThisWeak.lock());
+        if (!mUseNetworkMonitor) {
+          ZS_LOG_DETAIL(log("unable to use network monitor (polling for host IP changes)"))
+        }
+      }
+
       // kick start the process
       IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
     }
@@ -775,6 +815,7 @@ namespace ortc
       result->mUseUnfreezePriority = true;
       result->mUsernameFragment = mUsernameFrag;
       result->mPassword = mPassword;
+      result->mICELite = mOptions.mICELite;
       return result;
     }
 
@@ -1053,6 +1094,13 @@ namespace ortc
       return mOptions.mContinuousGathering;
     }
 
+    //-------------------------------------------------------------------------
+    bool ICEGatherer::isICELite() const
+    {
+      AutoRecursiveLock lock(*this);
+      return mOptions.mICELite;
+    }
+
     //-------------------------------------------------------------------------
     ICEGathererRouterPtr ICEGatherer::getGathererRouter() const
     {
@@ -1078,16 +1126,9 @@ namespace ortc
 
       mRoutes.erase(found);
 
-      auto foundQuick = mQuickSearchRoutes.find(LocalCandidateRemoteIPPair(route->mLocalCandidate, routerRoute->mRemoteIP));
-      EventWriteOrtcIceGathererSearchQuickRoute(__func__, mID, route->mLocalCandidate.get(), routerRoute->mRemoteIP.string(), foundQuick != mQuickSearchRoutes.end());
-      if (foundQuick == mQuickSearchRoutes.end()) {
-        ZS_LOG_WARNING(Detail, log("quick route is not found") + route->toDebug())
-        return;
-      }
-
-      EventWriteOrtcIceGathererRemoveQuickRoute(__func__, mID, (*foundQuick).first.first.get(), (*foundQuick).first.second.string(), route->mID);
+      removeSharedRoute(route->mHostPort, routerRoute->mRemoteIP);
 
-      mQuickSearchRoutes.erase(foundQuick);
+      removeQuickSearchRoute(route);
     }
 
     //-------------------------------------------------------------------------
@@ -1157,6 +1198,22 @@ namespace ortc
             goto send_failed;
           }
           route->mRelayPort->mLastActivity = route->mLastUsed;
+
+          if (mUseTURNChannels) {
+            // only an active route (one carrying more than connectivity
+            // checks) is worth binding a channel for
+            bool requestChannel = (PacketDemux::PacketType_STUN != PacketDemux::classify(buffer, bufferSizeInBytes));
+
+            auto channel = findTURNChannel(route->mRelayPort, route->mRouterRoute->mRemoteIP, requestChannel);
+            if (channel) {
+              EventWriteOrtcIceGathererSendIceTransportPacketViaTurn(__func__, mID, transport.getID(), routerRoute->mID, route->mRelayPort->mTURNSocket->getID(), SafeInt<unsigned int>(bufferSizeInBytes), buffer);
+              if (sendTURNChannelData(*(route->mRelayPort), *channel, buffer, bufferSizeInBytes)) return true;
+
+              ZS_LOG_WARNING(Debug, log("unable to send turn channel data at this time") + route->toDebug() + channel->toDebug() + ZS_PARAM("buffer size", bufferSizeInBytes))
+              goto send_failed;
+            }
+          }
+
           turn = route->mRelayPort->mTURNSocket;
           goto send_via_turn;
         }
@@ -1166,7 +1223,7 @@ namespace ortc
             goto send_failed;
           }
 
-          auto currentSize = route->mTCPPort->mOutgoingBuffer.CurrentSize();
+          auto currentSize = route->mTCPPort->mWriter.pending();
           auto maxSize = (route->mTCPPort->mConnected ? mMaxTCPBufferingSizeConnected : mMaxTCPBufferingSizePendingConnection);
 
           ZS_LOG_INSANE(log("putting packet into TCP buffer for sending") + route->toDebug() + route->mTCPPort->toDebug() + ZS_PARAM("buffer size", bufferSizeInBytes) + ZS_PARAM("current buffer size", currentSize) + ZS_PARAM("max size", maxSize))
@@ -1178,17 +1235,7 @@ namespace ortc
 
           EventWriteOrtcIceGathererSendIceTransportPacketViaTcp(__func__, mID, transport.getID(), routerRoute->mID, route->mTCPPort->mID, SafeInt<unsigned int>(bufferSizeInBytes), buffer);
 
-          CryptoPP::word16 packeSize {static_cast<CryptoPP::word16>(htons(static_cast<unsigned short>(bufferSizeInBytes)))};
-
-          route->mTCPPort->mOutgoingBuffer.Put((const BYTE *)(&packeSize), sizeof(packeSize));
-          route->mTCPPort->mOutgoingBuffer.Put(buffer, bufferSizeInBytes);
-          if ((route->mTCPPort->mConnected) &&
-              (0 == currentSize) &&
-              (route->mTCPPort->mWriteReady)) {
-            ZS_LOG_INSANE(log("simulate write ready for TCP socket (to ensure packet is sent out straight away)"))
-            ISocketDelegateProxy::create(mThisWeak.lock())->onWriteReady(route->mTCPPort->mSocket);
-          }
-          return true;
+          return sendTCPFrame(*(route->mTCPPort), buffer, bufferSizeInBytes);
         }
 
         ZS_LOG_WARNING(Debug, log("route does not have any source / destination ports") + route->toDebug())
@@ -1214,6 +1261,58 @@ namespace ortc
       return false;
     }
 
+    //-------------------------------------------------------------------------
+    bool ICEGatherer::sendPackets(
+                                  UseICETransport &transport,
+                                  RouterRoutePtr routerRoute,
+                                  const UDPBatchSender::PacketList &packets
+                                  )
+    {
+      if (packets.size() < 1) return true;
+      if (1 == packets.size()) return sendPacket(transport, routerRoute, packets.front().mBuffer, packets.front().mSize);
+
+      HostPortPtr hostPort;
+      SocketPtr socket;
+      IPAddress boundIP;
+      IPAddress remoteIP;
+
+      {
+        AutoRecursiveLock lock(*this);
+
+        auto found = mRoutes.find(routerRoute->mID);
+        if (found != mRoutes.end()) {
+          auto route = (*found).second;
+
+          if ((route->mHostPort) &&
+              (route->mHostPort->mBoundUDPSocket)) {
+            route->mLastUsed = zsLib::now();
+
+            hostPort = route->mHostPort;
+            socket = hostPort->mBoundUDPSocket;
+            boundIP = hostPort->mBoundUDPIP;
+            remoteIP = route->mRouterRoute->mRemoteIP;
+
+            for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+              auto &packet = (*iter);
+              EventWriteOrtcIceGathererSendIceTransportPacketViaUdp(__func__, mID, transport.getID(), routerRoute->mID, hostPort->mID, remoteIP.string(), SafeInt<unsigned int>(packet.mSize), packet.mBuffer);
+            }
+          }
+        }
+      }
+
+      // the burst is flushed outside the gatherer lock so a large frame
+      // never stalls incoming packet handling
+      if (hostPort) return sendUDPPackets(*hostPort, socket, boundIP, remoteIP, packets);
+
+      // routes not yet installed, relayed or TCP routes are not batched
+      bool result = true;
+      for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+        auto &packet = (*iter);
+        if (!sendPacket(transport, routerRoute, packet.mBuffer, packet.mSize)) result = false;
+      }
+      return result;
+    }
+
     //-------------------------------------------------------------------------
     void ICEGatherer::notifyLikelyReflexiveActivity(RouterRoutePtr routerRoute)
     {
@@ -1258,6 +1357,83 @@ namespace ortc
       }
     }
 
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICEGatherer => IICEGathererForICESharedPort
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::notifySharedUDPDatagrams(
+                                               SocketPtr socket,
+                                               UDPBatchReceiver::DatagramList &datagrams
+                                               )
+    {
+      IncomingUDPPacketList packets;
+      HostPortPtr hostPort;
+
+      {
+        AutoRecursiveLock lock(*this);
+
+        auto found = mHostPortSockets.find(socket);
+        if (found == mHostPortSockets.end()) {
+          ZS_LOG_WARNING(Trace, log("shared socket is not attached to a host port") + ZS_PARAM("socket", string(socket)))
+          return;
+        }
+
+        hostPort = (*found).second;
+      }
+
+      demuxUDPDatagrams(datagrams, datagrams.size(), packets);
+
+      {
+        AutoRecursiveLock lock(*this);
+        classifyUDPDatagrams(*hostPort, packets);
+      }
+
+      for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+        handleIncomingUDPPacket(hostPort, socket, *iter);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::notifySharedTCPConnection(
+                                                SocketPtr listenSocket,
+                                                SocketPtr socket,
+                                                const IPAddress &remoteIP
+                                                )
+    {
+      AutoRecursiveLock lock(*this);
+
+      HostPortPtr hostPort;
+
+      auto found = mHostPortSockets.find(listenSocket);
+      if (found != mHostPortSockets.end()) hostPort = (*found).second;
+
+      if ((!hostPort) ||
+          (!mGatherPassiveTCP) ||
+          (!hostPort->mCandidateTCPPassive)) {
+        ZS_LOG_WARNING(Detail, log("unable to accept shared TCP connection") + ZS_PARAM("remote ip", remoteIP.string()))
+        try {
+          socket->close();
+        } catch(Socket::Exceptions::Unspecified &error) {
+          ZS_LOG_WARNING(Debug, log("failed to close socket") + ZS_PARAM("error", error.errorCode()))
+        }
+        return;
+      }
+
+      ZS_LOG_DEBUG(log("notified of incoming shared TCP connection") + hostPort->toDebug())
+
+      TCPPortPtr tcpPort(make_shared<TCPPort>());
+      tcpPort->mConnected = true;
+      tcpPort->mRemoteIP = remoteIP;
+      tcpPort->mSocket = socket;
+
+      installIncomingTCPPort(hostPort, tcpPort);
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -1316,10 +1492,10 @@ namespace ortc
 
           ZS_THROW_INVALID_ASSUMPTION_IF(!bufferedPacket->mBuffer)
 
-          EventWriteOrtcIceGathererDeliverIceTransportIncomingPacket(__func__, mID, transport->getID(), route->mID, routerRouteID, true, SafeInt<unsigned int>(bufferedPacket->mBuffer->SizeInBytes()), bufferedPacket->mBuffer->BytePtr());
+          EventWriteOrtcIceGathererDeliverIceTransportIncomingPacket(__func__, mID, transport->getID(), route->mID, routerRouteID, true, SafeInt<unsigned int>(bufferedPacket->mBufferSize), bufferedPacket->mBuffer->BytePtr());
 
-          ZS_LOG_TRACE(log("delivering buffered packet") + ZS_PARAM("transport", transport->getID()) + ZS_PARAM("buffer size", bufferedPacket->mBuffer->SizeInBytes()))
-          transport->notifyPacket(route->mRouterRoute, *(bufferedPacket->mBuffer), bufferedPacket->mBuffer->SizeInBytes());
+          ZS_LOG_TRACE(log("delivering buffered packet") + ZS_PARAM("transport", transport->getID()) + ZS_PARAM("buffer size", bufferedPacket->mBufferSize))
+          transport->notifyPacket(route->mRouterRoute, bufferedPacket->mPacketType, bufferedPacket->mBuffer->BytePtr(), bufferedPacket->mBufferSize);
           continue;
         }
       }
@@ -1358,6 +1534,52 @@ namespace ortc
       step();
     }
 
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICEGatherer => INetworkMonitorDelegate
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::onNetworkMonitorInterfacesChanged()
+    {
+      ZS_LOG_DEBUG(log("on network monitor interfaces changed"))
+      AutoRecursiveLock lock(*this);
+
+      if (!mUseNetworkMonitor) return;
+
+      if ((isComplete()) &&
+          (!mOptions.mContinuousGathering)) {
+        ZS_LOG_TRACE(log("ignoring interface change since already complete"))
+        return;
+      }
+
+      mGetLocalIPsNow = true;
+      step();
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::onNetworkMonitorFailed()
+    {
+      ZS_LOG_WARNING(Detail, log("on network monitor failed (polling for host IP changes)"))
+      AutoRecursiveLock lock(*this);
+
+      if (!mUseNetworkMonitor) return;
+
+      // the monitor already dropped the subscription; the next step arms the
+      // recheck IP timer again
+      mUseNetworkMonitor = false;
+
+      if ((!isComplete()) ||
+          (mOptions.mContinuousGathering)) {
+        // changes may have been missed while the monitor was failing
+        mGetLocalIPsNow = true;
+      }
+      step();
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -1422,6 +1644,14 @@ namespace ortc
         return;
       }
 
+      if (mTURNChannelRefreshTimer == timer) {
+        EventWriteOrtcIceGathererInternalTimerEventFired(__func__, mID, timer->getID(), "turn channel refresh timer", 0);
+
+        ZS_LOG_TRACE(log("refreshing turn channels"))
+        refreshTURNChannels();
+        return;
+      }
+
       if (mCleanUpBufferingTimer == timer) {
         EventWriteOrtcIceGathererInternalTimerEventFired(__func__, mID, timer->getID(), "clean up buffers timer", 0);
 
@@ -1436,7 +1666,7 @@ namespace ortc
           }
 
           if (buffer->mBuffer) {
-            EventWriteOrtcIceGathererDisposeBufferedIceTransportIncomingPacket(__func__, mID, buffer->mRouterRoute->mID, SafeInt<unsigned int>(buffer->mBuffer->SizeInBytes()), buffer->mBuffer->BytePtr());
+            EventWriteOrtcIceGathererDisposeBufferedIceTransportIncomingPacket(__func__, mID, buffer->mRouterRoute->mID, SafeInt<unsigned int>(buffer->mBufferSize), buffer->mBuffer->BytePtr());
           }
           if (buffer->mSTUNPacket) {
             EventWriteOrtcIceGathererDisposeBufferedIceTransportIncomingStunPacket(__func__, mID, buffer->mRouterRoute->mID);
@@ -1473,96 +1703,10 @@ namespace ortc
         return;
       }
 
-      // scope: check to see if it is an activity timer
-      {
-        auto found = mReflexiveInactivityTimers.find(timer);
-        if (found != mReflexiveInactivityTimers.end()) {
-          HostPortPtr hostPort = (*found).second.first;
-          ReflexivePortPtr reflexivePort = (*found).second.second;
-
-          EventWriteOrtcIceGathererInternalTimerEventFired(__func__, mID, timer->getID(), "reflexive inactivity timer", reflexivePort->mID);
-
-          {
-            ZS_LOG_TRACE(log("reflexive inactivity timer fired") + hostPort->toDebug() + reflexivePort->toDebug())
-
-            if (reflexivePort->mInactivityTimer) {
-              reflexivePort->mInactivityTimer->cancel();
-              reflexivePort->mInactivityTimer.reset();
-            }
-
-            mReflexiveInactivityTimers.erase(found);
-
-            if (shouldKeepWarm()) {
-              ZS_LOG_WARNING(Trace, log("no need to shutdown TURN socket as paths need to be kept warm") + reflexivePort->toDebug())
-              return;
-            }
-
-            if (Time() == reflexivePort->mLastActivity) goto inactivity_shutdown_reflexive;
-            if (reflexivePort->mLastActivity + mReflexiveInactivityTime <= now) goto inactivity_shutdown_reflexive;
-
-            ZS_LOG_TRACE(log("no need to shutdown reflexive port at this time (still active)") + reflexivePort->toDebug() + ZS_PARAM("now", now))
-
-            auto fireAt = reflexivePort->mLastActivity + mReflexiveInactivityTime;
-            reflexivePort->mInactivityTimer = Timer::create(mThisWeak.lock(), fireAt);
-            mReflexiveInactivityTimers[reflexivePort->mInactivityTimer] = HostAndReflexivePortPair(hostPort, reflexivePort);
-            return;
-          }
-
-        inactivity_shutdown_reflexive:
-          {
-            ZS_LOG_DEBUG(log("need to shutdown reflexive port as it is inactive") + reflexivePort->toDebug())
-
-            shutdown(reflexivePort, hostPort);
-            return;
-          }
-          
-        }
-      }
-
-      // scope: check to see if it is an activity timer
-      {
-        auto found = mRelayInactivityTimers.find(timer);
-        if (found != mRelayInactivityTimers.end()) {
-          HostPortPtr hostPort = (*found).second.first;
-          RelayPortPtr relayPort = (*found).second.second;
-
-          EventWriteOrtcIceGathererInternalTimerEventFired(__func__, mID, timer->getID(), "relay inactivity timer", relayPort->mID);
-
-          {
-            ZS_LOG_TRACE(log("relay inactivity timer fired") + hostPort->toDebug() + relayPort->toDebug())
-
-            if (relayPort->mInactivityTimer) {
-              relayPort->mInactivityTimer->cancel();
-              relayPort->mInactivityTimer.reset();
-            }
-
-            mRelayInactivityTimers.erase(found);
-
-            if (shouldKeepWarm()) {
-              ZS_LOG_WARNING(Trace, log("no need to shutdown TURN socket as paths need to be kept warm") + relayPort->toDebug())
-              return;
-            }
-
-            if (Time() == relayPort->mLastActivity) goto inactivity_shutdown_relay;
-            if (relayPort->mLastActivity + mRelayInactivityTime <= now) goto inactivity_shutdown_relay;
-
-            ZS_LOG_TRACE(log("no need to shutdown relay port at this time (still active)") + relayPort->toDebug() + ZS_PARAM("now", now))
-
-            auto fireAt = relayPort->mLastActivity + mRelayInactivityTime;
-            relayPort->mInactivityTimer = Timer::create(mThisWeak.lock(), fireAt);
-            mRelayInactivityTimers[relayPort->mInactivityTimer] = HostAndRelayPortPair(hostPort, relayPort);
-            return;
-          }
-
-        inactivity_shutdown_relay:
-          {
-            ZS_LOG_DEBUG(log("need to shutdown relay port as it is inactive") + relayPort->toDebug())
-
-            shutdown(relayPort, hostPort);
-            return;
-          }
-
-        }
+      if (mInactivityTimer == timer) {
+        EventWriteOrtcIceGathererInternalTimerEventFired(__func__, mID, timer->getID(), "inactivity timer", 0);
+        handleInactivityTimers();
+        return;
       }
     }
 
@@ -1815,7 +1959,135 @@ namespace ortc
 
       step();
     }
-    
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICEGatherer => ISTUNRequesterDelegate
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::onSTUNRequesterSendPacket(
+                                                ISTUNRequesterPtr requester,
+                                                IPAddress destination,
+                                                SecureByteBlockPtr packet
+                                                )
+    {
+      ZS_THROW_INVALID_ARGUMENT_IF(!packet)
+
+      AutoRecursiveLock lock(*this);
+
+      auto found = mTURNChannelBindRequests.find(requester);
+      if (found == mTURNChannelBindRequests.end()) {
+        ZS_LOG_WARNING(Trace, log("turn channel bind request is obsolete (thus ignoring request to send packet)") + ZS_PARAM("stun requester", requester->getID()) + ZS_PARAM("destination ip", destination.string()))
+        return;
+      }
+
+      auto relayPort = (*found).second.first;
+      if (!relayPort->mTURNSocket) {
+        ZS_LOG_WARNING(Trace, log("turn socket is gone (thus cannot send channel bind request)") + relayPort->toDebug())
+        return;
+      }
+
+      auto foundSocket = mTURNSockets.find(relayPort->mTURNSocket);
+      if (foundSocket == mTURNSockets.end()) {
+        ZS_LOG_WARNING(Trace, log("turn socket is not mapped to a host port") + relayPort->toDebug())
+        return;
+      }
+
+      auto hostPort = (*foundSocket).second.first;
+      if (!hostPort->mBoundUDPSocket) {
+        ZS_LOG_WARNING(Trace, log("host port has no bound UDP socket (thus cannot send channel bind request)") + hostPort->toDebug())
+        return;
+      }
+
+      ZS_LOG_TRACE(log("sending turn channel bind request") + ZS_PARAM("stun requester", requester->getID()) + ZS_PARAM("destination ip", destination.string()) + ZS_PARAM("packet size", packet->SizeInBytes()))
+
+      auto result = sendUDPPacket(hostPort->mBoundUDPSocket, hostPort->mBoundUDPIP, destination, packet->BytePtr(), packet->SizeInBytes());
+      if (!result) {
+        ZS_LOG_WARNING(Debug, log("failed to send turn channel bind request") + relayPort->toDebug())
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    bool ICEGatherer::handleSTUNRequesterResponse(
+                                                  ISTUNRequesterPtr requester,
+                                                  IPAddress fromIPAddress,
+                                                  STUNPacketPtr response
+                                                  )
+    {
+      AutoRecursiveLock lock(*this);
+
+      auto found = mTURNChannelBindRequests.find(requester);
+      if (found == mTURNChannelBindRequests.end()) {
+        ZS_LOG_WARNING(Debug, log("response to turn channel bind must be from obsolete request") + ZS_PARAM("stun requester", requester->getID()))
+        return false;
+      }
+
+      auto relayPort = (*found).second.first;
+      auto channel = (*found).second.second;
+
+      if (fromIPAddress != relayPort->mServerResponseIP) {
+        ZS_LOG_WARNING(Detail, log("turn channel bind response did not come from turn server") + ZS_PARAM("from ip", fromIPAddress.string()) + relayPort->toDebug())
+        return false;
+      }
+
+      mTURNChannelBindRequests.erase(found);
+      if (channel->mBindRequester == requester) channel->mBindRequester.reset();
+
+      fix(response);
+
+      if (STUNPacket::Class_ErrorResponse == response->mClass) {
+        if (((STUNPacket::ErrorCode_Unauthorized == response->mErrorCode) ||
+             (STUNPacket::ErrorCode_StaleNonce == response->mErrorCode)) &&
+            (response->mNonce.hasData()) &&
+            (response->mNonce != relayPort->mNonce)) {
+          ZS_LOG_DEBUG(log("turn server issued new nonce (thus re-sending channel bind)") + channel->toDebug() + ZS_PARAM("realm", response->mRealm) + ZS_PARAM("nonce", response->mNonce))
+
+          if (response->mRealm.hasData()) relayPort->mRealm = response->mRealm;
+          relayPort->mNonce = response->mNonce;
+          bindTURNChannel(relayPort, channel);
+          return true;
+        }
+
+        ZS_LOG_WARNING(Detail, log("turn server refused channel binding (thus peer will remain on turn socket)") + channel->toDebug() + ZS_PARAM("error", response->mErrorCode) + relayPort->toDebug())
+        channel->mBound = false;
+        channel->mFailed = true;
+        return true;
+      }
+
+      channel->mBound = true;
+      channel->mBoundAt = zsLib::now();
+
+      ZS_LOG_DEBUG(log("turn channel bound") + channel->toDebug() + relayPort->toDebug())
+      return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::onSTUNRequesterTimedOut(ISTUNRequesterPtr requester)
+    {
+      AutoRecursiveLock lock(*this);
+
+      auto found = mTURNChannelBindRequests.find(requester);
+      if (found == mTURNChannelBindRequests.end()) {
+        ZS_LOG_WARNING(Debug, log("turn channel bind request timed out but request is obsolete") + ZS_PARAM("stun requester", requester->getID()))
+        return;
+      }
+
+      auto channel = (*found).second.second;
+      mTURNChannelBindRequests.erase(found);
+
+      if (channel->mBindRequester == requester) channel->mBindRequester.reset();
+
+      // a lost binding must not be used (the server would drop the data);
+      // the refresh timer will attempt to bind again
+      channel->mBound = false;
+
+      ZS_LOG_WARNING(Detail, log("turn channel bind request timed out") + channel->toDebug())
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -1878,6 +2150,7 @@ namespace ortc
 
       EventWriteOrtcIceGathererTurnSocketReceivedPacket(__func__, mID, socket->getID(), source.string(), SafeInt<unsigned int>(packetLengthInBytes), packet);
 
+      PacketDemux::PacketTypes packetType {PacketDemux::PacketType_Unknown};
       STUNPacketPtr stunPacket;
       CandidatePtr localCandidate;
 
@@ -1913,8 +2186,11 @@ namespace ortc
         localCandidate = relayPort->mRelayCandidate;
         relayPort->mLastActivity = zsLib::now();
 
-        stunPacket = STUNPacket::parseIfSTUN(packet, packetLengthInBytes, mSTUNPacketParseOptions);
-        fixSTUNParserOptions(stunPacket);
+        packetType = PacketDemux::classify(packet, packetLengthInBytes);
+        if (PacketDemux::isSTUNCandidate(packetType, packet, packetLengthInBytes)) {
+          stunPacket = STUNPacket::parseIfSTUN(packet, packetLengthInBytes, mSTUNPacketParseOptions);
+          fixSTUNParserOptions(stunPacket);
+        }
 
         if (closingSocket) {
           ZS_LOG_WARNING(Detail, log("turn socket is closing (thus cannot handle incoming packet)") + hostPort->toDebug() + relayPort->toDebug())
@@ -1949,7 +2225,7 @@ namespace ortc
           return;
         }
 
-        auto response = handleIncomingPacket(localCandidate, source, stunPacket);
+        auto response = handleIncomingPacket(localCandidate, source, stunPacket, packet, packetLengthInBytes);
         if (response) {
           ZS_LOG_TRACE(log("sending response packet") + localCandidate->toDebug() + ZS_PARAM("to", source.string()) + ZS_PARAM("packet length", response->SizeInBytes()))
           socket->sendPacket(source, *response, response->SizeInBytes());
@@ -1959,7 +2235,7 @@ namespace ortc
 
     found_packet:
       {
-        handleIncomingPacket(localCandidate, source, packet, packetLengthInBytes);
+        handleIncomingPacket(localCandidate, source, packetType, packet, packetLengthInBytes);
       }
     }
 
@@ -2086,6 +2362,7 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "get local ips now", mGetLocalIPsNow);
       UseServicesHelper::debugAppend(resultEl, "recheck ips duration", mRecheckIPsDuration);
       UseServicesHelper::debugAppend(resultEl, "recheck ips timer", mRecheckIPsTimer ? mRecheckIPsTimer->getID() : 0);
+      UseServicesHelper::debugAppend(resultEl, "use network monitor", mUseNetworkMonitor);
       UseServicesHelper::debugAppend(resultEl, "pending host ips", mPendingHostIPs.size());
       UseServicesHelper::debugAppend(resultEl, "resolved host ips", mResolvedHostIPs.size());
       UseServicesHelper::debugAppend(resultEl, "resolve host ip queries", mResolveHostIPQueries.size());
@@ -2107,6 +2384,11 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "turn sockets", mTURNSockets.size());
       UseServicesHelper::debugAppend(resultEl, "turn sockets shutting down", mShutdownTURNSockets.size());
 
+      UseServicesHelper::debugAppend(resultEl, "use turn channels", mUseTURNChannels);
+      UseServicesHelper::debugAppend(resultEl, "turn channel idle timeout", mTURNChannelIdleTimeout);
+      UseServicesHelper::debugAppend(resultEl, "turn channel bind requests", mTURNChannelBindRequests.size());
+      UseServicesHelper::debugAppend(resultEl, "turn channel refresh timer", mTURNChannelRefreshTimer ? mTURNChannelRefreshTimer->getID() : 0);
+
       UseServicesHelper::debugAppend(resultEl, "has stun servers options hash", mHasSTUNServersOptionsHash);
       UseServicesHelper::debugAppend(resultEl, "has stun servers", mHasSTUNServers);
 
@@ -2129,6 +2411,7 @@ namespace ortc
 
       UseServicesHelper::debugAppend(resultEl, "relay inactive time", mRelayInactivityTime);
       UseServicesHelper::debugAppend(resultEl, "relay inactive timers", mRelayInactivityTimers.size());
+      UseServicesHelper::debugAppend(resultEl, "inactivity timer", mInactivityTimer ? mInactivityTimer->getID() : 0);
 
       UseServicesHelper::debugAppend(resultEl, "tcp ports", mTCPPorts.size());
       UseServicesHelper::debugAppend(resultEl, "tcp candidate to tcp ports", mTCPCandidateToTCPPorts.size());
@@ -2226,6 +2509,11 @@ namespace ortc
         return true;
       }
 
+      if (mUseNetworkMonitor) {
+        ZS_LOG_TRACE(log("host IP changes are pushed by the network monitor (no recheck IP timer needed)"))
+        return true;
+      }
+
       if ((isComplete()) &&
           (!mOptions.mContinuousGathering)) {
         ZS_LOG_TRACE(log("do not need to recheck IPs since already complete"))
@@ -2437,6 +2725,7 @@ namespace ortc
       stepGetHostIPs_WinRT();
       stepGetHostIPs_Win32();
       stepGetHostIPs_ifaddr();
+      stepGetHostIPs_NetworkMonitor();
 
       if (mPendingHostIPs.size() > 0) {
         ZS_LOG_TRACE(log("not all host IPs resolved") + ZS_PARAM("pending size", mPendingHostIPs.size()))
@@ -2742,6 +3031,8 @@ namespace ortc
     void ICEGatherer::stepGetHostIPs_ifaddr()
     {
 #ifdef HAVE_GETIFADDRS
+      if (mUseNetworkMonitor) return;
+
       EventWriteOrtcIceGathererStep(__func__, mID);
 
       // scope: use getifaddrs
@@ -2788,6 +3079,33 @@ namespace ortc
 #endif //HAVE_GETIFADDRS
     }
 
+    //-------------------------------------------------------------------------
+    void ICEGatherer::stepGetHostIPs_NetworkMonitor()
+    {
+      if (!mUseNetworkMonitor) return;
+
+      EventWriteOrtcIceGathererStep(__func__, mID);
+
+      // the monitor's table is kept current from kernel deltas thus reading
+      // it is cheap; the existing hosts hash / host port diff turns it into
+      // bind and unbind operations
+      NetworkMonitor::AddressList addresses;
+      NetworkMonitor::getAddresses(addresses);
+
+      for (auto iter = addresses.begin(); iter != addresses.end(); ++iter) {
+        auto &address = (*iter);
+
+        ZS_LOG_TRACE(log("found host IP") + ZS_PARAM("ip", address.mIP.string()) + ZS_PARAM("interface", address.mInterfaceName))
+
+        EventWriteOrtcIceGathererResolveFoundHostIP(__func__, mID, address.mIP.string(), NULL, address.mInterfaceName.c_str(), address.mInterfaceIndex);
+
+        auto data = HostIPSorter::prepare(address.mInterfaceName.c_str(), address.mIP, mInterfaceMappings, mOptions);
+        data->mIsTemporaryIP = address.mIsTemporary;
+
+        mResolvedHostIPs.push_back(data);
+      }
+    }
+
     //-------------------------------------------------------------------------
     bool ICEGatherer::stepCalculateHostsHash()
     {
@@ -2926,7 +3244,11 @@ namespace ortc
             hostPort->mBindUDPBackOffTimer->notifyAttempting();
 
             IPAddress bindIP(hostPort->mHostData->mIP);
-            hostPort->mBoundUDPSocket = bind(firstAttempt, bindIP, IICETypes::Protocol_UDP);
+            hostPort->mBoundUDPSocket = bindShared(bindIP, IICETypes::Protocol_UDP);
+            hostPort->mSharedUDP = (bool)hostPort->mBoundUDPSocket;
+            if (!hostPort->mBoundUDPSocket) {
+              hostPort->mBoundUDPSocket = bind(firstAttempt, bindIP, IICETypes::Protocol_UDP);
+            }
             if (hostPort->mBoundUDPSocket) {
               EventWriteOrtcIceGathererHostPortBind(__func__, mID, hostPort->mID, bindIP.string(), IICETypes::toString(IICETypes::Protocol_UDP), true);
               ZS_LOG_DEBUG(log("successfully bound UDP socket") + hostPort->toDebug())
@@ -2936,6 +3258,7 @@ namespace ortc
 
               hostPort->mBoundUDPIP = bindIP;
               mHostPortSockets[hostPort->mBoundUDPSocket] = hostPort;
+              if (!hostPort->mSharedUDP) bindUDPShards(hostPort);
               hostPort->mCandidateUDP = createCandidate(hostPort->mHostData, IICETypes::CandidateType_Host, bindIP);
             } else {
               EventWriteOrtcIceGathererHostPortBind(__func__, mID, hostPort->mID, bindIP.string(), IICETypes::toString(IICETypes::Protocol_UDP), false);
@@ -2962,7 +3285,11 @@ namespace ortc
               hostPort->mBindTCPBackOffTimer->notifyAttempting();
 
               IPAddress bindIP(hostPort->mHostData->mIP);
-              hostPort->mBoundTCPSocket = bind(firstAttempt, bindIP, IICETypes::Protocol_TCP);
+              hostPort->mBoundTCPSocket = (mGatherPassiveTCP ? bindShared(bindIP, IICETypes::Protocol_TCP) : SocketPtr());
+              hostPort->mSharedTCP = (bool)hostPort->mBoundTCPSocket;
+              if (!hostPort->mBoundTCPSocket) {
+                hostPort->mBoundTCPSocket = bind(firstAttempt, bindIP, IICETypes::Protocol_TCP);
+              }
               if (hostPort->mBoundTCPSocket) {
                 EventWriteOrtcIceGathererHostPortBind(__func__, mID, hostPort->mID, bindIP.string(), IICETypes::toString(IICETypes::Protocol_TCP), true);
                 ZS_LOG_DEBUG(log("successfully bound TCP socket") + ZS_PARAM("bind ip", bindIP.string()))
@@ -3403,8 +3730,7 @@ namespace ortc
 
           if (!reflexivePort->mInactivityTimer) {
             Time fireAt = reflexivePort->mLastActivity + mReflexiveInactivityTime;
-            reflexivePort->mInactivityTimer = Timer::create(mThisWeak.lock(), fireAt);
-            mReflexiveInactivityTimers[reflexivePort->mInactivityTimer] = HostAndReflexivePortPair(hostPort, reflexivePort);
+            installInactivityTimer(hostPort, reflexivePort, fireAt);
             ZS_LOG_TRACE(log("setup reflexive inactivity timeout") + ZS_PARAMIZE(fireAt) + reflexivePort->toDebug())
           }
           goto wait_until_inactive;
@@ -3577,7 +3903,9 @@ namespace ortc
               options.mUsername = relayPort->mServer.mUserName;
               options.mPassword = relayPort->mServer.mCredential;
               options.mLookupType = lookup;
-              options.mUseChannelBinding = true;
+              // when the gatherer binds its own channels the socket must
+              // not bind the same peers (and numbers) a second time
+              options.mUseChannelBinding = !mUseTURNChannels;
 
               relayPort->mTURNSocket = UseTURNSocket::create(UseServicesHelper::getServiceQueue(), mThisWeak.lock(), options);
               ZS_THROW_UNEXPECTED_ERROR_IF(!relayPort->mTURNSocket);
@@ -3603,6 +3931,7 @@ namespace ortc
                 if (relayPort->mServerResponseIP.isAddressEmpty()) {
                   relayPort->mServerResponseIP = relayPort->mTURNSocket->getServerResponseIP();
                   hostPort->mIPToRelayPortMapping[relayPort->mServerResponseIP] = relayPort;
+                  addSharedRoute(hostPort, relayPort->mServerResponseIP);
                 }
                 break;
               }
@@ -3610,10 +3939,12 @@ namespace ortc
               case UseTURNSocket::TURNSocketState_Shutdown: {
                 ZS_LOG_WARNING(Trace, log("TURN socket is shutdown") + relayPort->toDebug())
                 ready = false;
+                clearTURNChannels(*relayPort);
                 if (!relayPort->mServerResponseIP.isAddressEmpty()) {
                   auto found = hostPort->mIPToRelayPortMapping.find(relayPort->mServerResponseIP);
                   if (found != hostPort->mIPToRelayPortMapping.end()) {
                     hostPort->mIPToRelayPortMapping.erase(found);
+                    removeSharedRoute(hostPort, relayPort->mServerResponseIP);
                   }
                 }
                 if (relayPort->mRelayCandidate) {
@@ -3748,8 +4079,7 @@ namespace ortc
 
           if (!relayPort->mInactivityTimer) {
             Time fireAt = relayPort->mLastActivity + mRelayInactivityTime;
-            relayPort->mInactivityTimer = Timer::create(mThisWeak.lock(), fireAt);
-            mRelayInactivityTimers[relayPort->mInactivityTimer] = HostAndRelayPortPair(hostPort, relayPort);
+            installInactivityTimer(hostPort, relayPort, fireAt);
             ZS_LOG_TRACE(log("setup relay inactivity timeout") + ZS_PARAMIZE(fireAt) + relayPort->toDebug())
           }
           goto wait_until_inactive;
@@ -3937,6 +4267,16 @@ namespace ortc
         }
       }
 
+      if (mUseSharedPort) {
+        ICESharedPort::unregisterUsernameFrag(mID, mUsernameFrag);
+        mUseSharedPort = false;
+      }
+
+      if (mUseNetworkMonitor) {
+        NetworkMonitor::unsubscribe(mID);
+        mUseNetworkMonitor = false;
+      }
+
       // scope: remote all routes
       {
         for (auto iter_doNotUse = mRoutes.begin(); iter_doNotUse != mRoutes.end();)
@@ -3984,6 +4324,17 @@ namespace ortc
       mTURNSockets.clear();
       mShutdownTURNSockets.clear();
 
+      for (auto iter = mTURNChannelBindRequests.begin(); iter != mTURNChannelBindRequests.end(); ++iter) {
+        auto requester = (*iter).first;
+        requester->cancel();
+      }
+      mTURNChannelBindRequests.clear();
+
+      if (mTURNChannelRefreshTimer) {
+        mTURNChannelRefreshTimer->cancel();
+        mTURNChannelRefreshTimer.reset();
+      }
+
       mLastLocalPreference.clear();
 
       mNotifiedCandidates.clear();
@@ -3996,6 +4347,10 @@ namespace ortc
 
       mReflexiveInactivityTimers.clear();
       mRelayInactivityTimers.clear();
+      if (mInactivityTimer) {
+        mInactivityTimer->cancel();
+        mInactivityTimer.reset();
+      }
 
       mTCPPorts.clear();
       mTCPCandidateToTCPPorts.clear();
@@ -4242,6 +4597,160 @@ namespace ortc
       return false;
     }
     
+    //-------------------------------------------------------------------------
+    void ICEGatherer::installInactivityTimer(
+                                             HostPortPtr hostPort,
+                                             ReflexivePortPtr reflexivePort,
+                                             Time fireAt
+                                             )
+    {
+      reflexivePort->mInactivityTimer = mReflexiveInactivityTimers.add(fireAt, HostAndReflexivePortPair(hostPort, reflexivePort));
+
+      stepInactivityTimer();
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::installInactivityTimer(
+                                             HostPortPtr hostPort,
+                                             RelayPortPtr relayPort,
+                                             Time fireAt
+                                             )
+    {
+      relayPort->mInactivityTimer = mRelayInactivityTimers.add(fireAt, HostAndRelayPortPair(hostPort, relayPort));
+
+      stepInactivityTimer();
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::handleInactivityTimers()
+    {
+      Time now = zsLib::now();
+
+      ReflexiveInactivityTimerWheel::ValueList firedReflexive;
+      RelayInactivityTimerWheel::ValueList firedRelay;
+
+      mReflexiveInactivityTimers.advance(now, firedReflexive);
+      mRelayInactivityTimers.advance(now, firedRelay);
+
+      for (auto iter = firedReflexive.begin(); iter != firedReflexive.end(); ++iter) {
+        handleInactivity((*iter).first, (*iter).second);
+      }
+      for (auto iter = firedRelay.begin(); iter != firedRelay.end(); ++iter) {
+        handleInactivity((*iter).first, (*iter).second);
+      }
+
+      // the one shot timer has fired
+      mInactivityTimer.reset();
+
+      stepInactivityTimer();
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::stepInactivityTimer()
+    {
+      Time reflexiveWakeUp = mReflexiveInactivityTimers.nextWakeUp();
+      Time relayWakeUp = mRelayInactivityTimers.nextWakeUp();
+
+      Time wakeUp = reflexiveWakeUp;
+      if ((Time() == wakeUp) ||
+          ((Time() != relayWakeUp) && (relayWakeUp < wakeUp))) {
+        wakeUp = relayWakeUp;
+      }
+
+      if (Time() == wakeUp) {
+        if (!mInactivityTimer) return;
+
+        ZS_LOG_TRACE(log("no more inactivity timers pending (stopping inactivity timer)"))
+
+        mInactivityTimer->cancel();
+        mInactivityTimer.reset();
+        return;
+      }
+
+      if (mInactivityTimer) {
+        if (mInactivityTimerWakeUp <= wakeUp) return;
+        mInactivityTimer->cancel();
+        mInactivityTimer.reset();
+      }
+
+      mInactivityTimer = Timer::create(mThisWeak.lock(), wakeUp);
+      mInactivityTimerWakeUp = wakeUp;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::handleInactivity(
+                                       HostPortPtr hostPort,
+                                       ReflexivePortPtr reflexivePort
+                                       )
+    {
+      EventWriteOrtcIceGathererInternalTimerEventFired(__func__, mID, mInactivityTimer ? mInactivityTimer->getID() : 0, "reflexive inactivity timer", reflexivePort->mID);
+
+      Time now = zsLib::now();
+
+      {
+        ZS_LOG_TRACE(log("reflexive inactivity timer fired") + hostPort->toDebug() + reflexivePort->toDebug())
+
+        reflexivePort->mInactivityTimer = 0;
+
+        if (shouldKeepWarm()) {
+          ZS_LOG_WARNING(Trace, log("no need to shutdown TURN socket as paths need to be kept warm") + reflexivePort->toDebug())
+          return;
+        }
+
+        if (Time() == reflexivePort->mLastActivity) goto inactivity_shutdown_reflexive;
+        if (reflexivePort->mLastActivity + mReflexiveInactivityTime <= now) goto inactivity_shutdown_reflexive;
+
+        ZS_LOG_TRACE(log("no need to shutdown reflexive port at this time (still active)") + reflexivePort->toDebug() + ZS_PARAM("now", now))
+
+        installInactivityTimer(hostPort, reflexivePort, reflexivePort->mLastActivity + mReflexiveInactivityTime);
+        return;
+      }
+
+    inactivity_shutdown_reflexive:
+      {
+        ZS_LOG_DEBUG(log("need to shutdown reflexive port as it is inactive") + reflexivePort->toDebug())
+
+        shutdown(reflexivePort, hostPort);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::handleInactivity(
+                                       HostPortPtr hostPort,
+                                       RelayPortPtr relayPort
+                                       )
+    {
+      EventWriteOrtcIceGathererInternalTimerEventFired(__func__, mID, mInactivityTimer ? mInactivityTimer->getID() : 0, "relay inactivity timer", relayPort->mID);
+
+      Time now = zsLib::now();
+
+      {
+        ZS_LOG_TRACE(log("relay inactivity timer fired") + hostPort->toDebug() + relayPort->toDebug())
+
+        relayPort->mInactivityTimer = 0;
+
+        if (shouldKeepWarm()) {
+          ZS_LOG_WARNING(Trace, log("no need to shutdown TURN socket as paths need to be kept warm") + relayPort->toDebug())
+          return;
+        }
+
+        if (Time() == relayPort->mLastActivity) goto inactivity_shutdown_relay;
+        if (relayPort->mLastActivity + mRelayInactivityTime <= now) goto inactivity_shutdown_relay;
+
+        ZS_LOG_TRACE(log("no need to shutdown relay port at this time (still active)") + relayPort->toDebug() + ZS_PARAM("now", now))
+
+        installInactivityTimer(hostPort, relayPort, relayPort->mLastActivity + mRelayInactivityTime);
+        return;
+      }
+
+    inactivity_shutdown_relay:
+      {
+        ZS_LOG_DEBUG(log("need to shutdown relay port as it is inactive") + relayPort->toDebug())
+
+        shutdown(relayPort, hostPort);
+      }
+    }
+
     //-------------------------------------------------------------------------
     void ICEGatherer::shutdown(HostPortPtr hostPort)
     {
@@ -4303,25 +4812,28 @@ namespace ortc
         if (found != mHostPortSockets.end()) {
           mHostPortSockets.erase(found);
         }
-        try {
-          hostPort->mBoundUDPSocket->close();
-        } catch(Socket::Exceptions::Unspecified &error) {
-          ZS_LOG_ERROR(Detail, log("failed to close udp socket") + ZS_PARAM("error", error.errorCode()))
-        }
+        removeUDPReceiver(*hostPort, hostPort->mBoundUDPSocket);
+        closeHostSocket(hostPort->mBoundUDPSocket, hostPort->mSharedUDP);
         hostPort->mBoundUDPSocket.reset();
+        hostPort->mSharedUDP = false;
+      }
+
+      for (auto iter = hostPort->mBoundUDPShardSockets.begin(); iter != hostPort->mBoundUDPShardSockets.end(); ++iter) {
+        auto shardSocket = (*iter);
+        mHostPortSockets.erase(shardSocket);
+        removeUDPReceiver(*hostPort, shardSocket);
+        closeUDPSocket(shardSocket);
       }
+      hostPort->mBoundUDPShardSockets.clear();
 
       if (hostPort->mBoundTCPSocket) {
         auto found = mHostPortSockets.find(hostPort->mBoundTCPSocket);
         if (found != mHostPortSockets.end()) {
           mHostPortSockets.erase(found);
         }
-        try {
-          hostPort->mBoundTCPSocket->close();
-        } catch(Socket::Exceptions::Unspecified &error) {
-          ZS_LOG_ERROR(Detail, log("failed to close tcp socket") + ZS_PARAM("error", error.errorCode()))
-        }
+        closeHostSocket(hostPort->mBoundTCPSocket, hostPort->mSharedTCP);
         hostPort->mBoundTCPSocket.reset();
+        hostPort->mSharedTCP = false;
       }
 
       // scope: remove from host ports mapping
@@ -4383,12 +4895,8 @@ namespace ortc
       }
 
       if (reflexivePort->mInactivityTimer) {
-        auto found = mReflexiveInactivityTimers.find(reflexivePort->mInactivityTimer);
-        if (found != mReflexiveInactivityTimers.end()) {
-          mReflexiveInactivityTimers.erase(found);
-        }
-        reflexivePort->mInactivityTimer->cancel();
-        reflexivePort->mInactivityTimer.reset();
+        mReflexiveInactivityTimers.cancel(reflexivePort->mInactivityTimer);
+        reflexivePort->mInactivityTimer = 0;
       }
 
       if (reflexivePort->mSTUNDiscovery) {
@@ -4445,14 +4953,12 @@ namespace ortc
         relayPort->mTURNSocket.reset();
       }
       if (relayPort->mInactivityTimer) {
-        auto found = mRelayInactivityTimers.find(relayPort->mInactivityTimer);
-        if (found != mRelayInactivityTimers.end()) {
-          mRelayInactivityTimers.erase(found);
-        }
-        relayPort->mInactivityTimer->cancel();
-        relayPort->mInactivityTimer.reset();
+        mRelayInactivityTimers.cancel(relayPort->mInactivityTimer);
+        relayPort->mInactivityTimer = 0;
       }
 
+      clearTURNChannels(*relayPort);
+
       removeCandidate(relayPort->mReflexiveCandidate);
       removeCandidate(relayPort->mRelayCandidate);
 
@@ -4463,6 +4969,7 @@ namespace ortc
         auto found = ownerHostPort->mIPToRelayPortMapping.find(relayPort->mServerResponseIP);
         if (found != ownerHostPort->mIPToRelayPortMapping.end()) {
           ownerHostPort->mIPToRelayPortMapping.erase(found);
+          removeSharedRoute(ownerHostPort, relayPort->mServerResponseIP);
         }
       }
 
@@ -4523,8 +5030,8 @@ namespace ortc
         tcpPort->mSocket.reset();
       }
 
-      tcpPort->mIncomingBuffer.Clear();
-      tcpPort->mOutgoingBuffer.Clear();
+      tcpPort->mReader.reset();
+      tcpPort->mWriter.reset();
 
       for (auto iter_doNotUse = mRoutes.begin(); iter_doNotUse != mRoutes.end(); ) {
         auto current = iter_doNotUse;
@@ -4567,6 +5074,11 @@ namespace ortc
           }
         }
 
+        if ((IICETypes::Protocol_UDP == protocol) &&
+            (mUDPShardsPerPort > 1)) {
+          SocketReactor::enableReusePort(socket);
+        }
+
         socket->bind(ioBindIP);
         socket->setBlocking(false);
 
@@ -4579,7 +5091,11 @@ namespace ortc
 
         IPAddress local = socket->getLocalAddress();
 
-        socket->setDelegate(mThisWeak.lock());
+        if (IICETypes::Protocol_UDP == protocol) {
+          monitorUDPSocket(socket);
+        } else {
+          socket->setDelegate(mThisWeak.lock());
+        }
 
         WORD bindPort = local.getPort();
         ioBindIP.setPort(bindPort);
@@ -4590,6 +5106,7 @@ namespace ortc
         ZS_THROW_CUSTOM_PROPERTIES_1_IF(Socket::Exceptions::Unspecified, 0 == bindPort, 0)
       } catch(Socket::Exceptions::Unspecified &error) {
         ZS_LOG_ERROR(Detail, log("bind error") + ZS_PARAM("error", error.errorCode()))
+        if (socket) SocketReactor::unmonitor(socket);
         socket.reset();
         goto bind_failure;
       }
@@ -4625,7 +5142,171 @@ namespace ortc
       }
       return SocketPtr();
     }
-    
+
+    //-------------------------------------------------------------------------
+    SocketPtr ICEGatherer::bindShared(
+                                      IPAddress &ioBindIP,
+                                      IICETypes::Protocols protocol
+                                      )
+    {
+      if (!mUseSharedPort) return SocketPtr();
+
+      auto socket = ICESharedPort::attach(mThisWeak.lock(), ioBindIP, protocol);
+      if (!socket) {
+        ZS_LOG_WARNING(Detail, log("unable to attach to shared port (binding own port)") + ZS_PARAM("ip", ioBindIP.string()) + ZS_PARAM("protocol", IICETypes::toString(protocol)))
+        return SocketPtr();
+      }
+
+      ZS_LOG_DEBUG(log("attached to shared port") + ZS_PARAM("ip", ioBindIP.string()) + ZS_PARAM("protocol", IICETypes::toString(protocol)))
+      return socket;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::closeHostSocket(
+                                      SocketPtr socket,
+                                      bool shared
+                                      )
+    {
+      if (!socket) return;
+
+      if (shared) {
+        // the socket stays open for the other gatherers sharing it
+        ICESharedPort::detach(mID, socket);
+        return;
+      }
+
+      SocketReactor::unmonitor(socket);
+
+      try {
+        socket->close();
+      } catch(Socket::Exceptions::Unspecified &error) {
+        ZS_LOG_ERROR(Detail, log("failed to close host socket") + ZS_PARAM("error", error.errorCode()))
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::addSharedRoute(
+                                     HostPortPtr hostPort,
+                                     const IPAddress &remoteIP
+                                     )
+    {
+      if (!hostPort) return;
+      if (!hostPort->mSharedUDP) return;
+
+      ICESharedPort::addRoute(hostPort->mBoundUDPSocket, remoteIP, mThisWeak.lock());
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::removeSharedRoute(
+                                        HostPortPtr hostPort,
+                                        const IPAddress &remoteIP
+                                        )
+    {
+      if (!hostPort) return;
+      if (!hostPort->mSharedUDP) return;
+
+      ICESharedPort::removeRoute(hostPort->mBoundUDPSocket, remoteIP, mID);
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::validateSharedRoute(
+                                          HostPortPtr hostPort,
+                                          const IPAddress &remoteIP,
+                                          bool integrityPassed
+                                          )
+    {
+      AutoRecursiveLock lock(*this);
+
+      if (!hostPort) return;
+      if (!hostPort->mSharedUDP) return;
+
+      // the shared port only caches a remote once its binding request has
+      // been authenticated by this gatherer
+      if (integrityPassed) {
+        ICESharedPort::confirmRoute(hostPort->mBoundUDPSocket, remoteIP, mThisWeak.lock());
+        return;
+      }
+      ICESharedPort::rejectRoute(hostPort->mBoundUDPSocket, remoteIP, mID);
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::bindUDPShards(HostPortPtr hostPort)
+    {
+      if (mUDPShardsPerPort < 2) return;
+      if (!hostPort->mBoundUDPSocket) return;
+
+      auto shards = SocketReactor::createUDPShards(hostPort->mBoundUDPIP, mUDPShardsPerPort - 1);
+
+      for (auto iter = shards.begin(); iter != shards.end(); ++iter) {
+        auto socket = (*iter);
+
+        monitorUDPSocket(socket);
+
+        hostPort->mBoundUDPShardSockets.push_back(socket);
+        mHostPortSockets[socket] = hostPort;
+      }
+
+      ZS_LOG_DEBUG(log("bound UDP shard sockets") + ZS_PARAM("total", hostPort->mBoundUDPShardSockets.size()) + hostPort->toDebug())
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::monitorUDPSocket(SocketPtr socket)
+    {
+      // the reactor delivers read events on its own thread (with no hop
+      // through the gatherer's queue) and packets then flow straight through
+      // the transports to the packet shards
+      if (mUseSocketReactor) {
+        if (SocketReactor::monitor(socket, mThisWeak.lock())) return;
+        ZS_LOG_WARNING(Detail, log("socket reactor unavailable (falling back to socket monitor)") + ZS_PARAM("socket", string(socket)))
+      }
+      socket->setDelegate(mThisWeak.lock());
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::closeUDPSocket(SocketPtr socket)
+    {
+      if (!socket) return;
+
+      SocketReactor::unmonitor(socket);
+
+      try {
+        socket->close();
+      } catch(Socket::Exceptions::Unspecified &error) {
+        ZS_LOG_ERROR(Detail, log("failed to close udp socket") + ZS_PARAM("error", error.errorCode()))
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::removeUDPReceiver(
+                                        HostPort &hostPort,
+                                        SocketPtr socket
+                                        )
+    {
+      auto found = hostPort.mUDPReceivers.find(socket);
+      if (found == hostPort.mUDPReceivers.end()) return;
+
+      auto receiver = (*found).second;
+      hostPort.mUDPReceivers.erase(found);
+
+      // waits out a read in progress on another thread thus the socket is
+      // never closed underneath it
+      AutoLock receiveLock(receiver->mLock);
+      receiver->mClosed = true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool ICEGatherer::isUDPSocket(
+                                  const HostPort &hostPort,
+                                  SocketPtr socket
+                                  )
+    {
+      if (hostPort.mBoundUDPSocket == socket) return true;
+      if (hostPort.mBoundUDPShardSockets.size() < 1) return false;
+
+      auto &shards = hostPort.mBoundUDPShardSockets;
+      return std::find(shards.begin(), shards.end(), socket) != shards.end();
+    }
+
     //-------------------------------------------------------------------------
     IICETypes::CandidatePtr ICEGatherer::createCandidate(
                                                          HostIPSorter::DataPtr hostData,
@@ -4975,64 +5656,22 @@ namespace ortc
                            SocketPtr socket
                            )
     {
-      UseTURNSocketPtr turnSocket;
-      STUNPacketPtr stunPacket;
-
-      size_t totalRead = 0;
-      IPAddress fromIP;
-      BYTE readBuffer[0xFFFF] {};
-
-      CandidatePtr localCandidate;
+      IncomingUDPPacketList packets;
+      bool readMore = false;
+      UDPReceiverPtr receiver;
 
       {
         AutoRecursiveLock lock(*this);
 
-        if (hostPort->mBoundUDPSocket == socket) {
-          bool wouldBlock = false;
-          try {
-            totalRead = socket->receiveFrom(fromIP, readBuffer, sizeof(readBuffer), &wouldBlock);
-          } catch(Socket::Exceptions::Unspecified &error) {
-            ZS_LOG_WARNING(Debug, log("socket read error") + ZS_PARAM("socket", string(socket)) + ZS_PARAM("error", error.errorCode()))
-            return false;
-          }
-
-          if (0 == totalRead) {
-            if (wouldBlock) {
-              ZS_LOG_INSANE(log("socket read would block") + ZS_PARAM("socket", string(socket)))
-            } else {
-              ZS_LOG_WARNING(Debug, log("failed to read any data from socket") + ZS_PARAM("socket", string(socket)))
-            }
-            return false;
-          }
-
-          EventWriteOrtcIceGathererUdpSocketPacketReceivedFrom(__func__, mID, fromIP.string(), SafeInt<unsigned int>(totalRead), &(readBuffer[0]));
-
-          ZS_LOG_INSANE(log("receiving incoming packet") + ZS_PARAM("from ip", fromIP.string()) + ZS_PARAM("read", totalRead) + hostPort->toDebug())
-
-          stunPacket = STUNPacket::parseIfSTUN(&(readBuffer[0]), totalRead, mSTUNPacketParseOptions);
-          fixSTUNParserOptions(stunPacket);
-
-          // scope: check if for relay socket
-          {
-            auto found = hostPort->mIPToRelayPortMapping.find(fromIP);
-            if (found != hostPort->mIPToRelayPortMapping.end()) {
-              auto relayPort = (*found).second;
-              turnSocket = relayPort->mTURNSocket;
-              if (!turnSocket) {
-                ZS_LOG_WARNING(Detail, log("TURN socket was not found despite mapping being found") + relayPort->toDebug())
-                goto unknown_handler;
-              }
-              goto found_relay_port;
-            }
-          }
-
-          // this is not a relay socket, see if there is a route
-          localCandidate = hostPort->mCandidateUDP;
-          if (!localCandidate) {
-            ZS_LOG_WARNING(Trace, log("did not find local candidate"))
-            goto unknown_handler;
+        if (isUDPSocket(*hostPort, socket)) {
+          auto found = hostPort->mUDPReceivers.find(socket);
+          if (found == hostPort->mUDPReceivers.end()) {
+            receiver = make_shared<UDPReceiver>();
+            hostPort->mUDPReceivers[socket] = receiver;
+          } else {
+            receiver = (*found).second;
           }
-          goto handle_incoming;
+          goto read_udp_socket;
         }
 
         if (hostPort->mBoundTCPSocket == socket) {
@@ -5058,19 +5697,7 @@ namespace ortc
               return false;
             }
 
-            EventWriteOrtcIceGathererTcpPortCreate(__func__, mID, tcpPort->mID, tcpPort->mRemoteIP.string());
-
-            // create mappings for this socket
-            mTCPPorts[tcpPort->mSocket] = HostAndTCPPortPair(hostPort, tcpPort);
-            hostPort->mTCPPorts[tcpPort->mSocket] = HostAndTCPPortPair(hostPort, tcpPort);
-
-            tcpPort->mSocket->setDelegate(mThisWeak.lock());
-
-            tcpPort->mCandidate = hostPort->mCandidateTCPPassive;
-
-            mTCPCandidateToTCPPorts[tcpPort->mCandidate] = tcpPort;
-
-            ZS_LOG_DEBUG(log("incoming connection ready") + hostPort->toDebug() + tcpPort->toDebug())
+            installIncomingTCPPort(hostPort, tcpPort);
             return true;
           }
         }
@@ -5078,35 +5705,238 @@ namespace ortc
 
       return false;
 
-    unknown_handler:
+    read_udp_socket:
       {
-        if (stunPacket) {
-          if (ISTUNRequester::handleSTUNPacket(fromIP, stunPacket)) {
-            ZS_LOG_TRACE(log("handled by stun requester") + ZS_PARAM("from ip", fromIP.string()) + stunPacket->toDebug())
-            return true;
+        // each socket (and thus each shard's reactor loop) reads and demuxes
+        // with its own receiver without holding the gatherer lock
+        {
+          AutoLock receiveLock(receiver->mLock);
+
+          if (receiver->mClosed) {
+            ZS_LOG_TRACE(log("socket closed before it could be read") + ZS_PARAM("socket", string(socket)))
+            return false;
           }
-        }
-        return true;
-      }
 
-    found_relay_port:
-      {
-        EventWriteOrtcIceGathererUdpSocketPacketForwardingToTurnSocket(__func__, mID, fromIP.string(), ((bool)stunPacket), SafeInt<unsigned int>(totalRead), &(readBuffer[0]));
+          bool wouldBlock = false;
+          int errorCode = 0;
 
-        if (stunPacket) {
-          if (ISTUNRequester::handleSTUNPacket(fromIP, stunPacket)) {
-            ZS_LOG_TRACE(log("handled by stun requester") + ZS_PARAM("from ip", fromIP.string()) + stunPacket->toDebug())
-            return true;
+          size_t totalRead = receiver->mReceiver.receive(socket, wouldBlock, errorCode);
+
+          if (0 == totalRead) {
+            if (0 != errorCode) {
+              ZS_LOG_WARNING(Debug, log("socket read error") + ZS_PARAM("socket", string(socket)) + ZS_PARAM("error", errorCode))
+            } else if (wouldBlock) {
+              ZS_LOG_INSANE(log("socket read would block") + ZS_PARAM("socket", string(socket)))
+            } else {
+              ZS_LOG_WARNING(Debug, log("failed to read any data from socket") + ZS_PARAM("socket", string(socket)))
+            }
+            return false;
+          }
+
+          readMore = receiver->mReceiver.moreMayBePending();
+
+          demuxUDPDatagrams(receiver->mReceiver.datagrams(), totalRead, packets);
+        }
+
+        // only the STUN parse and the relay lookups need the gatherer's state
+        {
+          AutoRecursiveLock lock(*this);
+          classifyUDPDatagrams(*hostPort, packets);
+        }
+
+        for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+          handleIncomingUDPPacket(hostPort, socket, *iter);
+        }
+        return readMore;
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::installIncomingTCPPort(
+                                             HostPortPtr hostPort,
+                                             TCPPortPtr tcpPort
+                                             )
+    {
+      EventWriteOrtcIceGathererTcpPortCreate(__func__, mID, tcpPort->mID, tcpPort->mRemoteIP.string());
+
+      // create mappings for this socket
+      mTCPPorts[tcpPort->mSocket] = HostAndTCPPortPair(hostPort, tcpPort);
+      hostPort->mTCPPorts[tcpPort->mSocket] = HostAndTCPPortPair(hostPort, tcpPort);
+
+      tcpPort->mSocket->setDelegate(mThisWeak.lock());
+
+      tcpPort->mCandidate = hostPort->mCandidateTCPPassive;
+
+      mTCPCandidateToTCPPorts[tcpPort->mCandidate] = tcpPort;
+
+      ZS_LOG_DEBUG(log("incoming connection ready") + hostPort->toDebug() + tcpPort->toDebug())
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::demuxUDPDatagrams(
+                                        UDPBatchReceiver::DatagramList &datagrams,
+                                        size_t totalDatagrams,
+                                        IncomingUDPPacketList &outPackets
+                                        )
+    {
+      outPackets.resize(totalDatagrams);
+
+      for (size_t index = 0; index < totalDatagrams; ++index) {
+        auto &packet = outPackets[index];
+        packet.mDatagram = std::move(datagrams[index]);
+
+        auto &datagram = packet.mDatagram;
+        const BYTE *buffer = datagram.mBuffer->BytePtr();
+
+        EventWriteOrtcIceGathererUdpSocketPacketReceivedFrom(__func__, mID, datagram.mFromIP.string(), SafeInt<unsigned int>(datagram.mSize), buffer);
+
+        packet.mPacketType = PacketDemux::classify(buffer, datagram.mSize);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::classifyUDPDatagrams(
+                                           HostPort &hostPort,
+                                           IncomingUDPPacketList &packets
+                                           )
+    {
+      // consecutive datagrams tend to come from the same remote so the
+      // relay mapping lookup is only repeated when the remote changes
+      const IPAddress *lastFromIP = NULL;
+      RelayPortPtr lastRelayPort;
+      UseTURNSocketPtr lastTURNSocket;
+      bool lastWasRelay = false;
+
+      for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+        auto &packet = (*iter);
+
+        auto &datagram = packet.mDatagram;
+        const BYTE *buffer = datagram.mBuffer->BytePtr();
+
+        ZS_LOG_INSANE(log("receiving incoming packet") + ZS_PARAM("from ip", datagram.mFromIP.string()) + ZS_PARAM("read", datagram.mSize) + hostPort.toDebug())
+
+        // media never needs to touch the STUN parser
+        if (PacketDemux::isSTUNCandidate(packet.mPacketType, buffer, datagram.mSize)) {
+          packet.mSTUNPacket = STUNPacket::parseIfSTUN(buffer, datagram.mSize, mSTUNPacketParseOptions);
+          fixSTUNParserOptions(packet.mSTUNPacket);
+        }
+
+        if ((!lastFromIP) ||
+            (*lastFromIP != datagram.mFromIP)) {
+          lastFromIP = &(datagram.mFromIP);
+          lastRelayPort.reset();
+          lastTURNSocket.reset();
+          lastWasRelay = false;
+
+          auto found = hostPort.mIPToRelayPortMapping.find(datagram.mFromIP);
+          if (found != hostPort.mIPToRelayPortMapping.end()) {
+            auto relayPort = (*found).second;
+            lastWasRelay = true;
+            lastRelayPort = relayPort;
+            lastTURNSocket = relayPort->mTURNSocket;
+            if (!lastTURNSocket) {
+              ZS_LOG_WARNING(Detail, log("TURN socket was not found despite mapping being found") + relayPort->toDebug())
+            }
+          }
+        }
+
+        if (lastWasRelay) {
+          packet.mTURNSocket = lastTURNSocket;
+          if (PacketDemux::PacketType_TURNChannelData == packet.mPacketType) {
+            resolveTURNChannelData(lastRelayPort, packet);
+          }
+          continue;
+        }
+
+        // this is not a relay socket, see if there is a route
+        packet.mLocalCandidate = hostPort.mCandidateUDP;
+        if (!packet.mLocalCandidate) {
+          ZS_LOG_WARNING(Trace, log("did not find local candidate"))
+        }
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::handleIncomingUDPPacket(
+                                              HostPortPtr hostPort,
+                                              SocketPtr socket,
+                                              IncomingUDPPacket &packet
+                                              )
+    {
+      const IPAddress &fromIP = packet.mDatagram.mFromIP;
+      const BYTE *buffer = packet.mDatagram.mBuffer->BytePtr();
+      size_t totalRead = packet.mDatagram.mSize;
+
+      auto &stunPacket = packet.mSTUNPacket;
+      auto &turnSocket = packet.mTURNSocket;
+      auto &localCandidate = packet.mLocalCandidate;
+
+      if (packet.mTURNChannel) goto found_turn_channel;
+      if (turnSocket) goto found_relay_port;
+      if (localCandidate) goto handle_incoming;
+
+      goto unknown_handler;
+
+    unknown_handler:
+      {
+        if (stunPacket) {
+          if (ISTUNRequester::handleSTUNPacket(fromIP, stunPacket)) {
+            ZS_LOG_TRACE(log("handled by stun requester") + ZS_PARAM("from ip", fromIP.string()) + stunPacket->toDebug())
+            return;
+          }
+        }
+        return;
+      }
+
+    found_relay_port:
+      {
+        EventWriteOrtcIceGathererUdpSocketPacketForwardingToTurnSocket(__func__, mID, fromIP.string(), ((bool)stunPacket), SafeInt<unsigned int>(totalRead), buffer);
+
+        if (stunPacket) {
+          if (ISTUNRequester::handleSTUNPacket(fromIP, stunPacket)) {
+            ZS_LOG_TRACE(log("handled by stun requester") + ZS_PARAM("from ip", fromIP.string()) + stunPacket->toDebug())
+            return;
           }
 
           ZS_LOG_INSANE(log("forwarding stun packet to turn socket") + ZS_PARAM("from ip", fromIP.string()) + stunPacket->toDebug())
           turnSocket->handleSTUNPacket(fromIP, stunPacket);
-          return true;
+          return;
         }
 
         ZS_LOG_INSANE(log("forwarding turn channel data to turn socket") + ZS_PARAM("from ip", fromIP.string()) + ZS_PARAM("total", totalRead))
-        turnSocket->handleChannelData(fromIP, &(readBuffer[0]), totalRead);
-        return true;
+        turnSocket->handleChannelData(fromIP, buffer, totalRead);
+        return;
+      }
+
+    found_turn_channel:
+      {
+        // channel data was unwrapped in place (no STUN decode of the datagram)
+        const IPAddress &peerIP = packet.mTURNChannel->mPeerIP;
+        const BYTE *payload = buffer + packet.mPayloadOffset;
+        size_t payloadSize = packet.mPayloadSize;
+
+        if (stunPacket) {
+          if (ISTUNRequester::handleSTUNPacket(peerIP, stunPacket)) {
+            ZS_LOG_TRACE(log("handled by stun requester") + ZS_PARAM("peer ip", peerIP.string()) + stunPacket->toDebug())
+            return;
+          }
+
+          ZS_LOG_INSANE(log("handling incoming stun packet from turn channel") + localCandidate->toDebug() + ZS_PARAM("peer ip", peerIP.string()) + stunPacket->toDebug())
+          auto response = handleIncomingPacket(localCandidate, peerIP, stunPacket, payload, payloadSize);
+          if (response) {
+            AutoRecursiveLock lock(*this);
+
+            auto result = sendTURNChannelData(*(packet.mRelayPort), *(packet.mTURNChannel), *response, response->SizeInBytes());
+            if (!result) {
+              ZS_LOG_WARNING(Debug, log("failed to send response packet over turn channel") + packet.mTURNChannel->toDebug() + stunPacket->toDebug())
+            }
+          }
+          return;
+        }
+
+        ZS_LOG_INSANE(log("handling incoming packet from turn channel") + localCandidate->toDebug() + ZS_PARAM("peer ip", peerIP.string()) + ZS_PARAM("total", payloadSize))
+        handleIncomingPacket(localCandidate, peerIP, packet.mPacketType, payload, payloadSize);
+        return;
       }
 
     handle_incoming:
@@ -5114,11 +5944,16 @@ namespace ortc
         if (stunPacket) {
           if (ISTUNRequester::handleSTUNPacket(fromIP, stunPacket)) {
             ZS_LOG_TRACE(log("handled by stun requester") + ZS_PARAM("from ip", fromIP.string()) + stunPacket->toDebug())
-            return true;
+            return;
           }
 
           ZS_LOG_INSANE(log("handling incoming stun packet") + localCandidate->toDebug() + ZS_PARAM("from ip", fromIP.string()) + stunPacket->toDebug())
-          auto response = handleIncomingPacket(localCandidate, fromIP, stunPacket);
+          bool integrityPassed = false;
+          auto response = handleIncomingPacket(localCandidate, fromIP, stunPacket, buffer, totalRead, &integrityPassed);
+          if ((STUNPacket::Class_Request == stunPacket->mClass) &&
+              (STUNPacket::Method_Binding == stunPacket->mMethod)) {
+            validateSharedRoute(hostPort, fromIP, integrityPassed);
+          }
           if (response) {
             AutoRecursiveLock lock(*this);
 
@@ -5131,11 +5966,10 @@ namespace ortc
               ZS_LOG_WARNING(Debug, log("cannot send response as socket is gone") + localCandidate->toDebug() + ZS_PARAM("from ip", fromIP.string()) + stunPacket->toDebug())
             }
           }
-          return true;
+          return;
         }
         ZS_LOG_INSANE(log("handling incoming packet") + localCandidate->toDebug() + ZS_PARAM("from ip", fromIP.string()) + ZS_PARAM("total", totalRead))
-        handleIncomingPacket(localCandidate, fromIP, &(readBuffer[0]), totalRead);
-        return true;
+        handleIncomingPacket(localCandidate, fromIP, packet.mPacketType, buffer, totalRead);
       }
     }
 
@@ -5145,113 +5979,87 @@ namespace ortc
                            TCPPort &tcpPort
                            )
     {
-      BufferedPacketList packets;
-
       CandidatePtr localCandidate;
       IPAddress fromIP;
 
+      IncomingTCPFrameList frames;
+
+      while (true)
       {
-        AutoRecursiveLock lock(*this);
+        SecureByteBlockPtr ring;  // keeps the slices valid even if the port is closed while they are handled
+
+        frames.clear();
 
-        while (true)
         {
+          AutoRecursiveLock lock(*this);
+
           if (!tcpPort.mSocket) {
             ZS_LOG_WARNING(Detail, log("cannot read closed socket") + tcpPort.toDebug())
             return;
           }
 
-          BYTE buffer[4096] {};
-
-          try {
-            bool wouldBlock = false;
-            size_t read = tcpPort.mSocket->receive(&(buffer[0]), sizeof(buffer), &wouldBlock);
-            if (0 == read) goto process_packets;
-
-            tcpPort.mIncomingBuffer.Put(&(buffer[0]), read);
-          } catch(Socket::Exceptions::Unspecified &error) {
-            ZS_LOG_ERROR(Detail, log("unable to receive from socket") + ZS_PARAM("error", error.errorCode()) + tcpPort.toDebug())
-            goto process_packets;
+          bool wouldBlock = false;
+          int errorCode = 0;
+          size_t read = tcpPort.mReader.receive(tcpPort.mSocket, wouldBlock, errorCode);
+          if (0 != errorCode) {
+            ZS_LOG_ERROR(Detail, log("unable to receive from socket") + ZS_PARAM("error", errorCode) + tcpPort.toDebug())
+            return;
           }
+          if (0 == read) return;
 
-          while (true) {
-            auto currentSize = tcpPort.mIncomingBuffer.CurrentSize();
-
-            CryptoPP::word16 packetSize {};
-
-            if (currentSize < sizeof(packetSize)) goto nothing_more_to_parse;
-
-            // peak ahead to see if the entire packet has arrived
-            tcpPort.mIncomingBuffer.PeekWord16(packetSize);
+          localCandidate = tcpPort.mCandidate;
+          fromIP = tcpPort.mRemoteIP;
+          ring = tcpPort.mReader.buffer();
 
-            if (currentSize < sizeof(packetSize) + packetSize) goto nothing_more_to_parse;
+          auto &received = tcpPort.mReader.frames();
+          for (auto iter = received.begin(); iter != received.end(); ++iter) {
+            auto &slice = (*iter);
 
-            tcpPort.mIncomingBuffer.Skip(sizeof(packetSize));
+            IncomingTCPFrame frame;
+            frame.mBuffer = slice.mBuffer;
+            frame.mSize = slice.mSize;
 
-            // now have enough to extract out of buffer
+            EventWriteOrtcIceGathererTcpSocketPacketReceivedFrom(__func__, mID, tcpPort.mRemoteIP.string(), frame.mSize, frame.mBuffer);
 
-            BufferedPacketPtr packet(make_shared<BufferedPacket>());
-            packet->mBuffer = make_shared<SecureByteBlock>(packetSize);
-            if (!localCandidate) {
-              localCandidate = tcpPort.mCandidate;
-              fromIP = tcpPort.mRemoteIP;
+            frame.mPacketType = PacketDemux::classify(frame.mBuffer, frame.mSize);
+            if (PacketDemux::isSTUNCandidate(frame.mPacketType, frame.mBuffer, frame.mSize)) {
+              frame.mSTUNPacket = STUNPacket::parseIfSTUN(frame.mBuffer, frame.mSize, mSTUNPacketParseOptions);
+              fixSTUNParserOptions(frame.mSTUNPacket);
             }
 
-            // fill packet with incoming data
-            tcpPort.mIncomingBuffer.Get(*(packet->mBuffer), packetSize);
-
-            EventWriteOrtcIceGathererTcpSocketPacketReceivedFrom(__func__, mID, tcpPort.mRemoteIP.string(), packetSize, packet->mBuffer->BytePtr());
-
-            packet->mSTUNPacket = STUNPacket::parseIfSTUN(*(packet->mBuffer), packet->mBuffer->SizeInBytes(), mSTUNPacketParseOptions);
-            fixSTUNParserOptions(packet->mSTUNPacket);
-
-            packets.push_back(packet);
+            frames.push_back(frame);
           }
 
-        nothing_more_to_parse:
-          {
-            ZS_LOG_INSANE(log("nothing more to parse at this time") + ZS_PARAM("packets found", packets.size()) + tcpPort.toDebug())
-          }
+          ZS_LOG_INSANE(log("nothing more to parse at this time") + ZS_PARAM("packets found", frames.size()) + ZS_PARAM("read", read) + tcpPort.toDebug())
         }
-      }
 
-    process_packets:
-      {
-        for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
-          auto packet = (*iter);
+        // the slices must be handled before the next receive() reuses the ring
+        for (auto iter = frames.begin(); iter != frames.end(); ++iter) {
+          auto &frame = (*iter);
 
-          if (packet->mSTUNPacket) {
-            if (ISTUNRequester::handleSTUNPacket(fromIP, packet->mSTUNPacket)) {
-              ZS_LOG_TRACE(log("handled by stun requester") + ZS_PARAM("from ip", fromIP.string()) + packet->mSTUNPacket->toDebug())
+          if (frame.mSTUNPacket) {
+            if (ISTUNRequester::handleSTUNPacket(fromIP, frame.mSTUNPacket)) {
+              ZS_LOG_TRACE(log("handled by stun requester") + ZS_PARAM("from ip", fromIP.string()) + frame.mSTUNPacket->toDebug())
               continue;
             }
 
-            ZS_LOG_TRACE(log("handling incoming TCP stun packet") + packet->toDebug() + packet->mSTUNPacket->toDebug())
+            ZS_LOG_TRACE(log("handling incoming TCP stun packet") + ZS_PARAM("size", frame.mSize) + frame.mSTUNPacket->toDebug())
 
-            auto response = handleIncomingPacket(localCandidate, fromIP, packet->mSTUNPacket);
+            auto response = handleIncomingPacket(localCandidate, fromIP, frame.mSTUNPacket, frame.mBuffer, frame.mSize);
             if (response) {
               AutoRecursiveLock lock(*this);
               if (tcpPort.mSocket) {
                 ZS_LOG_TRACE(log("sending packet response by putting into TCP send queue") + tcpPort.toDebug())
-                // put the buffer at the end of the queue
-
-                CryptoPP::word16 packeSize = ((CryptoPP::word16)(response->SizeInBytes()));
-
-                tcpPort.mOutgoingBuffer.PutWord16(packeSize);
-                tcpPort.mOutgoingBuffer.Put(*response, response->SizeInBytes());
-                if ((tcpPort.mConnected) &&
-                    (tcpPort.mWriteReady)) {
-                  ZS_LOG_INSANE(log("simulate TCP write ready to force the packet to send immediately"))
-                  ISocketDelegateProxy::create(mThisWeak.lock())->onWriteReady(tcpPort.mSocket);
-                }
+                sendTCPFrame(tcpPort, *response, response->SizeInBytes());
               } else {
-                ZS_LOG_WARNING(Debug, log("socket is now gone thus response cannot be sent") + tcpPort.toDebug() + ZS_PARAM("from ip", fromIP.string()) + packet->mSTUNPacket->toDebug())
+                ZS_LOG_WARNING(Debug, log("socket is now gone thus response cannot be sent") + tcpPort.toDebug() + ZS_PARAM("from ip", fromIP.string()) + frame.mSTUNPacket->toDebug())
               }
             }
             continue;
           }
 
-          ZS_LOG_INSANE(log("handling incoming TCP packet") + packet->toDebug())
-          handleIncomingPacket(localCandidate, fromIP, *(packet->mBuffer), packet->mBuffer->SizeInBytes());
+          ZS_LOG_INSANE(log("handling incoming TCP packet") + ZS_PARAM("size", frame.mSize) + ZS_PARAM("from ip", fromIP.string()))
+          handleIncomingPacket(localCandidate, fromIP, frame.mPacketType, frame.mBuffer, frame.mSize);
         }
       }
     }
@@ -5303,40 +6111,58 @@ namespace ortc
       }
 
       while (true) {
-        size_t currentSize = static_cast<size_t>(tcpPort.mOutgoingBuffer.CurrentSize());
-        if (0 == currentSize) {
+        if (0 == tcpPort.mWriter.pending()) {
           ZS_LOG_INSANE(log("nothing more to send") + tcpPort.toDebug())
           goto finished_write;
         }
 
-        try {
-          if (currentSize > 0xFFFF + sizeof(CryptoPP::word16)) currentSize = 0xFFFF + sizeof(CryptoPP::word16);
+        // everything queued goes out in one gathered send
+        bool wouldBlock = false;
+        int errorCode = 0;
+        auto sent = tcpPort.mWriter.flush(tcpPort.mSocket, wouldBlock, errorCode);
 
-          SecureByteBlock buffer(currentSize);
-          tcpPort.mOutgoingBuffer.Peek(buffer, currentSize);
+        if (0 != errorCode) {
+          ZS_LOG_ERROR(Detail, log("unable to send to socket") + ZS_PARAM("error", errorCode) + tcpPort.toDebug())
+          goto finished_write;
+        }
 
-          bool wouldBlock = false;
-          auto sent = tcpPort.mSocket->send(buffer, currentSize, &wouldBlock);
+        if (0 == sent) {
+          ZS_LOG_INSANE(log("no more room to send data") + tcpPort.toDebug())
+          tcpPort.mWriteReady = false;
+          goto finished_write;
+        }
 
-          if (0 == sent) {
-            ZS_LOG_INSANE(log("no more room to send data") + tcpPort.toDebug())
-            tcpPort.mWriteReady = false;
-            goto finished_write;
-          }
+        ZS_LOG_INSANE(log("sent TCP data to remote party") + tcpPort.toDebug() + ZS_PARAM("sent", sent))
+      }
 
-          EventWriteOrtcIceGathererTcpSocketSentOutgoing(__func__, mID, tcpPort.mRemoteIP.string(), SafeInt<unsigned int>(sent), buffer.BytePtr());
+    finished_write: {}
+      return true;
+    }
 
-          ZS_LOG_INSANE(log("sent TCP data to remote party") + tcpPort.toDebug() + ZS_PARAM("sent", sent))
+    //-------------------------------------------------------------------------
+    bool ICEGatherer::sendTCPFrame(
+                                   TCPPort &tcpPort,
+                                   const BYTE *buffer,
+                                   size_t bufferSizeInBytes
+                                   )
+    {
+      bool wasIdle = (0 == tcpPort.mWriter.pending());
 
-          // consume the amount sent from the pending queue (and try sending more)
-          tcpPort.mOutgoingBuffer.Skip(sent);
-        } catch(Socket::Exceptions::Unspecified &error) {
-          ZS_LOG_ERROR(Detail, log("unable to send to socket") + ZS_PARAM("error", error.errorCode()) + tcpPort.toDebug())
-          goto finished_write;
-        }
+      if (!tcpPort.mWriter.add(buffer, bufferSizeInBytes)) {
+        ZS_LOG_WARNING(Debug, log("packet too large to frame on TCP") + tcpPort.toDebug() + ZS_PARAM("buffer size", bufferSizeInBytes))
+        return false;
       }
 
-    finished_write: {}
+      EventWriteOrtcIceGathererTcpSocketSentOutgoing(__func__, mID, tcpPort.mRemoteIP.string(), SafeInt<unsigned int>(bufferSizeInBytes), buffer);
+
+      // packets queued before the (asynchronous) write ready fires are
+      // coalesced into the same send
+      if ((tcpPort.mConnected) &&
+          (wasIdle) &&
+          (tcpPort.mWriteReady)) {
+        ZS_LOG_INSANE(log("simulate write ready for TCP socket (to ensure packet is sent out straight away)"))
+        ISocketDelegateProxy::create(mThisWeak.lock())->onWriteReady(tcpPort.mSocket);
+      }
       return true;
     }
 
@@ -5349,6 +6175,20 @@ namespace ortc
       ZS_THROW_INVALID_ARGUMENT_IF(!hostPort)
       AutoRecursiveLock lock(*this);
 
+      {
+        auto &shards = hostPort->mBoundUDPShardSockets;
+        auto found = std::find(shards.begin(), shards.end(), socket);
+        if (found != shards.end()) {
+          // the primary socket (and the candidate) remain usable
+          ZS_LOG_WARNING(Detail, log("UDP shard socket unexpectedly closed") + hostPort->toDebug() + ZS_PARAM("socket", string(socket)))
+          shards.erase(found);
+          mHostPortSockets.erase(socket);
+          removeUDPReceiver(*hostPort, socket);
+          closeUDPSocket(socket);
+          return;
+        }
+      }
+
       if ((hostPort->mBoundUDPSocket != socket) &&
           (hostPort->mBoundTCPSocket != socket)) {
         ZS_LOG_WARNING(Detail, log("socket was not found on host port") + hostPort->toDebug() + ZS_PARAM("socket", string(socket)))
@@ -5370,6 +6210,19 @@ namespace ortc
         mHostPortSockets.erase(found);
       }
 
+      if (hostPort->mBoundUDPSocket == socket) {
+        // shards share the primary socket's port so they must go with it
+        for (auto iter = hostPort->mBoundUDPShardSockets.begin(); iter != hostPort->mBoundUDPShardSockets.end(); ++iter) {
+          auto shardSocket = (*iter);
+          mHostPortSockets.erase(shardSocket);
+          removeUDPReceiver(*hostPort, shardSocket);
+          closeUDPSocket(shardSocket);
+        }
+        hostPort->mBoundUDPShardSockets.clear();
+        SocketReactor::unmonitor(socket);
+        removeUDPReceiver(*hostPort, socket);
+      }
+
       try {
         socket->close();
       } catch(Socket::Exceptions::Unspecified &error) {
@@ -5414,9 +6267,14 @@ namespace ortc
     SecureByteBlockPtr ICEGatherer::handleIncomingPacket(
                                                          CandidatePtr localCandidate,
                                                          const IPAddress &remoteIP,
-                                                         STUNPacketPtr stunPacket
+                                                         STUNPacketPtr stunPacket,
+                                                         const BYTE *buffer,
+                                                         size_t bufferSizeInBytes,
+                                                         bool *outIntegrityPassed
                                                          )
     {
+      if (outIntegrityPassed) *outIntegrityPassed = false;
+
       RoutePtr route;
       RouterRoutePtr routerRoute;
       UseICETransportPtr transport;
@@ -5461,19 +6319,21 @@ namespace ortc
             goto stun_failed_validation;
           }
 
-          if (!stunPacket->isValidMessageIntegrity(mPassword)) {
+          if (!mMessageIntegrity->isValid(buffer, bufferSizeInBytes)) {
             if (!stunPacket->hasAttribute(STUNPacket::Attribute_MSICE2_ImplementationVersion)) {
               ZS_LOG_WARNING(Debug, log("stun packet does pass message integrity") + ZS_PARAM("password", mPassword) + stunPacket->toDebug());
               goto stun_failed_validation;
             }
             stunPacket->mOptions.mCalculateMessageIntegrityUsingFinalMessageSize = true;
             stunPacket->mOptions.mZeroPadMessageIntegrityInputToBlockSize = 64;
-            if (!stunPacket->isValidMessageIntegrity(mPassword)) {
+            if (!mMessageIntegrity->isValid(buffer, bufferSizeInBytes, true, 64)) {
               ZS_LOG_WARNING(Debug, log("stun packet does pass MSICE message integrity") + ZS_PARAM("password", mPassword) + stunPacket->toDebug());
               goto stun_failed_validation;
             }
           }
 
+          if (outIntegrityPassed) *outIntegrityPassed = true;
+
           auto found = mInstalledTransports.find(rFrag);
           if (found == mInstalledTransports.end()) goto buffer_data_now;
 
@@ -5521,7 +6381,7 @@ namespace ortc
 
         ZS_LOG_ERROR(Debug, log("candidate password integrity failed") + ZS_PARAM("request", stunPacket->toDebug()) + ZS_PARAM("reply", response->toDebug()))
         response->trace(__func__);
-        return response->packetize(STUNPacket::RFC_5245_ICE);
+        return mMessageIntegrity->packetize(response);
       }
 
     buffer_data_now:
@@ -5559,6 +6419,7 @@ namespace ortc
     void ICEGatherer::handleIncomingPacket(
                                            CandidatePtr localCandidate,
                                            const IPAddress &remoteIP,
+                                           PacketDemux::PacketTypes packetType,
                                            const BYTE *buffer,
                                            size_t bufferSizeInBytes
                                            )
@@ -5588,7 +6449,8 @@ namespace ortc
       {
         ZS_LOG_DEBUG(log("forwarding data packet to ice transport") + ZS_PARAM("transport", transport->getID()) +  ZS_PARAM("from ip", remoteIP.string()) + ZS_PARAM("size", bufferSizeInBytes))
         EventWriteOrtcIceGathererDeliverIceTransportIncomingPacket(__func__, mID, transport->getID(), route->mID, routerRoute->mID, false, SafeInt<unsigned int>(bufferSizeInBytes), buffer);
-        transport->notifyPacket(routerRoute, buffer, bufferSizeInBytes);
+        transport->notifyPacket(routerRoute, packetType, buffer, bufferSizeInBytes);
+        return;
       }
 
     buffer_data_now:
@@ -5606,7 +6468,10 @@ namespace ortc
         BufferedPacketPtr packet(make_shared<BufferedPacket>());
         packet->mTimestamp = zsLib::now();
         packet->mRouterRoute = routerRoute;
-        packet->mBuffer = UseServicesHelper::convertToBuffer(buffer, bufferSizeInBytes);
+        packet->mPacketType = packetType;
+        packet->mBuffer = UseBufferPool::allocate(bufferSizeInBytes);
+        packet->mBufferSize = bufferSizeInBytes;
+        memcpy(packet->mBuffer->BytePtr(), buffer, bufferSizeInBytes);
 
         EventWriteOrtcIceGathererBufferIceTransportIncomingPacket(__func__, mID, routerRoute->mID, SafeInt<unsigned int>(bufferSizeInBytes), buffer);
 
@@ -5753,18 +6618,14 @@ namespace ortc
                                                     UseICETransportPtr transport
                                                     )
     {
-      LocalCandidateRemoteIPPair search(sentFromLocalCandidate, remoteIP);
-
       RoutePtr route;
 
       // see if route already exists
       {
-        auto found = mQuickSearchRoutes.find(search);
-        EventWriteOrtcIceGathererSearchQuickRoute(__func__, mID, sentFromLocalCandidate.get(), remoteIP.string(), found != mQuickSearchRoutes.end());
-        if (found == mQuickSearchRoutes.end()) goto create_new_route;
+        route = findQuickSearchRoute(sentFromLocalCandidate, remoteIP);
+        if (!route) goto create_new_route;
 
         // found a route mapping
-        route = (*found).second;
         auto foundTransport = route->mTransport.lock();
 
         if (!foundTransport) goto remove_existing_route;
@@ -5795,6 +6656,7 @@ namespace ortc
         route->mOuterObjectID = mID;
         route->mLastUsed = zsLib::now();
         route->mLocalCandidate = sentFromLocalCandidate;
+        route->mQuickSearchCandidate = sentFromLocalCandidate;
         route->mTransportID = transport->getID();
         route->mTransport = transport;
 
@@ -5944,10 +6806,12 @@ namespace ortc
 
           ZS_LOG_TRACE(log("installing route") + route->toDebug())
 
-          EventWriteOrtcIceGathererInstallQuickRoute(__func__, mID, search.first.get(), search.second.string(), route->mID);
+          EventWriteOrtcIceGathererInstallQuickRoute(__func__, mID, sentFromLocalCandidate.get(), remoteIP.string(), route->mID);
 
           mRoutes[route->mRouterRoute->mID] = route;
-          mQuickSearchRoutes[search] = route;
+          mQuickSearchRoutes[toQuickSearchRouteKey(sentFromLocalCandidate, remoteIP)].push_back(route);
+
+          addSharedRoute(route->mHostPort, remoteIP);
 
           IGathererAsyncDelegateProxy::create(mThisWeak.lock())->onNotifyDeliverRouteBufferedPackets(transport, route->mRouterRoute->mID);
           return route;
@@ -5963,6 +6827,64 @@ namespace ortc
       return route;
     }
 
+    //-----------------------------------------------------------------------
+    ICEGatherer::QuickSearchRouteKey ICEGatherer::toQuickSearchRouteKey(
+                                                                        CandidatePtr localCandidate,
+                                                                        const IPAddress &remoteIP
+                                                                        )
+    {
+      // local candidates are owned by the gatherer and never change identity
+      // thus the candidate object is its own compact identifier (avoiding
+      // the need to hash the candidate's content on each incoming packet)
+      return ICEGathererRouter::toRouteKey(static_cast<QWORD>(reinterpret_cast<uintptr_t>(localCandidate.get())), remoteIP);
+    }
+
+    //-----------------------------------------------------------------------
+    ICEGatherer::RoutePtr ICEGatherer::findQuickSearchRoute(
+                                                            CandidatePtr localCandidate,
+                                                            const IPAddress &remoteIP
+                                                            ) const
+    {
+      auto found = mQuickSearchRoutes.find(toQuickSearchRouteKey(localCandidate, remoteIP));
+      if (found != mQuickSearchRoutes.end()) {
+        auto &routes = (*found).second;
+        for (auto iter = routes.begin(); iter != routes.end(); ++iter) {
+          auto &route = (*iter);
+          if (route->mQuickSearchCandidate != localCandidate) continue;
+          if (route->mRouterRoute->mRemoteIP != remoteIP) continue;
+
+          EventWriteOrtcIceGathererSearchQuickRoute(__func__, mID, localCandidate.get(), NULL, true);
+          return route;
+        }
+      }
+
+      EventWriteOrtcIceGathererSearchQuickRoute(__func__, mID, localCandidate.get(), remoteIP.string(), false);
+      return RoutePtr();
+    }
+
+    //-----------------------------------------------------------------------
+    void ICEGatherer::removeQuickSearchRoute(RoutePtr route)
+    {
+      auto found = mQuickSearchRoutes.find(toQuickSearchRouteKey(route->mQuickSearchCandidate, route->mRouterRoute->mRemoteIP));
+      if (found == mQuickSearchRoutes.end()) {
+        ZS_LOG_WARNING(Detail, log("quick route is not found") + route->toDebug())
+        return;
+      }
+
+      auto &routes = (*found).second;
+      for (auto iter = routes.begin(); iter != routes.end(); ++iter) {
+        if ((*iter) != route) continue;
+
+        EventWriteOrtcIceGathererRemoveQuickRoute(__func__, mID, route->mQuickSearchCandidate.get(), route->mRouterRoute->mRemoteIP.string(), route->mID);
+
+        routes.erase(iter);
+        if (routes.size() < 1) mQuickSearchRoutes.erase(found);
+        return;
+      }
+
+      ZS_LOG_WARNING(Detail, log("quick route is not found") + route->toDebug())
+    }
+
     //-----------------------------------------------------------------------
     void ICEGatherer::fix(STUNPacketPtr stun) const
     {
@@ -5981,14 +6903,25 @@ namespace ortc
         auto current = iter_doNotUse;
         ++iter_doNotUse;
 
-        auto route = (*current).second;
-        if (route->mTransportID != transportID) continue;
+        auto &routes = (*current).second;
+        for (auto iterRoute_doNotUse = routes.begin(); iterRoute_doNotUse != routes.end(); )
+        {
+          auto route = (*iterRoute_doNotUse);
+          if (route->mTransportID != transportID) {
+            ++iterRoute_doNotUse;
+            continue;
+          }
 
-        EventWriteOrtcIceGathererRemoveQuickRoute(__func__, mID, (*current).first.first.get(), (*current).first.second.string(), route->mID);
+          EventWriteOrtcIceGathererRemoveQuickRoute(__func__, mID, route->mQuickSearchCandidate.get(), route->mRouterRoute->mRemoteIP.string(), route->mID);
 
-        ZS_LOG_WARNING(Detail, log("need to remove route because of unbinding previous transport") + route->toDebug())
+          ZS_LOG_WARNING(Detail, log("need to remove route because of unbinding previous transport") + route->toDebug())
 
-        mQuickSearchRoutes.erase(current);
+          iterRoute_doNotUse = routes.erase(iterRoute_doNotUse);
+        }
+
+        if (routes.size() < 1) {
+          mQuickSearchRoutes.erase(current);
+        }
       }
 
       for (auto iter_doNotUse = mRoutes.begin(); iter_doNotUse != mRoutes.end();)
@@ -6029,6 +6962,9 @@ namespace ortc
         ZS_LOG_INSANE(log("packet sent") + ZS_PARAM("socket", string(socket)) + ZS_PARAM("to", remoteIP.string()) + ZS_PARAM("from", boundIP.string()) + ZS_PARAM("size", bufferSizeInBytes))
 
         if (sent == bufferSizeInBytes) return true;
+
+        // reactor monitored sockets only report write ready when asked
+        if (wouldBlock) SocketReactor::monitorWriteReady(socket);
       } catch(Socket::Exceptions::Unspecified &error) {
         ZS_LOG_ERROR(Debug, log("unable to send packet") + ZS_PARAM("error", error.errorCode()) + ZS_PARAM("to", remoteIP.string()) + ZS_PARAM("from", boundIP.string()))
         return false;
@@ -6038,6 +6974,306 @@ namespace ortc
       return false;
     }
 
+    //-------------------------------------------------------------------------
+    bool ICEGatherer::sendUDPPackets(
+                                     HostPort &hostPort,
+                                     SocketPtr socket,
+                                     const IPAddress &boundIP,
+                                     const IPAddress &remoteIP,
+                                     const UDPBatchSender::PacketList &packets
+                                     )
+    {
+      if (!socket) return false;
+
+      for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+        auto &packet = (*iter);
+        EventWriteOrtcIceGathererUdpSocketPacketSentTo(__func__, mID, boundIP.string(), remoteIP.string(), SafeInt<unsigned int>(packet.mSize), packet.mBuffer);
+      }
+
+      bool wouldBlock = false;
+      int errorCode = 0;
+      size_t sent = 0;
+
+      {
+        AutoLock lock(hostPort.mUDPSendLock);
+
+        hostPort.mUDPBatchSender.add(remoteIP, packets);
+        sent = hostPort.mUDPBatchSender.flush(socket, boundIP, wouldBlock, errorCode);
+      }
+
+      ZS_LOG_INSANE(log("packets sent") + ZS_PARAM("socket", string(socket)) + ZS_PARAM("to", remoteIP.string()) + ZS_PARAM("from", boundIP.string()) + ZS_PARAM("sent", sent) + ZS_PARAM("total", packets.size()))
+
+      if (sent == packets.size()) return true;
+
+      if (0 != errorCode) {
+        ZS_LOG_ERROR(Debug, log("unable to send packets") + ZS_PARAM("error", errorCode) + ZS_PARAM("to", remoteIP.string()) + ZS_PARAM("from", boundIP.string()) + ZS_PARAM("sent", sent) + ZS_PARAM("total", packets.size()))
+        return false;
+      }
+
+      ZS_LOG_WARNING(Trace, log("could not send all packets at this time") + ZS_PARAM("socket", string(socket)) + ZS_PARAM("to", remoteIP.string()) + ZS_PARAM("from", boundIP.string()) + ZS_PARAM("sent", sent) + ZS_PARAM("total", packets.size()) + ZS_PARAM("would block", wouldBlock))
+      if (wouldBlock) SocketReactor::monitorWriteReady(socket);
+      return false;
+    }
+
+    //-------------------------------------------------------------------------
+    ICEGatherer::TURNChannelPtr ICEGatherer::findTURNChannel(
+                                                             RelayPortPtr relayPort,
+                                                             const IPAddress &peerIP,
+                                                             bool bindIfMissing
+                                                             )
+    {
+      if (relayPort->mServerResponseIP.isAddressEmpty()) return TURNChannelPtr();
+
+      {
+        auto found = relayPort->mPeerChannels.find(peerIP);
+        if (found != relayPort->mPeerChannels.end()) {
+          auto channel = (*found).second;
+          channel->mLastUsed = zsLib::now();
+          if (channel->mBound) return channel;
+          return TURNChannelPtr();
+        }
+      }
+
+      if (!bindIfMissing) return TURNChannelPtr();
+
+      auto totalNumbers = static_cast<size_t>(PacketDemux::kTURNChannelNumberLast - PacketDemux::kTURNChannelNumberFirst) + 1;
+      if (relayPort->mChannelNumbers.size() >= totalNumbers) {
+        ZS_LOG_WARNING(Debug, log("no turn channel numbers available") + relayPort->toDebug())
+        return TURNChannelPtr();
+      }
+
+      TURNChannelNumber number = relayPort->mNextChannelNumber;
+      while (relayPort->mChannelNumbers.find(number) != relayPort->mChannelNumbers.end()) {
+        number = (PacketDemux::kTURNChannelNumberLast == number ? PacketDemux::kTURNChannelNumberFirst : static_cast<TURNChannelNumber>(number + 1));
+      }
+      relayPort->mNextChannelNumber = (PacketDemux::kTURNChannelNumberLast == number ? PacketDemux::kTURNChannelNumberFirst : static_cast<TURNChannelNumber>(number + 1));
+
+      TURNChannelPtr channel(make_shared<TURNChannel>());
+      channel->mNumber = number;
+      channel->mPeerIP = peerIP;
+      channel->mLastUsed = zsLib::now();
+
+      relayPort->mPeerChannels[peerIP] = channel;
+      relayPort->mChannelNumbers[number] = channel;
+
+      ZS_LOG_DEBUG(log("binding turn channel for active relay route") + channel->toDebug() + relayPort->toDebug())
+
+      bindTURNChannel(relayPort, channel);
+      return TURNChannelPtr();  // not usable until the server confirms the binding
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::bindTURNChannel(
+                                      RelayPortPtr relayPort,
+                                      TURNChannelPtr channel
+                                      )
+    {
+      if (channel->mBindRequester) {
+        auto found = mTURNChannelBindRequests.find(channel->mBindRequester);
+        if (found != mTURNChannelBindRequests.end()) mTURNChannelBindRequests.erase(found);
+        channel->mBindRequester->cancel();
+        channel->mBindRequester.reset();
+      }
+
+      STUNPacketPtr request = STUNPacket::createRequest(STUNPacket::Method_ChannelBind);
+      request->mChannelNumber = channel->mNumber;
+      request->mPeerAddressList.push_back(channel->mPeerIP);
+
+      if (relayPort->mNonce.hasData()) {
+        request->mCredentialMechanism = STUNPacket::CredentialMechanisms_LongTerm;
+        request->mUsername = relayPort->mServer.mUserName;
+        request->mPassword = relayPort->mServer.mCredential;
+        request->mRealm = relayPort->mRealm;
+        request->mNonce = relayPort->mNonce;
+      }
+
+      fix(request);
+
+      channel->mBindRequester = ISTUNRequester::create(UseServicesHelper::getServicePoolQueue(), mThisWeak.lock(), relayPort->mServerResponseIP, request, STUNPacket::RFC_5766_TURN);
+      if (!channel->mBindRequester) {
+        ZS_LOG_ERROR(Detail, log("unable to create turn channel bind request") + channel->toDebug())
+        channel->mFailed = true;
+        return;
+      }
+
+      mTURNChannelBindRequests[channel->mBindRequester] = RelayPortAndTURNChannelPair(relayPort, channel);
+
+      if (!mTURNChannelRefreshTimer) {
+        mTURNChannelRefreshTimer = Timer::create(mThisWeak.lock(), Seconds(kTURNChannelTimerInSeconds));
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::refreshTURNChannels()
+    {
+      Time now = zsLib::now();
+
+      bool hasChannels = false;
+
+      for (auto iter = mTURNSockets.begin(); iter != mTURNSockets.end(); ++iter) {
+        auto relayPort = (*iter).second.second;
+
+        for (auto iterChannel_doNotUse = relayPort->mPeerChannels.begin(); iterChannel_doNotUse != relayPort->mPeerChannels.end(); )
+        {
+          auto current = iterChannel_doNotUse;
+          ++iterChannel_doNotUse;
+
+          auto channel = (*current).second;
+
+          if (channel->mLastUsed + mTURNChannelIdleTimeout < now) {
+            ZS_LOG_TRACE(log("turn channel is idle (thus letting the binding expire)") + channel->toDebug())
+
+            if (channel->mBindRequester) {
+              auto found = mTURNChannelBindRequests.find(channel->mBindRequester);
+              if (found != mTURNChannelBindRequests.end()) mTURNChannelBindRequests.erase(found);
+              channel->mBindRequester->cancel();
+              channel->mBindRequester.reset();
+            }
+
+            // the number stays reserved until the server's binding lapses
+            // (plus the 5 minutes before the server allows it to be reused)
+            // so it cannot be reassigned to a different peer too early
+            channel->mBound = false;
+            if (channel->mLastUsed + mTURNChannelIdleTimeout + Seconds(kTURNChannelRefreshInSeconds * 3) < now) {
+              relayPort->mChannelNumbers.erase(channel->mNumber);
+              relayPort->mPeerChannels.erase(current);
+              continue;
+            }
+            hasChannels = true;
+            continue;
+          }
+
+          hasChannels = true;
+
+          if (channel->mFailed) continue;
+          if (channel->mBindRequester) continue;
+
+          if ((!channel->mBound) ||
+              (channel->mBoundAt + Seconds(kTURNChannelRefreshInSeconds) < now)) {
+            ZS_LOG_TRACE(log("refreshing turn channel binding") + channel->toDebug())
+            bindTURNChannel(relayPort, channel);
+          }
+        }
+      }
+
+      if ((!hasChannels) &&
+          (mTURNChannelBindRequests.size() < 1) &&
+          (mTURNChannelRefreshTimer)) {
+        ZS_LOG_TRACE(log("no turn channels remain (thus stopping refresh timer)"))
+        mTURNChannelRefreshTimer->cancel();
+        mTURNChannelRefreshTimer.reset();
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::clearTURNChannels(RelayPort &relayPort)
+    {
+      for (auto iter = relayPort.mPeerChannels.begin(); iter != relayPort.mPeerChannels.end(); ++iter) {
+        auto channel = (*iter).second;
+        if (!channel->mBindRequester) continue;
+
+        auto found = mTURNChannelBindRequests.find(channel->mBindRequester);
+        if (found != mTURNChannelBindRequests.end()) mTURNChannelBindRequests.erase(found);
+        channel->mBindRequester->cancel();
+        channel->mBindRequester.reset();
+      }
+
+      relayPort.mPeerChannels.clear();
+      relayPort.mChannelNumbers.clear();
+      relayPort.mNextChannelNumber = PacketDemux::kTURNChannelNumberFirst;
+      relayPort.mRealm.clear();
+      relayPort.mNonce.clear();
+    }
+
+    //-------------------------------------------------------------------------
+    void ICEGatherer::resolveTURNChannelData(
+                                             RelayPortPtr relayPort,
+                                             IncomingUDPPacket &packet
+                                             )
+    {
+      if (!relayPort) return;
+      if (relayPort->mChannelNumbers.size() < 1) return; // not bound by the gatherer (leave for the turn socket)
+
+      auto &datagram = packet.mDatagram;
+      const BYTE *buffer = datagram.mBuffer->BytePtr();
+
+      TURNChannelNumber number {};
+      size_t payloadSize {};
+      if (!PacketDemux::parseTURNChannelData(buffer, datagram.mSize, number, payloadSize)) {
+        ZS_LOG_WARNING(Trace, log("malformed turn channel data") + ZS_PARAM("from ip", datagram.mFromIP.string()) + ZS_PARAM("size", datagram.mSize))
+        return;
+      }
+
+      auto found = relayPort->mChannelNumbers.find(number);
+      if (found == relayPort->mChannelNumbers.end()) return;
+
+      auto channel = (*found).second;
+
+      if (!relayPort->mRelayCandidate) {
+        ZS_LOG_WARNING(Trace, log("relay candidate is gone (thus cannot handle turn channel data)") + relayPort->toDebug())
+        return;
+      }
+
+      Time now = zsLib::now();
+      channel->mLastUsed = now;
+      relayPort->mLastActivity = now;
+
+      packet.mRelayPort = relayPort;
+      packet.mTURNChannel = channel;
+      packet.mLocalCandidate = relayPort->mRelayCandidate;
+      packet.mPayloadOffset = PacketDemux::Size_TURNChannelDataHeader;
+      packet.mPayloadSize = payloadSize;
+
+      const BYTE *payload = buffer + packet.mPayloadOffset;
+
+      packet.mPacketType = PacketDemux::classify(payload, payloadSize);
+      if (PacketDemux::isSTUNCandidate(packet.mPacketType, payload, payloadSize)) {
+        packet.mSTUNPacket = STUNPacket::parseIfSTUN(payload, payloadSize, mSTUNPacketParseOptions);
+        fixSTUNParserOptions(packet.mSTUNPacket);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    bool ICEGatherer::sendTURNChannelData(
+                                          RelayPort &relayPort,
+                                          const TURNChannel &channel,
+                                          const BYTE *buffer,
+                                          size_t bufferSizeInBytes
+                                          )
+    {
+      if (!relayPort.mTURNSocket) return false;
+
+      auto found = mTURNSockets.find(relayPort.mTURNSocket);
+      if (found == mTURNSockets.end()) return false;
+
+      auto hostPort = (*found).second.first;
+      if (!hostPort->mBoundUDPSocket) return false;
+
+      BYTE header[PacketDemux::Size_TURNChannelDataHeader] {};
+      if (!PacketDemux::writeTURNChannelDataHeader(&(header[0]), channel.mNumber, bufferSizeInBytes)) {
+        ZS_LOG_WARNING(Debug, log("packet too large for turn channel data") + ZS_PARAM("size", bufferSizeInBytes))
+        return false;
+      }
+
+      EventWriteOrtcIceGathererUdpSocketPacketSentTo(__func__, mID, hostPort->mBoundUDPIP.string(), relayPort.mServerResponseIP.string(), SafeInt<unsigned int>(bufferSizeInBytes), buffer);
+
+      bool wouldBlock = false;
+      int errorCode = 0;
+      if (UDPBatchSender::sendWithPrefix(hostPort->mBoundUDPSocket, hostPort->mBoundUDPIP, relayPort.mServerResponseIP, &(header[0]), sizeof(header), buffer, bufferSizeInBytes, wouldBlock, errorCode)) {
+        ZS_LOG_INSANE(log("turn channel data sent") + ZS_PARAM("channel", channel.mNumber) + ZS_PARAM("to", relayPort.mServerResponseIP.string()) + ZS_PARAM("size", bufferSizeInBytes))
+        return true;
+      }
+
+      if (0 != errorCode) {
+        ZS_LOG_ERROR(Debug, log("unable to send turn channel data") + ZS_PARAM("error", errorCode) + ZS_PARAM("to", relayPort.mServerResponseIP.string()) + ZS_PARAM("from", hostPort->mBoundUDPIP.string()))
+        return false;
+      }
+
+      ZS_LOG_WARNING(Trace, log("could not send turn channel data at this time") + ZS_PARAM("to", relayPort.mServerResponseIP.string()) + ZS_PARAM("would block", wouldBlock))
+      if (wouldBlock) SocketReactor::monitorWriteReady(hostPort->mBoundUDPSocket);
+      return false;
+    }
+
     //-------------------------------------------------------------------------
     bool ICEGatherer::shouldKeepWarm() const
     {
@@ -6292,6 +7528,7 @@ namespace ortc
                                               )
     {
       FilterPolicies defaultPolicy = FilterPolicy_None;
+      bool foundExact = false;
       for (auto iter = options.mInterfacePolicies.begin(); iter != options.mInterfacePolicies.end(); ++iter) {
         auto interfacePolicy = (*iter);
         InterfaceTypes interfaceType = toInterfaceType(interfacePolicy.mInterfaceType);
@@ -6307,10 +7544,16 @@ namespace ortc
         if (interfaceType == ioData.mInterfaceType) {
           ZS_LOG_TRACE(slog("found exact interface policy") + interfacePolicy.toDebug())
           ioData.mFilterPolicy = interfacePolicy.mGatherPolicy;
-          return;
+          foundExact = true;
+          break;
         }
       }
-      ioData.mFilterPolicy = defaultPolicy;
+      if (!foundExact) ioData.mFilterPolicy = defaultPolicy;
+
+      if (options.mICELite) {
+        // an ice lite agent only ever advertises host candidates
+        ioData.mFilterPolicy = static_cast<FilterPolicies>(ioData.mFilterPolicy | FilterPolicy_NoSrflx | FilterPolicy_NoRelay);
+      }
     }
 
     //-------------------------------------------------------------------------
@@ -6427,7 +7670,7 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, mCandidate ? mCandidate->toDebug() : ElementPtr());
 
       UseServicesHelper::debugAppend(resultEl, "last activity", mLastActivity);
-      UseServicesHelper::debugAppend(resultEl, "inactivity timer", mInactivityTimer ? mInactivityTimer->getID() : 0);
+      UseServicesHelper::debugAppend(resultEl, "inactivity timer", mInactivityTimer);
 
       return resultEl;
     }
@@ -6455,7 +7698,39 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "reflexive candidate", mRelayCandidate ? mRelayCandidate->toDebug() : ElementPtr());
 
       UseServicesHelper::debugAppend(resultEl, "last activity", mLastActivity);
-      UseServicesHelper::debugAppend(resultEl, "inactivity timer", mInactivityTimer ? mInactivityTimer->getID() : 0);
+      UseServicesHelper::debugAppend(resultEl, "inactivity timer", mInactivityTimer);
+
+      UseServicesHelper::debugAppend(resultEl, "channels", mPeerChannels.size());
+      UseServicesHelper::debugAppend(resultEl, "next channel number", mNextChannelNumber);
+      UseServicesHelper::debugAppend(resultEl, "realm", mRealm);
+      UseServicesHelper::debugAppend(resultEl, "nonce", mNonce);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICEGatherer::TURNChannel
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr ICEGatherer::TURNChannel::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::ICEGatherer::TURNChannel");
+
+      UseServicesHelper::debugAppend(resultEl, "id", mID);
+
+      UseServicesHelper::debugAppend(resultEl, "number", mNumber);
+      UseServicesHelper::debugAppend(resultEl, "peer ip", mPeerIP.string());
+
+      UseServicesHelper::debugAppend(resultEl, "bind requester", mBindRequester ? mBindRequester->getID() : 0);
+      UseServicesHelper::debugAppend(resultEl, "bound", mBound);
+      UseServicesHelper::debugAppend(resultEl, "failed", mFailed);
+      UseServicesHelper::debugAppend(resultEl, "bound at", mBoundAt);
+      UseServicesHelper::debugAppend(resultEl, "last used", mLastUsed);
 
       return resultEl;
     }
@@ -6482,12 +7757,16 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "candidate udp", mCandidateUDP ? mCandidateUDP->toDebug() : ElementPtr());
       UseServicesHelper::debugAppend(resultEl, "bound udp ip", mBoundUDPIP.string());
       UseServicesHelper::debugAppend(resultEl, "bound udp socket", string(mBoundUDPSocket));
+      UseServicesHelper::debugAppend(resultEl, "bound udp shard sockets", mBoundUDPShardSockets.size());
+      UseServicesHelper::debugAppend(resultEl, "udp receivers", mUDPReceivers.size());
+      UseServicesHelper::debugAppend(resultEl, "shared udp", mSharedUDP);
       UseServicesHelper::debugAppend(resultEl, "udp back off timer", UseBackOffTimer::toDebug(mBindUDPBackOffTimer));
 
       UseServicesHelper::debugAppend(resultEl, "passive candidate tcp", mCandidateTCPPassive ? mCandidateTCPPassive->toDebug() : ElementPtr());
       UseServicesHelper::debugAppend(resultEl, "active candidate tcp", mCandidateTCPActive ? mCandidateTCPActive->toDebug() : ElementPtr());
       UseServicesHelper::debugAppend(resultEl, "bound udp ip", mBoundTCPIP.string());
       UseServicesHelper::debugAppend(resultEl, "bound tcp socket", string(mBoundTCPSocket));
+      UseServicesHelper::debugAppend(resultEl, "shared tcp", mSharedTCP);
       UseServicesHelper::debugAppend(resultEl, "tcp back off timer", UseBackOffTimer::toDebug(mBindTCPBackOffTimer));
 
       UseServicesHelper::debugAppend(resultEl, "warm up after binding", mWarmUpAfterBinding);
@@ -6525,8 +7804,8 @@ namespace ortc
 
       UseServicesHelper::debugAppend(resultEl, "remote ip", mRemoteIP.string());
       UseServicesHelper::debugAppend(resultEl, "socket", string(mSocket));
-      UseServicesHelper::debugAppend(resultEl, "incoming buffer", mIncomingBuffer.CurrentSize());
-      UseServicesHelper::debugAppend(resultEl, "outgoing buffer", mOutgoingBuffer.CurrentSize());
+      UseServicesHelper::debugAppend(resultEl, "reader", mReader.toDebug());
+      UseServicesHelper::debugAppend(resultEl, "writer", mWriter.toDebug());
 
       UseServicesHelper::debugAppend(resultEl, "transport id", mTransportID);
       UseICETransportPtr transport = mTransport.lock();
@@ -6555,7 +7834,8 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "stun packet", (bool)mSTUNPacket);
       UseServicesHelper::debugAppend(resultEl, "rfrag", mRFrag);
 
-      UseServicesHelper::debugAppend(resultEl, "buffer", mBuffer ? mBuffer->SizeInBytes() : 0);
+      UseServicesHelper::debugAppend(resultEl, "packet type", PacketDemux::toString(mPacketType));
+      UseServicesHelper::debugAppend(resultEl, "buffer", mBuffer ? mBufferSize : 0);
 
       return resultEl;
     }
@@ -7120,6 +8400,17 @@ namespace ortc
       }
     }
 
+    {
+      String str = UseServicesHelper::getElementText(elem->findFirstChildElement("iceLite"));
+      if (str.hasData()) {
+        try {
+          mICELite = Numeric<decltype(mICELite)>(str);
+        } catch(const Numeric<decltype(mICELite)>::ValueOutOfRange &) {
+          ZS_LOG_WARNING(Debug, slog("ice lite value out of range") + ZS_PARAM("value", str))
+        }
+      }
+    }
+
     ElementPtr interfacePoliciesEl = elem->findFirstChildElement("interfacePolicies");
 
     if (interfacePoliciesEl) {
@@ -7164,6 +8455,7 @@ namespace ortc
     ElementPtr elem = Element::create(objectName);
 
     elem->adoptAsLastChild(UseServicesHelper::createElementWithNumber("continuousGathering",  string(mContinuousGathering)));
+    elem->adoptAsLastChild(UseServicesHelper::createElementWithNumber("iceLite",  string(mICELite)));
 
     if (mInterfacePolicies.size() > 0) {
       ElementPtr interfacePoliciesEl = Element::create("interfacePolicies");
@@ -7204,7 +8496,8 @@ namespace ortc
   {
     SHA1Hasher hasher;
 
-    hasher.update(mContinuousGathering ? "Options:true:policy:" : "Options:false:policy:");
+    hasher.update(mContinuousGathering ? "Options:true:" : "Options:false:");
+    hasher.update(mICELite ? "lite:true:policy:" : "lite:false:policy:");
     for (auto iter = mInterfacePolicies.begin(); iter != mInterfacePolicies.end(); ++iter) {
       auto policy = (*iter);
       hasher.update(policy.hash());
@@ -118,23 +118,38 @@ namespace ortc
       AutoRecursiveLock lock(*this);
 
       LocalCandidateHash hash = localCandidate ? localCandidate->hash() : String();
+      LocalCandidateID localCandidateID = getLocalCandidateID(hash);
 
-      CandidateRemoteIPPair search(hash, remoteIP);
+      RouteKey key = toRouteKey(localCandidateID, remoteIP);
 
-      auto found = mRoutes.find(search);
+      auto found = mRoutes.find(key);
       if (found != mRoutes.end()) {
-        RoutePtr route = (*found).second.lock();
+        auto &routes = (*found).second;
+
+        for (size_t index = 0; index < routes.size(); ) {
+          RoutePtr route = routes[index].lock();
+          if (!route) {
+            EventWriteOrtcIceGathererRouterInternalEvent(__func__, mID, "gone", hash, ((bool)localCandidate) ? localCandidate->mIP : String(), ((bool)localCandidate) ? localCandidate->mPort : 0, remoteIP.string());
+            ZS_LOG_WARNING(Debug, log("route was previously found but is now gone") + (localCandidate ? localCandidate->toDebug() : ElementPtr()) + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("create route", createRouteIfNeeded))
+            routes.erase(routes.begin() + index);
+            continue;
+          }
+
+          if ((route->mLocalCandidateID != localCandidateID) ||
+              (route->mRemoteIP != remoteIP)) {
+            ++index;
+            continue;
+          }
 
-        if (route) {
           EventWriteOrtcIceGathererRouterInternalEvent(__func__, mID, "found", hash, ((bool)localCandidate) ? localCandidate->mIP : String(), ((bool)localCandidate) ? localCandidate->mPort : 0, remoteIP.string());
           route->trace(__func__, "found");
           ZS_LOG_TRACE(log("route found") + route->toDebug() + ZS_PARAM("create route", createRouteIfNeeded))
           return route;
         }
 
-        EventWriteOrtcIceGathererRouterInternalEvent(__func__, mID, "gone", hash, ((bool)localCandidate) ? localCandidate->mIP : String(), ((bool)localCandidate) ? localCandidate->mPort : 0, remoteIP.string());
-        ZS_LOG_WARNING(Debug, log("route was previously found but is now gone") + (localCandidate ? localCandidate->toDebug() : ElementPtr()) + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("create route", createRouteIfNeeded))
-        mRoutes.erase(found);
+        if (routes.size() < 1) {
+          mRoutes.erase(found);
+        }
       }
 
       if (!createRouteIfNeeded) {
@@ -144,19 +159,35 @@ namespace ortc
       }
 
       RoutePtr route(make_shared<Route>());
+      route->mLocalCandidateID = localCandidateID;
       route->mLocalCandidate = localCandidate ? make_shared<Candidate>(*localCandidate) : CandidatePtr();
       route->mRemoteIP = remoteIP;
 
       EventWriteOrtcIceGathererRouterInternalEvent(__func__, mID, "created", hash, ((bool)localCandidate) ? localCandidate->mIP : String(), ((bool)localCandidate) ? localCandidate->mPort : 0, remoteIP.string());
       route->trace(__func__, "created");
 
-      mRoutes[search] = route;
+      mRoutes[key].push_back(route);
 
       ZS_LOG_DEBUG(log("route created") + route->toDebug())
 
       return route;
     }
 
+    //-------------------------------------------------------------------------
+    ICEGathererRouter::RouteKey ICEGathererRouter::toRouteKey(
+                                                              QWORD localCandidateKey,
+                                                              const IPAddress &remoteIP
+                                                              )
+    {
+      // IPv4 addresses are held as IPv4 mapped IPv6 addresses thus folding
+      // both halves of the address covers either family
+      RouteKey key = localCandidateKey * 0x9E3779B97F4A7C15ULL;
+      key ^= static_cast<RouteKey>(remoteIP.mIPAddress.ull[0]) * 0xC2B2AE3D27D4EB4FULL;
+      key ^= static_cast<RouteKey>(remoteIP.mIPAddress.ull[1]);
+      key ^= (static_cast<RouteKey>(remoteIP.getPort()) << 48);
+      return key;
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -168,30 +199,52 @@ namespace ortc
     //-------------------------------------------------------------------------
     void ICEGathererRouter::onTimer(TimerPtr timer)
     {
+      typedef std::set<LocalCandidateID> LocalCandidateIDSet;
+
       ZS_LOG_DEBUG(log("on timer"))
 
       AutoRecursiveLock lock(*this);
 
+      LocalCandidateIDSet inUseIDs;
+
       for (auto iter_doNotUse = mRoutes.begin(); iter_doNotUse != mRoutes.end(); )
       {
         auto current = iter_doNotUse;
         ++iter_doNotUse;
 
-        auto route = (*current).second.lock();
+        auto &routes = (*current).second;
+
+        for (size_t index = 0; index < routes.size(); ) {
+          auto route = routes[index].lock();
 
-        auto candidateHash = ((*current).first).first;
-        auto remoteIP = ((*current).first).second;
+          if (route) {
+            EventWriteOrtcIceGathererRouterInternalEvent(__func__, mID, "keep", string(route->mLocalCandidateID), NULL, 0, route->mRemoteIP.string());
+            route->trace(__func__, "keep");
+            ZS_LOG_TRACE(log("route still in use") + ZS_PARAM("candidate id", route->mLocalCandidateID) + ZS_PARAM("remote ip", route->mRemoteIP.string()))
+            inUseIDs.insert(route->mLocalCandidateID);
+            ++index;
+            continue;
+          }
 
-        if (route) {
-          EventWriteOrtcIceGathererRouterInternalEvent(__func__, mID, "keep", candidateHash, NULL, 0, remoteIP.string());
-          route->trace(__func__, "keep");
-          ZS_LOG_TRACE(log("route still in use") + ZS_PARAM("candidate hash", candidateHash) + ZS_PARAM("remote ip", remoteIP.string()))
-          continue;
+          EventWriteOrtcIceGathererRouterInternalEvent(__func__, mID, "prune", string((*current).first), NULL, 0, NULL);
+          ZS_LOG_TRACE(log("pruning route") + ZS_PARAM("route key", (*current).first))
+          routes.erase(routes.begin() + index);
         }
 
-        EventWriteOrtcIceGathererRouterInternalEvent(__func__, mID, "prune", candidateHash, NULL, 0, remoteIP.string());
-        ZS_LOG_TRACE(log("pruning route") + ZS_PARAM("candidate hash", candidateHash) + ZS_PARAM("remote ip", remoteIP.string()))
-        mRoutes.erase(current);
+        if (routes.size() < 1) {
+          mRoutes.erase(current);
+        }
+      }
+
+      for (auto iter_doNotUse = mLocalCandidateIDs.begin(); iter_doNotUse != mLocalCandidateIDs.end(); )
+      {
+        auto current = iter_doNotUse;
+        ++iter_doNotUse;
+
+        if (inUseIDs.end() != inUseIDs.find((*current).second)) continue;
+
+        ZS_LOG_TRACE(log("pruning local candidate id") + ZS_PARAM("candidate hash", (*current).first) + ZS_PARAM("candidate id", (*current).second))
+        mLocalCandidateIDs.erase(current);
       }
     }
 
@@ -234,6 +287,8 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "id", mID);
 
       UseServicesHelper::debugAppend(resultEl, "routes", mRoutes.size());
+      UseServicesHelper::debugAppend(resultEl, "local candidate ids", mLocalCandidateIDs.size());
+      UseServicesHelper::debugAppend(resultEl, "last local candidate id", mLastLocalCandidateID);
 
       UseServicesHelper::debugAppend(resultEl, "timer", mTimer ? mTimer->getID() : 0);
 
@@ -250,6 +305,20 @@ namespace ortc
       }
 
       mRoutes.clear();
+      mLocalCandidateIDs.clear();
+    }
+
+    //-------------------------------------------------------------------------
+    ICEGathererRouter::LocalCandidateID ICEGathererRouter::getLocalCandidateID(const LocalCandidateHash &hash)
+    {
+      auto found = mLocalCandidateIDs.find(hash);
+      if (found != mLocalCandidateIDs.end()) return (*found).second;
+
+      LocalCandidateID localCandidateID = ++mLastLocalCandidateID;
+      mLocalCandidateIDs[hash] = localCandidateID;
+
+      ZS_LOG_TRACE(log("assigned local candidate id") + ZS_PARAM("candidate hash", hash) + ZS_PARAM("candidate id", localCandidateID))
+      return localCandidateID;
     }
 
     //-------------------------------------------------------------------------
@@ -312,6 +381,7 @@ namespace ortc
     {
       ElementPtr objectEl = Element::create("ortc::ICEGathererRouter::Route");
       UseServicesHelper::debugAppend(objectEl, "id", mID);
+      UseServicesHelper::debugAppend(objectEl, "local candidate id", mLocalCandidateID);
       UseServicesHelper::debugAppend(objectEl, "local candidate", mLocalCandidate ? mLocalCandidate->toDebug() : ElementPtr());
       UseServicesHelper::debugAppend(objectEl, "remote ip", mRemoteIP.string());
       return objectEl;
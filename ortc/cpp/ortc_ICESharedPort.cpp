@@ -0,0 +1,1166 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <ortc/internal/ortc_ICESharedPort.h>
+#include <ortc/internal/ortc_ICEGatherer.h>
+#include <ortc/internal/ortc_PacketDemux.h>
+#include <ortc/internal/ortc_SocketReactor.h>
+#include <ortc/internal/platform.h>
+
+#include <openpeer/services/ISettings.h>
+#include <openpeer/services/IHelper.h>
+#include <openpeer/services/ISTUNRequester.h>
+
+#include <zsLib/Log.h>
+#include <zsLib/Singleton.h>
+#include <zsLib/XML.h>
+
+#include <set>
+
+
+#ifdef _DEBUG
+#define ASSERT(x) ZS_THROW_BAD_STATE_IF(!(x))
+#else
+#define ASSERT(x)
+#endif //_DEBUG
+
+
+namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
+
+namespace ortc
+{
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISTUNRequester, UseSTUNRequester)
+
+  namespace internal
+  {
+    // RFC 4571 length prefix followed by a STUN header
+    static const size_t kFramedSTUNMinimumSize = sizeof(WORD) + 20;
+    static const size_t kFramedSTUNMaximumSize = sizeof(WORD) + 1500;
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IICESharedPortForSettings
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void IICESharedPortForSettings::applyDefaults()
+    {
+      UseSettings::setUInt(ORTC_SETTING_ICE_SHARED_PORT_PORT, 0);
+      UseSettings::setUInt(ORTC_SETTING_ICE_SHARED_PORT_MAX_ROUTES, 100000);
+      UseSettings::setUInt(ORTC_SETTING_ICE_SHARED_PORT_LEARNED_ROUTE_TIMEOUT_IN_SECONDS, 30);
+      UseSettings::setUInt(ORTC_SETTING_ICE_SHARED_PORT_MAX_PENDING_TCP_CONNECTIONS, 1000);
+      UseSettings::setUInt(ORTC_SETTING_ICE_SHARED_PORT_PENDING_TCP_TIMEOUT_IN_SECONDS, 10);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICESharedPort::SharedSocket
+    #pragma mark
+
+    struct ICESharedPort::SharedSocket
+    {
+      typedef std::set<PUID> GathererIDSet;
+
+      AutoPUID mID;
+
+      IPAddress mHostIP;
+      IPAddress mBoundIP;
+      IICETypes::Protocols mProtocol {IICETypes::Protocol_UDP};
+      SocketPtr mSocket;
+
+      GathererIDSet mAttached;
+
+      UDPBatchReceiver mReceiver;   // only used from the socket's read event
+
+      ElementPtr toDebug() const;
+    };
+
+    //-------------------------------------------------------------------------
+    ElementPtr ICESharedPort::SharedSocket::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::ICESharedPort::SharedSocket");
+
+      UseServicesHelper::debugAppend(resultEl, "id", mID);
+      UseServicesHelper::debugAppend(resultEl, "bound ip", mBoundIP.string());
+      UseServicesHelper::debugAppend(resultEl, "protocol", IICETypes::toString(mProtocol));
+      UseServicesHelper::debugAppend(resultEl, "socket", string(mSocket));
+      UseServicesHelper::debugAppend(resultEl, "attached", mAttached.size());
+      if (IICETypes::Protocol_UDP == mProtocol) {
+        UseServicesHelper::debugAppend(resultEl, mReceiver.toDebug());
+      }
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICESharedPort::PendingTCPConnection
+    #pragma mark
+
+    struct ICESharedPort::PendingTCPConnection
+    {
+      AutoPUID mID;
+
+      SharedSocketPtr mListener;
+      SocketPtr mSocket;
+      IPAddress mRemoteIP;
+      Time mAccepted;
+      PendingTCPTimerWheel::TimerID mExpiryTimer {};
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICESharedPort
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ICESharedPort::ICESharedPort(const make_private &) :
+      mPort(static_cast<WORD>(UseSettings::getUInt(ORTC_SETTING_ICE_SHARED_PORT_PORT))),
+      mMaxRoutes(UseSettings::getUInt(ORTC_SETTING_ICE_SHARED_PORT_MAX_ROUTES)),
+      mLearnedRouteTimeout(Seconds(UseSettings::getUInt(ORTC_SETTING_ICE_SHARED_PORT_LEARNED_ROUTE_TIMEOUT_IN_SECONDS))),
+      mMaxPendingTCPConnections(UseSettings::getUInt(ORTC_SETTING_ICE_SHARED_PORT_MAX_PENDING_TCP_CONNECTIONS)),
+      mPendingTCPTimeout(Seconds(UseSettings::getUInt(ORTC_SETTING_ICE_SHARED_PORT_PENDING_TCP_TIMEOUT_IN_SECONDS))),
+      mPendingTCPTimers(Seconds(1))
+    {
+      mSTUNPacketParseOptions = STUNPacket::ParseOptions(STUNPacket::RFC_AllowAll, false, "ortc::ICESharedPort", mID);
+      ZS_LOG_DETAIL(log("created") + ZS_PARAM("port", mPort))
+    }
+
+    //-------------------------------------------------------------------------
+    ICESharedPort::~ICESharedPort()
+    {
+      mThisWeak.reset();
+      notifySingletonCleanup();
+      ZS_LOG_DETAIL(log("destroyed"))
+    }
+
+    //-------------------------------------------------------------------------
+    ICESharedPortPtr ICESharedPort::create()
+    {
+      ICESharedPortPtr pThis(make_shared<ICESharedPort>(make_private{}));
+      pThis->mThisWeak = pThis;
+      return pThis;
+    }
+
+    //-------------------------------------------------------------------------
+    ICESharedPortPtr ICESharedPort::singleton()
+    {
+      AutoRecursiveLock lock(*UseServicesHelper::getGlobalLock());
+      static SingletonLazySharedPtr<ICESharedPort> singleton(create());
+      ICESharedPortPtr result = singleton.singleton();
+
+      static zsLib::SingletonManager::Register registerSingleton("ortc::ICESharedPort", result);
+
+      if (!result) {
+        ZS_LOG_WARNING(Detail, slog("singleton gone"))
+      }
+
+      return result;
+    }
+
+    //-------------------------------------------------------------------------
+    bool ICESharedPort::isEnabled()
+    {
+      return 0 != UseSettings::getUInt(ORTC_SETTING_ICE_SHARED_PORT_PORT);
+    }
+
+    //-------------------------------------------------------------------------
+    bool ICESharedPort::registerUsernameFrag(
+                                             UseGathererPtr gatherer,
+                                             const String &usernameFrag
+                                             )
+    {
+      if (!gatherer) return false;
+      if (usernameFrag.isEmpty()) return false;
+      if (!isEnabled()) return false;
+
+      auto pThis = singleton();
+      if (!pThis) return false;
+
+      AutoLock lock(pThis->mLock);
+
+      if (pThis->mShutdown) return false;
+
+      auto found = pThis->mUsernameFrags.find(usernameFrag);
+      if (found != pThis->mUsernameFrags.end()) {
+        auto &existing = (*found).second;
+        if (existing.mGatherer.lock()) {
+          ZS_LOG_DEBUG(pThis->log("username fragment is already registered") + ZS_PARAM("username frag", usernameFrag) + ZS_PARAM("gatherer", gatherer->getID()) + ZS_PARAM("existing gatherer", existing.mGathererID))
+          return false;
+        }
+      }
+
+      GathererTarget &target = pThis->mUsernameFrags[usernameFrag];
+      target.mGatherer = gatherer;
+      target.mGathererID = gatherer->getID();
+
+      ZS_LOG_DEBUG(pThis->log("registered username fragment") + ZS_PARAM("username frag", usernameFrag) + ZS_PARAM("gatherer", target.mGathererID))
+      return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::unregisterUsernameFrag(
+                                               PUID gathererID,
+                                               const String &usernameFrag
+                                               )
+    {
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      AutoLock lock(pThis->mLock);
+
+      auto found = pThis->mUsernameFrags.find(usernameFrag);
+      if (found == pThis->mUsernameFrags.end()) return;
+      if ((*found).second.mGathererID != gathererID) return;
+
+      pThis->mUsernameFrags.erase(found);
+
+      // scope: purge every route still pointing at the gatherer
+      {
+        for (auto iter_doNotUse = pThis->mRoutes.begin(); iter_doNotUse != pThis->mRoutes.end(); ) {
+          auto current = iter_doNotUse;
+          ++iter_doNotUse;
+
+          if ((*current).second.mGathererID != gathererID) continue;
+          pThis->mRoutes.erase(current);
+        }
+      }
+
+      ZS_LOG_DEBUG(pThis->log("unregistered username fragment") + ZS_PARAM("username frag", usernameFrag) + ZS_PARAM("gatherer", gathererID))
+    }
+
+    //-------------------------------------------------------------------------
+    ICESharedPort::SocketPtr ICESharedPort::attach(
+                                                   UseGathererPtr gatherer,
+                                                   IPAddress &ioBindIP,
+                                                   IICETypes::Protocols protocol
+                                                   )
+    {
+      if (!gatherer) return SocketPtr();
+
+      auto pThis = singleton();
+      if (!pThis) return SocketPtr();
+
+      AutoLock lock(pThis->mLock);
+
+      if (pThis->mShutdown) return SocketPtr();
+
+      IPAddress hostIP(ioBindIP);
+      hostIP.setPort(0);
+
+      SharedSocketPtr shared;
+
+      auto found = pThis->mSharedSockets.find(HostIPProtocolPair(hostIP, protocol));
+      if (found != pThis->mSharedSockets.end()) {
+        shared = (*found).second;
+      } else {
+        shared = pThis->bindSharedSocket(hostIP, protocol);
+        if (!shared) return SocketPtr();
+      }
+
+      shared->mAttached.insert(gatherer->getID());
+
+      ioBindIP = shared->mBoundIP;
+
+      ZS_LOG_DEBUG(pThis->log("gatherer attached to shared socket") + ZS_PARAM("gatherer", gatherer->getID()) + shared->toDebug())
+      return shared->mSocket;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::detach(
+                               PUID gathererID,
+                               SocketPtr socket
+                               )
+    {
+      if (!socket) return;
+
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      AutoLock lock(pThis->mLock);
+
+      auto found = pThis->mSocketToSharedSockets.find(socket.get());
+      if (found == pThis->mSocketToSharedSockets.end()) return;
+
+      auto shared = (*found).second;
+      shared->mAttached.erase(gathererID);
+
+      // scope: purge routes held by the gatherer on this socket
+      {
+        for (auto iter_doNotUse = pThis->mRoutes.begin(); iter_doNotUse != pThis->mRoutes.end(); ) {
+          auto current = iter_doNotUse;
+          ++iter_doNotUse;
+
+          if ((*current).first.first != shared->mID) continue;
+          if ((*current).second.mGathererID != gathererID) continue;
+          pThis->mRoutes.erase(current);
+        }
+      }
+
+      ZS_LOG_DEBUG(pThis->log("gatherer detached from shared socket") + ZS_PARAM("gatherer", gathererID) + shared->toDebug())
+
+      if (shared->mAttached.size() > 0) return;
+
+      pThis->closeSharedSocket(shared);
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::addRoute(
+                                 SocketPtr socket,
+                                 const IPAddress &remoteIP,
+                                 UseGathererPtr gatherer
+                                 )
+    {
+      if ((!socket) || (!gatherer)) return;
+
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      AutoLock lock(pThis->mLock);
+
+      auto found = pThis->mSocketToSharedSockets.find(socket.get());
+      if (found == pThis->mSocketToSharedSockets.end()) return;
+
+      auto shared = (*found).second;
+
+      PUID gathererID = gatherer->getID();
+
+      GathererTarget &target = pThis->mRoutes[SharedSocketRemoteIPPair(shared->mID, remoteIP)];
+      if (target.mGathererID != gathererID) {
+        if (0 != target.mGathererID) {
+          ZS_LOG_WARNING(Debug, pThis->log("remote address moved to another gatherer") + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("old gatherer", target.mGathererID) + ZS_PARAM("new gatherer", gathererID))
+        }
+        target.mGatherer = gatherer;
+        target.mGathererID = gathererID;
+        target.mReferences = 0;
+      }
+      ++(target.mReferences);
+
+      ZS_LOG_TRACE(pThis->log("added route") + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("gatherer", gathererID) + ZS_PARAM("references", target.mReferences))
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::removeRoute(
+                                    SocketPtr socket,
+                                    const IPAddress &remoteIP,
+                                    PUID gathererID
+                                    )
+    {
+      if (!socket) return;
+
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      AutoLock lock(pThis->mLock);
+
+      auto foundShared = pThis->mSocketToSharedSockets.find(socket.get());
+      if (foundShared == pThis->mSocketToSharedSockets.end()) return;
+
+      auto shared = (*foundShared).second;
+
+      auto found = pThis->mRoutes.find(SharedSocketRemoteIPPair(shared->mID, remoteIP));
+      if (found == pThis->mRoutes.end()) return;
+
+      auto &target = (*found).second;
+      if (target.mGathererID != gathererID) return;
+
+      if (target.mReferences > 1) {
+        --(target.mReferences);
+        return;
+      }
+
+      pThis->mRoutes.erase(found);
+
+      ZS_LOG_TRACE(pThis->log("removed route") + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("gatherer", gathererID))
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::confirmRoute(
+                                     SocketPtr socket,
+                                     const IPAddress &remoteIP,
+                                     UseGathererPtr gatherer
+                                     )
+    {
+      if ((!socket) || (!gatherer)) return;
+
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      AutoLock lock(pThis->mLock);
+
+      auto foundShared = pThis->mSocketToSharedSockets.find(socket.get());
+      if (foundShared == pThis->mSocketToSharedSockets.end()) return;
+
+      auto shared = (*foundShared).second;
+
+      PUID gathererID = gatherer->getID();
+      Time tick = zsLib::now();
+
+      SharedSocketRemoteIPPair key(shared->mID, remoteIP);
+
+      auto found = pThis->mRoutes.find(key);
+      if (found != pThis->mRoutes.end()) {
+        auto &target = (*found).second;
+
+        // a gatherer routing the remote itself is never overridden by a
+        // learned route
+        if (0 != target.mReferences) return;
+
+        if (target.mGathererID != gathererID) {
+          ZS_LOG_DEBUG(pThis->log("learned route replaced") + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("old gatherer", target.mGathererID) + ZS_PARAM("new gatherer", gathererID))
+          target.mGatherer = gatherer;
+          target.mGathererID = gathererID;
+        }
+        target.mLastUsed = tick;
+        return;
+      }
+
+      pThis->purgeLearnedRoutes(tick);
+
+      if (pThis->mRoutes.size() >= pThis->mMaxRoutes) {
+        if (!pThis->evictLearnedRoute()) {
+          ZS_LOG_WARNING(Debug, pThis->log("route cache is full (not caching remote)") + ZS_PARAM("remote ip", remoteIP.string()))
+          return;
+        }
+      }
+
+      GathererTarget &target = pThis->mRoutes[key];
+      target.mGatherer = gatherer;
+      target.mGathererID = gathererID;
+      target.mReferences = 0;
+      target.mLastUsed = tick;
+
+      ZS_LOG_TRACE(pThis->log("learned route from validated binding request") + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("gatherer", gathererID))
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::rejectRoute(
+                                    SocketPtr socket,
+                                    const IPAddress &remoteIP,
+                                    PUID gathererID
+                                    )
+    {
+      if (!socket) return;
+
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      AutoLock lock(pThis->mLock);
+
+      auto foundShared = pThis->mSocketToSharedSockets.find(socket.get());
+      if (foundShared == pThis->mSocketToSharedSockets.end()) return;
+
+      auto shared = (*foundShared).second;
+
+      auto found = pThis->mRoutes.find(SharedSocketRemoteIPPair(shared->mID, remoteIP));
+      if (found == pThis->mRoutes.end()) return;
+
+      auto &target = (*found).second;
+      if (0 != target.mReferences) return;
+      if (target.mGathererID != gathererID) return;
+
+      pThis->mRoutes.erase(found);
+
+      ZS_LOG_DEBUG(pThis->log("forgot learned route after failed integrity check") + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("gatherer", gathererID))
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr ICESharedPort::singletonToDebug()
+    {
+      auto pThis = singleton();
+      if (!pThis) return ElementPtr();
+      return pThis->toDebug();
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICESharedPort => ISocketDelegate
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::onReadReady(SocketPtr socket)
+    {
+      SharedSocketPtr shared;
+      PendingTCPConnectionPtr pending;
+
+      {
+        AutoLock lock(mLock);
+
+        auto found = mSocketToSharedSockets.find(socket.get());
+        if (found != mSocketToSharedSockets.end()) {
+          shared = (*found).second;
+        } else {
+          auto foundPending = mPendingTCPConnections.find(socket.get());
+          if (foundPending != mPendingTCPConnections.end()) {
+            pending = (*foundPending).second;
+          }
+        }
+      }
+
+      if (shared) {
+        if (IICETypes::Protocol_UDP == shared->mProtocol) {
+          readUDP(shared);
+        } else {
+          acceptTCP(shared);
+        }
+        return;
+      }
+
+      if (pending) {
+        readPendingTCP(pending);
+        return;
+      }
+
+      ZS_LOG_WARNING(Trace, log("read ready on unknown socket") + ZS_PARAM("socket", string(socket)))
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::onWriteReady(SocketPtr socket)
+    {
+      ZS_LOG_INSANE(log("write ready") + ZS_PARAM("socket", string(socket)))
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::onException(SocketPtr socket)
+    {
+      PendingTCPConnectionPtr pending;
+
+      {
+        AutoLock lock(mLock);
+
+        auto found = mSocketToSharedSockets.find(socket.get());
+        if (found != mSocketToSharedSockets.end()) {
+          // the gatherers keep sending through the socket; a failed shared
+          // socket is only replaced once every gatherer has detached
+          ZS_LOG_ERROR(Detail, log("exception on shared socket") + (*found).second->toDebug())
+          return;
+        }
+
+        auto foundPending = mPendingTCPConnections.find(socket.get());
+        if (foundPending == mPendingTCPConnections.end()) return;
+
+        pending = (*foundPending).second;
+      }
+
+      ZS_LOG_DEBUG(log("pending TCP connection closed before identifying itself") + ZS_PARAM("remote ip", pending->mRemoteIP.string()))
+      closePendingTCP(pending);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICESharedPort => ITimerDelegate
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::onTimer(TimerPtr timer)
+    {
+      PendingTCPConnectionList expired;
+
+      {
+        AutoLock lock(mLock);
+        if (timer != mPendingTCPTimer) return;
+
+        // the one shot timer has fired
+        mPendingTCPTimer.reset();
+
+        PendingTCPTimerWheel::ValueList fired;
+        mPendingTCPTimers.advance(zsLib::now(), fired);
+
+        for (auto iter = fired.begin(); iter != fired.end(); ++iter) {
+          auto pending = (*iter).lock();
+          if (!pending) continue;
+
+          pending->mExpiryTimer = 0;
+          expired.push_back(pending);
+        }
+
+        stepPendingTCPTimer();
+      }
+
+      // expire connections that never identified themselves
+      for (auto iter = expired.begin(); iter != expired.end(); ++iter) {
+        ZS_LOG_DEBUG(log("pending TCP connection timed out") + ZS_PARAM("remote ip", (*iter)->mRemoteIP.string()))
+        closePendingTCP(*iter);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICESharedPort => ISingletonManagerDelegate
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::notifySingletonCleanup()
+    {
+      PendingTCPConnectionMap pendingConnections;
+      SharedSocketMap sharedSockets;
+
+      {
+        AutoLock lock(mLock);
+        if (mShutdown) return;
+        mShutdown = true;
+
+        pendingConnections = mPendingTCPConnections;
+        sharedSockets = mSharedSockets;
+
+        mPendingTCPTimers.clear();
+        if (mPendingTCPTimer) {
+          mPendingTCPTimer->cancel();
+          mPendingTCPTimer.reset();
+        }
+      }
+
+      ZS_LOG_DEBUG(log("notify singleton cleanup"))
+
+      for (auto iter = pendingConnections.begin(); iter != pendingConnections.end(); ++iter) {
+        closePendingTCP((*iter).second);
+      }
+
+      AutoLock lock(mLock);
+      for (auto iter = sharedSockets.begin(); iter != sharedSockets.end(); ++iter) {
+        closeSharedSocket((*iter).second);
+      }
+
+      mRoutes.clear();
+      mUsernameFrags.clear();
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICESharedPort => (internal)
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    Log::Params ICESharedPort::slog(const char *message)
+    {
+      ElementPtr objectEl = Element::create("ortc::ICESharedPort");
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    Log::Params ICESharedPort::log(const char *message) const
+    {
+      ElementPtr objectEl = Element::create("ortc::ICESharedPort");
+      UseServicesHelper::debugAppend(objectEl, "id", mID);
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr ICESharedPort::toDebug() const
+    {
+      AutoLock lock(mLock);
+
+      ElementPtr resultEl = Element::create("ortc::ICESharedPort");
+
+      UseServicesHelper::debugAppend(resultEl, "id", mID);
+      UseServicesHelper::debugAppend(resultEl, "port", mPort);
+      UseServicesHelper::debugAppend(resultEl, "max routes", mMaxRoutes);
+      UseServicesHelper::debugAppend(resultEl, "learned route timeout", mLearnedRouteTimeout);
+      UseServicesHelper::debugAppend(resultEl, "max pending tcp connections", mMaxPendingTCPConnections);
+      UseServicesHelper::debugAppend(resultEl, "pending tcp timeout", mPendingTCPTimeout);
+      UseServicesHelper::debugAppend(resultEl, "shutdown", mShutdown);
+
+      ElementPtr socketsEl = Element::create("shared sockets");
+      for (auto iter = mSharedSockets.begin(); iter != mSharedSockets.end(); ++iter) {
+        UseServicesHelper::debugAppend(socketsEl, (*iter).second->toDebug());
+      }
+      UseServicesHelper::debugAppend(resultEl, socketsEl);
+
+      UseServicesHelper::debugAppend(resultEl, "pending tcp connections", mPendingTCPConnections.size());
+      UseServicesHelper::debugAppend(resultEl, "pending tcp timers", mPendingTCPTimers.size());
+      UseServicesHelper::debugAppend(resultEl, "pending tcp timer", mPendingTCPTimer ? mPendingTCPTimer->getID() : 0);
+      UseServicesHelper::debugAppend(resultEl, "routes", mRoutes.size());
+      UseServicesHelper::debugAppend(resultEl, "username frags", mUsernameFrags.size());
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    ICESharedPort::SharedSocketPtr ICESharedPort::bindSharedSocket(
+                                                                   const IPAddress &hostIP,
+                                                                   IICETypes::Protocols protocol
+                                                                   )
+    {
+      auto shared = make_shared<SharedSocket>();
+      shared->mProtocol = protocol;
+      shared->mHostIP = hostIP;
+      shared->mBoundIP = hostIP;
+      shared->mBoundIP.setPort(mPort);
+
+      auto createFamily = (hostIP.isIPv6() ? Socket::Create::IPv6 : Socket::Create::IPv4);
+
+      try {
+        switch (protocol) {
+          case IICETypes::Protocol_UDP: shared->mSocket = Socket::createUDP(createFamily); break;
+          case IICETypes::Protocol_TCP: shared->mSocket = Socket::createTCP(createFamily); break;
+        }
+
+        if (IICETypes::Protocol_TCP == protocol) {
+          shared->mSocket->setOptionFlag(Socket::SetOptionFlag::ReuseAddress, true);
+        }
+
+        shared->mSocket->bind(shared->mBoundIP);
+        shared->mSocket->setBlocking(false);
+
+        try {
+#ifndef __QNX__
+          shared->mSocket->setOptionFlag(Socket::SetOptionFlag::IgnoreSigPipe, true);
+#endif //ndef __QNX__
+        } catch(Socket::Exceptions::UnsupportedSocketOption &) {
+        }
+
+        if (IICETypes::Protocol_TCP == protocol) {
+          shared->mSocket->listen();
+        }
+      } catch(Socket::Exceptions::Unspecified &error) {
+        ZS_LOG_ERROR(Detail, log("unable to bind shared socket") + ZS_PARAM("ip", shared->mBoundIP.string()) + ZS_PARAM("protocol", IICETypes::toString(protocol)) + ZS_PARAM("error", error.errorCode()))
+        return SharedSocketPtr();
+      }
+
+      mSharedSockets[HostIPProtocolPair(hostIP, protocol)] = shared;
+      mSocketToSharedSockets[shared->mSocket.get()] = shared;
+
+      // TCP stays on the socket monitor (see ICEGatherer::monitorUDPSocket)
+      if ((IICETypes::Protocol_TCP == protocol) ||
+          (!SocketReactor::monitor(shared->mSocket, mThisWeak.lock()))) {
+        shared->mSocket->setDelegate(mThisWeak.lock());
+      }
+
+      ZS_LOG_DETAIL(log("bound shared socket") + shared->toDebug())
+      return shared;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::closeSharedSocket(SharedSocketPtr shared)
+    {
+      ZS_LOG_DETAIL(log("closing shared socket") + shared->toDebug())
+
+      mSharedSockets.erase(HostIPProtocolPair(shared->mHostIP, shared->mProtocol));
+      mSocketToSharedSockets.erase(shared->mSocket.get());
+
+      // scope: forget routes through this socket
+      {
+        for (auto iter_doNotUse = mRoutes.begin(); iter_doNotUse != mRoutes.end(); ) {
+          auto current = iter_doNotUse;
+          ++iter_doNotUse;
+
+          if ((*current).first.first != shared->mID) continue;
+          mRoutes.erase(current);
+        }
+      }
+
+      SocketReactor::unmonitor(shared->mSocket);
+
+      try {
+        shared->mSocket->close();
+      } catch(Socket::Exceptions::Unspecified &error) {
+        ZS_LOG_WARNING(Detail, log("failed to close shared socket") + ZS_PARAM("error", error.errorCode()))
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::readUDP(SharedSocketPtr shared)
+    {
+      typedef UDPBatchReceiver::DatagramList DatagramList;
+
+      // NOTE: no lock is held while reading or while calling into a gatherer
+      //       (gatherers call back into this object while holding their own
+      //       lock)
+
+      auto &receiver = shared->mReceiver;
+
+      while (true) {
+        bool wouldBlock = false;
+        int errorCode = 0;
+
+        size_t totalRead = receiver.receive(shared->mSocket, wouldBlock, errorCode);
+        if (0 == totalRead) {
+          if (0 != errorCode) {
+            ZS_LOG_WARNING(Debug, log("shared socket read error") + ZS_PARAM("error", errorCode) + shared->toDebug())
+          }
+          return;
+        }
+
+        auto &datagrams = receiver.datagrams();
+
+        Time tick = zsLib::now();
+
+        UseGathererPtr currentGatherer;
+        DatagramList currentDatagrams;
+
+        for (size_t index = 0; index < totalRead; ++index) {
+          auto &datagram = datagrams[index];
+
+          bool learned = false;
+          UseGathererPtr gatherer = findRoute(*shared, datagram.mFromIP, tick, learned);
+
+          if ((!gatherer) || (learned)) {
+            // only STUN may introduce a new remote address and binding
+            // requests follow their username fragment until a gatherer
+            // routes the remote itself (thus a spoofed request can never
+            // redirect a remote another gatherer has validated)
+            const BYTE *buffer = datagram.mBuffer->BytePtr();
+            auto packetType = PacketDemux::classify(buffer, datagram.mSize);
+            if (!PacketDemux::isSTUNCandidate(packetType, buffer, datagram.mSize)) {
+              if (!gatherer) {
+                ZS_LOG_TRACE(log("dropping datagram from unknown remote") + ZS_PARAM("from ip", datagram.mFromIP.string()) + ZS_PARAM("size", datagram.mSize))
+                continue;
+              }
+              goto route_datagram;
+            }
+
+            auto stunPacket = STUNPacket::parseIfSTUN(buffer, datagram.mSize, mSTUNPacketParseOptions);
+            if (!stunPacket) {
+              if (!gatherer) continue;
+              goto route_datagram;
+            }
+
+            PUID gathererID {};
+            auto usernameFragGatherer = findUsernameFrag(stunPacket, gathererID);
+            if (usernameFragGatherer) {
+              gatherer = usernameFragGatherer;
+              goto route_datagram;
+            }
+
+            if (!gatherer) {
+              // e.g. responses to server reflexive discovery requests
+              if (UseSTUNRequester::handleSTUNPacket(datagram.mFromIP, stunPacket)) continue;
+              ZS_LOG_TRACE(log("dropping unroutable STUN packet") + ZS_PARAM("from ip", datagram.mFromIP.string()) + stunPacket->toDebug())
+              continue;
+            }
+          }
+
+        route_datagram:
+          if ((currentGatherer) &&
+              (currentGatherer != gatherer)) {
+            currentGatherer->notifySharedUDPDatagrams(shared->mSocket, currentDatagrams);
+            currentDatagrams.clear();
+          }
+
+          currentGatherer = gatherer;
+          currentDatagrams.push_back(std::move(datagram));
+        }
+
+        if (currentGatherer) {
+          currentGatherer->notifySharedUDPDatagrams(shared->mSocket, currentDatagrams);
+        }
+
+        if (!receiver.moreMayBePending()) return;
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::acceptTCP(SharedSocketPtr listener)
+    {
+      while (true) {
+        auto pending = make_shared<PendingTCPConnection>();
+        pending->mListener = listener;
+        pending->mAccepted = zsLib::now();
+
+        try {
+          bool wouldBlock = false;
+          pending->mSocket = listener->mSocket->accept(pending->mRemoteIP, &wouldBlock);
+          if (wouldBlock) return;
+          if (!pending->mSocket) return;
+
+          pending->mSocket->setBlocking(false);
+        } catch(Socket::Exceptions::Unspecified &error) {
+          ZS_LOG_WARNING(Detail, log("failed to accept incoming TCP connection") + ZS_PARAM("error", error.errorCode()))
+          return;
+        }
+
+        bool tooMany = false;
+
+        {
+          AutoLock lock(mLock);
+
+          // connections that never identify themselves are expired by the
+          // pending TCP timer
+          tooMany = (mPendingTCPConnections.size() >= mMaxPendingTCPConnections);
+          if (!tooMany) {
+            mPendingTCPConnections[pending->mSocket.get()] = pending;
+            pending->mExpiryTimer = mPendingTCPTimers.add(pending->mAccepted + mPendingTCPTimeout, pending);
+            stepPendingTCPTimer();
+          }
+        }
+
+        if (tooMany) {
+          ZS_LOG_WARNING(Detail, log("too many pending TCP connections (refusing connection)") + ZS_PARAM("remote ip", pending->mRemoteIP.string()))
+          closePendingTCP(pending);
+          continue;
+        }
+
+        ZS_LOG_DEBUG(log("accepted TCP connection (waiting for binding request)") + ZS_PARAM("remote ip", pending->mRemoteIP.string()) + listener->toDebug())
+
+        pending->mSocket->setDelegate(mThisWeak.lock());
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::readPendingTCP(PendingTCPConnectionPtr pending)
+    {
+      BYTE buffer[kFramedSTUNMaximumSize];
+      size_t available = 0;
+
+      // peek so the gatherer reads the framed binding request itself
+      try {
+        bool wouldBlock = false;
+        available = pending->mSocket->receive(&(buffer[0]), sizeof(buffer), &wouldBlock, static_cast<ULONG>(Socket::Receive::Peek));
+        if (wouldBlock) return;
+        if (0 == available) {
+          closePendingTCP(pending);
+          return;
+        }
+      } catch(Socket::Exceptions::Unspecified &error) {
+        ZS_LOG_WARNING(Debug, log("unable to read pending TCP connection") + ZS_PARAM("error", error.errorCode()))
+        closePendingTCP(pending);
+        return;
+      }
+
+      if (available < kFramedSTUNMinimumSize) return;
+
+      size_t frameSize = (static_cast<size_t>(buffer[0]) << 8) | static_cast<size_t>(buffer[1]);
+      if (sizeof(WORD) + frameSize > sizeof(buffer)) {
+        ZS_LOG_WARNING(Debug, log("first framed packet is too large to be a binding request") + ZS_PARAM("size", frameSize) + ZS_PARAM("remote ip", pending->mRemoteIP.string()))
+        closePendingTCP(pending);
+        return;
+      }
+      if (available < sizeof(WORD) + frameSize) return;
+
+      PUID gathererID {};
+      UseGathererPtr gatherer;
+
+      auto stunPacket = STUNPacket::parseIfSTUN(&(buffer[sizeof(WORD)]), frameSize, mSTUNPacketParseOptions);
+      if (stunPacket) {
+        gatherer = findUsernameFrag(stunPacket, gathererID);
+      }
+
+      if (!gatherer) {
+        ZS_LOG_WARNING(Debug, log("TCP connection did not start with a routable binding request") + ZS_PARAM("remote ip", pending->mRemoteIP.string()))
+        closePendingTCP(pending);
+        return;
+      }
+
+      forgetPendingTCP(pending);
+
+      ZS_LOG_DEBUG(log("handing TCP connection to gatherer") + ZS_PARAM("gatherer", gathererID) + ZS_PARAM("remote ip", pending->mRemoteIP.string()))
+      gatherer->notifySharedTCPConnection(pending->mListener->mSocket, pending->mSocket, pending->mRemoteIP);
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::closePendingTCP(PendingTCPConnectionPtr pending)
+    {
+      forgetPendingTCP(pending);
+
+      try {
+        pending->mSocket->close();
+      } catch(Socket::Exceptions::Unspecified &error) {
+        ZS_LOG_WARNING(Debug, log("failed to close pending TCP connection") + ZS_PARAM("error", error.errorCode()))
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::forgetPendingTCP(PendingTCPConnectionPtr pending)
+    {
+      AutoLock lock(mLock);
+      mPendingTCPConnections.erase(pending->mSocket.get());
+
+      if (0 != pending->mExpiryTimer) {
+        mPendingTCPTimers.cancel(pending->mExpiryTimer);
+        pending->mExpiryTimer = 0;
+      }
+
+      stepPendingTCPTimer();
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::stepPendingTCPTimer()
+    {
+      Time wakeUp = mPendingTCPTimers.nextWakeUp();
+
+      if (Time() == wakeUp) {
+        if (!mPendingTCPTimer) return;
+
+        ZS_LOG_TRACE(log("no more pending TCP connections (stopping pending TCP timer)"))
+
+        mPendingTCPTimer->cancel();
+        mPendingTCPTimer.reset();
+        return;
+      }
+
+      if (mShutdown) return;
+
+      if (mPendingTCPTimer) {
+        if (mPendingTCPTimerWakeUp <= wakeUp) return;
+        mPendingTCPTimer->cancel();
+        mPendingTCPTimer.reset();
+      }
+
+      mPendingTCPTimer = Timer::create(mThisWeak.lock(), wakeUp);
+      mPendingTCPTimerWakeUp = wakeUp;
+    }
+
+    //-------------------------------------------------------------------------
+    ICESharedPort::UseGathererPtr ICESharedPort::findRoute(
+                                                           const SharedSocket &shared,
+                                                           const IPAddress &remoteIP,
+                                                           const Time &tick,
+                                                           bool &outLearned
+                                                           )
+    {
+      outLearned = false;
+
+      AutoLock lock(mLock);
+
+      purgeLearnedRoutes(tick);
+
+      auto found = mRoutes.find(SharedSocketRemoteIPPair(shared.mID, remoteIP));
+      if (found == mRoutes.end()) return UseGathererPtr();
+
+      auto &target = (*found).second;
+
+      auto gatherer = target.mGatherer.lock();
+      if (!gatherer) {
+        mRoutes.erase(found);
+        return UseGathererPtr();
+      }
+
+      if (0 == target.mReferences) {
+        if (target.mLastUsed + mLearnedRouteTimeout <= tick) {
+          ZS_LOG_TRACE(log("learned route expired") + ZS_PARAM("remote ip", remoteIP.string()) + ZS_PARAM("gatherer", target.mGathererID))
+          mRoutes.erase(found);
+          return UseGathererPtr();
+        }
+        target.mLastUsed = tick;
+        outLearned = true;
+      }
+      return gatherer;
+    }
+
+    //-------------------------------------------------------------------------
+    ICESharedPort::UseGathererPtr ICESharedPort::findUsernameFrag(
+                                                                  STUNPacketPtr stunPacket,
+                                                                  PUID &outGathererID
+                                                                  )
+    {
+      if ((STUNPacket::Class_Request != stunPacket->mClass) ||
+          (STUNPacket::Method_Binding != stunPacket->mMethod)) return UseGathererPtr();
+
+      const String &username = stunPacket->mUsername;
+
+      auto pos = username.find(':');
+      if (pos == String::npos) return UseGathererPtr();
+
+      String lFrag = username.substr(0, pos);
+
+      AutoLock lock(mLock);
+
+      auto found = mUsernameFrags.find(lFrag);
+      if (found == mUsernameFrags.end()) return UseGathererPtr();
+
+      auto gatherer = (*found).second.mGatherer.lock();
+      if (!gatherer) {
+        mUsernameFrags.erase(found);
+        return UseGathererPtr();
+      }
+
+      outGathererID = (*found).second.mGathererID;
+      return gatherer;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICESharedPort::purgeLearnedRoutes(const Time &tick)
+    {
+      if (tick < mNextLearnedRoutePurge) return;
+      mNextLearnedRoutePurge = tick + mLearnedRouteTimeout;
+
+      for (auto iter_doNotUse = mRoutes.begin(); iter_doNotUse != mRoutes.end(); ) {
+        auto current = iter_doNotUse;
+        ++iter_doNotUse;
+
+        auto &target = (*current).second;
+        if (0 != target.mReferences) continue;
+        if (target.mLastUsed + mLearnedRouteTimeout > tick) continue;
+
+        mRoutes.erase(current);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    bool ICESharedPort::evictLearnedRoute()
+    {
+      auto oldest = mRoutes.end();
+
+      for (auto iter = mRoutes.begin(); iter != mRoutes.end(); ++iter) {
+        auto &target = (*iter).second;
+        if (0 != target.mReferences) continue;
+        if (oldest != mRoutes.end()) {
+          if ((*oldest).second.mLastUsed <= target.mLastUsed) continue;
+        }
+        oldest = iter;
+      }
+
+      if (oldest == mRoutes.end()) return false;
+
+      ZS_LOG_TRACE(log("evicting least recently used learned route") + ZS_PARAM("remote ip", (*oldest).first.second.string()) + ZS_PARAM("gatherer", (*oldest).second.mGathererID))
+      mRoutes.erase(oldest);
+      return true;
+    }
+
+  }
+}
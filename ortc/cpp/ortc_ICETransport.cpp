@@ -130,6 +130,7 @@ namespace ortc
 
       UseSettings::setUInt(ORTC_SETTING_ICE_TRANSPORT_KEEP_WARM_TIME_BASE_IN_MILLISECONDS, 4000);
       UseSettings::setUInt(ORTC_SETTING_ICE_TRANSPORT_KEEP_WARM_TIME_RANDOMIZED_ADD_TIME_IN_MILLISECONDS, 2000);
+      UseSettings::setUInt(ORTC_SETTING_ICE_TRANSPORT_KEEP_WARM_TIMER_RESOLUTION_IN_MILLISECONDS, 20);
 
       UseSettings::setBool(ORTC_SETTING_ICE_TRANSPORT_TEST_CANDIDATE_PAIRS_OF_LOWER_PREFERENCE, false);
 
@@ -186,6 +187,7 @@ namespace ortc
       SharedRecursiveLock(SharedRecursiveLock::create()),
       mGatherer(ICEGatherer::convert(gatherer)),
       mRouteStateTracker(make_shared<RouteStateTracker>(mID)),
+      mNextKeepWarmTimers(Milliseconds(UseSettings::getUInt(ORTC_SETTING_ICE_TRANSPORT_KEEP_WARM_TIMER_RESOLUTION_IN_MILLISECONDS))),
       mNoPacketsReceivedRecheckTime(UseSettings::getUInt(ORTC_SETTING_ICE_TRANSPORT_NO_PACKETS_RECEVIED_RECHECK_CANDIDATES_IN_SECONDS)),
       mExpireRouteTime(UseSettings::getUInt(ORTC_SETTING_ICE_TRANSPORT_EXPIRE_ROUTE_IN_SECONDS)),
       mTestLowerPreferenceCandidatePairs(UseSettings::getBool(ORTC_SETTING_ICE_TRANSPORT_TEST_CANDIDATE_PAIRS_OF_LOWER_PREFERENCE)),
@@ -526,6 +528,8 @@ namespace ortc
         mGathererRouter = gatherer->getGathererRouter();
         ZS_THROW_INVALID_ASSUMPTION_IF(!mGathererRouter)
 
+        mICELite = mGatherer->isICELite();
+
         mGatherer->installTransport(mThisWeak.lock(), String());
         mGathererSubscription = mGatherer->subscribe(mThisWeak.lock());
 
@@ -549,6 +553,12 @@ namespace ortc
         }
       }
 
+      if (mICELite) {
+        ZS_LOG_DETAIL(log("ice lite gatherer attached (thus only answering checks in the controlled role)"))
+        mOptions.mRole = IICETypes::Role_Controlled;
+        mOptionsHash = mOptions.hash();
+      }
+
       wakeUp();
     }
 
@@ -1010,11 +1020,12 @@ namespace ortc
           }
         }
 
-        if ((route->isNew()) ||
-            (route->isFrozen()) ||
-            (route->isPending()) ||
-            (route->isFailed()) ||
-            (route->isIgnored())) {
+        if ((!mICELite) &&
+            ((route->isNew()) ||
+             (route->isFrozen()) ||
+             (route->isPending()) ||
+             (route->isFailed()) ||
+             (route->isIgnored()))) {
           if (mRemoteParameters.mUsernameFragment.hasData()) {
             ZS_LOG_DETAIL(log("going to activate candidate pair because of incoming request") + route->toDebug())
             route->trace(__func__, "activate route (due to incoming request)");
@@ -1032,6 +1043,11 @@ namespace ortc
         ZS_LOG_TRACE(log("sending binding response to remote party") + route->toDebug() + response->toDebug())
         sendPacket(routerRoute, response);
 
+        if (mICELite) {
+          handleLiteBindingRequest(route, packet);
+          return;
+        }
+
         if (IICETypes::Role_Controlled == mOptions.mRole) {
           if (packet->mUseCandidateIncluded) {
             auto previousRoute = mActiveRoute;
@@ -1085,6 +1101,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     void ICETransport::notifyPacket(
                                     RouterRoutePtr routerRoute,
+                                    PacketDemux::PacketTypes packetType,
                                     const BYTE *buffer,
                                     size_t bufferSizeInBytes
                                     )
@@ -1130,9 +1147,9 @@ namespace ortc
           // packets must be buffered
           ZS_LOG_TRACE(log("buffering packet for secure transport") + ZS_PARAM("buffer length", bufferSizeInBytes))
           EventWriteOrtcIceTransportBufferingIncomingPacket(__func__, mID, SafeInt<unsigned int>(bufferSizeInBytes), buffer);
-          mBufferedPackets.push(make_shared<SecureByteBlock>(buffer, bufferSizeInBytes));
+          mBufferedPackets.push(TypedPacket(packetType, make_shared<SecureByteBlock>(buffer, bufferSizeInBytes)));
           while (mBufferedPackets.size() > mMaxBufferedPackets) {
-            auto &poppedBuffer = mBufferedPackets.front();
+            auto &poppedBuffer = mBufferedPackets.front().second;
             (void)poppedBuffer;
             EventWriteOrtcIceTransportDisposingBufferedIncomingPacket(__func__, mID, SafeInt<unsigned int>(poppedBuffer->SizeInBytes()), poppedBuffer->BytePtr());
             ZS_LOG_TRACE(log("too many packets in buffered packet list (dropping packet") + ZS_PARAM("max packets", mMaxBufferedPackets) + ZS_PARAM("total packets", mBufferedPackets.size()))
@@ -1147,7 +1164,7 @@ namespace ortc
     forward_attached_secure_transport:
       {
         EventWriteOrtcIceTransportDeliveringIncomingPacketToSecureTransport(__func__, mID, transport->getID(), SafeInt<unsigned int>(bufferSizeInBytes), buffer);
-        bool handled = transport->handleReceivedPacket(mComponent, buffer, bufferSizeInBytes);
+        bool handled = transport->handleReceivedPacket(mComponent, packetType, buffer, bufferSizeInBytes);
 
         if (!handled) goto forward_old_transport;
         return;
@@ -1165,7 +1182,7 @@ namespace ortc
         }
 
         EventWriteOrtcIceTransportDeliveringIncomingPacketToSecureTransport(__func__, mID, transport->getID(), SafeInt<unsigned int>(bufferSizeInBytes), buffer);
-        bool handled = transport->handleReceivedPacket(mComponent, buffer, bufferSizeInBytes);
+        bool handled = transport->handleReceivedPacket(mComponent, packetType, buffer, bufferSizeInBytes);
         if (!handled) {
           AutoRecursiveLock lock(*this);
 
@@ -1399,6 +1416,48 @@ namespace ortc
       return gatherer->sendPacket(*this, routerRoute, buffer, bufferSizeInBytes);
     }
 
+    //-------------------------------------------------------------------------
+    bool ICETransport::sendPackets(
+                                   IICETypes::Components sendOverICETransport,
+                                   const UDPBatchSender::PacketList &packets
+                                   )
+    {
+      if (packets.size() < 1) return true;
+
+      UseICEGathererPtr gatherer;
+      RouterRoutePtr routerRoute;
+      ICETransportPtr rtcpTransport;
+
+      {
+        AutoRecursiveLock lock(*this);
+
+        if (sendOverICETransport != mComponent) {
+          if (IICETypes::Component_RTCP == sendOverICETransport) rtcpTransport = mRTCPTransport;
+          if (!rtcpTransport) {
+            ZS_LOG_WARNING(Debug, log("no transport for component") + ZS_PARAM("send over component", IICETypes::toString(sendOverICETransport)) + ZS_PARAM("total", packets.size()))
+            return false;
+          }
+          goto send_via_rtcp_transport;
+        }
+
+        if (!installGathererRoute(mActiveRoute)) {
+          ZS_LOG_WARNING(Trace, log("cannot install a gatherer route") + (mActiveRoute ? mActiveRoute->toDebug() : ElementPtr()) + ZS_PARAM("total", packets.size()))
+          return false;
+        }
+
+        gatherer = mGatherer;
+        routerRoute = mActiveRoute->mGathererRoute;
+      }
+
+      routerRoute->trace(__func__, "gatherer to use this route to send secure packets");
+      return gatherer->sendPackets(*this, routerRoute, packets);
+
+    send_via_rtcp_transport:
+      {
+        return rtcpTransport->sendPackets(sendOverICETransport, packets);
+      }
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -1516,12 +1575,13 @@ namespace ortc
       }
 
       while (packets.size() > 0) {
-        SecureByteBlockPtr deliverPacket = packets.front();
+        PacketDemux::PacketTypes packetType = packets.front().first;
+        SecureByteBlockPtr deliverPacket = packets.front().second;
         packets.pop();
 
         {
           EventWriteOrtcIceTransportDeliveringBufferedIncomingPacketToSecureTransport(__func__, mID, transport->getID(), SafeInt<unsigned int>(deliverPacket->SizeInBytes()), deliverPacket->BytePtr());
-          bool handled = transport->handleReceivedPacket(mComponent, deliverPacket->BytePtr(), deliverPacket->SizeInBytes());
+          bool handled = transport->handleReceivedPacket(mComponent, packetType, deliverPacket->BytePtr(), deliverPacket->SizeInBytes());
 
           if (!handled) goto forward_old_transport;
           goto deliver_next;
@@ -1540,7 +1600,7 @@ namespace ortc
           }
 
           EventWriteOrtcIceTransportDeliveringBufferedIncomingPacketToSecureTransport(__func__, mID, oldTransport->getID(), SafeInt<unsigned int>(deliverPacket->SizeInBytes()), deliverPacket->BytePtr());
-          bool handled = oldTransport->handleReceivedPacket(mComponent, deliverPacket->BytePtr(), deliverPacket->SizeInBytes());
+          bool handled = oldTransport->handleReceivedPacket(mComponent, packetType, deliverPacket->BytePtr(), deliverPacket->SizeInBytes());
           if (!handled) {
             AutoRecursiveLock lock(*this);
 
@@ -1623,24 +1683,15 @@ namespace ortc
         return;
       }
 
-      // scope: check keep warm timers
-      {
-        auto found = mNextKeepWarmTimers.find(timer);
-        if (found == mNextKeepWarmTimers.end()) goto not_a_keep_warm_timer;
-
+      if (timer == mKeepWarmTimer) {
         EventWriteOrtcIceTransportInternalTimerEventFired(__func__, mID, timer->getID(), "next keep warm timer");
-
-        RoutePtr route = (*found).second;
-        mNextKeepWarmTimers.erase(found);
-        handleNextKeepWarmTimer(route);
+        mKeepWarmTimer.reset();
+        handleKeepWarmTimers();
         return;
       }
 
-    not_a_keep_warm_timer:
-      {
-        EventWriteOrtcIceTransportInternalTimerEventFired(__func__, mID, timer->getID(), "obsolete timer");
-        ZS_LOG_WARNING(Trace, log("notified about an obsolete timer") + ZS_PARAM("timer id", timer->getID()))
-      }
+      EventWriteOrtcIceTransportInternalTimerEventFired(__func__, mID, timer->getID(), "obsolete timer");
+      ZS_LOG_WARNING(Trace, log("notified about an obsolete timer") + ZS_PARAM("timer id", timer->getID()))
     }
 
     //-------------------------------------------------------------------------
@@ -2076,8 +2127,7 @@ namespace ortc
 
       if ((keptWarm) &&
           (!route->mNextKeepWarm)) {
-        route->mNextKeepWarm = Timer::create(mThisWeak.lock(), zsLib::now() + mKeepWarmTimeBase + Milliseconds(UseServicesHelper::random(0, static_cast<size_t>(mKeepWarmTimeRandomizedAddTime.count()))));
-        mNextKeepWarmTimers[route->mNextKeepWarm] = route;
+        installKeepWarmTimer(route, zsLib::now() + mKeepWarmTimeBase + Milliseconds(UseServicesHelper::random(0, static_cast<size_t>(mKeepWarmTimeRandomizedAddTime.count()))));
 
         ZS_LOG_TRACE(log("installed keep warm timer") + route->toDebug())
       }
@@ -2182,6 +2232,7 @@ namespace ortc
 
       UseServicesHelper::debugAppend(resultEl, "options hash", mOptionsHash);
       UseServicesHelper::debugAppend(resultEl, "options", mOptions.toDebug());
+      UseServicesHelper::debugAppend(resultEl, "ice lite", mICELite);
       UseServicesHelper::debugAppend(resultEl, "conflict resolver", mConflictResolver);
 
       UseServicesHelper::debugAppend(resultEl, "remote parameters hash", mRemoteParametersHash);
@@ -2203,7 +2254,9 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "activation timer", mActivationTimer ? mActivationTimer->getID() : 0);
       UseServicesHelper::debugAppend(resultEl, "activate routes that received checks", mNextActivationCausesAllRoutesThatReceivedChecksToActivate);
 
+      UseServicesHelper::debugAppend(resultEl, "new routes", mNewRoutes.size());
       UseServicesHelper::debugAppend(resultEl, "pending activation", mPendingActivation.size());
+      UseServicesHelper::debugAppend(resultEl, "deferred activation", mTotalDeferredActivation);
 
       UseServicesHelper::debugAppend(resultEl, "frozen", mFrozen.size());
 
@@ -2215,6 +2268,8 @@ namespace ortc
 
       UseServicesHelper::debugAppend(resultEl, "outgoing checks", mOutgoingChecks.size());
       UseServicesHelper::debugAppend(resultEl, "next keep warm timers", mNextKeepWarmTimers.size());
+      UseServicesHelper::debugAppend(resultEl, "keep warm timer", mKeepWarmTimer ? mKeepWarmTimer->getID() : 0);
+      UseServicesHelper::debugAppend(resultEl, "keep warm timer wake up", mKeepWarmTimerWakeUp);
 
       UseServicesHelper::debugAppend(resultEl, "use candidate route", mUseCandidateRoute ? mUseCandidateRoute->toDebug() : ElementPtr());
       UseServicesHelper::debugAppend(resultEl, "use candidate request", mUseCandidateRequest ? mUseCandidateRequest->getID() : 0);
@@ -2278,6 +2333,14 @@ namespace ortc
 
       EventWriteOrtcIceTransportStep(__func__, mID);
 
+      if (mICELite) {
+        // an ice lite agent never pairs candidates, sends checks or keeps
+        // routes warm; routes only come into existence from validated
+        // incoming checks and only need to expire when consent stops
+        stepExpireRouteTimer();
+        goto done;
+      }
+
       if (!stepCalculateLegalPairs()) goto done;
       if (!stepPendingActivation()) goto done;
       if (!stepActivationTimer()) goto done;
@@ -2421,6 +2484,7 @@ namespace ortc
 
         ZS_LOG_DEBUG(log("found new legal route") + route->toDebug())
         mLegalRoutes[hash] = route;
+        mNewRoutes.push_back(route);
 
         installFoundation(route);
       }
@@ -2445,6 +2509,7 @@ namespace ortc
 
       if (0 == mRouteStateTracker->count(Route::State_New)) {
         ZS_LOG_TRACE(log("no routes pending activation"))
+        mNewRoutes.clear();
         return true;
       }
 
@@ -2455,21 +2520,16 @@ namespace ortc
 
       ZS_LOG_DEBUG(log("calculating pending activation"))
 
-      for (auto iter = mLegalRoutes.begin(); iter != mLegalRoutes.end(); ++iter)
+      // only routes created since the last step need to be examined
+      RouteList newRoutes;
+      newRoutes.swap(mNewRoutes);
+
+      for (auto iter = newRoutes.begin(); iter != newRoutes.end(); ++iter)
       {
-        auto hash = (*iter).first;
-        auto route = (*iter).second;
+        auto route = (*iter);
 
         if (route->state() != Route::State_New) continue;
-
-        auto found = mPendingActivation.find(route->mPendingPriority);
-        if (found != mPendingActivation.end()) {
-          if ((*found).second == route) {
-            ZS_LOG_TRACE(log("route is already pending activation") + route->toDebug())
-            continue;
-          }
-          route->mPendingPriority = 0;
-        }
+        if (route->mPrune) continue;
 
         ZS_LOG_DEBUG(log("route is now pending activation") + route->toDebug())
         setPending(route);
@@ -2507,7 +2567,7 @@ namespace ortc
         }
       }
 
-      if (mPendingActivation.size() > 0) {
+      if (hasPendingActivation()) {
         ZS_LOG_TRACE(log("need activation timer as routes are pending activation"))
         goto need_activation_timer;
       }
@@ -2784,8 +2844,7 @@ namespace ortc
 
           ZS_LOG_DEBUG(log("installing keep warm timer") + route->toDebug())
 
-          route->mNextKeepWarm = Timer::create(mThisWeak.lock(), zsLib::now() + mKeepWarmTimeBase + Milliseconds(UseServicesHelper::random(0, static_cast<size_t>(mKeepWarmTimeRandomizedAddTime.count()))));
-          mNextKeepWarmTimers[route->mNextKeepWarm] = route;
+          installKeepWarmTimer(route, zsLib::now() + mKeepWarmTimeBase + Milliseconds(UseServicesHelper::random(0, static_cast<size_t>(mKeepWarmTimeRandomizedAddTime.count()))));
           continue;
         }
       do_not_keep_warm:
@@ -2896,6 +2955,28 @@ namespace ortc
     {
       EventWriteOrtcIceTransportStep(__func__, mID);
 
+      if (mICELite) {
+        if (mActiveRoute) {
+          ZS_LOG_INSANE(debug("state is ice lite connected (controlling party nominated a route)"))
+          setState(mLocalCandidatesComplete ? IICETransport::State_Completed : IICETransport::State_Connected);
+          return true;
+        }
+        if (mRemoteParameters.mUsernameFragment.isEmpty()) {
+          ZS_LOG_INSANE(log("state is new (ice lite has no remote parameters)"))
+          setState(IICETransport::State_New);
+          return true;
+        }
+        if ((IICETransport::State_New == mCurrentState) ||
+            (IICETransport::State_Checking == mCurrentState)) {
+          ZS_LOG_INSANE(debug("state is checking (ice lite waiting for controlling party to nominate a route)"))
+          setState(IICETransport::State_Checking);
+          return true;
+        }
+        ZS_LOG_INSANE(debug("state is disconnected (ice lite lost nominated route)"))
+        setState(IICETransport::State_Disconnected);
+        return true;
+      }
+
       if ((mRemoteCandidates.size() < 1) &&
           (!mRemoteCandidatesComplete)) {
         ZS_LOG_INSANE(log("state is new (no remote candidates found)") + ZS_PARAM("total remote candidates", mRemoteCandidates.size()))
@@ -3059,7 +3140,10 @@ namespace ortc
         mActivationTimer.reset();
       }
 
+      mNewRoutes.clear();
       mPendingActivation.clear();
+      mDeferredActivation.clear();
+      mTotalDeferredActivation = 0;
 
       for (auto iter_doNotUse = mFrozen.begin(); iter_doNotUse != mFrozen.end(); ) {
         auto current = iter_doNotUse;
@@ -3077,6 +3161,10 @@ namespace ortc
 
       mOutgoingChecks.clear();
       mNextKeepWarmTimers.clear();
+      if (mKeepWarmTimer) {
+        mKeepWarmTimer->cancel();
+        mKeepWarmTimer.reset();
+      }
 
       mUseCandidateRoute.reset();
       if (mUseCandidateRequest) {
@@ -3294,11 +3382,17 @@ namespace ortc
       if (mNextActivationCausesAllRoutesThatReceivedChecksToActivate) {
         bool didActivate = false;
 
-        for (auto iter_doNotUse = mPendingActivation.begin(); iter_doNotUse != mPendingActivation.end(); ) {
-          auto current = iter_doNotUse;
-          ++iter_doNotUse;
+        // routes that received a check skip the foundation freezing rules
+        RoutePriorityQueue::ValueList pendingRoutes = mPendingActivation.values();
+        for (auto iter = mDeferredActivation.begin(); iter != mDeferredActivation.end(); ++iter) {
+          const RouteIDMap &routes = (*iter).second;
+          for (auto iterRoute = routes.begin(); iterRoute != routes.end(); ++iterRoute) {
+            pendingRoutes.push_back((*iterRoute).second);
+          }
+        }
 
-          auto route = (*current).second;
+        for (auto iter = pendingRoutes.begin(); iter != pendingRoutes.end(); ++iter) {
+          auto route = (*iter);
 
           if (IICETypes::Protocol_TCP == route->mCandidatePair->mLocal->mProtocol) {
             if (IICETypes::TCPCandidateType_Passive == route->mCandidatePair->mLocal->mTCPType) {
@@ -3314,7 +3408,7 @@ namespace ortc
           didActivate = true;
 
           setInProgress(route);
-          if (mPendingActivation.size() < 1) {
+          if (!hasPendingActivation()) {
             ZS_LOG_DEBUG(log("might not need activation timer anymore (thus waking up)"))
             wakeUp();
           }
@@ -3328,11 +3422,24 @@ namespace ortc
         }
       }
 
-      for (auto iter_doNotUse = mPendingActivation.begin(); iter_doNotUse != mPendingActivation.end(); ) {
-        auto current = iter_doNotUse;
-        ++iter_doNotUse;
+      releaseDeferredActivation();
 
-        auto route = (*current).second;
+      // one check is started per activation timer (Ta); highest priority
+      // first, with pairs whose foundation is still being checked deferred
+      while (true) {
+        RoutePtr route;
+
+        if (!mPendingActivation.empty()) {
+          route = mPendingActivation.top();
+
+          if (isFoundationBeingChecked(route)) {
+            deferPendingActivation(route);
+            continue;
+          }
+        } else {
+          route = unfreezeDeferredActivation();
+          if (!route) break;
+        }
 
         if (!mTestLowerPreferenceCandidatePairs) {
           if ((mActiveRoute) &&
@@ -3407,7 +3514,7 @@ namespace ortc
           ZS_LOG_DEBUG(log("activating route") + route->toDebug())
 
           setInProgress(route);
-          if (mPendingActivation.size() < 1) {
+          if (!hasPendingActivation()) {
             ZS_LOG_DEBUG(log("might not need activation timer anymore (thus waking up)"))
             wakeUp();
           }
@@ -3485,13 +3592,23 @@ namespace ortc
     }
 
     //-----------------------------------------------------------------------
-    void ICETransport::handleNextKeepWarmTimer(RoutePtr route)
+    void ICETransport::handleKeepWarmTimers()
     {
-      if (route->mNextKeepWarm) {
-        route->mNextKeepWarm->cancel();
-        route->mNextKeepWarm.reset();
+      RouteTimerWheel::ValueList fired;
+      mNextKeepWarmTimers.advance(zsLib::now(), fired);
+
+      for (auto iter = fired.begin(); iter != fired.end(); ++iter) {
+        handleNextKeepWarmTimer(*iter);
       }
 
+      stepKeepWarmTimer();
+    }
+
+    //-----------------------------------------------------------------------
+    void ICETransport::handleNextKeepWarmTimer(RoutePtr route)
+    {
+      route->mNextKeepWarm = 0;
+
       if (route->mOutgoingCheck) {
         ZS_LOG_TRACE(log("already have outgoing check (thus send a retry packet now)"))
         route->mOutgoingCheck->retryRequestNow();
@@ -3521,8 +3638,7 @@ namespace ortc
       route->trace(__func__, "forced active");
 
       // install a temporary keep warm timer (to force route activate sooner)
-      route->mNextKeepWarm = Timer::create(mThisWeak.lock(), zsLib::now() + Milliseconds(UseServicesHelper::random(0, static_cast<size_t>(mKeepWarmTimeRandomizedAddTime.count()))));
-      mNextKeepWarmTimers[route->mNextKeepWarm] = route;
+      installKeepWarmTimer(route, zsLib::now() + Milliseconds(UseServicesHelper::random(0, static_cast<size_t>(mKeepWarmTimeRandomizedAddTime.count()))));
 
       ZS_LOG_TRACE(log("forcing route to generate activity") + route->toDebug())
     }
@@ -3563,7 +3679,10 @@ namespace ortc
       mComputedPairsHash.clear();
 
       mFoundationRoutes.clear();
+      mNewRoutes.clear();
       mPendingActivation.clear();
+      mDeferredActivation.clear();
+      mTotalDeferredActivation = 0;
       mFrozen.clear();
       mGathererRoutes.clear();
       mOutgoingChecks.clear();
@@ -3622,11 +3741,8 @@ namespace ortc
           goto insert_pending;
         }
         case Route::State_Pending:    {
-          auto found = mPendingActivation.find(route->mPendingPriority);
-          if (found == mPendingActivation.end()) goto insert_pending;
-          if ((*found).second == route) return;
-
-          route->mPendingPriority = 0;
+          if (route->mPendingDeferred) return;
+          if (mPendingActivation.contains(route->mPendingEntry)) return;
           goto insert_pending;
         }
         case Route::State_Frozen:     {
@@ -3667,19 +3783,10 @@ namespace ortc
         removeWarm(route);
         route->mLastReceivedResponse = Time();  // need to recheck thus no response receieved
 
-        // NOTE: reversing priority value so largest value becomes smallest value
-        auto priority = (getMaxQWORD() ^ route->getActivationPriority(IICETypes::Role_Controlling == mOptions.mRole, mRemoteParameters.mUseUnfreezePriority));
-
-        auto found = mPendingActivation.find(priority);
-        while (found != mPendingActivation.end()) {
-          auto comparePriority = (*found).first;
-          if (priority != comparePriority) break;
-          ++priority;
-          ++found;
-        }
+        removePendingActivation(route);
 
-        route->mPendingPriority = priority;
-        mPendingActivation[priority] = route;
+        route->mPendingPriority = route->getActivationPriority(IICETypes::Role_Controlling == mOptions.mRole, mRemoteParameters.mUseUnfreezePriority);
+        route->mPendingEntry = mPendingActivation.push(route->mPendingPriority, route);
 
         route->state(Route::State_Pending);
       }
@@ -3993,7 +4100,8 @@ namespace ortc
 
       RoutePtr oldActiveRoute = mActiveRoute;
 
-      if (!mActiveRoute) {
+      if ((!mActiveRoute) &&
+          (!mICELite)) {
         if (Time() != route->mLastReceivedResponse) {
           ZS_LOG_DEBUG(log("setting route to active since received a response and no other route is available") + route->toDebug())
           mActiveRoute = route;
@@ -4052,6 +4160,50 @@ namespace ortc
       }
     }
 
+    //-------------------------------------------------------------------------
+    void ICETransport::handleLiteBindingRequest(
+                                                RoutePtr route,
+                                                STUNPacketPtr packet
+                                                )
+    {
+      // an ice lite agent never sends checks of its own thus a validated
+      // incoming check is the only proof of consent a route will ever get
+      if (mWarmRoutes.end() == mWarmRoutes.find(route->mCandidatePairHash)) {
+        ZS_LOG_DEBUG(log("ice lite route is now a success (validated incoming check)") + route->toDebug())
+        setSucceeded(route);
+      }
+
+      if (!packet->mUseCandidateIncluded) {
+        ZS_LOG_TRACE(log("ice lite check did not nominate route") + route->toDebug())
+        return;
+      }
+
+      auto previousUseCandidate = mLastReceivedUseCandidate;
+      mLastReceivedUseCandidate = mLastReceivedPacket;
+
+      if (mActiveRoute == route) {
+        ZS_LOG_TRACE(log("nominated route is already active") + route->toDebug())
+        return;
+      }
+
+      if ((mActiveRoute) &&
+          (Time() != previousUseCandidate) &&
+          (previousUseCandidate + Seconds(3) >= mLastReceivedPacket) &&
+          (mActiveRoute->getPreference(false) > route->getPreference(false))) {
+        ZS_LOG_DEBUG(log("keeping higher preference nominated route (aggressive 3 second rule)") + ZS_PARAM("new route", route->toDebug()) + ZS_PARAM("active route", mActiveRoute->toDebug()))
+        return;
+      }
+
+      mActiveRoute = route;
+      mActiveRoute->trace(__func__, "activating route (as route was nominated by controlling party)");
+
+      ZS_LOG_DETAIL(log("new route chosen") + mActiveRoute->toDebug())
+      EventWriteOrtcIceTransportCandidatePairChangedEventFired(__func__, mID, mActiveRoute->mID);
+      mSubscriptions.delegate()->onICETransportCandidatePairChanged(mThisWeak.lock(), cloneCandidatePair(mActiveRoute));
+
+      wakeUp();
+    }
+
     //-------------------------------------------------------------------------
     bool ICETransport::installGathererRoute(RoutePtr route)
     {
@@ -4199,13 +4351,125 @@ namespace ortc
     //-------------------------------------------------------------------------
     void ICETransport::removePendingActivation(RoutePtr route)
     {
-      auto found = mPendingActivation.find(route->mPendingPriority);
-      if (found != mPendingActivation.end()) {
-        mPendingActivation.erase(found);
+      if (route->mPendingEntry) {
+        mPendingActivation.erase(route->mPendingEntry);
+        route->mPendingEntry = 0;
       }
+
+      if (route->mPendingDeferred) {
+        route->mPendingDeferred = false;
+
+        LocalRemoteFoundationPair foundation(route->mCandidatePair->mLocal->mFoundation, route->mCandidatePair->mRemote->mFoundation);
+
+        auto found = mDeferredActivation.find(foundation);
+        if (found != mDeferredActivation.end()) {
+          RouteIDMap &routes = (*found).second;
+          if (routes.erase(route->mID) > 0) --mTotalDeferredActivation;
+          if (routes.size() < 1) mDeferredActivation.erase(found);
+        }
+      }
+
       route->mPendingPriority = 0;
     }
 
+    //-------------------------------------------------------------------------
+    bool ICETransport::hasPendingActivation() const
+    {
+      return (!mPendingActivation.empty()) || (0 != mTotalDeferredActivation);
+    }
+
+    //-------------------------------------------------------------------------
+    bool ICETransport::isFoundationBeingChecked(RoutePtr route) const
+    {
+      LocalRemoteFoundationPair foundation(route->mCandidatePair->mLocal->mFoundation, route->mCandidatePair->mRemote->mFoundation);
+
+      auto found = mFoundationRoutes.find(foundation);
+      if (found == mFoundationRoutes.end()) return false;
+
+      bool checking = false;
+
+      const RouteMap &routes = (*found).second;
+      for (auto iter = routes.begin(); iter != routes.end(); ++iter) {
+        auto compareRoute = (*iter).second;
+        if (compareRoute == route) continue;
+
+        // once any pair in the foundation succeeds the rest are unfrozen
+        if (compareRoute->isSucceeded()) return false;
+        if (compareRoute->isInProgress()) checking = true;
+      }
+      return checking;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICETransport::deferPendingActivation(RoutePtr route)
+    {
+      ZS_LOG_TRACE(log("deferring activation until foundation check completes") + route->toDebug())
+
+      auto priority = route->mPendingPriority;
+      removePendingActivation(route);
+      route->mPendingPriority = priority;
+
+      LocalRemoteFoundationPair foundation(route->mCandidatePair->mLocal->mFoundation, route->mCandidatePair->mRemote->mFoundation);
+
+      mDeferredActivation[foundation][route->mID] = route;
+      route->mPendingDeferred = true;
+      ++mTotalDeferredActivation;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICETransport::releaseDeferredActivation()
+    {
+      for (auto iter_doNotUse = mDeferredActivation.begin(); iter_doNotUse != mDeferredActivation.end(); ) {
+        auto current = iter_doNotUse;
+        ++iter_doNotUse;
+
+        RouteIDMap &routes = (*current).second;
+        if (routes.size() < 1) {
+          mDeferredActivation.erase(current);
+          continue;
+        }
+
+        if (isFoundationBeingChecked((*(routes.begin())).second)) continue;
+
+        ZS_LOG_TRACE(log("foundation check completed (thus releasing deferred routes)") + ZS_PARAM("local foundation", (*current).first.first) + ZS_PARAM("remote foundation", (*current).first.second) + ZS_PARAM("total", routes.size()))
+
+        for (auto iter = routes.begin(); iter != routes.end(); ++iter) {
+          auto route = (*iter).second;
+          route->mPendingDeferred = false;
+          route->mPendingEntry = mPendingActivation.push(route->mPendingPriority, route);
+        }
+
+        mTotalDeferredActivation -= routes.size();
+        mDeferredActivation.erase(current);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    ICETransport::RoutePtr ICETransport::unfreezeDeferredActivation()
+    {
+      RoutePtr bestRoute;
+
+      for (auto iter = mDeferredActivation.begin(); iter != mDeferredActivation.end(); ++iter) {
+        const RouteIDMap &routes = (*iter).second;
+        for (auto iterRoute = routes.begin(); iterRoute != routes.end(); ++iterRoute) {
+          auto route = (*iterRoute).second;
+          if ((!bestRoute) ||
+              (route->mPendingPriority > bestRoute->mPendingPriority)) {
+            bestRoute = route;
+          }
+        }
+      }
+
+      if (!bestRoute) return RoutePtr();
+
+      ZS_LOG_DEBUG(log("nothing else waiting (thus unfreezing deferred route)") + bestRoute->toDebug())
+
+      auto priority = bestRoute->mPendingPriority;
+      removePendingActivation(bestRoute);
+      bestRoute->mPendingPriority = priority;
+      return bestRoute;
+    }
+
     //-------------------------------------------------------------------------
     void ICETransport::removeOutgoingCheck(RoutePtr route)
     {
@@ -4239,19 +4503,53 @@ namespace ortc
       route->mGathererRoute.reset();
     }
     
+    //-------------------------------------------------------------------------
+    void ICETransport::installKeepWarmTimer(
+                                            RoutePtr route,
+                                            Time fireAt
+                                            )
+    {
+      route->mNextKeepWarm = mNextKeepWarmTimers.add(fireAt, route);
+
+      stepKeepWarmTimer();
+    }
+
     //-------------------------------------------------------------------------
     void ICETransport::removeKeepWarmTimer(RoutePtr route)
     {
       if (!route->mNextKeepWarm) return;
 
-      auto found = mNextKeepWarmTimers.find(route->mNextKeepWarm);
+      mNextKeepWarmTimers.cancel(route->mNextKeepWarm);
+      route->mNextKeepWarm = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    void ICETransport::stepKeepWarmTimer()
+    {
+      if (mNextKeepWarmTimers.empty()) {
+        if (!mKeepWarmTimer) return;
+
+        ZS_LOG_TRACE(log("no more keep warm timers pending (stopping keep warm timer)"))
+
+        mKeepWarmTimer->cancel();
+        mKeepWarmTimer.reset();
+        return;
+      }
+
+      // only wake up when the wheel next has something to do rather than
+      // at every tick of its resolution
+      Time wakeUp = mNextKeepWarmTimers.nextWakeUp();
 
-      if (found != mNextKeepWarmTimers.end()) {
-        mNextKeepWarmTimers.erase(found);
+      if (mKeepWarmTimer) {
+        if (mKeepWarmTimerWakeUp <= wakeUp) return;
+        mKeepWarmTimer->cancel();
+        mKeepWarmTimer.reset();
       }
 
-      route->mNextKeepWarm->cancel();
-      route->mNextKeepWarm.reset();
+      mKeepWarmTimer = Timer::create(mThisWeak.lock(), wakeUp);
+      mKeepWarmTimerWakeUp = wakeUp;
+
+      ZS_LOG_INSANE(log("armed keep warm timer") + ZS_PARAM("timer", mKeepWarmTimer->getID()) + ZS_PARAM("wake up", wakeUp))
     }
 
     //-------------------------------------------------------------------------
@@ -4449,7 +4747,20 @@ namespace ortc
         return;
       }
 
-      SecureByteBlockPtr packetized = packet->packetize(STUNPacket::RFC_5245_ICE);
+      SecureByteBlockPtr packetized;
+
+      // responses signed with the local password reuse the gatherer's
+      // precomputed HMAC states
+      auto integrity = mGatherer->getMessageIntegrity();
+      if ((integrity) &&
+          (STUNPacket::CredentialMechanisms_ShortTerm == packet->mCredentialMechanism) &&
+          (packet->mPassword == integrity->password())) {
+        packetized = integrity->packetize(packet);
+      }
+      if (!packetized) {
+        packetized = packet->packetize(STUNPacket::RFC_5245_ICE);
+      }
+
       EventWriteOrtcIceTransportSendStunPacket(__func__, mID, mGatherer->getID(), SafeInt<unsigned int>(packetized->SizeInBytes()), packetized->BytePtr());
       packet->trace(__func__);
       mGatherer->sendPacket(*this, routerRoute, packetized->BytePtr(), packetized->SizeInBytes());
@@ -4477,6 +4788,7 @@ namespace ortc
           return false;
         }
 
+        if (mICELite) goto respond_with_conflict;   // an ice lite agent never takes the controlling role
         if (mConflictResolver >= packet->mIceControlled) goto switch_roles;
         goto respond_with_conflict;
       }
@@ -4734,7 +5046,7 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "prune", mPrune);
       UseServicesHelper::debugAppend(resultEl, "keep warm", mKeepWarm);
       UseServicesHelper::debugAppend(resultEl, "outgoing check", mOutgoingCheck ? mOutgoingCheck->getID() : 0);
-      UseServicesHelper::debugAppend(resultEl, "keep warm timer", mNextKeepWarm ? mNextKeepWarm->getID() : 0);
+      UseServicesHelper::debugAppend(resultEl, "keep warm timer", mNextKeepWarm);
 
       UseServicesHelper::debugAppend(resultEl, "last round trip check", mLastRoundTripCheck);
       UseServicesHelper::debugAppend(resultEl, "last round trip measurement", mLastRoundTripMeasurement);
@@ -4833,7 +5145,7 @@ namespace ortc
                                            mPrune,
                                            mKeepWarm,
                                            ((bool)mOutgoingCheck) ? mOutgoingCheck->getID() : 0,
-                                           ((bool)mNextKeepWarm) ? mNextKeepWarm->getID() : 0,
+                                           mNextKeepWarm,
                                            (bool)mFrozenPromise,
                                            mDependentPromises.size(),
                                            zsLib::timeSinceEpoch<Milliseconds>(mLastReceivedCheck).count(),
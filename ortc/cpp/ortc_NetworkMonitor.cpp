@@ -0,0 +1,874 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+
+#include <ortc/internal/ortc_NetworkMonitor.h>
+#include <ortc/internal/platform.h>
+
+#include <openpeer/services/ISettings.h>
+#include <openpeer/services/IHelper.h>
+
+#include <zsLib/Log.h>
+#include <zsLib/Singleton.h>
+#include <zsLib/XML.h>
+
+#ifdef HAVE_RTNETLINK
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#endif //HAVE_RTNETLINK
+
+
+#ifdef _DEBUG
+#define ASSERT(x) ZS_THROW_BAD_STATE_IF(!(x))
+#else
+#define ASSERT(x)
+#endif //_DEBUG
+
+
+namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
+
+namespace ortc
+{
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+
+  namespace internal
+  {
+#ifdef HAVE_RTNETLINK
+    // large enough for a full dump datagram (the kernel sizes them to a page
+    // or 8K, whichever is larger)
+    static const size_t kReceiveBufferSize = 32*1024;
+
+    // a dump is answered immediately thus a silent kernel means the request
+    // was lost
+    static const int kDumpTimeoutInMilliseconds = 2000;
+
+    // a resync which fails is retried after 1s, 2s, 4s, ... before the
+    // monitor gives up
+    static const int kResyncRetryDelayInMilliseconds = 1000;
+    static const size_t kResyncAttempts = 5;
+#endif //HAVE_RTNETLINK
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark INetworkMonitorForSettings
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void INetworkMonitorForSettings::applyDefaults()
+    {
+      UseSettings::setBool(ORTC_SETTING_NETWORK_MONITOR_ENABLED, true);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark NetworkMonitor::Address
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr NetworkMonitor::Address::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::NetworkMonitor::Address");
+
+      UseServicesHelper::debugAppend(resultEl, "ip", mIP.string(false));
+      UseServicesHelper::debugAppend(resultEl, "interface name", mInterfaceName);
+      UseServicesHelper::debugAppend(resultEl, "interface index", mInterfaceIndex);
+      UseServicesHelper::debugAppend(resultEl, "temporary", mIsTemporary);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark NetworkMonitor
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    NetworkMonitor::NetworkMonitor(const make_private &)
+    {
+      ZS_LOG_DETAIL(log("created"))
+    }
+
+    //-------------------------------------------------------------------------
+    NetworkMonitor::~NetworkMonitor()
+    {
+      mThisWeak.reset();
+
+      stop();
+
+      ZS_LOG_DETAIL(log("destroyed"))
+    }
+
+    //-------------------------------------------------------------------------
+    NetworkMonitorPtr NetworkMonitor::create()
+    {
+      NetworkMonitorPtr pThis(make_shared<NetworkMonitor>(make_private{}));
+      pThis->mThisWeak = pThis;
+      return pThis;
+    }
+
+    //-------------------------------------------------------------------------
+    NetworkMonitorPtr NetworkMonitor::singleton()
+    {
+      AutoRecursiveLock lock(*UseServicesHelper::getGlobalLock());
+      static SingletonLazySharedPtr<NetworkMonitor> singleton(create());
+      NetworkMonitorPtr result = singleton.singleton();
+
+      static zsLib::SingletonManager::Register registerSingleton("ortc::NetworkMonitor", result);
+
+      if (!result) {
+        ZS_LOG_WARNING(Detail, slog("singleton gone"))
+      }
+
+      return result;
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::isEnabled()
+    {
+#ifdef HAVE_RTNETLINK
+      return UseSettings::getBool(ORTC_SETTING_NETWORK_MONITOR_ENABLED);
+#else
+      return false;
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::subscribe(
+                                   PUID subscriberID,
+                                   INetworkMonitorDelegatePtr delegate
+                                   )
+    {
+      if (!delegate) return false;
+      if (!isEnabled()) return false;
+
+      auto pThis = singleton();
+      if (!pThis) return false;
+
+      AutoLock lock(pThis->mLock);
+
+      if (!pThis->start()) return false;
+
+      pThis->mSubscribers[subscriberID] = delegate;
+
+      ZS_LOG_DEBUG(pThis->log("subscribed") + ZS_PARAM("subscriber", subscriberID) + ZS_PARAM("total", pThis->mSubscribers.size()))
+      return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void NetworkMonitor::unsubscribe(PUID subscriberID)
+    {
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      AutoLock lock(pThis->mLock);
+      pThis->mSubscribers.erase(subscriberID);
+
+      ZS_LOG_DEBUG(pThis->log("unsubscribed") + ZS_PARAM("subscriber", subscriberID) + ZS_PARAM("total", pThis->mSubscribers.size()))
+    }
+
+    //-------------------------------------------------------------------------
+    void NetworkMonitor::getAddresses(AddressList &outAddresses)
+    {
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      AutoLock lock(pThis->mLock);
+
+      for (auto iter = pThis->mAddresses.begin(); iter != pThis->mAddresses.end(); ++iter) {
+        auto &address = (*iter).second;
+        if (pThis->mDownInterfaces.end() != pThis->mDownInterfaces.find(address.mInterfaceIndex)) continue;
+        outAddresses.push_back(address);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr NetworkMonitor::singletonToDebug()
+    {
+      auto pThis = singleton();
+      if (!pThis) return ElementPtr();
+      return pThis->toDebug();
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark NetworkMonitor => ISingletonManagerDelegate
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void NetworkMonitor::notifySingletonCleanup()
+    {
+      ZS_LOG_DEBUG(log("notify singleton cleanup"))
+      stop();
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark NetworkMonitor => (internal)
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    Log::Params NetworkMonitor::slog(const char *message)
+    {
+      ElementPtr objectEl = Element::create("ortc::NetworkMonitor");
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    Log::Params NetworkMonitor::log(const char *message) const
+    {
+      ElementPtr objectEl = Element::create("ortc::NetworkMonitor");
+      UseServicesHelper::debugAppend(objectEl, "id", mID);
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr NetworkMonitor::toDebug() const
+    {
+      AutoLock lock(mLock);
+
+      ElementPtr resultEl = Element::create("ortc::NetworkMonitor");
+
+      UseServicesHelper::debugAppend(resultEl, "id", mID);
+      UseServicesHelper::debugAppend(resultEl, "started", mStarted);
+      UseServicesHelper::debugAppend(resultEl, "stopped", mStopped);
+      UseServicesHelper::debugAppend(resultEl, "failed", mFailed);
+      UseServicesHelper::debugAppend(resultEl, "socket", mSocket);
+      UseServicesHelper::debugAppend(resultEl, "wake fd", mWakeFD);
+      UseServicesHelper::debugAppend(resultEl, "sequence", mSequence);
+      UseServicesHelper::debugAppend(resultEl, "should stop", mShouldStop.load());
+      UseServicesHelper::debugAppend(resultEl, "down interfaces", mDownInterfaces.size());
+      UseServicesHelper::debugAppend(resultEl, "subscribers", mSubscribers.size());
+      UseServicesHelper::debugAppend(resultEl, "messages", mMessages.load());
+      UseServicesHelper::debugAppend(resultEl, "changes", mChanges.load());
+      UseServicesHelper::debugAppend(resultEl, "resyncs", mResyncs.load());
+
+      ElementPtr addressesEl = Element::create("addresses");
+      for (auto iter = mAddresses.begin(); iter != mAddresses.end(); ++iter) {
+        UseServicesHelper::debugAppend(addressesEl, (*iter).second.toDebug());
+      }
+      UseServicesHelper::debugAppend(resultEl, addressesEl);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::start()
+    {
+#ifdef HAVE_RTNETLINK
+      if (mStopped) return false;
+      if (mFailed) return false;
+      if (mStarted) return mSocket >= 0;
+
+      mStarted = true;
+
+      mSocket = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+      if (mSocket < 0) {
+        ZS_LOG_ERROR(Basic, log("unable to create rtnetlink socket") + ZS_PARAM("error", errno))
+        return false;
+      }
+
+      sockaddr_nl local;
+      memset(&local, 0, sizeof(local));
+      local.nl_family = AF_NETLINK;
+      local.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+
+      if (0 != ::bind(mSocket, reinterpret_cast<sockaddr *>(&local), sizeof(local))) {
+        ZS_LOG_ERROR(Basic, log("unable to bind rtnetlink socket") + ZS_PARAM("error", errno))
+        goto fail;
+      }
+
+      mWakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (mWakeFD < 0) {
+        ZS_LOG_ERROR(Basic, log("unable to create wake event") + ZS_PARAM("error", errno))
+        goto fail;
+      }
+
+      // seed the table before anyone can ask for it; the monitor thread is
+      // not yet running thus the lock is not needed to fill it
+      if (!resync(mAddresses, mDownInterfaces)) goto fail;
+
+      mThread = std::thread(&NetworkMonitor::run, this);
+
+      ZS_LOG_DETAIL(log("started rtnetlink monitor") + ZS_PARAM("addresses", mAddresses.size()) + ZS_PARAM("down interfaces", mDownInterfaces.size()))
+      return true;
+
+    fail:
+      {
+        if (mWakeFD >= 0) ::close(mWakeFD);
+        ::close(mSocket);
+        mWakeFD = -1;
+        mSocket = -1;
+        mAddresses.clear();
+        mDownInterfaces.clear();
+      }
+      return false;
+#else
+      return false;
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    void NetworkMonitor::stop()
+    {
+#ifdef HAVE_RTNETLINK
+      {
+        AutoLock lock(mLock);
+        if (mStopped) return;
+        mStopped = true;
+
+        mSubscribers.clear();
+      }
+
+      if (!mThread.joinable()) goto done;
+
+      mShouldStop = true;
+
+      {
+        uint64_t value = 1;
+        if (write(mWakeFD, &value, sizeof(value)) < 0) {
+          ZS_LOG_WARNING(Debug, log("unable to wake monitor thread") + ZS_PARAM("error", errno))
+        }
+      }
+
+      mThread.join();
+
+    done:
+      {
+        if (mWakeFD >= 0) ::close(mWakeFD);
+        if (mSocket >= 0) ::close(mSocket);
+        mWakeFD = -1;
+        mSocket = -1;
+      }
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::requestDump(int type)
+    {
+#ifdef HAVE_RTNETLINK
+      struct
+      {
+        nlmsghdr mHeader;
+        rtgenmsg mGen;
+      } request;
+
+      memset(&request, 0, sizeof(request));
+      request.mHeader.nlmsg_len = NLMSG_LENGTH(sizeof(rtgenmsg));
+      request.mHeader.nlmsg_type = static_cast<decltype(request.mHeader.nlmsg_type)>(type);
+      request.mHeader.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+      request.mHeader.nlmsg_seq = ++mSequence;
+      request.mGen.rtgen_family = AF_UNSPEC;
+
+      sockaddr_nl kernel;
+      memset(&kernel, 0, sizeof(kernel));
+      kernel.nl_family = AF_NETLINK;
+
+      if (::sendto(mSocket, &request, request.mHeader.nlmsg_len, 0, reinterpret_cast<sockaddr *>(&kernel), sizeof(kernel)) < 0) {
+        ZS_LOG_ERROR(Detail, log("unable to send rtnetlink dump request") + ZS_PARAM("type", type) + ZS_PARAM("error", errno))
+        return false;
+      }
+      return true;
+#else
+      return false;
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::readDump(
+                                  AddressMap &ioAddresses,
+                                  InterfaceIndexSet &ioDownInterfaces
+                                  )
+    {
+#ifdef HAVE_RTNETLINK
+      bool dumpDone = false;
+
+      while (!dumpDone) {
+        pollfd fd;
+        memset(&fd, 0, sizeof(fd));
+        fd.fd = mSocket;
+        fd.events = POLLIN;
+
+        int result = ::poll(&fd, 1, kDumpTimeoutInMilliseconds);
+        if (result < 0) {
+          if (EINTR == errno) continue;
+          ZS_LOG_ERROR(Detail, log("unable to wait for rtnetlink dump") + ZS_PARAM("error", errno))
+          return false;
+        }
+        if (0 == result) {
+          ZS_LOG_ERROR(Detail, log("timed out waiting for rtnetlink dump") + ZS_PARAM("sequence", mSequence))
+          return false;
+        }
+
+        bool changed = false;
+        if (!receive(ioAddresses, ioDownInterfaces, dumpDone, changed)) return false;
+      }
+      return true;
+#else
+      return false;
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::resync(
+                                AddressMap &outAddresses,
+                                InterfaceIndexSet &outDownInterfaces
+                                )
+    {
+#ifdef HAVE_RTNETLINK
+      // only one dump may be outstanding per socket; links are dumped first
+      // but the down filter is applied when the table is read so the order
+      // does not matter for correctness
+      if (!requestDump(RTM_GETLINK)) return false;
+      if (!readDump(outAddresses, outDownInterfaces)) return false;
+
+      if (!requestDump(RTM_GETADDR)) return false;
+      if (!readDump(outAddresses, outDownInterfaces)) return false;
+
+      ++mResyncs;
+      return true;
+#else
+      return false;
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::receive(
+                                 AddressMap &ioAddresses,
+                                 InterfaceIndexSet &ioDownInterfaces,
+                                 bool &outDumpDone,
+                                 bool &outChanged
+                                 )
+    {
+#ifdef HAVE_RTNETLINK
+      alignas(nlmsghdr) BYTE buffer[kReceiveBufferSize];
+
+      while (true) {
+        sockaddr_nl from;
+        socklen_t fromLength = sizeof(from);
+
+        ssize_t length = ::recvfrom(mSocket, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr *>(&from), &fromLength);
+        if (length < 0) {
+          int error = errno;
+          if (EINTR == error) continue;
+          if ((EAGAIN == error) || (EWOULDBLOCK == error)) return true;
+
+          if (ENOBUFS == error) {
+            ZS_LOG_WARNING(Detail, log("rtnetlink receive buffer overrun (messages lost)"))
+          } else {
+            ZS_LOG_ERROR(Detail, log("unable to receive from rtnetlink socket") + ZS_PARAM("error", error))
+          }
+          return false;
+        }
+
+        if (0 != from.nl_pid) continue;   // only trust messages from the kernel
+
+        process(buffer, static_cast<size_t>(length), ioAddresses, ioDownInterfaces, outDumpDone, outChanged);
+      }
+#else
+      return false;
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    void NetworkMonitor::process(
+                                 const BYTE *buffer,
+                                 size_t length,
+                                 AddressMap &ioAddresses,
+                                 InterfaceIndexSet &ioDownInterfaces,
+                                 bool &outDumpDone,
+                                 bool &outChanged
+                                 )
+    {
+#ifdef HAVE_RTNETLINK
+      auto remaining = static_cast<unsigned int>(length);
+
+      for (auto header = reinterpret_cast<const nlmsghdr *>(buffer); NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+        ++mMessages;
+
+        switch (header->nlmsg_type) {
+          case NLMSG_DONE: {
+            if (header->nlmsg_seq == mSequence) outDumpDone = true;
+            break;
+          }
+          case NLMSG_ERROR: {
+            if (header->nlmsg_len < NLMSG_LENGTH(sizeof(nlmsgerr))) {
+              ZS_LOG_WARNING(Detail, log("rtnetlink error message is truncated") + ZS_PARAM("length", header->nlmsg_len))
+              if (header->nlmsg_seq == mSequence) outDumpDone = true;
+              break;
+            }
+
+            auto error = reinterpret_cast<const nlmsgerr *>(NLMSG_DATA(header));
+            ZS_LOG_WARNING(Detail, log("rtnetlink reported an error") + ZS_PARAM("sequence", header->nlmsg_seq) + ZS_PARAM("error", -(error->error)))
+            if (header->nlmsg_seq == mSequence) outDumpDone = true;
+            break;
+          }
+          case RTM_NEWLINK:
+          case RTM_DELLINK: {
+            if (header->nlmsg_len < NLMSG_LENGTH(sizeof(ifinfomsg))) {
+              ZS_LOG_WARNING(Detail, log("rtnetlink link message is truncated") + ZS_PARAM("length", header->nlmsg_len))
+              break;
+            }
+
+            auto info = reinterpret_cast<const ifinfomsg *>(NLMSG_DATA(header));
+            auto index = static_cast<ULONG>(info->ifi_index);
+
+            // an interface without carrier keeps its addresses but they
+            // cannot reach anything
+            bool up = (RTM_NEWLINK == header->nlmsg_type) &&
+                      (0 != (info->ifi_flags & IFF_UP)) &&
+                      (0 != (info->ifi_flags & IFF_RUNNING));
+
+            if (up) {
+              if (0 != ioDownInterfaces.erase(index)) outChanged = true;
+            } else {
+              if (ioDownInterfaces.insert(index).second) outChanged = true;
+            }
+
+            if (RTM_DELLINK == header->nlmsg_type) {
+              ioDownInterfaces.erase(index);
+              for (auto iter_doNotUse = ioAddresses.begin(); iter_doNotUse != ioAddresses.end(); ) {
+                auto current = iter_doNotUse;
+                ++iter_doNotUse;
+
+                if (index != (*current).first.first) continue;
+                ioAddresses.erase(current);
+                outChanged = true;
+              }
+            }
+            break;
+          }
+          case RTM_NEWADDR:
+          case RTM_DELADDR: {
+            if (header->nlmsg_len < NLMSG_LENGTH(sizeof(ifaddrmsg))) {
+              ZS_LOG_WARNING(Detail, log("rtnetlink address message is truncated") + ZS_PARAM("length", header->nlmsg_len))
+              break;
+            }
+
+            auto info = reinterpret_cast<const ifaddrmsg *>(NLMSG_DATA(header));
+
+            const void *address = NULL;
+            size_t addressLength = 0;
+            const void *local = NULL;
+            size_t localLength = 0;
+            const char *label = NULL;
+            size_t labelLength = 0;
+            DWORD flags = info->ifa_flags;
+
+            auto attributesLength = IFA_PAYLOAD(header);
+            for (auto attribute = IFA_RTA(info); RTA_OK(attribute, attributesLength); attribute = RTA_NEXT(attribute, attributesLength)) {
+              switch (attribute->rta_type) {
+                case IFA_ADDRESS: address = RTA_DATA(attribute); addressLength = RTA_PAYLOAD(attribute); break;
+                case IFA_LOCAL:   local = RTA_DATA(attribute); localLength = RTA_PAYLOAD(attribute); break;
+                case IFA_LABEL:   label = reinterpret_cast<const char *>(RTA_DATA(attribute)); labelLength = RTA_PAYLOAD(attribute); break;
+#ifdef IFA_FLAGS
+                case IFA_FLAGS: {
+                  if (RTA_PAYLOAD(attribute) >= sizeof(DWORD)) flags = *reinterpret_cast<const DWORD *>(RTA_DATA(attribute));
+                  break;
+                }
+#endif //IFA_FLAGS
+                default:          break;
+              }
+            }
+
+            // on point-to-point links IFA_ADDRESS is the peer
+            if (local) {
+              address = local;
+              addressLength = localLength;
+            }
+            if (!address) break;
+
+            size_t requiredLength = (AF_INET == info->ifa_family ? sizeof(in_addr) : sizeof(in6_addr));
+            if (addressLength < requiredLength) {
+              ZS_LOG_WARNING(Detail, log("rtnetlink address attribute is truncated") + ZS_PARAM("length", addressLength))
+              break;
+            }
+
+            IPAddress ip;
+            if (AF_INET == info->ifa_family) {
+              sockaddr_in addr;
+              memset(&addr, 0, sizeof(addr));
+              addr.sin_family = AF_INET;
+              memcpy(&(addr.sin_addr), address, sizeof(addr.sin_addr));
+              ip = IPAddress(addr);
+            } else if (AF_INET6 == info->ifa_family) {
+              sockaddr_in6 addr;
+              memset(&addr, 0, sizeof(addr));
+              addr.sin6_family = AF_INET6;
+              memcpy(&(addr.sin6_addr), address, sizeof(addr.sin6_addr));
+              if (IN6_IS_ADDR_LINKLOCAL(&(addr.sin6_addr))) {
+                addr.sin6_scope_id = static_cast<uint32_t>(info->ifa_index);  // link-local addresses are only usable on their own interface
+              }
+              ip = IPAddress(addr);
+            }
+
+            if (ip.isAddressEmpty()) break;
+            if (ip.isLoopback()) break;
+            if (ip.isAddrAny()) break;
+
+            AddressKey key(static_cast<ULONG>(info->ifa_index), ip.string(false));
+
+            // tentative addresses cannot be bound until duplicate address
+            // detection completes (announced with a further RTM_NEWADDR)
+            bool usable = (RTM_NEWADDR == header->nlmsg_type) &&
+                          (0 == (flags & (IFA_F_TENTATIVE | IFA_F_DADFAILED | IFA_F_DEPRECATED)));
+
+            auto found = ioAddresses.find(key);
+
+            if (!usable) {
+              if (found == ioAddresses.end()) break;
+              ZS_LOG_DEBUG(log("address removed") + ZS_PARAM("ip", key.second) + ZS_PARAM("interface index", key.first))
+              ioAddresses.erase(found);
+              outChanged = true;
+              break;
+            }
+
+            Address entry;
+            entry.mIP = ip;
+            entry.mInterfaceIndex = key.first;
+            entry.mIsTemporary = (0 != (flags & IFA_F_TEMPORARY));
+
+            if ((label) &&
+                (0 != labelLength)) {
+              entry.mInterfaceName = String(std::string(label, strnlen(label, labelLength)));
+            } else {
+              char name[IF_NAMESIZE] {};
+              if (if_indextoname(info->ifa_index, name)) entry.mInterfaceName = String(name);
+            }
+
+            if (found != ioAddresses.end()) {
+              auto &existing = (*found).second;
+              if ((existing.mInterfaceName == entry.mInterfaceName) &&
+                  (existing.mIsTemporary == entry.mIsTemporary)) break;
+            }
+
+            ZS_LOG_DEBUG(log("address added") + entry.toDebug())
+            ioAddresses[key] = entry;
+            outChanged = true;
+            break;
+          }
+          default: break;
+        }
+      }
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    void NetworkMonitor::notifySubscribers(bool monitorFailed)
+    {
+      typedef std::list<INetworkMonitorDelegatePtr> DelegateList;
+
+      DelegateList delegates;
+
+      {
+        AutoLock lock(mLock);
+
+        for (auto iter_doNotUse = mSubscribers.begin(); iter_doNotUse != mSubscribers.end(); ) {
+          auto current = iter_doNotUse;
+          ++iter_doNotUse;
+
+          auto delegate = (*current).second.lock();
+          if (!delegate) {
+            mSubscribers.erase(current);
+            continue;
+          }
+          delegates.push_back(delegate);
+        }
+
+        // a failed monitor voids every subscription
+        if (monitorFailed) mSubscribers.clear();
+      }
+
+      if (monitorFailed) {
+        ZS_LOG_WARNING(Basic, log("notifying monitor failed") + ZS_PARAM("subscribers", delegates.size()))
+
+        for (auto iter = delegates.begin(); iter != delegates.end(); ++iter) {
+          INetworkMonitorDelegateProxy::create(*iter)->onNetworkMonitorFailed();
+        }
+        return;
+      }
+
+      ++mChanges;
+
+      ZS_LOG_DEBUG(log("notifying interfaces changed") + ZS_PARAM("subscribers", delegates.size()))
+
+      for (auto iter = delegates.begin(); iter != delegates.end(); ++iter) {
+        INetworkMonitorDelegateProxy::create(*iter)->onNetworkMonitorInterfacesChanged();
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::waitToRetry(int delayInMilliseconds)
+    {
+#ifdef HAVE_RTNETLINK
+      pollfd fd;
+      memset(&fd, 0, sizeof(fd));
+      fd.fd = mWakeFD;
+      fd.events = POLLIN;
+
+      // only the wake event is watched; an interrupted wait simply retries
+      // sooner
+      if ((::poll(&fd, 1, delayInMilliseconds) > 0) &&
+          (0 != fd.revents)) {
+        uint64_t value = 0;
+        while (read(mWakeFD, &value, sizeof(value)) > 0) {}
+      }
+      return !mShouldStop;
+#else
+      return false;
+#endif //HAVE_RTNETLINK
+    }
+
+    //-------------------------------------------------------------------------
+    bool NetworkMonitor::resyncWithRetry(
+                                         AddressMap &outAddresses,
+                                         InterfaceIndexSet &outDownInterfaces
+                                         )
+    {
+      int delay = kResyncRetryDelayInMilliseconds;
+
+      for (size_t attempt = 0; attempt < kResyncAttempts; ++attempt) {
+        if (0 != attempt) {
+          if (!waitToRetry(delay)) return false;
+          delay *= 2;
+        }
+
+        outAddresses.clear();
+        outDownInterfaces.clear();
+
+        if (resync(outAddresses, outDownInterfaces)) return true;
+
+        ZS_LOG_WARNING(Detail, log("unable to resync interface table") + ZS_PARAM("attempt", attempt + 1) + ZS_PARAM("attempts", kResyncAttempts))
+      }
+      return false;
+    }
+
+    //-------------------------------------------------------------------------
+    void NetworkMonitor::run()
+    {
+#ifdef HAVE_RTNETLINK
+      while (!mShouldStop) {
+        pollfd fds[2];
+        memset(&fds, 0, sizeof(fds));
+        fds[0].fd = mWakeFD;
+        fds[0].events = POLLIN;
+        fds[1].fd = mSocket;
+        fds[1].events = POLLIN;
+
+        int result = ::poll(fds, 2, -1);
+        if (result < 0) {
+          int error = errno;
+          if (EINTR == error) continue;
+          ZS_LOG_ERROR(Basic, log("poll failed (monitor exiting)") + ZS_PARAM("error", error))
+          goto failed;
+        }
+
+        if (0 != fds[0].revents) {
+          uint64_t value = 0;
+          while (read(mWakeFD, &value, sizeof(value)) > 0) {}
+          continue;
+        }
+
+        if (0 == fds[1].revents) continue;
+
+        bool dumpDone = false;
+        bool changed = false;
+        bool received = false;
+
+        {
+          AutoLock lock(mLock);
+          received = receive(mAddresses, mDownInterfaces, dumpDone, changed);
+        }
+
+        if (!received) {
+          // the deltas can no longer be trusted thus start over from a dump
+          AddressMap addresses;
+          InterfaceIndexSet downInterfaces;
+          if (!resyncWithRetry(addresses, downInterfaces)) {
+            if (mShouldStop) break;
+            ZS_LOG_ERROR(Basic, log("unable to resync interface table (monitor exiting)"))
+            goto failed;
+          }
+
+          AutoLock lock(mLock);
+          mAddresses.swap(addresses);
+          mDownInterfaces.swap(downInterfaces);
+          changed = true;
+        }
+
+        if (changed) notifySubscribers();
+      }
+
+      ZS_LOG_DETAIL(log("rtnetlink monitor stopped"))
+      return;
+
+    failed:
+      {
+        // the table can no longer be kept current thus anyone relying on it
+        // must go back to scanning the interfaces
+        {
+          AutoLock lock(mLock);
+          mFailed = true;
+          mAddresses.clear();
+          mDownInterfaces.clear();
+        }
+        notifySubscribers(true);
+      }
+#endif //HAVE_RTNETLINK
+    }
+
+  }
+}
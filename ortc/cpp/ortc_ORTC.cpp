@@ -36,10 +36,20 @@
 #include <openpeer/services/IHelper.h>
 #include <openpeer/services/ILogger.h>
 #include <openpeer/services/IMessageQueueManager.h>
+#include <openpeer/services/ISettings.h>
 
 #include <zsLib/Log.h>
 #include <zsLib/XML.h>
 
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif //_WIN32
+
 namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
 
 namespace ortc
@@ -50,9 +60,56 @@ namespace ortc
   namespace internal
   {
     ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IMessageQueueManager, UseMessageQueueManager)
+    ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
 
     void initSubsystems();
 
+    //-------------------------------------------------------------------------
+    static ULONGLONG mixStreamKey(ULONGLONG value)
+    {
+      // splitmix64 finalizer; neighbouring SSRCs and object addresses end up
+      // on unrelated threads
+      value ^= (value >> 30);
+      value *= 0xbf58476d1ce4e5b9ULL;
+      value ^= (value >> 27);
+      value *= 0x94d049bb133111ebULL;
+      value ^= (value >> 31);
+      return value;
+    }
+
+    //-------------------------------------------------------------------------
+    static bool pinCurrentThreadToCPU(size_t cpu)
+    {
+#if defined(_WIN32) && !defined(WINRT)
+      if (cpu >= (sizeof(DWORD_PTR) * 8)) return false;
+      return 0 != SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+#elif defined(__linux__) && !defined(_ANDROID)
+      if (cpu >= CPU_SETSIZE) return false;
+      cpu_set_t cpuSet;
+      CPU_ZERO(&cpuSet);
+      CPU_SET(cpu, &cpuSet);
+      return 0 == pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+      // thread affinity is not supported on this platform (or is only a hint)
+      return false;
+#endif
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IORTCForSettings
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void IORTCForSettings::applyDefaults()
+    {
+      UseSettings::setUInt(ORTC_SETTING_ORTC_TOTAL_PACKET_THREADS, 0);  // 0 = one per CPU core
+      UseSettings::setBool(ORTC_SETTING_ORTC_PIN_PACKET_THREADS, false);
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -85,6 +142,15 @@ namespace ortc
       return (ORTC::singleton())->queuePacket();
     }
 
+    //-------------------------------------------------------------------------
+    IMessageQueuePtr IORTCForInternal::queuePacket(
+                                                   const void *transport,
+                                                   DWORD ssrc
+                                                   )
+    {
+      return (ORTC::singleton())->queuePacket(transport, ssrc);
+    }
+
     //-------------------------------------------------------------------------
     IMessageQueuePtr IORTCForInternal::queueBlockingMediaStartStopThread()
     {
@@ -259,14 +325,35 @@ namespace ortc
     {
       AutoRecursiveLock lock(*this);
 
-      size_t index = mNextPacketQueueThread % ORTC_QUEUE_TOTAL_PACKET_THREADS;
-
-      if (!mPacketQueues[index]) {
-        mPacketQueues[index] = UseMessageQueueManager::getMessageQueue((String(ORTC_QUEUE_PACKET_THREAD_NAME) + string(index)).c_str());
-      }
+      preparePacketQueues();
 
+      size_t index = mNextPacketQueueThread % mPacketQueues.size();
       ++mNextPacketQueueThread;
-      return mPacketQueues[index];
+
+      return getPacketQueue(index);
+    }
+
+    //-------------------------------------------------------------------------
+    IMessageQueuePtr ORTC::queuePacket(
+                                       const void *transport,
+                                       DWORD ssrc
+                                       ) const
+    {
+      // a sender's SSRC is only chosen when its channel is set up; hashing
+      // the unknown SSRC would pile every such channel of a transport onto
+      // one thread thus each is handed the next thread instead
+      if (0 == ssrc) return queuePacket();
+
+      AutoRecursiveLock lock(*this);
+
+      preparePacketQueues();
+
+      // all work for one stream lands on one thread (preserving its order)
+      // while the streams of a bundled transport spread over every thread
+      ULONGLONG key = mixStreamKey(static_cast<ULONGLONG>(reinterpret_cast<uintptr_t>(transport))) ^ static_cast<ULONGLONG>(ssrc);
+      size_t index = static_cast<size_t>(mixStreamKey(key) % mPacketQueues.size());
+
+      return getPacketQueue(index);
     }
 
     //-------------------------------------------------------------------------
@@ -297,6 +384,27 @@ namespace ortc
       return mDefaultWebRTCLogLevel;
     }
 
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark Stack => IORTCAsyncDelegate
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ORTC::onPinPacketThread(
+                                 size_t index,
+                                 size_t cpu
+                                 )
+    {
+      if (!pinCurrentThreadToCPU(cpu)) {
+        ZS_LOG_WARNING(Detail, log("unable to pin packet thread to cpu") + ZS_PARAM("index", index) + ZS_PARAM("cpu", cpu))
+        return;
+      }
+      ZS_LOG_DEBUG(log("pinned packet thread to cpu") + ZS_PARAM("index", index) + ZS_PARAM("cpu", cpu))
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -319,6 +427,44 @@ namespace ortc
       ElementPtr objectEl = Element::create("ortc::ORTC");
       return Log::Params(message, objectEl);
     }
+
+    //-------------------------------------------------------------------------
+    void ORTC::preparePacketQueues() const
+    {
+      if (mPacketQueues.size() > 0) return;
+
+      size_t cores = static_cast<size_t>(std::thread::hardware_concurrency());
+
+      size_t total = static_cast<size_t>(UseSettings::getUInt(ORTC_SETTING_ORTC_TOTAL_PACKET_THREADS));
+      if (0 == total) total = cores;
+      if (0 == total) total = ORTC_QUEUE_DEFAULT_TOTAL_PACKET_THREADS;
+
+      mPinPacketThreads = UseSettings::getBool(ORTC_SETTING_ORTC_PIN_PACKET_THREADS);
+      if ((mPinPacketThreads) &&
+          (0 == cores)) {
+        ZS_LOG_WARNING(Detail, log("cannot pin packet threads as total cores is unknown"))
+        mPinPacketThreads = false;
+      }
+
+      mPacketQueues.resize(total);
+
+      ZS_LOG_DETAIL(log("packet threads configured") + ZS_PARAM("total", total) + ZS_PARAM("cores", cores) + ZS_PARAM("pin", mPinPacketThreads))
+    }
+
+    //-------------------------------------------------------------------------
+    IMessageQueuePtr ORTC::getPacketQueue(size_t index) const
+    {
+      auto &queue = mPacketQueues[index];
+      if (queue) return queue;
+
+      queue = UseMessageQueueManager::getMessageQueue((String(ORTC_QUEUE_PACKET_THREAD_NAME) + string(index)).c_str());
+
+      if (mPinPacketThreads) {
+        size_t cores = static_cast<size_t>(std::thread::hardware_concurrency());
+        IORTCAsyncDelegateProxy::createUsingQueue(queue, mThisWeak.lock())->onPinPacketThread(index, index % cores);
+      }
+      return queue;
+    }
   }
 
   //---------------------------------------------------------------------------
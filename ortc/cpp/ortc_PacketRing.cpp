@@ -0,0 +1,147 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+#include <ortc/internal/ortc_PacketRing.h>
+#include <ortc/internal/ortc_Helper.h>
+#include <ortc/internal/platform.h>
+
+#include <openpeer/services/IHelper.h>
+
+#include <zsLib/Log.h>
+#include <zsLib/XML.h>
+
+#include <cryptopp/sha.h>
+
+
+namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
+
+namespace ortc
+{
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+
+  ZS_DECLARE_TYPEDEF_PTR(ortc::internal::Helper, UseHelper)
+
+  typedef openpeer::services::Hasher<CryptoPP::SHA1> SHA1Hasher;
+
+  namespace internal
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PacketRingCounters
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr PacketRingCounters::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::PacketRingCounters");
+
+      UseServicesHelper::debugAppend(resultEl, "buffered", mBuffered);
+      UseServicesHelper::debugAppend(resultEl, "removed", mRemoved);
+      UseServicesHelper::debugAppend(resultEl, "dropped expired", mDroppedExpired);
+      UseServicesHelper::debugAppend(resultEl, "dropped overflow", mDroppedOverflow);
+      UseServicesHelper::debugAppend(resultEl, "dropped over budget", mDroppedOverBudget);
+      UseServicesHelper::debugAppend(resultEl, "dropped oversized", mDroppedOversized);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PacketRingStats
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr PacketRingStats::createElement(const char *objectName) const
+    {
+      ElementPtr rootEl = Stats::createElement(objectName);
+      if (!rootEl) rootEl = Element::create(objectName);
+
+      UseHelper::adoptElementValue(rootEl, "bufferedPackets", static_cast<ULONGLONG>(mBufferedPackets));
+      UseHelper::adoptElementValue(rootEl, "bufferedBytes", static_cast<ULONGLONG>(mBufferedBytes));
+      UseHelper::adoptElementValue(rootEl, "maxPackets", static_cast<ULONGLONG>(mMaxPackets));
+      UseHelper::adoptElementValue(rootEl, "maxBytes", static_cast<ULONGLONG>(mMaxBytes));
+      UseHelper::adoptElementValue(rootEl, "packetsBuffered", mCounters.mBuffered);
+      UseHelper::adoptElementValue(rootEl, "packetsRemoved", mCounters.mRemoved);
+      UseHelper::adoptElementValue(rootEl, "packetsDroppedExpired", mCounters.mDroppedExpired);
+      UseHelper::adoptElementValue(rootEl, "packetsDroppedOverflow", mCounters.mDroppedOverflow);
+      UseHelper::adoptElementValue(rootEl, "packetsDroppedOverBudget", mCounters.mDroppedOverBudget);
+      UseHelper::adoptElementValue(rootEl, "packetsDroppedOversized", mCounters.mDroppedOversized);
+
+      if (!rootEl->hasChildren()) return ElementPtr();
+
+      return rootEl;
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr PacketRingStats::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::PacketRingStats");
+
+      UseServicesHelper::debugAppend(resultEl, "id", mID);
+      UseServicesHelper::debugAppend(resultEl, "buffered packets", mBufferedPackets);
+      UseServicesHelper::debugAppend(resultEl, "buffered bytes", mBufferedBytes);
+      UseServicesHelper::debugAppend(resultEl, "max packets", mMaxPackets);
+      UseServicesHelper::debugAppend(resultEl, "max bytes", mMaxBytes);
+      UseServicesHelper::debugAppend(resultEl, mCounters.toDebug());
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    String PacketRingStats::hash() const
+    {
+      SHA1Hasher hasher;
+
+      hasher.update("PacketRingStats:");
+
+      hasher.update(Stats::hash());
+
+      hasher.update(static_cast<ULONGLONG>(mBufferedPackets));
+      hasher.update(":");
+      hasher.update(static_cast<ULONGLONG>(mBufferedBytes));
+      hasher.update(":");
+      hasher.update(mCounters.mBuffered);
+      hasher.update(":");
+      hasher.update(mCounters.mRemoved);
+      hasher.update(":");
+      hasher.update(mCounters.dropped());
+      hasher.update(":");
+
+      return hasher.final();
+    }
+  }
+}
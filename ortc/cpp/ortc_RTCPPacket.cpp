@@ -30,6 +30,7 @@
  */
 
 #include <ortc/internal/ortc_RTCPPacket.h>
+#include <ortc/internal/ortc_BufferPool.h>
 #include <ortc/internal/ortc_Helper.h>
 #include <ortc/internal/ortc_RTPUtils.h>
 #include <ortc/internal/platform.h>
@@ -65,6 +66,7 @@ namespace ortc
   namespace internal
   {
     ZS_DECLARE_TYPEDEF_PTR(ortc::internal::Helper, UseHelper)
+    ZS_DECLARE_TYPEDEF_PTR(ortc::internal::BufferPool, UseBufferPool)
 
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -76,6 +78,7 @@ namespace ortc
 
     static const size_t kMinRtcpPacketLen = 4;
     static const BYTE kRtpVersion = 2;
+    static const size_t kAllocationBlockSize = 1500;  // parse arena block size (fits a typical compound packet)
 
     //-------------------------------------------------------------------------
     static Log::Params packet_slog(const char *message)
@@ -840,6 +843,47 @@ namespace ortc
       return RTCPPacket::create(UseServicesHelper::convertToBuffer(buffer, bufferLengthInBytes));
     }
 
+    //-------------------------------------------------------------------------
+    RTCPPacketPtr RTCPPacket::createLazy(const BYTE *buffer, size_t bufferLengthInBytes)
+    {
+      ORTC_THROW_INVALID_PARAMETERS_IF(!buffer)
+      ORTC_THROW_INVALID_PARAMETERS_IF(0 == bufferLengthInBytes)
+
+      RTCPPacketPtr pThis(make_shared<RTCPPacket>(make_private{}));
+      pThis->mBuffer = UseServicesHelper::convertToBuffer(buffer, bufferLengthInBytes);
+      pThis->mPtr = pThis->mBuffer->BytePtr();
+      pThis->mSize = bufferLengthInBytes;
+      if (!pThis->parse(DecodeType_None)) {
+        ZS_LOG_WARNING(Debug, pThis->log("packet could not be indexed"))
+        return RTCPPacketPtr();
+      }
+      return pThis;
+    }
+
+    //-------------------------------------------------------------------------
+    RTCPPacketPtr RTCPPacket::create(
+                                     const BYTE *buffer,
+                                     size_t bufferLengthInBytes,
+                                     size_t reserveHeadroom,
+                                     size_t reserveTailroom
+                                     )
+    {
+      ORTC_THROW_INVALID_PARAMETERS_IF(!buffer)
+      ORTC_THROW_INVALID_PARAMETERS_IF(0 == bufferLengthInBytes)
+
+      RTCPPacketPtr pThis(make_shared<RTCPPacket>(make_private{}));
+      pThis->mBuffer = make_shared<SecureByteBlock>(reserveHeadroom + bufferLengthInBytes + reserveTailroom);
+      BYTE *pos = &((pThis->mBuffer->BytePtr())[reserveHeadroom]);
+      memcpy(pos, buffer, bufferLengthInBytes);
+      pThis->mPtr = pos;
+      pThis->mSize = bufferLengthInBytes;
+      if (!pThis->parse(DecodeType_All)) {
+        ZS_LOG_WARNING(Debug, pThis->log("packet could not be parsed"))
+        return RTCPPacketPtr();
+      }
+      return pThis;
+    }
+
     //-------------------------------------------------------------------------
     RTCPPacketPtr RTCPPacket::create(const SecureByteBlock &buffer)
     {
@@ -851,7 +895,11 @@ namespace ortc
     {
       RTCPPacketPtr pThis(make_shared<RTCPPacket>(make_private{}));
       pThis->mBuffer = buffer;
-      if (!pThis->parse()) {
+      if (buffer) {
+        pThis->mPtr = buffer->BytePtr();
+        pThis->mSize = buffer->SizeInBytes();
+      }
+      if (!pThis->parse(DecodeType_All)) {
         ZS_LOG_WARNING(Debug, pThis->log("packet could not be parsed"))
         return RTCPPacketPtr();
       }
@@ -861,23 +909,47 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacketPtr RTCPPacket::create(const Report *first)
     {
-      size_t allocationSize = getPacketSize(first);
-      SecureByteBlockPtr temp(make_shared<SecureByteBlock>(allocationSize));
+      return create(first, 0, 0);
+    }
 
-      BYTE *buffer = temp->BytePtr();
-      BYTE *pos = buffer;
-      writePacket(first, pos, allocationSize);
+    //-------------------------------------------------------------------------
+    RTCPPacketPtr RTCPPacket::create(
+                                     const Report *first,
+                                     size_t reserveHeadroom,
+                                     size_t reserveTailroom
+                                     )
+    {
+      size_t packetSize = getPacketSize(first);
+      SecureByteBlockPtr temp = generateFrom(first, reserveHeadroom, reserveTailroom);
 
-      return create(temp);
+      RTCPPacketPtr pThis(make_shared<RTCPPacket>(make_private{}));
+      pThis->mBuffer = temp;
+      pThis->mPtr = &((temp->BytePtr())[reserveHeadroom]);
+      pThis->mSize = packetSize;
+      if (!pThis->parse(DecodeType_All)) {
+        ZS_LOG_WARNING(Debug, pThis->log("packet could not be parsed"))
+        return RTCPPacketPtr();
+      }
+      return pThis;
     }
 
     //-------------------------------------------------------------------------
     SecureByteBlockPtr RTCPPacket::generateFrom(const Report *first)
+    {
+      return generateFrom(first, 0, 0);
+    }
+
+    //-------------------------------------------------------------------------
+    SecureByteBlockPtr RTCPPacket::generateFrom(
+                                                const Report *first,
+                                                size_t reserveHeadroom,
+                                                size_t reserveTailroom
+                                                )
     {
       size_t allocationSize = getPacketSize(first);
-      SecureByteBlockPtr temp(make_shared<SecureByteBlock>(allocationSize));
+      SecureByteBlockPtr temp(make_shared<SecureByteBlock>(reserveHeadroom + allocationSize + reserveTailroom));
 
-      BYTE *buffer = temp->BytePtr();
+      BYTE *buffer = &((temp->BytePtr())[reserveHeadroom]);
       BYTE *pos = buffer;
       writePacket(first, pos, allocationSize);
 
@@ -887,24 +959,70 @@ namespace ortc
     //-------------------------------------------------------------------------
     const BYTE *RTCPPacket::ptr() const
     {
-      return mBuffer->BytePtr();
+      return mPtr;
     }
 
     //-------------------------------------------------------------------------
     size_t RTCPPacket::size() const
     {
-      return mBuffer->SizeInBytes();
+      return mSize;
     }
 
     //-------------------------------------------------------------------------
     SecureByteBlockPtr RTCPPacket::buffer() const
     {
-      return mBuffer;
+      if ((0 == headroom()) &&
+          (0 == tailroom())) return mBuffer;
+
+      // parsed reports point into mBuffer thus an exact sized copy is handed out
+      return UseServicesHelper::convertToBuffer(mPtr, mSize);
+    }
+
+    //-------------------------------------------------------------------------
+    size_t RTCPPacket::headroom() const
+    {
+      if (!mBuffer) return 0;
+      return static_cast<size_t>(mPtr - mBuffer->BytePtr());
+    }
+
+    //-------------------------------------------------------------------------
+    size_t RTCPPacket::tailroom() const
+    {
+      if (!mBuffer) return 0;
+      return mBuffer->SizeInBytes() - headroom() - mSize;
+    }
+
+    //-------------------------------------------------------------------------
+    BYTE *RTCPPacket::writablePtr()
+    {
+      ASSERT((bool)mBuffer)
+      return &((mBuffer->BytePtr())[headroom()]);
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTCPPacket::decode(DecodeTypes types) const
+    {
+      WORD wanted = static_cast<WORD>(types);
+
+      if (wanted == (mDecodedTypes.load() & wanted)) return 0 == (mMalformedTypes & wanted);
+
+      AutoLock lock(mDecodeLock);
+      return const_cast<RTCPPacket *>(this)->decodePending(wanted);
+    }
+
+    //-------------------------------------------------------------------------
+    RTCPPacket::Report *RTCPPacket::first() const
+    {
+      // the compound chain visits every report type; a chain containing
+      // dropped (malformed) reports is not handed out
+      if (!decode(DecodeType_All)) return NULL;
+      return mFirst;
     }
 
     //-------------------------------------------------------------------------
     RTCPPacket::SenderReport *RTCPPacket::senderReportAtIndex(size_t index) const
     {
+      decode(DecodeType_SenderReport);
       ASSERT(index < mSenderReportCount)
       return &(mFirstSenderReport[index]);
     }
@@ -912,6 +1030,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacket::ReceiverReport *RTCPPacket::receiverReportAtIndex(size_t index) const
     {
+      decode(DecodeType_ReceiverReport);
       ASSERT(index < mReceiverReportCount)
       return &(mFirstReceiverReport[index]);
     }
@@ -919,6 +1038,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacket::SDES *RTCPPacket::sdesAtIndex(size_t index) const
     {
+      decode(DecodeType_SDES);
       ASSERT(index < mSDESCount)
       return &(mFirstSDES[index]);
     }
@@ -926,6 +1046,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacket::Bye *RTCPPacket::byeAtIndex(size_t index) const
     {
+      decode(DecodeType_Bye);
       ASSERT(index < mByeCount)
       return &(mFirstBye[index]);
     }
@@ -933,6 +1054,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacket::App *RTCPPacket::appAtIndex(size_t index) const
     {
+      decode(DecodeType_App);
       ASSERT(index < mAppCount)
       return &(mFirstApp[index]);
     }
@@ -940,6 +1062,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacket::TransportLayerFeedbackMessage *RTCPPacket::transportLayerFeedbackReportAtIndex(size_t index) const
     {
+      decode(DecodeType_TransportLayerFeedbackMessage);
       ASSERT(index < mTransportLayerFeedbackMessageCount)
       return &(mFirstTransportLayerFeedbackMessage[index]);
     }
@@ -947,6 +1070,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacket::PayloadSpecificFeedbackMessage *RTCPPacket::payloadSpecificFeedbackReportAtIndex(size_t index) const
     {
+      decode(DecodeType_PayloadSpecificFeedbackMessage);
       ASSERT(index < mPayloadSpecificFeedbackMessageCount)
       return &(mFirstPayloadSpecificFeedbackMessage[index]);
     }
@@ -954,6 +1078,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacket::XR *RTCPPacket::xrAtIndex(size_t index) const
     {
+      decode(DecodeType_XR);
       ASSERT(index < mXRCount)
       return &(mFirstXR[index]);
     }
@@ -961,6 +1086,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTCPPacket::UnknownReport *RTCPPacket::unknownAtIndex(size_t index) const
     {
+      decode(DecodeType_UnknownReport);
       ASSERT(index < mUnknownReportCount)
       return &(mFirstUnknownReport[index]);
     }
@@ -1795,13 +1921,18 @@ namespace ortc
     {
       ElementPtr objectEl = Element::create("ortc::RTCPPacket");
 
-      UseServicesHelper::debugAppend(objectEl, "buffer", mBuffer ? mBuffer->SizeInBytes() : 0);
+      Report *firstReport = first();
+
+      UseServicesHelper::debugAppend(objectEl, "buffer", mSize);
       UseServicesHelper::debugAppend(objectEl, "allocate buffer", mAllocationBuffer ? mAllocationBuffer->SizeInBytes() : 0);
+      UseServicesHelper::debugAppend(objectEl, "allocate overflow buffers", mAllocationOverflowBuffers.size());
 
       UseServicesHelper::debugAppend(objectEl, "allocation pos", (NULL != mAllocationPos ? (mAllocationBuffer ? (reinterpret_cast<PTRNUMBER>(mAllocationPos) - reinterpret_cast<PTRNUMBER>(mAllocationBuffer->BytePtr())) : reinterpret_cast<PTRNUMBER>(mAllocationPos)) : 0));
-      UseServicesHelper::debugAppend(objectEl, "buffer", mAllocationSize);
+      UseServicesHelper::debugAppend(objectEl, "allocation remaining", mAllocationSize);
+      UseServicesHelper::debugAppend(objectEl, "decoded types", mDecodedTypes.load());
+      UseServicesHelper::debugAppend(objectEl, "malformed types", mMalformedTypes);
 
-      for (Report *report = mFirst; NULL != report; report = report->next())
+      for (Report *report = firstReport; NULL != report; report = report->next())
       {
         switch (report->pt()) {
           case SenderReport::kPayloadType:
@@ -1899,10 +2030,10 @@ namespace ortc
     }
 
     //-------------------------------------------------------------------------
-    bool RTCPPacket::parse()
+    bool RTCPPacket::parse(DecodeTypes decodeNow)
     {
-      const BYTE *buffer = mBuffer->BytePtr();
-      size_t size = mBuffer->SizeInBytes();
+      const BYTE *buffer = ptr();
+      size_t size = this->size();
 
       if (size < kMinRtcpPacketLen) {
         ZS_LOG_WARNING(Trace, log("packet length is too short") + ZS_PARAM("length", size))
@@ -1911,7 +2042,9 @@ namespace ortc
 
       bool foundPaddingBit = false;
 
-      // scope: calculate total memory allocation size needed to parse entire RTCP packet
+      // scope: walk the compound packet's report headers (only the first
+      //        word of each report is touched) to validate the framing and
+      //        count how many of each report type are present
       {
         size_t remaining = size;
         const BYTE *pos = buffer;
@@ -1923,966 +2056,156 @@ namespace ortc
             return false;
           }
 
-          size_t length = sizeof(DWORD) + (static_cast<size_t>(RTPUtils::getBE16(&(pos[2]))) * sizeof(DWORD));
-
-          size_t padding = 0;
-
-          if (RTCP_IS_FLAG_SET(*pos, 5)) {
-            if (foundPaddingBit) {
-              ZS_LOG_WARNING(Trace, debug("found illegal second padding bit set in compound RTCP block"))
-              return false;
-            }
-
-            padding = buffer[size-1];
-          }
-
-          if ((sizeof(DWORD) + padding) > length) {
-            ZS_LOG_WARNING(Trace, debug("malformed padding size in RTCP packet"))
-            return false;
-          }
-
-          length -= padding;
-
-          if (remaining < length) {
-            ZS_LOG_WARNING(Trace, debug("insufficient length remaining for RTCP block") + ZS_PARAM("length", length) + ZS_PARAM("remaining", remaining))
-            return false;
-          }
-
-          BYTE reportSpecific = RTCP_GET_BITS(*pos, 0x1F, 0);
-
-          const BYTE *prePos = pos;
-          BYTE pt = pos[1];
-
-          advancePos(pos, remaining, sizeof(DWORD));
-
-          size_t preAllocationSize = mAllocationSize;
-
-          if (!getAllocationSize(version, static_cast<BYTE>(padding), reportSpecific, pt, pos, length - sizeof(DWORD))) return false;
-
-          advancePos(pos, remaining, length - sizeof(DWORD));
-
-          if (0 != padding) {
-            advancePos(pos, remaining, padding);
-          }
-
-          if (ZS_IS_LOGGING(Insane)) {
-            ZS_LOG_TRACE(log("report allocation size") + ZS_PARAM("pt", Report::ptToString(pt)) + ZS_PARAM("pt (number)", pt) + ZS_PARAM("consumed", (reinterpret_cast<PTRNUMBER>(pos) - reinterpret_cast<PTRNUMBER>(prePos))) + ZS_PARAM("allocation size", mAllocationSize - preAllocationSize))
-          }
-
-          ++mCount;
-        }
-      }
-
-      if (0 == mAllocationSize) {
-        ZS_LOG_TRACE(debug("no RTCP packets were processed"))
-        return true;
-      }
-
-      mAllocationBuffer = make_shared<SecureByteBlock>(alignedSize(mAllocationSize));
-
-      mAllocationPos = mAllocationBuffer->BytePtr();
-
-      // scope: allocation size is now established; begin parsing all reports contained in RTCP packet
-      {
-        size_t remaining = size;
-        const BYTE *pos = buffer;
-
-
-        if (0 != mSenderReportCount) {
-          mFirstSenderReport = new (allocateBuffer(alignedSize(sizeof(SenderReport)) * mSenderReportCount)) SenderReport[mSenderReportCount];
-        }
-        if (0 != mReceiverReportCount) {
-          mFirstReceiverReport = new (allocateBuffer(alignedSize(sizeof(ReceiverReport)) * mReceiverReportCount)) ReceiverReport[mReceiverReportCount];
-        }
-        if (0 != mSDESCount) {
-          mFirstSDES = new (allocateBuffer(alignedSize(sizeof(SDES)) * mSDESCount)) SDES[mSDESCount];
-        }
-        if (0 != mByeCount) {
-          mFirstBye = new (allocateBuffer(alignedSize(sizeof(Bye)) * mByeCount)) Bye[mByeCount];
-        }
-        if (0 != mAppCount) {
-          mFirstApp = new (allocateBuffer(alignedSize(sizeof(App)) * mAppCount)) App[mAppCount];
-        }
-        if (0 != mTransportLayerFeedbackMessageCount) {
-          mFirstTransportLayerFeedbackMessage = new (allocateBuffer(alignedSize(sizeof(TransportLayerFeedbackMessage)) * mTransportLayerFeedbackMessageCount)) TransportLayerFeedbackMessage[mTransportLayerFeedbackMessageCount];
-        }
-        if (0 != mPayloadSpecificFeedbackMessageCount) {
-          mFirstPayloadSpecificFeedbackMessage = new (allocateBuffer(alignedSize(sizeof(PayloadSpecificFeedbackMessage)) * mPayloadSpecificFeedbackMessageCount)) PayloadSpecificFeedbackMessage[mPayloadSpecificFeedbackMessageCount];
-        }
-        if (0 != mXRCount) {
-          mFirstXR = new (allocateBuffer(alignedSize(sizeof(XR)) * mXRCount)) XR[mXRCount];
-        }
-        if (0 != mUnknownReportCount) {
-          mFirstUnknownReport = new (allocateBuffer(alignedSize(sizeof(UnknownReport)) * mUnknownReportCount)) UnknownReport[mUnknownReportCount];
-        }
-
-        mSenderReportCount = 0;
-        mReceiverReportCount = 0;
-        mSDESCount = 0;
-        mByeCount = 0;
-        mAppCount = 0;
-        mTransportLayerFeedbackMessageCount = 0;
-        mPayloadSpecificFeedbackMessageCount = 0;
-        mXRCount = 0;
-        mUnknownReportCount = 0;
-
-        Report *lastReport = NULL;
-        size_t count = 0;
-
-        while (remaining >= kMinRtcpPacketLen) {
-          auto version = RTCP_GET_BITS(*pos, 0x3, 6);
-          size_t length = sizeof(DWORD) + (static_cast<size_t>(RTPUtils::getBE16(&(pos[2]))) * sizeof(DWORD));
-
-          size_t padding = 0;
-
-          if (RTCP_IS_FLAG_SET(*pos, 5)) {
-            padding = buffer[size-1];
-            length -= padding; // already protected during pre-parse against malformed padding length
-          }
-
-          BYTE reportSpecific = RTCP_GET_BITS(*pos, 0x1F, 0);
-
-          const BYTE *prePos = pos;
-          BYTE pt = pos[1];
-
-          advancePos(pos, remaining, sizeof(DWORD));
-
-          size_t preAllocationSize = mAllocationSize;
-
-          if (!parse(lastReport, version, static_cast<BYTE>(padding), reportSpecific, pt, pos, length - sizeof(DWORD))) return false;
-
-          if (NULL == mFirst) {
-            mFirst = lastReport;
-          }
-
-          advancePos(pos, remaining, length - sizeof(DWORD));
-
-          if (0 != padding) {
-            advancePos(pos, remaining, padding);
-          }
-
-          if (ZS_IS_LOGGING(Insane)) {
-            ZS_LOG_TRACE(log("report parsed") + ZS_PARAM("pt", Report::ptToString(pt)) + ZS_PARAM("pt (number)", pt) + ZS_PARAM("consumed", (reinterpret_cast<PTRNUMBER>(pos) - reinterpret_cast<PTRNUMBER>(prePos))) + ZS_PARAM("consumed allocation", preAllocationSize - mAllocationSize))
-          }
-
-          ++count;
-          ASSERT(count <= mCount)
-        }
-      }
-
-      ZS_LOG_INSANE(debug("parsed"))
-
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    //-------------------------------------------------------------------------
-    //-------------------------------------------------------------------------
-    //-------------------------------------------------------------------------
-    #pragma mark
-    #pragma mark RTCPPacket (parse allocation sizing routines)
-    #pragma mark
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getAllocationSize(
-                                       BYTE version,
-                                       BYTE padding,
-                                       BYTE reportSpecific,
-                                       BYTE pt,
-                                       const BYTE *contents,
-                                       size_t contentSize
-                                       )
-    {
-      bool result = false;
-
-      switch (pt) {
-        case SenderReport::kPayloadType:                    result = getSenderReportAllocationSize(version, padding, reportSpecific, contents, contentSize); break;
-        case ReceiverReport::kPayloadType:                  result = getReceiverReportAllocationSize(version, padding, reportSpecific, contents, contentSize); break;
-        case SDES::kPayloadType:                            result = getSDESAllocationSize(version, padding, reportSpecific, contents, contentSize); break;
-        case Bye::kPayloadType:                             result = getByeAllocationSize(version, padding, reportSpecific, contents, contentSize); break;
-        case App::kPayloadType:                             result = getAppAllocationSize(version, padding, reportSpecific, contents, contentSize); break;
-        case TransportLayerFeedbackMessage::kPayloadType:   result = getTransportLayerFeedbackMessageAllocationSize(version, padding, reportSpecific, contents, contentSize); break;
-        case PayloadSpecificFeedbackMessage::kPayloadType:  result = getPayloadSpecificFeedbackMessageAllocationSize(version, padding, reportSpecific, contents, contentSize); break;
-        case XR::kPayloadType:                              result = getXRAllocationSize(version, padding, reportSpecific, contents, contentSize); break;
-        default:
-        {
-          result = getUnknownReportAllocationSize(version, padding, reportSpecific, contents, contentSize);
-          break;
-        }
-      }
-      return result;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getSenderReportAllocationSize(
-                                                   BYTE version,
-                                                   BYTE padding,
-                                                   BYTE reportSpecific,
-                                                   const BYTE *contents,
-                                                   size_t contentSize
-                                                   )
-    {
-      ++mSenderReportCount;
-
-      mAllocationSize += alignedSize(sizeof(SenderReport)) + (alignedSize(sizeof(SenderReport::ReportBlock)) * static_cast<size_t>(reportSpecific));
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getReceiverReportAllocationSize(
-                                                     BYTE version,
-                                                     BYTE padding,
-                                                     BYTE reportSpecific,
-                                                     const BYTE *contents,
-                                                     size_t contentSize
-                                                     )
-    {
-      ++mReceiverReportCount;
-
-      mAllocationSize += alignedSize(sizeof(ReceiverReport)) + (alignedSize(sizeof(ReceiverReport::ReportBlock)) * static_cast<size_t>(reportSpecific));
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getSDESAllocationSize(
-                                           BYTE version,
-                                           BYTE padding,
-                                           BYTE reportSpecific,
-                                           const BYTE *contents,
-                                           size_t contentSize
-                                           )
-    {
-      ++mSDESCount;
-
-      size_t chunksCount = static_cast<size_t>(reportSpecific);
-
-      mAllocationSize += alignedSize(sizeof(SDES)) + (alignedSize(sizeof(SDES::Chunk)) * chunksCount);
-
-      size_t remaining = contentSize;
-
-      const BYTE *pos = contents;
-
-      while ((remaining > sizeof(DWORD)) &&
-             (chunksCount > 0))
-      {
-        advancePos(pos, remaining, sizeof(DWORD));
-
-        ZS_LOG_INSANE(log("getting SDES chunk allocation size") + ZS_PARAM("chunk number", static_cast<size_t>(reportSpecific) - chunksCount))
-
-        --chunksCount;
-
-        while (remaining >= sizeof(BYTE)) {
-
-          size_t preAllocationSize = mAllocationSize;
-
-          BYTE type = *pos;
-          advancePos(pos, remaining);
-
-          if (SDES::Chunk::kEndOfItemsType == type) {
-            // skip NUL item (no length octet is present)
-
-            // skip to next DWORD alignment
-            auto diff = reinterpret_cast<PTRNUMBER>(pos) - reinterpret_cast<PTRNUMBER>(contents);
-            while ((0 != (diff % sizeof(DWORD))) &&
-                   (remaining > 0))
-            {
-              // only NUL chunks are allowed
-              if (SDES::Chunk::kEndOfItemsType != (*pos)) {
-                ZS_LOG_WARNING(Insane, log("SDES item type is not understood") + ZS_PARAM("type", *pos))
-                return false;
-              }
-
-              advancePos(pos, remaining);
-              ++diff;
-            }
-            break;
-          }
-
-          if (remaining < sizeof(BYTE)) {
-            ZS_LOG_WARNING(Trace, log("no length of SDES entry present") + ZS_PARAM("remaining", remaining))
-            return false;
-          }
-
-          size_t prefixLength = 0;
-          size_t length = static_cast<size_t>(*pos);
-          advancePos(pos, remaining);
-
-          if (remaining < length) {
-            ZS_LOG_WARNING(Trace, debug("malformed SDES length found") + ZS_PARAM("length", length) + ZS_PARAM("remaining", remaining))
-            return false;
-          }
-
-          switch (type) {
-            case SDES::Chunk::CName::kItemType: mAllocationSize += alignedSize(sizeof(SDES::Chunk::CName)); break;
-            case SDES::Chunk::Name::kItemType:  mAllocationSize += alignedSize(sizeof(SDES::Chunk::Name)); break;
-            case SDES::Chunk::Email::kItemType: mAllocationSize += alignedSize(sizeof(SDES::Chunk::Email)); break;
-            case SDES::Chunk::Phone::kItemType: mAllocationSize += alignedSize(sizeof(SDES::Chunk::Phone)); break;
-            case SDES::Chunk::Loc::kItemType:   mAllocationSize += alignedSize(sizeof(SDES::Chunk::Loc)); break;
-            case SDES::Chunk::Tool::kItemType:  mAllocationSize += alignedSize(sizeof(SDES::Chunk::Tool)); break;
-            case SDES::Chunk::Note::kItemType:  mAllocationSize += alignedSize(sizeof(SDES::Chunk::Note)); break;
-            case SDES::Chunk::Priv::kItemType:
-            {
-              {
-                mAllocationSize += alignedSize(sizeof(SDES::Chunk::Priv));
-
-                if (length > 0) {
-                  prefixLength = static_cast<size_t>(*pos);
-
-                  if (prefixLength > (length-1)) goto illegal_priv_prefix;
-
-                  if (0 != prefixLength) {
-                    mAllocationSize += alignedSize(sizeof(char)*(prefixLength+1));
-                  }
-                }
-                break;
-              }
-            illegal_priv_prefix:
-              {
-                ZS_LOG_WARNING(Trace, debug("malformed SDES Priv prefix found"))
-                return false;
-              }
-              break;
-            }
-            case SDES::Chunk::Mid::kItemType:  mAllocationSize += alignedSize(sizeof(SDES::Chunk::Mid)); break;
-            case SDES::Chunk::Rid::kItemType:  mAllocationSize += alignedSize(sizeof(SDES::Chunk::Rid)); break;
-            default:
-            {
-              mAllocationSize += alignedSize(sizeof(SDES::Chunk::Unknown));
-              ZS_LOG_WARNING(Insane, log("SDES item type is not understood") + ZS_PARAM("type", type))
-              break;
-            }
-          }
-
-          if (0 != length) {
-            mAllocationSize += alignedSize((sizeof(char)*length)+sizeof(char));
-          }
-
-          ZS_LOG_INSANE(log("get SDES item allocation size") + ZS_PARAM("type", SDES::Chunk::StringItem::typeToString(type)) + ZS_PARAM("type (number)", type) + ZS_PARAM("prefix length", prefixLength) + ZS_PARAM("length", length) + ZS_PARAM("allocation size", (mAllocationSize - preAllocationSize)))
-
-          advancePos(pos, remaining, length);
-        }
-
-      }
-
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getByeAllocationSize(
-                                           BYTE version,
-                                           BYTE padding,
-                                           BYTE reportSpecific,
-                                           const BYTE *contents,
-                                           size_t contentSize
-                                           )
-    {
-      ++mByeCount;
-
-      size_t ssrcCount = static_cast<size_t>(reportSpecific);
-
-      mAllocationSize += alignedSize(sizeof(Bye)) + (alignedSize(sizeof(DWORD)) * ssrcCount);
-
-      const BYTE *pos = contents;
-      size_t remaining = contentSize;
-
-      if (remaining < (ssrcCount * sizeof(DWORD))) {
-        ZS_LOG_WARNING(Trace, debug("malformed BYE SSRC size"))
-        return false;
-      }
-
-      advancePos(pos, remaining, sizeof(DWORD) * ssrcCount);
-
-      if (remaining < sizeof(BYTE)) return true;
-
-      size_t length = static_cast<size_t>(*pos);
-
-      if (length < 1) return true;
-
-      if (length > remaining) {
-        ZS_LOG_WARNING(Trace, debug("malformed BYE reason length") + ZS_PARAM("length", length) + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      mAllocationSize += alignedSize((sizeof(char)*(length+1)));
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getAppAllocationSize(
-                                           BYTE version,
-                                           BYTE padding,
-                                           BYTE reportSpecific,
-                                           const BYTE *contents,
-                                           size_t contentSize
-                                           )
-    {
-      ++mAppCount;
-
-      mAllocationSize += alignedSize(sizeof(App));
-
-      size_t remaining = contentSize;
-
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Detail, log("malformed APP length") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getTransportLayerFeedbackMessageAllocationSize(
-                                                                    BYTE version,
-                                                                    BYTE padding,
-                                                                    BYTE reportSpecific,
-                                                                    const BYTE *contents,
-                                                                    size_t contentSize
-                                                                    )
-    {
-      ++mTransportLayerFeedbackMessageCount;
-
-      mAllocationSize += alignedSize(sizeof(TransportLayerFeedbackMessage));
-
-      const BYTE *pos = contents;
-      size_t remaining = contentSize;
-
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Detail, log("malformed transport layer feedback message length") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      advancePos(pos, remaining, sizeof(DWORD)*2);
-
-      bool result = false;
-
-      switch (reportSpecific) {
-        case TransportLayerFeedbackMessage::GenericNACK::kFmt:  result = getTransportLayerFeedbackMessageGenericNACKAllocationSize(reportSpecific, pos, remaining); break;
-        case TransportLayerFeedbackMessage::TMMBR::kFmt:        result = getTransportLayerFeedbackMessageTMMBRAllocationSize(reportSpecific, pos, remaining); break;
-        case TransportLayerFeedbackMessage::TMMBN::kFmt:        result = getTransportLayerFeedbackMessageTMMBNAllocationSize(reportSpecific, pos, remaining); break;
-        default: {
-          break;
-        }
-      }
-
-      ZS_LOG_INSANE(packet_slog("getting transport layer feedback message size") + ZS_PARAM("fmt", FeedbackMessage::fmtToString(TransportLayerFeedbackMessage::kPayloadType, reportSpecific)) + ZS_PARAM("fmt (number)", reportSpecific))
-
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageAllocationSize(
-                                                                     BYTE version,
-                                                                     BYTE padding,
-                                                                     BYTE reportSpecific,
-                                                                     const BYTE *contents,
-                                                                     size_t contentSize
-                                                                     )
-    {
-      ++mPayloadSpecificFeedbackMessageCount;
-
-      mAllocationSize += alignedSize(sizeof(PayloadSpecificFeedbackMessage));
-
-      const BYTE *pos = contents;
-      size_t remaining = contentSize;
-
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Detail, log("malformed transport layer feedback message length") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      advancePos(pos, remaining, sizeof(DWORD)*2);
-
-      bool result = false;
-
-      char bogus[sizeof(DWORD)] {};
-      const DWORD *usingSubType = reinterpret_cast<const DWORD *>(&(bogus[0]));
-
-      switch (reportSpecific) {
-        case PayloadSpecificFeedbackMessage::PLI::kFmt:   result = getPayloadSpecificFeedbackMessagePLIAllocationSize(reportSpecific, pos, remaining); break;
-        case PayloadSpecificFeedbackMessage::SLI::kFmt:   result = getPayloadSpecificFeedbackMessageSLIAllocationSize(reportSpecific, pos, remaining); break;
-        case PayloadSpecificFeedbackMessage::RPSI::kFmt:  result = getPayloadSpecificFeedbackMessageRPSIAllocationSize(reportSpecific, pos, remaining); break;
-        case PayloadSpecificFeedbackMessage::FIR::kFmt:   result = getPayloadSpecificFeedbackMessageFIRAllocationSize(reportSpecific, pos, remaining); break;
-        case PayloadSpecificFeedbackMessage::TSTR::kFmt:  result = getPayloadSpecificFeedbackMessageTSTRAllocationSize(reportSpecific, pos, remaining); break;
-        case PayloadSpecificFeedbackMessage::TSTN::kFmt:  result = getPayloadSpecificFeedbackMessageTSTNAllocationSize(reportSpecific, pos, remaining); break;
-        case PayloadSpecificFeedbackMessage::VBCM::kFmt:  result = getPayloadSpecificFeedbackMessageVBCMAllocationSize(reportSpecific, pos, remaining); break;
-        case PayloadSpecificFeedbackMessage::AFB::kFmt:   {
-          {
-            if (remaining < sizeof(DWORD)) goto generic_afb;
-            if (0 != memcmp(pos, reinterpret_cast<const BYTE *>("REMB"), sizeof(DWORD))) goto generic_afb;
-
-            usingSubType = reinterpret_cast<const DWORD *>(pos);
-
-            result = getPayloadSpecificFeedbackMessageREMBAllocationSize(reportSpecific, pos, remaining);
-            break;
-          }
-        generic_afb:
-          {
-            result = getPayloadSpecificFeedbackMessageAFBAllocationSize(reportSpecific, pos, remaining);
-            break;
-          }
-        }
-        default: {
-          break;
-        }
-      }
-
-      ZS_LOG_INSANE(packet_slog("getting payload specific feedback message size") + ZS_PARAM("fmt", FeedbackMessage::fmtToString(TransportLayerFeedbackMessage::kPayloadType, reportSpecific, *usingSubType)) + ZS_PARAM("fmt (number)", reportSpecific))
-
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRAllocationSize(
-                                         BYTE version,
-                                         BYTE padding,
-                                         BYTE reportSpecific,
-                                         const BYTE *contents,
-                                         size_t contentSize
-                                         )
-    {
-      ++mXRCount;
-
-      mAllocationSize += alignedSize(sizeof(XR));
-
-      const BYTE *pos = contents;
-      size_t remaining = contentSize;
-
-      if (remaining < sizeof(DWORD)) {
-        ZS_LOG_WARNING(Trace, debug("XR is not a valid length") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      advancePos(pos, remaining, sizeof(DWORD));
-
-      while (remaining >= sizeof(DWORD)) {
-        const BYTE *prePos = pos;
-        size_t preAllocationSize = mAllocationSize;
-
-        BYTE bt = pos[0];
-        BYTE typeSpecific = pos[1];
-        size_t blockLength = static_cast<size_t>(RTPUtils::getBE16(&(pos[2]))) * sizeof(DWORD);
-
-        advancePos(pos, remaining, sizeof(DWORD));
-
-        if (remaining < blockLength) {
-          ZS_LOG_WARNING(Trace, debug("malformed XR block length found") + ZS_PARAM("block length", blockLength) + ZS_PARAM("remaining", remaining))
-          return false;
-        }
-
-        bool result = false;
-
-        switch (bt) {
-          case XR::LossRLEReportBlock::kBlockType:                result = getXRLossRLEReportBlockAllocationSize(typeSpecific, pos, blockLength); break;
-          case XR::DuplicateRLEReportBlock::kBlockType:           result = getXRDuplicateRLEReportBlockAllocationSize(typeSpecific, pos, blockLength); break;
-          case XR::PacketReceiptTimesReportBlock::kBlockType:     result = getXRPacketReceiptTimesReportBlockAllocationSize(typeSpecific, pos, blockLength); break;
-          case XR::ReceiverReferenceTimeReportBlock::kBlockType:  result = getXRReceiverReferenceTimeReportBlockAllocationSize(typeSpecific, pos, blockLength); break;
-          case XR::DLRRReportBlock::kBlockType:                   result = getXRDLRRReportBlockAllocationSize(typeSpecific, pos, blockLength); break;
-          case XR::StatisticsSummaryReportBlock::kBlockType:      result = getXRStatisticsSummaryReportBlockAllocationSize(typeSpecific, pos, blockLength); break;
-          case XR::VoIPMetricsReportBlock::kBlockType:            result = getXRVoIPMetricsReportBlockAllocationSize(typeSpecific, pos, blockLength); break;
-          default:
-          {
-            result = getXRUnknownReportBlockAllocationSize(typeSpecific, pos, blockLength); break;
-            break;
-          }
-        }
-
-        if (!result) return false;
-
-        advancePos(pos, remaining, blockLength);
-
-        ZS_LOG_INSANE(log("get XR allocation size for block") + ZS_PARAM("block type", XR::ReportBlock::blockTypeToString(bt)) + ZS_PARAM("block type (number)", bt) + ZS_PARAM("block size", blockLength) + ZS_PARAM("consumed", (reinterpret_cast<PTRNUMBER>(pos) - reinterpret_cast<PTRNUMBER>(prePos))) + ZS_PARAM("allocation size", mAllocationSize - preAllocationSize))
-      }
-
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getUnknownReportAllocationSize(
-                                                   BYTE version,
-                                                   BYTE padding,
-                                                   BYTE reportSpecific,
-                                                   const BYTE *contents,
-                                                   size_t contentSize
-                                                   )
-    {
-      ++mUnknownReportCount;
-
-      mAllocationSize += alignedSize(sizeof(UnknownReport));
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getTransportLayerFeedbackMessageGenericNACKAllocationSize(
-                                                                               BYTE fmt,
-                                                                               const BYTE *contents,
-                                                                               size_t contentSize
-                                                                               )
-    {
-      size_t remaining = contentSize;
-
-      if (remaining < sizeof(DWORD)) {
-        ZS_LOG_WARNING(Trace, debug("malformed generic NACK transport layer feedback message") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      size_t possibleNACKs = remaining / sizeof(DWORD);
-
-      mAllocationSize += (alignedSize(sizeof(TransportLayerFeedbackMessage::GenericNACK)) * possibleNACKs);
-      return true;
-    }
-
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getTransportLayerFeedbackMessageTMMBRAllocationSize(
-                                                                         BYTE fmt,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      size_t remaining = contentSize;
-
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Trace, debug("malformed TMMBR transport layer feedback message") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      size_t possibleTMMBRs = remaining / (sizeof(DWORD)*2);
-
-      mAllocationSize += (alignedSize(sizeof(TransportLayerFeedbackMessage::TMMBR)) * possibleTMMBRs);
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getTransportLayerFeedbackMessageTMMBNAllocationSize(
-                                                                         BYTE fmt,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      size_t remaining = contentSize;
-
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Trace, debug("malformed TMMBN transport layer feedback message") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      size_t possibleTMMBNs = remaining / (sizeof(DWORD)*2);
-
-      mAllocationSize += (alignedSize(sizeof(TransportLayerFeedbackMessage::TMMBN)) * possibleTMMBNs);
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessagePLIAllocationSize(
-                                                                        BYTE fmt,
-                                                                        const BYTE *contents,
-                                                                        size_t contentSize
-                                                                        )
-    {
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageSLIAllocationSize(
-                                                                        BYTE fmt,
-                                                                        const BYTE *contents,
-                                                                        size_t contentSize
-                                                                        )
-    {
-      size_t remaining = contentSize;
-
-      if (remaining < sizeof(DWORD)) {
-        ZS_LOG_WARNING(Trace, debug("malformed SLI payload specific feedback message") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      size_t possibleSLIs = remaining / sizeof(DWORD);
-
-      mAllocationSize += (alignedSize(sizeof(PayloadSpecificFeedbackMessage::SLI)) * possibleSLIs);
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageRPSIAllocationSize(
-                                                                         BYTE fmt,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageFIRAllocationSize(
-                                                                         BYTE fmt,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      size_t remaining = contentSize;
-
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Trace, debug("malformed FIR payload specific feedback message") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      size_t possibleFIRs = remaining / (sizeof(DWORD)*2);
-
-      mAllocationSize += (alignedSize(sizeof(PayloadSpecificFeedbackMessage::FIR)) * possibleFIRs);
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageTSTRAllocationSize(
-                                                                         BYTE fmt,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      size_t remaining = contentSize;
-
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Trace, debug("malformed TSTR payload specific feedback message") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      size_t possibleTSTRs = remaining / (sizeof(DWORD)*2);
-
-      mAllocationSize += (alignedSize(sizeof(PayloadSpecificFeedbackMessage::TSTR)) * possibleTSTRs);
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageTSTNAllocationSize(
-                                                                         BYTE fmt,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      size_t remaining = contentSize;
-
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Trace, debug("malformed TSTN payload specific feedback message") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
-
-      size_t possibleTSTNs = remaining / (sizeof(DWORD)*2);
-
-      mAllocationSize += (alignedSize(sizeof(PayloadSpecificFeedbackMessage::TSTN)) * possibleTSTNs);
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageVBCMAllocationSize(
-                                                                         BYTE fmt,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      const BYTE *pos = contents;
-      size_t remaining = contentSize;
-
-      size_t possibleVBCMs = 0;
-
-      while (remaining >= (sizeof(DWORD)*2)) {
-        mAllocationSize += alignedSize(sizeof(PayloadSpecificFeedbackMessage::VBCM));
-        ++possibleVBCMs;
-
-        size_t length = RTPUtils::getBE16(&(pos[6]));
-        size_t modulas = length % sizeof(DWORD);
-        size_t padding = ((0 != modulas) ? (sizeof(DWORD)-modulas) : 0);
-
-        advancePos(pos, remaining, sizeof(DWORD)*2);
-
-        if (remaining < length) {
-          ZS_LOG_WARNING(Trace, debug("malformed VBCM payload specific feedback message") + ZS_PARAM("remaining", remaining) + ZS_PARAM("length", length))
-          return false;
-        }
-
-        size_t skipLength = (((length + padding) > remaining) ? remaining : (length + padding));
+          size_t length = sizeof(DWORD) + (static_cast<size_t>(RTPUtils::getBE16(&(pos[2]))) * sizeof(DWORD));
 
-        advancePos(pos, remaining, skipLength);
-      }
+          size_t padding = 0;
 
-      if (possibleVBCMs < 1) {
-        ZS_LOG_WARNING(Trace, debug("malformed VBCM payload specific feedback message") + ZS_PARAM("remaining", remaining) + ZS_PARAM("possible", possibleVBCMs))
-        return false;
-      }
+          if (RTCP_IS_FLAG_SET(*pos, 5)) {
+            if (foundPaddingBit) {
+              ZS_LOG_WARNING(Trace, debug("found illegal second padding bit set in compound RTCP block"))
+              return false;
+            }
 
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageAFBAllocationSize(
-                                                                         BYTE fmt,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      return true;
-    }
+            padding = buffer[size-1];
+          }
 
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getPayloadSpecificFeedbackMessageREMBAllocationSize(
-                                                                        BYTE fmt,
-                                                                        const BYTE *contents,
-                                                                        size_t contentSize
-                                                                        )
-    {
-      size_t remaining = contentSize;
+          if ((sizeof(DWORD) + padding) > length) {
+            ZS_LOG_WARNING(Trace, debug("malformed padding size in RTCP packet"))
+            return false;
+          }
 
-      if (remaining < (sizeof(DWORD)*3)) {
-        ZS_LOG_WARNING(Trace, debug("malformed REMB payload specific feedback message") + ZS_PARAM("remaining", remaining))
-        return false;
-      }
+          length -= padding;
+
+          if (remaining < length) {
+            ZS_LOG_WARNING(Trace, debug("insufficient length remaining for RTCP block") + ZS_PARAM("length", length) + ZS_PARAM("remaining", remaining))
+            return false;
+          }
 
-      size_t possibleSSRCs = (remaining - (sizeof(DWORD)*2)) / sizeof(DWORD);
+          countReport(pos[1]);
 
-      mAllocationSize += (alignedSize(sizeof(DWORD)) * possibleSSRCs);
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRLossRLEReportBlockAllocationSize(
-                                                           BYTE typeSpecific,
-                                                           const BYTE *contents,
-                                                           size_t contentSize
-                                                           )
-    {
-      mAllocationSize += alignedSize(sizeof(XR::LossRLEReportBlock));
+          advancePos(pos, remaining, length);
 
-      const BYTE *pos = contents;
-      size_t remaining = contentSize;
+          if (0 != padding) {
+            advancePos(pos, remaining, padding);
+          }
 
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Trace, debug("malformed loss RLE report block"))
-        return false;
+          ++mCount;
+        }
       }
 
-      advancePos(pos, remaining, sizeof(DWORD)*2);
+      if (0 == mCount) {
+        ZS_LOG_TRACE(debug("no RTCP packets were processed"))
+        mDecodedTypes = DecodeType_All;
+        return true;
+      }
 
-      size_t possibleChunks = remaining  / sizeof(WORD);
+      // scope: index every report contained in RTCP packet by type (report
+      //        bodies are decoded per type by decodePending)
+      {
+        size_t remaining = size;
+        const BYTE *pos = buffer;
 
-      if (0 != possibleChunks) {
-        mAllocationSize += alignedSize(sizeof(XR::RLEChunk)) * possibleChunks;
-      }
+        if (0 != mSenderReportCount) {
+          mFirstSenderReport = new (allocateBuffer(alignedSize(sizeof(SenderReport)) * mSenderReportCount)) SenderReport[mSenderReportCount];
+        }
+        if (0 != mReceiverReportCount) {
+          mFirstReceiverReport = new (allocateBuffer(alignedSize(sizeof(ReceiverReport)) * mReceiverReportCount)) ReceiverReport[mReceiverReportCount];
+        }
+        if (0 != mSDESCount) {
+          mFirstSDES = new (allocateBuffer(alignedSize(sizeof(SDES)) * mSDESCount)) SDES[mSDESCount];
+        }
+        if (0 != mByeCount) {
+          mFirstBye = new (allocateBuffer(alignedSize(sizeof(Bye)) * mByeCount)) Bye[mByeCount];
+        }
+        if (0 != mAppCount) {
+          mFirstApp = new (allocateBuffer(alignedSize(sizeof(App)) * mAppCount)) App[mAppCount];
+        }
+        if (0 != mTransportLayerFeedbackMessageCount) {
+          mFirstTransportLayerFeedbackMessage = new (allocateBuffer(alignedSize(sizeof(TransportLayerFeedbackMessage)) * mTransportLayerFeedbackMessageCount)) TransportLayerFeedbackMessage[mTransportLayerFeedbackMessageCount];
+        }
+        if (0 != mPayloadSpecificFeedbackMessageCount) {
+          mFirstPayloadSpecificFeedbackMessage = new (allocateBuffer(alignedSize(sizeof(PayloadSpecificFeedbackMessage)) * mPayloadSpecificFeedbackMessageCount)) PayloadSpecificFeedbackMessage[mPayloadSpecificFeedbackMessageCount];
+        }
+        if (0 != mXRCount) {
+          mFirstXR = new (allocateBuffer(alignedSize(sizeof(XR)) * mXRCount)) XR[mXRCount];
+        }
+        if (0 != mUnknownReportCount) {
+          mFirstUnknownReport = new (allocateBuffer(alignedSize(sizeof(UnknownReport)) * mUnknownReportCount)) UnknownReport[mUnknownReportCount];
+        }
 
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRDuplicateRLEReportBlockAllocationSize(
-                                                                BYTE typeSpecific,
-                                                                const BYTE *contents,
-                                                                size_t contentSize
-                                                                )
-    {
-      mAllocationSize += alignedSize(sizeof(XR::DuplicateRLEReportBlock));
+        mSenderReportCount = 0;
+        mReceiverReportCount = 0;
+        mSDESCount = 0;
+        mByeCount = 0;
+        mAppCount = 0;
+        mTransportLayerFeedbackMessageCount = 0;
+        mPayloadSpecificFeedbackMessageCount = 0;
+        mXRCount = 0;
+        mUnknownReportCount = 0;
 
-      const BYTE *pos = contents;
-      size_t remaining = contentSize;
+        Report *lastReport = NULL;
+        size_t count = 0;
 
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Trace, debug("malformed duplicate RLE report block"))
-        return false;
-      }
+        while (remaining >= kMinRtcpPacketLen) {
+          auto version = RTCP_GET_BITS(*pos, 0x3, 6);
+          size_t length = sizeof(DWORD) + (static_cast<size_t>(RTPUtils::getBE16(&(pos[2]))) * sizeof(DWORD));
 
-      advancePos(pos, remaining, sizeof(DWORD)*2);
+          size_t padding = 0;
 
-      size_t possibleChunks = remaining  / sizeof(WORD);
+          if (RTCP_IS_FLAG_SET(*pos, 5)) {
+            padding = buffer[size-1];
+            length -= padding; // already protected during header walk against malformed padding length
+          }
 
-      if (0 != possibleChunks) {
-        mAllocationSize += alignedSize(sizeof(XR::RLEChunk)) * possibleChunks;
-      }
+          BYTE reportSpecific = RTCP_GET_BITS(*pos, 0x1F, 0);
 
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRPacketReceiptTimesReportBlockAllocationSize(
-                                                                      BYTE typeSpecific,
-                                                                      const BYTE *contents,
-                                                                      size_t contentSize
-                                                                      )
-    {
-      mAllocationSize += alignedSize(sizeof(XR::PacketReceiptTimesReportBlock));
+          const BYTE *prePos = pos;
+          BYTE pt = pos[1];
 
-      const BYTE *pos = contents;
-      size_t remaining = contentSize;
+          advancePos(pos, remaining, sizeof(DWORD));
 
-      if (remaining < (sizeof(DWORD)*2)) {
-        ZS_LOG_WARNING(Trace, debug("malformed packet receipt times report block"))
-        return false;
-      }
+          index(lastReport, version, static_cast<BYTE>(padding), reportSpecific, pt, pos, length - sizeof(DWORD));
 
-      advancePos(pos, remaining, sizeof(DWORD)*2);
+          if (NULL == mFirst) {
+            mFirst = lastReport;
+          }
 
-      size_t possibleReceiptTimes = remaining  / sizeof(DWORD);
+          advancePos(pos, remaining, length - sizeof(DWORD));
 
-      if (0 != possibleReceiptTimes) {
-        mAllocationSize += alignedSize(sizeof(DWORD)) * possibleReceiptTimes;
-      }
+          if (0 != padding) {
+            advancePos(pos, remaining, padding);
+          }
 
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRReceiverReferenceTimeReportBlockAllocationSize(
-                                                                         BYTE typeSpecific,
-                                                                         const BYTE *contents,
-                                                                         size_t contentSize
-                                                                         )
-    {
-      mAllocationSize += alignedSize(sizeof(XR::ReceiverReferenceTimeReportBlock));
-      return true;
-    }
-    
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRDLRRReportBlockAllocationSize(
-                                                        BYTE typeSpecific,
-                                                        const BYTE *contents,
-                                                        size_t contentSize
-                                                        )
-    {
-      mAllocationSize += alignedSize(sizeof(XR::DLRRReportBlock));
+          if (ZS_IS_LOGGING(Insane)) {
+            ZS_LOG_TRACE(log("report indexed") + ZS_PARAM("pt", Report::ptToString(pt)) + ZS_PARAM("pt (number)", pt) + ZS_PARAM("consumed", (reinterpret_cast<PTRNUMBER>(pos) - reinterpret_cast<PTRNUMBER>(prePos))))
+          }
 
-      size_t possibleSubBlocks = contentSize / (sizeof(DWORD) + sizeof(DWORD) + sizeof(DWORD));
-      if (0 != possibleSubBlocks) {
-        mAllocationSize += alignedSize(sizeof(XR::DLRRReportBlock::SubBlock)) * possibleSubBlocks;
+          ++count;
+          ASSERT(count <= mCount)
+        }
       }
-      return true;
-    }
 
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRStatisticsSummaryReportBlockAllocationSize(
-                                                                     BYTE typeSpecific,
-                                                                     const BYTE *contents,
-                                                                     size_t contentSize
-                                                                     )
-    {
-      mAllocationSize += alignedSize(sizeof(XR::StatisticsSummaryReportBlock));
-      return true;
-    }
+      if (!decodePending(static_cast<WORD>(decodeNow))) return false;
+
+      ZS_LOG_INSANE(debug("parsed"))
 
-    //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRVoIPMetricsReportBlockAllocationSize(
-                                                               BYTE typeSpecific,
-                                                               const BYTE *contents,
-                                                               size_t contentSize
-                                                               )
-    {
-      mAllocationSize += alignedSize(sizeof(XR::VoIPMetricsReportBlock));
       return true;
     }
 
     //-------------------------------------------------------------------------
-    bool RTCPPacket::getXRUnknownReportBlockAllocationSize(
-                                                           BYTE typeSpecific,
-                                                           const BYTE *contents,
-                                                           size_t contentSize
-                                                           )
+    void RTCPPacket::countReport(BYTE pt)
     {
-      mAllocationSize += alignedSize(sizeof(XR::UnknownReportBlock));
-      return true;
+      switch (pt) {
+        case SenderReport::kPayloadType:                    ++mSenderReportCount; break;
+        case ReceiverReport::kPayloadType:                  ++mReceiverReportCount; break;
+        case SDES::kPayloadType:                            ++mSDESCount; break;
+        case Bye::kPayloadType:                             ++mByeCount; break;
+        case App::kPayloadType:                             ++mAppCount; break;
+        case TransportLayerFeedbackMessage::kPayloadType:   ++mTransportLayerFeedbackMessageCount; break;
+        case PayloadSpecificFeedbackMessage::kPayloadType:  ++mPayloadSpecificFeedbackMessageCount; break;
+        case XR::kPayloadType:                              ++mXRCount; break;
+        default:                                            ++mUnknownReportCount; break;
+      }
     }
 
     //-------------------------------------------------------------------------
@@ -2894,7 +2217,7 @@ namespace ortc
     #pragma mark
 
     //-------------------------------------------------------------------------
-    bool RTCPPacket::parse(
+    void RTCPPacket::index(
                            Report * &ioLastReport,
                            BYTE version,
                            BYTE padding,
@@ -2908,79 +2231,142 @@ namespace ortc
 
       switch (pt) {
         case SenderReport::kPayloadType:                                {
-          auto temp = &(mFirstSenderReport[mSenderReportCount]);;
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          auto temp = &(mFirstSenderReport[mSenderReportCount]);
+          if (0 != mSenderReportCount) {
+            (&(mFirstSenderReport[mSenderReportCount-1]))->mNextSenderReport = temp;
+          }
+          ++mSenderReportCount;
           usingReport = temp;
           break;
         }
         case ReceiverReport::kPayloadType:                              {
           auto temp = &(mFirstReceiverReport[mReceiverReportCount]);
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          if (0 != mReceiverReportCount) {
+            (&(mFirstReceiverReport[mReceiverReportCount-1]))->mNextReceiverReport = temp;
+          }
+          ++mReceiverReportCount;
           usingReport = temp;
           break;
         }
         case SDES::kPayloadType:                                        {
           auto temp = &(mFirstSDES[mSDESCount]);
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          if (0 != mSDESCount) {
+            (&(mFirstSDES[mSDESCount-1]))->mNextSDES = temp;
+          }
+          ++mSDESCount;
           usingReport = temp;
           break;
         }
         case Bye::kPayloadType:                                         {
           auto temp = &(mFirstBye[mByeCount]);
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          if (0 != mByeCount) {
+            (&(mFirstBye[mByeCount-1]))->mNextBye = temp;
+          }
+          ++mByeCount;
           usingReport = temp;
           break;
         }
         case App::kPayloadType:                                         {
           auto temp = &(mFirstApp[mAppCount]);
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          if (0 != mAppCount) {
+            (&(mFirstApp[mAppCount-1]))->mNextApp = temp;
+          }
+          ++mAppCount;
           usingReport = temp;
           break;
         }
         case TransportLayerFeedbackMessage::kPayloadType:               {
           auto temp = &(mFirstTransportLayerFeedbackMessage[mTransportLayerFeedbackMessageCount]);
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          if (0 != mTransportLayerFeedbackMessageCount) {
+            (&(mFirstTransportLayerFeedbackMessage[mTransportLayerFeedbackMessageCount-1]))->mNextTransportLayerFeedbackMessage = temp;
+          }
+          ++mTransportLayerFeedbackMessageCount;
           usingReport = temp;
           break;
         }
         case PayloadSpecificFeedbackMessage::kPayloadType:              {
           auto temp = &(mFirstPayloadSpecificFeedbackMessage[mPayloadSpecificFeedbackMessageCount]);
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          if (0 != mPayloadSpecificFeedbackMessageCount) {
+            (&(mFirstPayloadSpecificFeedbackMessage[mPayloadSpecificFeedbackMessageCount-1]))->mNextPayloadSpecificFeedbackMessage = temp;
+          }
+          ++mPayloadSpecificFeedbackMessageCount;
           usingReport = temp;
           break;
         }
         case XR::kPayloadType:                                          {
           auto temp = &(mFirstXR[mXRCount]);
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          if (0 != mXRCount) {
+            (&(mFirstXR[mXRCount-1]))->mNextXR = temp;
+          }
+          ++mXRCount;
           usingReport = temp;
           break;
         }
         default:
         {
           auto temp = &(mFirstUnknownReport[mUnknownReportCount]);
-          fill(temp, version, padding, reportSpecific, pt, contents, contentSize);
-          if (!parse(temp)) return false;
+          if (0 != mUnknownReportCount) {
+            (&(mFirstUnknownReport[mUnknownReportCount-1]))->mNextUnknown = temp;
+          }
+          ++mUnknownReportCount;
           usingReport = temp;
           break;
         }
       }
 
+      fill(usingReport, version, padding, reportSpecific, pt, contents, contentSize);
+
       if (NULL != ioLastReport) {
         ioLastReport->mNext = usingReport;
       }
 
       ioLastReport = usingReport;
+    }
+
+    //-------------------------------------------------------------------------
+    template <typename TReport>
+    bool RTCPPacket::decodeReports(
+                                   TReport * &ioFirst,
+                                   size_t &ioCount,
+                                   DecodeTypes type
+                                   )
+    {
+      for (size_t index = 0; index < ioCount; ++index) {
+        if (parse(&(ioFirst[index]))) continue;
+
+        // a malformed report drops all reports of the same type (the other
+        // report types in the compound packet remain usable)
+        ZS_LOG_WARNING(Trace, debug("dropping malformed reports") + ZS_PARAM("type", static_cast<WORD>(type)) + ZS_PARAM("index", index) + ZS_PARAM("count", ioCount))
+        ioFirst = NULL;
+        ioCount = 0;
+        mMalformedTypes |= static_cast<WORD>(type);
+        return false;
+      }
       return true;
     }
 
+    //-------------------------------------------------------------------------
+    bool RTCPPacket::decodePending(WORD types)
+    {
+      WORD pending = types & static_cast<WORD>(~mDecodedTypes.load());
+
+      if (0 != pending) {
+        if (0 != (pending & DecodeType_SenderReport)) decodeReports(mFirstSenderReport, mSenderReportCount, DecodeType_SenderReport);
+        if (0 != (pending & DecodeType_ReceiverReport)) decodeReports(mFirstReceiverReport, mReceiverReportCount, DecodeType_ReceiverReport);
+        if (0 != (pending & DecodeType_SDES)) decodeReports(mFirstSDES, mSDESCount, DecodeType_SDES);
+        if (0 != (pending & DecodeType_Bye)) decodeReports(mFirstBye, mByeCount, DecodeType_Bye);
+        if (0 != (pending & DecodeType_App)) decodeReports(mFirstApp, mAppCount, DecodeType_App);
+        if (0 != (pending & DecodeType_TransportLayerFeedbackMessage)) decodeReports(mFirstTransportLayerFeedbackMessage, mTransportLayerFeedbackMessageCount, DecodeType_TransportLayerFeedbackMessage);
+        if (0 != (pending & DecodeType_PayloadSpecificFeedbackMessage)) decodeReports(mFirstPayloadSpecificFeedbackMessage, mPayloadSpecificFeedbackMessageCount, DecodeType_PayloadSpecificFeedbackMessage);
+        if (0 != (pending & DecodeType_XR)) decodeReports(mFirstXR, mXRCount, DecodeType_XR);
+        if (0 != (pending & DecodeType_UnknownReport)) decodeReports(mFirstUnknownReport, mUnknownReportCount, DecodeType_UnknownReport);
+
+        mDecodedTypes |= pending;
+      }
+
+      return 0 == (mMalformedTypes & types);
+    }
+
     //-------------------------------------------------------------------------
     void RTCPPacket::fill(
                           Report *report,
@@ -3071,11 +2457,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(SenderReport *report)
     {
-      if (0 != mSenderReportCount) {
-        (&(mFirstSenderReport[mSenderReportCount-1]))->mNextSenderReport = report;
-      }
-      ++mSenderReportCount;
-
       if (!parseCommon(report, sizeof(DWORD)*5)) return false;
 
       const BYTE *pos = report->ptr();
@@ -3092,11 +2473,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(ReceiverReport *report)
     {
-      if (0 != mReceiverReportCount) {
-        (&(mFirstReceiverReport[mReceiverReportCount-1]))->mNextReceiverReport = report;
-      }
-      ++mReceiverReportCount;
-
       if (!parseCommon(report, 0)) return false;
 
       return true;
@@ -3105,11 +2481,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(SDES *report)
     {
-      if (0 != mSDESCount) {
-        (&(mFirstSDES[mSDESCount-1]))->mNextSDES = report;
-      }
-      ++mSDESCount;
-
       if (0 == report->sc()) return true;
 
       size_t chunkCount = 0;
@@ -3147,12 +2518,18 @@ namespace ortc
             break;
           }
 
-          ASSERT(remaining >= sizeof(BYTE))
+          if (remaining < sizeof(BYTE)) {
+            ZS_LOG_WARNING(Trace, log("no length of SDES entry present") + ZS_PARAM("remaining", remaining))
+            return false;
+          }
 
           size_t length = static_cast<size_t>(*pos);
           advancePos(pos, remaining);
 
-          ASSERT(remaining >= length)
+          if (remaining < length) {
+            ZS_LOG_WARNING(Trace, debug("malformed SDES length found") + ZS_PARAM("length", length) + ZS_PARAM("remaining", remaining))
+            return false;
+          }
 
           switch (type) {
             case SDES::Chunk::CName::kItemType: ++(chunk->mCNameCount); break;
@@ -3242,7 +2619,10 @@ namespace ortc
                    (remaining > 0))
             {
               // only NUL chunks are allowed
-              ASSERT(SDES::Chunk::kEndOfItemsType == (*pos))
+              if (SDES::Chunk::kEndOfItemsType != (*pos)) {
+                ZS_LOG_WARNING(Insane, log("SDES item type is not understood") + ZS_PARAM("type", *pos))
+                return false;
+              }
               advancePos(pos, remaining);
               ++diff;
             }
@@ -3328,6 +2708,10 @@ namespace ortc
                 prefixLen = static_cast<size_t>(*pos);
                 advancePos(pos, remaining);
                 --length;
+                if (prefixLen > length) {
+                  ZS_LOG_WARNING(Trace, debug("malformed SDES Priv prefix found") + ZS_PARAM("prefix length", prefixLen) + ZS_PARAM("length", length))
+                  return false;
+                }
                 if (0 != prefixLen) {
                   priv->mPrefix = new (allocateBuffer(sizeof(char)*(prefixLen+1))) char [prefixLen+1];
                   priv->mPrefixLength = prefixLen;
@@ -3407,11 +2791,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(Bye *report)
     {
-      if (0 != mByeCount) {
-        (&(mFirstBye[mByeCount-1]))->mNextBye = report;
-      }
-      ++mByeCount;
-
       const BYTE *pos = report->ptr();
       size_t remaining = report->size();
 
@@ -3464,11 +2843,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(App *report)
     {
-      if (0 != mAppCount) {
-        (&(mFirstApp[mAppCount-1]))->mNextApp = report;
-      }
-      ++mAppCount;
-
       const BYTE *pos = report->ptr();
       size_t remaining = report->size();
 
@@ -3503,11 +2877,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(TransportLayerFeedbackMessage *report)
     {
-      if (0 != mTransportLayerFeedbackMessageCount) {
-        (&(mFirstTransportLayerFeedbackMessage[mTransportLayerFeedbackMessageCount-1]))->mNextTransportLayerFeedbackMessage = report;
-      }
-      ++mTransportLayerFeedbackMessageCount;
-
       const BYTE *pos = report->ptr();
       size_t remaining = report->size();
 
@@ -3543,11 +2912,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(PayloadSpecificFeedbackMessage *report)
     {
-      if (0 != mPayloadSpecificFeedbackMessageCount) {
-        (&(mFirstPayloadSpecificFeedbackMessage[mPayloadSpecificFeedbackMessageCount-1]))->mNextPayloadSpecificFeedbackMessage = report;
-      }
-      ++mPayloadSpecificFeedbackMessageCount;
-
       const BYTE *pos = report->ptr();
       size_t remaining = report->size();
 
@@ -3602,11 +2966,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(XR *report)
     {
-      if (0 != mXRCount) {
-        (&(mFirstXR[mXRCount-1]))->mNextXR = report;
-      }
-      ++mXRCount;
-
       const BYTE *pos = report->ptr();
       size_t remaining = report->size();
 
@@ -3694,7 +3053,6 @@ namespace ortc
         // parse each XR report block
         while (remaining >= sizeof(DWORD)) {
           const BYTE *prePos = pos;
-          size_t preAllocationSize = mAllocationSize;
 
           BYTE bt = pos[0];
           BYTE typeSpecific = pos[1];
@@ -3802,7 +3160,7 @@ namespace ortc
 
           advancePos(pos, remaining, blockLength);
 
-          ZS_LOG_INSANE(packet_slog("parsed XR block") + ZS_PARAM("block type", usingBlock->blockTypeToString()) + ZS_PARAM("block type (number)", usingBlock->blockType()) + ZS_PARAM("block size", blockLength) + ZS_PARAM("consumed", (reinterpret_cast<PTRNUMBER>(pos) - reinterpret_cast<PTRNUMBER>(prePos)))  + ZS_PARAM("allocation consumed", preAllocationSize - mAllocationSize))
+          ZS_LOG_INSANE(packet_slog("parsed XR block") + ZS_PARAM("block type", usingBlock->blockTypeToString()) + ZS_PARAM("block type (number)", usingBlock->blockType()) + ZS_PARAM("block size", blockLength) + ZS_PARAM("consumed", (reinterpret_cast<PTRNUMBER>(pos) - reinterpret_cast<PTRNUMBER>(prePos))))
         }
         
 
@@ -3819,11 +3177,6 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTCPPacket::parse(UnknownReport *report)
     {
-      if (0 != mUnknownReportCount) {
-        (&(mFirstUnknownReport[mUnknownReportCount-1]))->mNextUnknown = report;
-      }
-      ++mUnknownReportCount;
-
       return true;
     }
     
@@ -3880,7 +3233,10 @@ namespace ortc
 
       size_t possibleNACKs = remaining / sizeof(DWORD);
 
-      ASSERT(0 != possibleNACKs)
+      if (0 == possibleNACKs) {
+        ZS_LOG_WARNING(Trace, debug("malformed generic NACK transport layer feedback message") + ZS_PARAM("remaining", remaining))
+        return false;
+      }
 
       report->mFirstGenericNACK = new (allocateBuffer(alignedSize(sizeof(GenericNACK))*possibleNACKs)) GenericNACK[possibleNACKs];
 
@@ -3925,7 +3281,10 @@ namespace ortc
 
       size_t possibleTMMBRs = remaining / (sizeof(DWORD)*2);
 
-      ASSERT(0 != possibleTMMBRs)
+      if (0 == possibleTMMBRs) {
+        ZS_LOG_WARNING(Trace, debug("malformed TMMBR transport layer feedback message") + ZS_PARAM("remaining", remaining))
+        return false;
+      }
 
       report->mFirstTMMBR = new (allocateBuffer(alignedSize(sizeof(TMMBR))*possibleTMMBRs)) TMMBR[possibleTMMBRs];
 
@@ -4000,7 +3359,10 @@ namespace ortc
 
       size_t possibleSLIs = remaining / (sizeof(DWORD));
 
-      ASSERT(0 != possibleSLIs)
+      if (0 == possibleSLIs) {
+        ZS_LOG_WARNING(Trace, debug("malformed SLI payload specific feedback message") + ZS_PARAM("remaining", remaining))
+        return false;
+      }
 
       report->mFirstSLI = new (allocateBuffer(alignedSize(sizeof(SLI))*possibleSLIs)) SLI[possibleSLIs];
 
@@ -4079,7 +3441,10 @@ namespace ortc
 
       size_t possibleFIRs = remaining / (sizeof(DWORD)*2);
 
-      ASSERT(0 != possibleFIRs)
+      if (0 == possibleFIRs) {
+        ZS_LOG_WARNING(Trace, debug("malformed FIR payload specific feedback message") + ZS_PARAM("remaining", remaining))
+        return false;
+      }
 
       report->mFirstFIR = new (allocateBuffer(alignedSize(sizeof(FIR))*possibleFIRs)) FIR[possibleFIRs];
 
@@ -4107,7 +3472,10 @@ namespace ortc
 
       size_t possibleTSTRs = remaining / (sizeof(DWORD)*2);
 
-      ASSERT(0 != possibleTSTRs)
+      if (0 == possibleTSTRs) {
+        ZS_LOG_WARNING(Trace, debug("malformed TSTR payload specific feedback message") + ZS_PARAM("remaining", remaining))
+        return false;
+      }
 
       report->mFirstTSTR = new (allocateBuffer(alignedSize(sizeof(TSTR))*possibleTSTRs)) TSTR[possibleTSTRs];
 
@@ -4138,7 +3506,10 @@ namespace ortc
 
       size_t possibleTSTNs = remaining / (sizeof(DWORD)*2);
 
-      ASSERT(0 != possibleTSTNs)
+      if (0 == possibleTSTNs) {
+        ZS_LOG_WARNING(Trace, debug("malformed TSTN payload specific feedback message") + ZS_PARAM("remaining", remaining))
+        return false;
+      }
 
       report->mFirstTSTN = new (allocateBuffer(alignedSize(sizeof(TSTN))*possibleTSTNs)) TSTN[possibleTSTNs];
 
@@ -4180,13 +3551,20 @@ namespace ortc
 
           advancePos(pos, remaining, sizeof(DWORD)*2);
 
-          ASSERT(remaining >= length)
+          if (remaining < length) {
+            ZS_LOG_WARNING(Trace, debug("malformed VBCM payload specific feedback message") + ZS_PARAM("remaining", remaining) + ZS_PARAM("length", length))
+            return false;
+          }
 
           size_t skipLength = (((length + padding) > remaining) ? remaining : (length + padding));
 
           advancePos(pos, remaining, skipLength);
         }
-        ASSERT(0 != possibleVBCMs)
+
+        if (0 == possibleVBCMs) {
+          ZS_LOG_WARNING(Trace, debug("malformed VBCM payload specific feedback message") + ZS_PARAM("remaining", remaining) + ZS_PARAM("possible", possibleVBCMs))
+          return false;
+        }
       }
 
       pos = report->fci();
@@ -4257,7 +3635,7 @@ namespace ortc
       report->mHasREMB = true;
 
       {
-        ASSERT(remaining >= sizeof(DWORD)*3)
+        if (remaining < (sizeof(DWORD)*3)) goto illegal_remaining;
 
         report->mREMB.mNumSSRC = pos[4];
         report->mREMB.mBRExp = RTCP_GET_BITS(pos[5], 0x3F, 2);
@@ -4557,6 +3935,21 @@ namespace ortc
     //-------------------------------------------------------------------------
     void *RTCPPacket::allocateBuffer(size_t size)
     {
+      size = alignedSize(size);
+
+      if (size > mAllocationSize) {
+        // current arena block is exhausted; borrow another from the buffer
+        // pool (its per thread cache makes this a free list pop; the blocks
+        // are recycled rather than freed when the packet is destroyed)
+        auto block = UseBufferPool::allocate(size > kAllocationBlockSize ? size : kAllocationBlockSize);
+        if (mAllocationBuffer) {
+          mAllocationOverflowBuffers.push_back(mAllocationBuffer);
+        }
+        mAllocationBuffer = block;
+        mAllocationPos = block->BytePtr();
+        mAllocationSize = block->SizeInBytes();
+      }
+
       return internal::allocateBuffer(mAllocationPos, mAllocationSize, size);
     }
 
@@ -37,6 +37,8 @@
 #include <ortc/internal/ortc_RTCPPacket.h>
 #include <ortc/internal/ortc_SRTPSDESTransport.h>
 #include <ortc/internal/ortc_RTPTypes.h>
+#include <ortc/internal/ortc_RTPUtils.h>
+#include <ortc/internal/ortc_StatsReport.h>
 #include <ortc/internal/ortc_ORTC.h>
 #include <ortc/internal/ortc_Tracing.h>
 #include <ortc/internal/platform.h>
@@ -74,6 +76,8 @@ namespace ortc
 
   namespace internal
   {
+    ZS_DECLARE_TYPEDEF_PTR(IStatsReportForInternal, UseStatsReport);
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -98,6 +102,19 @@ namespace ortc
       }
       return true;
     }
+
+    //-------------------------------------------------------------------------
+    static bool getRTCPSSRC(
+                            const RTCPPacket::Report *report,
+                            size_t offset,
+                            DWORD &outSSRC
+                            )
+    {
+      // reads a SSRC directly from the undecoded report contents
+      if (offset + sizeof(DWORD) > report->size()) return false;
+      outSSRC = RTPUtils::getBE32(&((report->ptr())[offset]));
+      return true;
+    }
     
 
     //-------------------------------------------------------------------------
@@ -112,9 +129,11 @@ namespace ortc
     void IRTPListenerForSettings::applyDefaults()
     {
       UseSettings::setUInt(ORTC_SETTING_RTP_LISTENER_MAX_RTP_PACKETS_IN_BUFFER, 100);
+      UseSettings::setUInt(ORTC_SETTING_RTP_LISTENER_MAX_RTP_BYTES_IN_BUFFER, 128*1024);
       UseSettings::setUInt(ORTC_SETTING_RTP_LISTENER_MAX_AGE_RTP_PACKETS_IN_SECONDS, 30);
 
       UseSettings::setUInt(ORTC_SETTING_RTP_LISTENER_MAX_RTCP_PACKETS_IN_BUFFER, 100);
+      UseSettings::setUInt(ORTC_SETTING_RTP_LISTENER_MAX_RTCP_BYTES_IN_BUFFER, 64*1024);
       UseSettings::setUInt(ORTC_SETTING_RTP_LISTENER_MAX_AGE_RTCP_PACKETS_IN_SECONDS, 30);
 
       UseSettings::setUInt(ORTC_SETTING_RTP_LISTENER_SSRC_TIMEOUT_IN_SECONDS, 60);
@@ -295,6 +314,7 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "receiver", ((bool)mReceiver.lock()));
 
       UseServicesHelper::debugAppend(resultEl, "kind", mKind.hasValue() ? IMediaStreamTrackTypes::toString(mKind) : (const char *)NULL);
+      UseServicesHelper::debugAppend(resultEl, "mux id interned", mMuxIDInterned);
       UseServicesHelper::debugAppend(resultEl, mFilledParameters.toDebug());
       UseServicesHelper::debugAppend(resultEl, mOriginalParameters.toDebug());
 
@@ -315,18 +335,119 @@ namespace ortc
     {
     }
 
+    //---------------------------------------------------------------------------
+    Time RTPListener::SSRCInfo::lastUsage() const
+    {
+      Time routed = Time(Time::duration(mLastRoutedUsage.load()));
+      return (routed > mLastUsage ? routed : mLastUsage);
+    }
+
     //---------------------------------------------------------------------------
     ElementPtr RTPListener::SSRCInfo::toDebug() const
     {
       ElementPtr resultEl = Element::create("ortc::RTPListener::SSRCInfo");
 
       UseServicesHelper::debugAppend(resultEl, "ssrc", mSSRC);
-      UseServicesHelper::debugAppend(resultEl, "last usage", mLastUsage);
+      UseServicesHelper::debugAppend(resultEl, "last usage", lastUsage());
       UseServicesHelper::debugAppend(resultEl, "mux id", mMuxID);
+      UseServicesHelper::debugAppend(resultEl, "mux id interned", mMuxIDInterned);
       UseServicesHelper::debugAppend(resultEl, mReceiverInfo ? mReceiverInfo->toDebug() : ElementPtr());
 
       return resultEl;
     }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark RTPListener::InternTable
+    #pragma mark
+
+    //---------------------------------------------------------------------------
+    DWORD RTPListener::InternTable::hash(const char *str, size_t length)
+    {
+      // FNV-1a
+      DWORD hash = 2166136261UL;
+      for (size_t index = 0; index < length; ++index) {
+        hash ^= static_cast<BYTE>(str[index]);
+        hash *= 16777619UL;
+      }
+      return hash;
+    }
+
+    //---------------------------------------------------------------------------
+    RTPListener::InternedID RTPListener::InternTable::find(
+                                                           const char *str,
+                                                           size_t length
+                                                           ) const
+    {
+      auto found = mHashes.find(hash(str, length));
+      if (found == mHashes.end()) return kInternedIDUnknown;
+
+      InternedID id = (*found).second;
+
+      const String &existing = mStrings[id - 1];
+      if ((existing.length() == length) &&
+          (0 == memcmp(existing.c_str(), str, length))) return id;
+
+      // hash collision (rare); fall back to scanning the interned strings
+      for (size_t index = 0; index < mStrings.size(); ++index) {
+        const String &value = mStrings[index];
+        if (value.length() != length) continue;
+        if (0 != memcmp(value.c_str(), str, length)) continue;
+        return static_cast<InternedID>(index + 1);
+      }
+
+      return kInternedIDUnknown;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark RTPListener::RoutingTable
+    #pragma mark
+
+    //---------------------------------------------------------------------------
+    const RTPListener::RoutingTable::Route *RTPListener::RoutingTable::findRoute(SSRCType ssrc) const
+    {
+      const ShardPtr &shard = mShards[shardIndex(ssrc)];
+      if (!shard) return NULL;
+
+      auto found = shard->mRoutes.find(ssrc);
+      if (found == shard->mRoutes.end()) return NULL;
+
+      return &((*found).second);
+    }
+
+    //---------------------------------------------------------------------------
+    RTPListener::InternedID RTPListener::RoutingTable::extractMuxIDInterned(const RTPPacket &rtpPacket) const
+    {
+      for (auto iter = mMuxIDExtensionIDs.begin(); iter != mMuxIDExtensionIDs.end(); ++iter) {
+        auto ext = rtpPacket.findHeaderExtension(*iter);
+        if (NULL == ext) continue;
+        if (NULL == ext->mData) continue;
+
+        // same string rules as RTPPacket::MidHeaderExtension but without
+        // copying the extension out of the packet
+        const char *str = reinterpret_cast<const char *>(ext->mData);
+        size_t maxLength = ext->mDataSizeInBytes;
+        if (maxLength > RTPPacket::MidHeaderExtension::kMaxMidLength) maxLength = RTPPacket::MidHeaderExtension::kMaxMidLength;
+
+        size_t length = 0;
+        while ((length < maxLength) && ('\0' != str[length])) {
+          ++length;
+        }
+        if (0 == length) continue;
+
+        if (!mInternTable) return kInternedIDUnknown;
+        return mInternTable->find(str, length);
+      }
+
+      return kInternedIDNone;
+    }
     
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -396,9 +517,13 @@ namespace ortc
       SharedRecursiveLock(SharedRecursiveLock::create()),
       mRTPTransport(transport),
       mMaxBufferedRTPPackets(SafeInt<decltype(mMaxBufferedRTPPackets)>(UseSettings::getUInt(ORTC_SETTING_RTP_LISTENER_MAX_RTP_PACKETS_IN_BUFFER))),
+      mMaxBufferedRTPBytes(SafeInt<decltype(mMaxBufferedRTPBytes)>(UseSettings::getUInt(ORTC_SETTING_RTP_LISTENER_MAX_RTP_BYTES_IN_BUFFER))),
       mMaxRTPPacketAge(UseSettings::getUInt(ORTC_SETTING_RTP_LISTENER_MAX_AGE_RTP_PACKETS_IN_SECONDS)),
       mMaxBufferedRTCPPackets(SafeInt<decltype(mMaxBufferedRTCPPackets)>(UseSettings::getUInt(ORTC_SETTING_RTP_LISTENER_MAX_RTCP_PACKETS_IN_BUFFER))),
+      mMaxBufferedRTCPBytes(SafeInt<decltype(mMaxBufferedRTCPBytes)>(UseSettings::getUInt(ORTC_SETTING_RTP_LISTENER_MAX_RTCP_BYTES_IN_BUFFER))),
       mMaxRTCPPacketAge(UseSettings::getUInt(ORTC_SETTING_RTP_LISTENER_MAX_AGE_RTCP_PACKETS_IN_SECONDS)),
+      mBufferedRTPPackets(mMaxBufferedRTPPackets, mMaxBufferedRTPBytes, mMaxRTPPacketAge),
+      mBufferedRTCPPackets(mMaxBufferedRTCPPackets, mMaxBufferedRTCPBytes, mMaxRTCPPacketAge),
       mReceivers(make_shared<ReceiverObjectMap>()),
       mSenders(make_shared<SenderObjectMap>()),
       mAmbigousPayloadMappingMinDifference(UseSettings::getUInt(ORTC_SETTING_RTP_LISTENER_ONLY_RESOLVE_AMBIGUOUS_PAYLOAD_MAPPING_IF_ACTIVITY_DIFFERS_IN_MILLISECONDS)),
@@ -588,6 +713,8 @@ namespace ortc
 
         registerHeaderExtensionReference(kAPIReference, headerExtension, extension.mID, extension.mEncrypt);
       }
+
+      publishRoutingTable();
     }
 
     //-------------------------------------------------------------------------
@@ -601,9 +728,37 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTPListener::PromiseWithStatsReportPtr RTPListener::getStats(const StatsTypeSet &stats) const
     {
-#define TODO 1
-#define TODO 2
-      return PromiseWithStatsReport::createRejected(IORTCForInternal::queueDelegate());
+      if (!stats.hasStatType(IStatsReportTypes::StatsType_InboundRTP)) {
+        return PromiseWithStatsReport::createRejected(IORTCForInternal::queueDelegate());
+      }
+
+      UseStatsReport::StatMap reportStats;
+
+      {
+        AutoRecursiveLock lock(*this);
+
+        if (isShutdown()) {
+          ZS_LOG_WARNING(Debug, log("cannot collect stats while shutdown"))
+          return PromiseWithStatsReport::createRejected(IORTCForInternal::queueDelegate());
+        }
+
+        // buffered packets not (yet) routable to any receiver
+        auto rtpReport = make_shared<PacketRingStats>();
+        rtpReport->mID = string(mID) + "_rtp_buffer";
+        rtpReport->mTimestamp = zsLib::now();
+        mBufferedRTPPackets.fillStats(*rtpReport);
+        reportStats[rtpReport->mID] = rtpReport;
+
+        auto rtcpReport = make_shared<PacketRingStats>();
+        rtcpReport->mID = string(mID) + "_rtcp_buffer";
+        rtcpReport->mTimestamp = rtpReport->mTimestamp;
+        mBufferedRTCPPackets.fillStats(*rtcpReport);
+        reportStats[rtcpReport->mID] = rtcpReport;
+      }
+
+      PromiseWithStatsReportPtr promise = PromiseWithStatsReport::create(IORTCForInternal::queueDelegate());
+      promise->resolve(UseStatsReport::create(reportStats));
+      return promise;
     }
 
     //-------------------------------------------------------------------------
@@ -645,18 +800,29 @@ namespace ortc
 
       // parse packet outside of a lock
       if (IICETypes::Component_RTCP == packetType) {
-        rtcpPacket = RTCPPacket::create(buffer, bufferLengthInBytes);
+        // only the report headers are validated here; the listener decodes
+        // BYE, SDES and SR reports (to maintain its SSRC tables) and resolves
+        // the report targets from the raw report contents; the remaining
+        // report types are decoded by whichever receiver or sender asks for
+        // them
+        rtcpPacket = RTCPPacket::createLazy(buffer, bufferLengthInBytes);
         if (!rtcpPacket) {
           ZS_LOG_WARNING(Trace, log("invalid rtcp packet received (thus dropping)"))
           return false;
         }
       } else {
-        rtpPacket = RTPPacket::create(buffer, bufferLengthInBytes);
+        // parsed in place; only copied if the packet needs to be kept
+        rtpPacket = RTPPacket::createView(buffer, bufferLengthInBytes);
 
         if (!rtpPacket) {
           ZS_LOG_WARNING(Trace, log("invalid RTP packet received (thus dropping)"))
           return false;
         }
+
+        // packets from already known SSRCs are routed from the published
+        // routing table without acquiring the lock
+        String muxID;
+        if (findMappingUsingRoutingTable(*rtpPacket, receiverInfo, muxID)) goto process_rtp;
       }
 
       {
@@ -670,37 +836,47 @@ namespace ortc
         if (IICETypes::Component_RTCP == packetType) {
           expireRTCPPackets();
 
+          receivers = mReceivers;
+          senders = mSenders;
+
+          // targets are resolved before BYEs remove their SSRC table entries
+          findRTCPTargets(*rtcpPacket, receivers, senders);
+
           processByes(*rtcpPacket);
           processSDESMid(*rtcpPacket);
           processSenderReports(*rtcpPacket);
 
-          EventWriteOrtcRtpListenerBufferIncomingPacket(__func__, mID, zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
+          publishRoutingTable();
 
-          mBufferedRTCPPackets.push_back(TimeRTCPPacketPair(zsLib::now(), rtcpPacket));
+          EventWriteOrtcRtpListenerBufferIncomingPacket(__func__, mID, zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
 
-          receivers = mReceivers;
-          senders = mSenders;
+          mBufferedRTCPPackets.push(zsLib::now(), 0, rtcpPacket);
           goto process_rtcp;
         }
 
         String muxID;
-        if (findMapping(*rtpPacket, receiverInfo, muxID)) goto process_rtp;
+        bool found = findMapping(*rtpPacket, receiverInfo, muxID);
+
+        publishRoutingTable();
+
+        if (found) goto process_rtp;
 
         if (isShuttingDown()) {
           ZS_LOG_WARNING(Debug, log("ignoring unhandled packet (during shutdown process)"))
           return false;
         }
 
-        expireRTPPackets();
-
         Time tick = zsLib::now();
 
         ASSERT(IICETypes::Component_RTP == viaComponent)
 
         EventWriteOrtcRtpListenerBufferIncomingPacket(__func__, mID, zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
 
-        // provide some modest buffering
-        mBufferedRTPPackets.push_back(TimeRTPPacketPair(tick, rtpPacket));
+        // provide some modest buffering (expires / evicts the oldest packets as needed)
+        rtpPacket->materialize();
+        if (!mBufferedRTPPackets.push(tick, rtpPacket->ssrc(), rtpPacket)) {
+          ZS_LOG_WARNING(Debug, log("rtp packet is too large to buffer") + ZS_PARAM("size", rtpPacket->size()) + ZS_PARAM("max bytes", mMaxBufferedRTPBytes))
+        }
 
         String rid = extractRID(*rtpPacket);
 
@@ -718,7 +894,10 @@ namespace ortc
         }
 
         ZS_LOG_TRACE(log("forwarding RTP packet to receiver") + ZS_PARAM("receiver id", receiver->getID()) + ZS_PARAM("ssrc", rtpPacket->ssrc()))
-        EventWriteOrtcRtpListenerForwardIncomingPacket(__func__, mID, receiver->getID(), zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(rtpPacket->buffer()->SizeInBytes()), rtpPacket->buffer()->BytePtr());
+        EventWriteOrtcRtpListenerForwardIncomingPacket(__func__, mID, receiver->getID(), zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(rtpPacket->size()), rtpPacket->ptr());
+
+        // receiver is allowed to hold onto the packet past this call
+        rtpPacket->materialize();
         return receiver->handlePacket(viaComponent, rtpPacket);
       }
 
@@ -736,7 +915,7 @@ namespace ortc
           }
 
           ZS_LOG_TRACE(log("forwarding RTCP packet to receiver") + ZS_PARAM("receiver id", receiverID))
-          EventWriteOrtcRtpListenerForwardIncomingPacket(__func__, mID, receiver->getID(), zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(rtcpPacket->buffer()->SizeInBytes()), rtcpPacket->buffer()->BytePtr());
+          EventWriteOrtcRtpListenerForwardIncomingPacket(__func__, mID, receiver->getID(), zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(rtcpPacket->size()), rtcpPacket->ptr());
           auto success = receiver->handlePacket(viaComponent, rtcpPacket);
           result = result || success;
         }
@@ -751,7 +930,7 @@ namespace ortc
           }
 
           ZS_LOG_TRACE(log("forwarding RTCP packet to sender") + ZS_PARAM("sender id", senderID))
-          EventWriteOrtcRtpListenerForwardIncomingPacket(__func__, mID, sender->getID(), zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(rtcpPacket->buffer()->SizeInBytes()), rtcpPacket->buffer()->BytePtr());
+          EventWriteOrtcRtpListenerForwardIncomingPacket(__func__, mID, sender->getID(), zsLib::to_underlying(viaComponent), zsLib::to_underlying(packetType), SafeInt<unsigned int>(rtcpPacket->size()), rtcpPacket->ptr());
           auto success = sender->handlePacket(viaComponent, rtcpPacket);
           result = result || success;
         }
@@ -883,14 +1062,13 @@ namespace ortc
         expireRTCPPackets();
 
         if (outPacketList) {
-          for (auto iter = mBufferedRTCPPackets.begin(); iter != mBufferedRTCPPackets.end(); ++iter) {
-            auto buffer = (*iter).second;
-            outPacketList->push_back(buffer);
-          }
+          mBufferedRTCPPackets.getPackets(*outPacketList);
         }
 
         reattemptDelivery();
       }
+
+      publishRoutingTable();
     }
 
     //-------------------------------------------------------------------------
@@ -947,6 +1125,7 @@ namespace ortc
 
         EventWriteOrtcRtpListenerSsrcTableEntryRemoved(__func__, mID, ((bool)ssrcInfo->mReceiverInfo) ? ssrcInfo->mReceiverInfo->mReceiverID : 0, ssrcInfo->mSSRC, zsLib::timeSinceEpoch<Seconds>(ssrcInfo->mLastUsage).count(), ssrcInfo->mMuxID, "receiver removed");
         mSSRCTable.erase(current);
+        markRouteDirty(ssrc);
       }
 
       // purge from mux id table
@@ -966,6 +1145,8 @@ namespace ortc
       }
 
       unregisterAllHeaderExtensionReferences(receiverID);
+
+      publishRoutingTable();
     }
 
     //-------------------------------------------------------------------------
@@ -975,11 +1156,7 @@ namespace ortc
 
       expireRTCPPackets();
 
-      for (auto iter = mBufferedRTCPPackets.begin(); iter != mBufferedRTCPPackets.end(); ++iter)
-      {
-        auto buffer = (*iter).second;
-        outPacketList.push_back(buffer);
-      }
+      mBufferedRTCPPackets.getPackets(outPacketList);
     }
 
     //-------------------------------------------------------------------------
@@ -1029,13 +1206,11 @@ namespace ortc
       (*senders)[inSender->getID()] = inSender;
       mSenders = senders;
 
+      setSenderSSRCs(inSender->getID(), &inParams);
+
       expireRTCPPackets();
 
-      for (auto iter = mBufferedRTCPPackets.begin(); iter != mBufferedRTCPPackets.end(); ++iter)
-      {
-        auto buffer = (*iter).second;
-        outPacketList.push_back(buffer);
-      }
+      mBufferedRTCPPackets.getPackets(outPacketList);
     }
 
     //-------------------------------------------------------------------------
@@ -1070,6 +1245,8 @@ namespace ortc
 
           mSenders = senders;
         }
+
+        setSenderSSRCs(senderID, NULL);
       }
       
     }
@@ -1090,6 +1267,7 @@ namespace ortc
 
       AutoRecursiveLock lock(*this);
       step();
+      publishRoutingTable();
     }
 
     //-------------------------------------------------------------------------
@@ -1127,15 +1305,17 @@ namespace ortc
 
           auto &ssrcInfo = (*current).second;
 
-          const Time &lastReceived = ssrcInfo->mLastUsage;
+          Time lastReceived = ssrcInfo->lastUsage();
 
           if (!(adjustedTick > lastReceived)) continue;
 
           ZS_LOG_TRACE(log("expiring SSRC mapping") + ssrcInfo->toDebug() + ZS_PARAM("adjusted tick", adjustedTick))
-          EventWriteOrtcRtpListenerSsrcTableEntryRemoved(__func__, mID, ((bool)ssrcInfo->mReceiverInfo) ? ssrcInfo->mReceiverInfo->mReceiverID : 0, ssrcInfo->mSSRC, zsLib::timeSinceEpoch<Seconds>(ssrcInfo->mLastUsage).count(), ssrcInfo->mMuxID, "expired");
+          EventWriteOrtcRtpListenerSsrcTableEntryRemoved(__func__, mID, ((bool)ssrcInfo->mReceiverInfo) ? ssrcInfo->mReceiverInfo->mReceiverID : 0, ssrcInfo->mSSRC, zsLib::timeSinceEpoch<Seconds>(lastReceived).count(), ssrcInfo->mMuxID, "expired");
+          markRouteDirty((*current).first);
           mSSRCTable.erase(current);
         }
 
+        publishRoutingTable();
         return;
       }
 
@@ -1184,7 +1364,7 @@ namespace ortc
     {
       ZS_LOG_TRACE(log("forwarding previously buffered RTP packet to receiver") + ZS_PARAM("receiver id", receiver->getID()) + ZS_PARAM("via", IICETypes::toString(viaComponent)) + ZS_PARAM("ssrc", packet->ssrc()))
 
-      EventWriteOrtcRtpListenerForwardIncomingPacket(__func__, mID, receiver->getID(), zsLib::to_underlying(viaComponent), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpListenerForwardIncomingPacket(__func__, mID, receiver->getID(), zsLib::to_underlying(viaComponent), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->size()), packet->ptr());
       receiver->handlePacket(viaComponent, packet);
     }
 
@@ -1306,27 +1486,31 @@ namespace ortc
 
       size_t previousSize = 0;
 
+      std::vector<BufferedRTPPacketRing::SSRCType> ssrcs;
+
       do
       {
         previousSize = mBufferedRTPPackets.size();
-        for (auto iter_doNotUse = mBufferedRTPPackets.begin(); iter_doNotUse != mBufferedRTPPackets.end();) {
-          auto current = iter_doNotUse;
-          ++iter_doNotUse;
 
-          RTPPacketPtr packet = (*current).second;
+        mBufferedRTPPackets.getSSRCs(ssrcs);
 
-          ReceiverInfoPtr receiverInfo;
-          String muxID;
-          if (!findMapping(*packet, receiverInfo, muxID)) continue;
+        for (auto iterSSRC = ssrcs.begin(); iterSSRC != ssrcs.end(); ++iterSSRC) {
+          for (auto index = mBufferedRTPPackets.first(*iterSSRC); BufferedRTPPacketRing::kNone != index; index = mBufferedRTPPackets.next(index)) {
+            RTPPacketPtr packet = mBufferedRTPPackets.packet(index);
 
-          auto receiver = receiverInfo->mReceiver.lock();
+            ReceiverInfoPtr receiverInfo;
+            String muxID;
+            if (!findMapping(*packet, receiverInfo, muxID)) continue;
 
-          if (receiver) {
-            ZS_LOG_TRACE(log("will attempt to deliver buffered RTP packet") + ZS_PARAM("receiver", receiver->getID()) + ZS_PARAM("ssrc", packet->ssrc()))
-            IRTPListenerAsyncDelegateProxy::create(mThisWeak.lock())->onDeliverPacket(IICETypes::Component_RTP, receiver, packet);
-          }
+            auto receiver = receiverInfo->mReceiver.lock();
+
+            if (receiver) {
+              ZS_LOG_TRACE(log("will attempt to deliver buffered RTP packet") + ZS_PARAM("receiver", receiver->getID()) + ZS_PARAM("ssrc", packet->ssrc()))
+              IRTPListenerAsyncDelegateProxy::create(mThisWeak.lock())->onDeliverPacket(IICETypes::Component_RTP, receiver, packet);
+            }
 
-          mBufferedRTPPackets.erase(current);
+            mBufferedRTPPackets.remove(index);
+          }
         }
 
       // NOTE: need to repetitively attempt to deliver packets as it's possible
@@ -1373,9 +1557,15 @@ namespace ortc
 
       mReceivers = make_shared<ReceiverObjectMap>();
       mSenders = make_shared<SenderObjectMap>();
+      mSenderSSRCs.clear();
 
       mSSRCTable.clear();
       mMuxIDTable.clear();
+      mInternTable.reset();
+
+      mRoutingTableDirty = false;
+      mRoutingTableDirtySSRCs.clear();
+      std::atomic_store(&mRoutingTable, RoutingTablePtr());
       mUnhandledEvents.clear();
 
       if (mSSRCTableTimer) {
@@ -1431,53 +1621,27 @@ namespace ortc
     //-------------------------------------------------------------------------
     void RTPListener::expireRTPPackets()
     {
-      auto tick = zsLib::now();
+      auto before = mBufferedRTPPackets.counters().mDroppedExpired;
 
-      while (mBufferedRTPPackets.size() > 0) {
-        auto &info = mBufferedRTPPackets.front();
-        auto &packetTime = info.first;
-        auto &packet = info.second;
-        (void)packet;
+      mBufferedRTPPackets.expire(zsLib::now());
 
-        {
-          if (mBufferedRTPPackets.size() > mMaxBufferedRTPPackets) goto expire_packet;
-          if (packetTime + mMaxRTPPacketAge < tick) goto expire_packet;
-          break;
-        }
+      auto expired = mBufferedRTPPackets.counters().mDroppedExpired - before;
+      if (0 == expired) return;
 
-      expire_packet:
-        {
-          EventWriteOrtcRtpListenerDisposeBufferedIncomingPacket(__func__, mID, zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
-          ZS_LOG_TRACE(log("expiring buffered rtp packet") + ZS_PARAM("tick", tick) + ZS_PARAM("packet time (s)", packetTime) + ZS_PARAM("total", mBufferedRTPPackets.size()))
-          mBufferedRTPPackets.pop_front();
-        }
-      }
+      ZS_LOG_TRACE(log("expired buffered rtp packets") + ZS_PARAM("expired", expired) + ZS_PARAM("total", mBufferedRTPPackets.size()))
     }
     
     //-------------------------------------------------------------------------
     void RTPListener::expireRTCPPackets()
     {
-      auto tick = zsLib::now();
+      auto before = mBufferedRTCPPackets.counters().mDroppedExpired;
 
-      while (mBufferedRTCPPackets.size() > 0) {
-        auto &info = mBufferedRTCPPackets.front();
-        auto &packetTime = info.first;
-        auto &packet = info.second;
-        (void)packet;
+      mBufferedRTCPPackets.expire(zsLib::now());
 
-        {
-          if (mBufferedRTCPPackets.size() > mMaxBufferedRTCPPackets) goto expire_packet;
-          if (packetTime + mMaxRTCPPacketAge < tick) goto expire_packet;
-          break;
-        }
+      auto expired = mBufferedRTCPPackets.counters().mDroppedExpired - before;
+      if (0 == expired) return;
 
-      expire_packet:
-        {
-          EventWriteOrtcRtpListenerDisposeBufferedIncomingPacket(__func__, mID, zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
-          ZS_LOG_TRACE(log("expiring buffered rtcp packet") + ZS_PARAM("tick", tick) + ZS_PARAM("packet time (s)", packetTime) + ZS_PARAM("total", mBufferedRTCPPackets.size()))
-          mBufferedRTCPPackets.pop_front();
-        }
-      }
+      ZS_LOG_TRACE(log("expired buffered rtcp packets") + ZS_PARAM("expired", expired) + ZS_PARAM("total", mBufferedRTCPPackets.size()))
     }
 
     //-------------------------------------------------------------------------
@@ -1501,6 +1665,7 @@ namespace ortc
         extension.mEncrypted = encrytped;
         extension.mReferences[objectID] = true;
         mRegisteredExtensions[localID] = extension;
+        mRoutingTableDirty = true;
 
         EventWriteOrtcRtpListenerRegisterHeaderExtension(__func__, mID, objectID, IRTPTypes::toString(extension.mHeaderExtensionURI), extension.mLocalID, extension.mEncrypted, extension.mReferences.size());
 
@@ -1545,6 +1710,7 @@ namespace ortc
         if (extension.mReferences.size() > 0) continue;
 
         mRegisteredExtensions.erase(current);
+        mRoutingTableDirty = true;
       }
     }
 
@@ -1555,14 +1721,18 @@ namespace ortc
                                   String &outMuxID
                                   )
     {
+      publishRoutingTable();  // include SSRCs confirmed since the last publish
+
+      if (findMappingUsingRoutingTable(rtpPacket, outReceiverInfo, outMuxID)) return true;
+
       outMuxID = extractMuxID(rtpPacket, outReceiverInfo);
 
-      EventWriteOrtcRtpListenerFindMapping(__func__, mID, outMuxID, SafeInt<unsigned int>(rtpPacket.buffer()->SizeInBytes()), rtpPacket.buffer()->BytePtr());
+      EventWriteOrtcRtpListenerFindMapping(__func__, mID, outMuxID, SafeInt<unsigned int>(rtpPacket.size()), rtpPacket.ptr());
 
       {
         if (outReceiverInfo) goto fill_mux_id;
 
-        if (findMappingUsingMuxID(outMuxID, rtpPacket, outReceiverInfo)) return true;
+        if (findMappingUsingMuxID(outMuxID, rtpPacket, outReceiverInfo)) goto mapped;
 
         if (findMappingUsingSSRCInEncodingParams(outMuxID, rtpPacket, outReceiverInfo)) goto fill_mux_id;
 
@@ -1580,6 +1750,54 @@ namespace ortc
         }
       }
 
+    mapped:
+      {
+        // once the SSRC entry agrees with its receiver's mux ID, subsequent
+        // packets for this SSRC are routed by findMappingUsingRoutingTable
+        auto found = mSSRCTable.find(rtpPacket.ssrc());
+        if (found != mSSRCTable.end()) {
+          auto &ssrcInfo = (*found).second;
+          if ((ssrcInfo->mReceiverInfo == outReceiverInfo) &&
+              (ssrcInfo->mMuxIDInterned != outReceiverInfo->mMuxIDInterned) &&
+              ((!outReceiverInfo->mFilledParameters.mMuxID.hasData()) ||
+               (outReceiverInfo->mFilledParameters.mMuxID == ssrcInfo->mMuxID))) {
+            ssrcInfo->mMuxIDInterned = outReceiverInfo->mMuxIDInterned;
+            markRouteDirty(rtpPacket.ssrc());
+          }
+        }
+      }
+
+      return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTPListener::findMappingUsingRoutingTable(
+                                                   const RTPPacket &rtpPacket,
+                                                   ReceiverInfoPtr &outReceiverInfo,
+                                                   String &outMuxID
+                                                   ) const
+    {
+      // NOTE: called with or without the lock held
+      RoutingTablePtr table = std::atomic_load(&mRoutingTable);
+      if (!table) return false;
+
+      const RoutingTable::Route *found = table->findRoute(rtpPacket.ssrc());
+      if (NULL == found) return false;
+
+      const RoutingTable::Route &route = *found;
+
+      InternedID muxID = table->extractMuxIDInterned(rtpPacket);
+      if ((kInternedIDNone != muxID) &&
+          (muxID != route.mMuxIDInterned)) return false;
+
+      Time tick = zsLib::now();
+      route.mSSRCInfo->mLastRoutedUsage.store(tick.time_since_epoch().count());
+
+      outReceiverInfo = route.mReceiverInfo;
+      outMuxID = route.mMuxID;
+
+      EventWriteOrtcRtpListenerFindMapping(__func__, mID, outMuxID, SafeInt<unsigned int>(rtpPacket.size()), rtpPacket.ptr());
+      EventWriteOrtcRtpListenerSsrcTableEntryUpdated(__func__, mID, route.mReceiverInfo->mReceiverID, rtpPacket.ssrc(), zsLib::timeSinceEpoch<Seconds>(tick).count(), outMuxID);
       return true;
     }
 
@@ -1742,7 +1960,7 @@ namespace ortc
                 auto tick = zsLib::now();
 
                 auto diffLast = tick - lastMatchUsageTime;
-                auto diffCurrent = tick - ssrcInfo->mLastUsage;
+                auto diffCurrent = tick - ssrcInfo->lastUsage();
 
                 if ((diffLast < mAmbigousPayloadMappingMinDifference) &&
                     (diffCurrent < mAmbigousPayloadMappingMinDifference)) {
@@ -1750,21 +1968,21 @@ namespace ortc
                   return false;
                 }
 
-                if (ssrcInfo->mLastUsage < lastMatchUsageTime) {
+                if (ssrcInfo->lastUsage() < lastMatchUsageTime) {
                   ZS_LOG_WARNING(Trace, log("possible ambiguity in match (but going with previous more recent usage)") + ZS_PARAM("match time", lastMatchUsageTime) + ssrcInfo->toDebug())
                   continue;
                 }
 
                 ZS_LOG_WARNING(Trace, log("possible ambiguity in match (going with this as more recent in usage)") + ZS_PARAM("match time", lastMatchUsageTime) + ssrcInfo->toDebug() + ZS_PARAM("using", receiverInfo->toDebug()) + ZS_PARAM("previous found", outReceiverInfo->toDebug()))
 
-                lastMatchUsageTime = ssrcInfo->mLastUsage;
+                lastMatchUsageTime = ssrcInfo->lastUsage();
                 outReceiverInfo = receiverInfo;
                 foundEncoding = matchEncoding;
                 foundDecodedCodec = decodedCodec;
               } else {
                 ZS_LOG_TRACE(log("found likely match") + receiverInfo->toDebug() + ssrcInfo->toDebug())
 
-                lastMatchUsageTime = ssrcInfo->mLastUsage;
+                lastMatchUsageTime = ssrcInfo->lastUsage();
                 outReceiverInfo = receiverInfo;
                 foundEncoding = matchEncoding;
                 foundDecodedCodec = decodedCodec;
@@ -1875,14 +2093,14 @@ namespace ortc
                                      ReceiverInfoPtr &ioReceiverInfo
                                      )
     {
-      for (auto ext = rtpPacket.firstHeaderExtension(); NULL != ext; ext = ext->mNext) {
-        LocalID localID = static_cast<LocalID>(ext->mID);
-        auto found = mRegisteredExtensions.find(localID);
-        if (found == mRegisteredExtensions.end()) continue; // header extension is not understood
-
-        RegisteredHeaderExtension &headerInfo = (*found).second;
+      for (auto iter = mRegisteredExtensions.begin(); iter != mRegisteredExtensions.end(); ++iter) {
+        RegisteredHeaderExtension &headerInfo = (*iter).second;
 
         if (IRTPTypes::HeaderExtensionURI_MuxID != headerInfo.mHeaderExtensionURI) continue;
+        if (headerInfo.mLocalID > 0xFF) continue;
+
+        auto ext = rtpPacket.findHeaderExtension(static_cast<BYTE>(headerInfo.mLocalID));
+        if (NULL == ext) continue;
 
         RTPPacket::MidHeaderExtension mid(*ext);
 
@@ -1902,14 +2120,14 @@ namespace ortc
     //-------------------------------------------------------------------------
     String RTPListener::extractRID(const RTPPacket &rtpPacket)
     {
-      for (auto ext = rtpPacket.firstHeaderExtension(); NULL != ext; ext = ext->mNext) {
-        LocalID localID = static_cast<LocalID>(ext->mID);
-        auto found = mRegisteredExtensions.find(localID);
-        if (found == mRegisteredExtensions.end()) continue; // header extension is not understood
-
-        RegisteredHeaderExtension &headerInfo = (*found).second;
+      for (auto iter = mRegisteredExtensions.begin(); iter != mRegisteredExtensions.end(); ++iter) {
+        RegisteredHeaderExtension &headerInfo = (*iter).second;
 
         if (IRTPTypes::HeaderExtensionURI_RID != headerInfo.mHeaderExtensionURI) continue;
+        if (headerInfo.mLocalID > 0xFF) continue;
+
+        auto ext = rtpPacket.findHeaderExtension(static_cast<BYTE>(headerInfo.mLocalID));
+        if (NULL == ext) continue;
 
         RTPPacket::RidHeaderExtension rid(*ext);
 
@@ -1922,6 +2140,42 @@ namespace ortc
       return String();
     }
 
+    //-------------------------------------------------------------------------
+    RTPListener::InternedID RTPListener::intern(const String &str)
+    {
+      if (!str.hasData()) return kInternedIDNone;
+
+      if (mInternTable) {
+        InternedID existing = mInternTable->find(str.c_str(), str.length());
+        if (kInternedIDUnknown != existing) return existing;
+      }
+
+      // only mux IDs belonging to receivers are interned thus the table is
+      // bounded by the receivers ever attached (not by incoming packets)
+      size_t total = (mInternTable ? mInternTable->mStrings.size() : 0);
+      if (total + 1 >= kInternedIDUnknown) {
+        ZS_LOG_WARNING(Debug, log("too many interned strings") + ZS_PARAM("string", str))
+        return kInternedIDUnknown;
+      }
+
+      // published routing tables may still reference the existing table
+      InternTablePtr table(mInternTable ? make_shared<InternTable>(*mInternTable) : make_shared<InternTable>());
+
+      table->mStrings.push_back(str);
+      InternedID id = static_cast<InternedID>(table->mStrings.size());
+
+      DWORD hash = InternTable::hash(str.c_str(), str.length());
+      if (table->mHashes.end() == table->mHashes.find(hash)) {
+        table->mHashes[hash] = id;
+      }
+
+      mInternTable = table;
+      mRoutingTableDirty = true;
+
+      ZS_LOG_TRACE(log("interned string") + ZS_PARAM("string", str) + ZS_PARAM("id", id))
+      return id;
+    }
+
     //-------------------------------------------------------------------------
     bool RTPListener::fillMuxIDParameters(
                                           const String &muxID,
@@ -1953,6 +2207,8 @@ namespace ortc
     //-------------------------------------------------------------------------
     void RTPListener::setReceiverInfo(ReceiverInfoPtr receiverInfo)
     {
+      receiverInfo->mMuxIDInterned = intern(receiverInfo->mFilledParameters.mMuxID);
+
       ReceiverObjectMapPtr receivers(make_shared<ReceiverObjectMap>(*mReceivers));
 
       // replace or add to replacement list
@@ -1965,6 +2221,7 @@ namespace ortc
 
         // replace existing entry in receiver table
         existingInfo->mReceiverInfo = receiverInfo;
+        markRouteDirty((*iter).first);
       }
 
       for (auto iter_doNotUse = mRegisteredSSRCs.begin(); iter_doNotUse != mRegisteredSSRCs.end(); ) {
@@ -2040,6 +2297,7 @@ namespace ortc
               ZS_LOG_TRACE(log("removing ssrc table entry due to BYE") + ZS_PARAM("ssrc", byeSSRC) + ssrcInfo->toDebug())
               EventWriteOrtcRtpListenerSsrcTableEntryRemoved(__func__, mID, ((bool)ssrcInfo->mReceiverInfo) ? ssrcInfo->mReceiverInfo->mReceiverID : 0, ssrcInfo->mSSRC, zsLib::timeSinceEpoch<Seconds>(ssrcInfo->mLastUsage).count(), ssrcInfo->mMuxID, "bye");
               mSSRCTable.erase(found);
+              markRouteDirty(byeSSRC);
             }
           }
 
@@ -2163,6 +2421,226 @@ namespace ortc
       }
     }
 
+    //-------------------------------------------------------------------------
+    void RTPListener::findRTCPTargets(
+                                      const RTCPPacket &rtcpPacket,
+                                      ReceiverObjectMapPtr &ioReceivers,
+                                      SenderObjectMapPtr &ioSenders
+                                      )
+    {
+      // Reports are delivered only to the receivers / senders owning the
+      // media SSRCs the reports are about. Reports without any media SSRC
+      // (or with an SSRC that has no known owner yet) are still broadcast
+      // to all receivers and/or senders.
+      //
+      // The SSRCs are read from the indexed report contents rather than the
+      // decoded reports so the lazily parsed packet is not fully decoded
+      // while the listener lock is held. Truncated reports are broadcast
+      // (the owner decoding the report decides if it is usable).
+
+      static const size_t kSenderInfoSize = sizeof(DWORD) * 5;
+      static const size_t kReportBlockSize = sizeof(DWORD) * 6;
+
+      bool broadcastReceivers = false;
+      bool broadcastSenders = false;
+
+      ReceiverObjectMap receivers;
+      SenderObjectMap senders;
+
+      for (auto report = rtcpPacket.firstIndexed(); NULL != report; report = report->next()) {
+        size_t count = static_cast<size_t>(report->reportSpecific());
+        DWORD ssrc = 0;
+
+        switch (report->pt()) {
+          case RTCPPacket::SenderReport::kPayloadType:                    {
+            if ((!getRTCPSSRC(report, 0, ssrc)) ||
+                (!addRTCPReceiverTarget(ssrc, receivers))) broadcastReceivers = true;
+
+            for (size_t index = 0; index < count; ++index) {
+              if ((!getRTCPSSRC(report, sizeof(DWORD) + kSenderInfoSize + (index * kReportBlockSize), ssrc)) ||
+                  (!addRTCPSenderTarget(ssrc, senders))) broadcastSenders = true;
+            }
+            break;
+          }
+          case RTCPPacket::ReceiverReport::kPayloadType:                  {
+            if (0 == count) broadcastSenders = true;
+
+            for (size_t index = 0; index < count; ++index) {
+              if ((!getRTCPSSRC(report, sizeof(DWORD) + (index * kReportBlockSize), ssrc)) ||
+                  (!addRTCPSenderTarget(ssrc, senders))) broadcastSenders = true;
+            }
+            break;
+          }
+          case RTCPPacket::SDES::kPayloadType:                            {
+            // SDES chunks usually describe the reporting endpoint itself thus
+            // an unknown chunk SSRC does not cause a broadcast
+            const BYTE *contents = report->ptr();
+            size_t size = report->size();
+            size_t offset = 0;
+
+            for (size_t index = 0; index < count; ++index) {
+              if (!getRTCPSSRC(report, offset, ssrc)) break;
+              addRTCPReceiverTarget(ssrc, receivers);
+
+              // skip the SDES items up to and including the null item and
+              // then the padding to the next 32 bit boundary
+              offset += sizeof(DWORD);
+              while ((offset < size) && (0 != contents[offset])) {
+                if (offset + 1 >= size) {
+                  offset = size;
+                  break;
+                }
+                offset += 2 + static_cast<size_t>(contents[offset+1]);
+              }
+              offset = ((offset + 1) + (sizeof(DWORD) - 1)) & ~(sizeof(DWORD) - 1);
+            }
+            break;
+          }
+          case RTCPPacket::Bye::kPayloadType:                             {
+            for (size_t index = 0; index < count; ++index) {
+              if ((!getRTCPSSRC(report, index * sizeof(DWORD), ssrc)) ||
+                  (!addRTCPReceiverTarget(ssrc, receivers))) broadcastReceivers = true;
+            }
+            break;
+          }
+          case RTCPPacket::TransportLayerFeedbackMessage::kPayloadType:
+          case RTCPPacket::PayloadSpecificFeedbackMessage::kPayloadType:  {
+            // FIR, TSTR, TSTN, VBCM and REMB leave the media source as zero
+            // and apply to more than one stream (thus are broadcast to all
+            // senders)
+            if ((!getRTCPSSRC(report, sizeof(DWORD), ssrc)) ||
+                (!addRTCPSenderTarget(ssrc, senders))) broadcastSenders = true;
+            break;
+          }
+          case RTCPPacket::XR::kPayloadType:                              {
+            const BYTE *contents = report->ptr();
+            size_t size = report->size();
+            size_t offset = sizeof(DWORD);
+
+            while (offset < size) {
+              if (offset + sizeof(DWORD) > size) {
+                broadcastReceivers = broadcastSenders = true;
+                break;
+              }
+
+              BYTE blockType = contents[offset];
+              size_t blockSize = sizeof(DWORD) + (static_cast<size_t>(RTPUtils::getBE16(&(contents[offset+2]))) * sizeof(DWORD));
+
+              switch (blockType) {
+                case RTCPPacket::XR::LossRLEReportBlock::kBlockType:
+                case RTCPPacket::XR::DuplicateRLEReportBlock::kBlockType:
+                case RTCPPacket::XR::PacketReceiptTimesReportBlock::kBlockType:
+                case RTCPPacket::XR::StatisticsSummaryReportBlock::kBlockType:
+                case RTCPPacket::XR::VoIPMetricsReportBlock::kBlockType:            {
+                  if ((blockSize < (sizeof(DWORD) * 2)) ||
+                      (!getRTCPSSRC(report, offset + sizeof(DWORD), ssrc)) ||
+                      (!addRTCPSenderTarget(ssrc, senders))) broadcastSenders = true;
+                  break;
+                }
+                case RTCPPacket::XR::ReceiverReferenceTimeReportBlock::kBlockType:  broadcastSenders = true; break;
+                case RTCPPacket::XR::DLRRReportBlock::kBlockType:                   broadcastReceivers = true; break;
+                default:                                                            {
+                  broadcastReceivers = true;
+                  broadcastSenders = true;
+                  break;
+                }
+              }
+
+              offset += blockSize;
+            }
+            break;
+          }
+          default:                                                        {
+            ZS_LOG_INSANE(log("app / unknown rtcp report found (thus broadcasting)") + ZS_PARAM("pt", report->ptToString()) + ZS_PARAM("pt (number)", report->pt()))
+            return;
+          }
+        }
+      }
+
+      if (!broadcastReceivers) {
+        ioReceivers = make_shared<ReceiverObjectMap>(std::move(receivers));
+      }
+      if (!broadcastSenders) {
+        ioSenders = make_shared<SenderObjectMap>(std::move(senders));
+      }
+
+      ZS_LOG_INSANE(log("rtcp targets found") + ZS_PARAM("broadcast receivers", broadcastReceivers) + ZS_PARAM("broadcast senders", broadcastSenders) + ZS_PARAM("receivers", ioReceivers->size()) + ZS_PARAM("senders", ioSenders->size()))
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTPListener::addRTCPReceiverTarget(
+                                            SSRCType ssrc,
+                                            ReceiverObjectMap &ioReceivers
+                                            )
+    {
+      auto found = mSSRCTable.find(ssrc);
+      if (found == mSSRCTable.end()) return false;
+
+      auto &ssrcInfo = (*found).second;
+      if (!ssrcInfo->mReceiverInfo) return false;
+
+      ReceiverID receiverID = ssrcInfo->mReceiverInfo->mReceiverID;
+
+      auto foundReceiver = mReceivers->find(receiverID);
+      if (foundReceiver == mReceivers->end()) return false;
+
+      ioReceivers[receiverID] = (*foundReceiver).second;
+      return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTPListener::addRTCPSenderTarget(
+                                          SSRCType ssrc,
+                                          SenderObjectMap &ioSenders
+                                          )
+    {
+      auto found = mSenderSSRCs.find(ssrc);
+      if (found == mSenderSSRCs.end()) return false;
+
+      SenderID senderID = (*found).second;
+
+      auto foundSender = mSenders->find(senderID);
+      if (foundSender == mSenders->end()) return false;
+
+      ioSenders[senderID] = (*foundSender).second;
+      return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPListener::setSenderSSRCs(
+                                     SenderID senderID,
+                                     const Parameters *params
+                                     )
+    {
+      for (auto iter_doNotUse = mSenderSSRCs.begin(); iter_doNotUse != mSenderSSRCs.end(); ) {
+        auto current = iter_doNotUse;
+        ++iter_doNotUse;
+
+        if (senderID != (*current).second) continue;
+        mSenderSSRCs.erase(current);
+      }
+
+      if (!params) return;
+
+      // encodings without an SSRC get one assigned by the sender thus any
+      // reports about those streams remain broadcast to all senders
+      for (auto iter = params->mEncodings.begin(); iter != params->mEncodings.end(); ++iter) {
+        auto &encoding = (*iter);
+
+        if (encoding.mSSRC.hasValue()) {
+          mSenderSSRCs[encoding.mSSRC.value()] = senderID;
+        }
+        if ((encoding.mRTX.hasValue()) &&
+            (encoding.mRTX.value().mSSRC.hasValue())) {
+          mSenderSSRCs[encoding.mRTX.value().mSSRC.value()] = senderID;
+        }
+        if ((encoding.mFEC.hasValue()) &&
+            (encoding.mFEC.value().mSSRC.hasValue())) {
+          mSenderSSRCs[encoding.mFEC.value().mSSRC.value()] = senderID;
+        }
+      }
+    }
+
     //-------------------------------------------------------------------------
     void RTPListener::handleDeltaChanges(
                                          ReceiverInfoPtr replacementInfo,
@@ -2260,6 +2738,7 @@ namespace ortc
         } else if (ioReceiverInfo) {
           ioMuxID = ssrcInfo->mMuxID = ioReceiverInfo->mFilledParameters.mMuxID;
         }
+        ssrcInfo->mMuxIDInterned = kInternedIDUnknown;   // confirmed by findMapping
         ssrcInfo->mReceiverInfo = ioReceiverInfo;
         EventWriteOrtcRtpListenerSsrcTableEntryAdded(__func__, mID, ((bool)ioReceiverInfo) ? ioReceiverInfo->mReceiverID : 0, ssrcInfo->mSSRC, zsLib::timeSinceEpoch<Seconds>(ssrcInfo->mLastUsage).count(), ssrcInfo->mMuxID);
         mSSRCTable[ssrc] = ssrcInfo;
@@ -2270,17 +2749,26 @@ namespace ortc
       ssrcInfo->mLastUsage = zsLib::now();
 
       if (ioReceiverInfo) {
-        ssrcInfo->mReceiverInfo = ioReceiverInfo;
+        if (ioReceiverInfo != ssrcInfo->mReceiverInfo) {
+          ssrcInfo->mReceiverInfo = ioReceiverInfo;
+          markRouteDirty(ssrc);
+        }
       } else {
         ioReceiverInfo = ssrcInfo->mReceiverInfo;
       }
 
       if (ioMuxID.hasData()) {
-        if (ioMuxID != ssrcInfo->mMuxID) ssrcInfo->mMuxID = ioMuxID;
+        if (ioMuxID != ssrcInfo->mMuxID) {
+          ssrcInfo->mMuxID = ioMuxID;
+          ssrcInfo->mMuxIDInterned = kInternedIDUnknown;
+          markRouteDirty(ssrc);
+        }
       } else if (ssrcInfo->mReceiverInfo) {
         if (ssrcInfo->mReceiverInfo->mFilledParameters.mMuxID.hasData()) {
           if (ssrcInfo->mMuxID != ssrcInfo->mReceiverInfo->mFilledParameters.mMuxID) {
             ioMuxID = ssrcInfo->mMuxID = ssrcInfo->mReceiverInfo->mFilledParameters.mMuxID;
+            ssrcInfo->mMuxIDInterned = kInternedIDUnknown;
+            markRouteDirty(ssrc);
           } else {
             ioMuxID = ssrcInfo->mMuxID;
           }
@@ -2298,6 +2786,111 @@ namespace ortc
       mRegisteredSSRCs[ssrcInfo->mSSRC] = ssrcInfo;
     }
 
+    //-------------------------------------------------------------------------
+    void RTPListener::markRouteDirty(SSRCType ssrc)
+    {
+      mRoutingTableDirtySSRCs.insert(ssrc);
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTPListener::fillRoute(
+                                const SSRCInfoPtr &ssrcInfo,
+                                RoutingTable::Route &outRoute
+                                )
+    {
+      if (!ssrcInfo->mReceiverInfo) return false;
+      if (kInternedIDUnknown == ssrcInfo->mMuxIDInterned) return false;
+      if (ssrcInfo->mMuxIDInterned != ssrcInfo->mReceiverInfo->mMuxIDInterned) return false;
+
+      outRoute.mReceiverInfo = ssrcInfo->mReceiverInfo;
+      outRoute.mSSRCInfo = ssrcInfo;
+      outRoute.mMuxID = ssrcInfo->mMuxID;
+      outRoute.mMuxIDInterned = ssrcInfo->mMuxIDInterned;
+      return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPListener::publishRoutingTable()
+    {
+      if ((!mRoutingTableDirty) &&
+          (mRoutingTableDirtySSRCs.size() < 1)) return;
+
+      mRoutingTableDirty = false;
+
+      if (isShutdown()) {
+        mRoutingTableDirtySSRCs.clear();
+        std::atomic_store(&mRoutingTable, RoutingTablePtr());
+        return;
+      }
+
+      // the previous table and its shards are never modified as packet
+      // threads may still be routing from them; a replacement is swapped in
+      // which shares every shard without a changed SSRC
+      RoutingTablePtr previous = std::atomic_load(&mRoutingTable);
+      RoutingTablePtr table(make_shared<RoutingTable>());
+
+      size_t copiedShards = 0;
+
+      if (previous) {
+        RoutingTable::ShardPtr copied[RoutingTable::kShardCount];
+
+        for (size_t index = 0; index < RoutingTable::kShardCount; ++index) {
+          table->mShards[index] = previous->mShards[index];
+        }
+
+        for (auto iter = mRoutingTableDirtySSRCs.begin(); iter != mRoutingTableDirtySSRCs.end(); ++iter) {
+          SSRCType ssrc = (*iter);
+          size_t index = RoutingTable::shardIndex(ssrc);
+
+          auto &shard = copied[index];
+          if (!shard) {
+            shard = make_shared<RoutingTable::Shard>(*(table->mShards[index]));
+            table->mShards[index] = shard;
+            ++copiedShards;
+          }
+
+          RoutingTable::Route route;
+          auto found = mSSRCTable.find(ssrc);
+          if ((found != mSSRCTable.end()) &&
+              (fillRoute((*found).second, route))) {
+            shard->mRoutes[ssrc] = route;
+          } else {
+            shard->mRoutes.erase(ssrc);
+          }
+        }
+      } else {
+        // first publish; every route is built from the SSRC table
+        for (size_t index = 0; index < RoutingTable::kShardCount; ++index) {
+          table->mShards[index] = make_shared<RoutingTable::Shard>();
+        }
+        copiedShards = RoutingTable::kShardCount;
+
+        for (auto iter = mSSRCTable.begin(); iter != mSSRCTable.end(); ++iter) {
+          RoutingTable::Route route;
+          if (!fillRoute((*iter).second, route)) continue;
+
+          table->mShards[RoutingTable::shardIndex((*iter).first)]->mRoutes[(*iter).first] = route;
+        }
+      }
+
+      for (auto iter = mRegisteredExtensions.begin(); iter != mRegisteredExtensions.end(); ++iter) {
+        const RegisteredHeaderExtension &headerInfo = (*iter).second;
+
+        if (IRTPTypes::HeaderExtensionURI_MuxID != headerInfo.mHeaderExtensionURI) continue;
+        if (headerInfo.mLocalID > 0xFF) continue;
+
+        table->mMuxIDExtensionIDs.push_back(static_cast<BYTE>(headerInfo.mLocalID));
+      }
+
+      table->mInternTable = mInternTable;
+
+      ZS_LOG_TRACE(log("publishing routing table") + ZS_PARAM("changed ssrcs", mRoutingTableDirtySSRCs.size()) + ZS_PARAM("copied shards", copiedShards) + ZS_PARAM("ssrc table", mSSRCTable.size()))
+
+      mRoutingTableDirtySSRCs.clear();
+
+      std::atomic_store(&mRoutingTable, table);
+    }
+
     //-------------------------------------------------------------------------
     void RTPListener::reattemptDelivery()
     {
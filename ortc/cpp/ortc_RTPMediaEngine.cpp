@@ -100,6 +100,19 @@ namespace ortc
     // foreward declaration
     void webrtcTrace(Log::Severity severity, Log::Level level, const char *message);
 
+    //-------------------------------------------------------------------------
+    // RETURNS: 0 if no encoding names an SSRC (the channel picks one when
+    //          it is set up)
+    static DWORD getPrimarySSRC(const IRTPTypes::Parameters *parameters)
+    {
+      if (!parameters) return 0;
+      for (auto iter = parameters->mEncodings.begin(); iter != parameters->mEncodings.end(); ++iter) {
+        auto &encoding = (*iter);
+        if (encoding.mSSRC.hasValue()) return encoding.mSSRC.value();
+      }
+      return 0;
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -1523,10 +1536,11 @@ namespace ortc
     //-------------------------------------------------------------------------
     RTPMediaEngine::ChannelResource::ChannelResource(
                                                      const make_private &priv,
-                                                     IRTPMediaEngineRegistrationPtr registration
+                                                     IRTPMediaEngineRegistrationPtr registration,
+                                                     IMessageQueuePtr handlePacketQueue
                                                      ) : 
       BaseResource(priv, registration, registration ? registration->getRTPEngine() : RTPMediaEnginePtr()),
-      mHandlePacketQueue(IORTCForInternal::queuePacket()),
+      mHandlePacketQueue(handlePacketQueue ? handlePacketQueue : IORTCForInternal::queuePacket()),
       mClock(webrtc::Clock::GetRealTimeClock()),
       mRemb(mClock)
     {
@@ -1660,7 +1674,7 @@ namespace ortc
                                                                                ParametersPtr parameters,
                                                                                RTPPacketPtr packet
                                                                                ) :
-      ChannelResource(priv, registration),
+      ChannelResource(priv, registration, IORTCForInternal::queuePacket(transport.get(), packet ? packet->ssrc() : getPrimarySSRC(parameters.get()))),
       mTransport(transport),
       mTrack(track),
       mParameters(parameters),
@@ -2189,7 +2203,7 @@ namespace ortc
                                                                            MediaStreamTrackPtr track,
                                                                            ParametersPtr parameters
                                                                            ) :
-      ChannelResource(priv, registration),
+      ChannelResource(priv, registration, IORTCForInternal::queuePacket(transport.get(), getPrimarySSRC(parameters.get()))),
       mTransport(transport),
       mTrack(track),
       mParameters(parameters)
@@ -2700,7 +2714,7 @@ namespace ortc
                                                                                ParametersPtr parameters,
                                                                                RTPPacketPtr packet
                                                                                ) :
-      ChannelResource(priv, registration),
+      ChannelResource(priv, registration, IORTCForInternal::queuePacket(transport.get(), packet ? packet->ssrc() : getPrimarySSRC(parameters.get()))),
       mTransport(transport),
       mTrack(track),
       mParameters(parameters),
@@ -3196,7 +3210,7 @@ namespace ortc
                                                                            MediaStreamTrackPtr track,
                                                                            ParametersPtr parameters
                                                                            ) :
-      ChannelResource(priv, registration),
+      ChannelResource(priv, registration, IORTCForInternal::queuePacket(transport.get(), getPrimarySSRC(parameters.get()))),
       mTransport(transport),
       mTrack(track),
       mParameters(parameters)
@@ -35,6 +35,7 @@
 #include <ortc/internal/platform.h>
 
 #include <openpeer/services/IHelper.h>
+#include <openpeer/services/ISettings.h>
 
 //#include <openpeer/services/IHTTP.h>
 //
@@ -70,6 +71,7 @@ namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib_rtp_rtcp_packet) }
 namespace ortc
 {
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
 //  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHTTP, UseHTTP)
 //
 //  typedef openpeer::services::Hasher<CryptoPP::SHA1> SHA1Hasher;
@@ -80,6 +82,23 @@ namespace ortc
 
     using CryptoPP::Integer;
 
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IRTPPacketForSettings
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void IRTPPacketForSettings::applyDefaults()
+    {
+      // TURN ChannelData header (4) plus room to add MID/RID tags
+      UseSettings::setUInt(ORTC_SETTING_RTP_PACKET_RESERVED_HEADROOM_IN_BYTES, 4 + RTPPacket::kHeaderExtensionHeadroom);
+      // SRTP authentication tag (10) plus SRTCP index (4) plus a small MKI
+      UseSettings::setUInt(ORTC_SETTING_RTP_PACKET_RESERVED_TAILROOM_IN_BYTES, 10 + 4 + 4);
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -717,6 +736,30 @@ namespace ortc
       return RTPPacket::create(UseServicesHelper::convertToBuffer(buffer, bufferLengthInBytes));
     }
 
+    //-------------------------------------------------------------------------
+    RTPPacketPtr RTPPacket::create(
+                                   const BYTE *buffer,
+                                   size_t bufferLengthInBytes,
+                                   size_t reserveHeadroom,
+                                   size_t reserveTailroom
+                                   )
+    {
+      ORTC_THROW_INVALID_PARAMETERS_IF(!buffer)
+      ORTC_THROW_INVALID_PARAMETERS_IF(0 == bufferLengthInBytes)
+
+      RTPPacketPtr pThis(make_shared<RTPPacket>(make_private{}));
+      pThis->mBuffer = make_shared<SecureByteBlock>(reserveHeadroom + bufferLengthInBytes + reserveTailroom);
+      BYTE *pos = pThis->mBuffer->BytePtr() + reserveHeadroom;
+      memcpy(pos, buffer, bufferLengthInBytes);
+      pThis->mPtr = pos;
+      pThis->mSize = bufferLengthInBytes;
+      if (!pThis->parse()) {
+        ZS_LOG_WARNING(Debug, pThis->log("packet could not be parsed"))
+        return RTPPacketPtr();
+      }
+      return pThis;
+    }
+
     //-------------------------------------------------------------------------
     RTPPacketPtr RTPPacket::create(const SecureByteBlock &buffer)
     {
@@ -728,6 +771,26 @@ namespace ortc
     {
       RTPPacketPtr pThis(make_shared<RTPPacket>(make_private{}));
       pThis->mBuffer = buffer;
+      if (buffer) {
+        pThis->mPtr = buffer->BytePtr();
+        pThis->mSize = buffer->SizeInBytes();
+      }
+      if (!pThis->parse()) {
+        ZS_LOG_WARNING(Debug, pThis->log("packet could not be parsed"))
+        return RTPPacketPtr();
+      }
+      return pThis;
+    }
+
+    //-------------------------------------------------------------------------
+    RTPPacketPtr RTPPacket::createView(const BYTE *buffer, size_t bufferLengthInBytes)
+    {
+      ORTC_THROW_INVALID_PARAMETERS_IF(!buffer)
+      ORTC_THROW_INVALID_PARAMETERS_IF(0 == bufferLengthInBytes)
+
+      RTPPacketPtr pThis(make_shared<RTPPacket>(make_private{}));
+      pThis->mPtr = buffer;
+      pThis->mSize = bufferLengthInBytes;
       if (!pThis->parse()) {
         ZS_LOG_WARNING(Debug, pThis->log("packet could not be parsed"))
         return RTPPacketPtr();
@@ -738,19 +801,51 @@ namespace ortc
     //-------------------------------------------------------------------------
     const BYTE *RTPPacket::ptr() const
     {
-      return mBuffer->BytePtr();
+      return mPtr;
     }
 
     //-------------------------------------------------------------------------
     size_t RTPPacket::size() const
     {
-      return mBuffer->SizeInBytes();
+      return mSize;
     }
 
     //-------------------------------------------------------------------------
     SecureByteBlockPtr RTPPacket::buffer() const
     {
-      return mBuffer;
+      if (!mPtr) return mBuffer;
+
+      if ((mBuffer) &&
+          (0 == headroom()) &&
+          (0 == tailroom())) return mBuffer;
+
+      // a view (or a packet with room around it) hands out an exact sized copy
+      return UseServicesHelper::convertToBuffer(mPtr, mSize);
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::materialize()
+    {
+      if (mBuffer) return;
+      if (!mPtr) return;
+
+      relocate(0, 0);
+
+      ZS_LOG_INSANE(log("view materialized") + ZS_PARAM("size", mSize))
+    }
+
+    //-------------------------------------------------------------------------
+    size_t RTPPacket::headroom() const
+    {
+      if (!mBuffer) return 0;
+      return static_cast<size_t>(mPtr - mBuffer->BytePtr());
+    }
+
+    //-------------------------------------------------------------------------
+    size_t RTPPacket::tailroom() const
+    {
+      if (!mBuffer) return 0;
+      return mBuffer->SizeInBytes() - headroom() - mSize;
     }
 
     //-------------------------------------------------------------------------
@@ -775,12 +870,45 @@ namespace ortc
       return &(mHeaderExtensions[index]);
     }
 
+    //-------------------------------------------------------------------------
+    RTPPacket::HeaderExtension *RTPPacket::findHeaderExtension(BYTE localID) const
+    {
+      if (0 == mTotalHeaderExtensions) return NULL;
+
+      if (mTotalHeaderExtensions <= kHeaderExtensionLinearLookupMax) {
+        // scanning a few extensions is cheaper than filling the table
+        for (size_t index = 0; index < mTotalHeaderExtensions; ++index) {
+          if (localID == mHeaderExtensions[index].mID) return &(mHeaderExtensions[index]);
+        }
+        return NULL;
+      }
+
+      if (!mHeaderExtensionLookupFilled) {
+        AutoLock lock(mHeaderExtensionLookupLock);
+        if (!mHeaderExtensionLookupFilled) {
+          fillHeaderExtensionLookup();
+          mHeaderExtensionLookupFilled = true;
+        }
+      }
+
+      WORD slot = mHeaderExtensionLookup[localID];
+      if (0 == slot) return NULL;
+      if (0xFFFF != slot) return &(mHeaderExtensions[slot - 1]);
+
+      // only an absurd number of extensions in front can cause this
+      for (size_t index = 0xFFFE; index < mTotalHeaderExtensions; ++index) {
+        if (localID == mHeaderExtensions[index].mID) return &(mHeaderExtensions[index]);
+      }
+      return NULL;
+    }
+
     //-------------------------------------------------------------------------
     ElementPtr RTPPacket::toDebug() const
     {
       ElementPtr objectEl = Element::create("ortc::RTPPacket");
 
-      UseServicesHelper::debugAppend(objectEl, "buffer", mBuffer ? mBuffer->SizeInBytes() : 0);
+      UseServicesHelper::debugAppend(objectEl, "buffer", size());
+      UseServicesHelper::debugAppend(objectEl, "view", isView());
 
       UseServicesHelper::debugAppend(objectEl, "version", mVersion);
       UseServicesHelper::debugAppend(objectEl, "padding", mPadding);
@@ -858,9 +986,7 @@ namespace ortc
 
       bool requiresExtension = requiredExtension(firstExtension, mHeaderExtensionAppBits, mHeaderExtensionPrepaddedSize, mHeaderExtensionParseStoppedPos);
 
-      const BYTE *buffer = ptr();
-
-      ASSERT(NULL != buffer)
+      ASSERT(NULL != ptr())
 
       size_t existingHeaderExtensionSize = mHeaderExtensionSize;
       size_t postHeaderExtensionSize = mPayloadSize + mPadding;
@@ -870,69 +996,144 @@ namespace ortc
       if (!requiresExtension) {
         // going to strip the extension header out entirely
 
-        if (RTP_HEADER_EXTENSION(buffer)) {
+        if (!RTP_HEADER_EXTENSION(ptr())) {
           ZS_LOG_INSANE(log("no extension present (thus no need to strip extension from RTP packet)"))
           return;
         }
 
-        ASSERT(size() == (mHeaderSize + existingHeaderExtensionSize + postHeaderExtensionSize))
-
-        size_t newSize = mHeaderSize + postHeaderExtensionSize;
+        // slide the fixed header forward over the extension (which becomes headroom)
+        BYTE *buffer = writablePtr();
+        BYTE *newBuffer = &(buffer[existingHeaderExtensionSize]);
 
-        SecureByteBlockPtr tempBuffer(make_shared<SecureByteBlock>(newSize));
-
-        BYTE *newBuffer = tempBuffer->BytePtr();
-
-        // copy the bytes before the extension header to the new buffer
-        memcpy(newBuffer, buffer, mHeaderSize);
-
-        // copy the bytes from after the extension header in the older buffer to the new buffer
-        memcpy(&(newBuffer[mHeaderSize]), &(buffer[mHeaderSize + existingHeaderExtensionSize]), postHeaderExtensionSize);
+        memmove(newBuffer, buffer, mHeaderSize);
 
         // strip the extension bit
         newBuffer[0] = newBuffer[0] & (0xFF ^ RTP_HEADER_EXTENSION_BIT);
 
-        mBuffer = tempBuffer;
+        mPtr = newBuffer;
+        mSize = mHeaderSize + postHeaderExtensionSize;
 
         mHeaderExtensionSize = 0;
 
-        mTotalHeaderExtensions = 0;
-        if (mHeaderExtensions) {
-          delete [] mHeaderExtensions;
-          mHeaderExtensions = NULL;
-        }
-        mHeaderExtensionAppBits = 0;
-        mHeaderExtensionPrepaddedSize = 0;
-        mHeaderExtensionParseStoppedPos = NULL;
-        mHeaderExtensionParseStoppedSize = 0;
+        resetHeaderExtensions();
 
         ZS_LOG_INSANE(debug("stripped existing extension header"))
         return;
       }
 
-      mHeaderExtensionSize = 0;
-      mTotalHeaderExtensions = 0;
-      getHeaderExtensionSize(firstExtension, twoByteHeader, mHeaderExtensionPrepaddedSize, mHeaderExtensionParseStoppedSize, mHeaderExtensionSize, mTotalHeaderExtensions);
+      size_t newHeaderExtensionSize = 0;
+      size_t newTotalHeaderExtensions = 0;
+      getHeaderExtensionSize(firstExtension, twoByteHeader, mHeaderExtensionPrepaddedSize, mHeaderExtensionParseStoppedSize, newHeaderExtensionSize, newTotalHeaderExtensions);
 
-      size_t newSize = mHeaderSize + mHeaderExtensionSize + postHeaderExtensionSize;
+      SecureByteBlockPtr previousAllocation = mBuffer; // the new extensions may still point into the previous allocation
+
+      if ((isView()) ||
+          (headroom() + existingHeaderExtensionSize < newHeaderExtensionSize)) {
+        // not enough room to grow in place so move the packet once (keeping
+        // spare room in front for the next change)
+        size_t growBy = (newHeaderExtensionSize > existingHeaderExtensionSize ? newHeaderExtensionSize - existingHeaderExtensionSize : 0);
+        relocate(growBy + kHeaderExtensionHeadroom, tailroom());
+      }
 
-      SecureByteBlockPtr oldBuffer = mBuffer; // temporary to keep previous allocation alive during swap
+      // The new extensions may reference data inside this packet (e.g. the
+      // existing extensions are chained after newly added ones) so they are
+      // staged before the header is moved over the top of them.
+      BYTE tempStaging[256] {};
+      SecureByteBlock heapStaging;
+      BYTE *staging = tempStaging;
+      if (newHeaderExtensionSize > sizeof(tempStaging)) {
+        heapStaging.CleanNew(newHeaderExtensionSize);
+        staging = heapStaging.BytePtr();
+      }
+
+      mHeaderExtensionSize = newHeaderExtensionSize;
+      mTotalHeaderExtensions = newTotalHeaderExtensions;
+
+      writeHeaderExtensions(staging, firstExtension, twoByteHeader);
 
-      mBuffer = make_shared<SecureByteBlock>(newSize);
+      // the payload stays where it is; only the header slides
+      BYTE *buffer = writablePtr();
+      BYTE *newBuffer = &(buffer[existingHeaderExtensionSize]) - newHeaderExtensionSize;
 
-      BYTE *newBuffer = mBuffer->BytePtr();
+      memmove(newBuffer, buffer, mHeaderSize);
+      memcpy(&(newBuffer[mHeaderSize]), staging, newHeaderExtensionSize);
 
-      // copy the bytes before the extension header to the new buffer
-      memcpy(newBuffer, buffer, mHeaderSize);
+      // set the extension bit
+      newBuffer[0] = newBuffer[0] | RTP_HEADER_EXTENSION_BIT;
 
-      // copy the bytes from after the extension header in the older buffer to the new buffer
-      memcpy(&(newBuffer[mHeaderSize + mHeaderExtensionSize]), &(buffer[mHeaderSize + existingHeaderExtensionSize]), postHeaderExtensionSize);
+      mPtr = newBuffer;
+      mSize = mHeaderSize + newHeaderExtensionSize + postHeaderExtensionSize;
 
-      writeHeaderExtensions(firstExtension, twoByteHeader);
+      rebase(staging, &(newBuffer[mHeaderSize]));
 
       ZS_LOG_INSANE(debug("header extension changed"))
     }
 
+    //-------------------------------------------------------------------------
+    void RTPPacket::changeSSRC(DWORD ssrc)
+    {
+      RTPUtils::setBE32(&(writablePtr()[8]), ssrc);
+      mSSRC = ssrc;
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::changeSequenceNumber(WORD sequenceNumber)
+    {
+      RTPUtils::setBE16(&(writablePtr()[2]), sequenceNumber);
+      mSequenceNumber = sequenceNumber;
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::changeTimestamp(DWORD timestamp)
+    {
+      RTPUtils::setBE32(&(writablePtr()[4]), timestamp);
+      mTimestamp = timestamp;
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::changePT(BYTE pt)
+    {
+      ORTC_THROW_INVALID_PARAMETERS_IF(pt > 0x7F)
+
+      BYTE *buffer = writablePtr();
+      buffer[1] = (buffer[1] & 0x80) | RTP_PACK_BITS(pt, 0x7F, 0);
+      mPT = pt;
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::changeM(bool m)
+    {
+      BYTE *buffer = writablePtr();
+      buffer[1] = (buffer[1] & 0x7F) | RTP_PACK_BITS(m ? 1 : 0, 0x1, 7);
+      mM = m;
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTPPacket::changeHeaderExtensionValue(
+                                               BYTE id,
+                                               const BYTE *data,
+                                               size_t dataSizeInBytes
+                                               )
+    {
+      BYTE *buffer = writablePtr();
+
+      for (size_t index = 0; index < mTotalHeaderExtensions; ++index) {
+        HeaderExtension &extension = mHeaderExtensions[index];
+        if (id != extension.mID) continue;
+
+        if (dataSizeInBytes != extension.mDataSizeInBytes) {
+          ZS_LOG_TRACE(log("header extension value size differs (cannot patch in place)") + ZS_PARAM("id", id) + ZS_PARAM("existing size", extension.mDataSizeInBytes) + ZS_PARAM("new size", dataSizeInBytes))
+          return false;
+        }
+
+        if (0 != dataSizeInBytes) {
+          memcpy(&(buffer[extension.mData - mPtr]), data, dataSizeInBytes);
+        }
+        return true;
+      }
+      return false;
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -964,8 +1165,8 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTPPacket::parse()
     {
-      const BYTE *buffer = mBuffer->BytePtr();
-      size_t size = mBuffer->SizeInBytes();
+      const BYTE *buffer = ptr();
+      size_t size = this->size();
 
       if (size < kMinRtpPacketLen) {
         ZS_LOG_WARNING(Trace, log("packet length is too short") + ZS_PARAM("length", size))
@@ -1032,6 +1233,18 @@ namespace ortc
         return true;
       }
 
+      return parseHeaderExtensions();
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTPPacket::parseHeaderExtensions()
+    {
+      // every failure resets again so no partially parsed extensions are left behind
+      resetHeaderExtensions();
+
+      if (0 == mHeaderExtensionSize) return true;
+
+      const BYTE *buffer = ptr();
       const BYTE *profilePos = &(buffer[mHeaderSize]);
 
       bool oneByte = false;
@@ -1045,6 +1258,7 @@ namespace ortc
 
         if (0x100 != ((twoByteHeader & 0xFFF0) >> 4)) {
           ZS_LOG_WARNING(Trace, log("header extension profile is not understood") + ZS_PARAM("profile", twoByteHeader))
+          resetHeaderExtensions();
           return false;
         }
       }
@@ -1127,6 +1341,7 @@ namespace ortc
 
           if (remaining < (1 + length)) {
             ZS_LOG_WARNING(Trace, log("extension header is not valid") + ZS_PARAM("id", id) + ZS_PARAM("remaining", remaining) + ZS_PARAM("length", length))
+            resetHeaderExtensions();
             return false;
           }
 
@@ -1147,6 +1362,7 @@ namespace ortc
 
         if (remaining < sizeof(WORD)) {
           ZS_LOG_WARNING(Trace, log("extension header is not valid") + ZS_PARAM("remaining", remaining))
+          resetHeaderExtensions();
           return false;
         }
 
@@ -1155,6 +1371,7 @@ namespace ortc
 
         if (remaining < (sizeof(WORD) + length)) {
           ZS_LOG_WARNING(Trace, log("extension header is not valid") + ZS_PARAM("id", id) + ZS_PARAM("remaining", remaining) + ZS_PARAM("length", length))
+          resetHeaderExtensions();
           return false;
         }
 
@@ -1174,19 +1391,94 @@ namespace ortc
       }
 
       mTotalHeaderExtensions = totalFound;
-      
+
       ZS_LOG_INSANE(debug("parsed"))
       return true;
     }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::resetHeaderExtensions()
+    {
+      mTotalHeaderExtensions = 0;
+      mHeaderExtensionLookupFilled = false;
+      if (mHeaderExtensions) {
+        delete [] mHeaderExtensions;
+        mHeaderExtensions = NULL;
+      }
+      mHeaderExtensionAppBits = 0;
+      mHeaderExtensionPrepaddedSize = 0;
+      mHeaderExtensionParseStoppedPos = NULL;
+      mHeaderExtensionParseStoppedSize = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::fillHeaderExtensionLookup() const
+    {
+      memset(&(mHeaderExtensionLookup[0]), 0, sizeof(mHeaderExtensionLookup));
+
+      for (size_t index = 0; index < mTotalHeaderExtensions; ++index) {
+        WORD &slot = mHeaderExtensionLookup[mHeaderExtensions[index].mID];
+        if (0 != slot) continue;  // the first extension with the ID wins
+
+        slot = (index < 0xFFFE ? static_cast<WORD>(index + 1) : 0xFFFF);
+      }
+    }
     
+    //-------------------------------------------------------------------------
+    BYTE *RTPPacket::writablePtr()
+    {
+      if (!mBuffer) materialize();
+      ASSERT((bool)mBuffer)
+
+      return &((mBuffer->BytePtr())[headroom()]);
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::relocate(
+                             size_t reserveHeadroom,
+                             size_t reserveTailroom
+                             )
+    {
+      const BYTE *oldBuffer = mPtr;
+      SecureByteBlockPtr oldAllocation = mBuffer; // temporary to keep previous allocation alive during copy
+
+      mBuffer = make_shared<SecureByteBlock>(reserveHeadroom + mSize + reserveTailroom);
+
+      BYTE *newBuffer = &((mBuffer->BytePtr())[reserveHeadroom]);
+      if (0 != mSize) {
+        memcpy(newBuffer, oldBuffer, mSize);
+      }
+      mPtr = newBuffer;
+
+      rebase(oldBuffer, newBuffer);
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPPacket::rebase(
+                           const BYTE *oldBuffer,
+                           const BYTE *newBuffer
+                           )
+    {
+      // parsed header extensions point directly into the packet's buffer
+      for (size_t index = 0; index < mTotalHeaderExtensions; ++index) {
+        HeaderExtension &extension = mHeaderExtensions[index];
+        if (NULL == extension.mData) continue;
+        extension.mData = newBuffer + (extension.mData - oldBuffer);
+      }
+
+      if (NULL != mHeaderExtensionParseStoppedPos) {
+        mHeaderExtensionParseStoppedPos = newBuffer + (mHeaderExtensionParseStoppedPos - oldBuffer);
+      }
+    }
+
     //-------------------------------------------------------------------------
     void RTPPacket::writeHeaderExtensions(
+                                          BYTE *extensionPos,
                                           HeaderExtension *firstExtension,
                                           bool twoByteHeader
                                           )
     {
-      ASSERT((bool)mBuffer)
-      ASSERT(0 != mBuffer->SizeInBytes())
+      ASSERT(NULL != extensionPos)
       ASSERT(0 != mHeaderSize)
       //ASSERT(mHeaderExtensionAppBits)           // needs to be set (but no way to verify here)
       //ASSERT(mTotalHeaderExtensions)            // needs to be set (but no way to verify here)
@@ -1196,12 +1488,7 @@ namespace ortc
       ASSERT(0 != mHeaderExtensionSize)
 
 
-      BYTE *newBuffer = mBuffer->BytePtr();
-
-      // set the extension bit
-      newBuffer[0] = newBuffer[0] | RTP_HEADER_EXTENSION_BIT;
-
-      BYTE *newProfilePos = &(newBuffer[mHeaderSize]);
+      BYTE *newProfilePos = extensionPos;
 
       if (twoByteHeader) {
         WORD profileType = (0x100 << 4) | (mHeaderExtensionAppBits & 0xF);
@@ -1268,6 +1555,7 @@ namespace ortc
         mHeaderExtensions = NULL;
       }
       mHeaderExtensions = newExtensions;
+      mHeaderExtensionLookupFilled = false;
     }
 
     //-------------------------------------------------------------------------
@@ -1356,9 +1644,12 @@ namespace ortc
 
       size_t newSize = mHeaderSize + mHeaderExtensionSize + postHeaderExtensionSize;
 
-      mBuffer = make_shared<SecureByteBlock>(newSize);
+      mBuffer = make_shared<SecureByteBlock>(params.mReserveHeadroom + newSize + params.mReserveTailroom);
+
+      BYTE *newBuffer = &((mBuffer->BytePtr())[params.mReserveHeadroom]);
 
-      BYTE *newBuffer = mBuffer->BytePtr();
+      mPtr = newBuffer;
+      mSize = newSize;
 
       // fill standard header
 
@@ -1380,7 +1671,7 @@ namespace ortc
       }
 
       if (requiresExtension) {
-        writeHeaderExtensions(params.mFirstHeaderExtension, twoByteHeader);
+        writeHeaderExtensions(&(pos[mHeaderSize]), params.mFirstHeaderExtension, twoByteHeader);
       }
 
       if (0 != mPayloadSize) {
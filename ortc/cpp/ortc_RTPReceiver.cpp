@@ -116,6 +116,7 @@ namespace ortc
       UseSettings::setUInt(ORTC_SETTING_RTP_RECEIVER_SSRC_TIMEOUT_IN_SECONDS, 60);
 
       UseSettings::setUInt(ORTC_SETTING_RTP_RECEIVER_MAX_RTP_PACKETS_IN_BUFFER, 100);
+      UseSettings::setUInt(ORTC_SETTING_RTP_RECEIVER_MAX_RTP_BYTES_IN_BUFFER, 128*1024);
       UseSettings::setUInt(ORTC_SETTING_RTP_RECEIVER_MAX_AGE_RTP_PACKETS_IN_SECONDS, 30);
 
       UseSettings::setUInt(ORTC_SETTING_RTP_RECEIVER_CSRC_EXPIRY_TIME_IN_SECONDS, 10);
@@ -485,7 +486,9 @@ namespace ortc
       mKind(kind),
       mChannels(make_shared<ChannelWeakMap>()),
       mMaxBufferedRTPPackets(SafeInt<decltype(mMaxBufferedRTPPackets)>(UseSettings::getUInt(ORTC_SETTING_RTP_RECEIVER_MAX_RTP_PACKETS_IN_BUFFER))),
+      mMaxBufferedRTPBytes(SafeInt<decltype(mMaxBufferedRTPBytes)>(UseSettings::getUInt(ORTC_SETTING_RTP_RECEIVER_MAX_RTP_BYTES_IN_BUFFER))),
       mMaxRTPPacketAge(UseSettings::getUInt(ORTC_SETTING_RTP_RECEIVER_MAX_AGE_RTP_PACKETS_IN_SECONDS)),
+      mBufferedRTPPackets(mMaxBufferedRTPPackets, mMaxBufferedRTPBytes, mMaxRTPPacketAge),
       mLockAfterSwitchTime(UseSettings::getUInt(ORTC_SETTING_RTP_RECEIVER_LOCK_TO_RECEIVER_CHANNEL_AFTER_SWITCH_EXCLUSIVELY_FOR_IN_MILLISECONDS)),
       mAmbigousPayloadMappingMinDifference(UseSettings::getUInt(ORTC_SETTING_RTP_RECEIVER_ONLY_RESOLVE_AMBIGUOUS_PAYLOAD_MAPPING_IF_ACTIVITY_DIFFERS_IN_MILLISECONDS)),
       mSSRCTableExpires(Seconds(UseSettings::getUInt(ORTC_SETTING_RTP_RECEIVER_SSRC_TIMEOUT_IN_SECONDS))),
@@ -608,6 +611,19 @@ namespace ortc
       {
         AutoRecursiveLock lock(*this);
         channels = mChannels; // obtain pointer to COW list while inside a lock
+
+        // buffered packets not (yet) routable to any channel
+        UseStatsReport::StatMap reportStats;
+
+        auto report = make_shared<PacketRingStats>();
+        report->mID = string(mID) + "_rtp_buffer";
+        report->mTimestamp = zsLib::now();
+        mBufferedRTPPackets.fillStats(*report);
+        reportStats[report->mID] = report;
+
+        auto bufferPromise = PromiseWithStatsReport::create(IORTCForInternal::queueORTC());
+        bufferPromise->resolve(UseStatsReport::create(reportStats));
+        promises.push_back(bufferPromise);
       }
 
       bool result = false;
@@ -1457,7 +1473,7 @@ namespace ortc
                                    RTPPacketPtr packet
                                    )
     {
-      EventWriteOrtcRtpReceivedIncomingPacket(__func__, mID, zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpReceivedIncomingPacket(__func__, mID, zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->size()), packet->ptr());
 
       ZS_LOG_TRACE(log("received packet") + ZS_PARAM("via", IICETypes::toString(viaTransport)) + packet->toDebug())
 
@@ -1482,12 +1498,12 @@ namespace ortc
           return false;
         }
 
-        expireRTPPackets();
-
         Time tick = zsLib::now();
 
-        // provide some modest buffering
-        mBufferedRTPPackets.push_back(TimeRTPPacketPair(tick, packet));
+        // provide some modest buffering (expires / evicts the oldest packets as needed)
+        if (!mBufferedRTPPackets.push(tick, packet->ssrc(), packet)) {
+          ZS_LOG_WARNING(Debug, log("rtp packet is too large to buffer") + ZS_PARAM("size", packet->size()) + ZS_PARAM("max bytes", mMaxBufferedRTPBytes))
+        }
 
         String muxID = extractMuxID(*packet);
 
@@ -1498,7 +1514,7 @@ namespace ortc
     process_rtp:
       {
         ZS_LOG_TRACE(log("forwarding RTP packet to channel") + ZS_PARAM("channel id", channelHolder->getID()) + ZS_PARAM("ssrc", packet->ssrc()))
-        EventWriteOrtcRtpReceiverDeliverIncomingPacketToChannel(__func__, mID, channelHolder->getID(), zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+        EventWriteOrtcRtpReceiverDeliverIncomingPacketToChannel(__func__, mID, channelHolder->getID(), zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->size()), packet->ptr());
         return channelHolder->handle(packet);
       }
 
@@ -1511,7 +1527,7 @@ namespace ortc
                                    RTCPPacketPtr packet
                                    )
     {
-      EventWriteOrtcRtpReceivedIncomingPacket(__func__, mID, zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpReceivedIncomingPacket(__func__, mID, zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->size()), packet->ptr());
 
       ZS_LOG_TRACE(log("received packet") + ZS_PARAM("via", IICETypes::toString(viaTransport)) + packet->toDebug())
 
@@ -1535,7 +1551,7 @@ namespace ortc
           continue;
         }
 
-        EventWriteOrtcRtpReceiverDeliverIncomingPacketToChannel(__func__, mID, channelHolder->getID(), zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+        EventWriteOrtcRtpReceiverDeliverIncomingPacketToChannel(__func__, mID, channelHolder->getID(), zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->size()), packet->ptr());
         auto channelResult = channelHolder->handle(packet);
         result = result || channelResult;
       }
@@ -1579,7 +1595,14 @@ namespace ortc
 
       ZS_LOG_TRACE(log("sending rtcp packet over secure transport") + ZS_PARAM("size", packet->size()))
 
-      EventWriteOrtcRtpReceiverSendOutgoingPacket(__func__, mID, zsLib::to_underlying(mSendRTCPOverTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpReceiverSendOutgoingPacket(__func__, mID, zsLib::to_underlying(mSendRTCPOverTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->size()), packet->ptr());
+      if ((0 != packet->tailroom()) &&
+          (1 == packet.use_count())) {
+        // nobody else references the packet thus the send consumes it and
+        // it can be protected in place
+        return rtcpTransport->sendPacketInPlace(mSendRTCPOverTransport, IICETypes::Component_RTCP, packet->writablePtr(), packet->size(), packet->tailroom());
+      }
+
       return rtcpTransport->sendPacket(mSendRTCPOverTransport, IICETypes::Component_RTCP, packet->ptr(), packet->size());
     }
 
@@ -1798,9 +1821,12 @@ namespace ortc
       UseServicesHelper::debugAppend(resultEl, "ssrc table expires", mSSRCTableExpires);
 
       UseServicesHelper::debugAppend(resultEl, "max buffered rtp packets", mMaxBufferedRTPPackets);
+      UseServicesHelper::debugAppend(resultEl, "max buffered rtp bytes", mMaxBufferedRTPBytes);
       UseServicesHelper::debugAppend(resultEl, "max rtp packet age", mMaxRTPPacketAge);
 
       UseServicesHelper::debugAppend(resultEl, "buffered rtp packets", mBufferedRTPPackets.size());
+      UseServicesHelper::debugAppend(resultEl, "buffered rtp bytes", mBufferedRTPPackets.bytes());
+      UseServicesHelper::debugAppend(resultEl, mBufferedRTPPackets.counters().toDebug());
       UseServicesHelper::debugAppend(resultEl, "reattempt delivery", mReattemptRTPDelivery);
 
       UseServicesHelper::debugAppend(resultEl, "contributing sources", mContributingSources.size());
@@ -1880,25 +1906,29 @@ namespace ortc
 
       size_t beforeSize = 0;
 
+      std::vector<BufferedRTPPacketRing::SSRCType> ssrcs;
+
       do
       {
         beforeSize = mBufferedRTPPackets.size();
-        for (auto iter_doNotUse = mBufferedRTPPackets.begin(); iter_doNotUse != mBufferedRTPPackets.end();) {
-          auto current = iter_doNotUse;
-          ++iter_doNotUse;
 
-          RTPPacketPtr packet = (*current).second;
+        mBufferedRTPPackets.getSSRCs(ssrcs);
 
-          ChannelHolderPtr channelHolder;
-          String rid;
-          if (!findMapping(*packet, channelHolder, rid)) continue;
+        for (auto iterSSRC = ssrcs.begin(); iterSSRC != ssrcs.end(); ++iterSSRC) {
+          for (auto index = mBufferedRTPPackets.first(*iterSSRC); BufferedRTPPacketRing::kNone != index; index = mBufferedRTPPackets.next(index)) {
+            RTPPacketPtr packet = mBufferedRTPPackets.packet(index);
 
-          postFindMappingProcessPacket(*packet, channelHolder);
+            ChannelHolderPtr channelHolder;
+            String rid;
+            if (!findMapping(*packet, channelHolder, rid)) continue;
+
+            postFindMappingProcessPacket(*packet, channelHolder);
 
-          ZS_LOG_TRACE(log("will attempt to deliver buffered RTP packet") + ZS_PARAM("channel", channelHolder->getID()) + ZS_PARAM("ssrc", packet->ssrc()))
-          channelHolder->notify(packet);
+            ZS_LOG_TRACE(log("will attempt to deliver buffered RTP packet") + ZS_PARAM("channel", channelHolder->getID()) + ZS_PARAM("ssrc", packet->ssrc()))
+            channelHolder->notify(packet);
 
-          mBufferedRTPPackets.erase(current);
+            mBufferedRTPPackets.remove(index);
+          }
         }
 
       // NOTE: need to repetitively attempt to deliver packets as it's possible
@@ -2570,23 +2600,14 @@ namespace ortc
     //-------------------------------------------------------------------------
     void RTPReceiver::expireRTPPackets()
     {
-      auto tick = zsLib::now();
+      auto before = mBufferedRTPPackets.counters().mDroppedExpired;
 
-      while (mBufferedRTPPackets.size() > 0) {
-        auto packetTime = mBufferedRTPPackets.front().first;
+      mBufferedRTPPackets.expire(zsLib::now());
 
-        {
-          if (mBufferedRTPPackets.size() > mMaxBufferedRTPPackets) goto expire_packet;
-          if (packetTime + mMaxRTPPacketAge < tick) goto expire_packet;
-          break;
-        }
+      auto expired = mBufferedRTPPackets.counters().mDroppedExpired - before;
+      if (0 == expired) return;
 
-      expire_packet:
-        {
-          ZS_LOG_TRACE(log("expiring buffered rtp packet") + ZS_PARAM("tick", tick) + ZS_PARAM("packet time (s)", packetTime) + ZS_PARAM("total", mBufferedRTPPackets.size()))
-          mBufferedRTPPackets.pop_front();
-        }
-      }
+      ZS_LOG_TRACE(log("expired buffered rtp packets") + ZS_PARAM("expired", expired) + ZS_PARAM("total", mBufferedRTPPackets.size()))
     }
 
     //-------------------------------------------------------------------------
@@ -2621,7 +2642,7 @@ namespace ortc
 
       outRID = extractRID(routingPayload, rtpPacket, outChannelHolder);
 
-      EventWriteOrtcRtpReceiverFindMapping(__func__, mID, outRID, SafeInt<unsigned int>(rtpPacket.buffer()->SizeInBytes()), rtpPacket.buffer()->BytePtr());
+      EventWriteOrtcRtpReceiverFindMapping(__func__, mID, outRID, SafeInt<unsigned int>(rtpPacket.size()), rtpPacket.ptr());
 
       {
         if (outChannelHolder) goto fill_rid;
@@ -2664,14 +2685,14 @@ namespace ortc
                                    ChannelHolderPtr &outChannelHolder
                                    )
     {
-      for (auto ext = rtpPacket.firstHeaderExtension(); NULL != ext; ext = ext->mNext) {
-        LocalID localID = static_cast<LocalID>(ext->mID);
-        auto found = mRegisteredExtensions.find(localID);
-        if (found == mRegisteredExtensions.end()) continue; // header extension is not understood
-
-        RegisteredHeaderExtension &headerInfo = (*found).second;
+      for (auto iter = mRegisteredExtensions.begin(); iter != mRegisteredExtensions.end(); ++iter) {
+        RegisteredHeaderExtension &headerInfo = (*iter).second;
 
         if (IRTPTypes::HeaderExtensionURI_RID != headerInfo.mHeaderExtensionURI) continue;
+        if (headerInfo.mLocalID > 0xFF) continue;
+
+        auto ext = rtpPacket.findHeaderExtension(static_cast<BYTE>(headerInfo.mLocalID));
+        if (NULL == ext) continue;
 
         RTPPacket::RidHeaderExtension rid(*ext);
 
@@ -2691,14 +2712,14 @@ namespace ortc
     //-------------------------------------------------------------------------
     String RTPReceiver::extractMuxID(const RTPPacket &rtpPacket)
     {
-      for (auto ext = rtpPacket.firstHeaderExtension(); NULL != ext; ext = ext->mNext) {
-        LocalID localID = static_cast<LocalID>(ext->mID);
-        auto found = mRegisteredExtensions.find(localID);
-        if (found == mRegisteredExtensions.end()) continue; // header extension is not understood
-
-        RegisteredHeaderExtension &headerInfo = (*found).second;
+      for (auto iter = mRegisteredExtensions.begin(); iter != mRegisteredExtensions.end(); ++iter) {
+        RegisteredHeaderExtension &headerInfo = (*iter).second;
 
         if (IRTPTypes::HeaderExtensionURI_MuxID != headerInfo.mHeaderExtensionURI) continue;
+        if (headerInfo.mLocalID > 0xFF) continue;
+
+        auto ext = rtpPacket.findHeaderExtension(static_cast<BYTE>(headerInfo.mLocalID));
+        if (NULL == ext) continue;
 
         RTPPacket::MidHeaderExtension mid(*ext);
 
@@ -3618,12 +3639,13 @@ namespace ortc
     //-------------------------------------------------------------------------
     void RTPReceiver::extractCSRCs(const RTPPacket &rtpPacket)
     {
-      for (auto ext = rtpPacket.firstHeaderExtension(); NULL != ext; ext = ext->mNext) {
-        LocalID localID = static_cast<LocalID>(ext->mID);
-        auto found = mRegisteredExtensions.find(localID);
-        if (found == mRegisteredExtensions.end()) continue; // header extension is not understood
+      for (auto iter = mRegisteredExtensions.begin(); iter != mRegisteredExtensions.end(); ++iter) {
+        RegisteredHeaderExtension &headerInfo = (*iter).second;
+
+        if (headerInfo.mLocalID > 0xFF) continue;
 
-        RegisteredHeaderExtension &headerInfo = (*found).second;
+        auto ext = rtpPacket.findHeaderExtension(static_cast<BYTE>(headerInfo.mLocalID));
+        if (NULL == ext) continue;
 
         switch (headerInfo.mHeaderExtensionURI) {
           case IRTPTypes::HeaderExtensionURI_ClienttoMixerAudioLevelIndication:   {
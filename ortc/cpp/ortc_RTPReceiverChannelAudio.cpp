@@ -166,7 +166,9 @@ namespace ortc
       SharedRecursiveLock(SharedRecursiveLock::create()),
       mReceiverChannel(receiverChannel),
       mTrack(track),
-      mParameters(make_shared<Parameters>(params))
+      mParameters(make_shared<Parameters>(params)),
+      mPacketHeadroom(UseSettings::getUInt(ORTC_SETTING_RTP_PACKET_RESERVED_HEADROOM_IN_BYTES)),
+      mPacketTailroom(UseSettings::getUInt(ORTC_SETTING_RTP_PACKET_RESERVED_TAILROOM_IN_BYTES))
     {
       ZS_LOG_DETAIL(debug("created"))
 
@@ -494,7 +496,7 @@ namespace ortc
     {
       auto channel = mReceiverChannel.lock();
       if (!channel) return false;
-      return channel->sendPacket(RTCPPacket::create(packet, length));
+      return channel->sendPacket(RTCPPacket::create(packet, length, mPacketHeadroom, mPacketTailroom));
     }
 
     //-------------------------------------------------------------------------
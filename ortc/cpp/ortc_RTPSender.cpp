@@ -775,7 +775,7 @@ namespace ortc
                                  RTCPPacketPtr packet
                                  )
     {
-      EventWriteOrtcRtpSenderIncomingPacket(__func__, mID, zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpSenderIncomingPacket(__func__, mID, zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->size()), packet->ptr());
 
       ZS_LOG_TRACE(log("received packet") + ZS_PARAM("via", IICETypes::toString(viaTransport)) + packet->toDebug())
 
@@ -791,7 +791,7 @@ namespace ortc
       {
         auto channel = (*iter).second;
 
-        EventWriteOrtcRtpSenderDeliverIncomingPacketToChannel(__func__, mID, channel->getID(), zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+        EventWriteOrtcRtpSenderDeliverIncomingPacketToChannel(__func__, mID, channel->getID(), zsLib::to_underlying(viaTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->size()), packet->ptr());
 
         auto channelResult = channel->handle(packet);
         result = result || channelResult;
@@ -831,7 +831,14 @@ namespace ortc
 
       ZS_LOG_TRACE(log("sending rtp packet over secure transport") + ZS_PARAM("size", packet->size()))
 
-      EventWriteOrtcRtpSenderSendOutgoingPacket(__func__, mID, zsLib::to_underlying(mSendRTPOverTransport), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpSenderSendOutgoingPacket(__func__, mID, zsLib::to_underlying(mSendRTPOverTransport), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->size()), packet->ptr());
+
+      if ((0 != packet->tailroom()) &&
+          (1 == packet.use_count())) {
+        // nobody else references the packet thus the send consumes it and
+        // it can be protected in place
+        return rtpTransport->sendPacketInPlace(mSendRTPOverTransport, IICETypes::Component_RTP, packet->writablePtr(), packet->size(), packet->tailroom());
+      }
 
       return rtpTransport->sendPacket(mSendRTPOverTransport, IICETypes::Component_RTP, packet->ptr(), packet->size());
     }
@@ -859,11 +866,70 @@ namespace ortc
 
       ZS_LOG_TRACE(log("sending rtcp packet over secure transport") + ZS_PARAM("size", packet->size()))
 
-      EventWriteOrtcRtpSenderSendOutgoingPacket(__func__, mID, zsLib::to_underlying(mSendRTCPOverTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpSenderSendOutgoingPacket(__func__, mID, zsLib::to_underlying(mSendRTCPOverTransport), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->size()), packet->ptr());
+
+      if ((0 != packet->tailroom()) &&
+          (1 == packet.use_count())) {
+        // nobody else references the packet thus the send consumes it and
+        // it can be protected in place
+        return rtcpTransport->sendPacketInPlace(mSendRTCPOverTransport, IICETypes::Component_RTCP, packet->writablePtr(), packet->size(), packet->tailroom());
+      }
 
       return rtcpTransport->sendPacket(mSendRTCPOverTransport, IICETypes::Component_RTCP, packet->ptr(), packet->size());
     }
 
+    //-------------------------------------------------------------------------
+    bool RTPSender::sendPackets(const RTPPacketList &packets)
+    {
+      if (packets.size() < 1) return true;
+
+      UseSecureTransportPtr rtpTransport;
+
+      {
+        AutoRecursiveLock lock(*this);
+
+        if (isShutdown()) {
+          ZS_LOG_WARNING(Debug, log("cannot send packets while shutdown"))
+          return false;
+        }
+
+        rtpTransport = mRTPTransport;
+      }
+
+      if (!rtpTransport) {
+        ZS_LOG_WARNING(Debug, log("no rtp transport is currently attached (thus discarding sent packets)"))
+        return false;
+      }
+
+      ZS_LOG_TRACE(log("sending rtp packet burst over secure transport") + ZS_PARAM("total", packets.size()))
+
+      ISecureTransportTypes::OutgoingPacketList outgoingPackets;
+      outgoingPackets.reserve(packets.size());
+
+      for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+        auto &packet = (*iter);
+
+        EventWriteOrtcRtpSenderSendOutgoingPacket(__func__, mID, zsLib::to_underlying(mSendRTPOverTransport), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->size()), packet->ptr());
+
+        ISecureTransportTypes::OutgoingPacket outgoing;
+        outgoing.mPacketType = IICETypes::Component_RTP;
+        outgoing.mSize = packet->size();
+        outgoing.mTailroom = packet->tailroom();
+        if ((0 != outgoing.mTailroom) &&
+            (1 == packet.use_count())) {
+          // only referenced by the burst thus it can be protected in place
+          outgoing.mWritableBuffer = packet->writablePtr();
+          outgoing.mBuffer = outgoing.mWritableBuffer;
+        } else {
+          outgoing.mBuffer = packet->ptr();
+        }
+
+        outgoingPackets.push_back(outgoing);
+      }
+
+      return rtpTransport->sendPackets(mSendRTPOverTransport, outgoingPackets);
+    }
+
     //-------------------------------------------------------------------------
     void RTPSender::notifyConflict(
                                    UseChannelPtr channel,
@@ -174,7 +174,9 @@ namespace ortc
       mTrack(track),
       mParameters(make_shared<Parameters>(params)),
       mRetagAfterInSeconds(Seconds(UseSettings::getUInt(ORTC_SETTING_RTP_SENDER_CHANNEL_RETAG_RTP_PACKETS_AFTER_SSRC_NOT_SENT_IN_SECONDS))),
-      mTagSDES(UseSettings::getBool(ORTC_SETTING_RTP_SENDER_CHANNEL_TAG_MID_RID_IN_RTCP_SDES))
+      mTagSDES(UseSettings::getBool(ORTC_SETTING_RTP_SENDER_CHANNEL_TAG_MID_RID_IN_RTCP_SDES)),
+      mPacketHeadroom(UseSettings::getUInt(ORTC_SETTING_RTP_PACKET_RESERVED_HEADROOM_IN_BYTES)),
+      mPacketTailroom(UseSettings::getUInt(ORTC_SETTING_RTP_PACKET_RESERVED_TAILROOM_IN_BYTES))
     {
       ZS_LOG_DETAIL(debug("created"))
 
@@ -347,7 +349,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool RTPSenderChannel::handlePacket(RTCPPacketPtr packet)
     {
-      EventWriteOrtcRtpSenderChannelDeliverIncomingPacketToMediaChannel(__func__, mID, mMediaBase->getID(), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpSenderChannelDeliverIncomingPacketToMediaChannel(__func__, mID, mMediaBase->getID(), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->size()), packet->ptr());
 
       if (mIsTagging)
       {
@@ -404,65 +406,11 @@ namespace ortc
       auto sender = mSender.lock();
       if (!sender) return false;
 
-      if (mIsTagging)
-      {
-        Time tick = zsLib::now();
-
-        AutoRecursiveLock lock(*this);
-
-        TaggingInfoPtr tagInfo;
-
-        auto found = mTaggings.find(packet->ssrc());
-        if (found == mTaggings.end()) {
-          tagInfo = make_shared<TaggingInfo>();
-          mTaggings[packet->ssrc()] = tagInfo;
-        } else {
-          tagInfo = (*found).second;
-        }
-
-        if (tagInfo->mLastSentPacket + mRetagAfterInSeconds < tick) {
-          tagInfo->mReceiverAck = false;
-          tagInfo->mSequenceNumberFirst = packet->sequenceNumber();
-        }
-        tagInfo->mLastSentPacket = tick;
-        if (!tagInfo->mReceiverAck) {
-          tagInfo->mSequenceNumberLast = packet->sequenceNumber();
-
-          auto oldHeaderExtensions = packet->mHeaderExtensions; // remember old pointer temporarily
-
-          RTPPacket::StringHeaderExtension muxHeader(mMuxHeader ? mMuxHeader->mID : 0, mMuxID.c_str());
-          RTPPacket::StringHeaderExtension ridHeader(mRIDHeader ? mRIDHeader->mID : 0, mRID.c_str());
-
-          // Re-point extenion headers in RTP packet to first point to MuxID or
-          // RID or both.
-          if (mMuxID.hasData()) {
-            if (mRID.hasData()) {
-              muxHeader.mNext = &ridHeader;
-              ridHeader.mNext = oldHeaderExtensions;
-              packet->mHeaderExtensions = &muxHeader;
-            } else {
-              muxHeader.mNext = oldHeaderExtensions;
-              packet->mHeaderExtensions = &muxHeader;
-            }
-          } else {
-            ridHeader.mNext = oldHeaderExtensions;
-            packet->mHeaderExtensions = &ridHeader;
-          }
-
-          RTPPacketPtr newPacket = RTPPacket::create(*packet);
+      tagPacket(packet);
 
-          // Put back old pointer to prevent crash during free of old packet.
-          packet->mHeaderExtensions = oldHeaderExtensions;
+      EventWriteOrtcRtpSenderChannelSendOutgoingPacket(__func__, mID, sender->getID(), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->size()), packet->ptr());
 
-          // Replace old packet with new packet that will have additional
-          // extension headers.
-          packet = newPacket;
-        }
-      }
-
-      EventWriteOrtcRtpSenderChannelSendOutgoingPacket(__func__, mID, sender->getID(), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
-
-      return sender->sendPacket(packet);
+      return sender->sendPacket(std::move(packet));
     }
 
     //-------------------------------------------------------------------------
@@ -471,7 +419,7 @@ namespace ortc
       auto sender = mSender.lock();
       if (!sender) return false;
 
-      EventWriteOrtcRtpSenderChannelSendOutgoingPacket(__func__, mID, sender->getID(), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->buffer()->SizeInBytes()), packet->buffer()->BytePtr());
+      EventWriteOrtcRtpSenderChannelSendOutgoingPacket(__func__, mID, sender->getID(), zsLib::to_underlying(IICETypes::Component_RTCP), SafeInt<unsigned int>(packet->size()), packet->ptr());
 
       if ((mIsTagging) &&
           (mTagSDES))
@@ -510,7 +458,7 @@ namespace ortc
           }
         }
 
-        RTCPPacketPtr newPacket(RTCPPacket::create(packet->first()));
+        RTCPPacketPtr newPacket(RTCPPacket::create(packet->first(), mPacketHeadroom, mPacketTailroom));
 
         // Reset the MID/RID SDES entries to NULL on the RTCP packets to
         // prevent the packet destruction from attempting to free the faked
@@ -531,7 +479,24 @@ namespace ortc
         packet = newPacket;
       }
 
-      return sender->sendPacket(packet);
+      return sender->sendPacket(std::move(packet));
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTPSenderChannel::sendPackets(const RTPPacketList &packets)
+    {
+      auto sender = mSender.lock();
+      if (!sender) return false;
+
+      for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+        auto &packet = (*iter);
+
+        tagPacket(packet);
+
+        EventWriteOrtcRtpSenderChannelSendOutgoingPacket(__func__, mID, sender->getID(), zsLib::to_underlying(IICETypes::Component_RTP), SafeInt<unsigned int>(packet->size()), packet->ptr());
+      }
+
+      return sender->sendPackets(packets);
     }
 
     //-------------------------------------------------------------------------
@@ -924,6 +889,60 @@ namespace ortc
       mIsTagging = mMuxID.hasData() || mRID.hasData();
     }
     
+    //-------------------------------------------------------------------------
+    void RTPSenderChannel::tagPacket(RTPPacketPtr packet)
+    {
+      if (!mIsTagging) return;
+
+      Time tick = zsLib::now();
+
+      AutoRecursiveLock lock(*this);
+
+      TaggingInfoPtr tagInfo;
+
+      auto found = mTaggings.find(packet->ssrc());
+      if (found == mTaggings.end()) {
+        tagInfo = make_shared<TaggingInfo>();
+        mTaggings[packet->ssrc()] = tagInfo;
+      } else {
+        tagInfo = (*found).second;
+      }
+
+      if (tagInfo->mLastSentPacket + mRetagAfterInSeconds < tick) {
+        tagInfo->mReceiverAck = false;
+        tagInfo->mSequenceNumberFirst = packet->sequenceNumber();
+      }
+      tagInfo->mLastSentPacket = tick;
+      if (!tagInfo->mReceiverAck) {
+        tagInfo->mSequenceNumberLast = packet->sequenceNumber();
+
+        auto oldHeaderExtensions = packet->firstHeaderExtension();
+
+        RTPPacket::StringHeaderExtension muxHeader(mMuxHeader ? mMuxHeader->mID : 0, mMuxID.c_str());
+        RTPPacket::StringHeaderExtension ridHeader(mRIDHeader ? mRIDHeader->mID : 0, mRID.c_str());
+
+        // Chain the MuxID or RID or both in front of the existing extension
+        // headers.
+        RTPPacket::HeaderExtension *firstExtension = NULL;
+        if (mMuxID.hasData()) {
+          if (mRID.hasData()) {
+            muxHeader.mNext = &ridHeader;
+            ridHeader.mNext = oldHeaderExtensions;
+          } else {
+            muxHeader.mNext = oldHeaderExtensions;
+          }
+          firstExtension = &muxHeader;
+        } else {
+          ridHeader.mNext = oldHeaderExtensions;
+          firstExtension = &ridHeader;
+        }
+
+        // Rewritten in place (using the packet's headroom) rather than
+        // regenerating the whole packet into a new buffer.
+        packet->changeHeaderExtensions(firstExtension);
+      }
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -142,7 +142,9 @@ namespace ortc
       SharedRecursiveLock(SharedRecursiveLock::create()),
       mSenderChannel(senderChannel),
       mTrack(track),
-      mParameters(make_shared<Parameters>(params))
+      mParameters(make_shared<Parameters>(params)),
+      mPacketHeadroom(UseSettings::getUInt(ORTC_SETTING_RTP_PACKET_RESERVED_HEADROOM_IN_BYTES)),
+      mPacketTailroom(UseSettings::getUInt(ORTC_SETTING_RTP_PACKET_RESERVED_TAILROOM_IN_BYTES))
     {
       ZS_LOG_DETAIL(debug("created"))
 
@@ -435,7 +437,7 @@ namespace ortc
     {
       auto channel = mSenderChannel.lock();
       if (!channel) return false;
-      return channel->sendPacket(RTPPacket::create(packet, length));
+      return channel->sendPacket(RTPPacket::create(packet, length, mPacketHeadroom, mPacketTailroom));
     }
     
     //-------------------------------------------------------------------------
@@ -443,7 +445,7 @@ namespace ortc
     {
       auto channel = mSenderChannel.lock();
       if (!channel) return false;
-      return channel->sendPacket(RTCPPacket::create(packet, length));
+      return channel->sendPacket(RTCPPacket::create(packet, length, mPacketHeadroom, mPacketTailroom));
     }
 
     //-------------------------------------------------------------------------
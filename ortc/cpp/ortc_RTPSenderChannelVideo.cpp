@@ -88,7 +88,8 @@ namespace ortc
     //-------------------------------------------------------------------------
     void IRTPSenderChannelVideoForSettings::applyDefaults()
     {
-//      UseSettings::setUInt(ORTC_SETTING_SCTP_TRANSPORT_MAX_MESSAGE_SIZE, 5*1024);
+      UseSettings::setUInt(ORTC_SETTING_RTP_SENDER_CHANNEL_VIDEO_MAX_BURST_PACKETS, 16);
+      UseSettings::setUInt(ORTC_SETTING_RTP_SENDER_CHANNEL_VIDEO_MAX_BURST_HOLD_IN_MILLISECONDS, 5);
     }
 
     //-------------------------------------------------------------------------
@@ -141,11 +142,17 @@ namespace ortc
       SharedRecursiveLock(SharedRecursiveLock::create()),
       mSenderChannel(senderChannel),
       mTrack(track),
-      mParameters(make_shared<Parameters>(params))
+      mParameters(make_shared<Parameters>(params)),
+      mPacketHeadroom(UseSettings::getUInt(ORTC_SETTING_RTP_PACKET_RESERVED_HEADROOM_IN_BYTES)),
+      mPacketTailroom(UseSettings::getUInt(ORTC_SETTING_RTP_PACKET_RESERVED_TAILROOM_IN_BYTES)),
+      mMaxBurstPackets(UseSettings::getUInt(ORTC_SETTING_RTP_SENDER_CHANNEL_VIDEO_MAX_BURST_PACKETS)),
+      mMaxBurstHold(UseSettings::getUInt(ORTC_SETTING_RTP_SENDER_CHANNEL_VIDEO_MAX_BURST_HOLD_IN_MILLISECONDS))
     {
       ZS_LOG_DETAIL(debug("created"))
 
       ORTC_THROW_INVALID_PARAMETERS_IF(!senderChannel)
+
+      updateBurstPayloadTypes(params);
     }
 
     //-------------------------------------------------------------------------
@@ -357,6 +364,31 @@ namespace ortc
     {
       ZS_LOG_DEBUG(log("timer") + ZS_PARAM("timer id", timer->getID()))
 
+      RTPPacketList expiredBurst;
+
+      {
+        AutoLock lock(mBurstLock);
+        if (timer == mBurstTimer) {
+          mBurstTimer.reset();
+
+          if (mPendingBurst.size() > 0) {
+            Time expires = mPendingBurstStarted + mMaxBurstHold;
+            if (zsLib::now() < expires) {
+              // the burst expiring was sent and a newer burst started since
+              mBurstTimer = Timer::create(mThisWeak.lock(), expires);
+            } else {
+              ZS_LOG_TRACE(log("sending burst whose end was not seen") + ZS_PARAM("packets", mPendingBurst.size()))
+              expiredBurst.swap(mPendingBurst);
+            }
+          }
+        }
+      }
+
+      if (expiredBurst.size() > 0) {
+        sendBurst(expiredBurst);
+        return;
+      }
+
       AutoRecursiveLock lock(*this);
 #define TODO 1
 #define TODO 2
@@ -412,6 +444,11 @@ namespace ortc
         channelResource = mChannelResource;
       }
 
+      {
+        AutoLock lock(mBurstLock);
+        updateBurstPayloadTypes(*params);
+      }
+
       if (channelResource)
         channelResource->notifyUpdate(params);
     }
@@ -431,9 +468,67 @@ namespace ortc
                                         const webrtc::PacketOptions& options
                                         )
     {
-      auto channel = mSenderChannel.lock();
-      if (!channel) return false;
-      return channel->sendPacket(RTPPacket::create(packet, length));
+      auto rtpPacket = RTPPacket::create(packet, length, mPacketHeadroom, mPacketTailroom);
+
+      if (mMaxBurstPackets < 2) {
+        auto channel = mSenderChannel.lock();
+        if (!channel) return false;
+        return channel->sendPacket(std::move(rtpPacket));
+      }
+
+      RTPPacketList previousFrame;
+      RTPPacketList completedFrame;
+
+      // the marker bit ends the frame's packet burst; padding only packets
+      // are never part of a frame so they are not held back
+      bool endsBurst = ((rtpPacket->m()) ||
+                        (0 == rtpPacket->payloadSize()));
+
+      {
+        AutoLock lock(mBurstLock);
+
+        if (!canHoldInBurst(*rtpPacket)) {
+          // retransmissions (RTX or NACK) and FEC packets are sent right away
+          // and leave any burst being held untouched
+          completedFrame.push_back(std::move(rtpPacket));
+          goto send_burst;
+        }
+
+        if (mPendingBurst.size() > 0) {
+          auto &first = mPendingBurst.front();
+          if ((first->ssrc() != rtpPacket->ssrc()) ||
+              (first->timestamp() != rtpPacket->timestamp())) {
+            // a different stream or frame started without the marker bit
+            // having been seen, send what is held
+            previousFrame.swap(mPendingBurst);
+          }
+        }
+
+        if (mPendingBurst.size() < 1) {
+          mPendingBurstStarted = zsLib::now();
+        }
+
+        // the burst holds the only reference thus it can be protected in place
+        mPendingBurst.push_back(std::move(rtpPacket));
+
+        if ((endsBurst) ||
+            (mPendingBurst.size() >= mMaxBurstPackets)) {
+          completedFrame.swap(mPendingBurst);
+          goto send_burst;
+        }
+
+        // a frame whose marker bit is lost (or never set) is not held
+        // longer than the maximum burst hold
+        if (!mBurstTimer) {
+          mBurstTimer = Timer::create(mThisWeak.lock(), mPendingBurstStarted + mMaxBurstHold);
+        }
+      }
+
+    send_burst:
+      {
+        bool result = sendBurst(previousFrame);
+        return sendBurst(completedFrame) && result;
+      }
     }
 
     //-------------------------------------------------------------------------
@@ -441,7 +536,7 @@ namespace ortc
     {
       auto channel = mSenderChannel.lock();
       if (!channel) return false;
-      return channel->sendPacket(RTCPPacket::create(packet, length));
+      return channel->sendPacket(RTCPPacket::create(packet, length, mPacketHeadroom, mPacketTailroom));
     }
 
     //-------------------------------------------------------------------------
@@ -668,6 +763,16 @@ namespace ortc
       mChannelResource.reset();
       mCloseChannelPromise.reset();
 
+      {
+        AutoLock lock(mBurstLock);
+        mPendingBurst.clear();
+
+        if (mBurstTimer) {
+          mBurstTimer->cancel();
+          mBurstTimer.reset();
+        }
+      }
+
       // make sure to cleanup any final reference to self
       mGracefulShutdownReference.reset();
     }
@@ -706,6 +811,71 @@ namespace ortc
       ZS_LOG_WARNING(Detail, debug("error set") + ZS_PARAM("error", mLastError) + ZS_PARAM("reason", mLastErrorReason))
     }
 
+    //-------------------------------------------------------------------------
+    bool RTPSenderChannelVideo::sendBurst(RTPPacketList &packets)
+    {
+      if (packets.size() < 1) return true;
+
+      auto channel = mSenderChannel.lock();
+      if (!channel) return false;
+
+      if (1 == packets.size()) return channel->sendPacket(std::move(packets.front()));
+
+      return channel->sendPackets(packets);
+    }
+
+    //-------------------------------------------------------------------------
+    void RTPSenderChannelVideo::updateBurstPayloadTypes(const Parameters &params)
+    {
+      mBurstMediaPayloadTypes.clear();
+      mBurstREDPayloadTypes.clear();
+
+      for (auto iter = params.mCodecs.begin(); iter != params.mCodecs.end(); ++iter) {
+        auto &codec = (*iter);
+
+        auto supportedCodec = IRTPTypes::toSupportedCodec(codec.mName);
+        if (IRTPTypes::SupportedCodec_RED == supportedCodec) {
+          mBurstREDPayloadTypes.insert(codec.mPayloadType);
+          continue;
+        }
+
+        switch (IRTPTypes::getCodecKind(supportedCodec)) {
+          case IRTPTypes::CodecKind_Video:
+          case IRTPTypes::CodecKind_AV:     mBurstMediaPayloadTypes.insert(codec.mPayloadType); break;
+          default:                          break;
+        }
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    bool RTPSenderChannelVideo::canHoldInBurst(const RTPPacket &packet)
+    {
+      // only media packets of a new frame are held; RTX and FEC have payload
+      // types of their own (or FEC is wrapped inside RED) and a NACK
+      // retransmission on the media SSRC repeats an older sequence number
+      PayloadType pt = packet.pt();
+
+      if (mBurstREDPayloadTypes.end() != mBurstREDPayloadTypes.find(pt)) {
+        if (packet.payloadSize() < 1) return false;
+        pt = static_cast<PayloadType>((packet.payload())[0] & 0x7F);
+      }
+
+      if (mBurstMediaPayloadTypes.end() == mBurstMediaPayloadTypes.find(pt)) return false;
+
+      WORD sequenceNumber = packet.sequenceNumber();
+
+      auto found = mBurstLastSequenceNumbers.find(packet.ssrc());
+      if (found != mBurstLastSequenceNumbers.end()) {
+        WORD diff = static_cast<WORD>(sequenceNumber - (*found).second);
+        if ((0 == diff) || (diff >= 0x8000)) return false;
+        (*found).second = sequenceNumber;
+        return true;
+      }
+
+      mBurstLastSequenceNumbers[packet.ssrc()] = sequenceNumber;
+      return true;
+    }
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
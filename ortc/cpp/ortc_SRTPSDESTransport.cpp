@@ -342,6 +342,31 @@ namespace ortc
       return mSRTPTransport->sendPacket(sendOverICETransport, packetType, buffer, bufferLengthInBytes);
     }
 
+    //-------------------------------------------------------------------------
+    bool SRTPSDESTransport::sendPacketInPlace(
+                                              IICETypes::Components sendOverICETransport,
+                                              IICETypes::Components packetType,
+                                              BYTE *buffer,
+                                              size_t bufferLengthInBytes,
+                                              size_t bufferTailroomInBytes
+                                              )
+    {
+      ZS_LOG_TRACE(log("sending packet in place") + ZS_PARAM("send over transport", IICETypes::toString(sendOverICETransport)) + ZS_PARAM("packet type", IICETypes::toString(packetType)) + ZS_PARAM("length", bufferLengthInBytes) + ZS_PARAM("tailroom", bufferTailroomInBytes))
+
+      return mSRTPTransport->sendPacketInPlace(sendOverICETransport, packetType, buffer, bufferLengthInBytes, bufferTailroomInBytes);
+    }
+
+    //-------------------------------------------------------------------------
+    bool SRTPSDESTransport::sendPackets(
+                                        IICETypes::Components sendOverICETransport,
+                                        const ISecureTransportTypes::OutgoingPacketList &packets
+                                        )
+    {
+      ZS_LOG_TRACE(log("sending packet burst") + ZS_PARAM("send over transport", IICETypes::toString(sendOverICETransport)) + ZS_PARAM("total", packets.size()))
+
+      return mSRTPTransport->sendPackets(sendOverICETransport, packets);
+    }
+
     //-------------------------------------------------------------------------
     IICETransportPtr SRTPSDESTransport::getICETransport() const
     {
@@ -367,6 +392,7 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool SRTPSDESTransport::handleReceivedPacket(
                                                  IICETypes::Components viaTransport,
+                                                 PacketDemux::PacketTypes packetType,
                                                  const BYTE *buffer,
                                                  size_t bufferLengthInBytes
                                                  )
@@ -378,9 +404,14 @@ namespace ortc
         return false;
       }
 
+      if (!PacketDemux::isMedia(packetType)) {
+        ZS_LOG_WARNING(Debug, log("received non RTP/RTCP packet (thus discarding)") + ZS_PARAM("packet type", PacketDemux::toString(packetType)) + ZS_PARAM("length", bufferLengthInBytes))
+        return false;
+      }
+
       ZS_LOG_INSANE(log("forwarding packet to SRTP transport") + ZS_PARAM("srtp transport id", mSRTPTransport->getID()) + ZS_PARAM("via", IICETypes::toString(viaTransport)) + ZS_PARAM("buffer length", bufferLengthInBytes))
 
-      return mSRTPTransport->handleReceivedPacket(viaTransport, buffer, bufferLengthInBytes);
+      return mSRTPTransport->handleReceivedPacket(viaTransport, packetType, buffer, bufferLengthInBytes);
     }
 
     //-------------------------------------------------------------------------
@@ -436,6 +467,26 @@ namespace ortc
       return transport->sendPacket(buffer, bufferLengthInBytes);
     }
 
+    //-------------------------------------------------------------------------
+    bool SRTPSDESTransport::sendEncryptedPackets(
+                                                 IICETypes::Components sendOverICETransport,
+                                                 const ISecureTransportTypes::EncryptedPacketList &packets
+                                                 )
+    {
+      if (isShutdown()) {
+        ZS_LOG_WARNING(Debug, log("cannot send packets on shutdown transport"))
+        return false;
+      }
+
+      UseICETransportPtr transport = (IICETypes::Component_RTP == sendOverICETransport ? mICETransportRTP : fixRTCPTransport());
+      if (!transport) {
+        ZS_LOG_WARNING(Debug, log("no ice transport is attached") + ZS_PARAM("send over transport", IICETypes::toString(sendOverICETransport)) + ZS_PARAM("total", packets.size()))
+        return false;
+      }
+
+      return transport->sendPackets(sendOverICETransport, packets);
+    }
+
     //-------------------------------------------------------------------------
     bool SRTPSDESTransport::handleReceivedDecryptedPacket(
                                                           IICETypes::Components viaTransport,
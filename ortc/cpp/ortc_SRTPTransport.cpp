@@ -30,9 +30,9 @@
  */
 
 #include <ortc/internal/ortc_SRTPTransport.h>
+#include <ortc/internal/ortc_BufferPool.h>
 #include <ortc/internal/ortc_DTLSTransport.h>
 #include <ortc/internal/ortc_Helper.h>
-#include <ortc/internal/ortc_RTPUtils.h>
 #include <ortc/internal/ortc_ORTC.h>
 #include <ortc/internal/ortc_Tracing.h>
 #include <ortc/internal/platform.h>
@@ -78,6 +78,7 @@ namespace ortc
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
   ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHTTP, UseHTTP)
   ZS_DECLARE_TYPEDEF_PTR(ortc::internal::Helper, UseHelper)
+  ZS_DECLARE_TYPEDEF_PTR(ortc::internal::BufferPool, UseBufferPool)
 
   typedef openpeer::services::Hasher<CryptoPP::SHA1> SHA1Hasher;
 
@@ -628,13 +629,15 @@ namespace ortc
     //-------------------------------------------------------------------------
     bool SRTPTransport::handleReceivedPacket(
                                              IICETypes::Components viaTransport,
+                                             PacketDemux::PacketTypes packetType,
                                              const BYTE *buffer,
                                              size_t bufferLengthInBytes
                                              )
     {
       UseSecureTransportPtr transport;
       SecureByteBlockPtr decryptedBuffer;
-      IICETypes::Components component = (RTPUtils::isRTCPPacketType(buffer, bufferLengthInBytes) ? IICETypes::Component_RTCP : IICETypes::Component_RTP);
+      size_t decryptedBufferSize {};
+      IICETypes::Components component = PacketDemux::toComponent(packetType);
 
       EventWriteOrtcSrtpTransportReceivedIncomingEncryptedPacket(__func__, mID, zsLib::to_underlying(viaTransport), zsLib::to_underlying(component), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
 
@@ -741,7 +744,8 @@ namespace ortc
         // As part of the decryption process, the MKI value must be stripped from
         // the packet. This is done by selectively copying from the source packet
         // to the decryptedBuffer (which is not yet decrypted).
-        decryptedBuffer = make_shared<SecureByteBlock>(bufferLengthInBytes - material.mMKILength);
+        decryptedBufferSize = bufferLengthInBytes - material.mMKILength;
+        decryptedBuffer = UseBufferPool::allocate(decryptedBufferSize);
 
         size_t headerAndPayloadSize = bufferLengthInBytes - authenticationTagLength - material.mMKILength;
 
@@ -755,7 +759,9 @@ namespace ortc
       } else {
         // nothing fancy here, just copy the source packet into the decrypted
         // buffer and prepare for decryption
-        decryptedBuffer = make_shared<SecureByteBlock>(buffer, bufferLengthInBytes);
+        decryptedBufferSize = bufferLengthInBytes;
+        decryptedBuffer = UseBufferPool::allocate(decryptedBufferSize);
+        memcpy(decryptedBuffer->BytePtr(), buffer, bufferLengthInBytes);
       }
 
 
@@ -768,7 +774,7 @@ namespace ortc
       {
         if (!((bool)(usedKeys[loop]))) continue;
 
-        out_len = SafeInt<decltype(out_len)>(decryptedBuffer->SizeInBytes());
+        out_len = SafeInt<decltype(out_len)>(decryptedBufferSize);
 
         // scope: lock the keying material with its own individual lock
         {
@@ -826,9 +832,9 @@ namespace ortc
       ASSERT(((bool)decryptedBuffer))
       ASSERT(out_len > 0)
 
-      ASSERT(out_len <= SafeInt<decltype(out_len)>(decryptedBuffer->SizeInBytes()))
+      ASSERT(out_len <= SafeInt<decltype(out_len)>(decryptedBufferSize))
 
-      ZS_LOG_INSANE(log("forwarding packet to secure transport") + ZS_PARAM("via", IICETypes::toString(viaTransport)) + ZS_PARAM("component", IICETypes::toString(component)) + ZS_PARAM("buffer length in bytes", decryptedBuffer->SizeInBytes()))
+      ZS_LOG_INSANE(log("forwarding packet to secure transport") + ZS_PARAM("via", IICETypes::toString(viaTransport)) + ZS_PARAM("component", IICETypes::toString(component)) + ZS_PARAM("buffer length in bytes", decryptedBufferSize))
 
       EventWriteOrtcSrtpTransportDeliverIncomingDecryptedPacket(__func__, mID, transport->getID(), zsLib::to_underlying(viaTransport), zsLib::to_underlying(component), SafeInt<size_t>(out_len), decryptedBuffer->BytePtr());
       return transport->handleReceivedDecryptedPacket(viaTransport, component, decryptedBuffer->BytePtr(), SafeInt<size_t>(out_len));
@@ -844,107 +850,66 @@ namespace ortc
     {
       EventWriteOrtcSrtpTransportSendOutgoingPacketAndEncrypt(__func__, mID, zsLib::to_underlying(sendOverICETransport), zsLib::to_underlying(packetType), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
 
-      UseSecureTransportPtr transport;
-      KeyingMaterialPtr keyingMaterial;
+      return protectAndSendPacket(sendOverICETransport, packetType, buffer, NULL, bufferLengthInBytes, 0);
+    }
 
-      SecureByteBlockPtr encryptedBuffer;
+    //-------------------------------------------------------------------------
+    bool SRTPTransport::sendPacketInPlace(
+                                          IICETypes::Components sendOverICETransport,
+                                          IICETypes::Components packetType,  // is packet RTP or RTCP
+                                          BYTE *buffer,
+                                          size_t bufferLengthInBytes,
+                                          size_t bufferTailroomInBytes
+                                          )
+    {
+      EventWriteOrtcSrtpTransportSendOutgoingPacketAndEncrypt(__func__, mID, zsLib::to_underlying(sendOverICETransport), zsLib::to_underlying(packetType), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
 
-      DirectionMaterial &material = mMaterial[Direction_Encrypt]; // WARNING: only some values are accessible outside a lock
+      return protectAndSendPacket(sendOverICETransport, packetType, buffer, buffer, bufferLengthInBytes, bufferTailroomInBytes);
+    }
 
+    //-------------------------------------------------------------------------
+    bool SRTPTransport::sendPackets(
+                                    IICETypes::Components sendOverICETransport,
+                                    const ISecureTransportTypes::OutgoingPacketList &packets
+                                    )
+    {
+      UseSecureTransportPtr transport;
 
-      //lbojan fix for SRTCP packet lenght
-      size_t authenticationTagLength  {0};// = material.mAuthenticationTagLength[packetType];
-      packetType == IICETypes::Component_RTP ? (authenticationTagLength = material.mAuthenticationTagLength[packetType]) : (authenticationTagLength = material.mAuthenticationTagLength[packetType] + 4);
+      ISecureTransportTypes::EncryptedPacketList encryptedPackets;
+      std::vector<SecureByteBlockPtr> copiedBuffers;  // keeps copied packets alive until sent
 
-      {
-        AutoRecursiveLock lock(*this);
+      encryptedPackets.reserve(packets.size());
 
-        if (0 == mLastRemainingOverallPercentageReported) {
-          ZS_LOG_WARNING(Detail, log("cannot encrypt packet as packet lifetime is exhausted"))
-          return false;
-        }
+      bool result = true;
 
-        transport = mSecureTransport.lock();
-        if (!transport) {
-          ZS_LOG_WARNING(Debug, log("nowhere to send packet as secure transport is gone"))
-          return false;
-        }
-
-        while (true) {
-          if (material.mKeyList.size() < 1) {
-            ZS_LOG_WARNING(Debug, log("no more keying material is present (all lifetimes are exhausted)") + material.toDebug())
-            return false;
-          }
+      for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+        auto &packet = (*iter);
 
-          keyingMaterial = material.mKeyList.front();
+        EventWriteOrtcSrtpTransportSendOutgoingPacketAndEncrypt(__func__, mID, zsLib::to_underlying(sendOverICETransport), zsLib::to_underlying(packet.mPacketType), SafeInt<unsigned int>(packet.mSize), packet.mBuffer);
 
-          ASSERT(((bool)keyingMaterial))
+        SecureByteBlockPtr encryptedBuffer;
+        BYTE *encryptedPtr {};
+        size_t encryptedBufferSize {};
 
-          if (keyingMaterial->mTotalPackets[packetType] + 1 > keyingMaterial->mLifetime) {
-            ZS_LOG_WARNING(Debug, log("cannot use keying material as it's lifetime is exhausted") + keyingMaterial->toDebug())
-            material.mKeyList.pop_front();
-            continue; // try another key
-          }
-
-          break;
+        if (!protectPacket(packet.mPacketType, packet.mBuffer, packet.mWritableBuffer, packet.mSize, packet.mTailroom, transport, encryptedBuffer, encryptedPtr, encryptedBufferSize)) {
+          result = false;
+          continue;
         }
 
-        updateTotalPackets(Direction_Encrypt, packetType, keyingMaterial);
-      }
-
-      // Encrypted buffer must include enough room for the full packet and the
-      // MKI and authentication tag.
-      encryptedBuffer = make_shared<SecureByteBlock>(bufferLengthInBytes + authenticationTagLength + material.mMKILength);
-
-      memcpy(encryptedBuffer->BytePtr(), buffer, bufferLengthInBytes);
+        if (encryptedBuffer) copiedBuffers.push_back(encryptedBuffer);
 
-      // lib srtp does not understand MKI thus we need to tell it the
-      // space available for the packet without including the additional MKI
-      // field...
-      //size_t libSRTPMaxLength = bufferLengthInBytes + authenticationTagLength;
-
-      int out_len {static_cast<int>(bufferLengthInBytes)};
-      int err {};
-
-      // scope: lock the keying material with its own individual lock
-      {
-        AutoLock lock(keyingMaterial->mSRTPSessionLock);
-        err = (packetType == IICETypes::Component_RTP ? srtp_protect(keyingMaterial->mSRTPSession, encryptedBuffer->BytePtr(), &out_len) :
-                                                        srtp_protect_rtcp(keyingMaterial->mSRTPSession, encryptedBuffer->BytePtr(), &out_len));
-
-        //uint32 ssrc;
-        //if (GetRtpSsrc(p, in_len, &ssrc)) {
-        //    srtp_stat_->AddProtectRtpResult(ssrc, err);
-        //}
-      }
-
-      if (err != err_status_ok) {
-        ZS_LOG_WARNING(Debug, log("cannot use current keying material for encryption") + keyingMaterial->toDebug())
-        return false;
-      }
-
-      if (material.mMKILength > 0) {
-        // Need to make room for the MKI by moving the authentication tag
-        // after the spot where the MKI is to be inserted. Once moved then
-        // the MKI value from the keying material can be copied into the
-        // packet's MKI location.
-        const BYTE *sourceAuthentication = &(encryptedBuffer->BytePtr()[bufferLengthInBytes]);
-        BYTE *destAuthentication = &(encryptedBuffer->BytePtr()[bufferLengthInBytes + material.mMKILength]);
-        BYTE *packetMKI = &(encryptedBuffer->BytePtr()[bufferLengthInBytes]);
-
-        memmove(destAuthentication, sourceAuthentication, authenticationTagLength);   // must use a memmove not a memcpy incase the source/dest buffers overlap
-        memcpy(packetMKI, keyingMaterial->mMKIValue->BytePtr(), material.mMKILength);
+        UDPBatchSender::Packet encrypted;
+        encrypted.mBuffer = encryptedPtr;
+        encrypted.mSize = encryptedBufferSize;
+        encryptedPackets.push_back(encrypted);
       }
 
+      if (encryptedPackets.size() < 1) return result;
 
       ASSERT(((bool)transport))
-      ASSERT(((bool)encryptedBuffer))
-
-      ASSERT(out_len <= SafeInt<decltype(out_len)>(encryptedBuffer->SizeInBytes()))
 
       // do NOT call this method from within a lock
-      EventWriteOrtcSrtpTransportSendOutgoingEncryptedPacketViaSecureTransport(__func__, mID, transport->getID(), zsLib::to_underlying(sendOverICETransport), zsLib::to_underlying(packetType), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
-      return transport->sendEncryptedPacket(sendOverICETransport, packetType, encryptedBuffer->BytePtr(), encryptedBuffer->SizeInBytes());
+      return transport->sendEncryptedPackets(sendOverICETransport, encryptedPackets) && result;
     }
 
     //-------------------------------------------------------------------------
@@ -1099,6 +1064,157 @@ namespace ortc
       }
     }
 
+    //-------------------------------------------------------------------------
+    bool SRTPTransport::protectAndSendPacket(
+                                             IICETypes::Components sendOverICETransport,
+                                             IICETypes::Components packetType,  // is packet RTP or RTCP
+                                             const BYTE *buffer,
+                                             BYTE *writableBuffer,
+                                             size_t bufferLengthInBytes,
+                                             size_t bufferTailroomInBytes
+                                             )
+    {
+      UseSecureTransportPtr transport;
+      SecureByteBlockPtr encryptedBuffer;
+      BYTE *encryptedPtr {};
+      size_t encryptedBufferSize {};
+
+      if (!protectPacket(packetType, buffer, writableBuffer, bufferLengthInBytes, bufferTailroomInBytes, transport, encryptedBuffer, encryptedPtr, encryptedBufferSize)) return false;
+
+      // do NOT call this method from within a lock
+      EventWriteOrtcSrtpTransportSendOutgoingEncryptedPacketViaSecureTransport(__func__, mID, transport->getID(), zsLib::to_underlying(sendOverICETransport), zsLib::to_underlying(packetType), SafeInt<unsigned int>(bufferLengthInBytes), buffer);
+      return transport->sendEncryptedPacket(sendOverICETransport, packetType, encryptedPtr, encryptedBufferSize);
+    }
+
+    //-------------------------------------------------------------------------
+    bool SRTPTransport::protectPacket(
+                                      IICETypes::Components packetType,  // is packet RTP or RTCP
+                                      const BYTE *buffer,
+                                      BYTE *writableBuffer,
+                                      size_t bufferLengthInBytes,
+                                      size_t bufferTailroomInBytes,
+                                      UseSecureTransportPtr &outTransport,
+                                      SecureByteBlockPtr &outEncryptedBuffer,
+                                      BYTE * &outEncryptedPtr,
+                                      size_t &outEncryptedSizeInBytes
+                                      )
+    {
+      UseSecureTransportPtr transport;
+      KeyingMaterialPtr keyingMaterial;
+
+      SecureByteBlockPtr encryptedBuffer;
+      size_t encryptedBufferSize {};
+
+      DirectionMaterial &material = mMaterial[Direction_Encrypt]; // WARNING: only some values are accessible outside a lock
+
+
+      //lbojan fix for SRTCP packet lenght
+      size_t authenticationTagLength  {0};// = material.mAuthenticationTagLength[packetType];
+      packetType == IICETypes::Component_RTP ? (authenticationTagLength = material.mAuthenticationTagLength[packetType]) : (authenticationTagLength = material.mAuthenticationTagLength[packetType] + 4);
+
+      {
+        AutoRecursiveLock lock(*this);
+
+        if (0 == mLastRemainingOverallPercentageReported) {
+          ZS_LOG_WARNING(Detail, log("cannot encrypt packet as packet lifetime is exhausted"))
+          return false;
+        }
+
+        transport = mSecureTransport.lock();
+        if (!transport) {
+          ZS_LOG_WARNING(Debug, log("nowhere to send packet as secure transport is gone"))
+          return false;
+        }
+
+        while (true) {
+          if (material.mKeyList.size() < 1) {
+            ZS_LOG_WARNING(Debug, log("no more keying material is present (all lifetimes are exhausted)") + material.toDebug())
+            return false;
+          }
+
+          keyingMaterial = material.mKeyList.front();
+
+          ASSERT(((bool)keyingMaterial))
+
+          if (keyingMaterial->mTotalPackets[packetType] + 1 > keyingMaterial->mLifetime) {
+            ZS_LOG_WARNING(Debug, log("cannot use keying material as it's lifetime is exhausted") + keyingMaterial->toDebug())
+            material.mKeyList.pop_front();
+            continue; // try another key
+          }
+
+          break;
+        }
+
+        updateTotalPackets(Direction_Encrypt, packetType, keyingMaterial);
+      }
+
+      // Encrypted buffer must include enough room for the full packet and the
+      // MKI and authentication tag.
+      encryptedBufferSize = bufferLengthInBytes + authenticationTagLength + material.mMKILength;
+
+      // Protect directly inside the caller's buffer when the reserved
+      // tailroom can hold the MKI and authentication tag; otherwise the
+      // packet must be copied into a larger buffer first.
+      BYTE *encryptedPtr = writableBuffer;
+      if ((NULL == encryptedPtr) ||
+          (bufferTailroomInBytes < (authenticationTagLength + material.mMKILength))) {
+        encryptedBuffer = UseBufferPool::allocate(encryptedBufferSize);
+        encryptedPtr = encryptedBuffer->BytePtr();
+
+        memcpy(encryptedPtr, buffer, bufferLengthInBytes);
+      }
+
+      // lib srtp does not understand MKI thus we need to tell it the
+      // space available for the packet without including the additional MKI
+      // field...
+      //size_t libSRTPMaxLength = bufferLengthInBytes + authenticationTagLength;
+
+      int out_len {static_cast<int>(bufferLengthInBytes)};
+      int err {};
+
+      // scope: lock the keying material with its own individual lock
+      {
+        AutoLock lock(keyingMaterial->mSRTPSessionLock);
+        err = (packetType == IICETypes::Component_RTP ? srtp_protect(keyingMaterial->mSRTPSession, encryptedPtr, &out_len) :
+                                                        srtp_protect_rtcp(keyingMaterial->mSRTPSession, encryptedPtr, &out_len));
+
+        //uint32 ssrc;
+        //if (GetRtpSsrc(p, in_len, &ssrc)) {
+        //    srtp_stat_->AddProtectRtpResult(ssrc, err);
+        //}
+      }
+
+      if (err != err_status_ok) {
+        ZS_LOG_WARNING(Debug, log("cannot use current keying material for encryption") + keyingMaterial->toDebug())
+        return false;
+      }
+
+      if (material.mMKILength > 0) {
+        // Need to make room for the MKI by moving the authentication tag
+        // after the spot where the MKI is to be inserted. Once moved then
+        // the MKI value from the keying material can be copied into the
+        // packet's MKI location.
+        const BYTE *sourceAuthentication = &(encryptedPtr[bufferLengthInBytes]);
+        BYTE *destAuthentication = &(encryptedPtr[bufferLengthInBytes + material.mMKILength]);
+        BYTE *packetMKI = &(encryptedPtr[bufferLengthInBytes]);
+
+        memmove(destAuthentication, sourceAuthentication, authenticationTagLength);   // must use a memmove not a memcpy incase the source/dest buffers overlap
+        memcpy(packetMKI, keyingMaterial->mMKIValue->BytePtr(), material.mMKILength);
+      }
+
+
+      ASSERT(((bool)transport))
+      ASSERT(NULL != encryptedPtr)
+
+      ASSERT(out_len <= SafeInt<decltype(out_len)>(encryptedBufferSize))
+
+      outTransport = transport;
+      outEncryptedBuffer = encryptedBuffer;
+      outEncryptedPtr = encryptedPtr;
+      outEncryptedSizeInBytes = encryptedBufferSize;
+      return true;
+    }
+
     //-------------------------------------------------------------------------
     size_t SRTPTransport::parseLifetime(const String &lifetime) throw(InvalidParameters)
     {
@@ -0,0 +1,275 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+
+#include <ortc/internal/ortc_STUNMessageIntegrity.h>
+#include <ortc/internal/platform.h>
+
+#include <zsLib/Log.h>
+
+#include <cryptopp/crc.h>
+#include <cryptopp/misc.h>
+
+#include <cstring>
+
+
+#ifdef _DEBUG
+#define ASSERT(x) ZS_THROW_BAD_STATE_IF(!(x))
+#else
+#define ASSERT(x)
+#endif //_DEBUG
+
+
+namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
+
+namespace ortc
+{
+  namespace internal
+  {
+    static const WORD kAttributeMessageIntegrity = 0x0008;
+    static const WORD kAttributeFingerprint = 0x8028;
+    static const DWORD kFingerprintXOR = 0x5354554E;
+
+    //-------------------------------------------------------------------------
+    static WORD readWORD(const BYTE *buffer)
+    {
+      return static_cast<WORD>((static_cast<WORD>(buffer[0]) << 8) | static_cast<WORD>(buffer[1]));
+    }
+
+    //-------------------------------------------------------------------------
+    static void writeWORD(BYTE *buffer, size_t value)
+    {
+      buffer[0] = static_cast<BYTE>((value >> 8) & 0xFF);
+      buffer[1] = static_cast<BYTE>(value & 0xFF);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark STUNMessageIntegrity
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    STUNMessageIntegrity::STUNMessageIntegrity(
+                                               const make_private &,
+                                               const String &password
+                                               ) :
+      mPassword(password)
+    {
+      BYTE key[CryptoPP::SHA1::BLOCKSIZE] {};
+
+      // HMAC keys longer than the block size are first hashed down
+      if (mPassword.length() > sizeof(key)) {
+        CryptoPP::SHA1 hasher;
+        hasher.Update(reinterpret_cast<const BYTE *>(mPassword.c_str()), mPassword.length());
+        hasher.Final(key);
+      } else if (mPassword.length() > 0) {
+        memcpy(&(key[0]), mPassword.c_str(), mPassword.length());
+      }
+
+      BYTE pad[CryptoPP::SHA1::BLOCKSIZE] {};
+
+      for (size_t index = 0; index < sizeof(pad); ++index) {
+        pad[index] = key[index] ^ 0x36;
+      }
+      mInner.Update(pad, sizeof(pad));
+
+      for (size_t index = 0; index < sizeof(pad); ++index) {
+        pad[index] = key[index] ^ 0x5C;
+      }
+      mOuter.Update(pad, sizeof(pad));
+    }
+
+    //-------------------------------------------------------------------------
+    STUNMessageIntegrityPtr STUNMessageIntegrity::create(const String &password)
+    {
+      return make_shared<STUNMessageIntegrity>(make_private{}, password);
+    }
+
+    //-------------------------------------------------------------------------
+    bool STUNMessageIntegrity::isValid(
+                                       const BYTE *packet,
+                                       size_t packetSizeInBytes,
+                                       bool useFinalMessageSize,
+                                       size_t zeroPadToBlockSize
+                                       ) const
+    {
+      if (!packet) return false;
+      if (packetSizeInBytes < Size_Header) return false;
+
+      size_t messageLength = readWORD(&(packet[2]));
+      size_t end = Size_Header + messageLength;
+      if (end > packetSizeInBytes) return false;
+
+      size_t offset = Size_Header;
+      while (offset + 4 <= end) {
+        WORD type = readWORD(&(packet[offset]));
+        size_t length = readWORD(&(packet[offset + 2]));
+
+        if (kAttributeMessageIntegrity == type) {
+          if (Size_Digest != length) return false;
+          if (offset + Size_MessageIntegrityAttribute > end) return false;
+
+          size_t lengthField = (useFinalMessageSize ? messageLength : (offset - Size_Header + Size_MessageIntegrityAttribute));
+
+          BYTE digest[Size_Digest] {};
+          computeHMAC(packet, lengthField, &(packet[Size_Header]), offset - Size_Header, zeroPadToBlockSize, digest);
+          return CryptoPP::VerifyBufsEqual(digest, &(packet[offset + 4]), sizeof(digest));
+        }
+
+        offset += 4 + ((length + 3) & (~static_cast<size_t>(3)));
+      }
+
+      return false;
+    }
+
+    //-------------------------------------------------------------------------
+    SecureByteBlockPtr STUNMessageIntegrity::packetize(STUNPacketPtr packet) const
+    {
+      ZS_THROW_INVALID_ARGUMENT_IF(!packet)
+
+      // have the packet serialize every attribute except the integrity and
+      // fingerprint (which are appended here from the cached HMAC states)
+      auto credentialMechanism = packet->mCredentialMechanism;
+      bool fingerprintIncluded = packet->mFingerprintIncluded;
+
+      packet->mCredentialMechanism = STUNPacket::CredentialMechanisms_None;
+      packet->mFingerprintIncluded = false;
+
+      SecureByteBlockPtr body = packet->packetize(STUNPacket::RFC_5245_ICE);
+
+      packet->mCredentialMechanism = credentialMechanism;
+      packet->mFingerprintIncluded = fingerprintIncluded;
+
+      if (!body) return SecureByteBlockPtr();
+      if (body->SizeInBytes() < Size_Header) return SecureByteBlockPtr();
+
+      size_t bodySize = Size_Header + readWORD(&(body->BytePtr()[2]));
+      if (bodySize > body->SizeInBytes()) return SecureByteBlockPtr();
+
+      // ICE always appends a fingerprint thus strip one if it was added anyway
+      if (bodySize >= Size_Header + Size_FingerprintAttribute) {
+        const BYTE *last = &(body->BytePtr()[bodySize - Size_FingerprintAttribute]);
+        if ((kAttributeFingerprint == readWORD(last)) &&
+            (4 == readWORD(&(last[2])))) {
+          bodySize -= Size_FingerprintAttribute;
+        }
+      }
+
+      size_t totalSize = bodySize + Size_MessageIntegrityAttribute + Size_FingerprintAttribute;
+
+      // the integrity and fingerprint are written straight into the
+      // serialized message (the block is only resized when the packet did
+      // not already leave exactly that much room after the body)
+      if (body->SizeInBytes() != totalSize) {
+        body->resize(totalSize);
+      }
+      BYTE *output = body->BytePtr();
+
+      size_t lengthField = bodySize - Size_Header + Size_MessageIntegrityAttribute;
+      if (packet->mOptions.mCalculateMessageIntegrityUsingFinalMessageSize) {
+        lengthField = totalSize - Size_Header;
+      }
+
+      BYTE *integrity = &(output[bodySize]);
+      writeWORD(&(integrity[0]), kAttributeMessageIntegrity);
+      writeWORD(&(integrity[2]), Size_Digest);
+      computeHMAC(output, lengthField, &(output[Size_Header]), bodySize - Size_Header, packet->mOptions.mZeroPadMessageIntegrityInputToBlockSize, &(integrity[4]));
+
+      // the fingerprint covers everything before it with the final length
+      writeWORD(&(output[2]), totalSize - Size_Header);
+
+      BYTE crc[CryptoPP::CRC32::DIGESTSIZE] {};
+      CryptoPP::CRC32 crcHasher;
+      crcHasher.Update(output, totalSize - Size_FingerprintAttribute);
+      crcHasher.Final(crc);
+
+      // CRC32 digest bytes are produced in little endian order
+      DWORD fingerprint = (static_cast<DWORD>(crc[0])) |
+                          (static_cast<DWORD>(crc[1]) << 8) |
+                          (static_cast<DWORD>(crc[2]) << 16) |
+                          (static_cast<DWORD>(crc[3]) << 24);
+      fingerprint ^= kFingerprintXOR;
+
+      BYTE *fingerprintAttribute = &(output[totalSize - Size_FingerprintAttribute]);
+      writeWORD(&(fingerprintAttribute[0]), kAttributeFingerprint);
+      writeWORD(&(fingerprintAttribute[2]), 4);
+      fingerprintAttribute[4] = static_cast<BYTE>((fingerprint >> 24) & 0xFF);
+      fingerprintAttribute[5] = static_cast<BYTE>((fingerprint >> 16) & 0xFF);
+      fingerprintAttribute[6] = static_cast<BYTE>((fingerprint >> 8) & 0xFF);
+      fingerprintAttribute[7] = static_cast<BYTE>(fingerprint & 0xFF);
+
+      return body;
+    }
+
+    //-------------------------------------------------------------------------
+    void STUNMessageIntegrity::computeHMAC(
+                                           const BYTE *header,
+                                           size_t lengthField,
+                                           const BYTE *body,
+                                           size_t bodySizeInBytes,
+                                           size_t zeroPadToBlockSize,
+                                           BYTE *outDigest
+                                           ) const
+    {
+      static const BYTE zeros[CryptoPP::SHA1::BLOCKSIZE] {};
+
+      BYTE patchedHeader[Size_Header] {};
+      memcpy(&(patchedHeader[0]), header, sizeof(patchedHeader));
+      writeWORD(&(patchedHeader[2]), lengthField);
+
+      CryptoPP::SHA1 inner(mInner);
+      inner.Update(patchedHeader, sizeof(patchedHeader));
+      if (bodySizeInBytes > 0) inner.Update(body, bodySizeInBytes);
+
+      if (zeroPadToBlockSize > 0) {
+        size_t remainder = (sizeof(patchedHeader) + bodySizeInBytes) % zeroPadToBlockSize;
+        size_t padding = (0 == remainder ? 0 : zeroPadToBlockSize - remainder);
+        while (padding > 0) {
+          size_t chunk = (padding > sizeof(zeros) ? sizeof(zeros) : padding);
+          inner.Update(zeros, chunk);
+          padding -= chunk;
+        }
+      }
+
+      BYTE innerDigest[CryptoPP::SHA1::DIGESTSIZE] {};
+      inner.Final(innerDigest);
+
+      CryptoPP::SHA1 outer(mOuter);
+      outer.Update(innerDigest, sizeof(innerDigest));
+      outer.Final(outDigest);
+    }
+
+  }
+}
@@ -31,17 +31,22 @@
 
 #include <ortc/internal/ortc_Settings.h>
 
+#include <ortc/internal/ortc_BufferPool.h>
 #include <ortc/internal/ortc_Certificate.h>
 #include <ortc/internal/ortc_DataChannel.h>
 #include <ortc/internal/ortc_DTMFSender.h>
 #include <ortc/internal/ortc_DTLSTransport.h>
 #include <ortc/internal/ortc_ICEGatherer.h>
+#include <ortc/internal/ortc_ICESharedPort.h>
 #include <ortc/internal/ortc_ICETransport.h>
 #include <ortc/internal/ortc_Identity.h>
 #include <ortc/internal/ortc_MediaDevices.h>
 #include <ortc/internal/ortc_MediaStreamTrack.h>
+#include <ortc/internal/ortc_NetworkMonitor.h>
+#include <ortc/internal/ortc_ORTC.h>
 #include <ortc/internal/ortc_RTPListener.h>
 #include <ortc/internal/ortc_RTPMediaEngine.h>
+#include <ortc/internal/ortc_RTPPacket.h>
 #include <ortc/internal/ortc_RTPReceiver.h>
 #include <ortc/internal/ortc_RTPReceiverChannel.h>
 #include <ortc/internal/ortc_RTPReceiverChannelAudio.h>
@@ -53,8 +58,11 @@
 #include <ortc/internal/ortc_StatsReport.h>
 #include <ortc/internal/ortc_SCTPTransport.h>
 #include <ortc/internal/ortc_SCTPTransportListener.h>
+#include <ortc/internal/ortc_SocketReactor.h>
 #include <ortc/internal/ortc_SRTPTransport.h>
 #include <ortc/internal/ortc_SRTPSDESTransport.h>
+#include <ortc/internal/ortc_TCPFraming.h>
+#include <ortc/internal/ortc_UDPBatch.h>
 
 #include <openpeer/services/IHelper.h>
 #include <openpeer/services/ISettings.h>
@@ -160,17 +168,22 @@ namespace ortc
     {
       UseServicesSettings::applyDefaults();
 
+      IBufferPoolForSettings::applyDefaults();
       ICertificateForSettings::applyDefaults();
       IDataChannelForSettings::applyDefaults();
       IDTMFSenderForSettings::applyDefaults();
       IDTLSTransportForSettings::applyDefaults();
       IICEGathererForSettings::applyDefaults();
+      IICESharedPortForSettings::applyDefaults();
       IICETransportForSettings::applyDefaults();
       IIdentityForSettings::applyDefaults();
       IMediaDevicesForSettings::applyDefaults();
       IMediaStreamTrackForSettings::applyDefaults();
+      INetworkMonitorForSettings::applyDefaults();
+      IORTCForSettings::applyDefaults();
       IRTPListenerForSettings::applyDefaults();
       IRTPMediaEngineForSettings::applyDefaults();
+      IRTPPacketForSettings::applyDefaults();
       IRTPReceiverForSettings::applyDefaults();
       IRTPReceiverChannelForSettings::applyDefaults();
       IRTPReceiverChannelAudioForSettings::applyDefaults();
@@ -182,8 +195,11 @@ namespace ortc
       IStatsReportForSettings::applyDefaults();
       ISCTPTransportForSettings::applyDefaults();
       ISCTPTransportListenerForSettings::applyDefaults();
+      ISocketReactorForSettings::applyDefaults();
       ISRTPTransportForSettings::applyDefaults();
       ISRTPSDESTransportForSettings::applyDefaults();
+      ITCPFramingForSettings::applyDefaults();
+      IUDPBatchForSettings::applyDefaults();
 
       {
         AutoRecursiveLock lock(mLock);
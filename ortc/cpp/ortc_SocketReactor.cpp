@@ -0,0 +1,660 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <ortc/internal/ortc_SocketReactor.h>
+#include <ortc/internal/platform.h>
+
+#include <openpeer/services/ISettings.h>
+#include <openpeer/services/IHelper.h>
+
+#include <zsLib/Log.h>
+#include <zsLib/Singleton.h>
+#include <zsLib/XML.h>
+
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#endif //HAVE_EPOLL
+
+#ifdef HAVE_SO_REUSEPORT
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif //HAVE_SO_REUSEPORT
+
+#include <thread>
+
+
+#ifdef _DEBUG
+#define ASSERT(x) ZS_THROW_BAD_STATE_IF(!(x))
+#else
+#define ASSERT(x)
+#endif //_DEBUG
+
+
+namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
+
+namespace ortc
+{
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+
+  namespace internal
+  {
+    // registration IDs start at 1 thus 0 identifies the loop's wake event
+    static const ULONGLONG kWakeRegistrationID = 0;
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ISocketReactorForSettings
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ISocketReactorForSettings::applyDefaults()
+    {
+      UseSettings::setBool(ORTC_SETTING_SOCKET_REACTOR_ENABLED, false);
+      UseSettings::setUInt(ORTC_SETTING_SOCKET_REACTOR_TOTAL_THREADS, 0);
+      UseSettings::setUInt(ORTC_SETTING_SOCKET_REACTOR_MAX_EVENTS_PER_WAIT, 128);
+      UseSettings::setUInt(ORTC_SETTING_SOCKET_REACTOR_UDP_SHARDS_PER_PORT, 1);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark SocketReactor::Loop
+    #pragma mark
+
+    struct SocketReactor::Loop
+    {
+      struct Registration
+      {
+        SocketPtr mSocket;
+        ISocketDelegateWeakPtr mDelegate;
+      };
+      typedef std::map<RegistrationID, Registration> RegistrationMap;
+
+      size_t mIndex {};
+
+      int mEPollFD {-1};
+      int mWakeFD {-1};
+
+      std::thread mThread;
+      std::atomic<bool> mShouldStop {false};
+
+      Lock mLock;
+      RegistrationMap mRegistrations;
+
+      std::atomic<ULONGLONG> mWakeups {};
+      std::atomic<ULONGLONG> mEvents {};
+
+      ElementPtr toDebug() const;
+    };
+
+    //-------------------------------------------------------------------------
+    ElementPtr SocketReactor::Loop::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::SocketReactor::Loop");
+
+      UseServicesHelper::debugAppend(resultEl, "index", mIndex);
+      UseServicesHelper::debugAppend(resultEl, "epoll fd", mEPollFD);
+      UseServicesHelper::debugAppend(resultEl, "wake fd", mWakeFD);
+      UseServicesHelper::debugAppend(resultEl, "should stop", mShouldStop.load());
+      UseServicesHelper::debugAppend(resultEl, "wakeups", mWakeups.load());
+      UseServicesHelper::debugAppend(resultEl, "events", mEvents.load());
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark SocketReactor
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    SocketReactor::SocketReactor(const make_private &) :
+      mTotalThreads(UseSettings::getUInt(ORTC_SETTING_SOCKET_REACTOR_TOTAL_THREADS)),
+      mMaxEventsPerWait(UseSettings::getUInt(ORTC_SETTING_SOCKET_REACTOR_MAX_EVENTS_PER_WAIT))
+    {
+      if (0 == mTotalThreads) {
+        mTotalThreads = static_cast<size_t>(std::thread::hardware_concurrency());
+      }
+      if (mTotalThreads < 1) mTotalThreads = 1;
+      if (mMaxEventsPerWait < 1) mMaxEventsPerWait = 1;
+
+      ZS_LOG_DETAIL(log("created"))
+    }
+
+    //-------------------------------------------------------------------------
+    SocketReactor::~SocketReactor()
+    {
+      mThisWeak.reset();
+
+      stopLoops();
+
+      ZS_LOG_DETAIL(log("destroyed"))
+    }
+
+    //-------------------------------------------------------------------------
+    SocketReactorPtr SocketReactor::create()
+    {
+      SocketReactorPtr pThis(make_shared<SocketReactor>(make_private{}));
+      pThis->mThisWeak = pThis;
+      return pThis;
+    }
+
+    //-------------------------------------------------------------------------
+    SocketReactorPtr SocketReactor::singleton()
+    {
+      AutoRecursiveLock lock(*UseServicesHelper::getGlobalLock());
+      static SingletonLazySharedPtr<SocketReactor> singleton(create());
+      SocketReactorPtr result = singleton.singleton();
+
+      static zsLib::SingletonManager::Register registerSingleton("ortc::SocketReactor", result);
+
+      if (!result) {
+        ZS_LOG_WARNING(Detail, slog("singleton gone"))
+      }
+
+      return result;
+    }
+
+    //-------------------------------------------------------------------------
+    bool SocketReactor::isEnabled()
+    {
+#ifdef HAVE_EPOLL
+      return UseSettings::getBool(ORTC_SETTING_SOCKET_REACTOR_ENABLED);
+#else
+      return false;
+#endif //HAVE_EPOLL
+    }
+
+    //-------------------------------------------------------------------------
+    bool SocketReactor::monitor(
+                                SocketPtr socket,
+                                ISocketDelegatePtr delegate
+                                )
+    {
+      if (!socket) return false;
+      if (!delegate) return false;
+      if (!isEnabled()) return false;
+
+      auto pThis = singleton();
+      if (!pThis) return false;
+
+      return pThis->add(socket, delegate);
+    }
+
+    //-------------------------------------------------------------------------
+    void SocketReactor::unmonitor(SocketPtr socket)
+    {
+      if (!socket) return;
+
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      pThis->remove(socket);
+    }
+
+    //-------------------------------------------------------------------------
+    void SocketReactor::monitorWriteReady(SocketPtr socket)
+    {
+      if (!socket) return;
+      if (!isEnabled()) return;
+
+      auto pThis = singleton();
+      if (!pThis) return;
+
+      pThis->armWriteReady(socket);
+    }
+
+    //-------------------------------------------------------------------------
+    bool SocketReactor::enableReusePort(SocketPtr socket)
+    {
+      if (!socket) return false;
+
+#ifdef HAVE_SO_REUSEPORT
+      int value = 1;
+      if (0 != setsockopt(static_cast<int>(socket->getSocket()), SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value))) {
+        ZS_LOG_WARNING(Detail, slog("unable to set SO_REUSEPORT on socket") + ZS_PARAM("error", errno))
+        return false;
+      }
+      return true;
+#else
+      return false;
+#endif //HAVE_SO_REUSEPORT
+    }
+
+    //-------------------------------------------------------------------------
+    SocketReactor::SocketList SocketReactor::createUDPShards(
+                                                             const IPAddress &boundIP,
+                                                             size_t total
+                                                             )
+    {
+      SocketList result;
+
+      auto createFamily = (boundIP.isIPv6() ? Socket::Create::IPv6 : Socket::Create::IPv4);
+
+      for (size_t index = 0; index < total; ++index) {
+        SocketPtr socket;
+
+        try {
+          socket = Socket::createUDP(createFamily);
+          if (!enableReusePort(socket)) break;
+
+          socket->bind(boundIP);
+          socket->setBlocking(false);
+        } catch(Socket::Exceptions::Unspecified &error) {
+          ZS_LOG_WARNING(Detail, slog("unable to bind UDP shard socket") + ZS_PARAM("ip", boundIP.string()) + ZS_PARAM("error", error.errorCode()))
+          break;
+        }
+
+        result.push_back(socket);
+      }
+
+      ZS_LOG_DEBUG(slog("created UDP shard sockets") + ZS_PARAM("ip", boundIP.string()) + ZS_PARAM("requested", total) + ZS_PARAM("created", result.size()))
+      return result;
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr SocketReactor::singletonToDebug()
+    {
+      auto pThis = singleton();
+      if (!pThis) return ElementPtr();
+      return pThis->toDebug();
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark SocketReactor => ISingletonManagerDelegate
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void SocketReactor::notifySingletonCleanup()
+    {
+      ZS_LOG_DEBUG(log("notify singleton cleanup"))
+      stopLoops();
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark SocketReactor => (internal)
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    Log::Params SocketReactor::slog(const char *message)
+    {
+      ElementPtr objectEl = Element::create("ortc::SocketReactor");
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    Log::Params SocketReactor::log(const char *message) const
+    {
+      ElementPtr objectEl = Element::create("ortc::SocketReactor");
+      UseServicesHelper::debugAppend(objectEl, "id", mID);
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr SocketReactor::toDebug() const
+    {
+      AutoLock lock(mLock);
+
+      ElementPtr resultEl = Element::create("ortc::SocketReactor");
+
+      UseServicesHelper::debugAppend(resultEl, "id", mID);
+      UseServicesHelper::debugAppend(resultEl, "total threads", mTotalThreads);
+      UseServicesHelper::debugAppend(resultEl, "max events per wait", mMaxEventsPerWait);
+      UseServicesHelper::debugAppend(resultEl, "started", mStarted);
+      UseServicesHelper::debugAppend(resultEl, "stopped", mStopped);
+      UseServicesHelper::debugAppend(resultEl, "sockets", mSockets.size());
+
+      ElementPtr loopsEl = Element::create("loops");
+      for (auto iter = mLoops.begin(); iter != mLoops.end(); ++iter) {
+        UseServicesHelper::debugAppend(loopsEl, (*iter)->toDebug());
+      }
+      UseServicesHelper::debugAppend(resultEl, loopsEl);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    bool SocketReactor::add(
+                            SocketPtr socket,
+                            ISocketDelegatePtr delegate
+                            )
+    {
+#ifdef HAVE_EPOLL
+      AutoLock lock(mLock);
+
+      if (!startLoops()) return false;
+
+      if (mSockets.end() != mSockets.find(socket.get())) {
+        ZS_LOG_WARNING(Detail, log("socket is already monitored") + ZS_PARAM("socket", socket->getSocket()))
+        return true;
+      }
+
+      size_t loopIndex = (mNextLoop++) % mLoops.size();
+      auto loop = mLoops[loopIndex];
+
+      RegistrationID registrationID = ++mLastRegistrationID;
+
+      {
+        AutoLock loopLock(loop->mLock);
+        Loop::Registration &registration = loop->mRegistrations[registrationID];
+        registration.mSocket = socket;
+        registration.mDelegate = delegate;
+      }
+
+      // a UDP socket is nearly always writable thus write readiness is only
+      // monitored when asked for (see armWriteReady)
+      epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLIN | EPOLLET;
+      event.data.u64 = registrationID;
+
+      if (0 != epoll_ctl(loop->mEPollFD, EPOLL_CTL_ADD, static_cast<int>(socket->getSocket()), &event)) {
+        int error = errno;
+        ZS_LOG_ERROR(Detail, log("unable to add socket to epoll loop") + ZS_PARAM("socket", socket->getSocket()) + ZS_PARAM("loop", loopIndex) + ZS_PARAM("error", error))
+
+        AutoLock loopLock(loop->mLock);
+        loop->mRegistrations.erase(registrationID);
+        return false;
+      }
+
+      mSockets[socket.get()] = LoopAndRegistrationPair(loopIndex, registrationID);
+
+      ZS_LOG_TRACE(log("socket monitored") + ZS_PARAM("socket", socket->getSocket()) + ZS_PARAM("loop", loopIndex) + ZS_PARAM("registration", registrationID))
+      return true;
+#else
+      return false;
+#endif //HAVE_EPOLL
+    }
+
+    //-------------------------------------------------------------------------
+    void SocketReactor::remove(SocketPtr socket)
+    {
+#ifdef HAVE_EPOLL
+      AutoLock lock(mLock);
+
+      auto found = mSockets.find(socket.get());
+      if (found == mSockets.end()) return;
+
+      size_t loopIndex = (*found).second.first;
+      RegistrationID registrationID = (*found).second.second;
+
+      mSockets.erase(found);
+
+      if (loopIndex >= mLoops.size()) return;
+
+      auto loop = mLoops[loopIndex];
+
+      if (0 != epoll_ctl(loop->mEPollFD, EPOLL_CTL_DEL, static_cast<int>(socket->getSocket()), NULL)) {
+        ZS_LOG_WARNING(Debug, log("unable to remove socket from epoll loop") + ZS_PARAM("socket", socket->getSocket()) + ZS_PARAM("loop", loopIndex) + ZS_PARAM("error", errno))
+      }
+
+      {
+        AutoLock loopLock(loop->mLock);
+        loop->mRegistrations.erase(registrationID);
+      }
+
+      ZS_LOG_TRACE(log("socket no longer monitored") + ZS_PARAM("socket", socket->getSocket()) + ZS_PARAM("loop", loopIndex))
+#endif //HAVE_EPOLL
+    }
+
+    //-------------------------------------------------------------------------
+    void SocketReactor::armWriteReady(SocketPtr socket)
+    {
+#ifdef HAVE_EPOLL
+      // held so the socket cannot be removed (and closed) while modified
+      AutoLock lock(mLock);
+
+      auto found = mSockets.find(socket.get());
+      if (found == mSockets.end()) return;
+
+      size_t loopIndex = (*found).second.first;
+      if (loopIndex >= mLoops.size()) return;
+
+      auto loop = mLoops[loopIndex];
+
+      // modifying the registration re-evaluates the socket's readiness thus
+      // an already writable socket reports straight away
+      if (!modify(loop, socket, (*found).second.second, true)) return;
+
+      ZS_LOG_INSANE(log("socket write ready armed") + ZS_PARAM("socket", socket->getSocket()) + ZS_PARAM("loop", loop->mIndex))
+#endif //HAVE_EPOLL
+    }
+
+    //-------------------------------------------------------------------------
+    bool SocketReactor::startLoops()
+    {
+#ifdef HAVE_EPOLL
+      if (mStopped) return false;
+      if (mStarted) return mLoops.size() > 0;
+
+      mStarted = true;
+
+      for (size_t index = 0; index < mTotalThreads; ++index) {
+        auto loop = make_shared<Loop>();
+        loop->mIndex = index;
+
+        loop->mEPollFD = epoll_create1(EPOLL_CLOEXEC);
+        if (loop->mEPollFD < 0) {
+          ZS_LOG_ERROR(Basic, log("unable to create epoll instance") + ZS_PARAM("error", errno))
+          break;
+        }
+
+        loop->mWakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop->mWakeFD < 0) {
+          ZS_LOG_ERROR(Basic, log("unable to create wake event") + ZS_PARAM("error", errno))
+          ::close(loop->mEPollFD);
+          break;
+        }
+
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = kWakeRegistrationID;
+        epoll_ctl(loop->mEPollFD, EPOLL_CTL_ADD, loop->mWakeFD, &event);
+
+        loop->mThread = std::thread(&SocketReactor::runLoop, loop, mMaxEventsPerWait);
+
+        mLoops.push_back(loop);
+      }
+
+      ZS_LOG_DETAIL(log("started epoll loops") + ZS_PARAM("requested", mTotalThreads) + ZS_PARAM("started", mLoops.size()))
+      return mLoops.size() > 0;
+#else
+      return false;
+#endif //HAVE_EPOLL
+    }
+
+    //-------------------------------------------------------------------------
+    void SocketReactor::stopLoops()
+    {
+#ifdef HAVE_EPOLL
+      LoopList loops;
+
+      {
+        AutoLock lock(mLock);
+        if (mStopped) return;
+        mStopped = true;
+
+        loops = mLoops;
+        mLoops.clear();
+        mSockets.clear();
+      }
+
+      for (auto iter = loops.begin(); iter != loops.end(); ++iter) {
+        auto loop = (*iter);
+
+        loop->mShouldStop = true;
+
+        uint64_t value = 1;
+        if (write(loop->mWakeFD, &value, sizeof(value)) < 0) {
+          ZS_LOG_WARNING(Debug, log("unable to wake epoll loop") + ZS_PARAM("loop", loop->mIndex) + ZS_PARAM("error", errno))
+        }
+      }
+
+      for (auto iter = loops.begin(); iter != loops.end(); ++iter) {
+        auto loop = (*iter);
+
+        if (loop->mThread.joinable()) {
+          if (loop->mThread.get_id() == std::this_thread::get_id()) {
+            // the last reference was released from an event handler
+            loop->mThread.detach();
+            continue;
+          }
+          loop->mThread.join();
+        }
+
+        ::close(loop->mWakeFD);
+        ::close(loop->mEPollFD);
+
+        AutoLock loopLock(loop->mLock);
+        loop->mRegistrations.clear();
+      }
+#endif //HAVE_EPOLL
+    }
+
+    //-------------------------------------------------------------------------
+    void SocketReactor::runLoop(
+                                LoopPtr loop,
+                                size_t maxEvents
+                                )
+    {
+#ifdef HAVE_EPOLL
+      std::vector<epoll_event> events(maxEvents);
+
+      while (!loop->mShouldStop) {
+        int total = epoll_wait(loop->mEPollFD, events.data(), static_cast<int>(maxEvents), -1);
+        if (total < 0) {
+          int error = errno;
+          if (EINTR == error) continue;
+          ZS_LOG_ERROR(Basic, slog("epoll wait failed (loop exiting)") + ZS_PARAM("loop", loop->mIndex) + ZS_PARAM("error", error))
+          break;
+        }
+
+        ++(loop->mWakeups);
+
+        for (int index = 0; index < total; ++index) {
+          auto &event = events[index];
+
+          if (kWakeRegistrationID == event.data.u64) {
+            uint64_t value = 0;
+            while (read(loop->mWakeFD, &value, sizeof(value)) > 0) {}
+            continue;
+          }
+
+          Loop::Registration registration;
+
+          {
+            AutoLock lock(loop->mLock);
+            auto found = loop->mRegistrations.find(event.data.u64);
+            if (found == loop->mRegistrations.end()) continue;   // removed while the event was pending
+            registration = (*found).second;
+
+            // write readiness is reported once per armWriteReady thus disarm
+            // before notifying so a re-arm from the handler is never lost
+            // (done while registered thus the socket cannot be closed yet)
+            if (0 != (event.events & EPOLLOUT)) {
+              modify(loop, registration.mSocket, event.data.u64, false);
+            }
+          }
+
+          auto delegate = registration.mDelegate.lock();
+          if (!delegate) continue;
+
+          ++(loop->mEvents);
+
+          // a pending socket error is reported (and cleared) by the next read
+          // thus only treat it as an exception if nothing can be read
+          if (0 != (event.events & EPOLLIN)) {
+            delegate->onReadReady(registration.mSocket);
+          } else if (0 != (event.events & (EPOLLERR | EPOLLHUP))) {
+            delegate->onException(registration.mSocket);
+            continue;
+          }
+
+          if (0 != (event.events & EPOLLOUT)) {
+            delegate->onWriteReady(registration.mSocket);
+          }
+        }
+      }
+
+      ZS_LOG_DETAIL(slog("epoll loop stopped") + ZS_PARAM("loop", loop->mIndex))
+#endif //HAVE_EPOLL
+    }
+
+    //-------------------------------------------------------------------------
+    bool SocketReactor::modify(
+                               LoopPtr loop,
+                               SocketPtr socket,
+                               RegistrationID registrationID,
+                               bool monitorWrite
+                               )
+    {
+#ifdef HAVE_EPOLL
+      epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLIN | EPOLLET | (monitorWrite ? EPOLLOUT : 0);
+      event.data.u64 = registrationID;
+
+      if (0 != epoll_ctl(loop->mEPollFD, EPOLL_CTL_MOD, static_cast<int>(socket->getSocket()), &event)) {
+        // the socket may have been removed (or closed) in the meantime
+        ZS_LOG_WARNING(Trace, slog("unable to modify socket epoll registration") + ZS_PARAM("socket", socket->getSocket()) + ZS_PARAM("loop", loop->mIndex) + ZS_PARAM("write", monitorWrite) + ZS_PARAM("error", errno))
+        return false;
+      }
+      return true;
+#else
+      return false;
+#endif //HAVE_EPOLL
+    }
+
+  }
+}
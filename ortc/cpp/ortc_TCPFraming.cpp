@@ -0,0 +1,516 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+
+#include <ortc/internal/ortc_TCPFraming.h>
+#include <ortc/internal/ortc_BufferPool.h>
+#include <ortc/internal/platform.h>
+
+#include <openpeer/services/ISettings.h>
+#include <openpeer/services/IHelper.h>
+
+#include <zsLib/Log.h>
+#include <zsLib/XML.h>
+
+#ifdef HAVE_SENDMSG
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
+#endif //HAVE_SENDMSG
+
+#include <cstring>
+
+
+#ifdef _DEBUG
+#define ASSERT(x) ZS_THROW_BAD_STATE_IF(!(x))
+#else
+#define ASSERT(x)
+#endif //_DEBUG
+
+
+namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
+
+namespace ortc
+{
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+
+  namespace internal
+  {
+    ZS_DECLARE_TYPEDEF_PTR(ortc::internal::BufferPool, UseBufferPool)
+
+    // RFC 4571 frames carry a 16-bit length so a frame never exceeds this
+    static const size_t kLengthPrefixSize = sizeof(WORD);
+    static const size_t kMaxFrameSize = kLengthPrefixSize + 0xFFFF;
+
+    // reading into less room than this is not worth a system call
+    static const size_t kMinReadSpace = 4096;
+
+    // largest single send when frames have to be coalesced into one buffer
+    static const size_t kMaxCoalescedBytes = 0xFFFF;
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ITCPFramingForSettings
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void ITCPFramingForSettings::applyDefaults()
+    {
+      UseSettings::setUInt(ORTC_SETTING_TCP_FRAMING_READ_BUFFER_SIZE_IN_BYTES, 2*kMaxFrameSize);
+      UseSettings::setUInt(ORTC_SETTING_TCP_FRAMING_MAX_FRAMES_PER_WRITE, 64);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TCPFrameReader::Counters
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr TCPFrameReader::Counters::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::TCPFrameReader::Counters");
+
+      UseServicesHelper::debugAppend(resultEl, "reads", mReads);
+      UseServicesHelper::debugAppend(resultEl, "bytes", mBytes);
+      UseServicesHelper::debugAppend(resultEl, "frames", mFrames);
+      UseServicesHelper::debugAppend(resultEl, "relocated bytes", mRelocatedBytes);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TCPFrameReader
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    TCPFrameReader::TCPFrameReader(size_t bufferSizeInBytes) :
+      mBufferSize(0 != bufferSizeInBytes ? bufferSizeInBytes : static_cast<size_t>(UseSettings::getUInt(ORTC_SETTING_TCP_FRAMING_READ_BUFFER_SIZE_IN_BYTES)))
+    {
+      // the largest possible frame plus room to read behind it must fit
+      if (mBufferSize < kMaxFrameSize + kMinReadSpace) mBufferSize = kMaxFrameSize + kMinReadSpace;
+    }
+
+    //-------------------------------------------------------------------------
+    TCPFrameReader::~TCPFrameReader()
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    size_t TCPFrameReader::receive(
+                                   SocketPtr socket,
+                                   bool &outWouldBlock,
+                                   int &outErrorCode
+                                   )
+    {
+      mFrames.clear();
+
+      outWouldBlock = false;
+      outErrorCode = 0;
+
+      if (!socket) return 0;
+
+      ++mCounters.mReads;
+
+      prepare();
+
+      size_t read = 0;
+
+      try {
+        read = socket->receive(mBuffer->BytePtr() + mTail, mBufferSize - mTail, &outWouldBlock);
+      } catch(Socket::Exceptions::Unspecified &error) {
+        outErrorCode = error.errorCode();
+        return 0;
+      }
+
+      if (0 == read) return 0;
+
+      mTail += read;
+      mCounters.mBytes += read;
+
+      extract();
+
+      mCounters.mFrames += mFrames.size();
+      return read;
+    }
+
+    //-------------------------------------------------------------------------
+    void TCPFrameReader::reset()
+    {
+      mFrames.clear();
+      mBuffer.reset();
+      mHead = mTail = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr TCPFrameReader::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::TCPFrameReader");
+
+      UseServicesHelper::debugAppend(resultEl, "buffer size", mBufferSize);
+      UseServicesHelper::debugAppend(resultEl, "allocated", (bool)mBuffer);
+      UseServicesHelper::debugAppend(resultEl, "head", mHead);
+      UseServicesHelper::debugAppend(resultEl, "tail", mTail);
+      UseServicesHelper::debugAppend(resultEl, "counters", mCounters.toDebug());
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TCPFrameReader => (internal)
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    Log::Params TCPFrameReader::slog(const char *message)
+    {
+      ElementPtr objectEl = Element::create("ortc::TCPFrameReader");
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    void TCPFrameReader::prepare()
+    {
+      if (!mBuffer) {
+        mBuffer = make_shared<SecureByteBlock>(mBufferSize);
+        mHead = mTail = 0;
+        return;
+      }
+
+      if (mHead == mTail) {
+        // everything was consumed; start over at the front for free
+        mHead = mTail = 0;
+        return;
+      }
+
+      size_t partial = mTail - mHead;
+
+      // where the partial frame will end once complete (a frame whose length
+      // prefix has not arrived yet is at most one byte)
+      size_t frameEnd = mHead + kLengthPrefixSize;
+      if (partial >= kLengthPrefixSize) {
+        const BYTE *prefix = mBuffer->BytePtr() + mHead;
+        frameEnd += (static_cast<size_t>(prefix[0]) << 8) | static_cast<size_t>(prefix[1]);
+      }
+
+      if ((frameEnd <= mBufferSize) &&
+          (mBufferSize - mTail >= kMinReadSpace)) return;
+
+      ZS_LOG_INSANE(slog("relocating partial frame to start of ring") + ZS_PARAM("bytes", partial) + ZS_PARAM("head", mHead))
+
+      memmove(mBuffer->BytePtr(), mBuffer->BytePtr() + mHead, partial);
+      mHead = 0;
+      mTail = partial;
+      mCounters.mRelocatedBytes += partial;
+    }
+
+    //-------------------------------------------------------------------------
+    void TCPFrameReader::extract()
+    {
+      const BYTE *base = mBuffer->BytePtr();
+
+      while (mTail - mHead >= kLengthPrefixSize) {
+        const BYTE *prefix = base + mHead;
+        size_t frameSize = (static_cast<size_t>(prefix[0]) << 8) | static_cast<size_t>(prefix[1]);
+
+        if (mTail - mHead < kLengthPrefixSize + frameSize) break;
+
+        if (0 != frameSize) {
+          Frame frame;
+          frame.mBuffer = prefix + kLengthPrefixSize;
+          frame.mSize = frameSize;
+          mFrames.push_back(frame);
+        }
+
+        mHead += kLengthPrefixSize + frameSize;
+      }
+
+      ASSERT(mHead <= mTail)
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TCPFrameWriter::Counters
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr TCPFrameWriter::Counters::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::TCPFrameWriter::Counters");
+
+      UseServicesHelper::debugAppend(resultEl, "flushes", mFlushes);
+      UseServicesHelper::debugAppend(resultEl, "system calls", mSystemCalls);
+      UseServicesHelper::debugAppend(resultEl, "frames", mFrames);
+      UseServicesHelper::debugAppend(resultEl, "bytes", mBytes);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TCPFrameWriter
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    TCPFrameWriter::TCPFrameWriter(size_t maxFramesPerWrite) :
+      mMaxFrames(0 != maxFramesPerWrite ? maxFramesPerWrite : static_cast<size_t>(UseSettings::getUInt(ORTC_SETTING_TCP_FRAMING_MAX_FRAMES_PER_WRITE)))
+    {
+      if (mMaxFrames < 1) mMaxFrames = 1;
+
+#if defined(HAVE_SENDMSG) && defined(IOV_MAX)
+      if (mMaxFrames > static_cast<size_t>(IOV_MAX)) mMaxFrames = static_cast<size_t>(IOV_MAX);
+#endif //defined(HAVE_SENDMSG) && defined(IOV_MAX)
+    }
+
+    //-------------------------------------------------------------------------
+    TCPFrameWriter::~TCPFrameWriter()
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    bool TCPFrameWriter::add(
+                             const BYTE *buffer,
+                             size_t bufferSizeInBytes
+                             )
+    {
+      if (bufferSizeInBytes > 0xFFFF) return false;
+      if ((!buffer) || (0 == bufferSizeInBytes)) return true;
+
+      QueuedFrame frame;
+      frame.mSize = kLengthPrefixSize + bufferSizeInBytes;
+      frame.mBuffer = UseBufferPool::allocate(frame.mSize);
+
+      BYTE *dest = frame.mBuffer->BytePtr();
+      dest[0] = static_cast<BYTE>(bufferSizeInBytes >> 8);
+      dest[1] = static_cast<BYTE>(bufferSizeInBytes & 0xFF);
+      memcpy(dest + kLengthPrefixSize, buffer, bufferSizeInBytes);
+
+      mPendingBytes += frame.mSize;
+      mQueue.push_back(frame);
+      return true;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t TCPFrameWriter::flush(
+                                 SocketPtr socket,
+                                 bool &outWouldBlock,
+                                 int &outErrorCode
+                                 )
+    {
+      outWouldBlock = false;
+      outErrorCode = 0;
+
+      if (!socket) return 0;
+      if (mQueue.size() < 1) return 0;
+
+      ++mCounters.mFlushes;
+
+#ifdef HAVE_SENDMSG
+      size_t sent = sendGathered(socket, outWouldBlock, outErrorCode);
+#else
+      size_t sent = sendCoalesced(socket, outWouldBlock, outErrorCode);
+#endif //HAVE_SENDMSG
+
+      consume(sent);
+      return sent;
+    }
+
+    //-------------------------------------------------------------------------
+    void TCPFrameWriter::reset()
+    {
+      mQueue.clear();
+      mFrontOffset = 0;
+      mPendingBytes = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr TCPFrameWriter::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::TCPFrameWriter");
+
+      UseServicesHelper::debugAppend(resultEl, "max frames", mMaxFrames);
+      UseServicesHelper::debugAppend(resultEl, "queued frames", mQueue.size());
+      UseServicesHelper::debugAppend(resultEl, "front offset", mFrontOffset);
+      UseServicesHelper::debugAppend(resultEl, "pending bytes", mPendingBytes);
+      UseServicesHelper::debugAppend(resultEl, "counters", mCounters.toDebug());
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TCPFrameWriter => (internal)
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    Log::Params TCPFrameWriter::slog(const char *message)
+    {
+      ElementPtr objectEl = Element::create("ortc::TCPFrameWriter");
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    size_t TCPFrameWriter::sendGathered(
+                                        SocketPtr socket,
+                                        bool &outWouldBlock,
+                                        int &outErrorCode
+                                        )
+    {
+#ifdef HAVE_SENDMSG
+      size_t total = (mQueue.size() < mMaxFrames ? mQueue.size() : mMaxFrames);
+
+      std::vector<iovec> ioVecs(total);
+
+      size_t offset = mFrontOffset;
+      for (size_t index = 0; index < total; ++index) {
+        auto &frame = mQueue[index];
+        ioVecs[index].iov_base = frame.mBuffer->BytePtr() + offset;
+        ioVecs[index].iov_len = frame.mSize - offset;
+        offset = 0;
+      }
+
+      msghdr header;
+      memset(&header, 0, sizeof(header));
+      header.msg_iov = ioVecs.data();
+      header.msg_iovlen = total;
+
+      int flags = MSG_DONTWAIT;
+#ifdef MSG_NOSIGNAL
+      flags |= MSG_NOSIGNAL;
+#endif //MSG_NOSIGNAL
+
+      while (true) {
+        ++mCounters.mSystemCalls;
+        auto result = sendmsg(static_cast<int>(socket->getSocket()), &header, flags);
+        if (result >= 0) return static_cast<size_t>(result);
+
+        int error = errno;
+        if (EINTR == error) continue;
+        if ((EAGAIN == error) ||
+            (EWOULDBLOCK == error)) {
+          outWouldBlock = true;
+          return 0;
+        }
+        outErrorCode = error;
+        return 0;
+      }
+#else
+      return sendCoalesced(socket, outWouldBlock, outErrorCode);
+#endif //HAVE_SENDMSG
+    }
+
+    //-------------------------------------------------------------------------
+    size_t TCPFrameWriter::sendCoalesced(
+                                         SocketPtr socket,
+                                         bool &outWouldBlock,
+                                         int &outErrorCode
+                                         )
+    {
+      if (!mScratch) {
+        mScratch = make_shared<SecureByteBlock>(kMaxCoalescedBytes);
+      }
+
+      BYTE *dest = mScratch->BytePtr();
+      size_t filled = 0;
+
+      size_t offset = mFrontOffset;
+      for (size_t index = 0; (index < mQueue.size()) && (index < mMaxFrames); ++index) {
+        auto &frame = mQueue[index];
+        size_t size = frame.mSize - offset;
+        if (filled + size > kMaxCoalescedBytes) {
+          if (0 != filled) break;
+          size = kMaxCoalescedBytes;
+        }
+        memcpy(dest + filled, frame.mBuffer->BytePtr() + offset, size);
+        filled += size;
+        offset = 0;
+      }
+
+      try {
+        ++mCounters.mSystemCalls;
+        return socket->send(dest, filled, &outWouldBlock);
+      } catch(Socket::Exceptions::Unspecified &error) {
+        outErrorCode = error.errorCode();
+      }
+      return 0;
+    }
+
+    //-------------------------------------------------------------------------
+    void TCPFrameWriter::consume(size_t sent)
+    {
+      ASSERT(sent <= mPendingBytes)
+
+      mPendingBytes -= sent;
+      mCounters.mBytes += sent;
+
+      while ((sent > 0) &&
+             (mQueue.size() > 0)) {
+        auto &frame = mQueue.front();
+        size_t remaining = frame.mSize - mFrontOffset;
+        if (sent < remaining) {
+          mFrontOffset += sent;
+          return;
+        }
+
+        sent -= remaining;
+        mFrontOffset = 0;
+        mQueue.pop_front();
+        ++mCounters.mFrames;
+      }
+    }
+
+  }
+}
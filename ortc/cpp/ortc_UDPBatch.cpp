@@ -0,0 +1,885 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <ortc/internal/ortc_UDPBatch.h>
+#include <ortc/internal/ortc_BufferPool.h>
+#include <ortc/internal/platform.h>
+
+#include <openpeer/services/ISettings.h>
+#include <openpeer/services/IHelper.h>
+
+#include <zsLib/Log.h>
+#include <zsLib/XML.h>
+
+#if defined(HAVE_RECVMMSG) || defined(HAVE_SENDMMSG)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <errno.h>
+#endif //defined(HAVE_RECVMMSG) || defined(HAVE_SENDMMSG)
+
+#ifdef HAVE_UDP_SEGMENT
+#include <netinet/udp.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif //SOL_UDP
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif //UDP_SEGMENT
+#endif //HAVE_UDP_SEGMENT
+
+#include <cstring>
+
+
+#ifdef _DEBUG
+#define ASSERT(x) ZS_THROW_BAD_STATE_IF(!(x))
+#else
+#define ASSERT(x)
+#endif //_DEBUG
+
+
+namespace ortc { ZS_DECLARE_SUBSYSTEM(ortclib) }
+
+namespace ortc
+{
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+  ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+
+  namespace internal
+  {
+    ZS_DECLARE_TYPEDEF_PTR(ortc::internal::BufferPool, UseBufferPool)
+
+    // the kernel refuses to segment more than 64 datagrams in one send and
+    // the whole payload must stay under the 64K IP datagram limit
+    static const size_t kMaxSegmentsPerSend = 64;
+    static const size_t kMaxSegmentedBytes = 65000;
+
+#ifdef HAVE_SENDMMSG
+    //-------------------------------------------------------------------------
+    static socklen_t toNativeAddress(
+                                     const IPAddress &ip,
+                                     bool useIPv4,
+                                     sockaddr_storage &outAddress
+                                     )
+    {
+      memset(&outAddress, 0, sizeof(outAddress));
+      if (useIPv4) {
+        ip.getIPv4(*reinterpret_cast<sockaddr_in *>(&outAddress));
+        return static_cast<socklen_t>(sizeof(sockaddr_in));
+      }
+      ip.getIPv6(*reinterpret_cast<sockaddr_in6 *>(&outAddress));
+      return static_cast<socklen_t>(sizeof(sockaddr_in6));
+    }
+#endif //HAVE_SENDMMSG
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IUDPBatchForSettings
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    void IUDPBatchForSettings::applyDefaults()
+    {
+      UseSettings::setUInt(ORTC_SETTING_UDP_BATCH_MAX_DATAGRAMS_PER_READ, 32);
+      UseSettings::setUInt(ORTC_SETTING_UDP_BATCH_RECEIVE_BUFFER_SIZE_IN_BYTES, 1500);
+      UseSettings::setUInt(ORTC_SETTING_UDP_BATCH_MAX_DATAGRAM_SIZE_IN_BYTES, 9000);
+      UseSettings::setUInt(ORTC_SETTING_UDP_BATCH_MAX_DATAGRAMS_PER_SEND, 64);
+      UseSettings::setBool(ORTC_SETTING_UDP_BATCH_SEGMENTATION_OFFLOAD, true);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchReceiver::NativeState
+    #pragma mark
+
+    struct UDPBatchReceiver::NativeState
+    {
+#ifdef HAVE_RECVMMSG
+      std::vector<mmsghdr> mHeaders;
+      std::vector<iovec> mIOVecs;
+      std::vector<sockaddr_storage> mAddresses;
+
+      NativeState(size_t total) :
+        mHeaders(total),
+        mIOVecs(total * 2),       // slot followed by the slot's own overflow
+        mAddresses(total)
+      {
+      }
+#endif //HAVE_RECVMMSG
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchReceiver::Counters
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr UDPBatchReceiver::Counters::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::UDPBatchReceiver::Counters");
+
+      UseServicesHelper::debugAppend(resultEl, "reads", mReads);
+      UseServicesHelper::debugAppend(resultEl, "system calls", mSystemCalls);
+      UseServicesHelper::debugAppend(resultEl, "datagrams", mDatagrams);
+      UseServicesHelper::debugAppend(resultEl, "truncated", mTruncated);
+      UseServicesHelper::debugAppend(resultEl, "oversized", mOversized);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchReceiver
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    UDPBatchReceiver::UDPBatchReceiver(
+                                       size_t maxDatagramsPerRead,
+                                       size_t bufferSizeInBytes
+                                       ) :
+      mMaxDatagrams(0 != maxDatagramsPerRead ? maxDatagramsPerRead : static_cast<size_t>(UseSettings::getUInt(ORTC_SETTING_UDP_BATCH_MAX_DATAGRAMS_PER_READ))),
+      mBufferSize(0 != bufferSizeInBytes ? bufferSizeInBytes : static_cast<size_t>(UseSettings::getUInt(ORTC_SETTING_UDP_BATCH_RECEIVE_BUFFER_SIZE_IN_BYTES))),
+      mMaxDatagramSize(static_cast<size_t>(UseSettings::getUInt(ORTC_SETTING_UDP_BATCH_MAX_DATAGRAM_SIZE_IN_BYTES)))
+    {
+      if (mMaxDatagrams < 1) mMaxDatagrams = 1;
+      if (mBufferSize < 1) mBufferSize = 1500;
+      if (mMaxDatagramSize > 0xFFFF) mMaxDatagramSize = 0xFFFF;
+      if (mMaxDatagramSize > mBufferSize) mOverflowSize = mMaxDatagramSize - mBufferSize;
+
+      mDatagrams.reserve(mMaxDatagrams);
+
+#ifdef HAVE_RECVMMSG
+      mSlots.resize(mMaxDatagrams);
+      mNative.reset(new NativeState(mMaxDatagrams));
+      mMultipleSupported = true;
+#endif //HAVE_RECVMMSG
+    }
+
+    //-------------------------------------------------------------------------
+    UDPBatchReceiver::~UDPBatchReceiver()
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    size_t UDPBatchReceiver::receive(
+                                     SocketPtr socket,
+                                     bool &outWouldBlock,
+                                     int &outErrorCode
+                                     )
+    {
+      mDatagrams.clear();
+      mLastReadFull = false;
+
+      outWouldBlock = false;
+      outErrorCode = 0;
+
+      ++mCounters.mReads;
+
+      size_t total = (mMultipleSupported ? receiveMultiple(socket, outWouldBlock, outErrorCode) : receiveEach(socket, outWouldBlock, outErrorCode));
+
+      if ((0 == total) &&
+          (0 != outErrorCode)) {
+        // an asynchronous error (e.g. ICMP port unreachable) is reported once
+        // and cleared; read again so datagrams queued behind it are not left
+        // waiting for a readiness edge that will never come
+        ZS_LOG_TRACE(slog("pending socket error consumed (reading again)") + ZS_PARAM("error", outErrorCode))
+        outErrorCode = 0;
+        ++mCounters.mReads;
+        total = (mMultipleSupported ? receiveMultiple(socket, outWouldBlock, outErrorCode) : receiveEach(socket, outWouldBlock, outErrorCode));
+      }
+
+      mCounters.mDatagrams += total;
+      return total;
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr UDPBatchReceiver::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::UDPBatchReceiver");
+
+      UseServicesHelper::debugAppend(resultEl, "max datagrams", mMaxDatagrams);
+      UseServicesHelper::debugAppend(resultEl, "buffer size", mBufferSize);
+      UseServicesHelper::debugAppend(resultEl, "max datagram size", mMaxDatagramSize);
+      UseServicesHelper::debugAppend(resultEl, "overflow size", mOverflowSize);
+      UseServicesHelper::debugAppend(resultEl, "multiple supported", mMultipleSupported);
+      UseServicesHelper::debugAppend(resultEl, "last read full", mLastReadFull);
+      UseServicesHelper::debugAppend(resultEl, "counters", mCounters.toDebug());
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchReceiver => (internal)
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    size_t UDPBatchReceiver::receiveMultiple(
+                                             SocketPtr socket,
+                                             bool &outWouldBlock,
+                                             int &outErrorCode
+                                             )
+    {
+#ifdef HAVE_RECVMMSG
+      ASSERT((bool)mNative)
+
+      auto &native = *mNative;
+
+      if ((0 != mOverflowSize) &&
+          (!mOverflow)) {
+        mOverflow = make_shared<SecureByteBlock>(mOverflowSize * mMaxDatagrams);
+      }
+
+      while (true) {
+        // re-arm every slot whose buffer was handed out by the previous read
+        for (size_t index = 0; index < mMaxDatagrams; ++index) {
+          auto &slot = mSlots[index];
+          if (!slot) slot = UseBufferPool::allocate(mBufferSize);
+
+          // anything not fitting the slot spills into the slot's own
+          // overflow region thus oversized datagrams within the same batch
+          // never overwrite each other
+          iovec *ioVecs = &(native.mIOVecs[index * 2]);
+          ioVecs[0].iov_base = slot->BytePtr();
+          ioVecs[0].iov_len = slot->SizeInBytes();
+          if (mOverflow) {
+            ioVecs[1].iov_base = mOverflow->BytePtr() + (index * mOverflowSize);
+            ioVecs[1].iov_len = mOverflowSize;
+          }
+
+          auto &header = native.mHeaders[index];
+          memset(&header, 0, sizeof(header));
+          header.msg_hdr.msg_name = &(native.mAddresses[index]);
+          header.msg_hdr.msg_namelen = sizeof(native.mAddresses[index]);
+          header.msg_hdr.msg_iov = ioVecs;
+          header.msg_hdr.msg_iovlen = (mOverflow ? 2 : 1);
+        }
+
+        ++mCounters.mSystemCalls;
+        int result = recvmmsg(static_cast<int>(socket->getSocket()), native.mHeaders.data(), static_cast<unsigned int>(mMaxDatagrams), MSG_DONTWAIT, NULL);
+
+        if (result < 0) {
+          int error = errno;
+          if ((EAGAIN == error) ||
+              (EWOULDBLOCK == error)) {
+            outWouldBlock = true;
+            return 0;
+          }
+          if (EINTR == error) continue;
+          if (ENOSYS == error) {
+            ZS_LOG_WARNING(Detail, slog("recvmmsg is not supported by this kernel (falling back to single receive)"))
+            mMultipleSupported = false;
+            return receiveEach(socket, outWouldBlock, outErrorCode);
+          }
+          outErrorCode = error;
+          return 0;
+        }
+
+        mLastReadFull = (static_cast<size_t>(result) == mMaxDatagrams);
+
+        for (int index = 0; index < result; ++index) {
+          auto &header = native.mHeaders[index];
+
+          size_t slotSize = mSlots[index]->SizeInBytes();
+          size_t size = static_cast<size_t>(header.msg_len);
+
+          if (0 != (header.msg_hdr.msg_flags & MSG_TRUNC)) {
+            ZS_LOG_WARNING(Debug, slog("datagram too large for receive buffer (dropped)") + ZS_PARAM("buffer size", slotSize) + ZS_PARAM("size", size))
+            ++mCounters.mTruncated;
+            continue; // slot buffer stays armed for the next read
+          }
+
+          auto &address = native.mAddresses[index];
+
+          Datagram datagram;
+          switch (address.ss_family) {
+            case AF_INET:   datagram.mFromIP = IPAddress(*reinterpret_cast<const sockaddr_in *>(&address)); break;
+            case AF_INET6:  datagram.mFromIP = IPAddress(*reinterpret_cast<const sockaddr_in6 *>(&address)); break;
+            default:        continue;
+          }
+
+          datagram.mSize = size;
+
+          if (size > slotSize) {
+            // reassembled into its own buffer (the slot stays armed)
+            datagram.mBuffer = UseBufferPool::allocate(size);
+            memcpy(datagram.mBuffer->BytePtr(), mSlots[index]->BytePtr(), slotSize);
+            memcpy(datagram.mBuffer->BytePtr() + slotSize, mOverflow->BytePtr() + (static_cast<size_t>(index) * mOverflowSize), size - slotSize);
+            ++mCounters.mOversized;
+            mDatagrams.push_back(datagram);
+            continue;
+          }
+
+          datagram.mBuffer = mSlots[index];
+          mSlots[index].reset();
+
+          mDatagrams.push_back(datagram);
+        }
+
+        // only truncated datagrams were read but more are waiting
+        if ((mDatagrams.size() < 1) &&
+            (result > 0)) continue;
+
+        return mDatagrams.size();
+      }
+#else
+      return receiveEach(socket, outWouldBlock, outErrorCode);
+#endif //HAVE_RECVMMSG
+    }
+
+    //-------------------------------------------------------------------------
+    size_t UDPBatchReceiver::receiveEach(
+                                         SocketPtr socket,
+                                         bool &outWouldBlock,
+                                         int &outErrorCode
+                                         )
+    {
+      if (!mScratch) {
+        mScratch = make_shared<SecureByteBlock>(0xFFFF);
+      }
+
+      while (mDatagrams.size() < mMaxDatagrams) {
+        IPAddress fromIP;
+        bool wouldBlock = false;
+        size_t read = 0;
+
+        ++mCounters.mSystemCalls;
+
+        try {
+          read = socket->receiveFrom(fromIP, mScratch->BytePtr(), mScratch->SizeInBytes(), &wouldBlock);
+        } catch(Socket::Exceptions::Unspecified &error) {
+          if (mDatagrams.size() < 1) outErrorCode = error.errorCode();
+          break;
+        }
+
+        if (0 == read) {
+          if (mDatagrams.size() < 1) outWouldBlock = wouldBlock;
+          break;
+        }
+
+        Datagram datagram;
+        datagram.mFromIP = fromIP;
+        datagram.mBuffer = UseBufferPool::allocate(read);
+        datagram.mSize = read;
+        memcpy(datagram.mBuffer->BytePtr(), mScratch->BytePtr(), read);
+
+        mDatagrams.push_back(datagram);
+      }
+
+      mLastReadFull = (mDatagrams.size() == mMaxDatagrams);
+      return mDatagrams.size();
+    }
+
+    //-------------------------------------------------------------------------
+    Log::Params UDPBatchReceiver::slog(const char *message)
+    {
+      ElementPtr objectEl = Element::create("ortc::UDPBatchReceiver");
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchSender::NativeState
+    #pragma mark
+
+    struct UDPBatchSender::NativeState
+    {
+#ifdef HAVE_SENDMMSG
+      std::vector<mmsghdr> mHeaders;
+      std::vector<iovec> mIOVecs;
+      std::vector<sockaddr_storage> mAddresses;
+
+      NativeState(size_t total) :
+        mHeaders(total),
+        mIOVecs(total),
+        mAddresses(total)
+      {
+      }
+#endif //HAVE_SENDMMSG
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchSender::Counters
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr UDPBatchSender::Counters::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::UDPBatchSender::Counters");
+
+      UseServicesHelper::debugAppend(resultEl, "flushes", mFlushes);
+      UseServicesHelper::debugAppend(resultEl, "system calls", mSystemCalls);
+      UseServicesHelper::debugAppend(resultEl, "datagrams", mDatagrams);
+      UseServicesHelper::debugAppend(resultEl, "segmented sends", mSegmentedSends);
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchSender
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    UDPBatchSender::UDPBatchSender(
+                                   size_t maxDatagramsPerSend,
+                                   bool allowSegmentationOffload
+                                   ) :
+      mMaxDatagrams(0 != maxDatagramsPerSend ? maxDatagramsPerSend : static_cast<size_t>(UseSettings::getUInt(ORTC_SETTING_UDP_BATCH_MAX_DATAGRAMS_PER_SEND)))
+    {
+      if (mMaxDatagrams < 1) mMaxDatagrams = 1;
+
+#ifdef HAVE_SENDMMSG
+      // a segmented send uses the same I/O vectors thus size for either
+      mNative.reset(new NativeState(mMaxDatagrams > kMaxSegmentsPerSend ? mMaxDatagrams : kMaxSegmentsPerSend));
+      mMultipleSupported = true;
+#endif //HAVE_SENDMMSG
+
+#ifdef HAVE_UDP_SEGMENT
+      mOffloadSupported = (allowSegmentationOffload) && (UseSettings::getBool(ORTC_SETTING_UDP_BATCH_SEGMENTATION_OFFLOAD));
+#endif //HAVE_UDP_SEGMENT
+    }
+
+    //-------------------------------------------------------------------------
+    UDPBatchSender::~UDPBatchSender()
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    void UDPBatchSender::add(
+                             const IPAddress &remoteIP,
+                             const BYTE *buffer,
+                             size_t bufferSizeInBytes
+                             )
+    {
+      if (!buffer) return;
+      if (0 == bufferSizeInBytes) return;
+
+      PendingDatagram datagram;
+      datagram.mRemoteIP = remoteIP;
+      datagram.mBuffer = buffer;
+      datagram.mSize = bufferSizeInBytes;
+
+      mPending.push_back(datagram);
+    }
+
+    //-------------------------------------------------------------------------
+    void UDPBatchSender::add(
+                             const IPAddress &remoteIP,
+                             const PacketList &packets
+                             )
+    {
+      for (auto iter = packets.begin(); iter != packets.end(); ++iter) {
+        auto &packet = (*iter);
+        add(remoteIP, packet.mBuffer, packet.mSize);
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    size_t UDPBatchSender::flush(
+                                 SocketPtr socket,
+                                 const IPAddress &boundIP,
+                                 bool &outWouldBlock,
+                                 int &outErrorCode
+                                 )
+    {
+      outWouldBlock = false;
+      outErrorCode = 0;
+
+      ++mCounters.mFlushes;
+
+      bool useIPv4 = boundIP.isIPv4();
+
+      size_t total = mPending.size();
+      size_t sent = 0;
+      size_t index = 0;
+
+      while (index < total) {
+        size_t runLength = (mOffloadSupported ? segmentRunLength(index) : 1);
+
+        if (runLength > 1) {
+          size_t result = sendSegmented(socket, useIPv4, index, runLength, outWouldBlock, outErrorCode);
+          sent += result;
+          if (result < runLength) break;
+
+          index += runLength;
+          continue;
+        }
+
+        // gather the datagrams up to the next segmentable run
+        size_t end = index + 1;
+        while ((end < total) &&
+               ((end - index) < mMaxDatagrams)) {
+          if ((mOffloadSupported) &&
+              (segmentRunLength(end) > 1)) break;
+          ++end;
+        }
+
+        size_t length = end - index;
+        size_t result = (mMultipleSupported ? sendMultiple(socket, useIPv4, index, length, outWouldBlock, outErrorCode) : sendEach(socket, index, length, outWouldBlock, outErrorCode));
+        sent += result;
+        if (result < length) break;
+
+        index = end;
+      }
+
+      if (sent < total) {
+        ZS_LOG_TRACE(slog("not all datagrams could be sent") + ZS_PARAM("sent", sent) + ZS_PARAM("total", total) + ZS_PARAM("would block", outWouldBlock) + ZS_PARAM("error", outErrorCode))
+      }
+
+      mPending.clear();
+
+      mCounters.mDatagrams += sent;
+      return sent;
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr UDPBatchSender::toDebug() const
+    {
+      ElementPtr resultEl = Element::create("ortc::UDPBatchSender");
+
+      UseServicesHelper::debugAppend(resultEl, "max datagrams", mMaxDatagrams);
+      UseServicesHelper::debugAppend(resultEl, "pending", mPending.size());
+      UseServicesHelper::debugAppend(resultEl, "multiple supported", mMultipleSupported);
+      UseServicesHelper::debugAppend(resultEl, "offload supported", mOffloadSupported);
+      UseServicesHelper::debugAppend(resultEl, "counters", mCounters.toDebug());
+
+      return resultEl;
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchSender => (internal)
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    Log::Params UDPBatchSender::slog(const char *message)
+    {
+      ElementPtr objectEl = Element::create("ortc::UDPBatchSender");
+      return Log::Params(message, objectEl);
+    }
+
+    //-------------------------------------------------------------------------
+    bool UDPBatchSender::sendWithPrefix(
+                                        SocketPtr socket,
+                                        const IPAddress &boundIP,
+                                        const IPAddress &remoteIP,
+                                        const BYTE *prefix,
+                                        size_t prefixSizeInBytes,
+                                        const BYTE *buffer,
+                                        size_t bufferSizeInBytes,
+                                        bool &outWouldBlock,
+                                        int &outErrorCode
+                                        )
+    {
+      if (!socket) return false;
+
+#ifdef HAVE_SENDMMSG
+      sockaddr_storage address;
+      socklen_t addressLength = toNativeAddress(remoteIP, !boundIP.isIPv6(), address);
+
+      iovec ioVecs[2];
+      ioVecs[0].iov_base = const_cast<BYTE *>(prefix);
+      ioVecs[0].iov_len = prefixSizeInBytes;
+      ioVecs[1].iov_base = const_cast<BYTE *>(buffer);
+      ioVecs[1].iov_len = bufferSizeInBytes;
+
+      msghdr header;
+      memset(&header, 0, sizeof(header));
+      header.msg_name = &address;
+      header.msg_namelen = addressLength;
+      header.msg_iov = ioVecs;
+      header.msg_iovlen = 2;
+
+      while (true) {
+        auto result = sendmsg(static_cast<int>(socket->getSocket()), &header, MSG_DONTWAIT);
+        if (result >= 0) return static_cast<size_t>(result) == (prefixSizeInBytes + bufferSizeInBytes);
+
+        int error = errno;
+        if (EINTR == error) continue;
+        if ((EAGAIN == error) ||
+            (EWOULDBLOCK == error)) {
+          outWouldBlock = true;
+          return false;
+        }
+        outErrorCode = error;
+        return false;
+      }
+#else
+      size_t totalSize = prefixSizeInBytes + bufferSizeInBytes;
+
+      auto joined = UseBufferPool::allocate(totalSize);
+      memcpy(joined->BytePtr(), prefix, prefixSizeInBytes);
+      memcpy(joined->BytePtr() + prefixSizeInBytes, buffer, bufferSizeInBytes);
+
+      try {
+        return socket->sendTo(remoteIP, joined->BytePtr(), totalSize, &outWouldBlock) == totalSize;
+      } catch(Socket::Exceptions::Unspecified &error) {
+        outErrorCode = error.errorCode();
+      }
+      return false;
+#endif //HAVE_SENDMMSG
+    }
+
+    //-------------------------------------------------------------------------
+    size_t UDPBatchSender::segmentRunLength(size_t index) const
+    {
+      // a segmented send splits the payload into equally sized datagrams
+      // where only the final datagram may be shorter
+      auto &first = mPending[index];
+
+      size_t length = 1;
+      size_t totalBytes = first.mSize;
+
+      for (size_t next = index + 1; (next < mPending.size()) && (length < kMaxSegmentsPerSend); ++next) {
+        auto &datagram = mPending[next];
+
+        if (datagram.mSize > first.mSize) break;
+        if (totalBytes + datagram.mSize > kMaxSegmentedBytes) break;
+        if (datagram.mRemoteIP != first.mRemoteIP) break;
+
+        ++length;
+        totalBytes += datagram.mSize;
+
+        if (datagram.mSize != first.mSize) break;
+      }
+
+      return length;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t UDPBatchSender::sendSegmented(
+                                         SocketPtr socket,
+                                         bool useIPv4,
+                                         size_t index,
+                                         size_t total,
+                                         bool &outWouldBlock,
+                                         int &outErrorCode
+                                         )
+    {
+#ifdef HAVE_UDP_SEGMENT
+      ASSERT((bool)mNative)
+      ASSERT(total <= kMaxSegmentsPerSend)
+
+      auto &native = *mNative;
+      auto &first = mPending[index];
+
+      for (size_t offset = 0; offset < total; ++offset) {
+        auto &datagram = mPending[index + offset];
+        auto &ioVec = native.mIOVecs[offset];
+        ioVec.iov_base = const_cast<BYTE *>(datagram.mBuffer);
+        ioVec.iov_len = datagram.mSize;
+      }
+
+      sockaddr_storage address;
+      socklen_t addressLength = toNativeAddress(first.mRemoteIP, useIPv4, address);
+
+      char control[CMSG_SPACE(sizeof(uint16_t))];
+      memset(control, 0, sizeof(control));
+
+      msghdr header;
+      memset(&header, 0, sizeof(header));
+      header.msg_name = &address;
+      header.msg_namelen = addressLength;
+      header.msg_iov = native.mIOVecs.data();
+      header.msg_iovlen = total;
+      header.msg_control = control;
+      header.msg_controllen = sizeof(control);
+
+      cmsghdr *controlHeader = CMSG_FIRSTHDR(&header);
+      controlHeader->cmsg_level = SOL_UDP;
+      controlHeader->cmsg_type = UDP_SEGMENT;
+      controlHeader->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      *reinterpret_cast<uint16_t *>(CMSG_DATA(controlHeader)) = static_cast<uint16_t>(first.mSize);
+
+      while (true) {
+        ++mCounters.mSystemCalls;
+        auto result = sendmsg(static_cast<int>(socket->getSocket()), &header, MSG_DONTWAIT);
+        if (result >= 0) {
+          ++mCounters.mSegmentedSends;
+          return total;
+        }
+
+        int error = errno;
+        if (EINTR == error) continue;
+        if ((EAGAIN == error) ||
+            (EWOULDBLOCK == error)) {
+          outWouldBlock = true;
+          return 0;
+        }
+        if ((EIO == error) ||
+            (EINVAL == error) ||
+            (ENOPROTOOPT == error) ||
+            (EOPNOTSUPP == error)) {
+          // older kernels (or devices without checksum offload) reject the
+          // segment option; stop trying and resend through the batch path
+          ZS_LOG_WARNING(Detail, slog("UDP segmentation offload is not available (falling back to batched send)") + ZS_PARAM("error", error))
+          mOffloadSupported = false;
+          return sendMultiple(socket, useIPv4, index, total, outWouldBlock, outErrorCode);
+        }
+
+        outErrorCode = error;
+        return 0;
+      }
+#else
+      return sendMultiple(socket, useIPv4, index, total, outWouldBlock, outErrorCode);
+#endif //HAVE_UDP_SEGMENT
+    }
+
+    //-------------------------------------------------------------------------
+    size_t UDPBatchSender::sendMultiple(
+                                        SocketPtr socket,
+                                        bool useIPv4,
+                                        size_t index,
+                                        size_t total,
+                                        bool &outWouldBlock,
+                                        int &outErrorCode
+                                        )
+    {
+#ifdef HAVE_SENDMMSG
+      ASSERT((bool)mNative)
+      ASSERT(total <= mNative->mHeaders.size())
+
+      auto &native = *mNative;
+
+      for (size_t offset = 0; offset < total; ++offset) {
+        auto &datagram = mPending[index + offset];
+
+        auto &ioVec = native.mIOVecs[offset];
+        ioVec.iov_base = const_cast<BYTE *>(datagram.mBuffer);
+        ioVec.iov_len = datagram.mSize;
+
+        auto &header = native.mHeaders[offset];
+        memset(&header, 0, sizeof(header));
+        header.msg_hdr.msg_name = &(native.mAddresses[offset]);
+        header.msg_hdr.msg_namelen = toNativeAddress(datagram.mRemoteIP, useIPv4, native.mAddresses[offset]);
+        header.msg_hdr.msg_iov = &ioVec;
+        header.msg_hdr.msg_iovlen = 1;
+      }
+
+      size_t sent = 0;
+      while (sent < total) {
+        ++mCounters.mSystemCalls;
+        int result = sendmmsg(static_cast<int>(socket->getSocket()), &(native.mHeaders[sent]), static_cast<unsigned int>(total - sent), MSG_DONTWAIT);
+
+        if (result < 0) {
+          int error = errno;
+          if (EINTR == error) continue;
+          if ((EAGAIN == error) ||
+              (EWOULDBLOCK == error)) {
+            outWouldBlock = true;
+            break;
+          }
+          if ((ENOSYS == error) &&
+              (0 == sent)) {
+            ZS_LOG_WARNING(Detail, slog("sendmmsg is not supported by this kernel (falling back to single send)"))
+            mMultipleSupported = false;
+            return sendEach(socket, index, total, outWouldBlock, outErrorCode);
+          }
+          outErrorCode = error;
+          break;
+        }
+
+        if (0 == result) break;
+        sent += static_cast<size_t>(result);
+      }
+
+      return sent;
+#else
+      return sendEach(socket, index, total, outWouldBlock, outErrorCode);
+#endif //HAVE_SENDMMSG
+    }
+
+    //-------------------------------------------------------------------------
+    size_t UDPBatchSender::sendEach(
+                                    SocketPtr socket,
+                                    size_t index,
+                                    size_t total,
+                                    bool &outWouldBlock,
+                                    int &outErrorCode
+                                    )
+    {
+      size_t sent = 0;
+
+      for (; sent < total; ++sent) {
+        auto &datagram = mPending[index + sent];
+
+        bool wouldBlock = false;
+        ++mCounters.mSystemCalls;
+
+        try {
+          auto result = socket->sendTo(datagram.mRemoteIP, datagram.mBuffer, datagram.mSize, &wouldBlock);
+          if (result != datagram.mSize) {
+            outWouldBlock = wouldBlock;
+            break;
+          }
+        } catch(Socket::Exceptions::Unspecified &error) {
+          outErrorCode = error.errorCode();
+          break;
+        }
+      }
+
+      return sent;
+    }
+
+  }
+}
@@ -0,0 +1,179 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <atomic>
+#include <vector>
+
+#define ORTC_SETTING_BUFFER_POOL_MAX_CACHED_BUFFERS_PER_SIZE_CLASS "ortc/buffer-pool/max-cached-buffers-per-size-class"
+#define ORTC_SETTING_BUFFER_POOL_MAX_THREAD_CACHED_BUFFERS_PER_SIZE_CLASS "ortc/buffer-pool/max-thread-cached-buffers-per-size-class"
+
+namespace ortc
+{
+  namespace internal
+  {
+    ZS_DECLARE_INTERACTION_PTR(IBufferPoolForSettings)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IBufferPoolForSettings
+    #pragma mark
+
+    interaction IBufferPoolForSettings
+    {
+      ZS_DECLARE_TYPEDEF_PTR(IBufferPoolForSettings, ForSettings)
+
+      static void applyDefaults();
+
+      virtual ~IBufferPoolForSettings() {}
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark BufferPool
+    #pragma mark
+
+    class BufferPool : public IBufferPoolForSettings
+    {
+    protected:
+      struct make_private {};
+
+    public:
+      friend interaction IBufferPoolForSettings;
+
+      enum SizeClasses
+      {
+        SizeClass_First,
+
+        SizeClass_256 = SizeClass_First,
+        SizeClass_1500,
+        SizeClass_9000,
+        SizeClass_64K,
+
+        SizeClass_Last = SizeClass_64K,
+      };
+      static const char *toString(SizeClasses sizeClass);
+      static size_t toSize(SizeClasses sizeClass);
+
+      ZS_DECLARE_STRUCT_PTR(Stats)
+
+      struct Stats
+      {
+        ULONGLONG mHits {};          // allocations satisfied from a cached buffer
+        ULONGLONG mMisses {};        // allocations that went to the global allocator
+        ULONGLONG mOutstanding {};   // pooled buffers currently handed out
+        ULONGLONG mCached {};        // buffers waiting in the shared free lists
+
+        ElementPtr toDebug() const;
+      };
+
+    protected:
+      struct Recycler;
+      struct ThreadCache;
+      template <typename T> struct ControlBlockAllocator;
+
+      typedef std::vector<SecureByteBlock *> BlockList;
+
+    public:
+      BufferPool(const make_private &);
+      ~BufferPool();
+
+    protected:
+      static BufferPoolPtr create();
+
+    public:
+      static BufferPoolPtr singleton();
+
+      // NOTE: The returned buffer is rounded up to its size class and may be
+      //       larger than requested. Callers must track the length they use.
+      //       Requests larger than the biggest size class are not pooled.
+      static SecureByteBlockPtr allocate(size_t sizeInBytes);
+
+      static Stats getStats();
+
+      static ElementPtr singletonToDebug();
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark BufferPool => (internal)
+      #pragma mark
+
+      static Log::Params slog(const char *message);
+      Log::Params log(const char *message) const;
+      Log::Params debug(const char *message) const;
+      ElementPtr toDebug() const;
+
+      static bool findSizeClass(
+                                size_t sizeInBytes,
+                                SizeClasses &outSizeClass
+                                );
+
+      SecureByteBlockPtr allocate(SizeClasses sizeClass);
+      void recycle(
+                   SecureByteBlock *block,
+                   SizeClasses sizeClass
+                   );
+      void release(ThreadCache &cache);
+
+      static ThreadCache &threadCache();
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark BufferPool => (data)
+      #pragma mark
+
+      AutoPUID mID;
+      BufferPoolWeakPtr mThisWeak;
+
+      mutable Lock mLock;
+
+      size_t mMaxCachedPerSizeClass {};
+      size_t mMaxThreadCachedPerSizeClass {};
+
+      BlockList mFree[SizeClass_Last+1];
+
+      std::atomic<ULONGLONG> mHits {};
+      std::atomic<ULONGLONG> mMisses {};
+      std::atomic<ULONGLONG> mOutstanding {};
+    };
+  }
+}
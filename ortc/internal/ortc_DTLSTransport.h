@@ -156,6 +156,8 @@ namespace ortc
 
       typedef CryptoPP::ByteQueue ByteQueue;
       typedef std::queue<SecureByteBlockPtr> PacketQueue;
+      typedef std::pair<PacketDemux::PacketTypes, SecureByteBlockPtr> TypedPacket;
+      typedef std::queue<TypedPacket> TypedPacketQueue;
 
       typedef std::list<PromisePtr> PromiseList;
 
@@ -261,6 +263,19 @@ namespace ortc
                               size_t bufferLengthInBytes
                               ) override;
 
+      virtual bool sendPacketInPlace(
+                                     IICETypes::Components sendOverICETransport,
+                                     IICETypes::Components packetType,
+                                     BYTE *buffer,
+                                     size_t bufferLengthInBytes,
+                                     size_t bufferTailroomInBytes
+                                     ) override;
+
+      virtual bool sendPackets(
+                               IICETypes::Components sendOverICETransport,
+                               const ISecureTransportTypes::OutgoingPacketList &packets
+                               ) override;
+
       virtual IICETransportPtr getICETransport() const override;
 
 
@@ -282,6 +297,14 @@ namespace ortc
       //                                     size_t bufferLengthInBytes
       //                                     ) override;
 
+      // (duplicate) virtual bool sendPacketInPlace(
+      //                                            IICETypes::Components sendOverICETransport,
+      //                                            IICETypes::Components packetType,
+      //                                            BYTE *buffer,
+      //                                            size_t bufferLengthInBytes,
+      //                                            size_t bufferTailroomInBytes
+      //                                            ) override;
+
       // (duplicate) virtual IICETransportPtr getICETransport() const = 0;
 
       //-----------------------------------------------------------------------
@@ -298,6 +321,7 @@ namespace ortc
 
       virtual bool handleReceivedPacket(
                                         IICETypes::Components viaTransport,
+                                        PacketDemux::PacketTypes packetType,
                                         const BYTE *buffer,
                                         size_t bufferLengthInBytes
                                         ) override;
@@ -322,6 +346,11 @@ namespace ortc
                                        size_t bufferLengthInBytes
                                        ) override;
 
+      virtual bool sendEncryptedPackets(
+                                        IICETypes::Components sendOverICETransport,
+                                        const ISecureTransportTypes::EncryptedPacketList &packets
+                                        ) override;
+
       virtual bool handleReceivedDecryptedPacket(
                                                  IICETypes::Components viaTransport,
                                                  IICETypes::Components packetType,
@@ -471,6 +500,8 @@ namespace ortc
       bool isShuttingDown() const;
       bool isShutdown() const;
 
+      UseSRTPTransportPtr getSRTPTransportForSending(size_t bufferLengthInBytes);
+
       void step();
       bool stepStartSSL();
       bool stepValidate();
@@ -742,7 +773,7 @@ namespace ortc
       size_t mMaxPendingRTPPackets {};
 
       bool mPutIncomingRTPIntoPendingQueue {true};
-      PacketQueue mPendingIncomingRTP;
+      TypedPacketQueue mPendingIncomingRTP;
       ByteQueue mPendingIncomingDTLS;
 
       PacketQueue mPendingOutgoingDTLS;
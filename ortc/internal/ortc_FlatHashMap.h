@@ -0,0 +1,295 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ortc
+{
+  namespace internal
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark FlatHashMap
+    #pragma mark
+
+    // Open addressing (linear probing) hash table for integer keys. All
+    // entries live in a single contiguous array so a lookup typically
+    // touches one or two cache lines regardless of how many keys are held.
+    //
+    // Erasing leaves a tombstone behind thus iterators remain valid while
+    // erasing during iteration (the "iter_doNotUse" pattern used with
+    // std::map). Inserting may rehash and invalidates all iterators.
+    template <typename TKey, typename TValue>
+    class FlatHashMap
+    {
+      static_assert(std::is_integral<TKey>::value, "FlatHashMap requires an integral key");
+
+    public:
+      typedef TKey key_type;
+      typedef TValue mapped_type;
+      typedef std::pair<TKey, TValue> value_type;
+      typedef size_t size_type;
+
+    protected:
+      enum SlotStates : BYTE
+      {
+        SlotState_Empty,
+        SlotState_Full,
+        SlotState_Erased,
+      };
+
+      typedef std::vector<value_type> EntryList;
+      typedef std::vector<BYTE> StateList;
+
+      static const size_t kMinCapacity = 16;
+
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark FlatHashMap::IteratorBase
+      #pragma mark
+
+      template <typename TMap, typename TEntry>
+      class IteratorBase
+      {
+      public:
+        friend class FlatHashMap;
+
+        IteratorBase() {}
+        IteratorBase(TMap *map, size_t index) : mMap(map), mIndex(index) {skip();}
+
+        TEntry &operator*() const                             {return mMap->mEntries[mIndex];}
+        TEntry *operator->() const                            {return &(mMap->mEntries[mIndex]);}
+
+        IteratorBase &operator++()                            {++mIndex; skip(); return *this;}
+        IteratorBase operator++(int)                          {IteratorBase temp(*this); ++(*this); return temp;}
+
+        bool operator==(const IteratorBase &op2) const        {return mIndex == op2.mIndex;}
+        bool operator!=(const IteratorBase &op2) const        {return mIndex != op2.mIndex;}
+
+      protected:
+        void skip()
+        {
+          while ((mIndex < mMap->mStates.size()) &&
+                 (SlotState_Full != mMap->mStates[mIndex])) {
+            ++mIndex;
+          }
+        }
+
+      protected:
+        TMap *mMap {};
+        size_t mIndex {};
+      };
+
+    public:
+      typedef IteratorBase<FlatHashMap, value_type> iterator;
+      typedef IteratorBase<const FlatHashMap, const value_type> const_iterator;
+
+    public:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark FlatHashMap (public)
+      #pragma mark
+
+      FlatHashMap() {}
+
+      iterator begin()                                        {return iterator(this, 0);}
+      iterator end()                                          {return iterator(this, mStates.size());}
+      const_iterator begin() const                            {return const_iterator(this, 0);}
+      const_iterator end() const                              {return const_iterator(this, mStates.size());}
+
+      size_type size() const                                  {return mSize;}
+      bool empty() const                                      {return 0 == mSize;}
+      size_type capacity() const                              {return mStates.size();}
+
+      //-----------------------------------------------------------------------
+      iterator find(TKey key)
+      {
+        size_t index = 0;
+        if (!locate(key, index)) return end();
+        return iterator(this, index);
+      }
+
+      //-----------------------------------------------------------------------
+      const_iterator find(TKey key) const
+      {
+        size_t index = 0;
+        if (!locate(key, index)) return end();
+        return const_iterator(this, index);
+      }
+
+      //-----------------------------------------------------------------------
+      TValue &operator[](TKey key)
+      {
+        size_t index = 0;
+        if (locate(key, index)) return mEntries[index].second;
+
+        if ((mSize + mErased + 1) * 10 > mStates.size() * 7) {
+          rehash(mSize + 1);
+        }
+
+        // probe for the first reusable slot (a tombstone may be reused)
+        size_t mask = mStates.size() - 1;
+        index = hash(key) & mask;
+        while (SlotState_Full == mStates[index]) {
+          index = (index + 1) & mask;
+        }
+
+        if (SlotState_Erased == mStates[index]) --mErased;
+
+        mStates[index] = SlotState_Full;
+        mEntries[index].first = key;
+        mEntries[index].second = TValue();
+        ++mSize;
+        return mEntries[index].second;
+      }
+
+      //-----------------------------------------------------------------------
+      void erase(iterator iter)
+      {
+        size_t index = iter.mIndex;
+        if (index >= mStates.size()) return;
+        if (SlotState_Full != mStates[index]) return;
+
+        mStates[index] = SlotState_Erased;
+        mEntries[index] = value_type();   // release the value now rather than at rehash
+        --mSize;
+        ++mErased;
+      }
+
+      //-----------------------------------------------------------------------
+      size_type erase(TKey key)
+      {
+        size_t index = 0;
+        if (!locate(key, index)) return 0;
+        erase(iterator(this, index));
+        return 1;
+      }
+
+      //-----------------------------------------------------------------------
+      void clear()
+      {
+        EntryList().swap(mEntries);
+        StateList().swap(mStates);
+        mSize = 0;
+        mErased = 0;
+      }
+
+      //-----------------------------------------------------------------------
+      void reserve(size_type count)
+      {
+        if (count * 10 <= mStates.size() * 7) return;
+        rehash(count);
+      }
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark FlatHashMap (internal)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      static size_t hash(TKey key)
+      {
+        // fibonacci hashing spreads sequential (and low entropy) SSRCs and
+        // identifiers across the whole table
+        ULONGLONG value = static_cast<ULONGLONG>(key) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(value ^ (value >> 32));
+      }
+
+      //-----------------------------------------------------------------------
+      bool locate(TKey key, size_t &outIndex) const
+      {
+        if (0 == mSize) return false;
+
+        size_t mask = mStates.size() - 1;
+        size_t index = hash(key) & mask;
+
+        while (SlotState_Empty != mStates[index]) {
+          if ((SlotState_Full == mStates[index]) &&
+              (key == mEntries[index].first)) {
+            outIndex = index;
+            return true;
+          }
+          index = (index + 1) & mask;
+        }
+        return false;
+      }
+
+      //-----------------------------------------------------------------------
+      void rehash(size_type minimumEntries)
+      {
+        size_t capacity = kMinCapacity;
+        while (minimumEntries * 2 > capacity) {
+          capacity *= 2;
+        }
+
+        EntryList oldEntries(capacity);
+        StateList oldStates(capacity, static_cast<BYTE>(SlotState_Empty));
+
+        oldEntries.swap(mEntries);
+        oldStates.swap(mStates);
+
+        size_t mask = capacity - 1;
+
+        for (size_t oldIndex = 0; oldIndex < oldStates.size(); ++oldIndex) {
+          if (SlotState_Full != oldStates[oldIndex]) continue;
+
+          size_t index = hash(oldEntries[oldIndex].first) & mask;
+          while (SlotState_Empty != mStates[index]) {
+            index = (index + 1) & mask;
+          }
+
+          mStates[index] = SlotState_Full;
+          mEntries[index] = std::move(oldEntries[oldIndex]);
+        }
+
+        mErased = 0;
+      }
+
+    protected:
+      EntryList mEntries;
+      StateList mStates;
+
+      size_t mSize {};
+      size_t mErased {};
+    };
+
+  }
+}
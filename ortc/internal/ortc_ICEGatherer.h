@@ -35,12 +35,20 @@
 
 #include <ortc/IICEGatherer.h>
 
+#include <ortc/internal/ortc_FlatHashMap.h>
 #include <ortc/internal/ortc_ICEGathererRouter.h>
+#include <ortc/internal/ortc_NetworkMonitor.h>
+#include <ortc/internal/ortc_PacketDemux.h>
+#include <ortc/internal/ortc_STUNMessageIntegrity.h>
+#include <ortc/internal/ortc_TimerWheel.h>
+#include <ortc/internal/ortc_TCPFraming.h>
+#include <ortc/internal/ortc_UDPBatch.h>
 
 #include <openpeer/services/IBackOffTimer.h>
 #include <openpeer/services/IDNS.h>
 #include <openpeer/services/IWakeDelegate.h>
 #include <openpeer/services/ISTUNDiscovery.h>
+#include <openpeer/services/ISTUNRequester.h>
 #include <openpeer/services/ITURNSocket.h>
 #include <openpeer/services/STUNPacket.h>
 
@@ -73,6 +81,7 @@
 
 #define ORTC_SETTING_GATHERER_REFLEXIVE_INACTIVITY_TIMEOUT_IN_SECONDS "ortc/gatherer/reflexive-inactivity-timeout-in-seconds"
 #define ORTC_SETTING_GATHERER_RELAY_INACTIVITY_TIMEOUT_IN_SECONDS "ortc/gatherer/relay-inactivity-timeout-in-seconds"
+#define ORTC_SETTING_GATHERER_INACTIVITY_TIMER_RESOLUTION_IN_MILLISECONDS "ortc/gatherer/inactivity-timer-resolution-in-milliseconds"
 
 #define ORTC_SETTING_GATHERER_MAX_INCOMING_PACKET_BUFFERING_TIME_IN_SECONDS "ortc/gatherer/max-incoming-packet-buffering-time-in-seconds"
 #define ORTC_SETTING_GATHERER_MAX_TOTAL_INCOMING_PACKET_BUFFERING "ortc/gatherer/max-total-packet-buffering"
@@ -86,6 +95,9 @@
 
 #define ORTC_SETTING_GATHERER_RECHECK_IP_ADDRESSES_IN_SECONDS "ortc/gatherer/recheck-ip-addresses-in-seconds"
 
+#define ORTC_SETTING_GATHERER_TURN_CHANNEL_FAST_PATH "ortc/gatherer/turn-channel-fast-path"
+#define ORTC_SETTING_GATHERER_TURN_CHANNEL_IDLE_TIMEOUT_IN_SECONDS "ortc/gatherer/turn-channel-idle-timeout-in-seconds"
+
 namespace ortc
 {
   namespace internal
@@ -148,8 +160,10 @@ namespace ortc
       virtual IICEGathererSubscriptionPtr subscribe(IICEGathererDelegatePtr delegate) = 0;
 
       virtual bool isContinousGathering() const = 0;
+      virtual bool isICELite() const = 0;
       virtual String getUsernameFrag() const = 0;
       virtual String getPassword() const = 0;
+      virtual STUNMessageIntegrityPtr getMessageIntegrity() const = 0;
 
       virtual CandidateListPtr getLocalCandidates() const = 0;
 
@@ -165,9 +179,43 @@ namespace ortc
                               size_t bufferSizeInBytes
                               ) = 0;
 
+      virtual bool sendPackets(
+                               UseICETransport &transport,
+                               RouterRoutePtr routerRoute,
+                               const UDPBatchSender::PacketList &packets
+                               ) = 0;
+
       virtual void notifyLikelyReflexiveActivity(RouterRoutePtr routerRoute) = 0;
     };
 
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IICEGathererForICESharedPort
+    #pragma mark
+
+    interaction IICEGathererForICESharedPort
+    {
+      ZS_DECLARE_TYPEDEF_PTR(IICEGathererForICESharedPort, ForICESharedPort)
+
+      ZS_DECLARE_TYPEDEF_PTR(zsLib::Socket, Socket)
+
+      virtual PUID getID() const = 0;
+
+      virtual void notifySharedUDPDatagrams(
+                                            SocketPtr socket,
+                                            UDPBatchReceiver::DatagramList &datagrams
+                                            ) = 0;
+
+      virtual void notifySharedTCPConnection(
+                                             SocketPtr listenSocket,
+                                             SocketPtr socket,
+                                             const IPAddress &remoteIP
+                                             ) = 0;
+    };
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -201,13 +249,16 @@ namespace ortc
                         public IICEGatherer,
                         public IICEGathererForSettings,
                         public IICEGathererForICETransport,
+                        public IICEGathererForICESharedPort,
                         public IGathererAsyncDelegate,
+                        public INetworkMonitorDelegate,
                         public IWakeDelegate,
                         public IDNSDelegate,
                         public zsLib::ITimerDelegate,
                         public zsLib::ISocketDelegate,
                         public IBackOffTimerDelegate,
                         public ISTUNDiscoveryDelegate,
+                        public openpeer::services::ISTUNRequesterDelegate,
                         public ITURNSocketDelegate
     {
     protected:
@@ -220,6 +271,7 @@ namespace ortc
       friend interaction IICEGathererFactory;
       friend interaction IICEGathererForSettings;
       friend interaction IICEGathererForICETransport;
+      friend interaction IICEGathererForICESharedPort;
 
       typedef IICEGatherer::States States;
 
@@ -289,8 +341,10 @@ namespace ortc
 
       ZS_DECLARE_CLASS_PTR(HostIPSorter)
       ZS_DECLARE_STRUCT_PTR(HostPort)
+      ZS_DECLARE_STRUCT_PTR(UDPReceiver)
       ZS_DECLARE_STRUCT_PTR(ReflexivePort)
       ZS_DECLARE_STRUCT_PTR(RelayPort)
+      ZS_DECLARE_STRUCT_PTR(TURNChannel)
       ZS_DECLARE_STRUCT_PTR(TCPPort)
       ZS_DECLARE_STRUCT_PTR(BufferedPacket)
       ZS_DECLARE_STRUCT_PTR(Route)
@@ -302,6 +356,8 @@ namespace ortc
 
       typedef std::map<IPAddress, HostPortPtr> IPToHostPortMap;
       typedef std::map<SocketPtr, HostPortPtr> SocketToHostPortMap;
+      typedef std::vector<SocketPtr> SocketList;
+      typedef std::map<SocketPtr, UDPReceiverPtr> SocketToUDPReceiverMap;
       typedef std::map<UseSTUNDiscoveryPtr, HostAndReflexivePortPair> STUNToReflexivePortMap;
       typedef std::map<UseTURNSocketPtr, HostAndRelayPortPair> TURNToRelayPortMap;
 
@@ -314,11 +370,17 @@ namespace ortc
       typedef std::map<CandidateHash, CandidatePair> CandidateMap;
 
       typedef std::list<ReflexivePortPtr> ReflexivePortList;
-      typedef std::map<TimerPtr, HostAndReflexivePortPair> TimerToReflexivePortMap;
+      typedef TimerWheel<HostAndReflexivePortPair> ReflexiveInactivityTimerWheel;
 
       typedef std::list<RelayPortPtr> RelayPortList;
       typedef std::map<IPAddress, RelayPortPtr> IPToRelayPortMap;
-      typedef std::map<TimerPtr, HostAndRelayPortPair> TimerToRelayPortMap;
+      typedef TimerWheel<HostAndRelayPortPair> RelayInactivityTimerWheel;
+
+      typedef WORD TURNChannelNumber;
+      typedef std::map<IPAddress, TURNChannelPtr> PeerToTURNChannelMap;
+      typedef FlatHashMap<TURNChannelNumber, TURNChannelPtr> TURNChannelNumberMap;
+      typedef std::pair<RelayPortPtr, TURNChannelPtr> RelayPortAndTURNChannelPair;
+      typedef std::map<ISTUNRequesterPtr, RelayPortAndTURNChannelPair> STUNRequesterToTURNChannelMap;
 
       typedef std::pair<HostPortPtr, TCPPortPtr> HostAndTCPPortPair;
       typedef std::map<SocketPtr, HostAndTCPPortPair> SocketToTCPPortMap;
@@ -333,12 +395,11 @@ namespace ortc
       typedef std::list<InstalledTransportPtr> TransportList;
 
       typedef PUID RouteID;
-      typedef std::map<RouteID, RoutePtr> RouteMap;
+      typedef FlatHashMap<RouteID, RoutePtr> RouteMap;
 
-      typedef std::pair<CandidatePtr, IPAddress> LocalCandidateRemoteIPPair;
-      typedef std::map<LocalCandidateRemoteIPPair, RoutePtr> LocalCandidateRemoteIPRouteMap;
-
-      typedef CryptoPP::ByteQueue ByteQueue;
+      typedef ICEGathererRouter::RouteKey QuickSearchRouteKey;
+      typedef std::vector<RoutePtr> QuickSearchRouteList;
+      typedef FlatHashMap<QuickSearchRouteKey, QuickSearchRouteList> QuickSearchRouteMap;
 
     public:
       struct ConstructorOptions
@@ -431,8 +492,10 @@ namespace ortc
       // (duplicate) virtual CandidateListPtr getLocalCandidates() const = 0;
 
       virtual bool isContinousGathering() const override;
+      virtual bool isICELite() const override;
       virtual String getUsernameFrag() const override {return mUsernameFrag;}
       virtual String getPassword() const override {return mPassword;}
+      virtual STUNMessageIntegrityPtr getMessageIntegrity() const override {return mMessageIntegrity;}
 
       virtual ICEGathererRouterPtr getGathererRouter() const override;
 
@@ -446,8 +509,32 @@ namespace ortc
                               size_t bufferSizeInBytes
                               ) override;
 
+      virtual bool sendPackets(
+                               UseICETransport &transport,
+                               RouterRoutePtr routerRoute,
+                               const UDPBatchSender::PacketList &packets
+                               ) override;
+
       virtual void notifyLikelyReflexiveActivity(RouterRoutePtr routerRoute) override;
 
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICEGatherer => IICEGathererForICESharedPort
+      #pragma mark
+
+      // (duplicate) virtual PUID getID() const;
+
+      virtual void notifySharedUDPDatagrams(
+                                            SocketPtr socket,
+                                            UDPBatchReceiver::DatagramList &datagrams
+                                            ) override;
+
+      virtual void notifySharedTCPConnection(
+                                             SocketPtr listenSocket,
+                                             SocketPtr socket,
+                                             const IPAddress &remoteIP
+                                             ) override;
+
       //-----------------------------------------------------------------------
       #pragma mark
       #pragma mark ICEGatherer => IGathererAsyncDelegate
@@ -460,6 +547,14 @@ namespace ortc
 
       virtual void onResolveStatsPromise(IStatsProvider::PromiseWithStatsReportPtr promise) override;
 
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICEGatherer => INetworkMonitorDelegate
+      #pragma mark
+
+      virtual void onNetworkMonitorInterfacesChanged() override;
+      virtual void onNetworkMonitorFailed() override;
+
       //-----------------------------------------------------------------------
       #pragma mark
       #pragma mark ICEGatherer => IWakeDelegate
@@ -513,6 +608,25 @@ namespace ortc
 
       virtual void onSTUNDiscoveryCompleted(ISTUNDiscoveryPtr discovery) override;
 
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICEGatherer => ISTUNRequesterDelegate
+      #pragma mark
+
+      virtual void onSTUNRequesterSendPacket(
+                                             ISTUNRequesterPtr requester,
+                                             IPAddress destination,
+                                             SecureByteBlockPtr packet
+                                             ) override;
+
+      virtual bool handleSTUNRequesterResponse(
+                                               ISTUNRequesterPtr requester,
+                                               IPAddress fromIPAddress,
+                                               STUNPacketPtr response
+                                               ) override;
+
+      virtual void onSTUNRequesterTimedOut(ISTUNRequesterPtr requester) override;
+
       //-----------------------------------------------------------------------
       #pragma mark
       #pragma mark ICEGatherer => ITURNSocketDelegate
@@ -673,7 +787,7 @@ namespace ortc
         CandidatePtr mCandidate;
 
         Time mLastActivity;
-        TimerPtr mInactivityTimer;
+        ReflexiveInactivityTimerWheel::TimerID mInactivityTimer {};
 
         ElementPtr toDebug() const;
       };
@@ -699,7 +813,39 @@ namespace ortc
         CandidatePtr mReflexiveCandidate;
 
         Time mLastActivity;
-        TimerPtr mInactivityTimer;
+        RelayInactivityTimerWheel::TimerID mInactivityTimer {};
+
+        // channels bound by the gatherer itself (the TURN socket only
+        // carries traffic for peers without a bound channel)
+        PeerToTURNChannelMap mPeerChannels;
+        TURNChannelNumberMap mChannelNumbers;
+        TURNChannelNumber mNextChannelNumber {PacketDemux::kTURNChannelNumberFirst};
+        String mRealm;
+        String mNonce;
+
+        ElementPtr toDebug() const;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICEGatherer::TURNChannel
+      #pragma mark
+
+      struct TURNChannel
+      {
+        AutoPUID mID;
+
+        TURNChannelNumber mNumber {};
+        IPAddress mPeerIP;
+
+        ISTUNRequesterPtr mBindRequester;   // outstanding ChannelBind (initial or refresh)
+        bool mBound {false};
+        bool mFailed {false};               // server refused the binding (the TURN socket keeps carrying the traffic)
+        Time mBoundAt;
+        Time mLastUsed;
 
         ElementPtr toDebug() const;
       };
@@ -722,6 +868,8 @@ namespace ortc
         CandidatePtr mCandidateUDP;
         IPAddress mBoundUDPIP;
         SocketPtr mBoundUDPSocket;
+        SocketList mBoundUDPShardSockets;   // extra SO_REUSEPORT sockets bound to mBoundUDPIP
+        bool mSharedUDP {false};            // mBoundUDPSocket belongs to ICESharedPort
         UseBackOffTimerPtr mBindUDPBackOffTimer;
         
         CandidatePtr mCandidateTCPPassive;
@@ -729,6 +877,7 @@ namespace ortc
 
         IPAddress mBoundTCPIP;
         SocketPtr mBoundTCPSocket;
+        bool mSharedTCP {false};            // mBoundTCPSocket belongs to ICESharedPort
         UseBackOffTimerPtr mBindTCPBackOffTimer;
 
         bool mWarmUpAfterBinding {true};
@@ -742,9 +891,29 @@ namespace ortc
 
         SocketToTCPPortMap mTCPPorts;
 
+        Lock mUDPSendLock;                  // guards mUDPBatchSender; taken without the gatherer lock held
+        UDPBatchSender mUDPBatchSender;
+
+        SocketToUDPReceiverMap mUDPReceivers; // one per bound UDP socket (primary and shards)
+
         ElementPtr toDebug() const;
       };
 
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICEGatherer::UDPReceiver
+      #pragma mark
+
+      struct UDPReceiver
+      {
+        Lock mLock;                         // taken without the gatherer lock held
+        bool mClosed {false};               // the socket was closed (or is closing)
+        UDPBatchReceiver mReceiver;
+      };
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -764,8 +933,8 @@ namespace ortc
 
         IPAddress mRemoteIP;
         SocketPtr mSocket;
-        ByteQueue mIncomingBuffer;
-        ByteQueue mOutgoingBuffer;
+        TCPFrameReader mReader;       // RFC 4571 frames are handed on as slices of its ring
+        TCPFrameWriter mWriter;
 
         TransportID mTransportID {0};
         UseICETransportWeakPtr mTransport;
@@ -789,10 +958,53 @@ namespace ortc
         STUNPacketPtr mSTUNPacket;
         String mRFrag;
 
-        SecureByteBlockPtr mBuffer;
+        PacketDemux::PacketTypes mPacketType {PacketDemux::PacketType_Unknown};
+        SecureByteBlockPtr mBuffer;   // NOTE: pooled, may be larger than mBufferSize
+        size_t mBufferSize {};
 
         ElementPtr toDebug() const;
       };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICEGatherer::IncomingUDPPacket
+      #pragma mark
+
+      struct IncomingUDPPacket
+      {
+        UDPBatchReceiver::Datagram mDatagram;
+        PacketDemux::PacketTypes mPacketType {PacketDemux::PacketType_Unknown};
+        STUNPacketPtr mSTUNPacket;
+
+        UseTURNSocketPtr mTURNSocket;     // set if arrived from a TURN server
+        CandidatePtr mLocalCandidate;     // set if arrived directly on the host candidate (or the relay candidate for bound channel data)
+
+        RelayPortPtr mRelayPort;          // set if unwrapped from a bound TURN channel
+        TURNChannelPtr mTURNChannel;
+        size_t mPayloadOffset {};         // channel data payload position within the datagram
+        size_t mPayloadSize {};
+      };
+      typedef std::vector<IncomingUDPPacket> IncomingUDPPacketList;
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICEGatherer::IncomingTCPFrame
+      #pragma mark
+
+      struct IncomingTCPFrame
+      {
+        const BYTE *mBuffer {};           // slice of the TCP port's read ring (not copied)
+        size_t mSize {};
+        PacketDemux::PacketTypes mPacketType {PacketDemux::PacketType_Unknown};
+        STUNPacketPtr mSTUNPacket;
+      };
+      typedef std::vector<IncomingTCPFrame> IncomingTCPFrameList;
       
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -812,6 +1024,7 @@ namespace ortc
 
         Time mLastUsed;
         CandidatePtr mLocalCandidate;
+        CandidatePtr mQuickSearchCandidate;   // candidate the quick search route is keyed upon
 
         TransportID mTransportID {};
         UseICETransportWeakPtr mTransport;
@@ -897,6 +1110,7 @@ namespace ortc
       void stepGetHostIPs_WinRT();
       void stepGetHostIPs_Win32();
       void stepGetHostIPs_ifaddr();
+      void stepGetHostIPs_NetworkMonitor();
       bool stepCalculateHostsHash();
       bool stepFixHostPorts();
       bool stepBindHostPorts();
@@ -928,6 +1142,27 @@ namespace ortc
 
       bool needsHostPort(HostIPSorter::DataPtr hostData);
 
+      void installInactivityTimer(
+                                  HostPortPtr hostPort,
+                                  ReflexivePortPtr reflexivePort,
+                                  Time fireAt
+                                  );
+      void installInactivityTimer(
+                                  HostPortPtr hostPort,
+                                  RelayPortPtr relayPort,
+                                  Time fireAt
+                                  );
+      void handleInactivityTimers();
+      void stepInactivityTimer();
+      void handleInactivity(
+                            HostPortPtr hostPort,
+                            ReflexivePortPtr reflexivePort
+                            );
+      void handleInactivity(
+                            HostPortPtr hostPort,
+                            RelayPortPtr relayPort
+                            );
+
       void shutdown(HostPortPtr hostPort);
       void shutdown(
                     ReflexivePortPtr reflexivePort,
@@ -947,6 +1182,39 @@ namespace ortc
                      IPAddress &ioBindIP,
                      IICETypes::Protocols protocol
                      );
+      SocketPtr bindShared(
+                           IPAddress &ioBindIP,
+                           IICETypes::Protocols protocol
+                           );
+      void closeHostSocket(
+                           SocketPtr socket,
+                           bool shared
+                           );
+      void addSharedRoute(
+                          HostPortPtr hostPort,
+                          const IPAddress &remoteIP
+                          );
+      void removeSharedRoute(
+                             HostPortPtr hostPort,
+                             const IPAddress &remoteIP
+                             );
+      void validateSharedRoute(
+                               HostPortPtr hostPort,
+                               const IPAddress &remoteIP,
+                               bool integrityPassed
+                               );
+      void bindUDPShards(HostPortPtr hostPort);
+
+      void monitorUDPSocket(SocketPtr socket);
+      void closeUDPSocket(SocketPtr socket);
+      void removeUDPReceiver(
+                             HostPort &hostPort,
+                             SocketPtr socket
+                             );
+      static bool isUDPSocket(
+                              const HostPort &hostPort,
+                              SocketPtr socket
+                              );
 
       CandidatePtr createCandidate(
                                    HostIPSorter::DataPtr hostData,
@@ -981,16 +1249,39 @@ namespace ortc
                 HostPortPtr hostPort,
                 SocketPtr socket
                 );
+      void demuxUDPDatagrams(
+                             UDPBatchReceiver::DatagramList &datagrams,
+                             size_t totalDatagrams,
+                             IncomingUDPPacketList &outPackets
+                             );
+      void classifyUDPDatagrams(
+                                HostPort &hostPort,
+                                IncomingUDPPacketList &packets
+                                );
+      void installIncomingTCPPort(
+                                  HostPortPtr hostPort,
+                                  TCPPortPtr tcpPort
+                                  );
       void read(
                 HostPort &hostPort,
                 TCPPort &tcpPort
                 );
+      void handleIncomingUDPPacket(
+                                   HostPortPtr hostPort,
+                                   SocketPtr socket,
+                                   IncomingUDPPacket &packet
+                                   );
 
       void write(
                  HostPort &hostPort,
                  SocketPtr socket
                  );
       bool writeIfTCPPort(SocketPtr socket);
+      bool sendTCPFrame(
+                        TCPPort &tcpPort,
+                        const BYTE *buffer,
+                        size_t bufferSizeInBytes
+                        );
 
       void close(
                  HostPortPtr hostPort,
@@ -1004,11 +1295,15 @@ namespace ortc
       SecureByteBlockPtr handleIncomingPacket(
                                               CandidatePtr localCandidate,
                                               const IPAddress &remoteIP,
-                                              STUNPacketPtr stunPacket
+                                              STUNPacketPtr stunPacket,
+                                              const BYTE *buffer,
+                                              size_t bufferSizeInBytes,
+                                              bool *outIntegrityPassed = NULL
                                               );
       void handleIncomingPacket(
                                 CandidatePtr localCandidate,
                                 const IPAddress &remoteIP,
+                                PacketDemux::PacketTypes packetType,
                                 const BYTE *buffer,
                                 size_t bufferSizeInBytes
                                 );
@@ -1025,6 +1320,16 @@ namespace ortc
                             UseICETransportPtr transport
                             );
 
+      static QuickSearchRouteKey toQuickSearchRouteKey(
+                                                       CandidatePtr localCandidate,
+                                                       const IPAddress &remoteIP
+                                                       );
+      RoutePtr findQuickSearchRoute(
+                                    CandidatePtr localCandidate,
+                                    const IPAddress &remoteIP
+                                    ) const;
+      void removeQuickSearchRoute(RoutePtr route);
+
       void fix(STUNPacketPtr stunPacket) const;
 
       void removeAllRelatedRoutes(
@@ -1040,6 +1345,36 @@ namespace ortc
                          size_t bufferSizeInBytes
                          );
 
+      bool sendUDPPackets(
+                          HostPort &hostPort,
+                          SocketPtr socket,
+                          const IPAddress &boundIP,
+                          const IPAddress &remoteIP,
+                          const UDPBatchSender::PacketList &packets
+                          );
+
+      TURNChannelPtr findTURNChannel(
+                                     RelayPortPtr relayPort,
+                                     const IPAddress &peerIP,
+                                     bool bindIfMissing
+                                     );
+      void bindTURNChannel(
+                           RelayPortPtr relayPort,
+                           TURNChannelPtr channel
+                           );
+      void refreshTURNChannels();
+      void clearTURNChannels(RelayPort &relayPort);
+      void resolveTURNChannelData(
+                                  RelayPortPtr relayPort,
+                                  IncomingUDPPacket &packet
+                                  );
+      bool sendTURNChannelData(
+                               RelayPort &relayPort,
+                               const TURNChannel &channel,
+                               const BYTE *buffer,
+                               size_t bufferSizeInBytes
+                               );
+
       bool shouldKeepWarm() const;
       bool shouldWarmUpAfterInterfaceBinding() const;
 
@@ -1070,6 +1405,7 @@ namespace ortc
       Components mComponent {Component_RTP};
       String mUsernameFrag;
       String mPassword;
+      STUNMessageIntegrityPtr mMessageIntegrity;
 
       ICEGathererPtr mRTPGatherer;
       ICEGathererWeakPtr mRTCPGatherer;
@@ -1083,6 +1419,7 @@ namespace ortc
       bool mGetLocalIPsNow {true};
       Seconds mRecheckIPsDuration {};
       TimerPtr mRecheckIPsTimer;
+      bool mUseNetworkMonitor {false};          // interface changes are pushed thus no recheck timer is needed
       HostIPSorter::DataList mPendingHostIPs;
       HostIPSorter::DataList mResolvedHostIPs;
       HostIPSorter::QueryMap mResolveHostIPQueries;
@@ -1104,6 +1441,11 @@ namespace ortc
       TURNToRelayPortMap mTURNSockets;
       TURNToRelayPortMap mShutdownTURNSockets;
 
+      bool mUseTURNChannels {true};
+      Seconds mTURNChannelIdleTimeout {};
+      STUNRequesterToTURNChannelMap mTURNChannelBindRequests;
+      TimerPtr mTURNChannelRefreshTimer;
+
       String mHasSTUNServersOptionsHash;
       bool mHasSTUNServers {false};
 
@@ -1122,12 +1464,20 @@ namespace ortc
       TimerPtr mWarmUpAterNewInterfaceBindingTimer;
 
       Seconds mReflexiveInactivityTime {};
-      TimerToReflexivePortMap mReflexiveInactivityTimers;
+      ReflexiveInactivityTimerWheel mReflexiveInactivityTimers;
 
       Seconds mRelayInactivityTime {};
-      TimerToRelayPortMap mRelayInactivityTimers;
+      RelayInactivityTimerWheel mRelayInactivityTimers;
+
+      TimerPtr mInactivityTimer;   // one shot, armed for the nearest wake up of both inactivity timer wheels
+      Time mInactivityTimerWakeUp;
 
       bool mGatherPassiveTCP {false};
+
+      bool mUseSocketReactor {false};
+      size_t mUDPShardsPerPort {1};
+
+      bool mUseSharedPort {false};
       SocketToTCPPortMap mTCPPorts;
       CandidateToTCPPortMap mTCPCandidateToTCPPorts;
       size_t mMaxTCPBufferingSizePendingConnection {};
@@ -1138,7 +1488,7 @@ namespace ortc
       size_t mMaxTotalBuffers {};
       BufferedPacketList mBufferedPackets;
 
-      LocalCandidateRemoteIPRouteMap mQuickSearchRoutes;
+      QuickSearchRouteMap mQuickSearchRoutes;
       RouteMap mRoutes;
       TimerPtr mCleanUnusedRoutesTimer;
       Seconds mCleanUnusedRoutesDuration {};
@@ -32,6 +32,7 @@
 #pragma once
 
 #include <ortc/internal/types.h>
+#include <ortc/internal/ortc_FlatHashMap.h>
 
 #include <ortc/IICEGatherer.h>
 
@@ -64,8 +65,15 @@ namespace ortc
       ZS_DECLARE_TYPEDEF_PTR(IICETypes::Candidate, Candidate)
 
       typedef String LocalCandidateHash;
-      typedef std::pair<LocalCandidateHash, IPAddress> CandidateRemoteIPPair;
-      typedef std::map<CandidateRemoteIPPair, RouteWeakPtr> CandidateRemoteIPToRouteMap;
+      typedef DWORD LocalCandidateID;
+      typedef std::map<LocalCandidateHash, LocalCandidateID> LocalCandidateIDMap;
+
+      // routes are keyed by a digest of (local candidate, remote IP:port);
+      // the digest is not unique thus each slot holds every route sharing
+      // the digest (almost always exactly one)
+      typedef QWORD RouteKey;
+      typedef std::vector<RouteWeakPtr> RouteWeakList;
+      typedef FlatHashMap<RouteKey, RouteWeakList> RouteKeyMap;
 
     public:
       ICEGathererRouter(
@@ -96,6 +104,11 @@ namespace ortc
                                  bool createRouteIfNeeded
                                  );
 
+      static RouteKey toRouteKey(
+                                 QWORD localCandidateKey,
+                                 const IPAddress &remoteIP
+                                 );
+
     protected:
       //-----------------------------------------------------------------------
       #pragma mark
@@ -117,6 +130,8 @@ namespace ortc
 
       void cancel();
 
+      LocalCandidateID getLocalCandidateID(const LocalCandidateHash &hash);
+
     public:
       //-----------------------------------------------------------------------
       #pragma mark
@@ -127,6 +142,7 @@ namespace ortc
       {
         AutoPUID mID;
 
+        LocalCandidateID mLocalCandidateID {};
         CandidatePtr mLocalCandidate;
         IPAddress mRemoteIP;
 
@@ -143,7 +159,10 @@ namespace ortc
       AutoPUID mID;
       ICEGathererRouterWeakPtr mThisWeak;
 
-      CandidateRemoteIPToRouteMap mRoutes;
+      LocalCandidateID mLastLocalCandidateID {};
+      LocalCandidateIDMap mLocalCandidateIDs;
+
+      RouteKeyMap mRoutes;
 
       TimerPtr mTimer;
     };
@@ -0,0 +1,313 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+#include <ortc/internal/ortc_UDPBatch.h>
+#include <ortc/internal/ortc_TimerWheel.h>
+
+#include <ortc/IICETypes.h>
+
+#include <openpeer/services/STUNPacket.h>
+
+#include <zsLib/Socket.h>
+#include <zsLib/Timer.h>
+
+#include <list>
+#include <map>
+
+#define ORTC_SETTING_ICE_SHARED_PORT_PORT "ortc/ice-shared-port/port"                                       // 0 = every gatherer binds its own ports
+#define ORTC_SETTING_ICE_SHARED_PORT_MAX_ROUTES "ortc/ice-shared-port/max-routes"
+#define ORTC_SETTING_ICE_SHARED_PORT_LEARNED_ROUTE_TIMEOUT_IN_SECONDS "ortc/ice-shared-port/learned-route-timeout-in-seconds"
+#define ORTC_SETTING_ICE_SHARED_PORT_MAX_PENDING_TCP_CONNECTIONS "ortc/ice-shared-port/max-pending-tcp-connections"
+#define ORTC_SETTING_ICE_SHARED_PORT_PENDING_TCP_TIMEOUT_IN_SECONDS "ortc/ice-shared-port/pending-tcp-timeout-in-seconds"
+
+namespace ortc
+{
+  namespace internal
+  {
+    ZS_DECLARE_INTERACTION_PTR(IICESharedPortForSettings)
+    ZS_DECLARE_INTERACTION_PTR(IICEGathererForICESharedPort)
+
+    ZS_DECLARE_CLASS_PTR(ICESharedPort)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IICESharedPortForSettings
+    #pragma mark
+
+    interaction IICESharedPortForSettings
+    {
+      ZS_DECLARE_TYPEDEF_PTR(IICESharedPortForSettings, ForSettings)
+
+      static void applyDefaults();
+
+      virtual ~IICESharedPortForSettings() {}
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ICESharedPort
+    #pragma mark
+
+    // Server mode: a single UDP socket (and a single passive TCP listen socket)
+    // per host IP, bound to a configured port, is shared by every gatherer in
+    // the process instead of each gatherer binding its own ports.
+    //
+    // Incoming UDP datagrams are demultiplexed by remote address using a
+    // route cache kept in sync with the gatherers' own routes. A datagram from
+    // an unknown remote is only accepted if it is a STUN binding request whose
+    // USERNAME starts with a registered local username fragment. The remote
+    // is only cached for the gatherer once the gatherer confirms the request
+    // passed its message integrity check; until a gatherer holds a route of
+    // its own binding requests keep being demultiplexed by username fragment
+    // and unused learned routes expire. Incoming TCP connections are held
+    // until their first framed STUN binding request arrives and then handed
+    // to the gatherer owning the username fragment.
+    //
+    // NOTE: a username fragment can only be registered once thus the
+    //       associated RTCP gatherer (which shares its RTP gatherer's
+    //       username fragment) keeps binding its own ports.
+    class ICESharedPort : public IICESharedPortForSettings,
+                          public zsLib::ISocketDelegate,
+                          public zsLib::ITimerDelegate,
+                          public ISingletonManagerDelegate
+    {
+    protected:
+      struct make_private {};
+
+      ZS_DECLARE_STRUCT_PTR(SharedSocket)
+      ZS_DECLARE_STRUCT_PTR(PendingTCPConnection)
+
+    public:
+      friend interaction IICESharedPortForSettings;
+
+      ZS_DECLARE_TYPEDEF_PTR(zsLib::Socket, Socket)
+      ZS_DECLARE_TYPEDEF_PTR(IICEGathererForICESharedPort, UseGatherer)
+      ZS_DECLARE_TYPEDEF_PTR(openpeer::services::STUNPacket, STUNPacket)
+
+    public:
+      ICESharedPort(const make_private &);
+
+    protected:
+      static ICESharedPortPtr create();
+
+    public:
+      ~ICESharedPort();
+
+      static ICESharedPortPtr singleton();
+
+      // true if a shared port is configured
+      static bool isEnabled();
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: claim a local username fragment for a gatherer
+      // RETURNS: false if shared mode is off or the fragment is already
+      //          claimed (the gatherer must bind its own ports)
+      static bool registerUsernameFrag(
+                                       UseGathererPtr gatherer,
+                                       const String &usernameFrag
+                                       );
+      static void unregisterUsernameFrag(
+                                         PUID gathererID,
+                                         const String &usernameFrag
+                                         );
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: obtain the shared socket for a host IP (binding it on first
+      //          use); ioBindIP receives the shared port
+      // RETURNS: SocketPtr() if the shared port could not be bound
+      static SocketPtr attach(
+                              UseGathererPtr gatherer,
+                              IPAddress &ioBindIP,
+                              IICETypes::Protocols protocol
+                              );
+      static void detach(
+                         PUID gathererID,
+                         SocketPtr socket
+                         );
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: route datagrams from "remoteIP" arriving on a shared UDP
+      //          socket to the gatherer (reference counted per gatherer)
+      static void addRoute(
+                           SocketPtr socket,
+                           const IPAddress &remoteIP,
+                           UseGathererPtr gatherer
+                           );
+      static void removeRoute(
+                              SocketPtr socket,
+                              const IPAddress &remoteIP,
+                              PUID gathererID
+                              );
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: report the outcome of the gatherer's message integrity check
+      //          of a binding request from "remoteIP" received on a shared
+      //          UDP socket; a passing check learns (or refreshes) an
+      //          unreferenced route to the gatherer, a failing check forgets
+      //          any learned route the remote holds to the gatherer
+      static void confirmRoute(
+                               SocketPtr socket,
+                               const IPAddress &remoteIP,
+                               UseGathererPtr gatherer
+                               );
+      static void rejectRoute(
+                              SocketPtr socket,
+                              const IPAddress &remoteIP,
+                              PUID gathererID
+                              );
+
+      static ElementPtr singletonToDebug();
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICESharedPort => ISocketDelegate
+      #pragma mark
+
+      virtual void onReadReady(SocketPtr socket) override;
+      virtual void onWriteReady(SocketPtr socket) override;
+      virtual void onException(SocketPtr socket) override;
+
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICESharedPort => ITimerDelegate
+      #pragma mark
+
+      virtual void onTimer(TimerPtr timer) override;
+
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICESharedPort => ISingletonManagerDelegate
+      #pragma mark
+
+      virtual void notifySingletonCleanup() override;
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICESharedPort => (internal)
+      #pragma mark
+
+      static Log::Params slog(const char *message);
+      Log::Params log(const char *message) const;
+      ElementPtr toDebug() const;
+
+      SharedSocketPtr bindSharedSocket(
+                                       const IPAddress &hostIP,
+                                       IICETypes::Protocols protocol
+                                       );
+      void closeSharedSocket(SharedSocketPtr shared);
+
+      void readUDP(SharedSocketPtr shared);
+      void acceptTCP(SharedSocketPtr listener);
+      void readPendingTCP(PendingTCPConnectionPtr pending);
+      void closePendingTCP(PendingTCPConnectionPtr pending);
+      void forgetPendingTCP(PendingTCPConnectionPtr pending);
+      void stepPendingTCPTimer();
+
+      UseGathererPtr findRoute(
+                               const SharedSocket &shared,
+                               const IPAddress &remoteIP,
+                               const Time &tick,
+                               bool &outLearned
+                               );
+      UseGathererPtr findUsernameFrag(
+                                      STUNPacketPtr stunPacket,
+                                      PUID &outGathererID
+                                      );
+      void purgeLearnedRoutes(const Time &tick);
+      bool evictLearnedRoute();
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ICESharedPort => (data)
+      #pragma mark
+
+      struct GathererTarget
+      {
+        UseGathererWeakPtr mGatherer;
+        PUID mGathererID {};
+        size_t mReferences {};    // 0 = learned from a validated binding request
+        Time mLastUsed;           // only maintained for learned routes
+      };
+
+      typedef std::pair<IPAddress, IICETypes::Protocols> HostIPProtocolPair;
+      typedef std::map<HostIPProtocolPair, SharedSocketPtr> SharedSocketMap;
+      typedef std::map<const Socket *, SharedSocketPtr> SocketToSharedSocketMap;
+      typedef std::map<const Socket *, PendingTCPConnectionPtr> PendingTCPConnectionMap;
+      typedef std::list<PendingTCPConnectionPtr> PendingTCPConnectionList;
+      typedef TimerWheel<PendingTCPConnectionWeakPtr> PendingTCPTimerWheel;
+
+      typedef std::pair<PUID, IPAddress> SharedSocketRemoteIPPair;
+      typedef std::map<SharedSocketRemoteIPPair, GathererTarget> RouteMap;
+
+      typedef std::map<String, GathererTarget> UsernameFragMap;
+
+      AutoPUID mID;
+      ICESharedPortWeakPtr mThisWeak;
+
+      mutable Lock mLock;
+
+      WORD mPort {};
+      size_t mMaxRoutes {};
+      Seconds mLearnedRouteTimeout {};
+      Time mNextLearnedRoutePurge;
+      size_t mMaxPendingTCPConnections {};
+      Seconds mPendingTCPTimeout {};
+
+      STUNPacket::ParseOptions mSTUNPacketParseOptions;
+
+      bool mShutdown {};
+
+      SharedSocketMap mSharedSockets;
+      SocketToSharedSocketMap mSocketToSharedSockets;
+      PendingTCPConnectionMap mPendingTCPConnections;
+      PendingTCPTimerWheel mPendingTCPTimers;
+      TimerPtr mPendingTCPTimer;        // one shot, armed for the nearest wake up of the pending TCP timer wheel
+      Time mPendingTCPTimerWakeUp;
+
+      RouteMap mRoutes;
+      UsernameFragMap mUsernameFrags;
+    };
+
+  }
+}
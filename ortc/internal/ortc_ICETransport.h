@@ -34,6 +34,10 @@
 #include <ortc/internal/types.h>
 
 #include <ortc/internal/ortc_ICEGathererRouter.h>
+#include <ortc/internal/ortc_PacketDemux.h>
+#include <ortc/internal/ortc_PriorityQueue.h>
+#include <ortc/internal/ortc_TimerWheel.h>
+#include <ortc/internal/ortc_UDPBatch.h>
 
 #include <ortc/IICETransport.h>
 #include <ortc/IICEGatherer.h>
@@ -58,6 +62,7 @@
 
 #define ORTC_SETTING_ICE_TRANSPORT_KEEP_WARM_TIME_BASE_IN_MILLISECONDS "ortc/ice-transport/keep-warm-time-base-in-milliseconds"
 #define ORTC_SETTING_ICE_TRANSPORT_KEEP_WARM_TIME_RANDOMIZED_ADD_TIME_IN_MILLISECONDS "ortc/ice-transport/keep-warm-time-randomized-add-time-in-milliseconds"
+#define ORTC_SETTING_ICE_TRANSPORT_KEEP_WARM_TIMER_RESOLUTION_IN_MILLISECONDS "ortc/ice-transport/keep-warm-timer-resolution-in-milliseconds"
 
 #define ORTC_SETTING_ICE_TRANSPORT_TEST_CANDIDATE_PAIRS_OF_LOWER_PREFERENCE "ortc/ice-transport/test-candidate-pairs-of-lower-preference"
 
@@ -121,6 +126,7 @@ namespace ortc
                                 ) = 0;
       virtual void notifyPacket(
                                 RouterRoutePtr routerRoute,
+                                PacketDemux::PacketTypes packetType,
                                 const BYTE *buffer,
                                 size_t bufferSizeInBytes
                                 ) = 0;
@@ -196,6 +202,14 @@ namespace ortc
                               const BYTE *buffer,
                               size_t bufferSizeInBytes
                               ) = 0;
+
+      // NOTE: sends a burst over the active route as a single batch; a burst
+      //       for the RTCP component given to the RTP transport is sent via
+      //       its associated RTCP transport
+      virtual bool sendPackets(
+                               IICETypes::Components sendOverICETransport,
+                               const UDPBatchSender::PacketList &packets
+                               ) = 0;
     };
     
     //-------------------------------------------------------------------------
@@ -296,12 +310,14 @@ namespace ortc
       typedef std::map<Hash, RoutePtr> RouteMap;
 
       typedef PUID RouteID;
-      typedef QWORD SortPriority;
-      typedef std::map<SortPriority, RoutePtr> SortedRouteMap;
+      typedef PriorityQueue<RoutePtr> RoutePriorityQueue;
+      typedef RoutePriorityQueue::EntryID RoutePriorityQueueID;
+      typedef std::list<RoutePtr> RouteList;
 
       typedef std::map<RouteID, RoutePtr> RouteIDMap;
       typedef std::map<ISTUNRequesterPtr, RoutePtr> STUNCheckMap;
-      typedef std::map<TimerPtr, RoutePtr> TimerRouteMap;
+      typedef TimerWheel<RoutePtr> RouteTimerWheel;
+      typedef RouteTimerWheel::TimerID RouteTimerID;
       typedef std::map<PromisePtr, RoutePtr> PromiseRouteMap;
 
       typedef std::list<PromisePtr> PromiseList;
@@ -310,6 +326,7 @@ namespace ortc
       typedef String RemoteFoundation;
       typedef std::pair<LocalFoundation, RemoteFoundation> LocalRemoteFoundationPair;
       typedef std::map<LocalRemoteFoundationPair, RouteMap> FoundationRouteMap;
+      typedef std::map<LocalRemoteFoundationPair, RouteIDMap> FoundationRouteIDMap;
 
       typedef CandidatePtr LocalCandidatePtr;
       typedef IPAddress FromIP;
@@ -317,7 +334,8 @@ namespace ortc
 
       typedef std::map<RouteID, LocalCandidateFromIPPair> RouteIDLocalCandidateFromIPMap;
 
-      typedef std::queue<SecureByteBlockPtr> PacketQueue;
+      typedef std::pair<PacketDemux::PacketTypes, SecureByteBlockPtr> TypedPacket;
+      typedef std::queue<TypedPacket> PacketQueue;
 
     public:
       ICETransport(
@@ -418,6 +436,7 @@ namespace ortc
                                 ) override;
       virtual void notifyPacket(
                                 RouterRoutePtr routerRoute,
+                                PacketDemux::PacketTypes packetType,
                                 const BYTE *buffer,
                                 size_t bufferSizeInBytes
                                 ) override;
@@ -472,6 +491,11 @@ namespace ortc
                               size_t bufferSizeInBytes
                               ) override;
 
+      virtual bool sendPackets(
+                               IICETypes::Components sendOverICETransport,
+                               const UDPBatchSender::PacketList &packets
+                               ) override;
+
       //-----------------------------------------------------------------------
       #pragma mark
       #pragma mark ICETransport => IICETransportForDataTransport
@@ -607,6 +631,8 @@ namespace ortc
         RouterRoutePtr mGathererRoute;
 
         QWORD mPendingPriority {};
+        RoutePriorityQueueID mPendingEntry {};
+        bool mPendingDeferred {false};       // waiting for a check in the same foundation to finish
 
         Time mLastReceivedCheck;
         Time mLastSentCheck;
@@ -617,7 +643,7 @@ namespace ortc
         bool mPrune {false};
         bool mKeepWarm {false};
         ISTUNRequesterPtr mOutgoingCheck;
-        TimerPtr mNextKeepWarm;
+        RouteTimerID mNextKeepWarm {};
 
         PromisePtr mFrozenPromise;
         PromiseList mDependentPromises;
@@ -720,6 +746,7 @@ namespace ortc
       void handleExpireRouteTimer();
       void handleLastReceivedPacket();
       void handleActivationTimer();
+      void handleKeepWarmTimers();
       void handleNextKeepWarmTimer(RoutePtr route);
 
       void forceActive(RoutePtr route);
@@ -740,6 +767,10 @@ namespace ortc
       void setBlacklisted(RoutePtr route);
 
       void updateAfterPacket(RoutePtr route);
+      void handleLiteBindingRequest(
+                                    RoutePtr route,
+                                    STUNPacketPtr packet
+                                    );
 
       bool installGathererRoute(RoutePtr route);
 
@@ -755,9 +786,19 @@ namespace ortc
                                     );
       void removeActive(RoutePtr route);
       void removePendingActivation(RoutePtr route);
+      bool hasPendingActivation() const;
+      bool isFoundationBeingChecked(RoutePtr route) const;
+      void deferPendingActivation(RoutePtr route);
+      void releaseDeferredActivation();
+      RoutePtr unfreezeDeferredActivation();
       void removeOutgoingCheck(RoutePtr route);
       void removeGathererRoute(RoutePtr route);
+      void installKeepWarmTimer(
+                                RoutePtr route,
+                                Time fireAt
+                                );
       void removeKeepWarmTimer(RoutePtr route);
+      void stepKeepWarmTimer();
       void removeWarm(RoutePtr route);
 
       RoutePtr findRoute(
@@ -848,6 +889,7 @@ namespace ortc
       String mOptionsHash;
       Options mOptions;
       QWORD mConflictResolver {};
+      bool mICELite {false};
 
       String mRemoteParametersHash;
       Parameters mRemoteParameters;
@@ -868,7 +910,10 @@ namespace ortc
       TimerPtr mActivationTimer;
       bool mNextActivationCausesAllRoutesThatReceivedChecksToActivate {false};
 
-      SortedRouteMap mPendingActivation;
+      RouteList mNewRoutes;
+      RoutePriorityQueue mPendingActivation;
+      FoundationRouteIDMap mDeferredActivation;   // pending routes waiting on a check of their foundation
+      size_t mTotalDeferredActivation {};
 
       PromiseRouteMap mFrozen;
 
@@ -879,7 +924,9 @@ namespace ortc
       RouteIDMap mGathererRoutes;
 
       STUNCheckMap mOutgoingChecks;
-      TimerRouteMap mNextKeepWarmTimers;
+      RouteTimerWheel mNextKeepWarmTimers;
+      TimerPtr mKeepWarmTimer;   // one shot, armed for mNextKeepWarmTimers's next wake up
+      Time mKeepWarmTimerWakeUp;
 
       RoutePtr mUseCandidateRoute;
       ISTUNRequesterPtr mUseCandidateRequest;
@@ -32,6 +32,8 @@
 #pragma once
 
 #include <ortc/internal/types.h>
+#include <ortc/internal/ortc_PacketDemux.h>
+#include <ortc/internal/ortc_UDPBatch.h>
 
 #include <ortc/IICETypes.h>
 
@@ -58,6 +60,18 @@ namespace ortc
       };
 
       static const char *toString(States state);
+
+      struct OutgoingPacket
+      {
+        IICETypes::Components mPacketType {IICETypes::Component_RTP};
+        const BYTE *mBuffer {};
+        BYTE *mWritableBuffer {};     // NULL unless "mBuffer" may be protected in place (contents are consumed)
+        size_t mSize {};
+        size_t mTailroom {};          // writable space after the packet
+      };
+      typedef std::vector<OutgoingPacket> OutgoingPacketList;
+
+      typedef UDPBatchSender::PacketList EncryptedPacketList;
     };
 
     //-------------------------------------------------------------------------
@@ -144,6 +158,26 @@ namespace ortc
                               size_t bufferLengthInBytes
                               ) = 0;
 
+      // NOTE: the packet is protected directly inside "buffer" (thus the
+      //       buffer contents are consumed); "bufferTailroomInBytes" is the
+      //       writable space after the packet available to hold the MKI and
+      //       authentication tag (falls back to a copy if insufficient)
+      virtual bool sendPacketInPlace(
+                                     IICETypes::Components sendOverICETransport,
+                                     IICETypes::Components packetType,
+                                     BYTE *buffer,
+                                     size_t bufferLengthInBytes,
+                                     size_t bufferTailroomInBytes
+                                     ) = 0;
+
+      // NOTE: sends a burst of packets (e.g. all packets of an encoded frame)
+      //       so the whole burst reaches the socket as one batch; returns
+      //       true only if every packet was sent
+      virtual bool sendPackets(
+                               IICETypes::Components sendOverICETransport,
+                               const ISecureTransportTypes::OutgoingPacketList &packets
+                               ) = 0;
+
       virtual IICETransportPtr getICETransport() const = 0;
     };
 
@@ -183,6 +217,18 @@ namespace ortc
                               size_t bufferLengthInBytes
                               ) = 0;
 
+      // NOTE: the packet is protected directly inside "buffer" (thus the
+      //       buffer contents are consumed); "bufferTailroomInBytes" is the
+      //       writable space after the packet available to hold the MKI and
+      //       authentication tag (falls back to a copy if insufficient)
+      virtual bool sendPacketInPlace(
+                                     IICETypes::Components sendOverICETransport,
+                                     IICETypes::Components packetType,
+                                     BYTE *buffer,
+                                     size_t bufferLengthInBytes,
+                                     size_t bufferTailroomInBytes
+                                     ) = 0;
+
       virtual IICETransportPtr getICETransport() const = 0;
     };
 
@@ -209,6 +255,11 @@ namespace ortc
                                        size_t bufferLengthInBytes
                                        ) = 0;
 
+      virtual bool sendEncryptedPackets(
+                                        IICETypes::Components sendOverICETransport,
+                                        const ISecureTransportTypes::EncryptedPacketList &packets
+                                        ) = 0;
+
       virtual bool handleReceivedDecryptedPacket(
                                                  IICETypes::Components viaTransport,
                                                  IICETypes::Components packetType,
@@ -240,6 +291,7 @@ namespace ortc
 
       virtual bool handleReceivedPacket(
                                         IICETypes::Components viaComponent,
+                                        PacketDemux::PacketTypes packetType,
                                         const BYTE *buffer,
                                         size_t bufferLengthInBytes
                                         ) = 0;
@@ -0,0 +1,269 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <set>
+#include <thread>
+
+#define ORTC_SETTING_NETWORK_MONITOR_ENABLED "ortc/network-monitor/enabled"
+
+namespace ortc
+{
+  namespace internal
+  {
+    ZS_DECLARE_INTERACTION_PTR(INetworkMonitorForSettings)
+    ZS_DECLARE_INTERACTION_PROXY(INetworkMonitorDelegate)
+
+    ZS_DECLARE_CLASS_PTR(NetworkMonitor)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark INetworkMonitorForSettings
+    #pragma mark
+
+    interaction INetworkMonitorForSettings
+    {
+      ZS_DECLARE_TYPEDEF_PTR(INetworkMonitorForSettings, ForSettings)
+
+      static void applyDefaults();
+
+      virtual ~INetworkMonitorForSettings() {}
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark INetworkMonitorDelegate
+    #pragma mark
+
+    interaction INetworkMonitorDelegate
+    {
+      // an address was added to or removed from an interface, or an
+      // interface went up or down (notifications are coalesced per batch of
+      // kernel messages)
+      virtual void onNetworkMonitorInterfacesChanged() = 0;
+
+      // the monitor stopped watching the kernel (the subscription is void
+      // and the subscriber must go back to scanning the interfaces itself)
+      virtual void onNetworkMonitorFailed() = 0;
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark NetworkMonitor
+    #pragma mark
+
+    // Optional Linux interface monitor: a single thread listens on an
+    // rtnetlink socket subscribed to RTMGRP_LINK, RTMGRP_IPV4_IFADDR and
+    // RTMGRP_IPV6_IFADDR. The address table is seeded once from an
+    // RTM_GETLINK / RTM_GETADDR dump and afterwards kept current by applying
+    // the kernel's add/remove deltas, so subscribers learn about a new or
+    // lost address as soon as the kernel announces it instead of waiting for
+    // a periodic getifaddrs() scan.
+    //
+    // Addresses still undergoing duplicate address detection and addresses
+    // on interfaces that are down are not reported. If the kernel drops
+    // messages (ENOBUFS) the table is rebuilt from a fresh dump (retried
+    // with backoff); should that keep failing, or the socket become
+    // unusable, subscribers are told the monitor failed and new
+    // subscriptions are refused.
+    class NetworkMonitor : public INetworkMonitorForSettings,
+                           public ISingletonManagerDelegate
+    {
+    protected:
+      struct make_private {};
+
+    public:
+      friend interaction INetworkMonitorForSettings;
+
+      struct Address
+      {
+        IPAddress mIP;
+        String mInterfaceName;
+        ULONG mInterfaceIndex {};
+        bool mIsTemporary {};
+
+        ElementPtr toDebug() const;
+      };
+
+      typedef std::list<Address> AddressList;
+
+    protected:
+      typedef std::pair<ULONG, String> AddressKey;                     // interface index, address
+      typedef std::map<AddressKey, Address> AddressMap;
+      typedef std::set<ULONG> InterfaceIndexSet;
+
+    public:
+      NetworkMonitor(const make_private &);
+
+    protected:
+      static NetworkMonitorPtr create();
+
+    public:
+      ~NetworkMonitor();
+
+      static NetworkMonitorPtr singleton();
+
+      // true if the monitor is turned on and supported on this platform
+      static bool isEnabled();
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: receive interface change notifications (the delegate is
+      //          held weakly and called on its own message queue)
+      // RETURNS: false if the monitor is unavailable (the caller must fall
+      //          back to scanning the interfaces itself)
+      static bool subscribe(
+                            PUID subscriberID,
+                            INetworkMonitorDelegatePtr delegate
+                            );
+      static void unsubscribe(PUID subscriberID);
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: obtain the currently usable addresses of all interfaces
+      //          which are up (loopback and wildcard addresses excluded)
+      static void getAddresses(AddressList &outAddresses);
+
+      static ElementPtr singletonToDebug();
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark NetworkMonitor => ISingletonManagerDelegate
+      #pragma mark
+
+      virtual void notifySingletonCleanup() override;
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark NetworkMonitor => (internal)
+      #pragma mark
+
+      static Log::Params slog(const char *message);
+      Log::Params log(const char *message) const;
+      ElementPtr toDebug() const;
+
+      bool start();
+      void stop();
+
+      bool requestDump(int type);
+      bool readDump(
+                    AddressMap &ioAddresses,
+                    InterfaceIndexSet &ioDownInterfaces
+                    );
+      bool resync(
+                  AddressMap &outAddresses,
+                  InterfaceIndexSet &outDownInterfaces
+                  );
+
+      // RETURNS: false if messages were lost (a resync is required)
+      bool receive(
+                   AddressMap &ioAddresses,
+                   InterfaceIndexSet &ioDownInterfaces,
+                   bool &outDumpDone,
+                   bool &outChanged
+                   );
+      void process(
+                   const BYTE *buffer,
+                   size_t length,
+                   AddressMap &ioAddresses,
+                   InterfaceIndexSet &ioDownInterfaces,
+                   bool &outDumpDone,
+                   bool &outChanged
+                   );
+
+      void notifySubscribers(bool monitorFailed = false);
+
+      // RETURNS: false if the monitor was asked to stop while waiting
+      bool waitToRetry(int delayInMilliseconds);
+      bool resyncWithRetry(
+                           AddressMap &outAddresses,
+                           InterfaceIndexSet &outDownInterfaces
+                           );
+
+      void run();
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark NetworkMonitor => (data)
+      #pragma mark
+
+      typedef std::map<PUID, INetworkMonitorDelegateWeakPtr> SubscriberMap;
+
+      AutoPUID mID;
+      NetworkMonitorWeakPtr mThisWeak;
+
+      mutable Lock mLock;
+
+      bool mStarted {};
+      bool mStopped {};
+      bool mFailed {};
+
+      int mSocket {-1};
+      int mWakeFD {-1};
+      DWORD mSequence {};
+
+      std::thread mThread;
+      std::atomic<bool> mShouldStop {false};
+
+      AddressMap mAddresses;
+      InterfaceIndexSet mDownInterfaces;
+
+      SubscriberMap mSubscribers;
+
+      std::atomic<ULONGLONG> mMessages {};
+      std::atomic<ULONGLONG> mChanges {};
+      std::atomic<ULONGLONG> mResyncs {};
+    };
+
+  }
+}
+
+ZS_DECLARE_PROXY_BEGIN(ortc::internal::INetworkMonitorDelegate)
+ZS_DECLARE_PROXY_METHOD_0(onNetworkMonitorInterfacesChanged)
+ZS_DECLARE_PROXY_METHOD_0(onNetworkMonitorFailed)
+ZS_DECLARE_PROXY_END()
@@ -34,16 +34,40 @@
 #include <ortc/internal/types.h>
 #include <ortc/IORTC.h>
 
+#include <vector>
+
 #define ORTC_QUEUE_MAIN_THREAD_NAME "org.ortc.ortcLibMainThread"
 #define ORTC_QUEUE_BLOCKING_MEDIA_STARTUP_THREAD_NAME "org.ortc.ortcLibBlockingMedia"
 #define ORTC_QUEUE_CERTIFICATE_GENERATION_NAME "org.ortc.ortcLibCertificateGeneration"
 #define ORTC_QUEUE_PACKET_THREAD_NAME "org.ortc.ortcLibPacketThread."
-#define ORTC_QUEUE_TOTAL_PACKET_THREADS 4
+#define ORTC_QUEUE_DEFAULT_TOTAL_PACKET_THREADS 4
+
+#define ORTC_SETTING_ORTC_TOTAL_PACKET_THREADS "ortc/ortc/total-packet-threads"
+#define ORTC_SETTING_ORTC_PIN_PACKET_THREADS "ortc/ortc/pin-packet-threads"
 
 namespace ortc
 {
   namespace internal
   {
+    ZS_DECLARE_INTERACTION_PROXY(IORTCAsyncDelegate)
+
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IORTCForSettings
+    #pragma mark
+
+    interaction IORTCForSettings
+    {
+      ZS_DECLARE_TYPEDEF_PTR(IORTCForSettings, ForSettings)
+
+      static void applyDefaults();
+
+      virtual ~IORTCForSettings() {}
+    };
+
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
@@ -60,12 +84,32 @@ namespace ortc
       static IMessageQueuePtr queueDelegate();
       static IMessageQueuePtr queueORTC();
       static IMessageQueuePtr queuePacket();
+      static IMessageQueuePtr queuePacket(
+                                          const void *transport,
+                                          DWORD ssrc                // 0 = not known yet (the caller gets its own round robin thread)
+                                          );
       static IMessageQueuePtr queueBlockingMediaStartStopThread();
       static IMessageQueuePtr queueCertificateGeneration();
 
       static Optional<Log::Level> webrtcLogLevel();
     };
 
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IORTCAsyncDelegate
+    #pragma mark
+
+    interaction IORTCAsyncDelegate
+    {
+      virtual void onPinPacketThread(
+                                     size_t index,
+                                     size_t cpu
+                                     ) = 0;
+    };
+
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
@@ -76,6 +120,7 @@ namespace ortc
 
     class ORTC : public IORTC,
                  public IORTCForInternal,
+                 public IORTCAsyncDelegate,
                  public SharedRecursiveLock
     {
     protected:
@@ -124,11 +169,25 @@ namespace ortc
       virtual IMessageQueuePtr queueDelegate() const;
       virtual IMessageQueuePtr queueORTC() const;
       virtual IMessageQueuePtr queuePacket() const;
+      virtual IMessageQueuePtr queuePacket(
+                                           const void *transport,
+                                           DWORD ssrc
+                                           ) const;
       virtual IMessageQueuePtr queueBlockingMediaStartStopThread() const;
       virtual IMessageQueuePtr queueCertificateGeneration() const;
 
       virtual Optional<Log::Level> webrtcLogLevel() const;
 
+      //---------------------------------------------------------------------
+      #pragma mark
+      #pragma mark ORTC => IORTCAsyncDelegate
+      #pragma mark
+
+      virtual void onPinPacketThread(
+                                     size_t index,
+                                     size_t cpu
+                                     ) override;
+
       //---------------------------------------------------------------------
       #pragma mark
       #pragma mark ORTC => (internal)
@@ -137,6 +196,9 @@ namespace ortc
       Log::Params log(const char *message) const;
       static Log::Params slog(const char *message);
 
+      void preparePacketQueues() const;
+      IMessageQueuePtr getPacketQueue(size_t index) const;
+
     protected:
       //---------------------------------------------------------------------
       #pragma mark
@@ -152,8 +214,9 @@ namespace ortc
       mutable IMessageQueuePtr mBlockingMediaStartStopThread;
       mutable IMessageQueuePtr mCertificateGeneration;
 
-      mutable IMessageQueuePtr mPacketQueues[ORTC_QUEUE_TOTAL_PACKET_THREADS];
+      mutable std::vector<IMessageQueuePtr> mPacketQueues;  // sized once from settings on first use
       mutable size_t mNextPacketQueueThread {};
+      mutable bool mPinPacketThreads {};
 
       Milliseconds mNTPServerTime {};
 
@@ -162,3 +225,7 @@ namespace ortc
     };
   }
 }
+
+ZS_DECLARE_PROXY_BEGIN(ortc::internal::IORTCAsyncDelegate)
+ZS_DECLARE_PROXY_METHOD_2(onPinPacketThread, size_t, size_t)
+ZS_DECLARE_PROXY_END()
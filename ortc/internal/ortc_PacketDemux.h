@@ -0,0 +1,200 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+#include <ortc/IICETypes.h>
+
+namespace ortc
+{
+  namespace internal
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PacketDemux
+    #pragma mark
+
+    // Classifies an incoming datagram once (at the socket) following the
+    // first byte ranges of RFC 7983 section 7:
+    //
+    //              +----------------+
+    //              |        [0..3] -+--> STUN (also requires magic cookie)
+    //              |      [16..19] -+--> ZRTP
+    //   packet --> |      [20..63] -+--> DTLS
+    //              |      [64..79] -+--> TURN Channel
+    //              |    [128..191] -+--> RTP/RTCP (RFC 5761 payload type)
+    //              +----------------+
+    //
+    // The result travels with the packet so later layers never need to
+    // inspect the buffer again to decide where it belongs.
+    class PacketDemux
+    {
+    public:
+      enum PacketTypes : BYTE
+      {
+        PacketType_First,
+
+        PacketType_Unknown = PacketType_First,
+        PacketType_STUN,
+        PacketType_ZRTP,
+        PacketType_DTLS,
+        PacketType_TURNChannelData,
+        PacketType_RTP,
+        PacketType_RTCP,
+
+        PacketType_Last = PacketType_RTCP,
+      };
+
+      static const char *toString(PacketTypes packetType);
+
+      enum Sizes : size_t
+      {
+        Size_STUNHeader = 20,
+        Size_DTLSRecordHeader = 13,
+        Size_TURNChannelDataHeader = 4,
+        Size_MinimumRTPPacket = 12,
+        Size_MinimumRTCPPacket = 8,
+      };
+
+      static const DWORD kSTUNMagicCookie = 0x2112A442;
+
+      // RFC 8656 narrowed the RFC 5766 channel range (0x4000..0x7FFF) to the
+      // numbers the [64..79] first byte range classifies as channel data
+      static const WORD kTURNChannelNumberFirst = 0x4000;
+      static const WORD kTURNChannelNumberLast = 0x4FFF;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: classify a packet from its first byte (plus the STUN magic
+      //          cookie or RTCP payload type where the first byte is shared)
+      static PacketTypes classify(
+                                  const BYTE *buffer,
+                                  size_t bufferLengthInBytes
+                                  )
+      {
+        if (bufferLengthInBytes < 1) return PacketType_Unknown;
+
+        BYTE first = buffer[0];
+
+        // media is by far the most common; unsigned subtraction turns each
+        // range test into a single compare
+        if (static_cast<BYTE>(first - 128) < 64) {
+          if (bufferLengthInBytes < Size_MinimumRTCPPacket) return PacketType_Unknown;
+          BYTE payloadType = (buffer[1] & 0x7F);
+          if (static_cast<BYTE>(payloadType - 64) < 32) return PacketType_RTCP;
+          return (bufferLengthInBytes >= Size_MinimumRTPPacket ? PacketType_RTP : PacketType_Unknown);
+        }
+        if (static_cast<BYTE>(first - 20) < 44) {
+          return (bufferLengthInBytes >= Size_DTLSRecordHeader ? PacketType_DTLS : PacketType_Unknown);
+        }
+        if (first < 4) {
+          if (bufferLengthInBytes < Size_STUNHeader) return PacketType_Unknown;
+          DWORD cookie = (static_cast<DWORD>(buffer[4]) << 24) |
+                         (static_cast<DWORD>(buffer[5]) << 16) |
+                         (static_cast<DWORD>(buffer[6]) << 8) |
+                         (static_cast<DWORD>(buffer[7]));
+          return (kSTUNMagicCookie == cookie ? PacketType_STUN : PacketType_Unknown);
+        }
+        if (static_cast<BYTE>(first - 64) < 16) {
+          return (bufferLengthInBytes >= Size_TURNChannelDataHeader ? PacketType_TURNChannelData : PacketType_Unknown);
+        }
+        if (static_cast<BYTE>(first - 16) < 4) return PacketType_ZRTP;
+
+        return PacketType_Unknown;
+      }
+
+      static bool isSTUNCandidate(
+                                  PacketTypes packetType,
+                                  const BYTE *buffer,
+                                  size_t bufferLengthInBytes
+                                  )
+      {
+        // RFC 3489 style STUN has no magic cookie but still occupies [0..3]
+        if (PacketType_STUN == packetType) return true;
+        if (PacketType_Unknown != packetType) return false;
+        return ((bufferLengthInBytes > 0) && (buffer[0] < 4));
+      }
+
+      static bool isTURNChannelNumber(WORD channelNumber)
+      {
+        return static_cast<WORD>(channelNumber - kTURNChannelNumberFirst) <= static_cast<WORD>(kTURNChannelNumberLast - kTURNChannelNumberFirst);
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: read a TURN ChannelData header (RFC 5766 section 11.4); the
+      //          payload follows the header
+      // RETURNS: false if the channel number is out of range or the length
+      //          exceeds the datagram (trailing padding is ignored)
+      static bool parseTURNChannelData(
+                                       const BYTE *buffer,
+                                       size_t bufferLengthInBytes,
+                                       WORD &outChannelNumber,
+                                       size_t &outPayloadLengthInBytes
+                                       )
+      {
+        if (bufferLengthInBytes < Size_TURNChannelDataHeader) return false;
+
+        outChannelNumber = static_cast<WORD>((static_cast<WORD>(buffer[0]) << 8) | static_cast<WORD>(buffer[1]));
+        if (!isTURNChannelNumber(outChannelNumber)) return false;
+
+        outPayloadLengthInBytes = (static_cast<size_t>(buffer[2]) << 8) | static_cast<size_t>(buffer[3]);
+        return outPayloadLengthInBytes <= (bufferLengthInBytes - Size_TURNChannelDataHeader);
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: write a TURN ChannelData header for a payload (no padding is
+      //          needed over UDP)
+      // RETURNS: false if the payload is too large to be framed
+      static bool writeTURNChannelDataHeader(
+                                             BYTE *outHeader,
+                                             WORD channelNumber,
+                                             size_t payloadLengthInBytes
+                                             )
+      {
+        if (payloadLengthInBytes > 0xFFFF) return false;
+
+        outHeader[0] = static_cast<BYTE>(channelNumber >> 8);
+        outHeader[1] = static_cast<BYTE>(channelNumber & 0xFF);
+        outHeader[2] = static_cast<BYTE>(payloadLengthInBytes >> 8);
+        outHeader[3] = static_cast<BYTE>(payloadLengthInBytes & 0xFF);
+        return true;
+      }
+
+      static bool isMedia(PacketTypes packetType)    {return (PacketType_RTP == packetType) || (PacketType_RTCP == packetType);}
+      static IICETypes::Components toComponent(PacketTypes packetType) {return (PacketType_RTCP == packetType ? IICETypes::Component_RTCP : IICETypes::Component_RTP);}
+    };
+
+  }
+}
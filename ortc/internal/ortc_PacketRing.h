@@ -0,0 +1,369 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+#pragma once
+
+#include <ortc/internal/types.h>
+#include <ortc/internal/ortc_FlatHashMap.h>
+
+#include <ortc/IStatsReport.h>
+
+#include <vector>
+
+namespace ortc
+{
+  namespace internal
+  {
+    ZS_DECLARE_STRUCT_PTR(PacketRingStats)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PacketRingCounters
+    #pragma mark
+
+    struct PacketRingCounters
+    {
+      ULONGLONG mBuffered {};           // packets accepted into the ring
+      ULONGLONG mRemoved {};            // packets taken out (i.e. delivered)
+      ULONGLONG mDroppedExpired {};     // older than the maximum age
+      ULONGLONG mDroppedOverflow {};    // evicted because every slot was in use
+      ULONGLONG mDroppedOverBudget {};  // evicted to stay within the byte budget
+      ULONGLONG mDroppedOversized {};   // larger than the entire byte budget (never buffered)
+
+      ULONGLONG dropped() const {return mDroppedExpired + mDroppedOverflow + mDroppedOverBudget + mDroppedOversized;}
+
+      ElementPtr toDebug() const;
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PacketRingStats
+    #pragma mark
+
+    // reported by getStats() of objects buffering packets for SSRCs that
+    // are not (yet) routable
+    struct PacketRingStats : public IStatsReportTypes::Stats
+    {
+      size_t mBufferedPackets {};
+      size_t mBufferedBytes {};
+      size_t mMaxPackets {};
+      size_t mMaxBytes {};
+      PacketRingCounters mCounters;
+
+      PacketRingStats() { mStatsTypeOther = "packetbuffer"; }
+
+      virtual ElementPtr createElement(const char *objectName = "packetbuffer") const override;
+
+      virtual ElementPtr toDebug() const override;
+      virtual String hash() const override;
+
+      PacketRingStats &operator=(const PacketRingStats &op2) = delete;
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PacketRing
+    #pragma mark
+
+    // Fixed capacity FIFO of buffered packets with a byte budget. Slots are
+    // allocated once up front; packets sharing an SSRC are chained together
+    // so all buffered packets of one SSRC can be visited without walking
+    // the entire ring.
+    //
+    // Packets are evicted oldest first; expiring, overflowing or exceeding
+    // the byte budget only ever pops the head of the ring (O(1) per packet
+    // dropped). Removing a packet from the middle leaves a hole which is
+    // reclaimed once it reaches the head.
+    //
+    // Not thread safe; protected by the owner's lock.
+    template <typename TPacketPtr>
+    class PacketRing
+    {
+    public:
+      typedef DWORD SSRCType;
+      typedef size_t Index;
+
+      static const Index kNone = static_cast<Index>(-1);
+
+    protected:
+      struct Slot
+      {
+        Time mTime;
+        SSRCType mSSRC {};
+        TPacketPtr mPacket;     // NULL when removed (hole)
+        size_t mSize {};
+        Index mNext {kNone};    // next slot with the same SSRC
+      };
+
+      struct Chain
+      {
+        Index mFirst {kNone};
+        Index mLast {kNone};
+        size_t mTotal {};       // live packets in the chain
+      };
+
+      typedef std::vector<Slot> SlotList;
+      typedef FlatHashMap<SSRCType, Chain> ChainMap;
+
+    public:
+      PacketRing(
+                 size_t maxPackets,
+                 size_t maxBytes,
+                 Seconds maxAge
+                 ) :
+        mSlots(maxPackets > 0 ? maxPackets : 1),
+        mMaxBytes(maxBytes),
+        mMaxAge(maxAge)
+      {
+      }
+
+      size_t size() const                   {return mTotalPackets;}
+      size_t bytes() const                  {return mTotalBytes;}
+      bool empty() const                    {return 0 == mTotalPackets;}
+
+      size_t maxPackets() const             {return mSlots.size();}
+      size_t maxBytes() const               {return mMaxBytes;}
+
+      const PacketRingCounters &counters() const {return mCounters;}
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: buffer a packet (evicting the oldest packets if needed)
+      // RETURNS: false if the packet is larger than the entire byte budget
+      bool push(
+                const Time &tick,
+                SSRCType ssrc,
+                TPacketPtr packet
+                )
+      {
+        size_t size = packet->size();
+        if (size > mMaxBytes) {
+          ++mCounters.mDroppedOversized;
+          return false;
+        }
+
+        expire(tick);
+
+        while (mUsedSlots >= mSlots.size()) {
+          pop(mCounters.mDroppedOverflow);
+        }
+        while (mTotalBytes + size > mMaxBytes) {
+          pop(mCounters.mDroppedOverBudget);
+        }
+
+        Index index = (mHead + mUsedSlots) % mSlots.size();
+        ++mUsedSlots;
+
+        Slot &slot = mSlots[index];
+        slot.mTime = tick;
+        slot.mSSRC = ssrc;
+        slot.mPacket = packet;
+        slot.mSize = size;
+        slot.mNext = kNone;
+
+        Chain &chain = mChains[ssrc];
+        if (kNone == chain.mFirst) {
+          chain.mFirst = index;
+        } else {
+          mSlots[chain.mLast].mNext = index;
+        }
+        chain.mLast = index;
+        ++chain.mTotal;
+
+        ++mTotalPackets;
+        mTotalBytes += size;
+        ++mCounters.mBuffered;
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: drop packets older than the maximum age
+      void expire(const Time &tick)
+      {
+        while (mUsedSlots > 0) {
+          Slot &slot = mSlots[mHead];
+          if ((slot.mPacket) &&
+              (!(slot.mTime + mMaxAge < tick))) break;
+          pop(mCounters.mDroppedExpired);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: visit the buffered packets of an SSRC (oldest first), e.g.
+      //          for (auto index = ring.first(ssrc); ring.kNone != index; index = ring.next(index))
+      Index first(SSRCType ssrc) const
+      {
+        auto found = mChains.find(ssrc);
+        if (found == mChains.end()) return kNone;
+        return skipHoles((*found).second.mFirst);
+      }
+
+      Index next(Index index) const         {return skipHoles(mSlots[index].mNext);}
+
+      const TPacketPtr &packet(Index index) const {return mSlots[index].mPacket;}
+      const Time &time(Index index) const   {return mSlots[index].mTime;}
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: take a packet out of the ring; next(index) remains valid
+      void remove(Index index)
+      {
+        Slot &slot = mSlots[index];
+        if (!slot.mPacket) return;
+
+        release(slot);
+        ++mCounters.mRemoved;
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: get the SSRCs with buffered packets
+      void getSSRCs(std::vector<SSRCType> &outSSRCs) const
+      {
+        outSSRCs.clear();
+        outSSRCs.reserve(mChains.size());
+        for (auto iter = mChains.begin(); iter != mChains.end(); ++iter) {
+          outSSRCs.push_back((*iter).first);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: append all buffered packets (oldest first)
+      template <typename TList>
+      void getPackets(TList &outPackets) const
+      {
+        for (size_t offset = 0; offset < mUsedSlots; ++offset) {
+          const Slot &slot = mSlots[(mHead + offset) % mSlots.size()];
+          if (!slot.mPacket) continue;
+          outPackets.push_back(slot.mPacket);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      void fillStats(PacketRingStats &outStats) const
+      {
+        outStats.mBufferedPackets = mTotalPackets;
+        outStats.mBufferedBytes = mTotalBytes;
+        outStats.mMaxPackets = mSlots.size();
+        outStats.mMaxBytes = mMaxBytes;
+        outStats.mCounters = mCounters;
+      }
+
+      //-----------------------------------------------------------------------
+      void clear()
+      {
+        for (auto iter = mSlots.begin(); iter != mSlots.end(); ++iter) {
+          (*iter) = Slot();
+        }
+        mChains.clear();
+        mHead = 0;
+        mUsedSlots = 0;
+        mTotalPackets = 0;
+        mTotalBytes = 0;
+      }
+
+    protected:
+      //-----------------------------------------------------------------------
+      Index skipHoles(Index index) const
+      {
+        while ((kNone != index) &&
+               (!mSlots[index].mPacket)) {
+          index = mSlots[index].mNext;
+        }
+        return index;
+      }
+
+      //-----------------------------------------------------------------------
+      void release(Slot &slot)
+      {
+        slot.mPacket = TPacketPtr();
+
+        --mTotalPackets;
+        mTotalBytes -= slot.mSize;
+
+        auto found = mChains.find(slot.mSSRC);
+        if (found == mChains.end()) return;
+
+        Chain &chain = (*found).second;
+        --chain.mTotal;
+        if (0 == chain.mTotal) mChains.erase(found); // remaining holes are never visited again
+      }
+
+      //-----------------------------------------------------------------------
+      void pop(ULONGLONG &ioDroppedCounter)
+      {
+        Index index = mHead;
+        Slot &slot = mSlots[index];
+
+        if (slot.mPacket) {
+          release(slot);
+          ++ioDroppedCounter;
+        }
+
+        // the head is always the oldest slot of its chain
+        auto found = mChains.find(slot.mSSRC);
+        if (found != mChains.end()) {
+          Chain &chain = (*found).second;
+          if (index == chain.mFirst) {
+            chain.mFirst = slot.mNext;
+            if (kNone == chain.mFirst) chain.mLast = kNone;
+          }
+        }
+
+        slot.mNext = kNone;
+
+        mHead = (mHead + 1) % mSlots.size();
+        --mUsedSlots;
+      }
+
+    protected:
+      SlotList mSlots;
+      ChainMap mChains;
+
+      Index mHead {};
+      size_t mUsedSlots {};           // includes holes
+
+      size_t mTotalPackets {};
+      size_t mTotalBytes {};
+
+      size_t mMaxBytes {};
+      Seconds mMaxAge {};
+
+      PacketRingCounters mCounters;
+    };
+  }
+}
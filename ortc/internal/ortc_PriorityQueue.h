@@ -0,0 +1,286 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <vector>
+
+namespace ortc
+{
+  namespace internal
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PriorityQueue
+    #pragma mark
+
+    // Binary max-heap keyed by a 64-bit priority where every entry can be
+    // removed (or found) in O(log n) through the ID returned when it was
+    // pushed. Entries of equal priority come out in the order they were
+    // pushed.
+    //
+    // Entry IDs carry a generation count thus an ID for an entry that was
+    // already popped or erased never matches a newer entry.
+    template <typename TValue>
+    class PriorityQueue
+    {
+    public:
+      typedef QWORD EntryID;                   // 0 is never a valid entry
+      typedef QWORD Priority;
+      typedef std::vector<TValue> ValueList;
+
+    protected:
+      static const DWORD kNone = 0xFFFFFFFF;
+
+      struct Entry
+      {
+        Priority mPriority {};
+        QWORD mSequence {};
+        DWORD mGeneration {1};
+        DWORD mPosition {kNone};               // position in the heap, kNone when free
+        DWORD mNextFree {kNone};
+        TValue mValue {};
+      };
+
+      typedef std::vector<Entry> EntryList;
+      typedef std::vector<DWORD> HeapList;
+
+    public:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark PriorityQueue (public)
+      #pragma mark
+
+      PriorityQueue() {}
+
+      size_t size() const                                     {return mHeap.size();}
+      bool empty() const                                      {return mHeap.empty();}
+
+      const TValue &top() const                               {return mEntries[mHeap.front()].mValue;}
+      Priority topPriority() const                            {return mEntries[mHeap.front()].mPriority;}
+
+      //-----------------------------------------------------------------------
+      EntryID push(
+                   Priority priority,
+                   const TValue &value
+                   )
+      {
+        DWORD index = allocate();
+        Entry &entry = mEntries[index];
+        entry.mPriority = priority;
+        entry.mSequence = ++mLastSequence;
+        entry.mValue = value;
+        entry.mPosition = static_cast<DWORD>(mHeap.size());
+        mHeap.push_back(index);
+        siftUp(entry.mPosition);
+        return (static_cast<QWORD>(entry.mGeneration) << 32) | static_cast<QWORD>(index + 1);
+      }
+
+      //-----------------------------------------------------------------------
+      void pop()
+      {
+        if (mHeap.empty()) return;
+        removeAt(0);
+      }
+
+      //-----------------------------------------------------------------------
+      // RETURNS: false if the entry was already popped or erased
+      bool erase(EntryID entryID)
+      {
+        DWORD index = 0;
+        if (!locate(entryID, index)) return false;
+        removeAt(mEntries[index].mPosition);
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      bool contains(EntryID entryID) const
+      {
+        DWORD index = 0;
+        return locate(entryID, index);
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: copy of every queued value (in no particular order)
+      ValueList values() const
+      {
+        ValueList result;
+        result.reserve(mHeap.size());
+        for (auto iter = mHeap.begin(); iter != mHeap.end(); ++iter) {
+          result.push_back(mEntries[*iter].mValue);
+        }
+        return result;
+      }
+
+      //-----------------------------------------------------------------------
+      void clear()
+      {
+        while (!mHeap.empty()) {
+          removeAt(static_cast<DWORD>(mHeap.size() - 1));
+        }
+      }
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark PriorityQueue (internal)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      bool before(
+                  DWORD indexA,
+                  DWORD indexB
+                  ) const
+      {
+        const Entry &a = mEntries[indexA];
+        const Entry &b = mEntries[indexB];
+        if (a.mPriority != b.mPriority) return a.mPriority > b.mPriority;
+        return a.mSequence < b.mSequence;
+      }
+
+      //-----------------------------------------------------------------------
+      void place(
+                 DWORD position,
+                 DWORD index
+                 )
+      {
+        mHeap[position] = index;
+        mEntries[index].mPosition = position;
+      }
+
+      //-----------------------------------------------------------------------
+      void siftUp(DWORD position)
+      {
+        DWORD index = mHeap[position];
+        while (position > 0) {
+          DWORD parent = (position - 1) / 2;
+          if (!before(index, mHeap[parent])) break;
+          place(position, mHeap[parent]);
+          position = parent;
+        }
+        place(position, index);
+      }
+
+      //-----------------------------------------------------------------------
+      void siftDown(DWORD position)
+      {
+        DWORD index = mHeap[position];
+        DWORD total = static_cast<DWORD>(mHeap.size());
+        while (true) {
+          DWORD child = (position * 2) + 1;
+          if (child >= total) break;
+          if ((child + 1 < total) && (before(mHeap[child + 1], mHeap[child]))) ++child;
+          if (!before(mHeap[child], index)) break;
+          place(position, mHeap[child]);
+          position = child;
+        }
+        place(position, index);
+      }
+
+      //-----------------------------------------------------------------------
+      void removeAt(DWORD position)
+      {
+        DWORD index = mHeap[position];
+        DWORD last = static_cast<DWORD>(mHeap.size() - 1);
+
+        if (position != last) {
+          DWORD moved = mHeap[last];
+          place(position, moved);
+          mHeap.pop_back();
+          siftDown(position);
+          siftUp(mEntries[moved].mPosition);
+        } else {
+          mHeap.pop_back();
+        }
+
+        release(index);
+      }
+
+      //-----------------------------------------------------------------------
+      bool locate(
+                  EntryID entryID,
+                  DWORD &outIndex
+                  ) const
+      {
+        DWORD position = static_cast<DWORD>(entryID & 0xFFFFFFFF);
+        if (0 == position) return false;
+        if (position > mEntries.size()) return false;
+
+        const Entry &entry = mEntries[position - 1];
+        if (kNone == entry.mPosition) return false;
+        if (entry.mGeneration != static_cast<DWORD>(entryID >> 32)) return false;
+
+        outIndex = position - 1;
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      DWORD allocate()
+      {
+        if (kNone != mFreeHead) {
+          DWORD index = mFreeHead;
+          mFreeHead = mEntries[index].mNextFree;
+          return index;
+        }
+        mEntries.push_back(Entry());
+        return static_cast<DWORD>(mEntries.size() - 1);
+      }
+
+      //-----------------------------------------------------------------------
+      void release(DWORD index)
+      {
+        Entry &entry = mEntries[index];
+        entry.mValue = TValue();               // release the value now rather than when the entry is reused
+        entry.mPosition = kNone;
+        ++entry.mGeneration;
+        if (0 == entry.mGeneration) entry.mGeneration = 1;
+        entry.mNextFree = mFreeHead;
+        mFreeHead = index;
+      }
+
+    protected:
+      EntryList mEntries;
+      HeapList mHeap;
+      DWORD mFreeHead {kNone};
+      QWORD mLastSequence {};
+    };
+
+    template <typename TValue>
+    const DWORD PriorityQueue<TValue>::kNone;
+
+  }
+}
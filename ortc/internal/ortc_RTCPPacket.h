@@ -35,6 +35,9 @@
 
 #include <ortc/IICETypes.h>
 
+#include <atomic>
+#include <vector>
+
 namespace ortc
 {
   namespace internal
@@ -1401,6 +1404,37 @@ namespace ortc
         UnknownReport *mNextUnknown {};
       };
 
+    public:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RTCPPacket::DecodeTypes
+      #pragma mark
+
+      enum DecodeTypes
+      {
+        DecodeType_None                             = 0,
+
+        DecodeType_SenderReport                     = (1 << 0),
+        DecodeType_ReceiverReport                   = (1 << 1),
+        DecodeType_SDES                             = (1 << 2),
+        DecodeType_Bye                              = (1 << 3),
+        DecodeType_App                              = (1 << 4),
+        DecodeType_TransportLayerFeedbackMessage    = (1 << 5),
+        DecodeType_PayloadSpecificFeedbackMessage   = (1 << 6),
+        DecodeType_XR                               = (1 << 7),
+        DecodeType_UnknownReport                    = (1 << 8),
+
+        DecodeType_All = (DecodeType_SenderReport |
+                          DecodeType_ReceiverReport |
+                          DecodeType_SDES |
+                          DecodeType_Bye |
+                          DecodeType_App |
+                          DecodeType_TransportLayerFeedbackMessage |
+                          DecodeType_PayloadSpecificFeedbackMessage |
+                          DecodeType_XR |
+                          DecodeType_UnknownReport),
+      };
+
     public:
       //-----------------------------------------------------------------------
       #pragma mark
@@ -1411,38 +1445,62 @@ namespace ortc
       ~RTCPPacket();
 
       static RTCPPacketPtr create(const BYTE *buffer, size_t bufferLengthInBytes);
+      static RTCPPacketPtr createLazy(const BYTE *buffer, size_t bufferLengthInBytes);  // NOTE: only the report headers are validated; each report type is decoded upon first access
+      static RTCPPacketPtr create(
+                                  const BYTE *buffer,
+                                  size_t bufferLengthInBytes,
+                                  size_t reserveHeadroom,
+                                  size_t reserveTailroom
+                                  );
       static RTCPPacketPtr create(const SecureByteBlock &buffer);
       static RTCPPacketPtr create(SecureByteBlockPtr buffer);  // NOTE: ownership of buffer is taken
       static RTCPPacketPtr create(const Report *first);
+      static RTCPPacketPtr create(
+                                  const Report *first,
+                                  size_t reserveHeadroom,
+                                  size_t reserveTailroom
+                                  );
       static SecureByteBlockPtr generateFrom(const Report *first);
+      static SecureByteBlockPtr generateFrom(
+                                             const Report *first,
+                                             size_t reserveHeadroom,   // NOTE: the packet starts at this offset into the returned buffer
+                                             size_t reserveTailroom
+                                             );
 
       const BYTE *ptr() const;
       size_t size() const;
-      SecureByteBlockPtr buffer() const;
+      SecureByteBlockPtr buffer() const;  // NOTE: a copy is returned if room was reserved around the packet
 
-      Report *first() const                                                       {return mFirst;}
+      size_t headroom() const;
+      size_t tailroom() const;
+      BYTE *writablePtr();
 
-      SenderReport *firstSenderReport() const                                     {return mFirstSenderReport;}
-      ReceiverReport *firstReceiverReport() const                                 {return mFirstReceiverReport;}
-      SDES *firstSDES() const                                                     {return mFirstSDES;}
-      Bye *firstBye() const                                                       {return mFirstBye;}
-      App *firstApp() const                                                       {return mFirstApp;}
-      TransportLayerFeedbackMessage *firstTransportLayerFeedbackMessage() const   {return mFirstTransportLayerFeedbackMessage;}
-      PayloadSpecificFeedbackMessage *firstPayloadSpecificFeedbackMessage() const {return mFirstPayloadSpecificFeedbackMessage;}
-      XR *firstXR() const                                                         {return mFirstXR;}
-      UnknownReport *firstUnknownReport() const                                   {return mFirstUnknownReport;}
+      bool decode(DecodeTypes types) const;  // returns false if any of the report types requested were malformed (and thus dropped)
+
+      Report *first() const;  // NOTE: decodes all report types
+      const Report *firstIndexed() const                                          {return mFirst;}  // NOTE: only the common report header fields and raw contents are valid (nothing is decoded)
+
+      SenderReport *firstSenderReport() const                                     {decode(DecodeType_SenderReport); return mFirstSenderReport;}
+      ReceiverReport *firstReceiverReport() const                                 {decode(DecodeType_ReceiverReport); return mFirstReceiverReport;}
+      SDES *firstSDES() const                                                     {decode(DecodeType_SDES); return mFirstSDES;}
+      Bye *firstBye() const                                                       {decode(DecodeType_Bye); return mFirstBye;}
+      App *firstApp() const                                                       {decode(DecodeType_App); return mFirstApp;}
+      TransportLayerFeedbackMessage *firstTransportLayerFeedbackMessage() const   {decode(DecodeType_TransportLayerFeedbackMessage); return mFirstTransportLayerFeedbackMessage;}
+      PayloadSpecificFeedbackMessage *firstPayloadSpecificFeedbackMessage() const {decode(DecodeType_PayloadSpecificFeedbackMessage); return mFirstPayloadSpecificFeedbackMessage;}
+      XR *firstXR() const                                                         {decode(DecodeType_XR); return mFirstXR;}
+      UnknownReport *firstUnknownReport() const                                   {decode(DecodeType_UnknownReport); return mFirstUnknownReport;}
 
       size_t count() const                                                        {return mCount;}
 
-      size_t senderReportCount() const                                            {return mSenderReportCount;}
-      size_t receiverReportCount() const                                          {return mReceiverReportCount;}
-      size_t sdesCount() const                                                    {return mSDESCount;}
-      size_t byeCount() const                                                     {return mByeCount;}
-      size_t appCount() const                                                     {return mAppCount;}
-      size_t transportLayerFeedbackMessageCount() const                           {return mTransportLayerFeedbackMessageCount;}
-      size_t payloadSpecificFeedbackMessage() const                               {return mPayloadSpecificFeedbackMessageCount;}
-      size_t xrCount() const                                                      {return mXRCount;}
-      size_t unknownReportCount() const                                           {return mUnknownReportCount;}
+      size_t senderReportCount() const                                            {decode(DecodeType_SenderReport); return mSenderReportCount;}
+      size_t receiverReportCount() const                                          {decode(DecodeType_ReceiverReport); return mReceiverReportCount;}
+      size_t sdesCount() const                                                    {decode(DecodeType_SDES); return mSDESCount;}
+      size_t byeCount() const                                                     {decode(DecodeType_Bye); return mByeCount;}
+      size_t appCount() const                                                     {decode(DecodeType_App); return mAppCount;}
+      size_t transportLayerFeedbackMessageCount() const                           {decode(DecodeType_TransportLayerFeedbackMessage); return mTransportLayerFeedbackMessageCount;}
+      size_t payloadSpecificFeedbackMessage() const                               {decode(DecodeType_PayloadSpecificFeedbackMessage); return mPayloadSpecificFeedbackMessageCount;}
+      size_t xrCount() const                                                      {decode(DecodeType_XR); return mXRCount;}
+      size_t unknownReportCount() const                                           {decode(DecodeType_UnknownReport); return mUnknownReportCount;}
       
       SenderReport *senderReportAtIndex(size_t index) const;
       ReceiverReport *receiverReportAtIndex(size_t index) const;
@@ -1466,43 +1524,20 @@ namespace ortc
       Log::Params log(const char *message) const;
       Log::Params debug(const char *message) const;
 
-      bool parse();
-
-      bool getAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, BYTE pt, const BYTE *contents, size_t contentSize);
-      bool getSenderReportAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-      bool getReceiverReportAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-      bool getSDESAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-      bool getByeAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-      bool getAppAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-      bool getTransportLayerFeedbackMessageAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-      bool getXRAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-      bool getUnknownReportAllocationSize(BYTE version, BYTE padding, BYTE reportSpecific, const BYTE *contents, size_t contentSize);
-
-      bool getTransportLayerFeedbackMessageGenericNACKAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getTransportLayerFeedbackMessageTMMBRAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getTransportLayerFeedbackMessageTMMBNAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-
-      bool getPayloadSpecificFeedbackMessagePLIAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageSLIAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageRPSIAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageFIRAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageTSTRAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageTSTNAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageVBCMAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageAFBAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-      bool getPayloadSpecificFeedbackMessageREMBAllocationSize(BYTE fmt, const BYTE *contents, size_t contentSize);
-
-      bool getXRLossRLEReportBlockAllocationSize(BYTE typeSpecific, const BYTE *contents, size_t contentSize);
-      bool getXRDuplicateRLEReportBlockAllocationSize(BYTE typeSpecific, const BYTE *contents, size_t contentSize);
-      bool getXRPacketReceiptTimesReportBlockAllocationSize(BYTE typeSpecific, const BYTE *contents, size_t contentSize);
-      bool getXRReceiverReferenceTimeReportBlockAllocationSize(BYTE typeSpecific, const BYTE *contents, size_t contentSize);
-      bool getXRDLRRReportBlockAllocationSize(BYTE typeSpecific, const BYTE *contents, size_t contentSize);
-      bool getXRStatisticsSummaryReportBlockAllocationSize(BYTE typeSpecific, const BYTE *contents, size_t contentSize);
-      bool getXRVoIPMetricsReportBlockAllocationSize(BYTE typeSpecific, const BYTE *contents, size_t contentSize);
-      bool getXRUnknownReportBlockAllocationSize(BYTE typeSpecific, const BYTE *contents, size_t contentSize);
-
-      bool parse(Report * &ioLastReport, BYTE version, BYTE padding, BYTE reportSpecific, BYTE pt, const BYTE *contents, size_t contentSize);
+      bool parse(DecodeTypes decodeNow);
+
+      void countReport(BYTE pt);
+
+      void index(Report * &ioLastReport, BYTE version, BYTE padding, BYTE reportSpecific, BYTE pt, const BYTE *contents, size_t contentSize);
+
+      bool decodePending(WORD types);
+
+      template <typename TReport>
+      bool decodeReports(
+                         TReport * &ioFirst,
+                         size_t &ioCount,
+                         DecodeTypes type
+                         );
       void fill(Report *report, BYTE version, BYTE padding, BYTE reportSpecific, BYTE pt, const BYTE *contents, size_t contentSize);
 
       bool parseCommon(
@@ -1558,16 +1593,25 @@ namespace ortc
       static void writePacket(const Report *first, BYTE * &ioPos, size_t &ioRemaining);
 
     public:
-      SecureByteBlockPtr mBuffer;
-      SecureByteBlockPtr mAllocationBuffer;
+      SecureByteBlockPtr mBuffer;         // NOTE: may hold head/tail room around the packet
+
+      const BYTE *mPtr {};                // points inside mBuffer
+      size_t mSize {};
+
+      SecureByteBlockPtr mAllocationBuffer;                         // current arena block (borrowed from the buffer pool)
+      std::vector<SecureByteBlockPtr> mAllocationOverflowBuffers;   // filled arena blocks (rarely needed)
 
       BYTE *mAllocationPos {};
-      size_t mAllocationSize {};
+      size_t mAllocationSize {};                                    // remaining in current arena block
 
       Report *mFirst {};
 
       size_t mCount {};
 
+      mutable Lock mDecodeLock;                                     // only held while a report type is being decoded
+      std::atomic<WORD> mDecodedTypes {};                           // DecodeTypes which are decoded (or dropped as malformed)
+      WORD mMalformedTypes {};
+
       size_t mSenderReportCount {};
       size_t mReceiverReportCount {};
       size_t mSDESCount {};
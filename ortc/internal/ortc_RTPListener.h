@@ -33,6 +33,8 @@
 
 #include <ortc/internal/types.h>
 #include <ortc/internal/ortc_ISecureTransport.h>
+#include <ortc/internal/ortc_FlatHashMap.h>
+#include <ortc/internal/ortc_PacketRing.h>
 
 #include <ortc/IRTPListener.h>
 #include <ortc/IMediaStreamTrack.h>
@@ -42,10 +44,15 @@
 #include <zsLib/Timer.h>
 #include <zsLib/TearAway.h>
 
+#include <atomic>
+#include <set>
+
 #define ORTC_SETTING_RTP_LISTENER_MAX_RTP_PACKETS_IN_BUFFER "ortc/rtp-listener/max-rtp-packets-in-buffer"
+#define ORTC_SETTING_RTP_LISTENER_MAX_RTP_BYTES_IN_BUFFER "ortc/rtp-listener/max-rtp-bytes-in-buffer"
 #define ORTC_SETTING_RTP_LISTENER_MAX_AGE_RTP_PACKETS_IN_SECONDS "ortc/rtp-listener/max-age-rtp-packets-in-seconds"
 
 #define ORTC_SETTING_RTP_LISTENER_MAX_RTCP_PACKETS_IN_BUFFER "ortc/rtp-listener/max-rtcp-packets-in-buffer"
+#define ORTC_SETTING_RTP_LISTENER_MAX_RTCP_BYTES_IN_BUFFER "ortc/rtp-listener/max-rtcp-bytes-in-buffer"
 #define ORTC_SETTING_RTP_LISTENER_MAX_AGE_RTCP_PACKETS_IN_SECONDS "ortc/rtp-listener/max-age-rtcp-packets-in-seconds"
 
 #define ORTC_SETTING_RTP_LISTENER_SSRC_TIMEOUT_IN_SECONDS "ortc/rtp-listener/ssrc-timeout-in-seconds"
@@ -237,6 +244,8 @@ namespace ortc
       ZS_DECLARE_STRUCT_PTR(ReceiverInfo)
       ZS_DECLARE_STRUCT_PTR(SSRCInfo)
       ZS_DECLARE_STRUCT_PTR(UnhandledEventInfo)
+      ZS_DECLARE_STRUCT_PTR(InternTable)
+      ZS_DECLARE_STRUCT_PTR(RoutingTable)
 
       ZS_DECLARE_TYPEDEF_PTR(IRTPReceiverForRTPListener, UseRTPReceiver)
       ZS_DECLARE_TYPEDEF_PTR(IRTPSenderForRTPListener, UseRTPSender)
@@ -246,14 +255,19 @@ namespace ortc
 
       typedef std::list<RTCPPacketPtr> RTCPPacketList;
 
-      typedef std::pair<Time, RTPPacketPtr> TimeRTPPacketPair;
-      typedef std::list<TimeRTPPacketPair> BufferedRTPPacketList;
+      typedef PacketRing<RTPPacketPtr> BufferedRTPPacketRing;
+      typedef PacketRing<RTCPPacketPtr> BufferedRTCPPacketRing;
+
+      typedef FlatHashMap<SSRCType, SSRCInfoPtr> SSRCMap;
+      typedef FlatHashMap<SSRCType, SSRCInfoWeakPtr> SSRCWeakMap;
+      typedef std::set<SSRCType> SSRCSet;
 
-      typedef std::pair<Time, RTCPPacketPtr> TimeRTCPPacketPair;
-      typedef std::list<TimeRTCPPacketPair> BufferedRTCPPacketList;
+      typedef WORD InternedID;                                // MID strings interned to small integers
+      typedef FlatHashMap<DWORD, InternedID> InternedHashMap;
+      typedef std::vector<String> InternedStringList;
 
-      typedef std::map<SSRCType, SSRCInfoPtr> SSRCMap;
-      typedef std::map<SSRCType, SSRCInfoWeakPtr> SSRCWeakMap;
+      static const InternedID kInternedIDNone {0};            // no string present
+      static const InternedID kInternedIDUnknown {0xFFFF};    // string present but not interned
 
       typedef PUID ObjectID;
       typedef USHORT LocalID;
@@ -299,6 +313,8 @@ namespace ortc
         Parameters mFilledParameters;
         Parameters mOriginalParameters;
 
+        InternedID mMuxIDInterned {kInternedIDNone};      // interned mFilledParameters.mMuxID
+
         SSRCMap mRegisteredSSRCs;
 
         SSRCInfoPtr registerSSRCUsage(SSRCInfoPtr ssrcInfo);
@@ -312,6 +328,8 @@ namespace ortc
       ZS_DECLARE_PTR(ReceiverObjectMap)
       ZS_DECLARE_PTR(SenderObjectMap)
 
+      typedef std::map<SSRCType, SenderID> SenderSSRCMap;
+
       //-----------------------------------------------------------------------
       #pragma mark
       #pragma mark RTPListener::SSRCInfo
@@ -321,11 +339,14 @@ namespace ortc
       {
         SSRCType mSSRC {};
         Time mLastUsage;
+        std::atomic<Time::duration::rep> mLastRoutedUsage {};  // updated without the lock by packets routed via the RoutingTable
         String mMuxID;
+        InternedID mMuxIDInterned {kInternedIDNone};  // set once routing via mReceiverInfo's mux ID is confirmed
 
         ReceiverInfoPtr mReceiverInfo;    // can be NULL
 
         SSRCInfo();
+        Time lastUsage() const;
         ElementPtr toDebug() const;
       };
 
@@ -351,6 +372,61 @@ namespace ortc
 
       typedef std::map<struct UnhandledEventInfo, Time> UnhandledEventMap;
 
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RTPListener::InternTable
+      #pragma mark
+
+      struct InternTable
+      {
+        InternedHashMap mHashes;      // string hash => first interned ID with that hash
+        InternedStringList mStrings;  // InternedID - 1 => string
+
+        static DWORD hash(const char *str, size_t length);
+        InternedID find(const char *str, size_t length) const;
+      };
+
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RTPListener::RoutingTable
+      #pragma mark
+
+      // immutable snapshot of the SSRC routing state; replaced (under the
+      // lock) and read without the lock by packet threads. Routes are split
+      // into shards by SSRC so a replacement only copies the shards holding
+      // changed SSRCs and shares the rest with the previous snapshot.
+      struct RoutingTable
+      {
+        struct Route
+        {
+          ReceiverInfoPtr mReceiverInfo;
+          SSRCInfoPtr mSSRCInfo;
+          String mMuxID;
+          InternedID mMuxIDInterned {kInternedIDNone};
+        };
+
+        typedef FlatHashMap<SSRCType, Route> RouteMap;
+        typedef std::vector<BYTE> LocalIDList;
+
+        ZS_DECLARE_STRUCT_PTR(Shard)
+
+        struct Shard
+        {
+          RouteMap mRoutes;               // only SSRCs confirmed against their receiver's mux ID
+        };
+
+        static const size_t kShardCount = 16;   // must be a power of 2
+
+        ShardPtr mShards[kShardCount];    // non-mutable once published (COW)
+        LocalIDList mMuxIDExtensionIDs;   // local IDs of registered MID header extensions
+        InternTablePtr mInternTable;      // non-mutable (COW)
+
+        static size_t shardIndex(SSRCType ssrc) {return static_cast<size_t>(ssrc) & (kShardCount - 1);}
+
+        const Route *findRoute(SSRCType ssrc) const;
+        InternedID extractMuxIDInterned(const RTPPacket &rtpPacket) const;
+      };
+
       enum States
       {
         State_Pending,
@@ -555,6 +631,12 @@ namespace ortc
                        String &outMuxID
                        );
 
+      bool findMappingUsingRoutingTable(
+                                        const RTPPacket &rtpPacket,
+                                        ReceiverInfoPtr &outReceiverInfo,
+                                        String &outMuxID
+                                        ) const;
+
       bool findMappingUsingMuxID(
                                  const String &muxID,
                                  const RTPPacket &rtpPacket,
@@ -579,6 +661,8 @@ namespace ortc
                           );
       String extractRID(const RTPPacket &rtpPacket);
 
+      InternedID intern(const String &str);
+
       bool fillMuxIDParameters(
                                const String &muxID,
                                ReceiverInfoPtr &ioReceiverInfo
@@ -590,6 +674,24 @@ namespace ortc
       void processSDESMid(const RTCPPacket &rtcpPacket);
       void processSenderReports(const RTCPPacket &rtcpPacket);
 
+      void findRTCPTargets(
+                           const RTCPPacket &rtcpPacket,
+                           ReceiverObjectMapPtr &ioReceivers,
+                           SenderObjectMapPtr &ioSenders
+                           );
+      bool addRTCPReceiverTarget(
+                                 SSRCType ssrc,
+                                 ReceiverObjectMap &ioReceivers
+                                 );
+      bool addRTCPSenderTarget(
+                               SSRCType ssrc,
+                               SenderObjectMap &ioSenders
+                               );
+      void setSenderSSRCs(
+                          SenderID senderID,
+                          const Parameters *params
+                          );
+
       void handleDeltaChanges(
                               ReceiverInfoPtr replacementInfo,
                               const EncodingParameters &existing,
@@ -605,6 +707,13 @@ namespace ortc
                                );
       void registerSSRCUsage(SSRCInfoPtr ssrcInfo);
 
+      void markRouteDirty(SSRCType ssrc);
+      static bool fillRoute(
+                            const SSRCInfoPtr &ssrcInfo,
+                            RoutingTable::Route &outRoute
+                            );
+      void publishRoutingTable();
+
       void reattemptDelivery();
 
       void processUnhandled(
@@ -636,13 +745,15 @@ namespace ortc
       UseRTPTransportWeakPtr mRTPTransport;
 
       size_t mMaxBufferedRTPPackets {};
+      size_t mMaxBufferedRTPBytes {};
       Seconds mMaxRTPPacketAge {};
 
       size_t mMaxBufferedRTCPPackets {};
+      size_t mMaxBufferedRTCPBytes {};
       Seconds mMaxRTCPPacketAge {};
 
-      BufferedRTPPacketList mBufferedRTPPackets;
-      BufferedRTCPPacketList mBufferedRTCPPackets;
+      BufferedRTPPacketRing mBufferedRTPPackets;      // indexed by SSRC
+      BufferedRTCPPacketRing mBufferedRTCPPackets;
 
       HeaderExtensionMap mRegisteredExtensions;
 
@@ -652,8 +763,16 @@ namespace ortc
       SSRCMap mSSRCTable;
       SSRCWeakMap mRegisteredSSRCs;
 
+      SenderSSRCMap mSenderSSRCs;       // local SSRCs of registered senders (targets for RTCP feedback)
+
       MuxIDMap mMuxIDTable;
 
+      InternTablePtr mInternTable;        // non-mutable (COW)
+
+      RoutingTablePtr mRoutingTable;      // published with std::atomic_store (RCU); read with std::atomic_load
+      bool mRoutingTableDirty {};         // extension IDs or intern table changed (shards are unaffected)
+      SSRCSet mRoutingTableDirtySSRCs;    // SSRCs whose routes must be refreshed on the next publish
+
       TimerPtr mSSRCTableTimer;
       Seconds mSSRCTableExpires {};
 
@@ -991,7 +991,8 @@ namespace ortc
       public:
         ChannelResource(
                         const make_private &priv,
-                        IRTPMediaEngineRegistrationPtr registration
+                        IRTPMediaEngineRegistrationPtr registration,
+                        IMessageQueuePtr handlePacketQueue = IMessageQueuePtr()
                         );
 
         virtual ~ChannelResource();
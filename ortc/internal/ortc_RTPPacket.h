@@ -35,10 +35,36 @@
 
 #include <ortc/IICETypes.h>
 
+#include <atomic>
+
+// room reserved around outgoing RTP/RTCP packets (e.g. for TURN ChannelData /
+// RFC 4571 framing in front and the SRTP authentication tag / MKI behind)
+#define ORTC_SETTING_RTP_PACKET_RESERVED_HEADROOM_IN_BYTES "ortc/rtp-packet/reserved-headroom-in-bytes"
+#define ORTC_SETTING_RTP_PACKET_RESERVED_TAILROOM_IN_BYTES "ortc/rtp-packet/reserved-tailroom-in-bytes"
+
 namespace ortc
 {
   namespace internal
   {
+    ZS_DECLARE_INTERACTION_PTR(IRTPPacketForSettings)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IRTPPacketForSettings
+    #pragma mark
+
+    interaction IRTPPacketForSettings
+    {
+      ZS_DECLARE_TYPEDEF_PTR(IRTPPacketForSettings, ForSettings)
+
+      static void applyDefaults();
+
+      virtual ~IRTPPacketForSettings() {}
+    };
+
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -85,6 +111,9 @@ namespace ortc
         size_t mHeaderExtensionPrepaddedSize {};
         const BYTE *mHeaderExtensionStopParsePos {};
         size_t mHeaderExtensionStopParseSize {};
+
+        size_t mReserveHeadroom {};
+        size_t mReserveTailroom {};
       };
 
       //-----------------------------------------------------------------------
@@ -329,18 +358,39 @@ namespace ortc
       #pragma mark (public)
       #pragma mark
 
+      static const size_t kHeaderExtensionHeadroom {32};  // typical room needed to add MID/RID tags
+      static const size_t kHeaderExtensionLinearLookupMax {3};  // up to this many extensions are scanned rather than using the lookup table
+
       RTPPacket(const make_private &);
       ~RTPPacket();
 
       static RTPPacketPtr create(const RTPPacket &packet);
       static RTPPacketPtr create(const CreationParams &params);
       static RTPPacketPtr create(const BYTE *buffer, size_t bufferLengthInBytes);
+      static RTPPacketPtr create(
+                                 const BYTE *buffer,
+                                 size_t bufferLengthInBytes,
+                                 size_t reserveHeadroom,       // NOTE: room kept in front of the packet to grow header extensions / frame in place
+                                 size_t reserveTailroom        // NOTE: room kept behind the packet to protect in place
+                                 );
       static RTPPacketPtr create(const SecureByteBlock &buffer);
       static RTPPacketPtr create(SecureByteBlockPtr buffer);  // NOTE: ownership of buffer is taken
 
+      // NOTE: the packet is parsed in place and does not own the buffer; the
+      //       buffer must remain valid until materialize() is called or the
+      //       packet is destroyed.
+      static RTPPacketPtr createView(const BYTE *buffer, size_t bufferLengthInBytes);
+
       const BYTE *ptr() const;
       size_t size() const;
-      SecureByteBlockPtr buffer() const;
+      SecureByteBlockPtr buffer() const;  // NOTE: a copy is returned for a view or if room was reserved around the packet
+
+      bool isView() const {return !mBuffer;}
+      void materialize();
+
+      size_t headroom() const;
+      size_t tailroom() const;
+      BYTE *writablePtr();                // NOTE: a view is materialized first
 
       BYTE version() const {return mVersion;}
       size_t padding() const {return mPadding;}
@@ -362,13 +412,28 @@ namespace ortc
       size_t totalHeaderExtensions() const {return mTotalHeaderExtensions;}
       HeaderExtension *firstHeaderExtension() const {return mHeaderExtensions;}
       HeaderExtension *getHeaderExtensionAtIndex(size_t index) const;
+      HeaderExtension *findHeaderExtension(BYTE localID) const;  // constant time (lookup table is filled upon the first lookup needing it)
       BYTE headerExtensionAppBits() const {return mHeaderExtensionAppBits;}
 
       size_t headerExtensionPrepaddedSize() const {return mHeaderExtensionPrepaddedSize;}
       const BYTE *headerExtensionParseStopped() const {return mHeaderExtensionParseStoppedPos;}
       size_t headerExtensionParseStoppedSize() const {return mHeaderExtensionParseStoppedSize;}
 
-      void changeHeaderExtensions(HeaderExtension *firstExtension);
+      void changeHeaderExtensions(HeaderExtension *firstExtension);  // NOTE: rewritten in place when the headroom allows
+
+      // NOTE: the following patch the packet's bytes in place (a view is
+      //       materialized first) so anyone sharing the packet's own
+      //       allocation sees the change
+      void changeSSRC(DWORD ssrc);
+      void changeSequenceNumber(WORD sequenceNumber);
+      void changeTimestamp(DWORD timestamp);
+      void changePT(BYTE pt);
+      void changeM(bool m);
+      bool changeHeaderExtensionValue(
+                                      BYTE id,
+                                      const BYTE *data,
+                                      size_t dataSizeInBytes
+                                      );  // returns false if the id is not present or the value size differs
 
       ElementPtr toDebug() const;
 
@@ -383,8 +448,20 @@ namespace ortc
       Log::Params debug(const char *message) const;
 
       bool parse();
+      bool parseHeaderExtensions();
+      void resetHeaderExtensions();
+      void fillHeaderExtensionLookup() const;
+      void relocate(
+                    size_t reserveHeadroom,
+                    size_t reserveTailroom
+                    );
+      void rebase(
+                  const BYTE *oldBuffer,
+                  const BYTE *newBuffer
+                  );
 
       void writeHeaderExtensions(
+                                 BYTE *extensionPos,
                                  HeaderExtension *firstExtension,
                                  bool twoByteHeader
                                  );
@@ -392,7 +469,10 @@ namespace ortc
       void generate(const CreationParams &params);
 
     public:
-      SecureByteBlockPtr mBuffer;
+      SecureByteBlockPtr mBuffer;         // NOTE: may hold head/tail room around the packet
+
+      const BYTE *mPtr {};                // points inside mBuffer (or to the viewed buffer)
+      size_t mSize {};
 
       BYTE mVersion {};
       size_t mPadding {};
@@ -414,6 +494,10 @@ namespace ortc
       size_t mHeaderExtensionPrepaddedSize {};
       const BYTE *mHeaderExtensionParseStoppedPos {};
       size_t mHeaderExtensionParseStoppedSize {};
+
+      mutable Lock mHeaderExtensionLookupLock;                    // only held while the lookup table is being filled
+      mutable std::atomic<bool> mHeaderExtensionLookupFilled {};
+      mutable WORD mHeaderExtensionLookup[0x100];                 // index + 1 of first extension with the local ID (only valid once filled)
     };
 
   }
@@ -34,6 +34,7 @@
 #include <ortc/internal/types.h>
 #include <ortc/internal/ortc_ISecureTransport.h>
 #include <ortc/internal/ortc_RTPTypes.h>
+#include <ortc/internal/ortc_PacketRing.h>
 
 #include <ortc/IICETransport.h>
 #include <ortc/IRTPReceiver.h>
@@ -48,6 +49,7 @@
 #define ORTC_SETTING_RTP_RECEIVER_SSRC_TIMEOUT_IN_SECONDS "ortc/rtp-receiver/ssrc-timeout-in-seconds"
 
 #define ORTC_SETTING_RTP_RECEIVER_MAX_RTP_PACKETS_IN_BUFFER "ortc/rtp-receiver/max-rtp-packets-in-buffer"
+#define ORTC_SETTING_RTP_RECEIVER_MAX_RTP_BYTES_IN_BUFFER "ortc/rtp-receiver/max-rtp-bytes-in-buffer"
 #define ORTC_SETTING_RTP_RECEIVER_MAX_AGE_RTP_PACKETS_IN_SECONDS "ortc/rtp-receiver/max-age-rtp-packets-in-seconds"
 
 #define ORTC_SETTING_RTP_RECEIVER_CSRC_EXPIRY_TIME_IN_SECONDS "ortc/rtp-receiver/csrc-expiry-time-in-seconds"
@@ -235,8 +237,7 @@ namespace ortc
 
       ZS_DECLARE_PTR(RTCPPacketList)
 
-      typedef std::pair<Time, RTPPacketPtr> TimeRTPPacketPair;
-      typedef std::list<TimeRTPPacketPair> BufferedRTPPacketList;
+      typedef PacketRing<RTPPacketPtr> BufferedRTPPacketRing;
 
       typedef String RID;
       typedef PUID ChannelID;
@@ -779,9 +780,10 @@ namespace ortc
       Seconds mSSRCTableExpires {};
 
       size_t mMaxBufferedRTPPackets {};
+      size_t mMaxBufferedRTPBytes {};
       Seconds mMaxRTPPacketAge {};
 
-      BufferedRTPPacketList mBufferedRTPPackets;
+      BufferedRTPPacketRing mBufferedRTPPackets;  // indexed by SSRC
       bool mReattemptRTPDelivery {false};
 
       ContributingSourceMap mContributingSources;
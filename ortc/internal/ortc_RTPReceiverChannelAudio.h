@@ -448,6 +448,9 @@ namespace ortc
       TransportPtr mTransport;  // allow lifetime of callback to exist separate from "this" object
       std::atomic<ISecureTransport::States> mTransportState { ISecureTransport::State_Pending };
 
+      size_t mPacketHeadroom {};
+      size_t mPacketTailroom {};
+
       RTPPacketQueue mQueuedRTP;
       RTCPPacketQueue mQueuedRTCP;
     };
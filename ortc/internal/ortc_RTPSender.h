@@ -118,9 +118,15 @@ namespace ortc
 
       virtual PUID getID() const = 0;
 
+      typedef std::vector<RTPPacketPtr> RTPPacketList;
+
       virtual bool sendPacket(RTPPacketPtr packet) = 0;
       virtual bool sendPacket(RTCPPacketPtr packet) = 0;
 
+      // NOTE: sends a burst (e.g. every packet of an encoded frame) through
+      //       the secure transport as a single batch
+      virtual bool sendPackets(const RTPPacketList &packets) = 0;
+
       virtual void notifyConflict(
                                   UseChannelPtr channel,
                                   IRTPTypes::SSRCType ssrc,
@@ -368,6 +374,7 @@ namespace ortc
 
       virtual bool sendPacket(RTPPacketPtr packet) override;
       virtual bool sendPacket(RTCPPacketPtr packet) override;
+      virtual bool sendPackets(const RTPPacketList &packets) override;
 
       virtual void notifyConflict(
                                   UseChannelPtr channel,
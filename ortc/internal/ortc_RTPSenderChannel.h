@@ -140,11 +140,15 @@ namespace ortc
     {
       ZS_DECLARE_TYPEDEF_PTR(IRTPSenderChannelForRTPSenderChannelMediaBase, ForRTPSenderChannelMediaBase)
 
+      typedef std::vector<RTPPacketPtr> RTPPacketList;
+
       virtual PUID getID() const = 0;
 
       virtual bool sendPacket(RTPPacketPtr packet) = 0;
 
       virtual bool sendPacket(RTCPPacketPtr packet) = 0;
+
+      virtual bool sendPackets(const RTPPacketList &packets) = 0;
     };
 
     //-------------------------------------------------------------------------
@@ -362,6 +366,8 @@ namespace ortc
 
       virtual bool sendPacket(RTCPPacketPtr packet) override;
 
+      virtual bool sendPackets(const RTPPacketList &packets) override;
+
       //-----------------------------------------------------------------------
       #pragma mark
       #pragma mark RTPSenderChannel => IRTPSenderChannelForRTPSenderChannelAudio
@@ -437,6 +443,7 @@ namespace ortc
       void setError(WORD error, const char *reason = NULL);
 
       void setupTagging();
+      void tagPacket(RTPPacketPtr packet);
 
     protected:
       //-----------------------------------------------------------------------
@@ -469,6 +476,10 @@ namespace ortc
 
       Seconds mRetagAfterInSeconds {};
       bool mTagSDES {false};
+
+      size_t mPacketHeadroom {};
+      size_t mPacketTailroom {};
+
       TaggingMap mTaggings;
 
       Optional<IMediaStreamTrackTypes::Kinds> mKind;
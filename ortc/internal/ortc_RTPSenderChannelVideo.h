@@ -46,7 +46,8 @@
 
 #include <webrtc/transport.h>
 
-//#define ORTC_SETTING_SCTP_TRANSPORT_MAX_MESSAGE_SIZE "ortc/sctp/max-message-size"
+#define ORTC_SETTING_RTP_SENDER_CHANNEL_VIDEO_MAX_BURST_PACKETS "ortc/rtp-sender-channel-video/max-burst-packets"
+#define ORTC_SETTING_RTP_SENDER_CHANNEL_VIDEO_MAX_BURST_HOLD_IN_MILLISECONDS "ortc/rtp-sender-channel-video/max-burst-hold-in-milliseconds"
 
 namespace ortc
 {
@@ -207,6 +208,11 @@ namespace ortc
 
       ZS_DECLARE_TYPEDEF_PTR(IRTPTypes::Parameters, Parameters);
       typedef std::list<RTCPPacketPtr> RTCPPacketList;
+      typedef UseChannel::RTPPacketList RTPPacketList;
+      typedef IRTPTypes::PayloadType PayloadType;
+      typedef IRTPTypes::SSRCType SSRCType;
+      typedef std::set<PayloadType> PayloadTypeSet;
+      typedef std::map<SSRCType, WORD> SequenceNumberMap;
       ZS_DECLARE_PTR(RTCPPacketList);
       ZS_DECLARE_TYPEDEF_PTR(IStatsProviderTypes::PromiseWithStatsReport, PromiseWithStatsReport);
       ZS_DECLARE_TYPEDEF_PTR(IStatsReportTypes::StatsTypeSet, StatsTypeSet)
@@ -403,6 +409,10 @@ namespace ortc
       void setState(States state);
       void setError(WORD error, const char *reason = NULL);
 
+      bool sendBurst(RTPPacketList &packets);
+      void updateBurstPayloadTypes(const Parameters &params);
+      bool canHoldInBurst(const RTPPacket &packet);
+
     protected:
       //-----------------------------------------------------------------------
       #pragma mark
@@ -432,6 +442,21 @@ namespace ortc
 
       TransportPtr mTransport;  // allow lifetime of callback to exist separate from "this" object
       std::atomic<ISecureTransport::States> mTransportState { ISecureTransport::State_Pending };
+
+      size_t mPacketHeadroom {};
+      size_t mPacketTailroom {};
+
+      size_t mMaxBurstPackets {};
+      Milliseconds mMaxBurstHold {};
+
+      mutable Lock mBurstLock;
+      RTPPacketList mPendingBurst;  // packets of the frame currently being sent
+      Time mPendingBurstStarted;
+      TimerPtr mBurstTimer;         // flushes a burst whose marker bit never arrives
+
+      PayloadTypeSet mBurstMediaPayloadTypes;
+      PayloadTypeSet mBurstREDPayloadTypes;
+      SequenceNumberMap mBurstLastSequenceNumbers;  // highest sequence number held per SSRC
     };
 
     //-------------------------------------------------------------------------
@@ -215,6 +215,19 @@ namespace ortc
                               size_t bufferLengthInBytes
                               ) override;
 
+      virtual bool sendPacketInPlace(
+                                     IICETypes::Components sendOverICETransport,
+                                     IICETypes::Components packetType,
+                                     BYTE *buffer,
+                                     size_t bufferLengthInBytes,
+                                     size_t bufferTailroomInBytes
+                                     ) override;
+
+      virtual bool sendPackets(
+                               IICETypes::Components sendOverICETransport,
+                               const ISecureTransportTypes::OutgoingPacketList &packets
+                               ) override;
+
       virtual IICETransportPtr getICETransport() const override;
 
       //-----------------------------------------------------------------------
@@ -236,6 +249,14 @@ namespace ortc
       //                                     size_t bufferLengthInBytes
       //                                     ) override;
 
+      // (duplicate) virtual bool sendPacketInPlace(
+      //                                            IICETypes::Components sendOverICETransport,
+      //                                            IICETypes::Components packetType,
+      //                                            BYTE *buffer,
+      //                                            size_t bufferLengthInBytes,
+      //                                            size_t bufferTailroomInBytes
+      //                                            ) override;
+
       // (duplicate) virtual IICETransportPtr getICETransport() const override;
 
       //-----------------------------------------------------------------------
@@ -254,6 +275,7 @@ namespace ortc
 
       virtual bool handleReceivedPacket(
                                         IICETypes::Components viaTransport,
+                                        PacketDemux::PacketTypes packetType,
                                         const BYTE *buffer,
                                         size_t bufferLengthInBytes
                                         ) override;
@@ -278,6 +300,11 @@ namespace ortc
                                        size_t bufferLengthInBytes
                                        ) override;
 
+      virtual bool sendEncryptedPackets(
+                                        IICETypes::Components sendOverICETransport,
+                                        const ISecureTransportTypes::EncryptedPacketList &packets
+                                        ) override;
+
       virtual bool handleReceivedDecryptedPacket(
                                                  IICETypes::Components viaTransport,
                                                  IICETypes::Components packetType,
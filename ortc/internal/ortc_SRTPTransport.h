@@ -112,6 +112,7 @@ namespace ortc
 
       virtual bool handleReceivedPacket(
                                         IICETypes::Components viaTransport,
+                                        PacketDemux::PacketTypes packetType,
                                         const BYTE *buffer,
                                         size_t bufferLengthInBytes
                                         ) = 0;
@@ -122,6 +123,25 @@ namespace ortc
                               const BYTE *buffer,
                               size_t bufferLengthInBytes
                               ) = 0;
+
+      // NOTE: the packet is protected directly inside "buffer" (thus the
+      //       buffer contents are consumed); "bufferTailroomInBytes" is the
+      //       writable space after the packet available to hold the MKI and
+      //       authentication tag (falls back to a copy if insufficient)
+      virtual bool sendPacketInPlace(
+                                     IICETypes::Components sendOverICETransport,
+                                     IICETypes::Components packetType,
+                                     BYTE *buffer,
+                                     size_t bufferLengthInBytes,
+                                     size_t bufferTailroomInBytes
+                                     ) = 0;
+
+      // NOTE: protects every packet (in place where possible) then hands the
+      //       whole burst to the secure transport as a single batch
+      virtual bool sendPackets(
+                               IICETypes::Components sendOverICETransport,
+                               const ISecureTransportTypes::OutgoingPacketList &packets
+                               ) = 0;
     };
 
     //-------------------------------------------------------------------------
@@ -232,6 +252,7 @@ namespace ortc
 
       virtual bool handleReceivedPacket(
                                         IICETypes::Components viaTransport,
+                                        PacketDemux::PacketTypes packetType,
                                         const BYTE *buffer,
                                         size_t bufferLengthInBytes
                                         ) override;
@@ -243,6 +264,19 @@ namespace ortc
                               size_t bufferLengthInBytes
                               ) override;
 
+      virtual bool sendPacketInPlace(
+                                     IICETypes::Components sendOverICETransport,
+                                     IICETypes::Components packetType,
+                                     BYTE *buffer,
+                                     size_t bufferLengthInBytes,
+                                     size_t bufferTailroomInBytes
+                                     ) override;
+
+      virtual bool sendPackets(
+                               IICETypes::Components sendOverICETransport,
+                               const ISecureTransportTypes::OutgoingPacketList &packets
+                               ) override;
+
       //-----------------------------------------------------------------------
       #pragma mark
       #pragma mark SRTPTransport => IWakeDelegate
@@ -282,6 +316,27 @@ namespace ortc
                               KeyingMaterialPtr &keyingMaterial
                               );
 
+      bool protectAndSendPacket(
+                                IICETypes::Components sendOverICETransport,
+                                IICETypes::Components packetType,
+                                const BYTE *buffer,
+                                BYTE *writableBuffer,   // NULL if "buffer" must not be altered
+                                size_t bufferLengthInBytes,
+                                size_t bufferTailroomInBytes
+                                );
+
+      bool protectPacket(
+                         IICETypes::Components packetType,
+                         const BYTE *buffer,
+                         BYTE *writableBuffer,   // NULL if "buffer" must not be altered
+                         size_t bufferLengthInBytes,
+                         size_t bufferTailroomInBytes,
+                         UseSecureTransportPtr &outTransport,
+                         SecureByteBlockPtr &outEncryptedBuffer,  // only set if the packet had to be copied
+                         BYTE * &outEncryptedPtr,
+                         size_t &outEncryptedSizeInBytes
+                         );
+
       static size_t parseLifetime(const String &lifetime) throw(InvalidParameters);
 
       static SecureByteBlockPtr convertIntegerToBigEndianEncodedBuffer(
@@ -0,0 +1,123 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <openpeer/services/STUNPacket.h>
+
+#include <cryptopp/sha.h>
+
+namespace ortc
+{
+  namespace internal
+  {
+    ZS_DECLARE_CLASS_PTR(STUNMessageIntegrity)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark STUNMessageIntegrity
+    #pragma mark
+
+    // Short term credential MESSAGE-INTEGRITY (HMAC-SHA1) for a single ICE
+    // password. The HMAC inner and outer pads are hashed once up front and
+    // the resulting SHA1 states are copied for each message thus validating
+    // or signing a STUN message costs two SHA1 finals rather than a full
+    // key derivation.
+    //
+    // NOTE: Immutable after construction; safe to share between threads.
+    class STUNMessageIntegrity
+    {
+    protected:
+      struct make_private {};
+
+    public:
+      ZS_DECLARE_TYPEDEF_PTR(openpeer::services::STUNPacket, STUNPacket)
+
+      enum Sizes
+      {
+        Size_Header = 20,
+        Size_Digest = 20,
+        Size_MessageIntegrityAttribute = 4 + Size_Digest,
+        Size_FingerprintAttribute = 4 + 4,
+      };
+
+    public:
+      STUNMessageIntegrity(
+                           const make_private &,
+                           const String &password
+                           );
+
+      static STUNMessageIntegrityPtr create(const String &password);
+
+      const String &password() const          {return mPassword;}
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: validate the MESSAGE-INTEGRITY attribute of a raw STUN
+      //          message
+      // NOTE:    "useFinalMessageSize" and "zeroPadToBlockSize" select the
+      //          MS-ICE2 variant of the calculation
+      bool isValid(
+                   const BYTE *packet,
+                   size_t packetSizeInBytes,
+                   bool useFinalMessageSize = false,
+                   size_t zeroPadToBlockSize = 0
+                   ) const;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: packetize a STUN message signed with this password (and
+      //          followed by a FINGERPRINT attribute as ICE requires)
+      SecureByteBlockPtr packetize(STUNPacketPtr packet) const;
+
+    protected:
+      void computeHMAC(
+                       const BYTE *header,
+                       size_t lengthField,
+                       const BYTE *body,
+                       size_t bodySizeInBytes,
+                       size_t zeroPadToBlockSize,
+                       BYTE *outDigest
+                       ) const;
+
+    protected:
+      String mPassword;
+
+      CryptoPP::SHA1 mInner;    // state after hashing (key ^ ipad)
+      CryptoPP::SHA1 mOuter;    // state after hashing (key ^ opad)
+    };
+
+  }
+}
@@ -0,0 +1,229 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <zsLib/Socket.h>
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#define ORTC_SETTING_SOCKET_REACTOR_ENABLED "ortc/socket-reactor/enabled"
+#define ORTC_SETTING_SOCKET_REACTOR_TOTAL_THREADS "ortc/socket-reactor/total-threads"                 // 0 = one per core
+#define ORTC_SETTING_SOCKET_REACTOR_MAX_EVENTS_PER_WAIT "ortc/socket-reactor/max-events-per-wait"
+#define ORTC_SETTING_SOCKET_REACTOR_UDP_SHARDS_PER_PORT "ortc/socket-reactor/udp-shards-per-port"     // 1 = no SO_REUSEPORT sharding
+
+namespace ortc
+{
+  namespace internal
+  {
+    ZS_DECLARE_INTERACTION_PTR(ISocketReactorForSettings)
+
+    ZS_DECLARE_CLASS_PTR(SocketReactor)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ISocketReactorForSettings
+    #pragma mark
+
+    interaction ISocketReactorForSettings
+    {
+      ZS_DECLARE_TYPEDEF_PTR(ISocketReactorForSettings, ForSettings)
+
+      static void applyDefaults();
+
+      virtual ~ISocketReactorForSettings() {}
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark SocketReactor
+    #pragma mark
+
+    // Optional Linux socket reactor: one edge triggered epoll loop per thread
+    // (one thread per core by default). Monitored sockets are spread across
+    // the loops and their ISocketDelegate events fire directly on the loop's
+    // thread, bypassing the zsLib socket monitor and any message queue hop.
+    //
+    // Because monitoring is edge triggered a delegate must keep reading until
+    // the socket would block. Write readiness is not monitored by default;
+    // after a write would block call monitorWriteReady() to receive a single
+    // onWriteReady once the socket can be written again. Delegates are held
+    // weakly.
+    //
+    // UDP ports may also be sharded with SO_REUSEPORT: several sockets bound
+    // to the same address, each on its own loop, with the kernel hashing every
+    // remote address to one of them.
+    class SocketReactor : public ISocketReactorForSettings,
+                          public ISingletonManagerDelegate
+    {
+    protected:
+      struct make_private {};
+
+      ZS_DECLARE_STRUCT_PTR(Loop)
+
+      typedef ULONGLONG RegistrationID;
+      typedef std::pair<size_t, RegistrationID> LoopAndRegistrationPair;
+
+    public:
+      friend interaction ISocketReactorForSettings;
+
+      typedef zsLib::Socket Socket;
+      ZS_DECLARE_TYPEDEF_PTR(zsLib::Socket, Socket)
+      ZS_DECLARE_TYPEDEF_PTR(zsLib::ISocketDelegate, ISocketDelegate)
+
+      typedef std::vector<SocketPtr> SocketList;
+
+    public:
+      SocketReactor(const make_private &);
+
+    protected:
+      static SocketReactorPtr create();
+
+    public:
+      ~SocketReactor();
+
+      static SocketReactorPtr singleton();
+
+      // true if the reactor is turned on and supported on this platform
+      static bool isEnabled();
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: start monitoring a (non-blocking) socket from a reactor loop
+      // RETURNS: false if the reactor is unavailable (the caller must fall
+      //          back to Socket::setDelegate)
+      static bool monitor(
+                          SocketPtr socket,
+                          ISocketDelegatePtr delegate
+                          );
+
+      // NOTE: must be called before the socket is closed; an event already
+      //       being dispatched may still arrive after this returns
+      static void unmonitor(SocketPtr socket);
+
+      // PURPOSE: report onWriteReady (once) when the monitored socket becomes
+      //          writable (or immediately if it already is)
+      static void monitorWriteReady(SocketPtr socket);
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: allow other sockets to bind to the same address (must be
+      //          called before bind)
+      static bool enableReusePort(SocketPtr socket);
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: bind up to "total" additional UDP sockets to "boundIP" (which
+      //          must include the port of a socket bound with SO_REUSEPORT)
+      static SocketList createUDPShards(
+                                        const IPAddress &boundIP,
+                                        size_t total
+                                        );
+
+      static ElementPtr singletonToDebug();
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark SocketReactor => ISingletonManagerDelegate
+      #pragma mark
+
+      virtual void notifySingletonCleanup() override;
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark SocketReactor => (internal)
+      #pragma mark
+
+      static Log::Params slog(const char *message);
+      Log::Params log(const char *message) const;
+      ElementPtr toDebug() const;
+
+      bool add(
+               SocketPtr socket,
+               ISocketDelegatePtr delegate
+               );
+      void remove(SocketPtr socket);
+      void armWriteReady(SocketPtr socket);
+
+      bool startLoops();
+      void stopLoops();
+
+      static void runLoop(
+                          LoopPtr loop,
+                          size_t maxEvents
+                          );
+
+      static bool modify(
+                         LoopPtr loop,
+                         SocketPtr socket,
+                         RegistrationID registrationID,
+                         bool monitorWrite
+                         );
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark SocketReactor => (data)
+      #pragma mark
+
+      typedef std::map<const Socket *, LoopAndRegistrationPair> SocketMap;
+      typedef std::vector<LoopPtr> LoopList;
+
+      AutoPUID mID;
+      SocketReactorWeakPtr mThisWeak;
+
+      mutable Lock mLock;
+
+      size_t mTotalThreads {};
+      size_t mMaxEventsPerWait {};
+
+      bool mStarted {};
+      bool mStopped {};
+
+      LoopList mLoops;
+      size_t mNextLoop {};
+
+      RegistrationID mLastRegistrationID {};
+      SocketMap mSockets;
+    };
+
+  }
+}
@@ -0,0 +1,277 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <zsLib/Socket.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#define ORTC_SETTING_TCP_FRAMING_READ_BUFFER_SIZE_IN_BYTES "ortc/tcp-framing/read-buffer-size-in-bytes"
+#define ORTC_SETTING_TCP_FRAMING_MAX_FRAMES_PER_WRITE "ortc/tcp-framing/max-frames-per-write"
+
+namespace ortc
+{
+  namespace internal
+  {
+    ZS_DECLARE_INTERACTION_PTR(ITCPFramingForSettings)
+
+    ZS_DECLARE_CLASS_PTR(TCPFrameReader)
+    ZS_DECLARE_CLASS_PTR(TCPFrameWriter)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark ITCPFramingForSettings
+    #pragma mark
+
+    interaction ITCPFramingForSettings
+    {
+      ZS_DECLARE_TYPEDEF_PTR(ITCPFramingForSettings, ForSettings)
+
+      static void applyDefaults();
+
+      virtual ~ITCPFramingForSettings() {}
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TCPFrameReader
+    #pragma mark
+
+    // Reads an RFC 4571 stream (16-bit length prefixed packets) straight into
+    // one contiguous ring of bytes and hands every complete frame to the
+    // caller as a slice of that ring. Frames are never copied out; the only
+    // bytes ever moved are those of a partial frame that would run past the
+    // end of the ring, which are relocated to the start before reading more.
+    //
+    // NOTE: Not thread safe; the owner must serialize calls to receive().
+    class TCPFrameReader
+    {
+    public:
+      ZS_DECLARE_TYPEDEF_PTR(zsLib::Socket, Socket)
+
+      struct Frame
+      {
+        const BYTE *mBuffer {};   // points into buffer()
+        size_t mSize {};
+      };
+      typedef std::vector<Frame> FrameList;
+
+      struct Counters
+      {
+        ULONGLONG mReads {};          // calls to receive()
+        ULONGLONG mBytes {};          // stream bytes read
+        ULONGLONG mFrames {};         // frames returned to the caller
+        ULONGLONG mRelocatedBytes {}; // partial frame bytes moved to the start of the ring
+
+        ElementPtr toDebug() const;
+      };
+
+    public:
+      TCPFrameReader(size_t bufferSizeInBytes = 0);   // 0 = use setting
+      ~TCPFrameReader();
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: read what is waiting on the socket and extract every frame
+      //          it completes into frames()
+      // RETURNS: the number of stream bytes read; 0 if nothing was read in
+      //          which case outWouldBlock / outErrorCode explain why
+      // NOTE:    frames() is cleared by the next receive() and the slices
+      //          only stay valid until then; hold buffer() to keep the bytes
+      //          alive across a reset()
+      size_t receive(
+                     SocketPtr socket,
+                     bool &outWouldBlock,
+                     int &outErrorCode
+                     );
+
+      FrameList &frames()                     {return mFrames;}
+      SecureByteBlockPtr buffer() const       {return mBuffer;}
+
+      // bytes of an incomplete frame waiting for more of the stream
+      size_t pending() const                  {return mTail - mHead;}
+      size_t bufferSizeInBytes() const        {return mBufferSize;}
+
+      void reset();
+
+      const Counters &counters() const        {return mCounters;}
+
+      ElementPtr toDebug() const;
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TCPFrameReader => (internal)
+      #pragma mark
+
+      static Log::Params slog(const char *message);
+
+      void prepare();
+      void extract();
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TCPFrameReader => (data)
+      #pragma mark
+
+      size_t mBufferSize {};
+
+      SecureByteBlockPtr mBuffer;   // allocated on first receive()
+      size_t mHead {};              // first unconsumed byte
+      size_t mTail {};              // one past the last byte read
+
+      FrameList mFrames;
+
+      Counters mCounters;
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TCPFrameWriter
+    #pragma mark
+
+    // Frames outgoing packets for an RFC 4571 stream and writes everything
+    // queued with a single gathered send (sendmsg() over an iovec per frame
+    // where available; coalesced into one send elsewhere). Each packet is
+    // copied exactly once, together with its length prefix, into a pooled
+    // buffer when it is queued.
+    //
+    // NOTE: Not thread safe; the owner must serialize all calls.
+    class TCPFrameWriter
+    {
+    public:
+      ZS_DECLARE_TYPEDEF_PTR(zsLib::Socket, Socket)
+
+      struct Counters
+      {
+        ULONGLONG mFlushes {};        // calls to flush()
+        ULONGLONG mSystemCalls {};    // send related system calls issued
+        ULONGLONG mFrames {};         // frames completely written
+        ULONGLONG mBytes {};          // stream bytes written
+
+        ElementPtr toDebug() const;
+      };
+
+    public:
+      TCPFrameWriter(size_t maxFramesPerWrite = 0);   // 0 = use setting
+      ~TCPFrameWriter();
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: frame a packet and queue it behind anything already queued
+      // RETURNS: false if the packet is too large to be framed
+      bool add(
+               const BYTE *buffer,
+               size_t bufferSizeInBytes
+               );
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: write as much of the queue as the socket accepts
+      // RETURNS: the number of stream bytes written; 0 if nothing was written
+      //          in which case outWouldBlock / outErrorCode explain why
+      size_t flush(
+                   SocketPtr socket,
+                   bool &outWouldBlock,
+                   int &outErrorCode
+                   );
+
+      // stream bytes (including length prefixes) not yet written
+      size_t pending() const                  {return mPendingBytes;}
+      size_t pendingFrames() const            {return mQueue.size();}
+      size_t maxFramesPerWrite() const        {return mMaxFrames;}
+
+      void reset();
+
+      const Counters &counters() const        {return mCounters;}
+
+      ElementPtr toDebug() const;
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TCPFrameWriter => (internal)
+      #pragma mark
+
+      struct QueuedFrame
+      {
+        SecureByteBlockPtr mBuffer;   // NOTE: pooled, may be larger than mSize
+        size_t mSize {};              // length prefix included
+      };
+      typedef std::deque<QueuedFrame> QueuedFrameList;
+
+      static Log::Params slog(const char *message);
+
+      size_t sendGathered(
+                          SocketPtr socket,
+                          bool &outWouldBlock,
+                          int &outErrorCode
+                          );
+      size_t sendCoalesced(
+                           SocketPtr socket,
+                           bool &outWouldBlock,
+                           int &outErrorCode
+                           );
+      void consume(size_t sent);
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TCPFrameWriter => (data)
+      #pragma mark
+
+      size_t mMaxFrames {};
+
+      QueuedFrameList mQueue;
+      size_t mFrontOffset {};       // bytes of the front frame already written
+      size_t mPendingBytes {};
+
+      SecureByteBlockPtr mScratch;  // used when frames are coalesced
+
+      Counters mCounters;
+    };
+
+  }
+}
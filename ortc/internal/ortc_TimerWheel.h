@@ -0,0 +1,406 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <vector>
+
+namespace ortc
+{
+  namespace internal
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark TimerWheel
+    #pragma mark
+
+    // Hierarchical timing wheel (four levels of 64 slots) for objects that
+    // own many short lived timers, e.g. one keep warm timer per candidate
+    // pair. Adding and cancelling a timer are O(1) and do not create any OS
+    // level timer; the owner drives the wheel from a single one shot zsLib
+    // timer armed for nextWakeUp() (re-armed whenever a timer is added that
+    // is due sooner) by calling advance() which collects every value due in
+    // one batch.
+    //
+    // Timers never fire early but may fire up to one resolution late. Timers
+    // further out than the wheel's span are parked in the top level and
+    // re-evaluated as the wheel turns.
+    //
+    // Not thread safe; the owner must hold its own lock.
+    template <typename TValue>
+    class TimerWheel
+    {
+    public:
+      typedef QWORD TimerID;                   // 0 is never a valid timer
+      typedef std::vector<TValue> ValueList;
+
+    protected:
+      enum Sizes
+      {
+        Size_SlotBits = 6,
+        Size_SlotsPerLevel = 1 << Size_SlotBits,
+        Size_SlotMask = Size_SlotsPerLevel - 1,
+        Size_Levels = 4,
+        Size_TotalSlots = Size_Levels * Size_SlotsPerLevel,
+      };
+
+      static const DWORD kNone = 0xFFFFFFFF;
+
+      struct Entry
+      {
+        ULONGLONG mTick {};
+        DWORD mGeneration {1};                 // bumped on release so stale timer IDs never match
+        DWORD mSlot {kNone};                   // kNone when the entry is free
+        DWORD mPrevious {kNone};
+        DWORD mNext {kNone};
+        TValue mValue {};
+      };
+
+      typedef std::vector<Entry> EntryList;
+      typedef std::vector<DWORD> SlotList;
+
+    public:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TimerWheel (public)
+      #pragma mark
+
+      TimerWheel(
+                 Milliseconds resolution = Milliseconds(10),
+                 Time start = zsLib::now()
+                 ) :
+        mResolution(Milliseconds::zero() < resolution ? resolution : Milliseconds(1)),
+        mStart(start),
+        mSlots(Size_TotalSlots, kNone)
+      {}
+
+      size_t size() const                                     {return mSize;}
+      bool empty() const                                      {return 0 == mSize;}
+      Milliseconds resolution() const                         {return mResolution;}
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: schedule "value" to be returned from advance() once "expires"
+      //          has been reached
+      TimerID add(
+                  Time expires,
+                  const TValue &value
+                  )
+      {
+        DWORD index = allocate();
+        Entry &entry = mEntries[index];
+        entry.mTick = toTick(expires, true);
+        entry.mValue = value;
+        link(index, mCurrentTick + 1);
+        ++mSize;
+        return toTimerID(index);
+      }
+
+      //-----------------------------------------------------------------------
+      // RETURNS: false if the timer already fired or was already cancelled
+      bool cancel(TimerID timerID)
+      {
+        DWORD index = 0;
+        if (!locate(timerID, index)) return false;
+        unlink(index);
+        release(index);
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      bool isPending(TimerID timerID) const
+      {
+        DWORD index = 0;
+        return locate(timerID, index);
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: turn the wheel up to "now" appending the value of every
+      //          timer that has expired to "outFired"
+      // RETURNS: the number of timers that fired
+      size_t advance(
+                     Time now,
+                     ValueList &outFired
+                     )
+      {
+        size_t total = 0;
+        ULONGLONG target = toTick(now, false);
+
+        if (0 == mSize) {
+          if (target > mCurrentTick) mCurrentTick = target;
+          return 0;
+        }
+
+        while (mCurrentTick < target) {
+          ++mCurrentTick;
+
+          // move timers from the outer levels inwards each time a level wraps
+          for (size_t level = 1; level < Size_Levels; ++level) {
+            ULONGLONG lowerMask = (static_cast<ULONGLONG>(1) << (Size_SlotBits * level)) - 1;
+            if (0 != (mCurrentTick & lowerMask)) break;
+            cascade(slotFor(level, mCurrentTick));
+          }
+
+          DWORD slot = slotFor(0, mCurrentTick);
+          DWORD index = mSlots[slot];
+          mSlots[slot] = kNone;
+
+          while (kNone != index) {
+            Entry &entry = mEntries[index];
+            DWORD next = entry.mNext;
+
+            entry.mSlot = kNone;
+            if (entry.mTick <= mCurrentTick) {
+              outFired.push_back(entry.mValue);
+              release(index);
+              ++total;
+            } else {
+              link(index, mCurrentTick + 1);
+            }
+            index = next;
+          }
+
+          if (0 == mSize) {
+            mCurrentTick = target;
+            break;
+          }
+        }
+        return total;
+      }
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: when advance() must next be called
+      // RETURNS: the tick of the nearest occupied slot (which may only
+      //          cascade timers further out rather than fire them) or Time()
+      //          if no timer is pending
+      Time nextWakeUp() const
+      {
+        if (0 == mSize) return Time();
+
+        // the inner level holds every timer due within one turn, one tick
+        // per slot
+        for (ULONGLONG tick = mCurrentTick + 1; tick <= mCurrentTick + Size_SlotsPerLevel; ++tick) {
+          if (kNone != mSlots[slotFor(0, tick)]) return toTime(tick);
+        }
+
+        // otherwise wake up when the nearest occupied outer slot cascades
+        ULONGLONG nearest = 0;
+        for (size_t level = 1; level < Size_Levels; ++level) {
+          size_t shift = Size_SlotBits * level;
+          for (ULONGLONG step = 1; step <= Size_SlotsPerLevel; ++step) {
+            ULONGLONG tick = ((mCurrentTick >> shift) + step) << shift;
+            if (kNone == mSlots[slotFor(level, tick)]) continue;
+            if ((0 == nearest) || (tick < nearest)) nearest = tick;
+            break;
+          }
+        }
+        return toTime(nearest);
+      }
+
+      //-----------------------------------------------------------------------
+      void clear()
+      {
+        for (DWORD index = 0; index < static_cast<DWORD>(mEntries.size()); ++index) {
+          if (kNone == mEntries[index].mSlot) continue;
+          mEntries[index].mSlot = kNone;
+          release(index);
+        }
+        for (auto iter = mSlots.begin(); iter != mSlots.end(); ++iter) {
+          *iter = kNone;
+        }
+      }
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TimerWheel (internal)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      ULONGLONG toTick(
+                       Time when,
+                       bool roundUp
+                       ) const
+      {
+        if (when <= mStart) return 0;
+        ULONGLONG elapsed = static_cast<ULONGLONG>(zsLib::toMilliseconds(when - mStart).count());
+        ULONGLONG resolution = static_cast<ULONGLONG>(mResolution.count());
+        return (elapsed + (roundUp ? resolution - 1 : 0)) / resolution;
+      }
+
+      //-----------------------------------------------------------------------
+      Time toTime(ULONGLONG tick) const
+      {
+        return mStart + Milliseconds(static_cast<Milliseconds::rep>(tick * static_cast<ULONGLONG>(mResolution.count())));
+      }
+
+      //-----------------------------------------------------------------------
+      static DWORD slotFor(
+                           size_t level,
+                           ULONGLONG tick
+                           )
+      {
+        return static_cast<DWORD>((level * Size_SlotsPerLevel) + ((tick >> (Size_SlotBits * level)) & Size_SlotMask));
+      }
+
+      //-----------------------------------------------------------------------
+      TimerID toTimerID(DWORD index) const
+      {
+        return (static_cast<QWORD>(mEntries[index].mGeneration) << 32) | static_cast<QWORD>(index + 1);
+      }
+
+      //-----------------------------------------------------------------------
+      bool locate(
+                  TimerID timerID,
+                  DWORD &outIndex
+                  ) const
+      {
+        DWORD position = static_cast<DWORD>(timerID & 0xFFFFFFFF);
+        if (0 == position) return false;
+        if (position > mEntries.size()) return false;
+
+        const Entry &entry = mEntries[position - 1];
+        if (kNone == entry.mSlot) return false;
+        if (entry.mGeneration != static_cast<DWORD>(timerID >> 32)) return false;
+
+        outIndex = position - 1;
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      DWORD allocate()
+      {
+        if (kNone != mFreeHead) {
+          DWORD index = mFreeHead;
+          mFreeHead = mEntries[index].mNext;
+          return index;
+        }
+        mEntries.push_back(Entry());
+        return static_cast<DWORD>(mEntries.size() - 1);
+      }
+
+      //-----------------------------------------------------------------------
+      void release(DWORD index)
+      {
+        Entry &entry = mEntries[index];
+        entry.mValue = TValue();               // release the value now rather than when the entry is reused
+        ++entry.mGeneration;
+        if (0 == entry.mGeneration) entry.mGeneration = 1;
+        entry.mPrevious = kNone;
+        entry.mNext = mFreeHead;
+        mFreeHead = index;
+        --mSize;
+      }
+
+      //-----------------------------------------------------------------------
+      void link(
+                DWORD index,
+                ULONGLONG earliestTick
+                )
+      {
+        Entry &entry = mEntries[index];
+
+        ULONGLONG tick = (entry.mTick < earliestTick ? earliestTick : entry.mTick);
+        ULONGLONG delta = tick - mCurrentTick;
+
+        // beyond the span of the wheel; park in the top level until it turns
+        ULONGLONG span = static_cast<ULONGLONG>(1) << (Size_SlotBits * Size_Levels);
+        if (delta >= span) {
+          tick = mCurrentTick + span - 1;
+          delta = span - 1;
+        }
+
+        size_t level = 0;
+        while ((level + 1 < Size_Levels) &&
+               (delta >= (static_cast<ULONGLONG>(1) << (Size_SlotBits * (level + 1))))) {
+          ++level;
+        }
+
+        DWORD slot = slotFor(level, tick);
+
+        entry.mSlot = slot;
+        entry.mPrevious = kNone;
+        entry.mNext = mSlots[slot];
+        if (kNone != entry.mNext) mEntries[entry.mNext].mPrevious = index;
+        mSlots[slot] = index;
+      }
+
+      //-----------------------------------------------------------------------
+      void unlink(DWORD index)
+      {
+        Entry &entry = mEntries[index];
+
+        if (kNone != entry.mPrevious) {
+          mEntries[entry.mPrevious].mNext = entry.mNext;
+        } else {
+          mSlots[entry.mSlot] = entry.mNext;
+        }
+        if (kNone != entry.mNext) mEntries[entry.mNext].mPrevious = entry.mPrevious;
+
+        entry.mSlot = kNone;
+      }
+
+      //-----------------------------------------------------------------------
+      void cascade(DWORD slot)
+      {
+        DWORD index = mSlots[slot];
+        mSlots[slot] = kNone;
+
+        while (kNone != index) {
+          DWORD next = mEntries[index].mNext;
+          link(index, mCurrentTick);
+          index = next;
+        }
+      }
+
+    protected:
+      Milliseconds mResolution;
+      Time mStart;
+
+      ULONGLONG mCurrentTick {};
+
+      EntryList mEntries;
+      SlotList mSlots;
+      DWORD mFreeHead {kNone};
+
+      size_t mSize {};
+    };
+
+    template <typename TValue>
+    const DWORD TimerWheel<TValue>::kNone;
+
+  }
+}
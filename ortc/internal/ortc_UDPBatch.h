@@ -0,0 +1,355 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#pragma once
+
+#include <ortc/internal/types.h>
+
+#include <zsLib/IPAddress.h>
+#include <zsLib/Socket.h>
+
+#include <memory>
+#include <vector>
+
+#define ORTC_SETTING_UDP_BATCH_MAX_DATAGRAMS_PER_READ "ortc/udp-batch/max-datagrams-per-read"
+#define ORTC_SETTING_UDP_BATCH_RECEIVE_BUFFER_SIZE_IN_BYTES "ortc/udp-batch/receive-buffer-size-in-bytes"
+#define ORTC_SETTING_UDP_BATCH_MAX_DATAGRAM_SIZE_IN_BYTES "ortc/udp-batch/max-datagram-size-in-bytes"
+#define ORTC_SETTING_UDP_BATCH_MAX_DATAGRAMS_PER_SEND "ortc/udp-batch/max-datagrams-per-send"
+#define ORTC_SETTING_UDP_BATCH_SEGMENTATION_OFFLOAD "ortc/udp-batch/segmentation-offload"
+
+namespace ortc
+{
+  namespace internal
+  {
+    ZS_DECLARE_INTERACTION_PTR(IUDPBatchForSettings)
+
+    ZS_DECLARE_CLASS_PTR(UDPBatchReceiver)
+    ZS_DECLARE_CLASS_PTR(UDPBatchSender)
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IUDPBatchForSettings
+    #pragma mark
+
+    interaction IUDPBatchForSettings
+    {
+      ZS_DECLARE_TYPEDEF_PTR(IUDPBatchForSettings, ForSettings)
+
+      static void applyDefaults();
+
+      virtual ~IUDPBatchForSettings() {}
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchReceiver
+    #pragma mark
+
+    // Drains a non-blocking UDP socket of up to "max datagrams per read"
+    // datagrams with as few system calls as the platform allows (a single
+    // recvmmsg() on Linux; one receive per datagram elsewhere). Each datagram
+    // lands in a pooled buffer which is handed to the caller.
+    //
+    // Batch slots are sized for ordinary datagrams. Anything larger spills
+    // into the slot's own overflow region (sized up to the maximum datagram
+    // size) and is copied out; datagrams larger than the maximum datagram
+    // size are dropped in batch mode.
+    //
+    // NOTE: Not thread safe; the owner must serialize calls to receive().
+    class UDPBatchReceiver
+    {
+    public:
+      typedef zsLib::IPAddress IPAddress;
+      typedef zsLib::Socket Socket;
+      ZS_DECLARE_TYPEDEF_PTR(zsLib::Socket, Socket)
+
+      struct Datagram
+      {
+        IPAddress mFromIP;
+        SecureByteBlockPtr mBuffer;   // NOTE: pooled, may be larger than mSize
+        size_t mSize {};
+      };
+      typedef std::vector<Datagram> DatagramList;
+
+      struct Counters
+      {
+        ULONGLONG mReads {};          // calls to receive()
+        ULONGLONG mSystemCalls {};    // receive related system calls issued
+        ULONGLONG mDatagrams {};      // datagrams returned to the caller
+        ULONGLONG mTruncated {};      // datagrams dropped as too large for a buffer
+        ULONGLONG mOversized {};      // datagrams larger than a slot (copied out of the slot's overflow region)
+
+        ElementPtr toDebug() const;
+      };
+
+    public:
+      UDPBatchReceiver(
+                       size_t maxDatagramsPerRead = 0,    // 0 = use setting
+                       size_t bufferSizeInBytes = 0       // 0 = use setting
+                       );
+      ~UDPBatchReceiver();
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: read every datagram waiting on the socket (up to the batch
+      //          limit) into datagrams()
+      // RETURNS: the number of datagrams read; 0 if nothing was read in which
+      //          case outWouldBlock / outErrorCode explain why
+      // NOTE:    datagrams() is cleared by the next receive(); move out any
+      //          datagram that must outlive it
+      size_t receive(
+                     SocketPtr socket,
+                     bool &outWouldBlock,
+                     int &outErrorCode
+                     );
+
+      DatagramList &datagrams()               {return mDatagrams;}
+      size_t maxDatagramsPerRead() const      {return mMaxDatagrams;}
+      size_t bufferSizeInBytes() const        {return mBufferSize;}
+
+      // true if the last read filled the whole batch (more may be waiting)
+      bool moreMayBePending() const           {return mLastReadFull;}
+
+      const Counters &counters() const        {return mCounters;}
+
+      ElementPtr toDebug() const;
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark UDPBatchReceiver => (internal)
+      #pragma mark
+
+      static Log::Params slog(const char *message);
+
+      size_t receiveMultiple(
+                             SocketPtr socket,
+                             bool &outWouldBlock,
+                             int &outErrorCode
+                             );
+      size_t receiveEach(
+                         SocketPtr socket,
+                         bool &outWouldBlock,
+                         int &outErrorCode
+                         );
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark UDPBatchReceiver => (data)
+      #pragma mark
+
+      struct NativeState;
+
+      size_t mMaxDatagrams {};
+      size_t mBufferSize {};
+      size_t mMaxDatagramSize {};
+
+      DatagramList mDatagrams;
+      std::vector<SecureByteBlockPtr> mSlots;   // buffers armed for the next read
+
+      std::unique_ptr<NativeState> mNative;     // platform batch receive state (if any)
+      bool mMultipleSupported {};
+      bool mLastReadFull {};
+
+      SecureByteBlockPtr mScratch;              // used by the one-by-one fallback
+      SecureByteBlockPtr mOverflow;             // one overflow region per batch slot
+      size_t mOverflowSize {};                  // size of each slot's overflow region
+
+      Counters mCounters;
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark UDPBatchSender
+    #pragma mark
+
+    // Sends a burst of datagrams (e.g. every packet of an encoded frame) with
+    // as few system calls as the platform allows. On Linux runs of equally
+    // sized datagrams to the same destination go out as a single UDP_SEGMENT
+    // (GSO) send and everything else goes out through sendmmsg(); elsewhere
+    // each datagram is sent individually.
+    //
+    // NOTE: Not thread safe; the owner must serialize calls to add() and
+    //       flush(). Added buffers are referenced (not copied) and must stay
+    //       valid until flush() returns.
+    class UDPBatchSender
+    {
+    public:
+      typedef zsLib::IPAddress IPAddress;
+      typedef zsLib::Socket Socket;
+      ZS_DECLARE_TYPEDEF_PTR(zsLib::Socket, Socket)
+
+      struct Packet
+      {
+        const BYTE *mBuffer {};
+        size_t mSize {};
+      };
+      typedef std::vector<Packet> PacketList;
+
+      struct Counters
+      {
+        ULONGLONG mFlushes {};          // calls to flush()
+        ULONGLONG mSystemCalls {};      // send related system calls issued
+        ULONGLONG mDatagrams {};        // datagrams handed to the network
+        ULONGLONG mSegmentedSends {};   // sends using segmentation offload
+
+        ElementPtr toDebug() const;
+      };
+
+    public:
+      UDPBatchSender(
+                     size_t maxDatagramsPerSend = 0,         // 0 = use setting
+                     bool allowSegmentationOffload = true    // true = use setting; false = never
+                     );
+      ~UDPBatchSender();
+
+      void add(
+               const IPAddress &remoteIP,
+               const BYTE *buffer,
+               size_t bufferSizeInBytes
+               );
+      void add(
+               const IPAddress &remoteIP,
+               const PacketList &packets
+               );
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: send every added datagram in the order added
+      // RETURNS: the number of datagrams sent; anything not sent is discarded
+      //          in which case outWouldBlock / outErrorCode explain why
+      // NOTE:    "boundIP" is the address the socket is bound to (selects the
+      //          address family used for the destinations)
+      size_t flush(
+                   SocketPtr socket,
+                   const IPAddress &boundIP,
+                   bool &outWouldBlock,
+                   int &outErrorCode
+                   );
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: send one datagram made of a small prefix (e.g. a TURN
+      //          ChannelData header) followed by an untouched payload
+      // NOTE:    on Linux both parts are gathered by a single sendmsg() so
+      //          the payload is never copied; elsewhere they are joined in a
+      //          pooled buffer
+      static bool sendWithPrefix(
+                                 SocketPtr socket,
+                                 const IPAddress &boundIP,
+                                 const IPAddress &remoteIP,
+                                 const BYTE *prefix,
+                                 size_t prefixSizeInBytes,
+                                 const BYTE *buffer,
+                                 size_t bufferSizeInBytes,
+                                 bool &outWouldBlock,
+                                 int &outErrorCode
+                                 );
+
+      size_t pending() const                  {return mPending.size();}
+      size_t maxDatagramsPerSend() const      {return mMaxDatagrams;}
+      bool segmentationOffloadEnabled() const {return mOffloadSupported;}
+
+      const Counters &counters() const        {return mCounters;}
+
+      ElementPtr toDebug() const;
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark UDPBatchSender => (internal)
+      #pragma mark
+
+      struct PendingDatagram
+      {
+        IPAddress mRemoteIP;
+        const BYTE *mBuffer {};
+        size_t mSize {};
+      };
+      typedef std::vector<PendingDatagram> PendingDatagramList;
+
+      static Log::Params slog(const char *message);
+
+      size_t segmentRunLength(size_t index) const;
+
+      size_t sendSegmented(
+                           SocketPtr socket,
+                           bool useIPv4,
+                           size_t index,
+                           size_t total,
+                           bool &outWouldBlock,
+                           int &outErrorCode
+                           );
+      size_t sendMultiple(
+                          SocketPtr socket,
+                          bool useIPv4,
+                          size_t index,
+                          size_t total,
+                          bool &outWouldBlock,
+                          int &outErrorCode
+                          );
+      size_t sendEach(
+                      SocketPtr socket,
+                      size_t index,
+                      size_t total,
+                      bool &outWouldBlock,
+                      int &outErrorCode
+                      );
+
+    protected:
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark UDPBatchSender => (data)
+      #pragma mark
+
+      struct NativeState;
+
+      size_t mMaxDatagrams {};
+
+      PendingDatagramList mPending;
+
+      std::unique_ptr<NativeState> mNative;     // platform batch send state (if any)
+      bool mMultipleSupported {};
+      bool mOffloadSupported {};
+
+      Counters mCounters;
+    };
+
+  }
+}
@@ -42,6 +42,13 @@
 #undef HAVE_SPRINTF_S
 #undef HAVE_GETADAPTERADDRESSES
 #undef HAVE_GETIFADDRS
+#undef HAVE_RECVMMSG
+#undef HAVE_SENDMMSG
+#undef HAVE_UDP_SEGMENT
+#undef HAVE_EPOLL
+#undef HAVE_SO_REUSEPORT
+#undef HAVE_RTNETLINK
+#undef HAVE_SENDMSG
 
 
 #ifdef _WIN32
@@ -99,6 +106,7 @@
 #define HAVE_GETIFADDRS 1
 #define HAVE_NET_IF_H 1
 #define HAVE_TGMATH_H
+#define HAVE_SENDMSG 1
 #if TARGET_OS_IPHONE
 // iphone OS
 #else
@@ -116,6 +124,13 @@
 #define HAVE_NET_IF_H 1
 #define HAVE_NETINIT6_IN6_VAR_H 1
 #define HAVE_GETIFADDRS 1
+#define HAVE_RECVMMSG 1
+#define HAVE_SENDMMSG 1
+#define HAVE_UDP_SEGMENT 1
+#define HAVE_EPOLL 1
+#define HAVE_SO_REUSEPORT 1
+#define HAVE_RTNETLINK 1
+#define HAVE_SENDMSG 1
 
 #ifdef _ANDROID
 
@@ -123,6 +138,10 @@
 
 // Android does not support these features
 #undef HAVE_IFADDRS_H
+#undef HAVE_RECVMMSG
+#undef HAVE_SENDMMSG
+#undef HAVE_UDP_SEGMENT
+#undef HAVE_RTNETLINK
 
 #endif //_ANDROID
 #endif //_LINUX
@@ -116,6 +116,7 @@ namespace ortc
 
     ZS_DECLARE_CLASS_PTR(ORTC)
     ZS_DECLARE_CLASS_PTR(Settings)
+    ZS_DECLARE_CLASS_PTR(BufferPool)
     ZS_DECLARE_CLASS_PTR(Certificate)
     ZS_DECLARE_CLASS_PTR(DataChannel)
     ZS_DECLARE_CLASS_PTR(DTMFSender)
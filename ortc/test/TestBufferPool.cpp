@@ -0,0 +1,214 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/MessageQueueThread.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_BufferPool.h>
+
+#include <openpeer/services/IHelper.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <list>
+#include <thread>
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::BYTE;
+using zsLib::ULONG;
+using zsLib::ULONGLONG;
+using ortc::SecureByteBlock;
+using ortc::SecureByteBlockPtr;
+
+ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
+ZS_DECLARE_TYPEDEF_PTR(ortc::internal::BufferPool, UseBufferPool)
+
+#define TEST_BASIC_POOL 0
+
+static bool isZeroFilled(const SecureByteBlock &buffer)
+{
+  const BYTE *pos = buffer.BytePtr();
+  for (size_t index = 0; index < buffer.SizeInBytes(); ++index) {
+    if (0 != pos[index]) return false;
+  }
+  return true;
+}
+
+void doTestBufferPool()
+{
+  if (!ORTC_TEST_DO_BUFFER_POOL_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for buffer pool testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_POOL: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_POOL: {
+            switch (step) {
+              case 1: {
+                // size classes round up
+                TESTING_EQUAL(256, UseBufferPool::allocate(1)->SizeInBytes())
+                TESTING_EQUAL(256, UseBufferPool::allocate(256)->SizeInBytes())
+                TESTING_EQUAL(1500, UseBufferPool::allocate(257)->SizeInBytes())
+                TESTING_EQUAL(9000, UseBufferPool::allocate(1501)->SizeInBytes())
+                TESTING_EQUAL(0xFFFF+1, UseBufferPool::allocate(9001)->SizeInBytes())
+
+                // oversized buffers are not pooled
+                TESTING_EQUAL(0xFFFF+2, UseBufferPool::allocate(0xFFFF+2)->SizeInBytes())
+                break;
+              }
+              case 2: {
+                // recycled buffers are handed back zeroed
+                UseBufferPool::Stats before = UseBufferPool::getStats();
+
+                const BYTE *original = NULL;
+                {
+                  auto buffer = UseBufferPool::allocate(1200);
+                  original = buffer->BytePtr();
+                  memset(buffer->BytePtr(), 0xAB, buffer->SizeInBytes());
+
+                  UseBufferPool::Stats during = UseBufferPool::getStats();
+                  TESTING_EQUAL(before.mOutstanding + 1, during.mOutstanding)
+                }
+
+                auto buffer = UseBufferPool::allocate(1200);
+                TESTING_CHECK(original == buffer->BytePtr())
+                TESTING_CHECK(isZeroFilled(*buffer))
+
+                UseBufferPool::Stats after = UseBufferPool::getStats();
+                TESTING_CHECK(after.mHits > before.mHits)
+                TESTING_EQUAL(before.mOutstanding + 1, after.mOutstanding)
+                break;
+              }
+              case 3: {
+                // buffers released on another thread are still recycled
+                UseBufferPool::Stats before = UseBufferPool::getStats();
+
+                const size_t totalBuffers = 100;
+
+                std::thread thread([totalBuffers]() {
+                  std::list<SecureByteBlockPtr> buffers;
+                  for (size_t loop = 0; loop < totalBuffers; ++loop) {
+                    buffers.push_back(UseBufferPool::allocate(9000));
+                  }
+                });
+                thread.join();
+
+                UseBufferPool::Stats after = UseBufferPool::getStats();
+                TESTING_EQUAL(before.mOutstanding, after.mOutstanding)
+                TESTING_CHECK(after.mCached > 0)
+                break;
+              }
+              case 4: {
+                // steady-state packet rate should never reach the allocator
+                const size_t totalIterations = 100000;
+
+                { auto warmup = UseBufferPool::allocate(1500); }
+
+                UseBufferPool::Stats before = UseBufferPool::getStats();
+
+                zsLib::Time start = zsLib::now();
+                for (size_t loop = 0; loop < totalIterations; ++loop) {
+                  auto buffer = UseBufferPool::allocate(1200);
+                  buffer->BytePtr()[0] = static_cast<BYTE>(loop);
+                }
+                zsLib::Time end = zsLib::now();
+
+                UseBufferPool::Stats after = UseBufferPool::getStats();
+
+                TESTING_EQUAL(before.mMisses, after.mMisses)
+                TESTING_EQUAL(before.mHits + totalIterations, after.mHits)
+
+                TESTING_STDOUT() << "BENCHMARK:    buffer pool [" << totalIterations << "] allocations, misses [" << (after.mMisses - before.mMisses) << "], took [" << zsLib::toMilliseconds(end - start).count() << "ms]\n";
+                break;
+              }
+              case 5: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All buffer pool tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -0,0 +1,264 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/MessageQueueThread.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_FlatHashMap.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <map>
+#include <vector>
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::DWORD;
+using zsLib::ULONG;
+using zsLib::ULONGLONG;
+
+typedef std::shared_ptr<DWORD> ValuePtr;
+typedef ortc::internal::FlatHashMap<DWORD, ValuePtr> SSRCFlatMap;
+typedef std::map<DWORD, ValuePtr> SSRCTreeMap;
+
+#define TEST_BASIC_FLAT_HASH_MAP 0
+
+static DWORD nextSSRC(DWORD &ioSeed)
+{
+  // fixed sequence (so runs are comparable) of well spread 32-bit values
+  ioSeed = (ioSeed * 1664525UL) + 1013904223UL;
+  return ioSeed;
+}
+
+static bool sameContents(const SSRCFlatMap &flat, const SSRCTreeMap &tree)
+{
+  if (flat.size() != tree.size()) return false;
+
+  size_t total = 0;
+  for (auto iter = flat.begin(); iter != flat.end(); ++iter, ++total) {
+    auto found = tree.find((*iter).first);
+    if (found == tree.end()) return false;
+    if ((*found).second != (*iter).second) return false;
+  }
+  return total == tree.size();
+}
+
+void doTestFlatHashMap()
+{
+  if (!ORTC_TEST_DO_FLAT_HASH_MAP_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for flat hash map testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_FLAT_HASH_MAP: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_FLAT_HASH_MAP: {
+            switch (step) {
+              case 1: {
+                // basic insert / find / erase
+                SSRCFlatMap flat;
+                TESTING_CHECK(flat.empty())
+                TESTING_CHECK(flat.find(5) == flat.end())
+                TESTING_CHECK(flat.begin() == flat.end())
+
+                flat[5] = std::make_shared<DWORD>(5);
+                flat[0] = std::make_shared<DWORD>(0);
+                flat[0xFFFFFFFF] = std::make_shared<DWORD>(0xFFFFFFFF);
+
+                TESTING_EQUAL(3, flat.size())
+                TESTING_CHECK(flat.find(5) != flat.end())
+                TESTING_EQUAL(5, *((*flat.find(5)).second))
+                TESTING_EQUAL(0xFFFFFFFF, *((*flat.find(0xFFFFFFFF)).second))
+
+                ValuePtr released = (*flat.find(0)).second;
+                flat.erase(flat.find(0));
+                TESTING_EQUAL(2, flat.size())
+                TESTING_CHECK(flat.find(0) == flat.end())
+                TESTING_EQUAL(1, released.use_count())      // erased values are released immediately
+
+                TESTING_EQUAL(1, flat.erase(5))
+                TESTING_EQUAL(0, flat.erase(5))
+                TESTING_EQUAL(1, flat.size())
+
+                flat.clear();
+                TESTING_CHECK(flat.empty())
+                TESTING_CHECK(flat.find(0xFFFFFFFF) == flat.end())
+                break;
+              }
+              case 2: {
+                // randomized comparison against std::map including erasing while iterating
+                SSRCFlatMap flat;
+                SSRCTreeMap tree;
+
+                DWORD seed = 7;
+                for (size_t loop = 0; loop < 20000; ++loop) {
+                  DWORD ssrc = nextSSRC(seed) % 4096;   // small key space forces collisions and re-use of erased slots
+                  switch (loop % 3) {
+                    case 0:
+                    case 1: {
+                      auto value = std::make_shared<DWORD>(ssrc);
+                      flat[ssrc] = value;
+                      tree[ssrc] = value;
+                      break;
+                    }
+                    default: {
+                      TESTING_EQUAL(tree.erase(ssrc), flat.erase(ssrc))
+                      break;
+                    }
+                  }
+                }
+
+                TESTING_CHECK(sameContents(flat, tree))
+
+                for (auto iter_doNotUse = flat.begin(); iter_doNotUse != flat.end(); ) {
+                  auto current = iter_doNotUse;
+                  ++iter_doNotUse;
+
+                  if (0 != ((*current).first % 2)) continue;
+                  tree.erase((*current).first);
+                  flat.erase(current);
+                }
+
+                TESTING_CHECK(sameContents(flat, tree))
+
+                SSRCFlatMap copy(flat);
+                TESTING_CHECK(sameContents(copy, tree))
+                break;
+              }
+              case 3: {
+                // SSRC routing lookups should not get slower as SSRCs are added
+                static const size_t kTotalLookups = 1000000;
+                static const size_t kSSRCCounts[] = {10, 100, 1000, 10000, 0};
+
+                for (size_t index = 0; 0 != kSSRCCounts[index]; ++index) {
+                  size_t totalSSRCs = kSSRCCounts[index];
+
+                  SSRCFlatMap flat;
+                  SSRCTreeMap tree;
+                  std::vector<DWORD> ssrcs;
+
+                  DWORD seed = static_cast<DWORD>(totalSSRCs);
+                  for (size_t loop = 0; loop < totalSSRCs; ++loop) {
+                    DWORD ssrc = nextSSRC(seed);
+                    auto value = std::make_shared<DWORD>(ssrc);
+                    flat[ssrc] = value;
+                    tree[ssrc] = value;
+                    ssrcs.push_back(ssrc);
+                  }
+
+                  // packets arrive interleaved across all streams
+                  std::vector<DWORD> lookups;
+                  lookups.reserve(kTotalLookups);
+                  for (size_t loop = 0; loop < kTotalLookups; ++loop) {
+                    lookups.push_back(ssrcs[nextSSRC(seed) % ssrcs.size()]);
+                  }
+
+                  ULONGLONG found = 0;
+
+                  zsLib::Time start = zsLib::now();
+                  for (auto iter = lookups.begin(); iter != lookups.end(); ++iter) {
+                    auto result = tree.find(*iter);
+                    if (result != tree.end()) found += *((*result).second);
+                  }
+                  zsLib::Time middle = zsLib::now();
+                  for (auto iter = lookups.begin(); iter != lookups.end(); ++iter) {
+                    auto result = flat.find(*iter);
+                    if (result != flat.end()) found -= *((*result).second);
+                  }
+                  zsLib::Time end = zsLib::now();
+
+                  TESTING_EQUAL(0, found)
+
+                  TESTING_STDOUT() << "BENCHMARK:    [" << totalSSRCs << "] SSRCs, [" << kTotalLookups << "] lookups, std::map took [" << zsLib::toMilliseconds(middle - start).count() << "ms], flat hash map took [" << zsLib::toMilliseconds(end - middle).count() << "ms] (capacity " << flat.capacity() << ")\n";
+                }
+                break;
+              }
+              case 4: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All flat hash map tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -0,0 +1,288 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_ICEGathererRouter.h>
+
+#include "config.h"
+#include "testing.h"
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::ULONG;
+using zsLib::IPAddress;
+using zsLib::AutoRecursiveLock;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace gatherer_router
+    {
+      ZS_DECLARE_CLASS_PTR(RouterTester)
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RouterTester
+      #pragma mark
+
+      // router without a cleanup timer; pruning is driven by the test
+      class RouterTester : public ortc::internal::ICEGathererRouter
+      {
+      public:
+        RouterTester() : ICEGathererRouter(make_private {}, IMessageQueuePtr()) {}
+
+        //---------------------------------------------------------------------
+        static RouterTesterPtr create()
+        {
+          RouterTesterPtr pThis(make_shared<RouterTester>());
+          pThis->mThisWeak = pThis;
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        void prune()
+        {
+          onTimer(zsLib::TimerPtr());
+        }
+
+        //---------------------------------------------------------------------
+        size_t totalRouteSlots() const
+        {
+          AutoRecursiveLock lock(*this);
+          return mRoutes.size();
+        }
+
+        //---------------------------------------------------------------------
+        size_t totalLocalCandidateIDs() const
+        {
+          AutoRecursiveLock lock(*this);
+          return mLocalCandidateIDs.size();
+        }
+      };
+
+      //-----------------------------------------------------------------------
+      static IICETypes::CandidatePtr createCandidate(
+                                                     const char *ip,
+                                                     WORD port
+                                                     )
+      {
+        IICETypes::CandidatePtr candidate(make_shared<IICETypes::Candidate>());
+        candidate->mInterfaceType = "lan";
+        candidate->mFoundation = String(ip) + ":" + string(port);
+        candidate->mPriority = 1;
+        candidate->mIP = ip;
+        candidate->mPort = port;
+        return candidate;
+      }
+    }
+  }
+}
+
+ZS_DECLARE_USING_PTR(ortc::test::gatherer_router, RouterTester)
+ZS_DECLARE_TYPEDEF_PTR(ortc::internal::ICEGathererRouter::Route, Route)
+ZS_DECLARE_TYPEDEF_PTR(ortc::IICETypes::Candidate, Candidate)
+
+using ortc::test::gatherer_router::createCandidate;
+
+#define TEST_BASIC_GATHERER_ROUTER 0
+
+void doTestICEGathererRouter()
+{
+  if (!ORTC_TEST_DO_ICE_GATHERER_ROUTER_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for ICE gatherer router testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      RouterTesterPtr router;
+
+      CandidatePtr candidate1 = createCandidate("192.168.1.10", 5000);
+      CandidatePtr candidate2 = createCandidate("192.168.1.11", 5000);
+      CandidatePtr candidate3 = createCandidate("192.168.1.12", 5000);
+
+      IPAddress remoteIP1("10.0.0.1", 6000);
+      IPAddress remoteIP2("10.0.0.1", 6001);
+
+      RoutePtr route1;
+      RoutePtr route2;
+      RoutePtr route3;
+
+      ortc::internal::ICEGathererRouter::LocalCandidateID candidate1ID {};
+      zsLib::PUID route1ID {};
+
+      switch (testNumber) {
+        case TEST_BASIC_GATHERER_ROUTER: {
+          router = RouterTester::create();
+          TESTING_CHECK(router)
+          break;
+        }
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_GATHERER_ROUTER: {
+            switch (step) {
+              case 1: {
+                // a route is only created on request and is found again
+                TESTING_CHECK(!router->findRoute(candidate1, remoteIP1, false))
+
+                route1 = router->findRoute(candidate1, remoteIP1, true);
+                TESTING_CHECK(route1)
+                TESTING_CHECK(0 != route1->mLocalCandidateID)
+                TESTING_CHECK(route1 == router->findRoute(candidate1, remoteIP1, false))
+                TESTING_CHECK(route1 == router->findRoute(createCandidate("192.168.1.10", 5000), remoteIP1, false))
+
+                candidate1ID = route1->mLocalCandidateID;
+                route1ID = route1->mID;
+
+                // same candidate to another remote port is another route
+                // sharing the candidate's ID
+                route2 = router->findRoute(candidate1, remoteIP2, true);
+                TESTING_CHECK(route2)
+                TESTING_CHECK(route2 != route1)
+                TESTING_EQUAL(route2->mLocalCandidateID, candidate1ID)
+
+                // another candidate gets its own ID
+                route3 = router->findRoute(candidate2, remoteIP1, true);
+                TESTING_CHECK(route3)
+                TESTING_CHECK(route3 != route1)
+                TESTING_CHECK(route3->mLocalCandidateID != candidate1ID)
+                break;
+              }
+              case 2: {
+                // a removed route is never handed out again; the slot is
+                // cleaned and a fresh route is created in its place
+                route1.reset();
+                TESTING_CHECK(!router->findRoute(candidate1, remoteIP1, false))
+
+                route1 = router->findRoute(candidate1, remoteIP1, true);
+                TESTING_CHECK(route1)
+                TESTING_CHECK(route1->mID != route1ID)
+                TESTING_EQUAL(route1->mLocalCandidateID, candidate1ID)   // candidate still has live routes
+                TESTING_CHECK(route2 == router->findRoute(candidate1, remoteIP2, false))
+                break;
+              }
+              case 3: {
+                // once every route of a candidate is gone the prune drops
+                // both its route slots and its ID
+                route1.reset();
+                route2.reset();
+
+                TESTING_EQUAL(router->totalLocalCandidateIDs(), 2)
+                router->prune();
+                TESTING_EQUAL(router->totalLocalCandidateIDs(), 1)
+                TESTING_EQUAL(router->totalRouteSlots(), 1)
+
+                // live routes survive the prune untouched
+                TESTING_CHECK(route3 == router->findRoute(candidate2, remoteIP1, false))
+                break;
+              }
+              case 4: {
+                // a pruned ID is never reused by a new candidate nor by the
+                // same candidate returning
+                route2 = router->findRoute(candidate3, remoteIP1, true);
+                TESTING_CHECK(route2)
+                TESTING_CHECK(route2->mLocalCandidateID != candidate1ID)
+                TESTING_CHECK(route2->mLocalCandidateID != route3->mLocalCandidateID)
+
+                route1 = router->findRoute(candidate1, remoteIP1, true);
+                TESTING_CHECK(route1)
+                TESTING_CHECK(route1->mLocalCandidateID != candidate1ID)
+                TESTING_CHECK(route1->mID != route1ID)
+                TESTING_CHECK(route1 != route2)
+                TESTING_CHECK(route1 != route3)
+
+                TESTING_CHECK(route1 == router->findRoute(candidate1, remoteIP1, false))
+                TESTING_CHECK(route2 == router->findRoute(candidate3, remoteIP1, false))
+                TESTING_CHECK(!router->findRoute(candidate1, remoteIP2, false))
+                break;
+              }
+              case 5: {
+                route1.reset();
+                route2.reset();
+                route3.reset();
+                router.reset();
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All ICE gatherer router tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -0,0 +1,401 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/MessageQueueThread.h>
+#include <zsLib/Socket.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_ICESharedPort.h>
+#include <ortc/internal/ortc_ICEGatherer.h>
+
+#include <openpeer/services/ISettings.h>
+#include <openpeer/services/STUNPacket.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <cstring>
+#include <list>
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::BYTE;
+using zsLib::ULONG;
+using zsLib::PUID;
+using zsLib::String;
+using zsLib::IPAddress;
+using zsLib::Socket;
+using zsLib::SocketPtr;
+using zsLib::Lock;
+using zsLib::AutoLock;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace ice_shared_port
+    {
+      ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+      ZS_DECLARE_TYPEDEF_PTR(openpeer::services::STUNPacket, STUNPacket)
+      ZS_DECLARE_TYPEDEF_PTR(ortc::internal::ICESharedPort, ICESharedPort)
+      ZS_DECLARE_TYPEDEF_PTR(ortc::internal::IICEGathererForICESharedPort, IICEGathererForICESharedPort)
+
+      typedef ortc::internal::UDPBatchReceiver UDPBatchReceiver;
+
+      ZS_DECLARE_CLASS_PTR(FakeGatherer)
+
+      //-----------------------------------------------------------------------
+      // records which remote each datagram routed to the gatherer came from
+      class FakeGatherer : public IICEGathererForICESharedPort
+      {
+      public:
+        static FakeGathererPtr create() {return std::make_shared<FakeGatherer>();}
+
+        virtual PUID getID() const override {return mID;}
+
+        virtual void notifySharedUDPDatagrams(
+                                              SocketPtr socket,
+                                              UDPBatchReceiver::DatagramList &datagrams
+                                              ) override
+        {
+          AutoLock lock(mLock);
+          for (auto iter = datagrams.begin(); iter != datagrams.end(); ++iter) {
+            mReceivedFrom.push_back((*iter).mFromIP);
+          }
+        }
+
+        virtual void notifySharedTCPConnection(
+                                               SocketPtr listenSocket,
+                                               SocketPtr socket,
+                                               const IPAddress &remoteIP
+                                               ) override
+        {
+          socket->close();
+        }
+
+        size_t received(const IPAddress &fromIP) const
+        {
+          AutoLock lock(mLock);
+          size_t total = 0;
+          for (auto iter = mReceivedFrom.begin(); iter != mReceivedFrom.end(); ++iter) {
+            if ((*iter) == fromIP) ++total;
+          }
+          return total;
+        }
+
+      protected:
+        zsLib::AutoPUID mID;
+        mutable Lock mLock;
+        std::list<IPAddress> mReceivedFrom;
+      };
+
+      //-----------------------------------------------------------------------
+      static SocketPtr createLoopbackSocket()
+      {
+        SocketPtr socket = Socket::createUDP(Socket::Create::IPv4);
+        socket->bind(IPAddress("127.0.0.1", 0));
+        socket->setBlocking(false);
+        return socket;
+      }
+
+      //-----------------------------------------------------------------------
+      static void sendBindingRequest(
+                                     SocketPtr from,
+                                     const IPAddress &to,
+                                     const char *usernameFrag
+                                     )
+      {
+        auto request = STUNPacket::createRequest(STUNPacket::Method_Binding);
+        request->mUsername = String(usernameFrag) + ":remote";
+        auto packet = request->packetize(STUNPacket::RFC_5245_ICE);
+
+        bool wouldBlock = false;
+        from->sendTo(to, packet->BytePtr(), packet->SizeInBytes(), &wouldBlock);
+      }
+
+      //-----------------------------------------------------------------------
+      static void sendData(
+                           SocketPtr from,
+                           const IPAddress &to
+                           )
+      {
+        BYTE buffer[100] {};
+        buffer[0] = 0x80;   // RTP (never accepted from an unknown remote)
+        buffer[1] = 96;
+
+        bool wouldBlock = false;
+        from->sendTo(to, &(buffer[0]), sizeof(buffer), &wouldBlock);
+      }
+
+      //-----------------------------------------------------------------------
+      // RETURNS: true if the gatherer received "expecting" datagrams from the
+      //          remote (false if nothing more arrived in time)
+      static bool waitFor(
+                          FakeGathererPtr gatherer,
+                          const IPAddress &fromIP,
+                          size_t expecting
+                          )
+      {
+        zsLib::Time giveUp = zsLib::now() + zsLib::Seconds(2);
+        while (zsLib::now() < giveUp) {
+          size_t received = gatherer->received(fromIP);
+          if (received >= expecting) return received == expecting;
+          TESTING_SLEEP(10)
+        }
+        return false;
+      }
+
+      //-----------------------------------------------------------------------
+      // RETURNS: true if nothing more from the remote reached either gatherer
+      static bool expectDropped(
+                                FakeGathererPtr first,
+                                FakeGathererPtr second,
+                                const IPAddress &fromIP
+                                )
+      {
+        size_t firstBefore = first->received(fromIP);
+        size_t secondBefore = second->received(fromIP);
+        TESTING_SLEEP(250)
+        return (first->received(fromIP) == firstBefore) &&
+               (second->received(fromIP) == secondBefore);
+      }
+    }
+  }
+}
+
+using namespace ortc::test::ice_shared_port;
+
+#define TEST_BASIC_ICE_SHARED_PORT 0
+
+void doTestICESharedPort()
+{
+  if (!ORTC_TEST_DO_ICE_SHARED_PORT_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  // the shared port reads its settings once (when first used)
+  UseSettings::setUInt(ORTC_SETTING_ICE_SHARED_PORT_PORT, 40000 + (rand() % 10000));
+  UseSettings::setUInt(ORTC_SETTING_ICE_SHARED_PORT_MAX_ROUTES, 2);
+  UseSettings::setUInt(ORTC_SETTING_ICE_SHARED_PORT_LEARNED_ROUTE_TIMEOUT_IN_SECONDS, 1);
+
+  TESTING_STDOUT() << "WAITING:      Waiting for ICE shared port testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    FakeGathererPtr gathererA = FakeGatherer::create();
+    FakeGathererPtr gathererB = FakeGatherer::create();
+
+    SocketPtr shared;
+    IPAddress sharedIP;
+
+    SocketPtr remote1 = createLoopbackSocket();
+    SocketPtr remote2 = createLoopbackSocket();
+    SocketPtr remote3 = createLoopbackSocket();
+
+    IPAddress remote1IP = remote1->getLocalAddress();
+    IPAddress remote2IP = remote2->getLocalAddress();
+    IPAddress remote3IP = remote3->getLocalAddress();
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_ICE_SHARED_PORT: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_ICE_SHARED_PORT: {
+            switch (step) {
+              case 1: {
+                // binding requests are demultiplexed by username fragment;
+                // nothing else is accepted from an unknown remote
+                TESTING_CHECK(ICESharedPort::registerUsernameFrag(gathererA, "ufragA"))
+                TESTING_CHECK(ICESharedPort::registerUsernameFrag(gathererB, "ufragB"))
+                TESTING_CHECK(!ICESharedPort::registerUsernameFrag(gathererB, "ufragA"))
+
+                sharedIP = IPAddress("127.0.0.1", 0);
+                shared = ICESharedPort::attach(gathererA, sharedIP, ortc::IICETypes::Protocol_UDP);
+                TESTING_CHECK(shared)
+
+                IPAddress otherIP("127.0.0.1", 0);
+                TESTING_CHECK(shared == ICESharedPort::attach(gathererB, otherIP, ortc::IICETypes::Protocol_UDP))
+                TESTING_CHECK(sharedIP == otherIP)
+
+                sendBindingRequest(remote1, sharedIP, "ufragA");
+                TESTING_CHECK(waitFor(gathererA, remote1IP, 1))
+                TESTING_EQUAL(0, gathererB->received(remote1IP))
+
+                sendBindingRequest(remote1, sharedIP, "ufragB");
+                TESTING_CHECK(waitFor(gathererB, remote1IP, 1))
+                TESTING_EQUAL(1, gathererA->received(remote1IP))
+
+                sendBindingRequest(remote1, sharedIP, "unknown");
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(expectDropped(gathererA, gathererB, remote1IP))
+                break;
+              }
+              case 2: {
+                // a route is only learned once a gatherer confirms the request
+                // passed its integrity check and a failed check forgets it
+                ICESharedPort::rejectRoute(shared, remote1IP, gathererA->getID());
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(expectDropped(gathererA, gathererB, remote1IP))
+
+                ICESharedPort::confirmRoute(shared, remote1IP, gathererA);
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(waitFor(gathererA, remote1IP, 2))
+
+                // a learned route never captures another gatherer's requests
+                sendBindingRequest(remote1, sharedIP, "ufragB");
+                TESTING_CHECK(waitFor(gathererB, remote1IP, 2))
+                TESTING_EQUAL(2, gathererA->received(remote1IP))
+
+                // ...nor does another gatherer's failed check drop it
+                ICESharedPort::rejectRoute(shared, remote1IP, gathererB->getID());
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(waitFor(gathererA, remote1IP, 3))
+
+                // a spoofed request failing the owner's check forgets the route
+                ICESharedPort::rejectRoute(shared, remote1IP, gathererA->getID());
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(expectDropped(gathererA, gathererB, remote1IP))
+
+                // the next validated request learns the replacement route
+                ICESharedPort::confirmRoute(shared, remote1IP, gathererB);
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(waitFor(gathererB, remote1IP, 3))
+
+                ICESharedPort::confirmRoute(shared, remote1IP, gathererA);
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(waitFor(gathererA, remote1IP, 4))
+                TESTING_EQUAL(3, gathererB->received(remote1IP))
+
+                // a gatherer's own route is never replaced or dropped by a
+                // learned one
+                ICESharedPort::addRoute(shared, remote2IP, gathererB);
+                ICESharedPort::confirmRoute(shared, remote2IP, gathererA);
+                ICESharedPort::rejectRoute(shared, remote2IP, gathererB->getID());
+                sendData(remote2, sharedIP);
+                TESTING_CHECK(waitFor(gathererB, remote2IP, 1))
+                TESTING_EQUAL(0, gathererA->received(remote2IP))
+
+                ICESharedPort::removeRoute(shared, remote2IP, gathererB->getID());
+                sendData(remote2, sharedIP);
+                TESTING_CHECK(expectDropped(gathererA, gathererB, remote2IP))
+                break;
+              }
+              case 3: {
+                // a full cache evicts the least recently used learned route
+                // and unused learned routes expire
+                ICESharedPort::confirmRoute(shared, remote1IP, gathererA);
+                TESTING_SLEEP(10)
+                ICESharedPort::confirmRoute(shared, remote2IP, gathererA);
+                TESTING_SLEEP(10)
+                ICESharedPort::confirmRoute(shared, remote3IP, gathererA);
+
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(expectDropped(gathererA, gathererB, remote1IP))
+
+                sendData(remote2, sharedIP);
+                TESTING_CHECK(waitFor(gathererA, remote2IP, 1))
+                sendData(remote3, sharedIP);
+                TESTING_CHECK(waitFor(gathererA, remote3IP, 1))
+
+                TESTING_SLEEP(1500)
+
+                sendData(remote2, sharedIP);
+                TESTING_CHECK(expectDropped(gathererA, gathererB, remote2IP))
+                sendData(remote3, sharedIP);
+                TESTING_CHECK(expectDropped(gathererA, gathererB, remote3IP))
+
+                // referenced routes do not age
+                ICESharedPort::addRoute(shared, remote1IP, gathererB);
+                TESTING_SLEEP(1500)
+                sendData(remote1, sharedIP);
+                TESTING_CHECK(waitFor(gathererB, remote1IP, 4))
+                ICESharedPort::removeRoute(shared, remote1IP, gathererB->getID());
+                break;
+              }
+              case 4: {
+                ICESharedPort::detach(gathererA->getID(), shared);
+                ICESharedPort::detach(gathererB->getID(), shared);
+                ICESharedPort::unregisterUsernameFrag(gathererA->getID(), "ufragA");
+                ICESharedPort::unregisterUsernameFrag(gathererB->getID(), "ufragB");
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All ICE shared port tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -65,6 +65,33 @@ namespace ortc
       ZS_DECLARE_CLASS_PTR(ICEGathererTester)
       ZS_DECLARE_CLASS_PTR(ICETransportTester)
 
+      //-----------------------------------------------------------------------
+      static ElementPtr findDebugElement(
+                                         ElementPtr debugEl,
+                                         const char *name
+                                         )
+      {
+        if (!debugEl) return ElementPtr();
+
+        for (ElementPtr childEl = debugEl->findFirstChildElement(); childEl; childEl = childEl->findNextSiblingElement()) {
+          if (childEl->getValue() == name) return childEl;
+          ElementPtr foundEl = findDebugElement(childEl, name);
+          if (foundEl) return foundEl;
+        }
+        return ElementPtr();
+      }
+
+      //-----------------------------------------------------------------------
+      static String getDebugValue(
+                                  ElementPtr debugEl,
+                                  const char *name
+                                  )
+      {
+        ElementPtr foundEl = findDebugElement(debugEl, name);
+        if (!foundEl) return String();
+        return UseServicesHelper::getElementText(foundEl);
+      }
+
       class ICEGathererTester : public SharedRecursiveLock,
                                 public zsLib::MessageQueueAssociator,
                                 public IICEGathererDelegate
@@ -445,6 +472,13 @@ namespace ortc
         //-----------------------------------------------------------------------
         Expectations getExpectations() const {return mExpectations;}
 
+        //-----------------------------------------------------------------------
+        ElementPtr getDebug() const
+        {
+          AutoRecursiveLock lock(*this);
+          return IICETransport::toDebug(mTransport);
+        }
+
         //-----------------------------------------------------------------------
         void setRemote(ICEGathererTesterPtr remoteGathererTester)
         {
@@ -632,6 +666,9 @@ namespace ortc
 ZS_DECLARE_USING_PTR(ortc::test::transport, ICEGathererTester)
 ZS_DECLARE_USING_PTR(ortc::test::transport, ICETransportTester)
 
+using ortc::test::transport::findDebugElement;
+using ortc::test::transport::getDebugValue;
+
 
 void doTestICETransport()
 {
@@ -736,6 +773,34 @@ void doTestICETransport()
             testTransportObject2 = ICETransportTester::create(thread, testGathererObject2);
           }
 
+          testTransportObject1->setRemote(testGathererObject2);
+          testTransportObject2->setRemote(testGathererObject1);
+          break;
+        }
+        case 1: {
+          {
+            testGathererObject1 = ICEGathererTester::create(thread);
+            testTransportObject1 = ICETransportTester::create(thread, testGathererObject1);
+          }
+          {
+            // an ice lite gatherer must ignore its stun server and only
+            // ever offer host candidates
+            String url = String("stun:") + ORTC_TEST_STUN_SERVER;
+
+            ortc::IICEGatherer::Server server;
+            server.mURLs.push_back(url);
+            ortc::IICEGatherer::Options options;
+            options.mICELite = true;
+            options.mICEServers.push_back(server);
+
+            testGathererObject2 = ICEGathererTester::create(thread, options);
+            testTransportObject2 = ICETransportTester::create(thread, testGathererObject2);
+          }
+
+          // host gathering is complete long before the lite transport is
+          // started thus a nominated route goes straight to completed
+          expectationsTransport2.mStateConnected = 0;
+
           testTransportObject1->setRemote(testGathererObject2);
           testTransportObject2->setRemote(testGathererObject1);
           break;
@@ -833,13 +898,52 @@ void doTestICETransport()
             break;
           }
           case 1: {
-            if (7 == totalWait) {
-              if (testGathererObject1) testGathererObject1->close();
-              if (testGathererObject2) testGathererObject2->close();
+            if (5 == totalWait) {
+              ortc::IICETransportTypes::Options options1;
+              ortc::IICETransportTypes::Options options2;
+
+              // the lite agent must refuse the controlling role it was given
+              options1.mRole = ortc::IICETypes::Role_Controlling;
+              options2.mRole = ortc::IICETypes::Role_Controlling;
+
+              testTransportObject1->start(options1);
+              testTransportObject2->start(options2);
+            }
+            if (40 == totalWait) {
+              auto fullParams = testGathererObject1->getGatherer()->getLocalParameters();
+              auto liteParams = testGathererObject2->getGatherer()->getLocalParameters();
+              TESTING_CHECK(fullParams)
+              TESTING_CHECK(liteParams)
+              if ((fullParams) && (liteParams)) {
+                TESTING_CHECK(!fullParams->mICELite)
+                TESTING_CHECK(liteParams->mICELite)
+              }
+
+              // the lite side answers checks but never sends any of its own
+              ElementPtr liteEl = testTransportObject2->getDebug();
+              TESTING_CHECK(liteEl)
+              TESTING_EQUAL(getDebugValue(liteEl, "ice lite"), String("true"))
+              TESTING_EQUAL(getDebugValue(liteEl, "role"), String(ortc::IICETypes::toString(ortc::IICETypes::Role_Controlled)))
+              TESTING_CHECK(getDebugValue(liteEl, "outgoing checks").isEmpty())
+              TESTING_CHECK(getDebugValue(liteEl, "legal routes").isEmpty())
+              TESTING_CHECK(getDebugValue(liteEl, "keep warm timer").isEmpty())
+              TESTING_CHECK(getDebugValue(liteEl, "last received packet timer").isEmpty())
+              TESTING_CHECK(getDebugValue(liteEl, "last sent check").isEmpty())
+              TESTING_CHECK(findDebugElement(liteEl, "active route"))
+              TESTING_CHECK(getDebugValue(liteEl, "last received use candidate").hasData())
+
+              // the full agent did all the checking and the nomination
+              ElementPtr fullEl = testTransportObject1->getDebug();
+              TESTING_CHECK(fullEl)
+              TESTING_CHECK(getDebugValue(fullEl, "ice lite").isEmpty())
+              TESTING_CHECK(getDebugValue(fullEl, "last sent check").hasData())
+            }
+            if (50 == totalWait) {
               if (testTransportObject1) testTransportObject1->close();
               if (testTransportObject2) testTransportObject2->close();
+              if (testGathererObject1) testGathererObject1->close();
+              if (testGathererObject2) testGathererObject2->close();
             }
-
             break;
           }
           case 2: {
@@ -0,0 +1,532 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_NetworkMonitor.h>
+#include <ortc/internal/platform.h>
+
+#include <openpeer/services/ISettings.h>
+
+#ifdef HAVE_RTNETLINK
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <string.h>
+#endif //HAVE_RTNETLINK
+
+#include "config.h"
+#include "testing.h"
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::BYTE;
+using zsLib::WORD;
+using zsLib::DWORD;
+using zsLib::ULONG;
+using zsLib::String;
+using zsLib::IPAddress;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace network_monitor
+    {
+      ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+
+#ifdef HAVE_RTNETLINK
+      //-----------------------------------------------------------------------
+      // feeds crafted kernel messages straight into the monitor's parser
+      // (no rtnetlink socket or monitor thread is involved)
+      class Tester : public ortc::internal::NetworkMonitor
+      {
+      public:
+        typedef NetworkMonitor::AddressMap AddressMap;
+        typedef NetworkMonitor::InterfaceIndexSet InterfaceIndexSet;
+
+        Tester() : NetworkMonitor(make_private{}) {}
+
+        void setSequence(DWORD sequence) {mSequence = sequence;}
+
+        void process(
+                     const BYTE *buffer,
+                     size_t length,
+                     bool &outDumpDone,
+                     bool &outChanged
+                     )
+        {
+          outDumpDone = false;
+          outChanged = false;
+          NetworkMonitor::process(buffer, length, mTestAddresses, mTestDownInterfaces, outDumpDone, outChanged);
+        }
+
+        const Address *find(
+                            ULONG interfaceIndex,
+                            const char *ip
+                            ) const
+        {
+          auto found = mTestAddresses.find(AddressKey(interfaceIndex, IPAddress(ip).string(false)));
+          if (found == mTestAddresses.end()) return NULL;
+          return &((*found).second);
+        }
+
+        AddressMap mTestAddresses;
+        InterfaceIndexSet mTestDownInterfaces;
+      };
+
+      //-----------------------------------------------------------------------
+      // appends netlink messages (with their route attributes) the same way
+      // the kernel lays them out in a datagram
+      class MessageBuilder
+      {
+      public:
+        void begin(
+                   WORD type,
+                   DWORD sequence
+                   )
+        {
+          mHeader = reinterpret_cast<nlmsghdr *>(&(mBuffer[mLength]));
+          memset(mHeader, 0, sizeof(nlmsghdr));
+          mHeader->nlmsg_len = NLMSG_LENGTH(0);
+          mHeader->nlmsg_type = type;
+          mHeader->nlmsg_seq = sequence;
+        }
+
+        void append(
+                    const void *data,
+                    size_t size
+                    )
+        {
+          BYTE *pos = reinterpret_cast<BYTE *>(mHeader) + NLMSG_ALIGN(mHeader->nlmsg_len);
+          memcpy(pos, data, size);
+          mHeader->nlmsg_len = NLMSG_ALIGN(mHeader->nlmsg_len) + static_cast<DWORD>(size);
+        }
+
+        void addAttribute(
+                          WORD type,
+                          const void *data,
+                          size_t size
+                          )
+        {
+          BYTE attribute[RTA_SPACE(64)] {};
+          auto header = reinterpret_cast<rtattr *>(&(attribute[0]));
+          header->rta_type = type;
+          header->rta_len = static_cast<WORD>(RTA_LENGTH(size));
+          memcpy(RTA_DATA(header), data, size);
+          append(&(attribute[0]), RTA_LENGTH(size));
+        }
+
+        void end()
+        {
+          mLength += NLMSG_ALIGN(mHeader->nlmsg_len);
+          mHeader = NULL;
+        }
+
+        const BYTE *ptr() const {return &(mBuffer[0]);}
+        size_t size() const {return mLength;}
+
+      protected:
+        alignas(nlmsghdr) BYTE mBuffer[4096] {};
+        size_t mLength {};
+        nlmsghdr *mHeader {};
+      };
+
+      //-----------------------------------------------------------------------
+      static void addAddress(
+                             MessageBuilder &builder,
+                             WORD type,
+                             ULONG interfaceIndex,
+                             const char *ip,
+                             DWORD flags,
+                             const char *label
+                             )
+      {
+        ifaddrmsg info;
+        memset(&info, 0, sizeof(info));
+        info.ifa_index = interfaceIndex;
+        info.ifa_flags = static_cast<BYTE>(flags & 0xFF);
+
+        in6_addr address6;
+        in_addr address4;
+        bool isIPv6 = (NULL != strchr(ip, ':'));
+
+        info.ifa_family = static_cast<BYTE>(isIPv6 ? AF_INET6 : AF_INET);
+        info.ifa_prefixlen = static_cast<BYTE>(isIPv6 ? 64 : 24);
+
+        builder.begin(type, 0);
+        builder.append(&info, sizeof(info));
+        if (isIPv6) {
+          inet_pton(AF_INET6, ip, &address6);
+          builder.addAttribute(IFA_ADDRESS, &address6, sizeof(address6));
+        } else {
+          inet_pton(AF_INET, ip, &address4);
+          builder.addAttribute(IFA_LOCAL, &address4, sizeof(address4));
+          builder.addAttribute(IFA_ADDRESS, &address4, sizeof(address4));
+        }
+        if (label) builder.addAttribute(IFA_LABEL, label, strlen(label) + 1);
+#ifdef IFA_FLAGS
+        builder.addAttribute(IFA_FLAGS, &flags, sizeof(flags));
+#endif //IFA_FLAGS
+        builder.end();
+      }
+
+      //-----------------------------------------------------------------------
+      static void addLink(
+                          MessageBuilder &builder,
+                          WORD type,
+                          ULONG interfaceIndex,
+                          unsigned int flags
+                          )
+      {
+        ifinfomsg info;
+        memset(&info, 0, sizeof(info));
+        info.ifi_family = AF_UNSPEC;
+        info.ifi_index = static_cast<int>(interfaceIndex);
+        info.ifi_flags = flags;
+
+        builder.begin(type, 0);
+        builder.append(&info, sizeof(info));
+        builder.end();
+      }
+
+      //-----------------------------------------------------------------------
+      static void addDone(
+                          MessageBuilder &builder,
+                          DWORD sequence
+                          )
+      {
+        int result = 0;
+        builder.begin(NLMSG_DONE, sequence);
+        builder.append(&result, sizeof(result));
+        builder.end();
+      }
+
+      //-----------------------------------------------------------------------
+      static void addError(
+                           MessageBuilder &builder,
+                           DWORD sequence,
+                           int error
+                           )
+      {
+        nlmsgerr result;
+        memset(&result, 0, sizeof(result));
+        result.error = -error;
+        builder.begin(NLMSG_ERROR, sequence);
+        builder.append(&result, sizeof(result));
+        builder.end();
+      }
+#endif //HAVE_RTNETLINK
+    }
+  }
+}
+
+using namespace ortc::test::network_monitor;
+
+#define TEST_BASIC_NETWORK_MONITOR 0
+
+void doTestNetworkMonitor()
+{
+  if (!ORTC_TEST_DO_NETWORK_MONITOR_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for network monitor testing to complete.\n";
+
+#ifdef HAVE_RTNETLINK
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    Tester monitor;
+    monitor.setSequence(42);
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_NETWORK_MONITOR: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        bool dumpDone = false;
+        bool changed = false;
+
+        switch (testNumber) {
+          case TEST_BASIC_NETWORK_MONITOR: {
+            switch (step) {
+              case 1: {
+                // new addresses are added once (a repeat is not a change)
+                MessageBuilder builder;
+                addAddress(builder, RTM_NEWADDR, 7, "192.0.2.10", 0, "test0");
+                addAddress(builder, RTM_NEWADDR, 7, "2001:db8::10", IFA_F_TEMPORARY, "test0");
+                monitor.process(builder.ptr(), builder.size(), dumpDone, changed);
+
+                TESTING_CHECK(changed)
+                TESTING_CHECK(!dumpDone)
+                TESTING_EQUAL(2, monitor.mTestAddresses.size())
+
+                auto address = monitor.find(7, "192.0.2.10");
+                TESTING_CHECK(address)
+                if (address) {
+                  TESTING_EQUAL(String("test0"), address->mInterfaceName)
+                  TESTING_EQUAL(7, address->mInterfaceIndex)
+                  TESTING_CHECK(!address->mIsTemporary)
+                }
+
+                address = monitor.find(7, "2001:db8::10");
+                TESTING_CHECK(address)
+                if (address) {
+                  TESTING_CHECK(address->mIsTemporary)
+                }
+
+                monitor.process(builder.ptr(), builder.size(), dumpDone, changed);
+                TESTING_CHECK(!changed)
+                TESTING_EQUAL(2, monitor.mTestAddresses.size())
+                break;
+              }
+              case 2: {
+                // tentative, loopback and wildcard addresses are never reported
+                MessageBuilder builder;
+                addAddress(builder, RTM_NEWADDR, 7, "2001:db8::20", IFA_F_TENTATIVE, "test0");
+                addAddress(builder, RTM_NEWADDR, 1, "127.0.0.1", 0, "lo");
+                addAddress(builder, RTM_NEWADDR, 7, "0.0.0.0", 0, "test0");
+                monitor.process(builder.ptr(), builder.size(), dumpDone, changed);
+
+                TESTING_CHECK(!changed)
+                TESTING_EQUAL(2, monitor.mTestAddresses.size())
+
+                // duplicate address detection completing makes it usable
+                MessageBuilder completed;
+                addAddress(completed, RTM_NEWADDR, 7, "2001:db8::20", 0, "test0");
+                monitor.process(completed.ptr(), completed.size(), dumpDone, changed);
+
+                TESTING_CHECK(changed)
+                TESTING_CHECK(monitor.find(7, "2001:db8::20"))
+                TESTING_EQUAL(3, monitor.mTestAddresses.size())
+                break;
+              }
+              case 3: {
+                // removing an address (or one becoming deprecated) is a change
+                MessageBuilder builder;
+                addAddress(builder, RTM_DELADDR, 7, "2001:db8::20", 0, "test0");
+                monitor.process(builder.ptr(), builder.size(), dumpDone, changed);
+
+                TESTING_CHECK(changed)
+                TESTING_CHECK(!monitor.find(7, "2001:db8::20"))
+
+                MessageBuilder again;
+                addAddress(again, RTM_DELADDR, 7, "2001:db8::20", 0, "test0");
+                monitor.process(again.ptr(), again.size(), dumpDone, changed);
+                TESTING_CHECK(!changed)
+
+                MessageBuilder deprecated;
+                addAddress(deprecated, RTM_NEWADDR, 7, "2001:db8::10", IFA_F_DEPRECATED, "test0");
+                monitor.process(deprecated.ptr(), deprecated.size(), dumpDone, changed);
+                TESTING_CHECK(changed)
+                TESTING_EQUAL(1, monitor.mTestAddresses.size())
+                break;
+              }
+              case 4: {
+                // an interface without carrier is down; it keeps its addresses
+                MessageBuilder builder;
+                addLink(builder, RTM_NEWLINK, 7, IFF_UP);
+                monitor.process(builder.ptr(), builder.size(), dumpDone, changed);
+
+                TESTING_CHECK(changed)
+                TESTING_CHECK(monitor.mTestDownInterfaces.end() != monitor.mTestDownInterfaces.find(7))
+                TESTING_EQUAL(1, monitor.mTestAddresses.size())
+
+                MessageBuilder up;
+                addLink(up, RTM_NEWLINK, 7, IFF_UP | IFF_RUNNING);
+                monitor.process(up.ptr(), up.size(), dumpDone, changed);
+
+                TESTING_CHECK(changed)
+                TESTING_CHECK(monitor.mTestDownInterfaces.empty())
+
+                monitor.process(up.ptr(), up.size(), dumpDone, changed);
+                TESTING_CHECK(!changed)
+
+                // a removed interface takes its addresses with it
+                MessageBuilder other;
+                addAddress(other, RTM_NEWADDR, 9, "198.51.100.1", 0, "test1");
+                monitor.process(other.ptr(), other.size(), dumpDone, changed);
+                TESTING_EQUAL(2, monitor.mTestAddresses.size())
+
+                MessageBuilder removed;
+                addLink(removed, RTM_DELLINK, 7, 0);
+                monitor.process(removed.ptr(), removed.size(), dumpDone, changed);
+
+                TESTING_CHECK(changed)
+                TESTING_EQUAL(1, monitor.mTestAddresses.size())
+                TESTING_CHECK(monitor.find(9, "198.51.100.1"))
+                TESTING_CHECK(monitor.mTestDownInterfaces.empty())
+                break;
+              }
+              case 5: {
+                // only the terminator of the outstanding dump ends the dump
+                MessageBuilder stale;
+                addDone(stale, 41);
+                addError(stale, 40, EBUSY);
+                monitor.process(stale.ptr(), stale.size(), dumpDone, changed);
+                TESTING_CHECK(!dumpDone)
+
+                MessageBuilder done;
+                addAddress(done, RTM_NEWADDR, 9, "198.51.100.2", 0, "test1");
+                addDone(done, 42);
+                monitor.process(done.ptr(), done.size(), dumpDone, changed);
+                TESTING_CHECK(dumpDone)
+                TESTING_CHECK(changed)
+                TESTING_CHECK(monitor.find(9, "198.51.100.2"))
+
+                MessageBuilder error;
+                addError(error, 42, EBUSY);
+                monitor.process(error.ptr(), error.size(), dumpDone, changed);
+                TESTING_CHECK(dumpDone)
+                TESTING_CHECK(!changed)
+                break;
+              }
+              case 6: {
+                // a datagram cut short loses only the message that was cut
+                MessageBuilder builder;
+                addAddress(builder, RTM_NEWADDR, 9, "198.51.100.3", 0, "test1");
+                size_t firstLength = builder.size();
+                addAddress(builder, RTM_NEWADDR, 9, "198.51.100.4", 0, "test1");
+
+                monitor.process(builder.ptr(), builder.size() - 6, dumpDone, changed);
+                TESTING_CHECK(changed)
+                TESTING_CHECK(monitor.find(9, "198.51.100.3"))
+                TESTING_CHECK(!monitor.find(9, "198.51.100.4"))
+
+                // less than a message header is ignored
+                monitor.process(builder.ptr() + firstLength, sizeof(nlmsghdr) - 1, dumpDone, changed);
+                TESTING_CHECK(!changed)
+                TESTING_CHECK(!monitor.find(9, "198.51.100.4"))
+                break;
+              }
+              case 7: {
+                // messages whose own length is too short for their body (or
+                // whose attributes overrun the message) are skipped
+                size_t total = monitor.mTestAddresses.size();
+
+                MessageBuilder shortAddress;
+                shortAddress.begin(RTM_NEWADDR, 0);
+                BYTE partial[2] {AF_INET, 24};
+                shortAddress.append(&(partial[0]), sizeof(partial));
+                shortAddress.end();
+                addDone(shortAddress, 42);
+                monitor.process(shortAddress.ptr(), shortAddress.size(), dumpDone, changed);
+                TESTING_CHECK(!changed)
+                TESTING_CHECK(dumpDone)
+                TESTING_EQUAL(total, monitor.mTestAddresses.size())
+
+                MessageBuilder shortLink;
+                shortLink.begin(RTM_DELLINK, 0);
+                int index = 9;
+                shortLink.append(&index, sizeof(index));
+                shortLink.end();
+                monitor.process(shortLink.ptr(), shortLink.size(), dumpDone, changed);
+                TESTING_CHECK(!changed)
+                TESTING_EQUAL(total, monitor.mTestAddresses.size())
+
+                MessageBuilder shortError;
+                shortError.begin(NLMSG_ERROR, 42);
+                shortError.append(&index, sizeof(index));
+                shortError.end();
+                monitor.process(shortError.ptr(), shortError.size(), dumpDone, changed);
+                TESTING_CHECK(dumpDone)
+
+                MessageBuilder shortAttribute;
+                {
+                  ifaddrmsg info;
+                  memset(&info, 0, sizeof(info));
+                  info.ifa_family = AF_INET6;
+                  info.ifa_index = 9;
+                  BYTE address[4] {0x20, 0x01, 0x0d, 0xb8};
+                  shortAttribute.begin(RTM_NEWADDR, 0);
+                  shortAttribute.append(&info, sizeof(info));
+                  shortAttribute.addAttribute(IFA_ADDRESS, &(address[0]), sizeof(address));
+                  shortAttribute.end();
+                }
+                monitor.process(shortAttribute.ptr(), shortAttribute.size(), dumpDone, changed);
+                TESTING_CHECK(!changed)
+                TESTING_EQUAL(total, monitor.mTestAddresses.size())
+                break;
+              }
+              case 8: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+#endif //HAVE_RTNETLINK
+
+  TESTING_STDOUT() << "WAITING:      All network monitor tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -0,0 +1,338 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_PacketDemux.h>
+
+#include "config.h"
+#include "testing.h"
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::BYTE;
+using zsLib::WORD;
+using zsLib::ULONG;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace packet_demux
+    {
+      ZS_DECLARE_TYPEDEF_PTR(ortc::internal::PacketDemux, PacketDemux)
+
+      struct ClassifyCase
+      {
+        BYTE mFirst;
+        BYTE mSecond;
+        size_t mLength;
+        bool mCookie;                     // bytes 4..7 hold the STUN magic cookie
+        PacketDemux::PacketTypes mExpecting;
+      };
+
+      static const ClassifyCase gClassifyCases[] =
+      {
+        // STUN [0..3] (requires the magic cookie and a full header)
+        {0,   0x01, 20, true,  PacketDemux::PacketType_STUN},
+        {3,   0x01, 20, true,  PacketDemux::PacketType_STUN},
+        {0,   0x01, 19, true,  PacketDemux::PacketType_Unknown},
+        {0,   0x01, 20, false, PacketDemux::PacketType_Unknown},
+        {3,   0x01, 100, false, PacketDemux::PacketType_Unknown},
+        {4,   0x01, 20, true,  PacketDemux::PacketType_Unknown},
+
+        // nothing defined [4..15]
+        {15,  0x00, 20, false, PacketDemux::PacketType_Unknown},
+
+        // ZRTP [16..19]
+        {16,  0x00, 20, false, PacketDemux::PacketType_ZRTP},
+        {19,  0x00, 1,  false, PacketDemux::PacketType_ZRTP},
+
+        // DTLS [20..63] (requires a record header)
+        {20,  0xFE, 13, false, PacketDemux::PacketType_DTLS},
+        {20,  0xFE, 12, false, PacketDemux::PacketType_Unknown},
+        {23,  0xFE, 100, false, PacketDemux::PacketType_DTLS},
+        {63,  0xFE, 13, false, PacketDemux::PacketType_DTLS},
+
+        // TURN ChannelData [64..79] (requires a channel data header)
+        {64,  0x00, 4,  false, PacketDemux::PacketType_TURNChannelData},
+        {64,  0x00, 3,  false, PacketDemux::PacketType_Unknown},
+        {79,  0xFF, 4,  false, PacketDemux::PacketType_TURNChannelData},
+
+        // nothing defined [80..127]
+        {80,  0x00, 100, false, PacketDemux::PacketType_Unknown},
+        {127, 0x00, 100, false, PacketDemux::PacketType_Unknown},
+
+        // RTP/RTCP [128..191]
+        {128, 0,    12, false, PacketDemux::PacketType_RTP},
+        {128, 0,    11, false, PacketDemux::PacketType_Unknown},
+        {128, 0,    7,  false, PacketDemux::PacketType_Unknown},
+        {128, 63,   12, false, PacketDemux::PacketType_RTP},
+        {128, 96,   12, false, PacketDemux::PacketType_RTP},
+        {128, 0x80 | 96, 12, false, PacketDemux::PacketType_RTP},
+        {128, 127,  12, false, PacketDemux::PacketType_RTP},
+        {128, 200,  8,  false, PacketDemux::PacketType_RTCP},    // SR (marker bit position set)
+        {128, 200,  7,  false, PacketDemux::PacketType_Unknown},
+        {191, 0,    12, false, PacketDemux::PacketType_RTP},
+        {191, 201,  8,  false, PacketDemux::PacketType_RTCP},
+
+        // nothing defined [192..255]
+        {192, 0,    100, false, PacketDemux::PacketType_Unknown},
+        {255, 200,  100, false, PacketDemux::PacketType_Unknown},
+      };
+
+      //-----------------------------------------------------------------------
+      static void fill(
+                       BYTE *buffer,
+                       const ClassifyCase &test
+                       )
+      {
+        memset(buffer, 0, 256);
+        buffer[0] = test.mFirst;
+        buffer[1] = test.mSecond;
+        if (test.mCookie) {
+          buffer[4] = static_cast<BYTE>(PacketDemux::kSTUNMagicCookie >> 24);
+          buffer[5] = static_cast<BYTE>((PacketDemux::kSTUNMagicCookie >> 16) & 0xFF);
+          buffer[6] = static_cast<BYTE>((PacketDemux::kSTUNMagicCookie >> 8) & 0xFF);
+          buffer[7] = static_cast<BYTE>(PacketDemux::kSTUNMagicCookie & 0xFF);
+        }
+      }
+
+      struct ChannelDataCase
+      {
+        WORD mChannelNumber;
+        size_t mPayloadLength;            // as written in the header
+        size_t mDatagramLength;
+        bool mExpecting;
+      };
+
+      static const ChannelDataCase gChannelDataCases[] =
+      {
+        {0x4000, 0,    4,    true},
+        {0x4FFF, 4,    8,    true},
+        {0x4001, 1,    8,    true},       // trailing padding is ignored
+        {0x4001, 5,    8,    false},      // length overruns the datagram
+        {0x4001, 0xFFFF, 64, false},
+        {0x4001, 1,    4,    false},
+        {0x4001, 0,    3,    false},      // shorter than the header
+        {0x3FFF, 0,    4,    false},      // below the channel range
+        {0x5000, 0,    4,    false},      // above the (RFC 8656) channel range
+        {0x7FFF, 0,    4,    false},
+      };
+    }
+  }
+}
+
+using namespace ortc::test::packet_demux;
+
+#define TEST_BASIC_PACKET_DEMUX 0
+
+void doTestPacketDemux()
+{
+  if (!ORTC_TEST_DO_PACKET_DEMUX_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for packet demux testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_PACKET_DEMUX: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_PACKET_DEMUX: {
+            switch (step) {
+              case 1: {
+                // first byte range boundaries, short buffers and the cookie
+                BYTE buffer[256] {};
+                for (size_t index = 0; index < (sizeof(gClassifyCases) / sizeof(gClassifyCases[0])); ++index) {
+                  auto &test = gClassifyCases[index];
+                  fill(&(buffer[0]), test);
+
+                  auto result = PacketDemux::classify(&(buffer[0]), test.mLength);
+                  if (test.mExpecting != result) {
+                    TESTING_STDOUT() << "FAILED:       classify case " << index << " (first byte " << static_cast<int>(test.mFirst) << ") returned " << PacketDemux::toString(result) << "\n";
+                  }
+                  TESTING_EQUAL(PacketDemux::toString(test.mExpecting), PacketDemux::toString(result))
+                }
+
+                TESTING_EQUAL(PacketDemux::toString(PacketDemux::PacketType_Unknown), PacketDemux::toString(PacketDemux::classify(&(buffer[0]), 0)))
+                break;
+              }
+              case 2: {
+                // every RTCP payload type [64..95] with and without the
+                // marker bit position set; everything else is RTP
+                BYTE buffer[12] {};
+                buffer[0] = 0x80;
+                for (size_t pt = 0; pt < 256; ++pt) {
+                  buffer[1] = static_cast<BYTE>(pt);
+                  size_t type = (pt & 0x7F);
+                  auto expecting = (((type >= 64) && (type <= 95)) ? PacketDemux::PacketType_RTCP : PacketDemux::PacketType_RTP);
+                  TESTING_EQUAL(PacketDemux::toString(expecting), PacketDemux::toString(PacketDemux::classify(&(buffer[0]), sizeof(buffer))))
+                }
+
+                // an 8 byte RTCP packet is complete while an 8 byte RTP packet is not
+                buffer[1] = 64;
+                TESTING_EQUAL(PacketDemux::toString(PacketDemux::PacketType_RTCP), PacketDemux::toString(PacketDemux::classify(&(buffer[0]), 8)))
+                buffer[1] = 95;
+                TESTING_EQUAL(PacketDemux::toString(PacketDemux::PacketType_RTCP), PacketDemux::toString(PacketDemux::classify(&(buffer[0]), 8)))
+                buffer[1] = 96;
+                TESTING_EQUAL(PacketDemux::toString(PacketDemux::PacketType_Unknown), PacketDemux::toString(PacketDemux::classify(&(buffer[0]), 8)))
+                break;
+              }
+              case 3: {
+                // every first byte lands in exactly the range RFC 7983 gives it
+                BYTE buffer[256] {};
+                for (size_t first = 0; first < 256; ++first) {
+                  ClassifyCase test {static_cast<BYTE>(first), 0, sizeof(buffer), true, PacketDemux::PacketType_Unknown};
+                  fill(&(buffer[0]), test);
+
+                  if (first <= 3) test.mExpecting = PacketDemux::PacketType_STUN;
+                  else if ((first >= 16) && (first <= 19)) test.mExpecting = PacketDemux::PacketType_ZRTP;
+                  else if ((first >= 20) && (first <= 63)) test.mExpecting = PacketDemux::PacketType_DTLS;
+                  else if ((first >= 64) && (first <= 79)) test.mExpecting = PacketDemux::PacketType_TURNChannelData;
+                  else if ((first >= 128) && (first <= 191)) test.mExpecting = PacketDemux::PacketType_RTP;
+
+                  TESTING_EQUAL(PacketDemux::toString(test.mExpecting), PacketDemux::toString(PacketDemux::classify(&(buffer[0]), sizeof(buffer))))
+                }
+                break;
+              }
+              case 4: {
+                // RFC 3489 style STUN has no cookie but still belongs to STUN
+                BYTE buffer[20] {0x00, 0x01};
+                auto type = PacketDemux::classify(&(buffer[0]), sizeof(buffer));
+                TESTING_EQUAL(PacketDemux::toString(PacketDemux::PacketType_Unknown), PacketDemux::toString(type))
+                TESTING_CHECK(PacketDemux::isSTUNCandidate(type, &(buffer[0]), sizeof(buffer)))
+                TESTING_CHECK(PacketDemux::isSTUNCandidate(PacketDemux::PacketType_STUN, &(buffer[0]), sizeof(buffer)))
+                TESTING_CHECK(!PacketDemux::isSTUNCandidate(type, &(buffer[0]), 0))
+
+                buffer[0] = 0x04;
+                TESTING_CHECK(!PacketDemux::isSTUNCandidate(PacketDemux::classify(&(buffer[0]), sizeof(buffer)), &(buffer[0]), sizeof(buffer)))
+                buffer[0] = 0x80;
+                TESTING_CHECK(!PacketDemux::isSTUNCandidate(PacketDemux::classify(&(buffer[0]), sizeof(buffer)), &(buffer[0]), sizeof(buffer)))
+                break;
+              }
+              case 5: {
+                // TURN ChannelData headers
+                BYTE buffer[64] {};
+                for (size_t index = 0; index < (sizeof(gChannelDataCases) / sizeof(gChannelDataCases[0])); ++index) {
+                  auto &test = gChannelDataCases[index];
+
+                  buffer[0] = static_cast<BYTE>(test.mChannelNumber >> 8);
+                  buffer[1] = static_cast<BYTE>(test.mChannelNumber & 0xFF);
+                  buffer[2] = static_cast<BYTE>((test.mPayloadLength >> 8) & 0xFF);
+                  buffer[3] = static_cast<BYTE>(test.mPayloadLength & 0xFF);
+
+                  WORD channelNumber = 0;
+                  size_t payloadLength = 0;
+                  bool result = PacketDemux::parseTURNChannelData(&(buffer[0]), test.mDatagramLength, channelNumber, payloadLength);
+                  if (test.mExpecting != result) {
+                    TESTING_STDOUT() << "FAILED:       channel data case " << index << " returned " << (result ? "true" : "false") << "\n";
+                  }
+                  TESTING_EQUAL(test.mExpecting, result)
+                  if (!result) continue;
+
+                  TESTING_EQUAL(test.mChannelNumber, channelNumber)
+                  TESTING_EQUAL(test.mPayloadLength, payloadLength)
+                }
+                break;
+              }
+              case 6: {
+                // a written header parses back
+                BYTE buffer[4 + 300] {};
+                TESTING_CHECK(PacketDemux::writeTURNChannelDataHeader(&(buffer[0]), 0x4ABC, 300))
+
+                WORD channelNumber = 0;
+                size_t payloadLength = 0;
+                TESTING_CHECK(PacketDemux::parseTURNChannelData(&(buffer[0]), sizeof(buffer), channelNumber, payloadLength))
+                TESTING_EQUAL(0x4ABC, channelNumber)
+                TESTING_EQUAL(300, payloadLength)
+                TESTING_EQUAL(PacketDemux::toString(PacketDemux::PacketType_TURNChannelData), PacketDemux::toString(PacketDemux::classify(&(buffer[0]), sizeof(buffer))))
+
+                TESTING_CHECK(!PacketDemux::parseTURNChannelData(&(buffer[0]), sizeof(buffer) - 1, channelNumber, payloadLength))
+
+                TESTING_CHECK(PacketDemux::writeTURNChannelDataHeader(&(buffer[0]), 0x4000, 0xFFFF))
+                TESTING_CHECK(!PacketDemux::writeTURNChannelDataHeader(&(buffer[0]), 0x4000, 0x10000))
+                break;
+              }
+              case 7: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All packet demux tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -0,0 +1,205 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_ORTC.h>
+
+#include <openpeer/services/ISettings.h>
+
+#include <set>
+
+#include "config.h"
+#include "testing.h"
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::DWORD;
+using zsLib::ULONG;
+using zsLib::IMessageQueuePtr;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace packet_queues
+    {
+      ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+      ZS_DECLARE_TYPEDEF_PTR(ortc::internal::IORTCForInternal, UseORTC)
+
+      typedef std::set<IMessageQueuePtr> QueueSet;
+
+      //-----------------------------------------------------------------------
+      // RETURNS: total packet threads (counted by walking the round robin
+      //          until it repeats)
+      static size_t countPacketThreads()
+      {
+        QueueSet queues;
+        IMessageQueuePtr first = UseORTC::queuePacket();
+        queues.insert(first);
+
+        for (size_t index = 0; index < 256; ++index) {
+          IMessageQueuePtr queue = UseORTC::queuePacket();
+          if (queue == first) break;
+          queues.insert(queue);
+        }
+        return queues.size();
+      }
+    }
+  }
+}
+
+using namespace ortc::test::packet_queues;
+
+#define TEST_BASIC_PACKET_QUEUES 0
+
+void doTestPacketQueues()
+{
+  if (!ORTC_TEST_DO_PACKET_QUEUES_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  // the packet threads are sized once (when first used)
+  UseSettings::setUInt(ORTC_SETTING_ORTC_TOTAL_PACKET_THREADS, 4);
+
+  TESTING_STDOUT() << "WAITING:      Waiting for packet queue testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    int transportA = 0;
+    int transportB = 0;
+
+    size_t totalThreads = countPacketThreads();
+    TESTING_CHECK(totalThreads > 0)
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_PACKET_QUEUES: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_PACKET_QUEUES: {
+            switch (step) {
+              case 1: {
+                // a stream always lands on the same thread
+                IMessageQueuePtr queue = UseORTC::queuePacket(&transportA, 0x1234);
+                TESTING_CHECK(queue)
+                for (size_t index = 0; index < 10; ++index) {
+                  TESTING_CHECK(queue == UseORTC::queuePacket(&transportA, 0x1234))
+                }
+                break;
+              }
+              case 2: {
+                // senders whose SSRC is not known yet (every sender which did
+                // not name one in its encodings) each get their own thread
+                // rather than all sharing the thread of SSRC 0
+                QueueSet queues;
+                for (size_t index = 0; index < totalThreads; ++index) {
+                  IMessageQueuePtr queue = UseORTC::queuePacket(&transportA, 0);
+                  TESTING_CHECK(queue)
+                  queues.insert(queue);
+                }
+                TESTING_EQUAL(totalThreads, queues.size())
+
+                // the same holds across transports
+                QueueSet otherQueues;
+                for (size_t index = 0; index < totalThreads; ++index) {
+                  otherQueues.insert(UseORTC::queuePacket(&transportB, 0));
+                }
+                TESTING_EQUAL(totalThreads, otherQueues.size())
+                break;
+              }
+              case 3: {
+                // the streams of one bundled transport spread over the threads
+                if (totalThreads < 2) {
+                  TESTING_STDOUT() << "WARNING:      Only one packet thread (spreading not tested).\n";
+                  break;
+                }
+
+                QueueSet queues;
+                for (DWORD ssrc = 1000; ssrc < 1064; ++ssrc) {
+                  queues.insert(UseORTC::queuePacket(&transportA, ssrc));
+                }
+                TESTING_CHECK(queues.size() > 1)
+                break;
+              }
+              case 4: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All packet queue tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
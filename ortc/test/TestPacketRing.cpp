@@ -0,0 +1,260 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/MessageQueueThread.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_PacketRing.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <vector>
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::DWORD;
+using zsLib::ULONG;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace packet_ring
+    {
+      ZS_DECLARE_STRUCT_PTR(FakePacket)
+
+      struct FakePacket
+      {
+        DWORD mSSRC {};
+        size_t mSize {};
+        size_t mSequence {};
+
+        size_t size() const {return mSize;}
+
+        static FakePacketPtr create(DWORD ssrc, size_t size, size_t sequence)
+        {
+          auto result = make_shared<FakePacket>();
+          result->mSSRC = ssrc;
+          result->mSize = size;
+          result->mSequence = sequence;
+          return result;
+        }
+      };
+
+      typedef ortc::internal::PacketRing<FakePacketPtr> FakePacketRing;
+
+      static size_t countSSRC(const FakePacketRing &ring, DWORD ssrc)
+      {
+        size_t total = 0;
+        for (auto index = ring.first(ssrc); FakePacketRing::kNone != index; index = ring.next(index)) {
+          if (ring.packet(index)->mSSRC != ssrc) return static_cast<size_t>(-1);
+          ++total;
+        }
+        return total;
+      }
+    }
+  }
+}
+
+using namespace ortc::test::packet_ring;
+
+#define TEST_BASIC_PACKET_RING 0
+
+void doTestPacketRing()
+{
+  if (!ORTC_TEST_DO_PACKET_RING_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for packet ring testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_PACKET_RING: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_PACKET_RING: {
+            switch (step) {
+              case 1: {
+                // slot capacity evicts oldest first
+                FakePacketRing ring(4, 100000, Seconds(30));
+                zsLib::Time tick = zsLib::now();
+
+                for (size_t loop = 0; loop < 6; ++loop) {
+                  TESTING_CHECK(ring.push(tick, static_cast<DWORD>(loop % 2), FakePacket::create(static_cast<DWORD>(loop % 2), 100, loop)))
+                }
+
+                TESTING_EQUAL(4, ring.size())
+                TESTING_EQUAL(400, ring.bytes())
+                TESTING_EQUAL(2, ring.counters().mDroppedOverflow)
+                TESTING_EQUAL(2, countSSRC(ring, 0))
+                TESTING_EQUAL(2, countSSRC(ring, 1))
+
+                // oldest remaining packet of ssrc 0 is sequence 2
+                TESTING_EQUAL(2, ring.packet(ring.first(0))->mSequence)
+
+                std::vector<FakePacketPtr> all;
+                ring.getPackets(all);
+                TESTING_EQUAL(4, all.size())
+                TESTING_EQUAL(2, all.front()->mSequence)
+                TESTING_EQUAL(5, all.back()->mSequence)
+                break;
+              }
+              case 2: {
+                // byte budget, oversized packets, removal and age expiry
+                FakePacketRing ring(100, 1000, Seconds(30));
+                zsLib::Time tick = zsLib::now();
+
+                TESTING_CHECK(!ring.push(tick, 5, FakePacket::create(5, 1001, 0)))
+                TESTING_EQUAL(1, ring.counters().mDroppedOversized)
+                TESTING_CHECK(ring.empty())
+
+                for (size_t loop = 0; loop < 5; ++loop) {
+                  TESTING_CHECK(ring.push(tick, 7, FakePacket::create(7, 300, loop)))
+                }
+                TESTING_EQUAL(3, ring.size())
+                TESTING_EQUAL(900, ring.bytes())
+                TESTING_EQUAL(2, ring.counters().mDroppedOverBudget)
+
+                // remove the middle packet; walking continues past the hole
+                auto index = ring.next(ring.first(7));
+                TESTING_EQUAL(3, ring.packet(index)->mSequence)
+                ring.remove(index);
+                TESTING_EQUAL(2, ring.size())
+                TESTING_EQUAL(600, ring.bytes())
+                TESTING_EQUAL(2, countSSRC(ring, 7))
+                TESTING_EQUAL(4, ring.packet(ring.next(ring.first(7)))->mSequence)
+
+                TESTING_CHECK(ring.push(tick + Seconds(20), 8, FakePacket::create(8, 100, 5)))
+
+                ring.expire(tick + Seconds(40));
+                TESTING_EQUAL(1, ring.size())
+                TESTING_EQUAL(2, ring.counters().mDroppedExpired)
+                TESTING_CHECK(FakePacketRing::kNone == ring.first(7))
+                TESTING_EQUAL(1, countSSRC(ring, 8))
+
+                std::vector<FakePacketRing::SSRCType> ssrcs;
+                ring.getSSRCs(ssrcs);
+                TESTING_EQUAL(1, ssrcs.size())
+
+                ring.clear();
+                TESTING_CHECK(ring.empty())
+                TESTING_EQUAL(0, ring.bytes())
+                break;
+              }
+              case 3: {
+                // long running churn keeps the per-SSRC chains consistent
+                FakePacketRing ring(64, 64*200, Seconds(30));
+                zsLib::Time tick = zsLib::now();
+
+                DWORD seed = 11;
+                for (size_t loop = 0; loop < 100000; ++loop) {
+                  seed = (seed * 1664525UL) + 1013904223UL;
+                  DWORD ssrc = (seed >> 16) % 16;
+                  ring.push(tick, ssrc, FakePacket::create(ssrc, 50 + ((seed >> 8) % 300), loop));
+
+                  if (0 == (loop % 7)) {
+                    auto index = ring.first(ssrc);
+                    if (FakePacketRing::kNone != index) ring.remove(index);
+                  }
+                }
+
+                size_t total = 0;
+                for (DWORD ssrc = 0; ssrc < 16; ++ssrc) {
+                  size_t count = countSSRC(ring, ssrc);
+                  TESTING_CHECK(static_cast<size_t>(-1) != count)
+                  total += count;
+                }
+                TESTING_EQUAL(total, ring.size())
+                TESTING_CHECK(ring.bytes() <= ring.maxBytes())
+                TESTING_CHECK(ring.size() <= ring.maxPackets())
+
+                auto &counters = ring.counters();
+                TESTING_EQUAL(counters.mBuffered, counters.mRemoved + counters.dropped() - counters.mDroppedOversized + ring.size())
+                break;
+              }
+              case 4: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All packet ring tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
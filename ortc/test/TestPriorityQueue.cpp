@@ -0,0 +1,217 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/MessageQueueThread.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_PriorityQueue.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::DWORD;
+using zsLib::ULONG;
+using zsLib::ULONGLONG;
+
+typedef ortc::internal::PriorityQueue<DWORD> DWORDPriorityQueue;
+
+#define TEST_BASIC_PRIORITY_QUEUE 0
+
+static DWORD nextRandom(DWORD &ioSeed)
+{
+  ioSeed = (ioSeed * 1664525UL) + 1013904223UL;
+  return ioSeed;
+}
+
+void doTestPriorityQueue()
+{
+  if (!ORTC_TEST_DO_PRIORITY_QUEUE_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for priority queue testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_PRIORITY_QUEUE: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_PRIORITY_QUEUE: {
+            switch (step) {
+              case 1: {
+                // basic ordering / erase / stale IDs
+                DWORDPriorityQueue queue;
+                TESTING_CHECK(queue.empty())
+
+                auto low = queue.push(10, 1);
+                auto high = queue.push(0x7E0000FFFFFFFFFFULL, 2);
+                auto equalFirst = queue.push(500, 3);
+                auto equalSecond = queue.push(500, 4);
+
+                TESTING_EQUAL(4, queue.size())
+                TESTING_EQUAL(2, queue.top())
+                TESTING_CHECK(queue.contains(low))
+
+                TESTING_CHECK(queue.erase(high))
+                TESTING_CHECK(!queue.erase(high))
+                TESTING_CHECK(!queue.contains(high))
+
+                TESTING_EQUAL(3, queue.top())                 // equal priorities come out in push order
+                queue.pop();
+                TESTING_CHECK(!queue.contains(equalFirst))
+                TESTING_EQUAL(4, queue.top())
+
+                auto reused = queue.push(1, 5);               // reuses a released entry
+                TESTING_CHECK(reused != equalFirst)
+                TESTING_CHECK(!queue.erase(equalFirst))
+                TESTING_CHECK(queue.contains(reused))
+
+                TESTING_CHECK(queue.erase(equalSecond))
+                TESTING_EQUAL(1, queue.top())
+                queue.pop();
+                TESTING_EQUAL(5, queue.top())
+                queue.pop();
+                TESTING_CHECK(queue.empty())
+                break;
+              }
+              case 2: {
+                // randomized comparison against std::multimap including erasing from the middle
+                DWORDPriorityQueue queue;
+                std::multimap<ULONGLONG, DWORD, std::greater<ULONGLONG> > reference;
+                std::map<DWORD, DWORDPriorityQueue::EntryID> entryIDs;
+                std::map<DWORD, std::multimap<ULONGLONG, DWORD, std::greater<ULONGLONG> >::iterator> referenceIDs;
+
+                DWORD seed = 3;
+                DWORD nextValue = 0;
+                for (size_t loop = 0; loop < 50000; ++loop) {
+                  switch (nextRandom(seed) % 4) {
+                    case 0:
+                    case 1: {
+                      ULONGLONG priority = (static_cast<ULONGLONG>(nextRandom(seed) % 64) << 32);   // many equal priorities
+                      DWORD value = nextValue++;
+                      entryIDs[value] = queue.push(priority, value);
+                      referenceIDs[value] = reference.insert(std::make_pair(priority, value));
+                      break;
+                    }
+                    case 2: {
+                      if (reference.empty()) break;
+                      TESTING_EQUAL((*reference.begin()).second, queue.top())
+                      TESTING_EQUAL((*reference.begin()).first, queue.topPriority())
+                      DWORD value = (*reference.begin()).second;
+                      queue.pop();
+                      reference.erase(reference.begin());
+                      referenceIDs.erase(value);
+                      TESTING_CHECK(!queue.contains(entryIDs[value]))
+                      break;
+                    }
+                    default: {
+                      if (referenceIDs.empty()) break;
+                      auto found = referenceIDs.lower_bound(nextRandom(seed) % nextValue);
+                      if (found == referenceIDs.end()) break;
+                      TESTING_CHECK(queue.erase(entryIDs[(*found).first]))
+                      reference.erase((*found).second);
+                      referenceIDs.erase(found);
+                      break;
+                    }
+                  }
+                  TESTING_EQUAL(reference.size(), queue.size())
+                }
+
+                while (!reference.empty()) {
+                  TESTING_EQUAL((*reference.begin()).second, queue.top())
+                  queue.pop();
+                  reference.erase(reference.begin());
+                }
+                TESTING_CHECK(queue.empty())
+                break;
+              }
+              case 3: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All priority queue tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -35,6 +35,7 @@
 #include <ortc/ISettings.h>
 
 #include <ortc/internal/ortc_RTCPPacket.h>
+#include <ortc/internal/ortc_BufferPool.h>
 #include <ortc/internal/ortc_Helper.h>
 
 #include <openpeer/services/IHelper.h>
@@ -65,6 +66,7 @@ using zsLib::AutoRecursiveLock;
 //ZS_DECLARE_TYPEDEF_PTR(ortc::ISettings, UseSettings)
 ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
 ZS_DECLARE_TYPEDEF_PTR(ortc::internal::Helper, UseHelper)
+ZS_DECLARE_TYPEDEF_PTR(ortc::internal::BufferPool, UseBufferPool)
 
 
 namespace ortc
@@ -3560,10 +3562,120 @@ void doTestRTCPPacket()
                 break;
               }
               case 3: {
-                reachedFinalStep = true;
+                // SR + SDES(CNAME) + REMB + generic NACK, the common compound packet seen on a video session
+                static const BYTE compound[] = {
+                  0x81, 0xC8, 0x00, 0x0C,                                           // SR, RC=1, length=12
+                  0x11, 0x22, 0x33, 0x44,                                           // sender SSRC
+                  0xDA, 0x00, 0x00, 0x01, 0x80, 0x00, 0x00, 0x00,                   // NTP timestamp
+                  0x00, 0x01, 0x00, 0x00,                                           // RTP timestamp
+                  0x00, 0x00, 0x01, 0x00,                                           // sender packet count
+                  0x00, 0x01, 0x00, 0x00,                                           // sender octet count
+                  0x55, 0x66, 0x77, 0x88,                                           // report block SSRC
+                  0x01, 0x00, 0x00, 0x02,                                           // fraction lost / cumulative lost
+                  0x00, 0x00, 0x10, 0x00,                                           // extended highest sequence number
+                  0x00, 0x00, 0x00, 0x20,                                           // jitter
+                  0x00, 0x00, 0x00, 0x00,                                           // LSR
+                  0x00, 0x00, 0x00, 0x00,                                           // DLSR
+
+                  0x81, 0xCA, 0x00, 0x06,                                           // SDES, SC=1, length=6
+                  0x11, 0x22, 0x33, 0x44,                                           // chunk SSRC
+                  0x01, 0x10,                                                       // CNAME, 16 bytes
+                  'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p',
+                  0x00, 0x00,                                                       // end + padding
+
+                  0x8F, 0xCE, 0x00, 0x05,                                           // PSFB, FMT=15 (AFB), length=5
+                  0x11, 0x22, 0x33, 0x44,                                           // sender SSRC
+                  0x00, 0x00, 0x00, 0x00,                                           // media SSRC
+                  'R', 'E', 'M', 'B',
+                  0x01, 0x0A, 0x00, 0x00,                                           // num SSRC=1, exp/mantissa
+                  0x55, 0x66, 0x77, 0x88,                                           // SSRC feedback
+
+                  0x81, 0xCD, 0x00, 0x04,                                           // RTPFB, FMT=1 (generic NACK), length=4
+                  0x11, 0x22, 0x33, 0x44,                                           // sender SSRC
+                  0x55, 0x66, 0x77, 0x88,                                           // media SSRC
+                  0x10, 0x00, 0x00, 0x05,                                           // PID / BLP
+                  0x10, 0x20, 0x00, 0x00,                                           // PID / BLP
+                };
+
+                {
+                  auto packet = RTCPPacket::create(&(compound[0]), sizeof(compound));
+                  TESTING_CHECK(packet)
+                  TESTING_EQUAL(packet->count(), 4)
+                  TESTING_EQUAL(packet->senderReportCount(), 1)
+                  TESTING_EQUAL(packet->sdesCount(), 1)
+                  TESTING_EQUAL(packet->payloadSpecificFeedbackMessage(), 1)
+                  TESTING_EQUAL(packet->transportLayerFeedbackMessageCount(), 1)
+                  TESTING_EQUAL(packet->firstSDES()->firstChunk()->cNameCount(), 1)
+                  TESTING_CHECK(packet->firstPayloadSpecificFeedbackMessage()->remb())
+                  TESTING_EQUAL(packet->firstTransportLayerFeedbackMessage()->genericNACKCount(), 2)
+                }
+
+                static const size_t kIterations = 100000;
+
+                auto before = UseBufferPool::getStats();
+
+                zsLib::Time start = zsLib::now();
+                size_t totalReports = 0;
+                for (size_t index = 0; index < kIterations; ++index) {
+                  auto packet = RTCPPacket::create(&(compound[0]), sizeof(compound));
+                  totalReports += packet->count();
+                }
+                zsLib::Time end = zsLib::now();
+
+                auto after = UseBufferPool::getStats();
+
+                TESTING_EQUAL(totalReports, kIterations * 4)
+
+                TESTING_STDOUT() << "BENCHMARK:    parsing " << kIterations << " SR+SDES+REMB+NACK compound packets took [" << zsLib::toMilliseconds(end - start).count() << "ms]\n";
+                TESTING_STDOUT() << "BENCHMARK:    parse arena pool hits [" << (after.mHits - before.mHits) << "], misses [" << (after.mMisses - before.mMisses) << "]\n";
+
+                // lazy decoding only decodes the report types asked for
+                {
+                  auto packet = RTCPPacket::createLazy(&(compound[0]), sizeof(compound));
+                  TESTING_CHECK(packet)
+                  TESTING_EQUAL(packet->count(), 4)
+                  TESTING_CHECK(NULL == packet->firstBye())
+                  TESTING_CHECK(packet->firstSenderReport())
+                  TESTING_EQUAL(packet->firstSenderReport()->ssrcOfSender(), 0x11223344)
+                  TESTING_EQUAL(packet->firstSDES()->firstChunk()->cNameCount(), 1)
+                  TESTING_CHECK(packet->first())
+                  TESTING_EQUAL(packet->firstTransportLayerFeedbackMessage()->genericNACKCount(), 2)
+                }
+
+                // a malformed report body only drops its own report type when lazily decoded
+                {
+                  BYTE malformed[sizeof(compound)] {};
+                  memcpy(&(malformed[0]), &(compound[0]), sizeof(compound));
+                  malformed[sizeof(compound) - 20 + 3] = 0x02;                  // NACK without any FCI entries
+                  size_t malformedSize = sizeof(compound) - 8;
+
+                  TESTING_CHECK(!RTCPPacket::create(&(malformed[0]), malformedSize))
+
+                  auto packet = RTCPPacket::createLazy(&(malformed[0]), malformedSize);
+                  TESTING_CHECK(packet)
+                  TESTING_CHECK(packet->firstSenderReport())
+                  TESTING_EQUAL(packet->transportLayerFeedbackMessageCount(), 0)
+                  TESTING_CHECK(NULL == packet->firstTransportLayerFeedbackMessage())
+                  TESTING_CHECK(NULL == packet->first())
+                }
+
+                start = zsLib::now();
+                totalReports = 0;
+                for (size_t index = 0; index < kIterations; ++index) {
+                  auto packet = RTCPPacket::createLazy(&(compound[0]), sizeof(compound));
+                  for (auto bye = packet->firstBye(); NULL != bye; bye = bye->nextBye()) {++totalReports;}
+                  for (auto sdes = packet->firstSDES(); NULL != sdes; sdes = sdes->nextSDES()) {++totalReports;}
+                  for (auto sr = packet->firstSenderReport(); NULL != sr; sr = sr->nextSenderReport()) {++totalReports;}
+                }
+                end = zsLib::now();
+
+                TESTING_EQUAL(totalReports, kIterations * 2)
+
+                TESTING_STDOUT() << "BENCHMARK:    lazily parsing BYE/SDES/SR from " << kIterations << " SR+SDES+REMB+NACK compound packets took [" << zsLib::toMilliseconds(end - start).count() << "ms]\n";
                 break;
               }
               case 4: {
+                reachedFinalStep = true;
                 break;
               }
               case 5: {
@@ -44,6 +44,10 @@
 #include "config.h"
 #include "testing.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
 
 using zsLib::String;
@@ -246,7 +250,7 @@ namespace ortc
 
         ZS_LOG_DEBUG(log("packet received") + ZS_PARAM("buffer", (PTRNUMBER)(buffer->BytePtr())) + ZS_PARAM("buffer size", buffer->SizeInBytes()))
 
-        transport->handleReceivedPacket(mComponent, buffer->BytePtr(), buffer->SizeInBytes());
+        transport->handleReceivedPacket(mComponent, ortc::internal::PacketDemux::classify(buffer->BytePtr(), buffer->SizeInBytes()), buffer->BytePtr(), buffer->SizeInBytes());
       }
 
       //-----------------------------------------------------------------------
@@ -311,7 +315,7 @@ namespace ortc
 
           ZS_LOG_DEBUG(log("packet received (after delay)") + ZS_PARAM("buffer", (PTRNUMBER)(buffer->BytePtr())) + ZS_PARAM("buffer size", buffer->SizeInBytes()))
 
-          transport->handleReceivedPacket(mComponent, buffer->BytePtr(), buffer->SizeInBytes());
+          transport->handleReceivedPacket(mComponent, ortc::internal::PacketDemux::classify(buffer->BytePtr(), buffer->SizeInBytes()), buffer->BytePtr(), buffer->SizeInBytes());
         }
       }
 
@@ -596,6 +600,7 @@ namespace ortc
       //-----------------------------------------------------------------------
       bool FakeSecureTransport::handleReceivedPacket(
                                                      IICETypes::Components component,
+                                                     ortc::internal::PacketDemux::PacketTypes packetType,
                                                      const BYTE *buffer,
                                                      size_t bufferSizeInBytes
                                                      )
@@ -1666,12 +1671,202 @@ namespace ortc
 
         sender->sendPacket(secureBuffer);
       }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RTPListenerInternalTester
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      RTPListenerInternalTester::RTPListenerInternalTester() :
+        RTPListener(zsLib::Noop(true))
+      {
+        mReceivers = make_shared<ReceiverObjectMap>();
+        mSenders = make_shared<SenderObjectMap>();
+      }
+
+      //-----------------------------------------------------------------------
+      RTPListenerInternalTester::~RTPListenerInternalTester()
+      {
+      }
+
+      //-----------------------------------------------------------------------
+      RTPListenerInternalTesterPtr RTPListenerInternalTester::create()
+      {
+        return make_shared<RTPListenerInternalTester>();
+      }
+
+      //-----------------------------------------------------------------------
+      void RTPListenerInternalTester::addReceiver(
+                                                  ReceiverID receiverID,
+                                                  const char *muxID
+                                                  )
+      {
+        AutoRecursiveLock lock(*this);
+
+        ReceiverInfoPtr receiverInfo(make_shared<ReceiverInfo>());
+        receiverInfo->mReceiverID = receiverID;
+
+        if (NULL != muxID) {
+          receiverInfo->mFilledParameters.mMuxID = String(muxID);
+          receiverInfo->mMuxIDInterned = intern(receiverInfo->mFilledParameters.mMuxID);
+          mMuxIDTable[receiverInfo->mFilledParameters.mMuxID] = receiverInfo;
+        }
+
+        ReceiverObjectMapPtr receivers(make_shared<ReceiverObjectMap>(*mReceivers));
+        (*receivers)[receiverID] = receiverInfo;
+        mReceivers = receivers;
+      }
+
+      //-----------------------------------------------------------------------
+      void RTPListenerInternalTester::addReceiverSSRC(
+                                                      ReceiverID receiverID,
+                                                      SSRCType ssrc,
+                                                      bool confirmMuxID
+                                                      )
+      {
+        AutoRecursiveLock lock(*this);
+
+        ReceiverInfoPtr receiverInfo = getReceiverInfo(receiverID);
+        TESTING_CHECK(receiverInfo)
+
+        SSRCInfoPtr ssrcInfo(make_shared<SSRCInfo>());
+        ssrcInfo->mSSRC = ssrc;
+        ssrcInfo->mReceiverInfo = receiverInfo;
+
+        // only SSRCs confirmed against their receiver's mux ID are routed
+        // by the routing table
+        if (confirmMuxID) {
+          ssrcInfo->mMuxID = receiverInfo->mFilledParameters.mMuxID;
+          ssrcInfo->mMuxIDInterned = receiverInfo->mMuxIDInterned;
+        }
+
+        mSSRCTable[ssrc] = ssrcInfo;
+        markRouteDirty(ssrc);
+      }
+
+      //-----------------------------------------------------------------------
+      void RTPListenerInternalTester::removeSSRC(SSRCType ssrc)
+      {
+        AutoRecursiveLock lock(*this);
+
+        mSSRCTable.erase(ssrc);
+        markRouteDirty(ssrc);
+      }
+
+      //-----------------------------------------------------------------------
+      void RTPListenerInternalTester::registerMuxIDExtension(LocalID localID)
+      {
+        AutoRecursiveLock lock(*this);
+        registerHeaderExtensionReference(kAPIReference, IRTPTypes::HeaderExtensionURI_MuxID, localID, false);
+      }
+
+      //-----------------------------------------------------------------------
+      void RTPListenerInternalTester::addSender(
+                                                SenderID senderID,
+                                                SSRCType ssrc
+                                                )
+      {
+        AutoRecursiveLock lock(*this);
+
+        SenderObjectMapPtr senders(make_shared<SenderObjectMap>(*mSenders));
+        (*senders)[senderID] = UseSenderWeakPtr();
+        mSenders = senders;
+
+        Parameters params;
+        IRTPTypes::EncodingParameters encoding;
+        encoding.mSSRC = ssrc;
+        params.mEncodings.push_back(encoding);
+
+        setSenderSSRCs(senderID, &params);
+      }
+
+      //-----------------------------------------------------------------------
+      void RTPListenerInternalTester::removeSender(SenderID senderID)
+      {
+        AutoRecursiveLock lock(*this);
+
+        SenderObjectMapPtr senders(make_shared<SenderObjectMap>(*mSenders));
+        senders->erase(senderID);
+        mSenders = senders;
+
+        setSenderSSRCs(senderID, NULL);
+      }
+
+      //-----------------------------------------------------------------------
+      RTPListenerInternalTester::ReceiverObjectMapPtr RTPListenerInternalTester::getReceivers() const
+      {
+        AutoRecursiveLock lock(*this);
+        return mReceivers;
+      }
+
+      //-----------------------------------------------------------------------
+      RTPListenerInternalTester::SenderObjectMapPtr RTPListenerInternalTester::getSenders() const
+      {
+        AutoRecursiveLock lock(*this);
+        return mSenders;
+      }
+
+      //-----------------------------------------------------------------------
+      void RTPListenerInternalTester::findTargets(
+                                                  const RTCPPacket &rtcpPacket,
+                                                  ReceiverObjectMapPtr &outReceivers,
+                                                  SenderObjectMapPtr &outSenders
+                                                  )
+      {
+        AutoRecursiveLock lock(*this);
+
+        outReceivers = mReceivers;
+        outSenders = mSenders;
+
+        findRTCPTargets(rtcpPacket, outReceivers, outSenders);
+      }
+
+      //-----------------------------------------------------------------------
+      void RTPListenerInternalTester::publish()
+      {
+        AutoRecursiveLock lock(*this);
+        publishRoutingTable();
+      }
+
+      //-----------------------------------------------------------------------
+      RTPListenerInternalTester::RoutingTablePtr RTPListenerInternalTester::getRoutingTable() const
+      {
+        return std::atomic_load(&mRoutingTable);
+      }
+
+      //-----------------------------------------------------------------------
+      bool RTPListenerInternalTester::route(
+                                            const RTPPacket &rtpPacket,
+                                            ReceiverID &outReceiverID,
+                                            String &outMuxID
+                                            ) const
+      {
+        // NOTE: deliberately called without the lock (as packet threads do)
+        ReceiverInfoPtr receiverInfo;
+        if (!findMappingUsingRoutingTable(rtpPacket, receiverInfo, outMuxID)) return false;
+
+        outReceiverID = receiverInfo->mReceiverID;
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      RTPListenerInternalTester::ReceiverInfoPtr RTPListenerInternalTester::getReceiverInfo(ReceiverID receiverID) const
+      {
+        auto found = mReceivers->find(receiverID);
+        if (found == mReceivers->end()) return ReceiverInfoPtr();
+        return (*found).second;
+      }
     }
   }
 }
 
 ZS_DECLARE_USING_PTR(ortc::test::rtplistener, FakeICETransport)
 ZS_DECLARE_USING_PTR(ortc::test::rtplistener, RTPListenerTester)
+ZS_DECLARE_USING_PTR(ortc::test::rtplistener, RTPListenerInternalTester)
 ZS_DECLARE_USING_PTR(ortc, IICETransport)
 ZS_DECLARE_USING_PTR(ortc, IDTLSTransport)
 using ortc::IDTLSTransportTypes;
@@ -1688,6 +1883,7 @@ ZS_DECLARE_TYPEDEF_PTR(ortc::IRTPTypes::EncodingParameters, EncodingParameters)
 using ortc::IICETypes;
 using zsLib::Optional;
 using zsLib::WORD;
+using zsLib::DWORD;
 using zsLib::BYTE;
 using zsLib::Milliseconds;
 using ortc::SecureByteBlock;
@@ -1695,6 +1891,93 @@ using ortc::SecureByteBlockPtr;
 
 #define TEST_BASIC_ROUTING 0
 #define TEST_BASIC_ROUTING_EXTENDED_SOURCE 1
+#define TEST_RTCP_TARGETS 2
+#define TEST_ROUTING_TABLE_REPUBLISH 3
+#define TEST_ROUTING_TABLE_CONCURRENT_READERS 4
+
+#define TEST_ROUTING_TABLE_READER_THREADS 4
+#define TEST_ROUTING_TABLE_PUBLISHES 2000
+
+//-----------------------------------------------------------------------------
+static RTPPacketPtr createRoutingPacket(
+                                        DWORD ssrc,
+                                        const char *mid = NULL
+                                        )
+{
+  RTPPacket::CreationParams params;
+  params.mPT = 96;
+  params.mSequenceNumber = 1;
+  params.mTimestamp = 10000;
+  params.mSSRC = ssrc;
+  const char *payload = "routingtable";
+  params.mPayload = reinterpret_cast<const BYTE *>(payload);
+  params.mPayloadSize = strlen(payload);
+
+  if (NULL == mid) return RTPPacket::create(params);
+
+  RTPPacket::MidHeaderExtension midExtension(1, mid);
+  params.mFirstHeaderExtension = &midExtension;
+
+  return RTPPacket::create(params);
+}
+
+//-----------------------------------------------------------------------------
+static RTCPPacketPtr createSenderReport(
+                                        DWORD ssrcOfSender,
+                                        DWORD reportAboutSSRC
+                                        )
+{
+  RTCPPacket::SenderReceiverCommonReport::ReportBlock block;
+  block.mSSRC = reportAboutSSRC;
+
+  RTCPPacket::SenderReport report;
+  report.mVersion = 2;
+  report.mPT = RTCPPacket::SenderReport::kPayloadType;
+  report.mReportSpecific = 1;
+  report.mSSRCOfSender = ssrcOfSender;
+  report.mFirstReportBlock = &block;
+
+  return RTCPPacket::create(&report);
+}
+
+//-----------------------------------------------------------------------------
+static RTCPPacketPtr createReceiverReport(
+                                          DWORD ssrcOfSender,
+                                          const DWORD *reportAboutSSRCs,
+                                          size_t totalSSRCs
+                                          )
+{
+  typedef RTCPPacket::SenderReceiverCommonReport::ReportBlock ReportBlock;
+
+  std::vector<ReportBlock> blocks(totalSSRCs);
+  for (size_t index = 0; index < totalSSRCs; ++index) {
+    blocks[index].mSSRC = reportAboutSSRCs[index];
+    if (index + 1 < totalSSRCs) blocks[index].mNext = &(blocks[index + 1]);
+  }
+
+  RTCPPacket::ReceiverReport report;
+  report.mVersion = 2;
+  report.mPT = RTCPPacket::ReceiverReport::kPayloadType;
+  report.mReportSpecific = static_cast<BYTE>(totalSSRCs);
+  report.mSSRCOfSender = ssrcOfSender;
+  report.mFirstReportBlock = (totalSSRCs > 0 ? &(blocks[0]) : NULL);
+
+  return RTCPPacket::create(&report);
+}
+
+//-----------------------------------------------------------------------------
+static RTCPPacketPtr createBye(DWORD ssrc)
+{
+  DWORD ssrcs[1] = {ssrc};
+
+  RTCPPacket::Bye report;
+  report.mVersion = 2;
+  report.mPT = RTCPPacket::Bye::kPayloadType;
+  report.mReportSpecific = 1;
+  report.mSSRCs = ssrcs;
+
+  return RTCPPacket::create(&report);
+}
 
 static void bogusSleep()
 {
@@ -1722,6 +2005,8 @@ void doTestRTPListener()
   RTPListenerTesterPtr testObject1;
   RTPListenerTesterPtr testObject2;
 
+  RTPListenerInternalTesterPtr internalTester;
+
   TESTING_STDOUT() << "WAITING:      Waiting for RTPListener testing to complete (max wait is 180 seconds).\n";
 
   // check to see if all DNS routines have resolved
@@ -1776,6 +2061,14 @@ void doTestRTPListener()
           expectations1.mUnhandled = 0;
           break;
         }
+        case TEST_RTCP_TARGETS:
+        case TEST_ROUTING_TABLE_REPUBLISH:
+        case TEST_ROUTING_TABLE_CONCURRENT_READERS:
+        {
+          internalTester = RTPListenerInternalTester::create();
+          TESTING_CHECK(internalTester)
+          break;
+        }
         default:  quit = true; break;
       }
       if (quit) break;
@@ -2097,6 +2390,299 @@ void doTestRTPListener()
             }
             break;
           }
+          case TEST_RTCP_TARGETS: {
+            RTPListenerInternalTester::ReceiverObjectMapPtr receivers;
+            RTPListenerInternalTester::SenderObjectMapPtr senders;
+
+            switch (step) {
+              case 1: {
+                // receivers 1 and 2 receive SSRC 100 and 200, senders 11
+                // and 12 send SSRC 1000 and 2000
+                internalTester->addReceiver(1);
+                internalTester->addReceiver(2);
+                internalTester->addReceiverSSRC(1, 100);
+                internalTester->addReceiverSSRC(2, 200);
+
+                internalTester->addSender(11, 1000);
+                internalTester->addSender(12, 2000);
+                break;
+              }
+              case 2: {
+                // SR goes to the receiver of the reporting SSRC and its
+                // report block goes to the sender of the reported SSRC
+                RTCPPacketPtr packet = createSenderReport(100, 1000);
+                TESTING_CHECK(packet)
+
+                internalTester->findTargets(*packet, receivers, senders);
+                TESTING_EQUAL(receivers->size(), 1)
+                TESTING_CHECK(receivers->end() != receivers->find(1))
+                TESTING_EQUAL(senders->size(), 1)
+                TESTING_CHECK(senders->end() != senders->find(11))
+                break;
+              }
+              case 3: {
+                // an RR about both local SSRCs reaches both senders but no
+                // receiver
+                DWORD ssrcs[2] = {1000, 2000};
+                RTCPPacketPtr packet = createReceiverReport(300, ssrcs, 2);
+                TESTING_CHECK(packet)
+
+                internalTester->findTargets(*packet, receivers, senders);
+                TESTING_EQUAL(receivers->size(), 0)
+                TESTING_CHECK(receivers != internalTester->getReceivers())
+                TESTING_EQUAL(senders->size(), 2)
+                TESTING_CHECK(senders != internalTester->getSenders())
+                break;
+              }
+              case 4: {
+                // a report about an SSRC with no known owner (or an RR
+                // without any report block) is broadcast to all senders
+                DWORD ssrcs[1] = {3000};
+                RTCPPacketPtr packet = createReceiverReport(300, ssrcs, 1);
+                TESTING_CHECK(packet)
+
+                internalTester->findTargets(*packet, receivers, senders);
+                TESTING_CHECK(senders == internalTester->getSenders())
+
+                packet = createReceiverReport(300, NULL, 0);
+                TESTING_CHECK(packet)
+
+                internalTester->findTargets(*packet, receivers, senders);
+                TESTING_CHECK(senders == internalTester->getSenders())
+                break;
+              }
+              case 5: {
+                // a BYE only reaches the receiver of the departing SSRC;
+                // an unknown SSRC is broadcast to all receivers
+                RTCPPacketPtr packet = createBye(200);
+                TESTING_CHECK(packet)
+
+                internalTester->findTargets(*packet, receivers, senders);
+                TESTING_EQUAL(receivers->size(), 1)
+                TESTING_CHECK(receivers->end() != receivers->find(2))
+                TESTING_EQUAL(senders->size(), 0)
+
+                packet = createBye(400);
+                TESTING_CHECK(packet)
+
+                internalTester->findTargets(*packet, receivers, senders);
+                TESTING_CHECK(receivers == internalTester->getReceivers())
+                break;
+              }
+              case 6: {
+                // once a sender is gone its SSRC no longer has an owner
+                internalTester->removeSender(11);
+
+                RTCPPacketPtr packet = createSenderReport(100, 1000);
+                TESTING_CHECK(packet)
+
+                internalTester->findTargets(*packet, receivers, senders);
+                TESTING_EQUAL(receivers->size(), 1)
+                TESTING_CHECK(senders == internalTester->getSenders())
+                TESTING_EQUAL(senders->size(), 1)
+                TESTING_CHECK(senders->end() == senders->find(11))
+                break;
+              }
+              case 7: {
+                internalTester.reset();
+                lastStepReached = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          case TEST_ROUTING_TABLE_REPUBLISH: {
+            RTPListenerInternalTester::ReceiverID receiverID {};
+            String muxID;
+
+            switch (step) {
+              case 1: {
+                internalTester->registerMuxIDExtension(1);
+                internalTester->addReceiver(1, "a");
+                internalTester->addReceiver(2, "b");
+                internalTester->addReceiverSSRC(1, 100, true);
+
+                TESTING_CHECK(!internalTester->getRoutingTable())
+                internalTester->publish();
+                TESTING_CHECK(internalTester->getRoutingTable())
+
+                TESTING_CHECK(internalTester->route(*createRoutingPacket(100), receiverID, muxID))
+                TESTING_EQUAL(receiverID, 1)
+                TESTING_EQUAL(muxID, "a")
+                TESTING_CHECK(!internalTester->route(*createRoutingPacket(200), receiverID, muxID))
+                break;
+              }
+              case 2: {
+                auto previousTable = internalTester->getRoutingTable();
+                TESTING_CHECK(previousTable)
+
+                // an SSRC whose mux ID has not been confirmed is never put
+                // into the routing table
+                internalTester->addReceiverSSRC(2, 200, true);
+                internalTester->addReceiverSSRC(2, 300, false);
+
+                // readers keep routing from the previous table until the
+                // replacement is published
+                TESTING_CHECK(!internalTester->route(*createRoutingPacket(200), receiverID, muxID))
+
+                internalTester->publish();
+
+                auto table = internalTester->getRoutingTable();
+                TESTING_CHECK(table)
+                TESTING_CHECK(table != previousTable)
+
+                TESTING_CHECK(internalTester->route(*createRoutingPacket(100), receiverID, muxID))
+                TESTING_EQUAL(receiverID, 1)
+                TESTING_CHECK(internalTester->route(*createRoutingPacket(200), receiverID, muxID))
+                TESTING_EQUAL(receiverID, 2)
+                TESTING_EQUAL(muxID, "b")
+                TESTING_CHECK(!internalTester->route(*createRoutingPacket(300), receiverID, muxID))
+
+                // the previous table was not modified by the publish
+                TESTING_CHECK(NULL != previousTable->findRoute(100))
+                TESTING_CHECK(NULL == previousTable->findRoute(200))
+
+                // only the shards of the changed SSRCs were replaced
+                size_t shard100 = RTPListenerInternalTester::RoutingTable::shardIndex(100);
+                size_t shard200 = RTPListenerInternalTester::RoutingTable::shardIndex(200);
+                TESTING_CHECK(shard100 != shard200)
+                TESTING_CHECK(table->mShards[shard100] == previousTable->mShards[shard100])
+                TESTING_CHECK(table->mShards[shard200] != previousTable->mShards[shard200])
+                break;
+              }
+              case 3: {
+                auto previousTable = internalTester->getRoutingTable();
+                TESTING_CHECK(previousTable)
+
+                // move an SSRC to another receiver
+                internalTester->addReceiverSSRC(2, 100, true);
+                internalTester->publish();
+
+                TESTING_CHECK(internalTester->route(*createRoutingPacket(100), receiverID, muxID))
+                TESTING_EQUAL(receiverID, 2)
+                TESTING_EQUAL(muxID, "b")
+
+                auto found = previousTable->findRoute(100);
+                TESTING_CHECK(NULL != found)
+                if (NULL != found) {
+                  TESTING_EQUAL(found->mReceiverInfo->mReceiverID, 1)
+                }
+                break;
+              }
+              case 4: {
+                // publishing without any change keeps the existing table
+                auto previousTable = internalTester->getRoutingTable();
+                internalTester->publish();
+                TESTING_CHECK(previousTable == internalTester->getRoutingTable())
+
+                internalTester->removeSSRC(200);
+                internalTester->publish();
+                TESTING_CHECK(previousTable != internalTester->getRoutingTable())
+                TESTING_CHECK(!internalTester->route(*createRoutingPacket(200), receiverID, muxID))
+                break;
+              }
+              case 5: {
+                // a packet whose MID disagrees with the route (or whose MID
+                // was never interned) is left for the locked path
+                TESTING_CHECK(internalTester->route(*createRoutingPacket(100, "b"), receiverID, muxID))
+                TESTING_EQUAL(receiverID, 2)
+                TESTING_CHECK(!internalTester->route(*createRoutingPacket(100, "a"), receiverID, muxID))
+                TESTING_CHECK(!internalTester->route(*createRoutingPacket(100, "z"), receiverID, muxID))
+                break;
+              }
+              case 6: {
+                internalTester.reset();
+                lastStepReached = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          case TEST_ROUTING_TABLE_CONCURRENT_READERS: {
+            switch (step) {
+              case 1: {
+                internalTester->addReceiver(1, "a");
+                internalTester->addReceiver(2, "b");
+                internalTester->addReceiverSSRC(1, 100, true);
+                internalTester->addReceiverSSRC(2, 200, true);
+                internalTester->publish();
+                break;
+              }
+              case 2: {
+                // readers route without the lock while tables are replaced;
+                // SSRC 100 never changes and SSRC 200 comes and goes
+                RTPPacketPtr stablePacket = createRoutingPacket(100);
+                RTPPacketPtr changingPacket = createRoutingPacket(200);
+
+                std::atomic<bool> stop {false};
+                std::atomic<ULONG> lookups {0};
+                std::atomic<ULONG> failures {0};
+
+                std::vector<std::thread> readers;
+                for (int index = 0; index < TEST_ROUTING_TABLE_READER_THREADS; ++index) {
+                  readers.push_back(std::thread([&]() {
+                    while (!stop) {
+                      RTPListenerInternalTester::ReceiverID receiverID {};
+                      String muxID;
+
+                      if ((!internalTester->route(*stablePacket, receiverID, muxID)) ||
+                          (1 != receiverID) ||
+                          (muxID != "a")) {
+                        ++failures;
+                      }
+
+                      receiverID = 0;
+                      muxID.clear();
+                      if ((internalTester->route(*changingPacket, receiverID, muxID)) &&
+                          ((2 != receiverID) ||
+                           (muxID != "b"))) {
+                        ++failures;
+                      }
+                      ++lookups;
+                    }
+                  }));
+                }
+
+                for (int loop = 0; loop < TEST_ROUTING_TABLE_PUBLISHES; ++loop) {
+                  if (0 == (loop % 2)) {
+                    internalTester->removeSSRC(200);
+                  } else {
+                    internalTester->addReceiverSSRC(2, 200, true);
+                  }
+                  // vary the table size so replacements rehash differently
+                  internalTester->addReceiverSSRC(2, 1000 + (loop % 64), true);
+                  internalTester->publish();
+                }
+
+                stop = true;
+                for (auto iter = readers.begin(); iter != readers.end(); ++iter) {
+                  (*iter).join();
+                }
+
+                TESTING_EQUAL(failures.load(), 0)
+                TESTING_CHECK(lookups.load() > 0)
+                break;
+              }
+              case 3: {
+                internalTester.reset();
+                lastStepReached = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
           default: {
             // none defined
             break;
@@ -2129,6 +2715,7 @@ void doTestRTPListener()
 
       testObject1.reset();
       testObject2.reset();
+      internalTester.reset();
 
       ++testNumber;
     } while (true);
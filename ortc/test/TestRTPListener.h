@@ -120,6 +120,7 @@ namespace ortc
       ZS_DECLARE_CLASS_PTR(FakeReceiver)
       ZS_DECLARE_CLASS_PTR(FakeSender)
       ZS_DECLARE_CLASS_PTR(RTPListenerTester)
+      ZS_DECLARE_CLASS_PTR(RTPListenerInternalTester)
 
       //---------------------------------------------------------------------
       //---------------------------------------------------------------------
@@ -357,6 +358,7 @@ namespace ortc
         //---------------------------------------------------------------------
         bool handleReceivedPacket(
                                   IICETypes::Components component,
+                                  ortc::internal::PacketDemux::PacketTypes packetType,
                                   const BYTE *buffer,
                                   size_t bufferSizeInBytes
                                   ) override;
@@ -770,6 +772,69 @@ namespace ortc
 
         UnhandledEventDataList mExpectingUnhandled;
       };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RTPListenerInternalTester
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      // fills the listener's tables directly (no transports, receivers or
+      // senders are attached) so lookups can be checked synchronously
+      class RTPListenerInternalTester : public RTPListener
+      {
+      public:
+        typedef IRTPTypes::SSRCType SSRCType;
+
+      public:
+        RTPListenerInternalTester();
+        ~RTPListenerInternalTester();
+
+        static RTPListenerInternalTesterPtr create();
+
+        void addReceiver(
+                         ReceiverID receiverID,
+                         const char *muxID = NULL
+                         );
+        void addReceiverSSRC(
+                             ReceiverID receiverID,
+                             SSRCType ssrc,
+                             bool confirmMuxID = false
+                             );
+        void removeSSRC(SSRCType ssrc);
+
+        void registerMuxIDExtension(LocalID localID);
+
+        void addSender(
+                       SenderID senderID,
+                       SSRCType ssrc
+                       );
+        void removeSender(SenderID senderID);
+
+        ReceiverObjectMapPtr getReceivers() const;
+        SenderObjectMapPtr getSenders() const;
+
+        void findTargets(
+                         const RTCPPacket &rtcpPacket,
+                         ReceiverObjectMapPtr &outReceivers,
+                         SenderObjectMapPtr &outSenders
+                         );
+
+        void publish();
+        RoutingTablePtr getRoutingTable() const;
+
+        bool route(
+                   const RTPPacket &rtpPacket,
+                   ReceiverID &outReceiverID,
+                   String &outMuxID
+                   ) const;
+
+      protected:
+        ReceiverInfoPtr getReceiverInfo(ReceiverID receiverID) const;
+      };
     }
   }
 }
@@ -45,6 +45,9 @@
 #include "config.h"
 #include "testing.h"
 
+#include <cstdlib>
+#include <new>
+
 namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
 
 using std::make_shared;
@@ -67,6 +70,35 @@ ZS_DECLARE_TYPEDEF_PTR(openpeer::services::IHelper, UseServicesHelper)
 ZS_DECLARE_TYPEDEF_PTR(ortc::internal::Helper, UseHelper)
 ZS_DECLARE_TYPEDEF_PTR(ortc::internal::RTPUtils, UseRTPUtils)
 
+namespace ortc
+{
+  namespace test
+  {
+    namespace rtppacket
+    {
+      // heap allocations made by the current thread while counting is on
+      static thread_local bool gCountAllocations {};
+      static thread_local size_t gCountedAllocations {};
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void *operator new(std::size_t size)
+{
+  if (ortc::test::rtppacket::gCountAllocations) ++ortc::test::rtppacket::gCountedAllocations;
+
+  void *result = malloc(0 != size ? size : 1);
+  if (NULL == result) throw std::bad_alloc();
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+void operator delete(void *ptr) noexcept
+{
+  free(ptr);
+}
+
 
 namespace ortc
 {
@@ -281,6 +313,35 @@ static BYTE gHeader5[] =
   0x10, 0x05, 0x00, 0x00
 };
 
+// one byte element claims more data than the extension holds
+static BYTE gBadHeader1[] =
+{
+  0xBE, 0xDE, 0x00, 0x01,
+  0xE3, 0x77, 0x00, 0x00
+};
+
+// two byte element claims more data than the extension holds
+static BYTE gBadHeader2[] =
+{
+  0x10, 0x00, 0x00, 0x01,
+  0x04, 0x09, 0x41, 0x42
+};
+
+// profile is neither one byte nor two byte
+static BYTE gBadHeader3[] =
+{
+  0x12, 0x34, 0x00, 0x01,
+  0x04, 0x01, 0x41, 0x00
+};
+
+// valid element (parsed before the failure) followed by a one byte element that overruns
+static BYTE gBadHeader4[] =
+{
+  0xBE, 0xDE, 0x00, 0x02,
+  0x10, 0x55, 0x00, 0x24,
+  0x11, 0x22, 0x00, 0x00
+};
+
 void doTestRTPPacket()
 {
   if (!ORTC_TEST_DO_RTP_PACKET_TEST) return;
@@ -1022,6 +1083,295 @@ void doTestRTPPacket()
                 break;
               }
               case 7: {
+                const char *payload = "ABCDEFG";
+                auto tempPacket = Tester::createPacket(2, 0, 0, false, 96, 1, 1024, 5, NULL, &gHeader3[0], sizeof(gHeader3), payload);
+
+                const BYTE *start = tempPacket->BytePtr();
+                const BYTE *end = start + tempPacket->SizeInBytes();
+
+                auto packet = RTPPacket::createView(tempPacket->BytePtr(), tempPacket->SizeInBytes());
+                TESTING_CHECK(packet)
+
+                TESTING_CHECK(packet->isView())
+                TESTING_CHECK(start == packet->ptr())
+                TESTING_EQUAL(tempPacket->SizeInBytes(), packet->size())
+                TESTING_EQUAL(3, packet->totalHeaderExtensions())
+
+                for (auto ext = packet->firstHeaderExtension(); NULL != ext; ext = ext->mNext) {
+                  TESTING_CHECK((ext->mData >= start) && (ext->mData < end))
+                }
+
+                packet->materialize();
+
+                TESTING_CHECK(!packet->isView())
+                TESTING_CHECK(start != packet->ptr())
+                TESTING_EQUAL(0, UseServicesHelper::compare(*tempPacket, *(packet->buffer())))
+
+                const BYTE *newStart = packet->ptr();
+                const BYTE *newEnd = newStart + packet->size();
+                for (auto ext = packet->firstHeaderExtension(); NULL != ext; ext = ext->mNext) {
+                  TESTING_CHECK((ext->mData >= newStart) && (ext->mData < newEnd))
+                }
+
+                // heap allocations made per parsed packet (copy vs. view);
+                // the copy's packet bytes come from the SecureByteBlock
+                // allocator which is not counted but is always paired with
+                // the counted make_shared of the SecureByteBlock itself
+                const size_t totalIterations = 100000;
+
+                size_t copyAllocations = 0;
+                size_t viewAllocations = 0;
+
+                zsLib::Time copyStart = zsLib::now();
+                gCountedAllocations = 0;
+                gCountAllocations = true;
+                for (size_t loop = 0; loop < totalIterations; ++loop) {
+                  auto copy = RTPPacket::create(tempPacket->BytePtr(), tempPacket->SizeInBytes());
+                }
+                gCountAllocations = false;
+                copyAllocations = gCountedAllocations;
+
+                zsLib::Time viewStart = zsLib::now();
+                gCountedAllocations = 0;
+                gCountAllocations = true;
+                for (size_t loop = 0; loop < totalIterations; ++loop) {
+                  auto view = RTPPacket::createView(tempPacket->BytePtr(), tempPacket->SizeInBytes());
+                }
+                gCountAllocations = false;
+                viewAllocations = gCountedAllocations;
+                zsLib::Time viewEnd = zsLib::now();
+
+                // a view skips at least the buffer copy (the packet object and
+                // the header extension table are still allocated)
+                TESTING_CHECK(copyAllocations >= viewAllocations + totalIterations)
+
+                TESTING_STDOUT() << "BENCHMARK:    RTP parse (copy) [" << totalIterations << "] packets, heap allocations per packet [" << (static_cast<double>(copyAllocations) / totalIterations) << "], took [" << zsLib::toMilliseconds(viewStart - copyStart).count() << "ms]\n";
+                TESTING_STDOUT() << "BENCHMARK:    RTP parse (view) [" << totalIterations << "] packets, heap allocations per packet [" << (static_cast<double>(viewAllocations) / totalIterations) << "], took [" << zsLib::toMilliseconds(viewEnd - viewStart).count() << "ms]\n";
+                break;
+              }
+              case 8: {
+                const char *payload = "ABCDEFG";
+                auto tempPacket = Tester::createPacket(2, 0, 0, false, 96, 1, 1024, 5, NULL, &gHeader3[0], sizeof(gHeader3), payload);
+
+                auto packet = RTPPacket::create(tempPacket->BytePtr(), tempPacket->SizeInBytes(), RTPPacket::kHeaderExtensionHeadroom, 0);
+                TESTING_CHECK(packet)
+                TESTING_EQUAL(static_cast<size_t>(RTPPacket::kHeaderExtensionHeadroom), packet->headroom())
+                TESTING_EQUAL(0, packet->tailroom())
+
+                auto allocation = packet->mBuffer.get();
+                const BYTE *payloadPos = packet->payload();
+
+                packet->changeSSRC(0x12345678);
+                packet->changeSequenceNumber(0xABCD);
+                packet->changeTimestamp(0x87654321);
+                packet->changePT(111);
+                packet->changeM(true);
+
+                {
+                  auto reparsed = RTPPacket::create(packet->ptr(), packet->size());
+                  TESTING_CHECK(reparsed)
+                  TESTING_EQUAL(0x12345678, reparsed->ssrc())
+                  TESTING_EQUAL(0xABCD, reparsed->sequenceNumber())
+                  TESTING_EQUAL(0x87654321, reparsed->timestamp())
+                  TESTING_EQUAL(111, reparsed->pt())
+                  TESTING_CHECK(reparsed->m())
+                }
+
+                // fixed size extension values are patched where they sit
+                {
+                  BYTE value[2] = {0x11, 0x22};
+                  TESTING_CHECK(packet->changeHeaderExtensionValue(13, &value[0], sizeof(value)))
+                  TESTING_CHECK(!packet->changeHeaderExtensionValue(13, &value[0], 1))
+                  TESTING_CHECK(!packet->changeHeaderExtensionValue(1, &value[0], sizeof(value)))
+
+                  auto reparsed = RTPPacket::create(packet->ptr(), packet->size());
+                  TESTING_CHECK(reparsed)
+                  auto ext = reparsed->getHeaderExtensionAtIndex(1);
+                  TESTING_CHECK(ext)
+                  TESTING_EQUAL(13, ext->mID)
+                  TESTING_EQUAL(0x11, ext->mData[0])
+                  TESTING_EQUAL(0x22, ext->mData[1])
+                }
+
+                // MID tagging grows the extension into the headroom
+                RTPPacket::StringHeaderExtension midHeader(1, "a1");
+
+                RTPPacketPtr expected;
+                {
+                  // regenerated into a new buffer for comparison
+                  auto oldHeaderExtensions = packet->mHeaderExtensions;
+                  midHeader.mNext = oldHeaderExtensions;
+                  packet->mHeaderExtensions = &midHeader;
+                  expected = RTPPacket::create(*packet);
+                  packet->mHeaderExtensions = oldHeaderExtensions;
+                }
+
+                packet->changeHeaderExtensions(&midHeader);
+
+                TESTING_CHECK(allocation == packet->mBuffer.get())
+                TESTING_CHECK(payloadPos == packet->payload())
+                TESTING_EQUAL(4, packet->totalHeaderExtensions())
+                TESTING_EQUAL(expected->size(), packet->size())
+                TESTING_EQUAL(0, memcmp(expected->payload(), packet->payload(), strlen(payload)))
+
+                {
+                  auto reparsed = RTPPacket::create(packet->ptr(), packet->size());
+                  TESTING_CHECK(reparsed)
+                  TESTING_EQUAL(expected->totalHeaderExtensions(), reparsed->totalHeaderExtensions())
+                  for (size_t index = 0; index < expected->totalHeaderExtensions(); ++index) {
+                    auto expectedExt = expected->getHeaderExtensionAtIndex(index);
+                    auto ext = reparsed->getHeaderExtensionAtIndex(index);
+                    TESTING_EQUAL(expectedExt->mID, ext->mID)
+                    TESTING_EQUAL(expectedExt->mDataSizeInBytes, ext->mDataSizeInBytes)
+                    TESTING_EQUAL(0, memcmp(expectedExt->mData, ext->mData, ext->mDataSizeInBytes))
+                  }
+                  TESTING_EQUAL(expected->headerExtensionParseStoppedSize(), reparsed->headerExtensionParseStoppedSize())
+                }
+
+                {
+                  RTPPacket::StringHeaderExtension mid(*(packet->firstHeaderExtension()));
+                  TESTING_EQUAL(0, strcmp("a1", mid.str()))
+                }
+
+                // stripping returns the extension to the headroom
+                packet->mHeaderExtensionAppBits = 0;
+                packet->mHeaderExtensionPrepaddedSize = 0;
+                packet->mHeaderExtensionParseStoppedPos = NULL;
+                packet->mHeaderExtensionParseStoppedSize = 0;
+                packet->changeHeaderExtensions(NULL);
+
+                TESTING_CHECK(allocation == packet->mBuffer.get())
+                TESTING_CHECK(payloadPos == packet->payload())
+                TESTING_EQUAL(0, packet->headerExtensionSize())
+                TESTING_EQUAL(12 + strlen(payload), packet->size())
+
+                auto stripped = RTPPacket::create(packet->ptr(), packet->size());
+                TESTING_CHECK(stripped)
+                TESTING_EQUAL(0, stripped->totalHeaderExtensions())
+                TESTING_EQUAL(0x12345678, stripped->ssrc())
+                TESTING_EQUAL(0, memcmp(payload, stripped->payload(), strlen(payload)))
+
+                // reserved tailroom survives in place changes and buffer() hands out an exact copy
+                {
+                  auto roomPacket = RTPPacket::create(tempPacket->BytePtr(), tempPacket->SizeInBytes(), 4, 18);
+                  TESTING_CHECK(roomPacket)
+                  TESTING_EQUAL(4, roomPacket->headroom())
+                  TESTING_EQUAL(18, roomPacket->tailroom())
+                  TESTING_CHECK(roomPacket->ptr() == roomPacket->writablePtr())
+
+                  roomPacket->mHeaderExtensionAppBits = 0;
+                  roomPacket->mHeaderExtensionPrepaddedSize = 0;
+                  roomPacket->mHeaderExtensionParseStoppedPos = NULL;
+                  roomPacket->mHeaderExtensionParseStoppedSize = 0;
+                  roomPacket->changeHeaderExtensions(NULL);
+                  TESTING_EQUAL(18, roomPacket->tailroom())
+
+                  auto exact = roomPacket->buffer();
+                  TESTING_EQUAL(roomPacket->size(), exact->SizeInBytes())
+                  TESTING_EQUAL(0, memcmp(roomPacket->ptr(), exact->BytePtr(), roomPacket->size()))
+                  TESTING_CHECK(exact->BytePtr() != roomPacket->ptr())
+                  TESTING_EQUAL(18, roomPacket->tailroom())
+                }
+                break;
+              }
+              case 9: {
+                const char *payload = "ABCDEFG";
+                auto tempPacket = Tester::createPacket(2, 0, 0, false, 96, 1, 1024, 5, NULL, &gHeader3[0], sizeof(gHeader3), payload);
+
+                auto packet = RTPPacket::createView(tempPacket->BytePtr(), tempPacket->SizeInBytes());
+                TESTING_CHECK(packet)
+
+                // extensions are parsed when the view is created but the
+                // lookup table is only filled when a lookup needs it
+                TESTING_CHECK(packet->isView())
+                TESTING_CHECK(NULL != packet->mHeaderExtensions)
+                TESTING_EQUAL(3, packet->mTotalHeaderExtensions)
+                TESTING_CHECK(!packet->mHeaderExtensionLookupFilled)
+                TESTING_EQUAL(strlen(payload), packet->payloadSize())
+                TESTING_EQUAL(0, memcmp(payload, packet->payload(), strlen(payload)))
+
+                // buffer() copies rather than materializing the view behind the caller's back
+                {
+                  auto copy = packet->buffer();
+                  TESTING_CHECK(copy)
+                  TESTING_EQUAL(tempPacket->SizeInBytes(), copy->SizeInBytes())
+                  TESTING_CHECK(packet->isView())
+                  TESTING_CHECK(tempPacket->BytePtr() == packet->ptr())
+                }
+
+                {
+                  auto ext = packet->findHeaderExtension(12);
+                  TESTING_CHECK(ext)
+                  TESTING_EQUAL(4, ext->mDataSizeInBytes)
+                  TESTING_EQUAL(0x99, ext->mData[0])
+                  TESTING_EQUAL(0xCC, ext->mData[3])
+                  TESTING_EQUAL(packet->getHeaderExtensionAtIndex(2), ext)
+                }
+                {
+                  auto ext = packet->findHeaderExtension(13);
+                  TESTING_CHECK(ext)
+                  TESTING_EQUAL(2, ext->mDataSizeInBytes)
+                  TESTING_EQUAL(packet->getHeaderExtensionAtIndex(1), ext)
+                }
+                {
+                  auto ext = packet->findHeaderExtension(14);
+                  TESTING_CHECK(ext)
+                  TESTING_EQUAL(0x77, ext->mData[0])
+                  TESTING_EQUAL(packet->getHeaderExtensionAtIndex(0), ext)
+                }
+                TESTING_CHECK(NULL == packet->findHeaderExtension(1))
+                TESTING_CHECK(NULL == packet->findHeaderExtension(0xFF))
+                TESTING_EQUAL(3, packet->totalHeaderExtensions())
+
+                // a few extensions are scanned without filling the table
+                TESTING_CHECK(!packet->mHeaderExtensionLookupFilled)
+
+                // changing the extensions refreshes the table
+                packet->materialize();
+
+                RTPPacket::StringHeaderExtension midHeader(1, "a1");
+                midHeader.mNext = packet->firstHeaderExtension();
+                packet->changeHeaderExtensions(&midHeader);
+
+                TESTING_CHECK(!packet->mHeaderExtensionLookupFilled)
+                {
+                  auto ext = packet->findHeaderExtension(1);
+                  TESTING_CHECK(packet->mHeaderExtensionLookupFilled)
+                  TESTING_EQUAL(1, packet->mHeaderExtensionLookup[1])
+                  TESTING_EQUAL(4, packet->mHeaderExtensionLookup[12])
+                  TESTING_EQUAL(0, packet->mHeaderExtensionLookup[2])
+                  TESTING_CHECK(ext)
+                  RTPPacket::StringHeaderExtension mid(*ext);
+                  TESTING_EQUAL(0, strcmp("a1", mid.str()))
+                  TESTING_EQUAL(packet->getHeaderExtensionAtIndex(3), packet->findHeaderExtension(12))
+                }
+                break;
+              }
+              case 10: {
+                const char *payload = "ABCDEFG";
+
+                // every malformed extension is rejected by both the owning and the view parse
+                BYTE *malformed[] = {&gBadHeader1[0], &gBadHeader2[0], &gBadHeader3[0], &gBadHeader4[0]};
+                size_t malformedSizes[] = {sizeof(gBadHeader1), sizeof(gBadHeader2), sizeof(gBadHeader3), sizeof(gBadHeader4)};
+
+                for (size_t index = 0; index < (sizeof(malformedSizes) / sizeof(malformedSizes[0])); ++index) {
+                  auto tempPacket = Tester::createPacket(2, 0, 0, false, 96, 1, 1024, 5, NULL, malformed[index], malformedSizes[index], payload);
+
+                  TESTING_CHECK(!RTPPacket::create(*tempPacket))
+                  TESTING_CHECK(!RTPPacket::create(tempPacket->BytePtr(), tempPacket->SizeInBytes(), 4, 16))
+                  TESTING_CHECK(!RTPPacket::createView(tempPacket->BytePtr(), tempPacket->SizeInBytes()))
+                }
+
+                // a valid packet parsed after a rejected one is unaffected
+                {
+                  auto tempPacket = Tester::createPacket(2, 0, 0, false, 96, 1, 1024, 5, NULL, &gHeader2[0], sizeof(gHeader2), payload);
+                  auto packet = RTPPacket::createView(tempPacket->BytePtr(), tempPacket->SizeInBytes());
+                  TESTING_CHECK(packet)
+                  TESTING_CHECK(NULL != packet->findHeaderExtension(14))
+                }
+                break;
+              }
+              case 11: {
                 reachedFinalStep = true;
                 break;
               }
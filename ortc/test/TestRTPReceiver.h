@@ -498,6 +498,7 @@ namespace ortc
         //---------------------------------------------------------------------
         bool handleReceivedPacket(
                                   IICETypes::Components component,
+                                  ortc::internal::PacketDemux::PacketTypes packetType,
                                   const BYTE *buffer,
                                   size_t bufferSizeInBytes
                                   ) override;
@@ -348,7 +348,7 @@ namespace ortc
 
         ZS_LOG_DEBUG(log("packet received") + ZS_PARAM("buffer", (PTRNUMBER)(buffer->BytePtr())) + ZS_PARAM("buffer size", buffer->SizeInBytes()))
 
-        transport->handleReceivedPacket(mComponent, buffer->BytePtr(), buffer->SizeInBytes());
+        transport->handleReceivedPacket(mComponent, ortc::internal::PacketDemux::classify(buffer->BytePtr(), buffer->SizeInBytes()), buffer->BytePtr(), buffer->SizeInBytes());
       }
 
       //-----------------------------------------------------------------------
@@ -413,7 +413,7 @@ namespace ortc
 
           ZS_LOG_DEBUG(log("packet received (after delay)") + ZS_PARAM("buffer", (PTRNUMBER)(buffer->BytePtr())) + ZS_PARAM("buffer size", buffer->SizeInBytes()))
 
-          transport->handleReceivedPacket(mComponent, buffer->BytePtr(), buffer->SizeInBytes());
+          transport->handleReceivedPacket(mComponent, ortc::internal::PacketDemux::classify(buffer->BytePtr(), buffer->SizeInBytes()), buffer->BytePtr(), buffer->SizeInBytes());
         }
       }
 
@@ -707,6 +707,7 @@ namespace ortc
       //-----------------------------------------------------------------------
       bool FakeSecureTransport::handleReceivedPacket(
                                                      IICETypes::Components component,
+                                                     ortc::internal::PacketDemux::PacketTypes packetType,
                                                      const BYTE *buffer,
                                                      size_t bufferSizeInBytes
                                                      )
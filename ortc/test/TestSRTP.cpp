@@ -376,7 +376,7 @@ namespace ortc
 
           ZS_LOG_DEBUG(log("packet received") + ZS_PARAM("buffer", (PTRNUMBER)(buffer->BytePtr())) + ZS_PARAM("buffer size", buffer->SizeInBytes()))
 
-          transport->handleReceivedPacket(sendOverICETransport, buffer->BytePtr(), buffer->SizeInBytes());
+          transport->handleReceivedPacket(sendOverICETransport, ortc::internal::PacketDemux::classify(buffer->BytePtr(), buffer->SizeInBytes()), buffer->BytePtr(), buffer->SizeInBytes());
         }
 
       protected:
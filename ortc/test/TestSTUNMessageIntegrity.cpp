@@ -0,0 +1,247 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/MessageQueueThread.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_STUNMessageIntegrity.h>
+
+#include <openpeer/services/STUNPacket.h>
+
+#include "config.h"
+#include "testing.h"
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::BYTE;
+using zsLib::ULONG;
+using zsLib::ULONGLONG;
+
+using openpeer::services::STUNPacket;
+using openpeer::services::STUNPacketPtr;
+using openpeer::services::SecureByteBlockPtr;
+using ortc::internal::STUNMessageIntegrity;
+using ortc::internal::STUNMessageIntegrityPtr;
+
+#define TEST_BASIC_STUN_MESSAGE_INTEGRITY 0
+
+static STUNPacketPtr createSignedBindingRequest(const char *password)
+{
+  STUNPacketPtr stunPacket = STUNPacket::createRequest(STUNPacket::Method_Binding);
+  stunPacket->mFingerprintIncluded = true;
+  stunPacket->mPriorityIncluded = true;
+  stunPacket->mPriority = 0x6E0001FF;
+  stunPacket->mIceControllingIncluded = true;
+  stunPacket->mIceControlling = 0x0102030405060708ULL;
+  stunPacket->mCredentialMechanism = STUNPacket::CredentialMechanisms_ShortTerm;
+  stunPacket->mUsername = "remoteFrag:localFrag";
+  stunPacket->mPassword = password;
+  return stunPacket;
+}
+
+static STUNPacketPtr parse(const SecureByteBlockPtr &buffer)
+{
+  return STUNPacket::parseIfSTUN(buffer->BytePtr(), buffer->SizeInBytes(), STUNPacket::ParseOptions(STUNPacket::RFC_AllowAll, false, "TestSTUNMessageIntegrity", 0));
+}
+
+void doTestSTUNMessageIntegrity()
+{
+  if (!ORTC_TEST_DO_STUN_MESSAGE_INTEGRITY_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for STUN message integrity testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_STUN_MESSAGE_INTEGRITY: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_STUN_MESSAGE_INTEGRITY: {
+            switch (step) {
+              case 1: {
+                // validation agrees with the full STUN parser
+                const char *password = "0123456789abcdefghijkl";
+                STUNMessageIntegrityPtr integrity = STUNMessageIntegrity::create(password);
+                STUNMessageIntegrityPtr wrongIntegrity = STUNMessageIntegrity::create("somethingelsealtogether");
+                TESTING_EQUAL(password, integrity->password())
+
+                SecureByteBlockPtr buffer = createSignedBindingRequest(password)->packetize(STUNPacket::RFC_5245_ICE);
+                TESTING_CHECK(buffer)
+
+                STUNPacketPtr parsed = parse(buffer);
+                TESTING_CHECK(parsed)
+                TESTING_CHECK(parsed->isValidMessageIntegrity(password))
+
+                TESTING_CHECK(integrity->isValid(buffer->BytePtr(), buffer->SizeInBytes()))
+                TESTING_CHECK(!wrongIntegrity->isValid(buffer->BytePtr(), buffer->SizeInBytes()))
+
+                // flip a bit inside the signed region
+                buffer->BytePtr()[STUNMessageIntegrity::Size_Header + 5] ^= 0x01;
+                TESTING_CHECK(!integrity->isValid(buffer->BytePtr(), buffer->SizeInBytes()))
+
+                // truncated buffers must never validate
+                TESTING_CHECK(!integrity->isValid(buffer->BytePtr(), STUNMessageIntegrity::Size_Header))
+                TESTING_CHECK(!integrity->isValid(buffer->BytePtr(), 0))
+                break;
+              }
+              case 2: {
+                // packets signed with the cached state are accepted by the full STUN parser
+                const char *password = "0123456789abcdefghijkl";
+                STUNMessageIntegrityPtr integrity = STUNMessageIntegrity::create(password);
+
+                STUNPacketPtr request = parse(createSignedBindingRequest("remotepassword0123456789")->packetize(STUNPacket::RFC_5245_ICE));
+                TESTING_CHECK(request)
+
+                STUNPacketPtr response = STUNPacket::createResponse(request);
+                response->mFingerprintIncluded = true;
+                response->mMappedAddress = zsLib::IPAddress("192.168.1.10:5000");
+                response->mCredentialMechanism = STUNPacket::CredentialMechanisms_ShortTerm;
+                response->mUsername = request->mUsername;
+                response->mPassword = password;
+
+                SecureByteBlockPtr signedBuffer = integrity->packetize(response);
+                TESTING_CHECK(signedBuffer)
+                TESTING_EQUAL(STUNPacket::CredentialMechanisms_ShortTerm, response->mCredentialMechanism)   // restored after signing
+                TESTING_CHECK(response->mFingerprintIncluded)
+
+                SecureByteBlockPtr libraryBuffer = response->packetize(STUNPacket::RFC_5245_ICE);
+                TESTING_CHECK(libraryBuffer)
+                TESTING_EQUAL(libraryBuffer->SizeInBytes(), signedBuffer->SizeInBytes())
+                TESTING_CHECK(0 == memcmp(libraryBuffer->BytePtr(), signedBuffer->BytePtr(), signedBuffer->SizeInBytes()))
+
+                STUNPacketPtr parsed = parse(signedBuffer);
+                TESTING_CHECK(parsed)
+                TESTING_CHECK(parsed->isValidMessageIntegrity(password))
+                TESTING_CHECK(integrity->isValid(signedBuffer->BytePtr(), signedBuffer->SizeInBytes()))
+                break;
+              }
+              case 3: {
+                // throughput of validating and signing with and without the cached HMAC state
+                static const size_t kTotalPackets = 100000;
+                const char *password = "0123456789abcdefghijkl";
+                STUNMessageIntegrityPtr integrity = STUNMessageIntegrity::create(password);
+
+                STUNPacketPtr request = createSignedBindingRequest(password);
+                SecureByteBlockPtr buffer = request->packetize(STUNPacket::RFC_5245_ICE);
+                TESTING_CHECK(buffer)
+
+                ULONGLONG totalValid = 0;
+
+                zsLib::Time start = zsLib::now();
+                for (size_t loop = 0; loop < kTotalPackets; ++loop) {
+                  STUNPacketPtr parsed = parse(buffer);
+                  if ((parsed) && (parsed->isValidMessageIntegrity(password))) ++totalValid;
+                }
+                zsLib::Time middle = zsLib::now();
+                for (size_t loop = 0; loop < kTotalPackets; ++loop) {
+                  STUNPacketPtr parsed = parse(buffer);
+                  if ((parsed) && (integrity->isValid(buffer->BytePtr(), buffer->SizeInBytes()))) ++totalValid;
+                }
+                zsLib::Time end = zsLib::now();
+
+                TESTING_EQUAL(kTotalPackets * 2, totalValid)
+
+                TESTING_STDOUT() << "BENCHMARK:    [" << kTotalPackets << "] validations, STUN packet took [" << zsLib::toMilliseconds(middle - start).count() << "ms], cached HMAC took [" << zsLib::toMilliseconds(end - middle).count() << "ms]\n";
+
+                size_t totalBytes = 0;
+
+                start = zsLib::now();
+                for (size_t loop = 0; loop < kTotalPackets; ++loop) {
+                  totalBytes += request->packetize(STUNPacket::RFC_5245_ICE)->SizeInBytes();
+                }
+                middle = zsLib::now();
+                for (size_t loop = 0; loop < kTotalPackets; ++loop) {
+                  totalBytes -= integrity->packetize(request)->SizeInBytes();
+                }
+                end = zsLib::now();
+
+                TESTING_EQUAL(0, totalBytes)
+
+                TESTING_STDOUT() << "BENCHMARK:    [" << kTotalPackets << "] signings, STUN packet took [" << zsLib::toMilliseconds(middle - start).count() << "ms], cached HMAC took [" << zsLib::toMilliseconds(end - middle).count() << "ms]\n";
+                break;
+              }
+              case 4: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All STUN message integrity tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -0,0 +1,306 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/Socket.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_SocketReactor.h>
+
+#include <openpeer/services/ISettings.h>
+
+#include "config.h"
+#include "testing.h"
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::BYTE;
+using zsLib::ULONG;
+using zsLib::IPAddress;
+using zsLib::Socket;
+using zsLib::SocketPtr;
+using zsLib::ISocketDelegate;
+using zsLib::Lock;
+using zsLib::AutoLock;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace socket_reactor
+    {
+      ZS_DECLARE_TYPEDEF_PTR(openpeer::services::ISettings, UseSettings)
+      ZS_DECLARE_TYPEDEF_PTR(ortc::internal::SocketReactor, SocketReactor)
+
+      ZS_DECLARE_CLASS_PTR(FakeDelegate)
+
+      //-----------------------------------------------------------------------
+      // counts the readiness events dispatched from a reactor loop
+      class FakeDelegate : public ISocketDelegate
+      {
+      public:
+        static FakeDelegatePtr create() {return std::make_shared<FakeDelegate>();}
+
+        virtual void onReadReady(SocketPtr socket) override
+        {
+          // edge triggered thus drain until the socket would block
+          size_t read = 0;
+          while (true) {
+            BYTE buffer[1500] {};
+            IPAddress fromIP;
+            bool wouldBlock = false;
+            try {
+              if (0 == socket->receiveFrom(fromIP, &(buffer[0]), sizeof(buffer), &wouldBlock)) break;
+            } catch(Socket::Exceptions::Unspecified &) {
+              break;
+            }
+            if (wouldBlock) break;
+            ++read;
+          }
+
+          AutoLock lock(mLock);
+          ++mReadReady;
+          mDatagrams += read;
+        }
+
+        virtual void onWriteReady(SocketPtr socket) override
+        {
+          AutoLock lock(mLock);
+          ++mWriteReady;
+        }
+
+        virtual void onException(SocketPtr socket) override
+        {
+          AutoLock lock(mLock);
+          ++mExceptions;
+        }
+
+        size_t readReady() const    {AutoLock lock(mLock); return mReadReady;}
+        size_t datagrams() const    {AutoLock lock(mLock); return mDatagrams;}
+        size_t writeReady() const   {AutoLock lock(mLock); return mWriteReady;}
+        size_t exceptions() const   {AutoLock lock(mLock); return mExceptions;}
+
+      protected:
+        mutable Lock mLock;
+        size_t mReadReady {};
+        size_t mDatagrams {};
+        size_t mWriteReady {};
+        size_t mExceptions {};
+      };
+
+      //-----------------------------------------------------------------------
+      static SocketPtr createLoopbackSocket()
+      {
+        SocketPtr socket = Socket::createUDP(Socket::Create::IPv4);
+        socket->bind(IPAddress("127.0.0.1", 0));
+        socket->setBlocking(false);
+        return socket;
+      }
+
+      //-----------------------------------------------------------------------
+      static void sendData(
+                           SocketPtr from,
+                           const IPAddress &to,
+                           size_t total
+                           )
+      {
+        BYTE buffer[100] {};
+        for (size_t index = 0; index < total; ++index) {
+          bool wouldBlock = false;
+          from->sendTo(to, &(buffer[0]), sizeof(buffer), &wouldBlock);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      // RETURNS: true once the counter reaches "expecting" (false if it did
+      //          not in time or went past it)
+      template <typename Counter>
+      static bool waitFor(
+                          Counter counter,
+                          size_t expecting
+                          )
+      {
+        zsLib::Time giveUp = zsLib::now() + zsLib::Seconds(2);
+        while (zsLib::now() < giveUp) {
+          size_t value = counter();
+          if (value >= expecting) return value == expecting;
+          TESTING_SLEEP(10)
+        }
+        return false;
+      }
+    }
+  }
+}
+
+using namespace ortc::test::socket_reactor;
+
+#define TEST_BASIC_SOCKET_REACTOR 0
+
+void doTestSocketReactor()
+{
+  if (!ORTC_TEST_DO_SOCKET_REACTOR_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  // the reactor reads its thread settings once (when first used)
+  UseSettings::setBool(ORTC_SETTING_SOCKET_REACTOR_ENABLED, true);
+  UseSettings::setUInt(ORTC_SETTING_SOCKET_REACTOR_TOTAL_THREADS, 2);
+
+  TESTING_STDOUT() << "WAITING:      Waiting for socket reactor testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    FakeDelegatePtr delegateA = FakeDelegate::create();
+    FakeDelegatePtr delegateB = FakeDelegate::create();
+
+    SocketPtr socketA = createLoopbackSocket();
+    SocketPtr socketB = createLoopbackSocket();
+
+    IPAddress socketAIP = socketA->getLocalAddress();
+    IPAddress socketBIP = socketB->getLocalAddress();
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_SOCKET_REACTOR: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_SOCKET_REACTOR: {
+            switch (step) {
+              case 1: {
+                // registered sockets land on different loops yet both report
+                // their reads (and nothing else) to their own delegate
+                TESTING_CHECK(SocketReactor::isEnabled())
+                TESTING_CHECK(SocketReactor::monitor(socketA, delegateA))
+                TESTING_CHECK(SocketReactor::monitor(socketB, delegateB))
+
+                sendData(socketB, socketAIP, 3);
+                TESTING_CHECK(waitFor([&]() {return delegateA->datagrams();}, 3))
+
+                sendData(socketA, socketBIP, 2);
+                TESTING_CHECK(waitFor([&]() {return delegateB->datagrams();}, 2))
+
+                TESTING_CHECK(delegateA->readReady() > 0)
+                TESTING_CHECK(delegateB->readReady() > 0)
+                TESTING_EQUAL(0, delegateA->writeReady())
+                TESTING_EQUAL(0, delegateB->writeReady())
+                TESTING_EQUAL(0, delegateA->exceptions())
+                TESTING_EQUAL(0, delegateB->exceptions())
+                break;
+              }
+              case 2: {
+                // write readiness is reported exactly once per request (an
+                // already writable socket reports straight away)
+                SocketReactor::monitorWriteReady(socketA);
+                TESTING_CHECK(waitFor([&]() {return delegateA->writeReady();}, 1))
+
+                sendData(socketB, socketAIP, 1);
+                TESTING_CHECK(waitFor([&]() {return delegateA->datagrams();}, 4))
+                TESTING_EQUAL(1, delegateA->writeReady())
+
+                SocketReactor::monitorWriteReady(socketA);
+                TESTING_CHECK(waitFor([&]() {return delegateA->writeReady();}, 2))
+                TESTING_EQUAL(0, delegateB->writeReady())
+                break;
+              }
+              case 3: {
+                // nothing is dispatched once a socket is unregistered
+                SocketReactor::unmonitor(socketA);
+
+                size_t readReady = delegateA->readReady();
+                sendData(socketB, socketAIP, 2);
+                SocketReactor::monitorWriteReady(socketA);
+                TESTING_SLEEP(250)
+
+                TESTING_EQUAL(readReady, delegateA->readReady())
+                TESTING_EQUAL(4, delegateA->datagrams())
+                TESTING_EQUAL(2, delegateA->writeReady())
+
+                // the other socket is unaffected
+                sendData(socketA, socketBIP, 1);
+                TESTING_CHECK(waitFor([&]() {return delegateB->datagrams();}, 3))
+                break;
+              }
+              case 4: {
+                SocketReactor::unmonitor(socketB);
+                socketA->close();
+                socketB->close();
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All socket reactor tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
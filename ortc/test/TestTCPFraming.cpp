@@ -0,0 +1,334 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc. / Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+
+#include <zsLib/Socket.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_TCPFraming.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::BYTE;
+using zsLib::ULONG;
+using zsLib::IPAddress;
+using zsLib::Socket;
+using zsLib::SocketPtr;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace tcp_framing
+    {
+      typedef ortc::internal::TCPFrameReader TCPFrameReader;
+      typedef ortc::internal::TCPFrameWriter TCPFrameWriter;
+
+      //-----------------------------------------------------------------------
+      static void createLoopbackPair(
+                                     SocketPtr &outClient,
+                                     SocketPtr &outServer
+                                     )
+      {
+        SocketPtr listenSocket = Socket::createTCP(Socket::Create::IPv4);
+        listenSocket->bind(IPAddress("127.0.0.1", 0));
+        listenSocket->listen();
+
+        outClient = Socket::createTCP(Socket::Create::IPv4);
+        outClient->connect(listenSocket->getLocalAddress());
+
+        IPAddress remoteIP;
+        outServer = listenSocket->accept(remoteIP);
+
+        outClient->setBlocking(false);
+        outServer->setBlocking(false);
+      }
+
+      //-----------------------------------------------------------------------
+      static void fillPacket(
+                             std::vector<BYTE> &outPacket,
+                             size_t size,
+                             size_t sequence
+                             )
+      {
+        outPacket.resize(size);
+        for (size_t index = 0; index < size; ++index) {
+          outPacket[index] = static_cast<BYTE>((sequence + index) & 0xFF);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      static size_t checkFrames(
+                                TCPFrameReader &reader,
+                                const std::vector<size_t> &sizes,
+                                size_t received
+                                )
+      {
+        auto &frames = reader.frames();
+        for (auto iter = frames.begin(); iter != frames.end(); ++iter) {
+          auto &frame = (*iter);
+          TESTING_CHECK(received < sizes.size())
+          if (received >= sizes.size()) break;
+
+          std::vector<BYTE> expecting;
+          fillPacket(expecting, sizes[received], received);
+
+          TESTING_EQUAL(sizes[received], frame.mSize)
+          TESTING_CHECK(0 == memcmp(frame.mBuffer, &(expecting[0]), frame.mSize))
+          ++received;
+        }
+        return received;
+      }
+    }
+  }
+}
+
+using namespace ortc::test::tcp_framing;
+
+#define TEST_BASIC_TCP_FRAMING 0
+
+void doTestTCPFraming()
+{
+  if (!ORTC_TEST_DO_TCP_FRAMING_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for TCP framing testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_TCP_FRAMING: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_TCP_FRAMING: {
+            switch (step) {
+              case 1: {
+                // small and maximum sized frames written in
+                // gathered batches arrive intact and in order
+                SocketPtr client;
+                SocketPtr server;
+                createLoopbackPair(client, server);
+
+                TCPFrameWriter writer;
+                TCPFrameReader reader;
+
+                std::vector<size_t> sizes;
+                for (size_t loop = 0; loop < 500; ++loop) {
+                  sizes.push_back(0 == (loop % 50) ? 0xFFFF : 1 + ((loop * 97) % 1400));
+                }
+
+                std::vector<BYTE> packet;
+                fillPacket(packet, 0x10000, 0);
+                TESTING_CHECK(!writer.add(&(packet[0]), packet.size()))
+                TESTING_EQUAL(0, writer.pending())
+
+                for (size_t index = 0; index < sizes.size(); ++index) {
+                  fillPacket(packet, sizes[index], index);
+                  TESTING_CHECK(writer.add(&(packet[0]), packet.size()))
+                }
+
+                size_t received = 0;
+                zsLib::Time giveUp = zsLib::now() + zsLib::Seconds(10);
+
+                while ((received < sizes.size()) &&
+                       (zsLib::now() < giveUp)) {
+                  bool wouldBlock = false;
+                  int errorCode = 0;
+                  if (writer.pending() > 0) {
+                    writer.flush(client, wouldBlock, errorCode);
+                    TESTING_EQUAL(0, errorCode)
+                  }
+
+                  while (reader.receive(server, wouldBlock, errorCode) > 0) {
+                    received = checkFrames(reader, sizes, received);
+                  }
+                  TESTING_EQUAL(0, errorCode)
+                }
+
+                TESTING_EQUAL(sizes.size(), received)
+                TESTING_EQUAL(0, writer.pending())
+                TESTING_EQUAL(0, reader.pending())
+                TESTING_CHECK(writer.counters().mSystemCalls < sizes.size())
+                break;
+              }
+              case 2: {
+                // a stream trickling in split at every possible point
+                // (including inside a length prefix) is reassembled
+                SocketPtr client;
+                SocketPtr server;
+                createLoopbackPair(client, server);
+
+                TCPFrameReader reader;
+
+                std::vector<size_t> sizes;
+                std::vector<BYTE> stream;
+                for (size_t index = 0; index < 300; ++index) {
+                  size_t size = (0 == (index % 30) ? 0xFFFF : 1 + ((index * 53) % 1500));
+                  sizes.push_back(size);
+
+                  std::vector<BYTE> packet;
+                  fillPacket(packet, size, index);
+                  stream.push_back(static_cast<BYTE>(size >> 8));
+                  stream.push_back(static_cast<BYTE>(size & 0xFF));
+                  stream.insert(stream.end(), packet.begin(), packet.end());
+                }
+
+                size_t received = 0;
+                size_t offset = 0;
+                size_t chunk = 1;
+                zsLib::Time giveUp = zsLib::now() + zsLib::Seconds(10);
+
+                while ((received < sizes.size()) &&
+                       (zsLib::now() < giveUp)) {
+                  if (offset < stream.size()) {
+                    size_t size = (stream.size() - offset < chunk ? stream.size() - offset : chunk);
+                    bool wouldBlock = false;
+                    offset += client->send(&(stream[offset]), size, &wouldBlock);
+                    chunk = (chunk * 7 + 3) % 3001;
+                  }
+
+                  bool wouldBlock = false;
+                  int errorCode = 0;
+                  while (reader.receive(server, wouldBlock, errorCode) > 0) {
+                    received = checkFrames(reader, sizes, received);
+                  }
+                  TESTING_EQUAL(0, errorCode)
+                }
+
+                TESTING_EQUAL(sizes.size(), received)
+                TESTING_EQUAL(0, reader.pending())
+                TESTING_STDOUT() << "INFO:         relocated bytes=" << reader.counters().mRelocatedBytes << " of " << reader.counters().mBytes << "\n";
+                break;
+              }
+              case 3: {
+                // loopback benchmark: ICE-TCP sized media packets
+                const size_t totalPackets = 200000;
+                const size_t burst = 32;
+                const size_t packetSize = 1200;
+
+                SocketPtr client;
+                SocketPtr server;
+                createLoopbackPair(client, server);
+
+                TCPFrameWriter writer;
+                TCPFrameReader reader;
+
+                std::vector<BYTE> packet;
+                fillPacket(packet, packetSize, 0);
+
+                size_t received = 0;
+                zsLib::Time start = zsLib::now();
+                for (size_t loop = 0; loop < totalPackets; loop += burst) {
+                  for (size_t index = 0; index < burst; ++index) {
+                    writer.add(&(packet[0]), packet.size());
+                  }
+
+                  bool wouldBlock = false;
+                  int errorCode = 0;
+                  while (writer.pending() > 0) {
+                    writer.flush(client, wouldBlock, errorCode);
+                    while (reader.receive(server, wouldBlock, errorCode) > 0) {
+                      received += reader.frames().size();
+                    }
+                    if (0 != errorCode) break;
+                  }
+                }
+                zsLib::Time end = zsLib::now();
+
+                auto duration = zsLib::toMilliseconds(end - start).count();
+                if (duration < 1) duration = 1;
+
+                TESTING_EQUAL(totalPackets, received)
+                TESTING_STDOUT() << "BENCHMARK:    packets=" << received << " packets/s=" << ((received * 1000) / duration) << " send syscalls/packet=" << (static_cast<double>(writer.counters().mSystemCalls) / static_cast<double>(received ? received : 1)) << " relocated bytes=" << reader.counters().mRelocatedBytes << "\n";
+                break;
+              }
+              case 4: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All TCP framing tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -0,0 +1,320 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/MessageQueueThread.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_TimerWheel.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <map>
+#include <vector>
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::DWORD;
+using zsLib::ULONG;
+using zsLib::Time;
+using zsLib::Milliseconds;
+using zsLib::Seconds;
+
+typedef ortc::internal::TimerWheel<DWORD> DWORDTimerWheel;
+
+#define TEST_BASIC_TIMER_WHEEL 0
+
+static DWORD nextRandom(DWORD &ioSeed)
+{
+  ioSeed = (ioSeed * 1664525UL) + 1013904223UL;
+  return ioSeed;
+}
+
+void doTestTimerWheel()
+{
+  if (!ORTC_TEST_DO_TIMER_WHEEL_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for timer wheel testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_TIMER_WHEEL: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_TIMER_WHEEL: {
+            switch (step) {
+              case 1: {
+                // basic add / fire / cancel
+                Time start = zsLib::now();
+                DWORDTimerWheel wheel(Milliseconds(10), start);
+                DWORDTimerWheel::ValueList fired;
+
+                TESTING_CHECK(wheel.empty())
+
+                auto first = wheel.add(start + Milliseconds(25), 1);
+                auto second = wheel.add(start + Milliseconds(100), 2);
+                auto third = wheel.add(start + Milliseconds(100), 3);
+                TESTING_CHECK(0 != first)
+                TESTING_CHECK(first != second)
+                TESTING_EQUAL(3, wheel.size())
+                TESTING_CHECK(wheel.isPending(first))
+
+                // never fires early
+                TESTING_EQUAL(0, wheel.advance(start + Milliseconds(20), fired))
+                TESTING_EQUAL(1, wheel.advance(start + Milliseconds(30), fired))
+                TESTING_EQUAL(1, fired.size())
+                TESTING_EQUAL(1, fired.front())
+                TESTING_CHECK(!wheel.isPending(first))
+                TESTING_CHECK(!wheel.cancel(first))                 // already fired
+
+                TESTING_CHECK(wheel.cancel(third))
+                TESTING_CHECK(!wheel.cancel(third))
+                TESTING_EQUAL(1, wheel.size())
+
+                // a stale ID must not cancel whichever timer reuses its entry
+                auto reused = wheel.add(start + Milliseconds(50), 4);
+                TESTING_CHECK(reused != third)
+                TESTING_CHECK(!wheel.cancel(third))
+                TESTING_CHECK(wheel.isPending(reused))
+
+                fired.clear();
+                TESTING_EQUAL(2, wheel.advance(start + Milliseconds(100), fired))
+                TESTING_EQUAL(4, fired[0])
+                TESTING_EQUAL(2, fired[1])
+                TESTING_CHECK(wheel.empty())
+
+                // already expired timers fire on the next advance
+                fired.clear();
+                wheel.add(start, 5);
+                TESTING_EQUAL(1, wheel.advance(start + Milliseconds(110), fired))
+                TESTING_EQUAL(5, fired.front())
+                break;
+              }
+              case 2: {
+                // randomized comparison against a sorted reference (including far timers which cascade through every level)
+                Time start = zsLib::now();
+                DWORDTimerWheel wheel(Milliseconds(1), start);
+                std::multimap<Time, DWORD> reference;
+                std::map<DWORD, DWORDTimerWheel::TimerID> timerIDs;
+                std::map<DWORD, std::multimap<Time, DWORD>::iterator> referenceIDs;
+
+                DWORD seed = 11;
+                for (DWORD value = 0; value < 20000; ++value) {
+                  DWORD range = (0 == (value % 50) ? 40000000 : 100000);     // some timers beyond the span of the wheel
+                  Time expires = start + Milliseconds(nextRandom(seed) % range);
+                  timerIDs[value] = wheel.add(expires, value);
+                  referenceIDs[value] = reference.insert(std::make_pair(expires, value));
+                }
+
+                for (DWORD value = 0; value < 20000; value += 3) {
+                  TESTING_CHECK(wheel.cancel(timerIDs[value]))
+                  reference.erase(referenceIDs[value]);
+                }
+                TESTING_EQUAL(reference.size(), wheel.size())
+
+                Time now = start;
+                while (!reference.empty()) {
+                  now += Milliseconds(1 + (nextRandom(seed) % 5000));
+
+                  DWORDTimerWheel::ValueList fired;
+                  wheel.advance(now, fired);
+
+                  size_t expected = 0;
+                  for (auto iter = reference.begin(); iter != reference.end(); ) {
+                    if ((*iter).first > now) break;
+                    ++expected;
+                    iter = reference.erase(iter);
+                  }
+                  TESTING_EQUAL(expected, fired.size())
+                  TESTING_EQUAL(reference.size(), wheel.size())
+                }
+                TESTING_CHECK(wheel.empty())
+                break;
+              }
+              case 3: {
+                // an owner only waking up at nextWakeUp() never fires a timer
+                // more than one resolution late and sleeps through empty slots
+                Time start = zsLib::now();
+                DWORDTimerWheel wheel(Milliseconds(20), start);
+                std::multimap<Time, DWORD> reference;
+
+                TESTING_CHECK(Time() == wheel.nextWakeUp())
+
+                DWORD seed = 7;
+                for (DWORD value = 0; value < 500; ++value) {
+                  DWORD range = (0 == (value % 25) ? 10000000 : 60000);
+                  Time expires = start + Milliseconds(nextRandom(seed) % range);
+                  wheel.add(expires, value);
+                  reference.insert(std::make_pair(expires, value));
+                }
+
+                size_t wakeUps = 0;
+                while (!reference.empty()) {
+                  Time wakeUp = wheel.nextWakeUp();
+                  TESTING_CHECK(Time() != wakeUp)
+                  TESTING_CHECK(wakeUp <= (*reference.begin()).first + wheel.resolution())
+                  if (Time() == wakeUp) break;
+
+                  ++wakeUps;
+
+                  DWORDTimerWheel::ValueList fired;
+                  wheel.advance(wakeUp, fired);
+
+                  size_t expected = 0;
+                  for (auto iter = reference.begin(); iter != reference.end(); ) {
+                    if ((*iter).first > wakeUp) break;
+                    ++expected;
+                    iter = reference.erase(iter);
+                  }
+                  TESTING_EQUAL(expected, fired.size())
+
+                  // an earlier timer added between wake ups moves the wake up
+                  if (0 == (wakeUps % 50)) {
+                    Time expires = wakeUp + Milliseconds(1 + (nextRandom(seed) % 100));
+                    wheel.add(expires, 0);
+                    reference.insert(std::make_pair(expires, 0));
+                    TESTING_CHECK(wheel.nextWakeUp() <= expires + wheel.resolution())
+                  }
+                }
+                TESTING_CHECK(wheel.empty())
+                TESTING_CHECK(Time() == wheel.nextWakeUp())
+
+                // far fewer wake ups than a repeating timer at the resolution
+                TESTING_CHECK(wakeUps < static_cast<size_t>(zsLib::toMilliseconds(Seconds(10000)).count() / wheel.resolution().count()) / 100)
+                TESTING_STDOUT() << "INFO:         [" << wakeUps << "] wake ups for 500 timers\n";
+                break;
+              }
+              case 4: {
+                // add / cancel cost should not grow with the number of pending timers
+                static const size_t kTotalOperations = 1000000;
+                static const size_t kTimerCounts[] = {10, 1000, 100000, 0};
+
+                for (size_t index = 0; 0 != kTimerCounts[index]; ++index) {
+                  size_t totalTimers = kTimerCounts[index];
+
+                  Time start = zsLib::now();
+                  DWORDTimerWheel wheel(Milliseconds(20), start);
+                  std::multimap<Time, DWORD> tree;
+
+                  std::vector<DWORDTimerWheel::TimerID> wheelIDs;
+                  std::vector<std::multimap<Time, DWORD>::iterator> treeIDs;
+
+                  DWORD seed = static_cast<DWORD>(totalTimers);
+                  for (size_t loop = 0; loop < totalTimers; ++loop) {
+                    Time expires = start + Milliseconds(4000 + (nextRandom(seed) % 2000));
+                    wheelIDs.push_back(wheel.add(expires, static_cast<DWORD>(loop)));
+                    treeIDs.push_back(tree.insert(std::make_pair(expires, static_cast<DWORD>(loop))));
+                  }
+
+                  // reschedule keep warm style timers
+                  zsLib::Time begin = zsLib::now();
+                  for (size_t loop = 0; loop < kTotalOperations; ++loop) {
+                    size_t which = loop % totalTimers;
+                    tree.erase(treeIDs[which]);
+                    treeIDs[which] = tree.insert(std::make_pair(start + Milliseconds(4000 + (loop % 2000)), static_cast<DWORD>(which)));
+                  }
+                  zsLib::Time middle = zsLib::now();
+                  for (size_t loop = 0; loop < kTotalOperations; ++loop) {
+                    size_t which = loop % totalTimers;
+                    wheel.cancel(wheelIDs[which]);
+                    wheelIDs[which] = wheel.add(start + Milliseconds(4000 + (loop % 2000)), static_cast<DWORD>(which));
+                  }
+                  zsLib::Time end = zsLib::now();
+
+                  TESTING_EQUAL(totalTimers, wheel.size())
+                  TESTING_EQUAL(totalTimers, tree.size())
+
+                  DWORDTimerWheel::ValueList fired;
+                  wheel.advance(start + Seconds(10), fired);
+                  TESTING_EQUAL(totalTimers, fired.size())
+
+                  TESTING_STDOUT() << "BENCHMARK:    [" << totalTimers << "] timers, [" << kTotalOperations << "] reschedules, std::multimap took [" << zsLib::toMilliseconds(middle - begin).count() << "ms], timer wheel took [" << zsLib::toMilliseconds(end - middle).count() << "ms]\n";
+                }
+                break;
+              }
+              case 5: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All timer wheel tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -0,0 +1,522 @@
+/*
+ 
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+ 
+ */
+
+
+#include <zsLib/MessageQueueThread.h>
+#include <zsLib/Socket.h>
+
+#include <ortc/ISettings.h>
+
+#include <ortc/internal/ortc_UDPBatch.h>
+#include <ortc/internal/ortc_PacketDemux.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ortc { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_test) } }
+
+using zsLib::BYTE;
+using zsLib::ULONG;
+using zsLib::IPAddress;
+using zsLib::Socket;
+using zsLib::SocketPtr;
+
+namespace ortc
+{
+  namespace test
+  {
+    namespace udp_batch
+    {
+      typedef ortc::internal::UDPBatchReceiver UDPBatchReceiver;
+      typedef ortc::internal::UDPBatchSender UDPBatchSender;
+      typedef ortc::internal::PacketDemux PacketDemux;
+
+      //-----------------------------------------------------------------------
+      static SocketPtr createLoopbackSocket()
+      {
+        SocketPtr socket = Socket::createUDP(Socket::Create::IPv4);
+        socket->bind(IPAddress("127.0.0.1", 0));
+        socket->setBlocking(false);
+        return socket;
+      }
+
+      //-----------------------------------------------------------------------
+      static size_t sendBurst(
+                              SocketPtr from,
+                              const IPAddress &to,
+                              size_t total,
+                              size_t size,
+                              size_t sequenceStart
+                              )
+      {
+        std::vector<BYTE> buffer(size);
+        size_t sent = 0;
+        for (size_t loop = 0; loop < total; ++loop) {
+          memset(&(buffer[0]), static_cast<int>((sequenceStart + loop) & 0xFF), size);
+          bool wouldBlock = false;
+          if (from->sendTo(to, &(buffer[0]), size, &wouldBlock) != size) break;
+          ++sent;
+        }
+        return sent;
+      }
+
+      //-----------------------------------------------------------------------
+      static size_t drain(
+                          UDPBatchReceiver &receiver,
+                          SocketPtr socket,
+                          size_t expecting
+                          )
+      {
+        size_t received = 0;
+        zsLib::Time giveUp = zsLib::now() + zsLib::Seconds(5);
+        while ((received < expecting) &&
+               (zsLib::now() < giveUp)) {
+          bool wouldBlock = false;
+          int errorCode = 0;
+          received += receiver.receive(socket, wouldBlock, errorCode);
+          if (0 != errorCode) break;
+        }
+        return received;
+      }
+
+      //-----------------------------------------------------------------------
+      // RETURNS: the number of datagrams received (each checked to be whole)
+      static size_t drainWhole(
+                               UDPBatchReceiver &receiver,
+                               SocketPtr socket,
+                               size_t expecting,
+                               size_t smallSize,
+                               size_t largeSize
+                               )
+      {
+        size_t received = 0;
+        zsLib::Time giveUp = zsLib::now() + zsLib::Seconds(5);
+        while ((received < expecting) &&
+               (zsLib::now() < giveUp)) {
+          bool wouldBlock = false;
+          int errorCode = 0;
+          receiver.receive(socket, wouldBlock, errorCode);
+          if (0 != errorCode) break;
+
+          auto &datagrams = receiver.datagrams();
+          for (auto iter = datagrams.begin(); iter != datagrams.end(); ++iter) {
+            auto &datagram = (*iter);
+            TESTING_CHECK((smallSize == datagram.mSize) || (largeSize == datagram.mSize))
+            TESTING_CHECK(datagram.mBuffer->SizeInBytes() >= datagram.mSize)
+            TESTING_EQUAL(datagram.mBuffer->BytePtr()[0], datagram.mBuffer->BytePtr()[datagram.mSize - 1])
+            ++received;
+          }
+        }
+        return received;
+      }
+
+      //-----------------------------------------------------------------------
+      static void fillFrame(
+                            std::vector<BYTE> &outFrame,
+                            UDPBatchSender::PacketList &outPackets,
+                            size_t frameSize,
+                            size_t packetSize
+                            )
+      {
+        outFrame.resize(frameSize);
+        outPackets.clear();
+        for (size_t offset = 0; offset < frameSize; offset += packetSize) {
+          UDPBatchSender::Packet packet;
+          packet.mBuffer = &(outFrame[offset]);
+          packet.mSize = (frameSize - offset > packetSize ? packetSize : frameSize - offset);
+          memset(&(outFrame[offset]), static_cast<int>(outPackets.size() & 0xFF), packet.mSize);
+          outPackets.push_back(packet);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      static void checkBurst(
+                             bool allowSegmentationOffload,
+                             const std::vector<size_t> &sizes
+                             )
+      {
+        SocketPtr senderSocket = createLoopbackSocket();
+        SocketPtr receiverSocket = createLoopbackSocket();
+
+        UDPBatchSender sender(16, allowSegmentationOffload);
+        UDPBatchReceiver receiver(64, 1500);
+
+        std::vector< std::vector<BYTE> > buffers(sizes.size());
+        for (size_t index = 0; index < sizes.size(); ++index) {
+          buffers[index].resize(sizes[index]);
+          memset(&(buffers[index][0]), static_cast<int>(index & 0xFF), sizes[index]);
+          sender.add(receiverSocket->getLocalAddress(), &(buffers[index][0]), sizes[index]);
+        }
+        TESTING_EQUAL(sizes.size(), sender.pending())
+
+        bool wouldBlock = false;
+        int errorCode = 0;
+        size_t sent = sender.flush(senderSocket, senderSocket->getLocalAddress(), wouldBlock, errorCode);
+        TESTING_EQUAL(0, errorCode)
+        TESTING_EQUAL(sizes.size(), sent)
+        TESTING_EQUAL(0, sender.pending())
+        TESTING_CHECK(sender.counters().mSystemCalls <= sizes.size())
+
+        size_t received = 0;
+        zsLib::Time giveUp = zsLib::now() + zsLib::Seconds(5);
+        while ((received < sent) &&
+               (zsLib::now() < giveUp)) {
+          receiver.receive(receiverSocket, wouldBlock, errorCode);
+          TESTING_EQUAL(0, errorCode)
+
+          auto &datagrams = receiver.datagrams();
+          for (auto iter = datagrams.begin(); iter != datagrams.end(); ++iter) {
+            auto &datagram = (*iter);
+            TESTING_CHECK(received < sizes.size())
+            if (received >= sizes.size()) break;
+            TESTING_EQUAL(sizes[received], datagram.mSize)
+            TESTING_EQUAL(static_cast<BYTE>(received & 0xFF), datagram.mBuffer->BytePtr()[0])
+            TESTING_EQUAL(static_cast<BYTE>(received & 0xFF), datagram.mBuffer->BytePtr()[datagram.mSize - 1])
+            TESTING_CHECK(datagram.mFromIP == senderSocket->getLocalAddress())
+            ++received;
+          }
+        }
+        TESTING_EQUAL(sent, received)
+      }
+    }
+  }
+}
+
+using namespace ortc::test::udp_batch;
+
+#define TEST_BASIC_UDP_BATCH 0
+#define TEST_BASIC_UDP_BATCH_SEND 1
+
+void doTestUDPBatch()
+{
+  if (!ORTC_TEST_DO_UDP_BATCH_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  TESTING_SLEEP(1000)
+
+  ortc::ISettings::applyDefaults();
+
+  TESTING_STDOUT() << "WAITING:      Waiting for UDP batch testing to complete.\n";
+
+  {
+    ULONG testNumber = 0;
+    ULONG maxSteps = 10;
+
+    do
+    {
+      TESTING_STDOUT() << "TESTING       ---------->>>>>>>>>> " << testNumber << " <<<<<<<<<<----------\n";
+
+      bool quit = false;
+
+      switch (testNumber) {
+        case TEST_BASIC_UDP_BATCH: break;
+        case TEST_BASIC_UDP_BATCH_SEND: break;
+        default:  quit = true; break;
+      }
+      if (quit) break;
+
+      ULONG step = 0;
+
+      bool reachedFinalStep = false;
+
+      while (!reachedFinalStep)
+      {
+        ++step;
+        if (step >= maxSteps)
+          break;
+
+        switch (testNumber) {
+          case TEST_BASIC_UDP_BATCH: {
+            switch (step) {
+              case 1: {
+                // every datagram arrives intact, in order, with its source
+                SocketPtr sender = createLoopbackSocket();
+                SocketPtr receiverSocket = createLoopbackSocket();
+
+                UDPBatchReceiver receiver(8, 1500);
+
+                size_t sent = sendBurst(sender, receiverSocket->getLocalAddress(), 20, 100, 0);
+                TESTING_EQUAL(20, sent)
+
+                size_t received = 0;
+                zsLib::Time giveUp = zsLib::now() + zsLib::Seconds(5);
+                while ((received < sent) &&
+                       (zsLib::now() < giveUp)) {
+                  bool wouldBlock = false;
+                  int errorCode = 0;
+                  size_t total = receiver.receive(receiverSocket, wouldBlock, errorCode);
+                  TESTING_EQUAL(0, errorCode)
+                  TESTING_CHECK(total <= receiver.maxDatagramsPerRead())
+
+                  auto &datagrams = receiver.datagrams();
+                  for (auto iter = datagrams.begin(); iter != datagrams.end(); ++iter) {
+                    auto &datagram = (*iter);
+                    TESTING_EQUAL(100, datagram.mSize)
+                    TESTING_EQUAL(static_cast<BYTE>(received & 0xFF), datagram.mBuffer->BytePtr()[0])
+                    TESTING_EQUAL(static_cast<BYTE>(received & 0xFF), datagram.mBuffer->BytePtr()[99])
+                    TESTING_CHECK(datagram.mFromIP == sender->getLocalAddress())
+                    ++received;
+                  }
+                }
+                TESTING_EQUAL(sent, received)
+                TESTING_EQUAL(received, receiver.counters().mDatagrams)
+                break;
+              }
+              case 2: {
+                // datagrams larger than a receive slot are delivered whole (or
+                // dropped) but never reach the caller as partial data
+                SocketPtr sender = createLoopbackSocket();
+                SocketPtr receiverSocket = createLoopbackSocket();
+
+                UDPBatchReceiver receiver(8, 256);
+
+                // a lone oversized datagram within a batch is recovered
+                size_t sent = sendBurst(sender, receiverSocket->getLocalAddress(), 1, 1000, 0);
+                sent += sendBurst(sender, receiverSocket->getLocalAddress(), 3, 200, 1);
+                TESTING_EQUAL(4, sent)
+
+                size_t received = drainWhole(receiver, receiverSocket, 4, 200, 1000);
+                TESTING_EQUAL(4, received)
+                TESTING_EQUAL(0, receiver.counters().mTruncated)
+
+                // several in one batch each spill into their own overflow
+                // region thus all of them survive intact
+                sent = sendBurst(sender, receiverSocket->getLocalAddress(), 4, 1000, 4);
+                sent += sendBurst(sender, receiverSocket->getLocalAddress(), 4, 200, 8);
+                TESTING_EQUAL(8, sent)
+
+                received = drainWhole(receiver, receiverSocket, 8, 200, 1000);
+                TESTING_EQUAL(8, received)
+                TESTING_EQUAL(0, receiver.counters().mTruncated)
+                TESTING_EQUAL(4 + 8, receiver.counters().mDatagrams)
+                break;
+              }
+              case 3: {
+                // loopback benchmark: one receive per datagram vs batched
+                const size_t totalPackets = 200000;
+                const size_t burst = 128;
+                const size_t batchSizes[] = {1, 8, 32, 64};
+
+                for (size_t batchIndex = 0; batchIndex < (sizeof(batchSizes) / sizeof(batchSizes[0])); ++batchIndex) {
+                  size_t batchSize = batchSizes[batchIndex];
+
+                  SocketPtr sender = createLoopbackSocket();
+                  SocketPtr receiverSocket = createLoopbackSocket();
+                  IPAddress to = receiverSocket->getLocalAddress();
+
+                  UDPBatchReceiver receiver(batchSize, 1500);
+
+                  size_t received = 0;
+                  zsLib::Time start = zsLib::now();
+                  for (size_t loop = 0; loop < totalPackets; loop += burst) {
+                    size_t sent = sendBurst(sender, to, burst, 200, loop);
+                    received += drain(receiver, receiverSocket, sent);
+                  }
+                  zsLib::Time end = zsLib::now();
+
+                  auto duration = zsLib::toMilliseconds(end - start).count();
+                  if (duration < 1) duration = 1;
+
+                  auto &counters = receiver.counters();
+                  TESTING_STDOUT() << "BENCHMARK:    batch=" << batchSize << " packets=" << received << " packets/s=" << ((received * 1000) / duration) << " syscalls/packet=" << (static_cast<double>(counters.mSystemCalls) / static_cast<double>(received ? received : 1)) << "\n";
+                }
+                break;
+              }
+              case 4: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          case TEST_BASIC_UDP_BATCH_SEND: {
+            switch (step) {
+              case 1: {
+                // equal sized runs, a short tail, a larger datagram breaking a
+                // run and more datagrams than one system call carries all
+                // arrive intact and in order
+                std::vector<size_t> sizes;
+                for (size_t loop = 0; loop < 40; ++loop) sizes.push_back(1200);
+                sizes.push_back(300);
+                sizes.push_back(1200);
+                sizes.push_back(1400);
+                sizes.push_back(1400);
+                sizes.push_back(800);
+                sizes.push_back(100);
+
+                checkBurst(true, sizes);
+                checkBurst(false, sizes);
+                break;
+              }
+              case 2: {
+                // 1080p keyframe burst benchmark: one send per packet vs
+                // sendmmsg vs segmentation offload
+                const size_t totalFrames = 2000;
+                const size_t frameSize = 150 * 1024;   // typical 1080p keyframe
+                const size_t packetSize = 1200;
+
+                struct Mode
+                {
+                  const char *mName;
+                  size_t mBatch;
+                  bool mOffload;
+                };
+                const Mode modes[] = {
+                  {"sendto", 1, false},
+                  {"sendmmsg", 64, false},
+                  {"gso", 64, true},
+                };
+
+                std::vector<BYTE> frame;
+                UDPBatchSender::PacketList packets;
+                fillFrame(frame, packets, frameSize, packetSize);
+
+                for (size_t modeIndex = 0; modeIndex < (sizeof(modes) / sizeof(modes[0])); ++modeIndex) {
+                  auto &mode = modes[modeIndex];
+
+                  SocketPtr senderSocket = createLoopbackSocket();
+                  SocketPtr receiverSocket = createLoopbackSocket();
+                  IPAddress to = receiverSocket->getLocalAddress();
+                  IPAddress bound = senderSocket->getLocalAddress();
+
+                  UDPBatchSender sender(mode.mBatch, mode.mOffload);
+                  UDPBatchReceiver receiver(64, 1500);
+
+                  zsLib::Microseconds sendTime {};
+                  size_t sent = 0;
+                  size_t received = 0;
+
+                  for (size_t loop = 0; loop < totalFrames; ++loop) {
+                    bool wouldBlock = false;
+                    int errorCode = 0;
+
+                    zsLib::Time start = zsLib::now();
+                    sender.add(to, packets);
+                    size_t frameSent = sender.flush(senderSocket, bound, wouldBlock, errorCode);
+                    sendTime += zsLib::toMicroseconds(zsLib::now() - start);
+
+                    sent += frameSent;
+
+                    // loopback delivers synchronously; whatever overflowed the
+                    // receive buffer is simply lost
+                    while (true) {
+                      size_t total = receiver.receive(receiverSocket, wouldBlock, errorCode);
+                      if (0 == total) break;
+                      received += total;
+                    }
+                  }
+
+                  auto duration = sendTime.count();
+                  if (duration < 1) duration = 1;
+
+                  auto &counters = sender.counters();
+                  TESTING_STDOUT() << "BENCHMARK:    mode=" << mode.mName << " frames=" << totalFrames << " packets/frame=" << packets.size() << " sent=" << sent << " received=" << received << " us/frame=" << (static_cast<double>(duration) / static_cast<double>(totalFrames)) << " syscalls/frame=" << (static_cast<double>(counters.mSystemCalls) / static_cast<double>(totalFrames)) << " segmented=" << counters.mSegmentedSends << "\n";
+                }
+                break;
+              }
+              case 3: {
+                // a TURN ChannelData header gathered in front of an untouched
+                // payload arrives as one datagram the demux can unwrap
+                SocketPtr senderSocket = createLoopbackSocket();
+                SocketPtr receiverSocket = createLoopbackSocket();
+                UDPBatchReceiver receiver(8, 1500);
+
+                std::vector<BYTE> payload(1000);
+                for (size_t index = 0; index < payload.size(); ++index) payload[index] = static_cast<BYTE>(index & 0xFF);
+                payload[0] = 0x80;  // looks like RTP once unwrapped
+
+                BYTE header[PacketDemux::Size_TURNChannelDataHeader] {};
+                TESTING_CHECK(PacketDemux::writeTURNChannelDataHeader(&(header[0]), 0x4001, payload.size()))
+                TESTING_CHECK(!PacketDemux::writeTURNChannelDataHeader(&(header[0]), 0x4001, 0x10000))
+
+                bool wouldBlock = false;
+                int errorCode = 0;
+                TESTING_CHECK(UDPBatchSender::sendWithPrefix(senderSocket, senderSocket->getLocalAddress(), receiverSocket->getLocalAddress(), &(header[0]), sizeof(header), &(payload[0]), payload.size(), wouldBlock, errorCode))
+                TESTING_EQUAL(0, errorCode)
+
+                TESTING_EQUAL(1, drain(receiver, receiverSocket, 1))
+
+                auto &datagram = receiver.datagrams()[0];
+                const BYTE *buffer = datagram.mBuffer->BytePtr();
+                TESTING_EQUAL(sizeof(header) + payload.size(), datagram.mSize)
+                TESTING_EQUAL(PacketDemux::PacketType_TURNChannelData, PacketDemux::classify(buffer, datagram.mSize))
+
+                zsLib::WORD channelNumber = 0;
+                size_t payloadSize = 0;
+                TESTING_CHECK(PacketDemux::parseTURNChannelData(buffer, datagram.mSize, channelNumber, payloadSize))
+                TESTING_EQUAL(0x4001, channelNumber)
+                TESTING_EQUAL(payload.size(), payloadSize)
+                TESTING_CHECK(0 == memcmp(buffer + sizeof(header), &(payload[0]), payload.size()))
+                TESTING_EQUAL(PacketDemux::PacketType_RTP, PacketDemux::classify(buffer + sizeof(header), payloadSize))
+
+                // a length running past the datagram or a number outside the
+                // channel range is rejected
+                TESTING_CHECK(!PacketDemux::parseTURNChannelData(buffer, sizeof(header) + 10, channelNumber, payloadSize))
+                BYTE outOfRange[PacketDemux::Size_TURNChannelDataHeader] = {0x50, 0x00, 0x00, 0x00};
+                TESTING_CHECK(!PacketDemux::parseTURNChannelData(&(outOfRange[0]), sizeof(outOfRange), channelNumber, payloadSize))
+                break;
+              }
+              case 4: {
+                reachedFinalStep = true;
+                break;
+              }
+              default: {
+                // nothing happening in this step
+                break;
+              }
+            }
+            break;
+          }
+          default: {
+            // none defined
+            break;
+          }
+        }
+      }
+
+      TESTING_CHECK(reachedFinalStep)
+
+      ++testNumber;
+    } while (true);
+  }
+
+  TESTING_STDOUT() << "WAITING:      All UDP batch tests have finished.\n";
+
+  TESTING_UNINSTALL_LOGGER();
+}
@@ -49,6 +49,20 @@
 #define ORTC_TEST_DO_DTLS_TRANSPORT_TEST                  (false)
 #define ORTC_TEST_DO_SRTP_TEST                            (false)
 #define ORTC_TEST_DO_SCTP_TRANSPORT_TEST                  (false)
+#define ORTC_TEST_DO_BUFFER_POOL_TEST                     (false)
+#define ORTC_TEST_DO_FLAT_HASH_MAP_TEST                   (false)
+#define ORTC_TEST_DO_PACKET_RING_TEST                     (false)
+#define ORTC_TEST_DO_UDP_BATCH_TEST                       (false)
+#define ORTC_TEST_DO_ICE_SHARED_PORT_TEST                 (false)
+#define ORTC_TEST_DO_SOCKET_REACTOR_TEST                  (false)
+#define ORTC_TEST_DO_NETWORK_MONITOR_TEST                 (false)
+#define ORTC_TEST_DO_PACKET_QUEUES_TEST                   (false)
+#define ORTC_TEST_DO_PACKET_DEMUX_TEST                    (false)
+#define ORTC_TEST_DO_ICE_GATHERER_ROUTER_TEST             (false)
+#define ORTC_TEST_DO_TCP_FRAMING_TEST                     (false)
+#define ORTC_TEST_DO_STUN_MESSAGE_INTEGRITY_TEST          (false)
+#define ORTC_TEST_DO_TIMER_WHEEL_TEST                     (false)
+#define ORTC_TEST_DO_PRIORITY_QUEUE_TEST                  (false)
 #define ORTC_TEST_DO_RTP_PACKET_TEST                      (false)
 #define ORTC_TEST_DO_RTCP_PACKET_TEST                     (false)
 #define ORTC_TEST_DO_RTP_LISTENER_TEST                    (false)
@@ -58,6 +58,20 @@ void doTestRTPChannel();
 void doTestRTPReceiver();
 void doTestRTPSender();
 void doTestRTPListener();
+void doTestBufferPool();
+void doTestFlatHashMap();
+void doTestPacketRing();
+void doTestUDPBatch();
+void doTestICESharedPort();
+void doTestSocketReactor();
+void doTestNetworkMonitor();
+void doTestPacketQueues();
+void doTestPacketDemux();
+void doTestICEGathererRouter();
+void doTestTCPFraming();
+void doTestSTUNMessageIntegrity();
+void doTestTimerWheel();
+void doTestPriorityQueue();
 void doTestRTPPacket();
 void doTestRTCPPacket();
 void doTestSCTP();
@@ -169,6 +183,20 @@ namespace Testing
     TESTING_RUN_TEST_FUNC_0(doTestRTPSender)
     TESTING_RUN_TEST_FUNC_0(doTestRTPReceiver)
     TESTING_RUN_TEST_FUNC_0(doTestRTPListener)
+    TESTING_RUN_TEST_FUNC_0(doTestBufferPool)
+    TESTING_RUN_TEST_FUNC_0(doTestFlatHashMap)
+    TESTING_RUN_TEST_FUNC_0(doTestPacketRing)
+    TESTING_RUN_TEST_FUNC_0(doTestUDPBatch)
+    TESTING_RUN_TEST_FUNC_0(doTestICESharedPort)
+    TESTING_RUN_TEST_FUNC_0(doTestSocketReactor)
+    TESTING_RUN_TEST_FUNC_0(doTestNetworkMonitor)
+    TESTING_RUN_TEST_FUNC_0(doTestPacketQueues)
+    TESTING_RUN_TEST_FUNC_0(doTestPacketDemux)
+    TESTING_RUN_TEST_FUNC_0(doTestICEGathererRouter)
+    TESTING_RUN_TEST_FUNC_0(doTestTCPFraming)
+    TESTING_RUN_TEST_FUNC_0(doTestSTUNMessageIntegrity)
+    TESTING_RUN_TEST_FUNC_0(doTestTimerWheel)
+    TESTING_RUN_TEST_FUNC_0(doTestPriorityQueue)
     TESTING_RUN_TEST_FUNC_0(doTestRTPPacket)
     TESTING_RUN_TEST_FUNC_0(doTestRTCPPacket)
     TESTING_RUN_TEST_FUNC_0(doTestSCTP)